@@ -22,4 +22,7 @@ if(NOT WIN32)
     string(CONCAT CMAKE_C_FLAGS_DEBUG_INIT
            "-g -gdwarf-2 -g3 -O0 -fno-inline -fno-eliminate-unused-debug-types "
            "--coverage")
+    # The same for the C++ tests, which link the instrumented library
+    set(CMAKE_CXX_FLAGS_INIT "${CMAKE_C_FLAGS_INIT}")
+    set(CMAKE_CXX_FLAGS_DEBUG_INIT "${CMAKE_C_FLAGS_DEBUG_INIT}")
 endif()
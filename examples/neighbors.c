@@ -28,6 +28,10 @@ int main(int argc, char* argv[]) {
     int k = 2;
 
     int maxNeighboring = maxKringSize(k);
+    if (maxNeighboring < 0) {
+        // k is too large for the k-ring to fit in an int
+        return 1;
+    }
     H3Index* neighboring = calloc(maxNeighboring, sizeof(H3Index));
     kRing(indexed, k, neighboring);
 
@@ -15,35 +15,92 @@
  */
 /** @file benchmark.h
  * @brief Benchmark harness functions and macros.
+ *
+ * Each benchmark splits its iterations into samples, timed with a monotonic
+ * nanosecond clock after one sample of warmup, and reports the median, mean,
+ * standard deviation, minimum and 99th percentile time per iteration across
+ * samples.
+ *
+ * Benchmark programs accept these options:
+ *  `--samples N`: number of samples per benchmark (default 20)
+ *  `--format text|json|csv`: output format (default text)
+ *  `--inputs DIR`: directory of the tests/inputfiles corpora read by
+ *  benchmarkReadCenters
+ *  `--threads N`: maximum number of threads for threaded benchmarks
+ *
+ * When the library is built with H3_ENABLE_STATS, the warmup sample is
+ * profiled as well: each benchmark also reports the heap allocations and
+ * bytes allocated per iteration, the peak of live heap bytes and the
+ * largest stack array, and for polyfills the candidate cells classified
+ * per cell output. Only the calling thread is counted.
  */
 
 #ifndef BENCHMARK_H
 #define BENCHMARK_H
 
-#include <time.h>
+#include <stdint.h>
+#include "h3api.h"
+
+/** maximum number of samples taken for any benchmark */
+#define BENCHMARK_MAX_SAMPLES 1000
+
+void benchmarkBegin(int argc, char* argv[]);
+void benchmarkEnd(void);
+int benchmarkNumSamples(int iterations);
+int benchmarkMaxThreads(void);
+int64_t benchmarkNowNs(void);
+void benchmarkProfileStart(void);
+void benchmarkProfileStop(int iterations);
+void benchmarkReport(const char* name, int iterations, int numSamples,
+                     double* sampleNs);
+void benchmarkEscape(void* p);
+int benchmarkReadCenters(const char* name, int maxCount, H3Index* cells,
+                         GeoCoord* centers);
+
+/**
+ * Prevents the compiler from optimizing away the computation of an lvalue,
+ * for benchmark bodies whose results are otherwise unused.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define DO_NOT_OPTIMIZE(VALUE) __asm__ volatile("" : : "r"(&(VALUE)) : "memory")
+#else
+#define DO_NOT_OPTIMIZE(VALUE) benchmarkEscape((void*)&(VALUE))
+#endif
 
 #define BEGIN_BENCHMARKS()             \
     int main(int argc, char* argv[]) { \
-        clock_t start;                 \
-        clock_t diff;                  \
-        double duration;               \
-        int iterations;                \
-        char* name;
-
-#define BENCHMARK(NAME, ITERATIONS, BODY)                                    \
-    start = clock();                                                         \
-    iterations = ITERATIONS;                                                 \
-    name = #NAME;                                                            \
-    for (int i = 0; i < iterations; i++) {                                   \
-        BODY;                                                                \
-    }                                                                        \
-    diff = clock() - start;                                                  \
-    duration = diff * 1000 / CLOCKS_PER_SEC;                                 \
-    printf("\t-- %s: %f milliseconds per iteration (%d iterations)\n", name, \
-           duration / iterations, iterations);
+        benchmarkBegin(argc, argv);
+
+/**
+ * Runs a benchmark whose name is given by a string expression, for
+ * benchmarks generated in a loop.
+ */
+#define NAMED_BENCHMARK(NAME, ITERATIONS, BODY)                               \
+    do {                                                                      \
+        double sampleNs[BENCHMARK_MAX_SAMPLES];                               \
+        int numSamples = benchmarkNumSamples(ITERATIONS);                     \
+        int iterations = (ITERATIONS) / numSamples;                           \
+        benchmarkProfileStart();                                              \
+        for (int i = 0; i < iterations; i++) {                                \
+            BODY;                                                             \
+        }                                                                     \
+        benchmarkProfileStop(iterations);                                     \
+        for (int s = 0; s < numSamples; s++) {                                \
+            int64_t start = benchmarkNowNs();                                 \
+            for (int i = 0; i < iterations; i++) {                            \
+                BODY;                                                         \
+            }                                                                 \
+            sampleNs[s] = (double)(benchmarkNowNs() - start) / iterations;    \
+        }                                                                     \
+        benchmarkReport(NAME,  iterations, numSamples, sampleNs);             \
+    } while (0)
+
+#define BENCHMARK(NAME, ITERATIONS, BODY) \
+    NAMED_BENCHMARK(#NAME, ITERATIONS, BODY)
 
 #define END_BENCHMARKS() \
     ;                    \
+    benchmarkEnd();      \
     }
 
 #endif
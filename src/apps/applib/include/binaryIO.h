@@ -0,0 +1,45 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file binaryIO.h
+ * @brief Packed binary input and output for the filter applications.
+ *
+ * H3 indexes are packed as little endian 64 bit unsigned integers, and
+ * coordinates as pairs of little endian IEEE 754 doubles, latitude first, in
+ * decimal degrees. Cells are packed as an index followed by the coordinates
+ * of its center. Records are read and written in blocks of
+ * BINARY_BLOCK_SIZE.
+ */
+
+#ifndef BINARYIO_H
+#define BINARYIO_H
+
+#include <stdio.h>
+#include "h3api.h"
+
+/** number of records read or written at a time */
+#define BINARY_BLOCK_SIZE 4096
+
+void binaryMode(FILE* f);
+int binaryReadIndexes(FILE* f, H3Index* out, int maxCount);
+int binaryReadCoords(FILE* f, double* lat, double* lon, int maxCount);
+void binaryWriteIndexes(FILE* f, const H3Index* h3, int n);
+void binaryWriteCoords(FILE* f, const double* lat, const double* lon, int n);
+int binaryReadCells(FILE* f, H3Index* h3, double* lat, double* lon,
+                    int maxCount);
+void binaryWriteCells(FILE* f, const H3Index* h3, const double* lat,
+                      const double* lon, int n);
+
+#endif
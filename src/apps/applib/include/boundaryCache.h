@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file boundaryCache.h
+ * @brief A thread safe LRU cache of cell boundaries.
+ */
+
+#ifndef BOUNDARYCACHE_H
+#define BOUNDARYCACHE_H
+
+#include <stdint.h>
+#include "h3api.h"
+
+/** number of shards of a cache created with numShards 0 */
+#define BOUNDARY_CACHE_DEFAULT_SHARDS 16
+
+/** @struct BoundaryCache
+ *  @brief opaque cache of the boundaries of cells
+ */
+typedef struct BoundaryCache BoundaryCache;
+
+/** @brief Counters of a cache, summed over its shards */
+typedef struct {
+    uint64_t hits;       ///< lookups of cached boundaries
+    uint64_t misses;     ///< lookups decoding the boundary
+    uint64_t evictions;  ///< boundaries evicted to make room
+    int size;            ///< boundaries held
+} BoundaryCacheStats;
+
+BoundaryCache* createBoundaryCache(int capacity, int numShards);
+void boundaryCacheGet(BoundaryCache* cache, H3Index h, GeoBoundary* gb);
+void boundaryCacheStats(BoundaryCache* cache, BoundaryCacheStats* stats);
+size_t boundaryCacheMemorySize(const BoundaryCache* cache);
+void destroyBoundaryCache(BoundaryCache* cache);
+
+#endif
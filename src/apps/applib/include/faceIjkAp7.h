@@ -0,0 +1,29 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file faceIjkAp7.h
+ * @brief Reference FaceIJK encoding through the aperture 7 grids, for
+ * testing and benchmarking _faceIjkToH3.
+ */
+
+#ifndef FACEIJKAP7_H
+#define FACEIJKAP7_H
+
+#include "faceijk.h"
+#include "h3api.h"
+
+H3Index _faceIjkToH3Ap7(const FaceIJK* fijk, int res);
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file geoWriter.h
+ * @brief Buffered streaming output of points and polygons as KML or GeoJSON.
+ *
+ * Output is gathered in a large buffer and written with fwrite when it
+ * fills, and coordinates are formatted in decimal degrees with a fixed
+ * number of digits by integer arithmetic, instead of with printf.
+ */
+
+#ifndef GEOWRITER_H
+#define GEOWRITER_H
+
+#include <stdio.h>
+#include "h3api.h"
+
+/** size in bytes of the output buffered before each write */
+#define GEO_WRITER_BUFFER_SIZE (1 << 20)
+
+/** digits written after the decimal point of each coordinate */
+#define GEO_WRITER_PRECISION 6
+
+/** most bytes written by geoWriterFormatFixed, including the terminator */
+#define GEO_WRITER_FIXED_SIZE 32
+
+/** @brief output formats of a GeoWriter */
+typedef enum {
+    GEO_WRITER_KML,     ///< a KML Document of Placemarks
+    GEO_WRITER_GEOJSON  ///< a GeoJSON FeatureCollection
+} GeoWriterFormat;
+
+/** @brief a stream of features being written to a file */
+typedef struct {
+    FILE* f;                 ///< the file written to
+    GeoWriterFormat format;  ///< the output format
+    int numFeatures;         ///< the number of features written so far
+    size_t length;           ///< the number of bytes in the buffer
+    char buffer[GEO_WRITER_BUFFER_SIZE];  ///< output not yet written
+} GeoWriter;
+
+GeoWriter* geoWriterCreate(FILE* f, GeoWriterFormat format, const char* name,
+                           const char* desc);
+void geoWriterPoint(GeoWriter* w, const GeoCoord* g, const char* name);
+void geoWriterPolygon(GeoWriter* w, const GeoCoord* verts, int numVerts,
+                      const char* name);
+void geoWriterBoundary(GeoWriter* w, const GeoBoundary* b, const char* name);
+void geoWriterLinkedGeo(GeoWriter* w, const LinkedGeoPolygon* polygon,
+                        const char* name);
+void geoWriterClose(GeoWriter* w);
+
+int geoWriterFormatFixed(double value, char* out);
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file hierDump.h
+ * @brief Parallel enumeration of the descendants of cells, written to shards.
+ */
+
+#ifndef HIERDUMP_H
+#define HIERDUMP_H
+
+#include <stdio.h>
+#include "h3api.h"
+
+/** number of partitions enumerated per thread, to even out their sizes */
+#define HIER_DUMP_PARTITIONS_PER_THREAD 16
+
+/** @brief The shards cells are written to, a block at a time */
+typedef struct {
+    /** opens shard number shard of numShards, returning its state */
+    void* (*open)(void* context, int shard, int numShards);
+    /** writes a block of cells to a shard */
+    void (*write)(void* shard, const H3Index* cells, int numCells);
+    /** finishes a shard, and frees its state */
+    void (*close)(void* shard);
+    void* context;  ///< passed to open
+} HierOutput;
+
+/** @brief Options common to the hierarchy applications */
+typedef struct {
+    int numThreads;      ///< number of threads, and of shards
+    const char* output;  ///< prefix of the shard files, or NULL for stdout
+    int binary;          ///< whether to write packed binary records
+} HierOptions;
+
+int hierParseOptions(int argc, char* argv[], HierOptions* options);
+FILE* hierOpenShard(const HierOptions* options, int shard);
+void hierCloseShard(FILE* f);
+void hierDump(H3Index root, int res, int numThreads, const HierOutput* output);
+
+#endif
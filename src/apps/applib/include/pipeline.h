@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file pipeline.h
+ * @brief In-process pipelines of filter stages, passing binary batches
+ * between stages.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include "h3api.h"
+
+/** bytes of stdio buffer of the input and output of a pipeline */
+#define PIPE_IO_BUFFER_SIZE (1 << 20)
+
+/** most stages of a pipeline */
+#define PIPE_MAX_STAGES 16
+
+/** most records a batch is read with, before the stages expand it */
+#define PIPE_MAX_BATCH_RECORDS (1 << 20)
+
+/** largest k of a kring stage */
+#define PIPE_MAX_K 100
+
+/** @brief The kinds of records passed between stages */
+typedef enum {
+    PIPE_COORDS,     ///< lat/lon pairs, in degrees
+    PIPE_INDEXES,    ///< H3 indexes
+    PIPE_BOUNDARIES  ///< H3 indexes with their cell boundaries
+} PipeKind;
+
+/** @brief A batch of records of one kind */
+typedef struct {
+    PipeKind kind;            ///< the kind of the records
+    int numRecords;           ///< the number of records
+    H3Index* indexes;         ///< the indexes, but for PIPE_COORDS
+    double* lat;              ///< the latitudes of PIPE_COORDS
+    double* lon;              ///< the longitudes of PIPE_COORDS
+    GeoBoundary* boundaries;  ///< the boundaries of PIPE_BOUNDARIES
+} PipeBatch;
+
+/** @brief A stage of a pipeline, as parsed from `name[:arg]` */
+typedef struct {
+    const char* name;  ///< the name of the stage
+    PipeKind input;    ///< the kind of records it reads
+    PipeKind output;   ///< the kind of records it writes
+    int arg;           ///< its argument
+    /** converts a batch, returning the input itself or a new batch, in
+     * which case the input is freed */
+    PipeBatch* (*run)(int arg, PipeBatch* in);
+} PipeStage;
+
+/** @brief Options of a pipeline */
+typedef struct {
+    int binary;      ///< whether input and output are packed binary records
+    int numWorkers;  ///< the threads running each stage, or 0 to run the
+                     ///< whole pipeline on the calling thread
+} PipeOptions;
+
+int pipeParseStage(const char* spec, PipeStage* stage);
+const char* pipeCheck(const PipeStage* stages, int numStages,
+                      const PipeOptions* options);
+void pipeRun(const PipeStage* stages, int numStages,
+             const PipeOptions* options, FILE* in, FILE* out);
+PipeBatch* pipeCreateBatch(PipeKind kind, int capacity);
+void pipeDestroyBatch(PipeBatch* batch);
+
+#endif
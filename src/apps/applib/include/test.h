@@ -26,6 +26,8 @@
 
 void t_assert(int value, const char* msg);
 void t_assertBoundary(H3Index h3, const GeoBoundary* b1);
+void reverseParallelFor(void* executor, int n, H3ParallelTask task,
+                        void* data);
 
 int testCount();
 
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file threadPool.h
+ * @brief A pool of pthreads running H3ParallelFor tasks with work stealing.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "h3api.h"
+
+/** @struct ThreadPool
+ *  @brief opaque pool of threads, passed as the executor of threadPoolFor
+ */
+typedef struct ThreadPool ThreadPool;
+
+ThreadPool* createThreadPool(int numThreads);
+int threadPoolSize(const ThreadPool* pool);
+void threadPoolFor(void* executor, int n, H3ParallelTask task, void* data);
+void destroyThreadPool(ThreadPool* pool);
+
+#endif
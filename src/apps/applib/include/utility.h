@@ -41,5 +41,6 @@ void geoPrintlnNoFmt(const GeoCoord* p);
 void geoBoundaryPrint(const GeoBoundary* b);
 void geoBoundaryPrintln(const GeoBoundary* b);
 int readBoundary(FILE* f, GeoBoundary* b);
+int readCenters(FILE* f, int maxCount, H3Index* cells, GeoCoord* centers);
 
 #endif
@@ -0,0 +1,342 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmark.c
+ * @brief Benchmark harness functions
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "benchmark.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "utility.h"
+
+/** default number of samples per benchmark */
+#define DEFAULT_SAMPLES 20
+
+#ifndef BENCHMARK_INPUT_DIR
+/** default directory of the input corpora, relative to the source root */
+#define BENCHMARK_INPUT_DIR "tests/inputfiles"
+#endif
+
+/** @brief benchmark output formats */
+typedef enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV } BenchmarkFormat;
+
+static int globalSamples = DEFAULT_SAMPLES;
+static BenchmarkFormat globalFormat = FORMAT_TEXT;
+static int globalReportCount = 0;
+static const char* globalInputDir = BENCHMARK_INPUT_DIR;
+static int globalMaxThreads = 0;
+/** whether the library counts its work, see H3_ENABLE_STATS */
+static int globalProfiling = 0;
+/** counters of the last profiled benchmark, until it is reported */
+static H3Stats globalProfile;
+/** iterations of the last profiled benchmark, or 0 if it was reported */
+static int globalProfileIterations = 0;
+
+/** sink for benchmarkEscape, which compilers must assume is read */
+void* volatile globalBenchmarkSink;
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--samples N] [--format text|json|csv] "
+            "[--inputs DIR] [--threads N]\n",
+            program);
+    exit(1);
+}
+
+/**
+ * Parses the benchmark program arguments and prints any output header.
+ *
+ * @param argc Number of arguments
+ * @param argv Arguments, with the program name first
+ */
+void benchmarkBegin(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            globalSamples = atoi(argv[++i]);
+            if (globalSamples < 1 || globalSamples > BENCHMARK_MAX_SAMPLES) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "text") == 0) {
+                globalFormat = FORMAT_TEXT;
+            } else if (strcmp(argv[i], "json") == 0) {
+                globalFormat = FORMAT_JSON;
+            } else if (strcmp(argv[i], "csv") == 0) {
+                globalFormat = FORMAT_CSV;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--inputs") == 0 && i + 1 < argc) {
+            globalInputDir = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            globalMaxThreads = atoi(argv[++i]);
+            if (globalMaxThreads < 1) {
+                usage(argv[0]);
+            }
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    H3Stats stats;
+    globalProfiling = H3_EXPORT(h3GetStats)(&stats) == 0;
+
+    if (globalFormat == FORMAT_JSON) {
+        printf("{\"benchmarks\": [");
+    } else if (globalFormat == FORMAT_CSV) {
+        printf(
+            "name,samples,iterations,median_ns,mean_ns,stddev_ns,min_ns,"
+            "p99_ns%s\n",
+            globalProfiling ? ",allocations,allocated_bytes,peak_heap_bytes,"
+                              "peak_stack_bytes,candidates_per_output"
+                            : "");
+    }
+}
+
+/**
+ * Prints any output footer.
+ */
+void benchmarkEnd(void) {
+    if (globalFormat == FORMAT_JSON) {
+        printf("\n]}\n");
+    }
+}
+
+/**
+ * Returns the number of samples to split a benchmark's iterations into, so
+ * that each sample runs at least one iteration.
+ *
+ * @param iterations Total number of iterations of the benchmark
+ * @return Number of samples
+ */
+int benchmarkNumSamples(int iterations) {
+    if (iterations < 1) return 1;
+    return iterations < globalSamples ? iterations : globalSamples;
+}
+
+/**
+ * Returns the maximum number of threads given with --threads.
+ *
+ * @return Maximum number of threads, or 0 if not given
+ */
+int benchmarkMaxThreads(void) { return globalMaxThreads; }
+
+/**
+ * Starts counting the work of the calling thread, for the warmup of a
+ * benchmark.
+ */
+void benchmarkProfileStart(void) {
+    if (globalProfiling) H3_EXPORT(h3ResetStats)();
+}
+
+/**
+ * Stops counting the work of the calling thread, keeping the counters for
+ * the next benchmarkReport.
+ *
+ * @param iterations Number of iterations counted
+ */
+void benchmarkProfileStop(int iterations) {
+    if (globalProfiling && iterations > 0) {
+        H3_EXPORT(h3GetStats)(&globalProfile);
+        globalProfileIterations = iterations;
+    }
+}
+
+/**
+ * Prints the counters of the last profiled benchmark per iteration, after
+ * its timings, or nulls if it was not profiled.
+ */
+static void _benchmarkReportProfile(void) {
+    int n = globalProfileIterations;
+    const H3Stats* p = &globalProfile;
+    // the candidate cells classified per cell output, by polyfills
+    double candidates = p->polyfillKept
+                            ? (double)p->polyfillCandidates / p->polyfillKept
+                            : 0;
+    switch (globalFormat) {
+        case FORMAT_JSON:
+            if (!n) {
+                printf(
+                    ", \"allocations\": null, \"allocated_bytes\": null, "
+                    "\"peak_heap_bytes\": null, \"peak_stack_bytes\": null, "
+                    "\"candidates_per_output\": null");
+                break;
+            }
+            printf(
+                ", \"allocations\": %.3f, \"allocated_bytes\": %.3f, "
+                "\"peak_heap_bytes\": %lld, \"peak_stack_bytes\": %llu, ",
+                (double)p->allocations / n, (double)p->allocatedBytes / n,
+                (long long)p->peakBytes,
+                (unsigned long long)p->peakStackBytes);
+            if (p->polyfillKept) {
+                printf("\"candidates_per_output\": %.3f", candidates);
+            } else {
+                printf("\"candidates_per_output\": null");
+            }
+            break;
+        case FORMAT_CSV:
+            if (!n) {
+                printf(",,,,,");
+                break;
+            }
+            printf(",%.3f,%.3f,%lld,%llu,", (double)p->allocations / n,
+                   (double)p->allocatedBytes / n, (long long)p->peakBytes,
+                   (unsigned long long)p->peakStackBytes);
+            if (p->polyfillKept) printf("%.3f", candidates);
+            break;
+        default:
+            if (!n) break;
+            printf(
+                "\t   %.1f allocations of %.0f bytes per iteration, %lld "
+                "peak heap bytes, %llu peak stack bytes",
+                (double)p->allocations / n, (double)p->allocatedBytes / n,
+                (long long)p->peakBytes,
+                (unsigned long long)p->peakStackBytes);
+            if (p->polyfillKept) {
+                printf(", %.2f candidates per output cell", candidates);
+            }
+            printf("\n");
+    }
+    globalProfileIterations = 0;
+}
+
+/**
+ * Returns the time of a monotonic clock in nanoseconds.
+ */
+int64_t benchmarkNowNs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (int64_t)((double)count.QuadPart * 1e9 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+/**
+ * Forces the memory at p to be computed, for compilers without inline
+ * assembly barriers.
+ */
+void benchmarkEscape(void* p) { globalBenchmarkSink = p; }
+
+static int cmpDouble(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Prints the statistics of a benchmark's samples.
+ *
+ * @param name Benchmark name
+ * @param iterations Number of iterations in each sample
+ * @param numSamples Number of samples
+ * @param sampleNs Time per iteration of each sample in nanoseconds. Sorted
+ *                 in place.
+ */
+void benchmarkReport(const char* name, int iterations, int numSamples,
+                     double* sampleNs) {
+    qsort(sampleNs, numSamples, sizeof(double), cmpDouble);
+
+    double sum = 0;
+    for (int i = 0; i < numSamples; i++) sum += sampleNs[i];
+    double mean = sum / numSamples;
+    double sumSq = 0;
+    for (int i = 0; i < numSamples; i++) {
+        sumSq += (sampleNs[i] - mean) * (sampleNs[i] - mean);
+    }
+    double stddev = numSamples > 1 ? sqrt(sumSq / (numSamples - 1)) : 0;
+    double median = numSamples % 2
+                        ? sampleNs[numSamples / 2]
+                        : (sampleNs[numSamples / 2 - 1] +
+                           sampleNs[numSamples / 2]) /
+                              2;
+    // nearest rank percentile
+    int p99Rank = (int)ceil(0.99 * numSamples);
+    double p99 = sampleNs[p99Rank - 1];
+    double min = sampleNs[0];
+
+    switch (globalFormat) {
+        case FORMAT_JSON:
+            printf(
+                "%s\n  {\"name\": \"%s\", \"samples\": %d, \"iterations\": "
+                "%d, \"median_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": "
+                "%.3f, \"min_ns\": %.3f, \"p99_ns\": %.3f",
+                globalReportCount ? "," : "", name, numSamples, iterations,
+                median, mean, stddev, min, p99);
+            if (globalProfiling) _benchmarkReportProfile();
+            printf("}");
+            break;
+        case FORMAT_CSV:
+            printf("%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f", name, numSamples,
+                   iterations, median, mean, stddev, min, p99);
+            if (globalProfiling) _benchmarkReportProfile();
+            printf("\n");
+            break;
+        default:
+            printf(
+                "\t-- %s: %.1f ns median, %.1f ns mean, %.1f ns stddev, "
+                "%.1f ns p99 per iteration (%d samples of %d iterations)\n",
+                name, median, mean, stddev, p99, numSamples, iterations);
+            if (globalProfiling) _benchmarkReportProfile();
+    }
+    fflush(stdout);
+    globalReportCount++;
+}
+
+/**
+ * Reads a centers file from the input corpora, exiting if it cannot be
+ * read.
+ *
+ * @param name File name within the input directory, e.g. "rand09centers.txt"
+ * @param maxCount Maximum number of centers to read
+ * @param cells Output indexes, with room for maxCount
+ * @param centers Output centers, with room for maxCount
+ * @return Number of centers read
+ */
+int benchmarkReadCenters(const char* name, int maxCount, H3Index* cells,
+                         GeoCoord* centers) {
+    char path[BUFF_SIZE];
+    snprintf(path, BUFF_SIZE, "%s/%s", globalInputDir, name);
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s, see --inputs\n", path);
+        exit(1);
+    }
+    int n = readCenters(f, maxCount, cells, centers);
+    fclose(f);
+    if (n <= 0) {
+        fprintf(stderr, "cannot read centers from %s\n", path);
+        exit(1);
+    }
+    return n;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file binaryIO.c
+ * @brief Packed binary input and output for the filter applications.
+ */
+
+#include "binaryIO.h"
+#include <stdint.h>
+#include <string.h>
+#include "utility.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/** size in bytes of one packed 64 bit word */
+#define WORD_SIZE 8
+
+/**
+ * Decodes a little endian 64 bit word. Compilers reduce this to a single
+ * load on little endian machines.
+ */
+static uint64_t _getWord(const unsigned char* b) {
+    return (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16 |
+           (uint64_t)b[3] << 24 | (uint64_t)b[4] << 32 |
+           (uint64_t)b[5] << 40 | (uint64_t)b[6] << 48 | (uint64_t)b[7] << 56;
+}
+
+/**
+ * Encodes a little endian 64 bit word.
+ */
+static void _putWord(unsigned char* b, uint64_t w) {
+    for (int i = 0; i < WORD_SIZE; i++) {
+        b[i] = (unsigned char)(w >> (8 * i));
+    }
+}
+
+static double _wordToDouble(uint64_t w) {
+    double d;
+    memcpy(&d, &w, sizeof(d));
+    return d;
+}
+
+static uint64_t _doubleToWord(double d) {
+    uint64_t w;
+    memcpy(&w, &d, sizeof(w));
+    return w;
+}
+
+/**
+ * Reads up to maxCount records of numWords words each, exiting with an error
+ * if the input ends inside a record.
+ *
+ * @return The number of records read, 0 at the end of the input
+ */
+static int _readRecords(FILE* f, unsigned char* buff, int numWords,
+                        int maxCount) {
+    size_t recordSize = (size_t)numWords * WORD_SIZE;
+    size_t numBytes = fread(buff, 1, recordSize * maxCount, f);
+    if (ferror(f)) error("reading binary input");
+    if (numBytes % recordSize) error("binary input ends inside a record");
+    return (int)(numBytes / recordSize);
+}
+
+/**
+ * Switches a stream to binary mode, so that no newline translation is done
+ * on platforms that have text streams.
+ */
+void binaryMode(FILE* f) {
+#ifdef _WIN32
+    _setmode(_fileno(f), _O_BINARY);
+#else
+    (void)f;
+#endif
+}
+
+/**
+ * Reads a block of packed H3 indexes.
+ *
+ * @param f The stream to read
+ * @param out Output indexes
+ * @param maxCount Maximum number of indexes to read, at most
+ * BINARY_BLOCK_SIZE
+ * @return The number of indexes read, 0 at the end of the input
+ */
+int binaryReadIndexes(FILE* f, H3Index* out, int maxCount) {
+    unsigned char buff[BINARY_BLOCK_SIZE * WORD_SIZE];
+    if (maxCount > BINARY_BLOCK_SIZE) maxCount = BINARY_BLOCK_SIZE;
+    int n = _readRecords(f, buff, 1, maxCount);
+    for (int i = 0; i < n; i++) {
+        out[i] = _getWord(&buff[i * WORD_SIZE]);
+    }
+    return n;
+}
+
+/**
+ * Reads a block of packed lat/lon pairs, in degrees.
+ *
+ * @param f The stream to read
+ * @param lat Output latitudes
+ * @param lon Output longitudes
+ * @param maxCount Maximum number of pairs to read, at most BINARY_BLOCK_SIZE
+ * @return The number of pairs read, 0 at the end of the input
+ */
+int binaryReadCoords(FILE* f, double* lat, double* lon, int maxCount) {
+    unsigned char buff[BINARY_BLOCK_SIZE * 2 * WORD_SIZE];
+    if (maxCount > BINARY_BLOCK_SIZE) maxCount = BINARY_BLOCK_SIZE;
+    int n = _readRecords(f, buff, 2, maxCount);
+    for (int i = 0; i < n; i++) {
+        lat[i] = _wordToDouble(_getWord(&buff[2 * i * WORD_SIZE]));
+        lon[i] = _wordToDouble(_getWord(&buff[(2 * i + 1) * WORD_SIZE]));
+    }
+    return n;
+}
+
+/**
+ * Writes packed H3 indexes.
+ *
+ * @param f The stream to write
+ * @param h3 The indexes
+ * @param n The number of indexes
+ */
+void binaryWriteIndexes(FILE* f, const H3Index* h3, int n) {
+    unsigned char buff[BINARY_BLOCK_SIZE * WORD_SIZE];
+    while (n > 0) {
+        int count = n < BINARY_BLOCK_SIZE ? n : BINARY_BLOCK_SIZE;
+        for (int i = 0; i < count; i++) {
+            _putWord(&buff[i * WORD_SIZE], h3[i]);
+        }
+        if (fwrite(buff, WORD_SIZE, count, f) != (size_t)count) {
+            error("writing binary output");
+        }
+        h3 += count;
+        n -= count;
+    }
+}
+
+/**
+ * Writes packed lat/lon pairs, in degrees.
+ *
+ * @param f The stream to write
+ * @param lat The latitudes
+ * @param lon The longitudes
+ * @param n The number of pairs
+ */
+void binaryWriteCoords(FILE* f, const double* lat, const double* lon, int n) {
+    unsigned char buff[BINARY_BLOCK_SIZE * 2 * WORD_SIZE];
+    while (n > 0) {
+        int count = n < BINARY_BLOCK_SIZE ? n : BINARY_BLOCK_SIZE;
+        for (int i = 0; i < count; i++) {
+            _putWord(&buff[2 * i * WORD_SIZE], _doubleToWord(lat[i]));
+            _putWord(&buff[(2 * i + 1) * WORD_SIZE], _doubleToWord(lon[i]));
+        }
+        if (fwrite(buff, 2 * WORD_SIZE, count, f) != (size_t)count) {
+            error("writing binary output");
+        }
+        lat += count;
+        lon += count;
+        n -= count;
+    }
+}
+
+/**
+ * Reads a block of packed cells, each an index and the lat/lon pair of its
+ * center, in degrees.
+ *
+ * @param f The stream to read
+ * @param h3 Output indexes
+ * @param lat Output latitudes
+ * @param lon Output longitudes
+ * @param maxCount Maximum number of cells to read, at most BINARY_BLOCK_SIZE
+ * @return The number of cells read, 0 at the end of the input
+ */
+int binaryReadCells(FILE* f, H3Index* h3, double* lat, double* lon,
+                    int maxCount) {
+    unsigned char buff[BINARY_BLOCK_SIZE * 3 * WORD_SIZE];
+    if (maxCount > BINARY_BLOCK_SIZE) maxCount = BINARY_BLOCK_SIZE;
+    int n = _readRecords(f, buff, 3, maxCount);
+    for (int i = 0; i < n; i++) {
+        h3[i] = _getWord(&buff[3 * i * WORD_SIZE]);
+        lat[i] = _wordToDouble(_getWord(&buff[(3 * i + 1) * WORD_SIZE]));
+        lon[i] = _wordToDouble(_getWord(&buff[(3 * i + 2) * WORD_SIZE]));
+    }
+    return n;
+}
+
+/**
+ * Writes packed cells, each an index and the lat/lon pair of its center, in
+ * degrees.
+ *
+ * @param f The stream to write
+ * @param h3 The indexes
+ * @param lat The latitudes
+ * @param lon The longitudes
+ * @param n The number of cells
+ */
+void binaryWriteCells(FILE* f, const H3Index* h3, const double* lat,
+                      const double* lon, int n) {
+    unsigned char buff[BINARY_BLOCK_SIZE * 3 * WORD_SIZE];
+    while (n > 0) {
+        int count = n < BINARY_BLOCK_SIZE ? n : BINARY_BLOCK_SIZE;
+        for (int i = 0; i < count; i++) {
+            _putWord(&buff[3 * i * WORD_SIZE], h3[i]);
+            _putWord(&buff[(3 * i + 1) * WORD_SIZE], _doubleToWord(lat[i]));
+            _putWord(&buff[(3 * i + 2) * WORD_SIZE], _doubleToWord(lon[i]));
+        }
+        if (fwrite(buff, 3 * WORD_SIZE, count, f) != (size_t)count) {
+            error("writing binary output");
+        }
+        h3 += count;
+        lat += count;
+        lon += count;
+        n -= count;
+    }
+}
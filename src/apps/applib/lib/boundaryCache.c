@@ -0,0 +1,286 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file boundaryCache.c
+ * @brief A thread safe LRU cache of cell boundaries.
+ *
+ * The cache is split into shards by the hash of the index, each guarded by
+ * a lock of its own so threads looking up different cells rarely contend.
+ * A shard holds a fixed number of entries, allocated up front, in a chained
+ * hash table and in a doubly linked list from the most to the least
+ * recently used; a miss past the capacity evicts the least recently used
+ * entry. The lock is not held while a missing boundary is decoded.
+ */
+
+#include "boundaryCache.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include "h3IndexSet.h"
+
+/** marks the end of a list of entries */
+#define NO_ENTRY -1
+
+/** @brief A cached boundary */
+typedef struct {
+    H3Index h;             ///< the cell
+    int prev;              ///< the more recently used entry
+    int next;              ///< the less recently used entry
+    int chain;             ///< the next entry of the same bucket
+    GeoBoundary boundary;  ///< the boundary of the cell
+} BoundaryEntry;
+
+/** @brief A shard of a cache */
+typedef struct {
+    pthread_mutex_t lock;    ///< guards everything below
+    BoundaryEntry* entries;  ///< the entries, the first size of them used
+    int* buckets;            ///< the first entry of each bucket
+    int mask;                ///< the number of buckets minus one
+    int capacity;            ///< the number of entries
+    int size;                ///< the number of entries used
+    int head;                ///< the most recently used entry
+    int tail;                ///< the least recently used entry
+    uint64_t hits;           ///< lookups found in the shard
+    uint64_t misses;         ///< lookups not found in the shard
+    uint64_t evictions;      ///< entries reused for another cell
+} BoundaryShard;
+
+struct BoundaryCache {
+    BoundaryShard** shards;  ///< the shards, allocated apart
+    int numShards;           ///< the number of shards
+};
+
+static void _destroyShard(BoundaryShard* shard) {
+    if (shard == NULL) return;
+    pthread_mutex_destroy(&shard->lock);
+    free(shard->entries);
+    free(shard->buckets);
+    free(shard);
+}
+
+static BoundaryShard* _createShard(int capacity) {
+    BoundaryShard* shard = calloc(1, sizeof(BoundaryShard));
+    if (shard == NULL) return NULL;
+    int numBuckets = 1;
+    while (numBuckets < capacity) {
+        numBuckets *= 2;
+    }
+    shard->entries = malloc(capacity * sizeof(BoundaryEntry));
+    shard->buckets = malloc(numBuckets * sizeof(int));
+    pthread_mutex_init(&shard->lock, NULL);
+    if (shard->entries == NULL || shard->buckets == NULL) {
+        _destroyShard(shard);
+        return NULL;
+    }
+    for (int b = 0; b < numBuckets; b++) {
+        shard->buckets[b] = NO_ENTRY;
+    }
+    shard->mask = numBuckets - 1;
+    shard->capacity = capacity;
+    shard->head = NO_ENTRY;
+    shard->tail = NO_ENTRY;
+    return shard;
+}
+
+/**
+ * createBoundaryCache creates an empty cache holding at most about capacity
+ * boundaries, split evenly between its shards.
+ *
+ * @param capacity The number of boundaries held
+ * @param numShards The number of shards, or 0 for
+ * BOUNDARY_CACHE_DEFAULT_SHARDS
+ * @return The cache, which the caller must free with destroyBoundaryCache,
+ * or NULL if it could not be allocated
+ */
+BoundaryCache* createBoundaryCache(int capacity, int numShards) {
+    if (numShards <= 0) numShards = BOUNDARY_CACHE_DEFAULT_SHARDS;
+    if (capacity < numShards) capacity = numShards;
+    BoundaryCache* cache = malloc(sizeof(BoundaryCache));
+    if (cache == NULL) return NULL;
+    cache->shards = calloc(numShards, sizeof(BoundaryShard*));
+    cache->numShards = numShards;
+    if (cache->shards == NULL) {
+        free(cache);
+        return NULL;
+    }
+    int shardCapacity = (capacity + numShards - 1) / numShards;
+    for (int s = 0; s < numShards; s++) {
+        cache->shards[s] = _createShard(shardCapacity);
+        if (cache->shards[s] == NULL) {
+            destroyBoundaryCache(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+/**
+ * Finds the entry of a cell in a shard.
+ *
+ * @return The entry, or NO_ENTRY if the cell is not cached
+ */
+static int _shardFind(const BoundaryShard* shard, H3Index h, uint64_t hash) {
+    int e = shard->buckets[hash & shard->mask];
+    while (e != NO_ENTRY && shard->entries[e].h != h) {
+        e = shard->entries[e].chain;
+    }
+    return e;
+}
+
+static void _shardUnlink(BoundaryShard* shard, int e) {
+    BoundaryEntry* entry = &shard->entries[e];
+    if (entry->prev == NO_ENTRY) {
+        shard->head = entry->next;
+    } else {
+        shard->entries[entry->prev].next = entry->next;
+    }
+    if (entry->next == NO_ENTRY) {
+        shard->tail = entry->prev;
+    } else {
+        shard->entries[entry->next].prev = entry->prev;
+    }
+}
+
+static void _shardPushFront(BoundaryShard* shard, int e) {
+    BoundaryEntry* entry = &shard->entries[e];
+    entry->prev = NO_ENTRY;
+    entry->next = shard->head;
+    if (shard->head == NO_ENTRY) {
+        shard->tail = e;
+    } else {
+        shard->entries[shard->head].prev = e;
+    }
+    shard->head = e;
+}
+
+/**
+ * Adds the boundary of a cell not in a shard, evicting the least recently
+ * used entry if the shard is full.
+ */
+static void _shardInsert(BoundaryShard* shard, H3Index h, uint64_t hash,
+                         const GeoBoundary* gb) {
+    int e;
+    if (shard->size < shard->capacity) {
+        e = shard->size++;
+    } else {
+        e = shard->tail;
+        _shardUnlink(shard, e);
+        int* link = &shard->buckets[_h3IndexHash(shard->entries[e].h) &
+                                    shard->mask];
+        while (*link != e) {
+            link = &shard->entries[*link].chain;
+        }
+        *link = shard->entries[e].chain;
+        shard->evictions++;
+    }
+    BoundaryEntry* entry = &shard->entries[e];
+    entry->h = h;
+    entry->boundary = *gb;
+    entry->chain = shard->buckets[hash & shard->mask];
+    shard->buckets[hash & shard->mask] = e;
+    _shardPushFront(shard, e);
+}
+
+/**
+ * boundaryCacheGet finds the boundary of a cell, as h3ToGeoBoundary does,
+ * decoding and caching it if it is not cached. It may be called from many
+ * threads at once.
+ *
+ * @param cache The cache
+ * @param h The cell
+ * @param gb Output boundary
+ */
+void boundaryCacheGet(BoundaryCache* cache, H3Index h, GeoBoundary* gb) {
+    uint64_t hash = _h3IndexHash(h);
+    BoundaryShard* shard =
+        cache->shards[(hash >> 32) % (uint64_t)cache->numShards];
+
+    pthread_mutex_lock(&shard->lock);
+    int e = _shardFind(shard, h, hash);
+    if (e != NO_ENTRY) {
+        *gb = shard->entries[e].boundary;
+        if (e != shard->head) {
+            _shardUnlink(shard, e);
+            _shardPushFront(shard, e);
+        }
+        shard->hits++;
+        pthread_mutex_unlock(&shard->lock);
+        return;
+    }
+    shard->misses++;
+    pthread_mutex_unlock(&shard->lock);
+
+    H3_EXPORT(h3ToGeoBoundary)(h, gb);
+
+    pthread_mutex_lock(&shard->lock);
+    // Another thread may have cached the same cell in the meantime
+    if (_shardFind(shard, h, hash) == NO_ENTRY) {
+        _shardInsert(shard, h, hash, gb);
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * boundaryCacheStats sums the counters of the shards of a cache.
+ *
+ * @param cache The cache
+ * @param stats Output counters
+ */
+void boundaryCacheStats(BoundaryCache* cache, BoundaryCacheStats* stats) {
+    stats->hits = 0;
+    stats->misses = 0;
+    stats->evictions = 0;
+    stats->size = 0;
+    for (int s = 0; s < cache->numShards; s++) {
+        BoundaryShard* shard = cache->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->size += shard->size;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+/**
+ * boundaryCacheMemorySize returns the memory held by a cache, which is
+ * allocated in full when it is created.
+ *
+ * @param cache The cache
+ * @return The size in bytes
+ */
+size_t boundaryCacheMemorySize(const BoundaryCache* cache) {
+    size_t size = sizeof(BoundaryCache) +
+                  cache->numShards * sizeof(BoundaryShard*);
+    for (int s = 0; s < cache->numShards; s++) {
+        const BoundaryShard* shard = cache->shards[s];
+        size += sizeof(BoundaryShard) +
+                shard->capacity * sizeof(BoundaryEntry) +
+                (shard->mask + 1) * sizeof(int);
+    }
+    return size;
+}
+
+/**
+ * destroyBoundaryCache frees a cache returned by createBoundaryCache.
+ *
+ * @param cache The cache
+ */
+void destroyBoundaryCache(BoundaryCache* cache) {
+    for (int s = 0; s < cache->numShards; s++) {
+        _destroyShard(cache->shards[s]);
+    }
+    free(cache->shards);
+    free(cache);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file faceIjkAp7.c
+ * @brief Reference FaceIJK encoding through the aperture 7 grids, for
+ * testing and benchmarking _faceIjkToH3.
+ */
+
+#include "faceIjkAp7.h"
+#include "coordijk.h"
+#include "h3Index.h"
+
+/**
+ * Convert an FaceIJK address to the corresponding H3Index, finding each digit
+ * by moving up and back down the aperture 7 grids.
+ *
+ * This is the reference implementation of _faceIjkToH3, for testing and
+ * benchmarking the table driven digit generation.
+ * @param fijk The FaceIJK address.
+ * @param res The cell resolution.
+ * @return The encoded H3Index (or 0 on failure).
+ */
+H3Index _faceIjkToH3Ap7(const FaceIJK* fijk, int res) {
+    // initialize the index
+    H3Index h = H3_INIT;
+    H3_SET_MODE(h, H3_HEXAGON_MODE);
+    H3_SET_RESOLUTION(h, res);
+
+    // we need to find the correct base cell FaceIJK for this H3 index;
+    // start with the passed in face and resolution res ijk coordinates
+    // in that face's coordinate system
+    FaceIJK fijkBC = *fijk;
+
+    // build the H3Index from finest res up
+    // adjust r for the fact that the res 0 base cell offsets the index array
+    CoordIJK* ijk = &fijkBC.coord;
+    for (int r = res - 1; r >= 0; r--) {
+        CoordIJK lastIJK = *ijk;
+        CoordIJK lastCenter;
+        if (isResClassIII(r + 1)) {
+            // rotate ccw
+            _upAp7(ijk);
+            lastCenter = *ijk;
+            _downAp7(&lastCenter);
+        } else {
+            // rotate cw
+            _upAp7r(ijk);
+            lastCenter = *ijk;
+            _downAp7r(&lastCenter);
+        }
+
+        CoordIJK diff;
+        _ijkSub(&lastIJK, &lastCenter, &diff);
+        _ijkNormalize(&diff);
+
+        H3_SET_INDEX_DIGIT(h, r + 1, _unitIjkToDigit(&diff));
+    }
+
+    // fijkBC should now hold the IJK of the base cell in the
+    // coordinate system of the current face
+    return _faceIjkBaseCellToH3(h, &fijkBC);
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file geoWriter.c
+ * @brief Buffered streaming output of points and polygons as KML or GeoJSON.
+ */
+
+#include "geoWriter.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utility.h"
+
+/** most bytes written for one coordinate, with its separators */
+#define COORD_SIZE (2 * GEO_WRITER_FIXED_SIZE + 32)
+
+/** 10 to the power GEO_WRITER_PRECISION */
+static const uint64_t FIXED_SCALE = 1000000;
+
+/** coordinates at least this large are formatted with snprintf */
+#define FIXED_LIMIT 1e12
+
+/**
+ * Writes out the buffered output.
+ */
+static void _geoWriterFlush(GeoWriter* w) {
+    if (w->length > 0 && fwrite(w->buffer, 1, w->length, w->f) != w->length)
+        error("writing output");
+    w->length = 0;
+}
+
+/**
+ * Makes room in the buffer for at least n more bytes, n being at most
+ * GEO_WRITER_BUFFER_SIZE.
+ */
+static char* _geoWriterReserve(GeoWriter* w, size_t n) {
+    if (w->length + n > GEO_WRITER_BUFFER_SIZE) _geoWriterFlush(w);
+    return w->buffer + w->length;
+}
+
+/**
+ * Appends a string of any length.
+ */
+static void _geoWriterString(GeoWriter* w, const char* str) {
+    size_t n = strlen(str);
+    while (n > 0) {
+        _geoWriterReserve(w, 1);
+        size_t chunk = GEO_WRITER_BUFFER_SIZE - w->length;
+        if (chunk > n) chunk = n;
+        memcpy(w->buffer + w->length, str, chunk);
+        w->length += chunk;
+        str += chunk;
+        n -= chunk;
+    }
+}
+
+/**
+ * Appends a name or description, escaping the characters that are special
+ * in the output format.
+ */
+static void _geoWriterEscaped(GeoWriter* w, const char* str) {
+    for (; *str; str++) {
+        char* p = _geoWriterReserve(w, 8);
+        const char* escape = NULL;
+        if (w->format == GEO_WRITER_KML) {
+            if (*str == '<') escape = "&lt;";
+            if (*str == '>') escape = "&gt;";
+            if (*str == '&') escape = "&amp;";
+        } else {
+            if (*str == '"') escape = "\\\"";
+            if (*str == '\\') escape = "\\\\";
+            if ((unsigned char)*str < 0x20) escape = " ";
+        }
+        if (escape) {
+            size_t n = strlen(escape);
+            memcpy(p, escape, n);
+            w->length += n;
+        } else {
+            *p = *str;
+            w->length++;
+        }
+    }
+}
+
+/**
+ * geoWriterFormatFixed formats a number with GEO_WRITER_PRECISION digits
+ * after the decimal point, as the "%.6f" format of printf does. The value
+ * is rounded to nearest, ties to even, after scaling, so the last digit can
+ * differ from printf for values within an ulp of halfway between two
+ * outputs.
+ *
+ * @param value The number to format
+ * @param out Output string of at least GEO_WRITER_FIXED_SIZE bytes
+ * @return The length of the string
+ */
+int geoWriterFormatFixed(double value, char* out) {
+    if (!(fabs(value) < FIXED_LIMIT)) {
+        return snprintf(out, GEO_WRITER_FIXED_SIZE, "%.*f",
+                        GEO_WRITER_PRECISION, value);
+    }
+
+    char* p = out;
+    if (value < 0) *p++ = '-';
+    uint64_t scaled = (uint64_t)rint(fabs(value) * FIXED_SCALE);
+    uint64_t whole = scaled / FIXED_SCALE;
+    uint64_t frac = scaled % FIXED_SCALE;
+
+    // digits of the whole part, written backwards
+    char digits[24];
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (numDigits > 0) *p++ = digits[--numDigits];
+
+    *p++ = '.';
+    for (int i = GEO_WRITER_PRECISION - 1; i >= 0; i--) {
+        p[i] = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    p += GEO_WRITER_PRECISION;
+    *p = '\0';
+    return (int)(p - out);
+}
+
+/**
+ * Appends a coordinate as longitude then latitude in degrees: on its own
+ * line for KML, and as a [lon,lat] pair for GeoJSON, preceded by a comma
+ * unless it is the first of its ring.
+ */
+static void _geoWriterCoord(GeoWriter* w, const GeoCoord* g, int first) {
+    char* p = _geoWriterReserve(w, COORD_SIZE);
+    char* start = p;
+    if (w->format == GEO_WRITER_KML) {
+        memcpy(p, "            ", 12);
+        p += 12;
+        p += geoWriterFormatFixed(H3_EXPORT(radsToDegs)(g->lon), p);
+        *p++ = ',';
+        p += geoWriterFormatFixed(H3_EXPORT(radsToDegs)(g->lat), p);
+        memcpy(p, ",5.0\n", 5);
+        p += 5;
+    } else {
+        if (!first) *p++ = ',';
+        *p++ = '[';
+        p += geoWriterFormatFixed(H3_EXPORT(radsToDegs)(g->lon), p);
+        *p++ = ',';
+        p += geoWriterFormatFixed(H3_EXPORT(radsToDegs)(g->lat), p);
+        *p++ = ']';
+    }
+    w->length += p - start;
+}
+
+/**
+ * Starts a feature, its geometry of the given GeoJSON type.
+ */
+static void _geoWriterBeginFeature(GeoWriter* w, const char* name,
+                                   const char* type) {
+    if (w->format == GEO_WRITER_KML) {
+        _geoWriterString(w, "<Placemark>\n<name>");
+        _geoWriterEscaped(w, name);
+        _geoWriterString(w, "</name>\n");
+    } else {
+        _geoWriterString(w, w->numFeatures ? ",\n" : "\n");
+        _geoWriterString(w, "{\"type\":\"Feature\",\"properties\":{\"name\":\"");
+        _geoWriterEscaped(w, name);
+        _geoWriterString(w, "\"},\"geometry\":{\"type\":\"");
+        _geoWriterString(w, type);
+        _geoWriterString(w, "\",\"coordinates\":");
+    }
+    w->numFeatures++;
+}
+
+/**
+ * Ends a feature.
+ */
+static void _geoWriterEndFeature(GeoWriter* w) {
+    _geoWriterString(w, w->format == GEO_WRITER_KML ? "</Placemark>\n" : "}}");
+}
+
+/**
+ * geoWriterCreate starts writing features to a file.
+ *
+ * @param f The file to write to
+ * @param format The output format
+ * @param name The name of the document
+ * @param desc The description of the document, written only to KML
+ * @return The writer, which must be closed with geoWriterClose
+ */
+GeoWriter* geoWriterCreate(FILE* f, GeoWriterFormat format, const char* name,
+                           const char* desc) {
+    GeoWriter* w = malloc(sizeof(GeoWriter));
+    if (!w) error("allocating output buffer");
+    w->f = f;
+    w->format = format;
+    w->numFeatures = 0;
+    w->length = 0;
+
+    if (format == GEO_WRITER_KML) {
+        _geoWriterString(
+            w,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+            "<Document>\n"
+            "   <name>");
+        _geoWriterEscaped(w, name);
+        _geoWriterString(w, "</name>\n   <description>");
+        _geoWriterEscaped(w, desc);
+        _geoWriterString(
+            w,
+            "</description>\n"
+            "   <Style id=\"lineStyle1\">\n"
+            "      <LineStyle id=\"lineStyle2\">\n"
+            "         <color>ff000fff</color>\n"
+            "         <width>2</width>\n"
+            "      </LineStyle>\n"
+            "      <PolyStyle>\n"
+            "         <fill>0</fill>\n"
+            "      </PolyStyle>\n"
+            "   </Style>\n"
+            "   <Style id=\"m_ylw-pushpin\">\n"
+            "      <IconStyle>\n"
+            "         <scale>1.1</scale>\n"
+            "         <Icon>\n"
+            "            <href>http://maps.google.com/mapfiles/kml/shapes/"
+            "placemark_circle.png</href>\n"
+            "         </Icon>\n"
+            "      </IconStyle>\n"
+            "      <LabelStyle>\n"
+            "         <color>ff000fff</color>\n"
+            "         <scale>2</scale>\n"
+            "      </LabelStyle>\n"
+            "   </Style>\n");
+    } else {
+        _geoWriterString(w, "{\"type\":\"FeatureCollection\",\"name\":\"");
+        _geoWriterEscaped(w, name);
+        _geoWriterString(w, "\",\"features\":[");
+    }
+    return w;
+}
+
+/**
+ * geoWriterPoint writes a point.
+ *
+ * @param w The writer
+ * @param g The point
+ * @param name The name of the point
+ */
+void geoWriterPoint(GeoWriter* w, const GeoCoord* g, const char* name) {
+    _geoWriterBeginFeature(w, name, "Point");
+    if (w->format == GEO_WRITER_KML) {
+        _geoWriterString(w,
+                         "   <styleUrl>#m_ylw-pushpin</styleUrl>\n"
+                         "   <Point>\n"
+                         "      <coordinates>\n");
+        _geoWriterCoord(w, g, 1);
+        _geoWriterString(w, "      </coordinates>\n   </Point>\n");
+    } else {
+        _geoWriterCoord(w, g, 1);
+    }
+    _geoWriterEndFeature(w);
+}
+
+/**
+ * Appends a ring, repeating its first vertex at its end.
+ */
+static void _geoWriterRing(GeoWriter* w, const GeoCoord* verts,
+                           int numVerts) {
+    if (w->format == GEO_WRITER_GEOJSON) _geoWriterString(w, "[");
+    for (int v = 0; v < numVerts; v++) _geoWriterCoord(w, &verts[v], v == 0);
+    if (numVerts > 0) _geoWriterCoord(w, &verts[0], 0);
+    if (w->format == GEO_WRITER_GEOJSON) _geoWriterString(w, "]");
+}
+
+/**
+ * geoWriterPolygon writes a polygon without holes, as a line string closed
+ * by its first vertex in KML.
+ *
+ * @param w The writer
+ * @param verts The vertices of the polygon, not closed
+ * @param numVerts The number of vertices
+ * @param name The name of the polygon
+ */
+void geoWriterPolygon(GeoWriter* w, const GeoCoord* verts, int numVerts,
+                      const char* name) {
+    _geoWriterBeginFeature(w, name, "Polygon");
+    if (w->format == GEO_WRITER_KML) {
+        _geoWriterString(w,
+                         "      <styleUrl>#lineStyle1</styleUrl>\n"
+                         "      <LineString>\n"
+                         "         <tessellate>1</tessellate>\n"
+                         "         <coordinates>\n");
+        _geoWriterRing(w, verts, numVerts);
+        _geoWriterString(w,
+                         "         </coordinates>\n"
+                         "      </LineString>\n");
+    } else {
+        _geoWriterString(w, "[");
+        _geoWriterRing(w, verts, numVerts);
+        _geoWriterString(w, "]");
+    }
+    _geoWriterEndFeature(w);
+}
+
+/**
+ * geoWriterBoundary writes a cell boundary.
+ *
+ * @param w The writer
+ * @param b The boundary
+ * @param name The name of the cell
+ */
+void geoWriterBoundary(GeoWriter* w, const GeoBoundary* b, const char* name) {
+    geoWriterPolygon(w, b->verts, b->numVerts, name);
+}
+
+/**
+ * Appends a loop of a linked polygon, as a ring closed by its first vertex.
+ */
+static void _geoWriterLinkedLoop(GeoWriter* w, const LinkedGeoLoop* loop) {
+    if (w->format == GEO_WRITER_GEOJSON) _geoWriterString(w, "[");
+    for (const LinkedGeoCoord* c = loop->first; c; c = c->next) {
+        _geoWriterCoord(w, &c->vertex, c == loop->first);
+    }
+    if (loop->first) _geoWriterCoord(w, &loop->first->vertex, 0);
+    if (w->format == GEO_WRITER_GEOJSON) _geoWriterString(w, "]");
+}
+
+/**
+ * geoWriterLinkedGeo writes the polygons of a linked geo structure, such as
+ * the outline from h3SetToLinkedGeo, as one multipolygon. The first loop of
+ * each polygon is its outer loop, and the others its holes.
+ *
+ * @param w The writer
+ * @param polygon The first polygon of the structure
+ * @param name The name of the multipolygon
+ */
+void geoWriterLinkedGeo(GeoWriter* w, const LinkedGeoPolygon* polygon,
+                        const char* name) {
+    _geoWriterBeginFeature(w, name, "MultiPolygon");
+    if (w->format == GEO_WRITER_KML) {
+        _geoWriterString(w,
+                         "      <styleUrl>#lineStyle1</styleUrl>\n"
+                         "      <MultiGeometry>\n");
+        for (const LinkedGeoPolygon* p = polygon; p; p = p->next) {
+            if (!p->first) continue;
+            _geoWriterString(w, "      <Polygon>\n");
+            for (const LinkedGeoLoop* loop = p->first; loop;
+                 loop = loop->next) {
+                const char* boundary =
+                    loop == p->first ? "outerBoundaryIs" : "innerBoundaryIs";
+                _geoWriterString(w, "         <");
+                _geoWriterString(w, boundary);
+                _geoWriterString(w, "><LinearRing><coordinates>\n");
+                _geoWriterLinkedLoop(w, loop);
+                _geoWriterString(w, "         </coordinates></LinearRing></");
+                _geoWriterString(w, boundary);
+                _geoWriterString(w, ">\n");
+            }
+            _geoWriterString(w, "      </Polygon>\n");
+        }
+        _geoWriterString(w, "      </MultiGeometry>\n");
+    } else {
+        _geoWriterString(w, "[");
+        int numPolygons = 0;
+        for (const LinkedGeoPolygon* p = polygon; p; p = p->next) {
+            if (!p->first) continue;
+            _geoWriterString(w, numPolygons++ ? ",[" : "[");
+            for (const LinkedGeoLoop* loop = p->first; loop;
+                 loop = loop->next) {
+                if (loop != p->first) _geoWriterString(w, ",");
+                _geoWriterLinkedLoop(w, loop);
+            }
+            _geoWriterString(w, "]");
+        }
+        _geoWriterString(w, "]");
+    }
+    _geoWriterEndFeature(w);
+}
+
+/**
+ * geoWriterClose ends the document, writes out the remaining output and
+ * frees the writer. The file is flushed, but not closed.
+ *
+ * @param w The writer
+ */
+void geoWriterClose(GeoWriter* w) {
+    if (w->format == GEO_WRITER_KML) {
+        _geoWriterString(w, "</Document>\n</kml>\n");
+    } else {
+        _geoWriterString(w, "\n]}\n");
+    }
+    _geoWriterFlush(w);
+    if (fflush(w->f)) error("writing output");
+    free(w);
+}
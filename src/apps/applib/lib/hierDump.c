@@ -0,0 +1,314 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file hierDump.c
+ * @brief Parallel enumeration of the descendants of cells, written to shards.
+ *
+ * The root cells are split into partitions, their descendants at a
+ * resolution coarse enough that there are a few dozen per thread, and the
+ * partitions enumerated by a pool of threads. Each thread writes the cells
+ * of its partitions to a shard of its own, a block at a time, so no output
+ * is shared between threads and every shard is a complete output by
+ * itself. Without threads, everything is enumerated in order to one shard.
+ */
+
+#include "hierDump.h"
+#include <stdlib.h>
+#include <string.h>
+#include "baseCells.h"
+#include "binaryIO.h"
+#include "h3Index.h"
+#include "utility.h"
+
+#ifdef H3_APP_THREADS
+#include <pthread.h>
+#include "threadPool.h"
+#endif
+
+/** @brief Cells enumerated, and not yet written */
+typedef struct {
+    const HierOutput* output;  ///< the output, or NULL to only collect
+    void* shard;               ///< the shard written to
+    H3Index* cells;            ///< the cells
+    int numCells;              ///< the number of cells
+    int capacity;              ///< the number of cells before writing
+} HierBlock;
+
+/**
+ * Writes the cells of a block to its shard, and empties it.
+ */
+static void _hierFlush(HierBlock* block) {
+    if (block->numCells > 0 && block->output != NULL) {
+        block->output->write(block->shard, block->cells, block->numCells);
+        block->numCells = 0;
+    }
+}
+
+/**
+ * Adds a cell to a block, writing the block when it is full.
+ */
+static void _hierAdd(HierBlock* block, H3Index h) {
+    block->cells[block->numCells++] = h;
+    if (block->numCells == block->capacity) _hierFlush(block);
+}
+
+/**
+ * Adds the descendants of a cell under digit r and finer, in order.
+ *
+ * @param h The cell, with the resolution of the descendants
+ * @param r The first digit to enumerate
+ * @param block The block the descendants are added to
+ */
+static void _hierRecurse(H3Index h, int r, HierBlock* block) {
+    for (int d = 0; d < 7; d++) {
+        H3_SET_INDEX_DIGIT(h, r, d);
+
+        // skip the pentagonal deleted subsequence
+
+        if (_isBaseCellPentagon(H3_GET_BASE_CELL(h)) &&
+            _h3LeadingNonZeroDigit(h) == 1) {
+            continue;
+        }
+
+        if (r == H3_GET_RESOLUTION(h)) {
+            _hierAdd(block, h);
+        } else {
+            _hierRecurse(h, r + 1, block);
+        }
+    }
+}
+
+/**
+ * Adds the descendants of a cell at a resolution, or the cell itself if it
+ * is no coarser than the resolution.
+ */
+static void _hierEnumerate(H3Index root, int res, HierBlock* block) {
+    int rootRes = H3_GET_RESOLUTION(root);
+    if (res <= rootRes) {
+        _hierAdd(block, root);
+    } else {
+        H3_SET_RESOLUTION(root, res);
+        _hierRecurse(root, rootRes + 1, block);
+    }
+}
+
+#ifdef H3_APP_THREADS
+/** @brief The partitions enumerated by a pool, and its free shards */
+typedef struct {
+    const HierOutput* output;  ///< the output
+    const H3Index* parts;      ///< the partitions
+    int res;                   ///< the resolution enumerated
+    void** freeShards;         ///< the shards no task is writing to
+    int numFree;               ///< the number of free shards
+    pthread_mutex_t lock;      ///< guards freeShards and numFree
+} HierJob;
+
+/**
+ * Enumerates a range of partitions to a free shard. At most one task runs
+ * per thread of the pool, so there is always a free shard.
+ */
+static void _hierTask(void* data, int begin, int end) {
+    HierJob* job = data;
+    pthread_mutex_lock(&job->lock);
+    void* shard = job->freeShards[--job->numFree];
+    pthread_mutex_unlock(&job->lock);
+
+    H3Index cells[BINARY_BLOCK_SIZE];
+    HierBlock block = {job->output, shard, cells, 0, BINARY_BLOCK_SIZE};
+    for (int p = begin; p < end; p++) {
+        _hierEnumerate(job->parts[p], job->res, &block);
+    }
+    _hierFlush(&block);
+
+    pthread_mutex_lock(&job->lock);
+    job->freeShards[job->numFree++] = shard;
+    pthread_mutex_unlock(&job->lock);
+}
+
+/**
+ * Enumerates the descendants of the roots with a pool of threads.
+ *
+ * @return 0 on success, or 1 if the pool could not be created
+ */
+static int _hierDumpParallel(const H3Index* roots, int numRoots, int res,
+                             int numThreads, const HierOutput* output) {
+    ThreadPool* pool = createThreadPool(numThreads);
+    if (pool == NULL) return 1;
+    int numShards = threadPoolSize(pool);
+
+    // Refine the roots until there are enough partitions to balance
+    int rootRes = H3_GET_RESOLUTION(roots[0]);
+    int partRes = rootRes;
+    long long numParts = numRoots;
+    while (partRes < res &&
+           numParts < (long long)numShards * HIER_DUMP_PARTITIONS_PER_THREAD) {
+        partRes++;
+        numParts *= 7;
+    }
+    H3Index* parts = malloc(numParts * sizeof(H3Index));
+    if (parts == NULL) error("allocating partitions");
+    HierBlock collect = {NULL, NULL, parts, 0, (int)numParts + 1};
+    for (int i = 0; i < numRoots; i++) {
+        _hierEnumerate(roots[i], partRes, &collect);
+    }
+
+    HierJob job;
+    job.output = output;
+    job.parts = parts;
+    job.res = res;
+    job.freeShards = malloc(numShards * sizeof(void*));
+    if (job.freeShards == NULL) error("allocating shards");
+    job.numFree = numShards;
+    pthread_mutex_init(&job.lock, NULL);
+    for (int s = 0; s < numShards; s++) {
+        job.freeShards[s] = output->open(output->context, s, numShards);
+    }
+
+    threadPoolFor(pool, collect.numCells, _hierTask, &job);
+
+    for (int s = 0; s < numShards; s++) {
+        output->close(job.freeShards[s]);
+    }
+    pthread_mutex_destroy(&job.lock);
+    free(job.freeShards);
+    free(parts);
+    destroyThreadPool(pool);
+    return 0;
+}
+#endif
+
+/**
+ * Enumerates the descendants of a cell, or of every base cell, at a
+ * resolution, and writes them to shards. A cell no coarser than the
+ * resolution is written by itself.
+ *
+ * With one thread, or where the applications are built without threads,
+ * the cells are written in order to a single shard. Otherwise the cells are
+ * split up between one shard per thread, in no particular order.
+ *
+ * @param root The cell, or 0 for the whole globe
+ * @param res The resolution of the descendants
+ * @param numThreads The number of threads, or 0 for one per processor
+ * @param output The shards
+ */
+void hierDump(H3Index root, int res, int numThreads, const HierOutput* output) {
+    H3Index roots[NUM_BASE_CELLS];
+    int numRoots = 0;
+    if (root == 0) {
+        for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+            H3Index h = H3_INIT;
+            H3_SET_MODE(h, H3_HEXAGON_MODE);
+            H3_SET_BASE_CELL(h, bc);
+            roots[numRoots++] = h;
+        }
+    } else {
+        roots[numRoots++] = root;
+    }
+
+#ifdef H3_APP_THREADS
+    if (numThreads != 1 && res > H3_GET_RESOLUTION(roots[0]) &&
+        _hierDumpParallel(roots, numRoots, res, numThreads, output) == 0) {
+        return;
+    }
+#else
+    (void)numThreads;
+#endif
+
+    void* shard = output->open(output->context, 0, 1);
+    H3Index cells[BINARY_BLOCK_SIZE];
+    HierBlock block = {output, shard, cells, 0, BINARY_BLOCK_SIZE};
+    for (int i = 0; i < numRoots; i++) {
+        _hierEnumerate(roots[i], res, &block);
+    }
+    _hierFlush(&block);
+    output->close(shard);
+}
+
+/**
+ * Parses and removes the options common to the hierarchy applications,
+ * `--threads n`, `--output prefix` and `--binary`, from the arguments,
+ * leaving the rest in order. Exits with an error on an invalid option.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, with the options removed
+ * @param options Output options
+ * @return The number of arguments left
+ */
+int hierParseOptions(int argc, char* argv[], HierOptions* options) {
+    options->numThreads = 1;
+    options->output = NULL;
+    options->binary = 0;
+    int numArgs = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0) {
+            if (++i == argc || !sscanf(argv[i], "%d", &options->numThreads) ||
+                options->numThreads < 0) {
+                error("--threads must be a non-negative integer");
+            }
+        } else if (strcmp(argv[i], "--output") == 0) {
+            if (++i == argc) error("--output needs a prefix");
+            options->output = argv[i];
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            options->binary = 1;
+        } else {
+            argv[numArgs++] = argv[i];
+        }
+    }
+#ifndef H3_APP_THREADS
+    if (options->numThreads > 1) error("built without threads");
+    options->numThreads = 1;
+#endif
+    if (options->numThreads != 1 && options->output == NULL) {
+        error("--threads needs --output");
+    }
+    return numArgs;
+}
+
+/**
+ * Opens the file of a shard, `prefix.shard`, or stdout without a prefix;
+ * exits with an error if it cannot be opened.
+ *
+ * @param options The options
+ * @param shard The shard
+ * @return The file
+ */
+FILE* hierOpenShard(const HierOptions* options, int shard) {
+    FILE* f = stdout;
+    if (options->output != NULL) {
+        size_t size = strlen(options->output) + 16;
+        char* path = malloc(size);
+        if (path == NULL) error("allocating shard name");
+        snprintf(path, size, "%s.%d", options->output, shard);
+        f = fopen(path, options->binary ? "wb" : "w");
+        free(path);
+        if (f == NULL) error("opening shard");
+    } else if (options->binary) {
+        binaryMode(f);
+    }
+    return f;
+}
+
+/**
+ * Closes a file opened by hierOpenShard, or flushes stdout.
+ *
+ * @param f The file
+ */
+void hierCloseShard(FILE* f) {
+    if (f == stdout) {
+        if (fflush(f)) error("writing output");
+    } else if (fclose(f)) {
+        error("writing shard");
+    }
+}
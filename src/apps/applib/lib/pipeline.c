@@ -0,0 +1,572 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file pipeline.c
+ * @brief In-process pipelines of filter stages, passing binary batches
+ * between stages.
+ *
+ * The input is read a batch at a time, and each batch is passed through
+ * the stages in turn and written, with no text between stages. With
+ * threads, the reader, every stage and the writer run concurrently: each
+ * stage runs on a group of worker threads taking batches from the queue
+ * of the stage before it, and the writer takes them from the queue of the
+ * last stage. A queue is a ring of slots indexed by the number of the
+ * batch, so at most as many batches as it has slots are waiting between two
+ * stages, and batches leave it in the order they were read, whichever
+ * worker finished them first. Without threads, the batches are run through
+ * the stages one at a time.
+ */
+
+#include "pipeline.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binaryIO.h"
+#include "constants.h"
+#include "utility.h"
+
+#ifdef H3_APP_THREADS
+#include <pthread.h>
+#endif
+
+/** bytes of text formatted before it is written */
+#define PIPE_TEXT_BLOCK_SIZE (1 << 16)
+
+/** most bytes of text formatted for one record */
+#define PIPE_MAX_RECORD_TEXT 1024
+
+/**
+ * Allocates a batch, with room for some records of a kind.
+ *
+ * @param kind The kind of the records
+ * @param capacity The number of records
+ * @return The batch, which must be freed with pipeDestroyBatch
+ */
+PipeBatch* pipeCreateBatch(PipeKind kind, int capacity) {
+    PipeBatch* batch = calloc(1, sizeof(PipeBatch));
+    if (batch == NULL) error("allocating batch");
+    batch->kind = kind;
+    if (capacity < 1) capacity = 1;
+    if (kind == PIPE_COORDS) {
+        batch->lat = malloc(capacity * sizeof(double));
+        batch->lon = malloc(capacity * sizeof(double));
+        if (batch->lat == NULL || batch->lon == NULL) error("allocating batch");
+    } else {
+        batch->indexes = malloc(capacity * sizeof(H3Index));
+        if (batch->indexes == NULL) error("allocating batch");
+    }
+    if (kind == PIPE_BOUNDARIES) {
+        batch->boundaries = malloc(capacity * sizeof(GeoBoundary));
+        if (batch->boundaries == NULL) error("allocating batch");
+    }
+    return batch;
+}
+
+/**
+ * Frees a batch allocated by pipeCreateBatch.
+ *
+ * @param batch The batch
+ */
+void pipeDestroyBatch(PipeBatch* batch) {
+    free(batch->indexes);
+    free(batch->lat);
+    free(batch->lon);
+    free(batch->boundaries);
+    free(batch);
+}
+
+/**
+ * Indexes lat/lon pairs at resolution res, as geoToH3 does.
+ */
+static PipeBatch* _pipeEncode(int res, PipeBatch* in) {
+    int n = in->numRecords;
+    PipeBatch* out = pipeCreateBatch(PIPE_INDEXES, n);
+    for (int i = 0; i < n; i++) {
+        in->lat[i] = H3_EXPORT(degsToRads)(in->lat[i]);
+        in->lon[i] = H3_EXPORT(degsToRads)(in->lon[i]);
+    }
+    H3_EXPORT(geoToH3Batch)(in->lat, in->lon, n, res, out->indexes);
+    out->numRecords = n;
+    pipeDestroyBatch(in);
+    return out;
+}
+
+/**
+ * Replaces each index by its k-ring, without the empty slots, as kRing
+ * does.
+ */
+static PipeBatch* _pipeKring(int k, PipeBatch* in) {
+    int maxSize = H3_EXPORT(maxKringSize)(k);
+    PipeBatch* out = pipeCreateBatch(PIPE_INDEXES, in->numRecords * maxSize);
+    int count = 0;
+    for (int c = 0; c < in->numRecords; c++) {
+        H3Index* ring = &out->indexes[count];
+        memset(ring, 0, maxSize * sizeof(H3Index));
+        H3_EXPORT(kRing)(in->indexes[c], k, ring);
+        for (int i = 0; i < maxSize; i++) {
+            if (ring[i] != 0) out->indexes[count++] = ring[i];
+        }
+    }
+    out->numRecords = count;
+    pipeDestroyBatch(in);
+    return out;
+}
+
+/**
+ * Replaces each index by its parent at resolution res.
+ */
+static PipeBatch* _pipeParent(int res, PipeBatch* in) {
+    for (int i = 0; i < in->numRecords; i++) {
+        in->indexes[i] = H3_EXPORT(h3ToParent)(in->indexes[i], res);
+    }
+    return in;
+}
+
+/**
+ * Replaces each index by the lat/lon of its center, as h3ToGeo does.
+ */
+static PipeBatch* _pipeCenter(int arg, PipeBatch* in) {
+    (void)arg;
+    int n = in->numRecords;
+    PipeBatch* out = pipeCreateBatch(PIPE_COORDS, n);
+    H3_EXPORT(h3ToGeoBatch)(in->indexes, n, out->lat, out->lon);
+    for (int i = 0; i < n; i++) {
+        out->lat[i] = H3_EXPORT(radsToDegs)(out->lat[i]);
+        out->lon[i] = H3_EXPORT(radsToDegs)(out->lon[i]);
+    }
+    out->numRecords = n;
+    pipeDestroyBatch(in);
+    return out;
+}
+
+/**
+ * Adds the cell boundary of each index, as h3ToGeoBoundary does.
+ */
+static PipeBatch* _pipeBoundary(int arg, PipeBatch* in) {
+    (void)arg;
+    int n = in->numRecords;
+    PipeBatch* out = pipeCreateBatch(PIPE_BOUNDARIES, n);
+    memcpy(out->indexes, in->indexes, n * sizeof(H3Index));
+    for (int i = 0; i < n; i++) {
+        H3_EXPORT(h3ToGeoBoundary)(in->indexes[i], &out->boundaries[i]);
+    }
+    out->numRecords = n;
+    pipeDestroyBatch(in);
+    return out;
+}
+
+/** @brief A stage a pipeline may have, and the range of its argument */
+typedef struct {
+    PipeStage stage;  ///< the stage, with no argument
+    int hasArg;       ///< whether it takes an argument
+    int minArg;       ///< the smallest argument
+    int maxArg;       ///< the largest argument
+} PipeStageDef;
+
+static const PipeStageDef _pipeStages[] = {
+    {{"encode", PIPE_COORDS, PIPE_INDEXES, 0, _pipeEncode}, 1, 0, MAX_H3_RES},
+    {{"kring", PIPE_INDEXES, PIPE_INDEXES, 0, _pipeKring}, 1, 0, PIPE_MAX_K},
+    {{"parent", PIPE_INDEXES, PIPE_INDEXES, 0, _pipeParent}, 1, 0, MAX_H3_RES},
+    {{"center", PIPE_INDEXES, PIPE_COORDS, 0, _pipeCenter}, 0, 0, 0},
+    {{"boundary", PIPE_INDEXES, PIPE_BOUNDARIES, 0, _pipeBoundary}, 0, 0, 0}};
+
+/**
+ * Parses a stage, `encode:res`, `kring:k`, `parent:res`, `center` or
+ * `boundary`.
+ *
+ * @param spec The stage
+ * @param stage Output stage
+ * @return 0 on success, or 1 if the stage is unknown or its argument is
+ * missing or out of range
+ */
+int pipeParseStage(const char* spec, PipeStage* stage) {
+    const char* colon = strchr(spec, ':');
+    size_t nameLength = colon ? (size_t)(colon - spec) : strlen(spec);
+    int numDefs = sizeof(_pipeStages) / sizeof(_pipeStages[0]);
+    for (int d = 0; d < numDefs; d++) {
+        const PipeStageDef* def = &_pipeStages[d];
+        if (strlen(def->stage.name) != nameLength ||
+            strncmp(def->stage.name, spec, nameLength) != 0) {
+            continue;
+        }
+        *stage = def->stage;
+        if (!def->hasArg) return colon != NULL;
+        if (colon == NULL || colon[1] == '\0') return 1;
+        char* end;
+        long arg = strtol(colon + 1, &end, 10);
+        if (*end != '\0' || arg < def->minArg || arg > def->maxArg) return 1;
+        stage->arg = (int)arg;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Determines how many records the k-ring stages of a pipeline may expand
+ * each record read to, up to just over PIPE_MAX_BATCH_RECORDS.
+ */
+static long long _pipeGrowth(const PipeStage* stages, int numStages) {
+    long long growth = 1;
+    for (int s = 0; s < numStages; s++) {
+        if (stages[s].run == _pipeKring && growth <= PIPE_MAX_BATCH_RECORDS) {
+            growth *= H3_EXPORT(maxKringSize)(stages[s].arg);
+        }
+    }
+    return growth;
+}
+
+/**
+ * Checks that each stage of a pipeline reads the kind of records the stage
+ * before it writes.
+ *
+ * @param stages The stages
+ * @param numStages The number of stages
+ * @param options The options
+ * @return NULL if the pipeline can run, or a description of the problem
+ */
+const char* pipeCheck(const PipeStage* stages, int numStages,
+                      const PipeOptions* options) {
+    if (numStages < 1) return "no stages";
+    if (numStages > PIPE_MAX_STAGES) return "too many stages";
+    for (int s = 1; s < numStages; s++) {
+        if (stages[s].input != stages[s - 1].output) {
+            return "stage does not read what the stage before it writes";
+        }
+    }
+    if (_pipeGrowth(stages, numStages) > PIPE_MAX_BATCH_RECORDS) {
+        return "k-rings expand each record to too many records";
+    }
+    if (options->binary && stages[numStages - 1].output == PIPE_BOUNDARIES) {
+        return "boundaries have no binary output";
+    }
+    return NULL;
+}
+
+/**
+ * Reads a batch of records of a kind, as text lines of `lat lon` pairs or
+ * hexadecimal indexes, or packed as described in binaryIO.h.
+ *
+ * @return The batch, or NULL at the end of the input
+ */
+static PipeBatch* _pipeRead(PipeKind kind, int maxRecords, int binary,
+                            FILE* in) {
+    PipeBatch* batch = pipeCreateBatch(kind, maxRecords);
+    int n = 0;
+    if (binary) {
+        while (n < maxRecords) {
+            int count = kind == PIPE_COORDS
+                            ? binaryReadCoords(in, &batch->lat[n],
+                                               &batch->lon[n], maxRecords - n)
+                            : binaryReadIndexes(in, &batch->indexes[n],
+                                                maxRecords - n);
+            if (count == 0) break;
+            n += count;
+        }
+    } else {
+        char buff[BUFF_SIZE];
+        while (n < maxRecords && fgets(buff, BUFF_SIZE, in)) {
+            if (kind == PIPE_COORDS) {
+                char* end;
+                batch->lat[n] = strtod(buff, &end);
+                char* lonStart = end;
+                batch->lon[n] = strtod(lonStart, &end);
+                if (lonStart == buff || end == lonStart) {
+                    error("parsing lat/lon");
+                }
+            } else {
+                // as stringToH3, 0 for anything else
+                batch->indexes[n] = strtoull(buff, NULL, 16);
+            }
+            n++;
+        }
+        if (ferror(in)) error("reading input");
+    }
+    if (n == 0) {
+        pipeDestroyBatch(batch);
+        return NULL;
+    }
+    batch->numRecords = n;
+    return batch;
+}
+
+/**
+ * Writes a block of formatted text.
+ */
+static void _pipeWriteText(const char* text, size_t size, FILE* out) {
+    if (fwrite(text, 1, size, out) != size) error("writing output");
+}
+
+/**
+ * Writes a batch, as text in the formats of the kRing, h3ToGeo and
+ * h3ToGeoBoundary filters, or packed as described in binaryIO.h.
+ */
+static void _pipeWrite(const PipeBatch* batch, int binary, FILE* out) {
+    if (binary) {
+        if (batch->kind == PIPE_COORDS) {
+            binaryWriteCoords(out, batch->lat, batch->lon, batch->numRecords);
+        } else {
+            binaryWriteIndexes(out, batch->indexes, batch->numRecords);
+        }
+        return;
+    }
+
+    char text[PIPE_TEXT_BLOCK_SIZE];
+    size_t size = 0;
+    for (int i = 0; i < batch->numRecords; i++) {
+        if (size > PIPE_TEXT_BLOCK_SIZE - PIPE_MAX_RECORD_TEXT) {
+            _pipeWriteText(text, size, out);
+            size = 0;
+        }
+        char* t = &text[size];
+        size_t room = PIPE_TEXT_BLOCK_SIZE - size;
+        if (batch->kind == PIPE_COORDS) {
+            size += snprintf(t, room, "%.10lf %.10lf\n", batch->lat[i],
+                             batch->lon[i]);
+        } else if (batch->kind == PIPE_INDEXES) {
+            size += snprintf(t, room, "%" PRIx64 "\n", batch->indexes[i]);
+        } else {
+            const GeoBoundary* b = &batch->boundaries[i];
+            size += snprintf(t, room, "%" PRIx64 "\n{\n", batch->indexes[i]);
+            for (int v = 0; v < b->numVerts; v++) {
+                size += snprintf(&text[size], PIPE_TEXT_BLOCK_SIZE - size,
+                                 "   %.9lf %.9lf\n",
+                                 H3_EXPORT(radsToDegs)(b->verts[v].lat),
+                                 H3_EXPORT(radsToDegs)(b->verts[v].lon));
+            }
+            size += snprintf(&text[size], PIPE_TEXT_BLOCK_SIZE - size, "}\n");
+        }
+    }
+    _pipeWriteText(text, size, out);
+}
+
+/**
+ * Runs a batch through the stages.
+ */
+static PipeBatch* _pipeRunStages(const PipeStage* stages, int numStages,
+                                 PipeBatch* batch) {
+    for (int s = 0; s < numStages; s++) {
+        batch = stages[s].run(stages[s].arg, batch);
+    }
+    return batch;
+}
+
+#ifdef H3_APP_THREADS
+/** @brief Batches waiting between two stages, by batch number */
+typedef struct {
+    PipeBatch** slots;      ///< the batches, at their number modulo numSlots
+    int numSlots;           ///< the number of slots
+    long long head;         ///< the number of the next batch taken
+    long long end;          ///< the number of batches, or -1 until known
+    pthread_mutex_t lock;   ///< guards every field
+    pthread_cond_t change;  ///< signalled when a batch is added or taken
+} PipeQueue;
+
+/** @brief The workers of a stage, or the writer */
+typedef struct {
+    const PipeStage* stage;  ///< the stage, or NULL for the writer
+    PipeQueue* in;           ///< the queue batches are taken from
+    PipeQueue* out;          ///< the queue batches are added to
+    int numRunning;          ///< the number of workers not yet finished
+    pthread_mutex_t lock;    ///< guards numRunning
+    int binary;              ///< for the writer, the output format
+    FILE* file;              ///< for the writer, the output
+} PipeWorkers;
+
+static void _pipeQueueInit(PipeQueue* q, int numSlots) {
+    q->slots = calloc(numSlots, sizeof(PipeBatch*));
+    if (q->slots == NULL) error("allocating queue");
+    q->numSlots = numSlots;
+    q->head = 0;
+    q->end = -1;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->change, NULL);
+}
+
+static void _pipeQueueDestroy(PipeQueue* q) {
+    pthread_cond_destroy(&q->change);
+    pthread_mutex_destroy(&q->lock);
+    free(q->slots);
+}
+
+/**
+ * Adds batch number seq to a queue, waiting until its slot is free.
+ */
+static void _pipeQueuePut(PipeQueue* q, long long seq, PipeBatch* batch) {
+    pthread_mutex_lock(&q->lock);
+    while (seq >= q->head + q->numSlots) {
+        pthread_cond_wait(&q->change, &q->lock);
+    }
+    q->slots[seq % q->numSlots] = batch;
+    pthread_cond_broadcast(&q->change);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * Takes the next batch of a queue, waiting until it is added.
+ *
+ * @param seq Output number of the batch
+ * @return The batch, or NULL after the last batch
+ */
+static PipeBatch* _pipeQueueTake(PipeQueue* q, long long* seq) {
+    pthread_mutex_lock(&q->lock);
+    PipeBatch* batch;
+    while ((batch = q->slots[q->head % q->numSlots]) == NULL &&
+           q->head != q->end) {
+        pthread_cond_wait(&q->change, &q->lock);
+    }
+    if (batch != NULL) {
+        q->slots[q->head % q->numSlots] = NULL;
+        *seq = q->head++;
+        pthread_cond_broadcast(&q->change);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return batch;
+}
+
+/**
+ * Records the number of batches of a queue, once all are added.
+ */
+static void _pipeQueueClose(PipeQueue* q, long long end) {
+    pthread_mutex_lock(&q->lock);
+    q->end = end;
+    pthread_cond_broadcast(&q->change);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * Runs a worker of a stage, or the writer, until the queue it takes from
+ * is empty. The last worker of a stage to finish closes the next queue.
+ */
+static void* _pipeWorker(void* data) {
+    PipeWorkers* workers = data;
+    PipeBatch* batch;
+    long long seq;
+    while ((batch = _pipeQueueTake(workers->in, &seq)) != NULL) {
+        if (workers->stage == NULL) {
+            _pipeWrite(batch, workers->binary, workers->file);
+            pipeDestroyBatch(batch);
+        } else {
+            batch = workers->stage->run(workers->stage->arg, batch);
+            _pipeQueuePut(workers->out, seq, batch);
+        }
+    }
+    if (workers->out != NULL) {
+        pthread_mutex_lock(&workers->lock);
+        int last = --workers->numRunning == 0;
+        pthread_mutex_unlock(&workers->lock);
+        if (last) _pipeQueueClose(workers->out, workers->in->end);
+    }
+    return NULL;
+}
+
+/**
+ * Runs a pipeline with a group of threads for each stage and a thread for
+ * the writer, reading on the calling thread.
+ */
+static void _pipeRunParallel(const PipeStage* stages, int numStages,
+                             const PipeOptions* options, int maxRecords,
+                             FILE* in, FILE* out) {
+    int numWorkers = options->numWorkers;
+    PipeQueue queues[PIPE_MAX_STAGES + 1];
+    PipeWorkers workers[PIPE_MAX_STAGES + 1];
+    pthread_t* threads =
+        malloc((numStages * numWorkers + 1) * sizeof(pthread_t));
+    if (threads == NULL) error("allocating threads");
+    for (int q = 0; q <= numStages; q++) {
+        _pipeQueueInit(&queues[q], 2 * numWorkers + 2);
+    }
+
+    int numThreads = 0;
+    for (int s = 0; s <= numStages; s++) {
+        PipeWorkers* w = &workers[s];
+        w->stage = s < numStages ? &stages[s] : NULL;
+        w->in = &queues[s];
+        w->out = s < numStages ? &queues[s + 1] : NULL;
+        w->numRunning = s < numStages ? numWorkers : 1;
+        pthread_mutex_init(&w->lock, NULL);
+        w->binary = options->binary;
+        w->file = out;
+        for (int t = 0; t < w->numRunning; t++) {
+            if (pthread_create(&threads[numThreads++], NULL, _pipeWorker, w)) {
+                error("creating threads");
+            }
+        }
+    }
+
+    long long seq = 0;
+    PipeBatch* batch;
+    while ((batch = _pipeRead(stages[0].input, maxRecords, options->binary,
+                              in)) != NULL) {
+        _pipeQueuePut(&queues[0], seq++, batch);
+    }
+    _pipeQueueClose(&queues[0], seq);
+
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int s = 0; s <= numStages; s++) {
+        pthread_mutex_destroy(&workers[s].lock);
+    }
+    for (int q = 0; q <= numStages; q++) {
+        _pipeQueueDestroy(&queues[q]);
+    }
+    free(threads);
+}
+#endif
+
+/**
+ * Runs a pipeline checked by pipeCheck, from one input to one output, with
+ * the records written in the order they are read. Exits with an error if
+ * reading or writing fails.
+ *
+ * Batches are read small enough that the stages expand them to at most
+ * PIPE_MAX_BATCH_RECORDS records.
+ *
+ * @param stages The stages
+ * @param numStages The number of stages
+ * @param options The options; without threads, numWorkers is ignored and
+ * the pipeline runs on the calling thread
+ * @param in The input
+ * @param out The output
+ */
+void pipeRun(const PipeStage* stages, int numStages,
+             const PipeOptions* options, FILE* in, FILE* out) {
+    if (options->binary) {
+        binaryMode(in);
+        binaryMode(out);
+    }
+    long long growth = _pipeGrowth(stages, numStages);
+    int maxRecords = BINARY_BLOCK_SIZE;
+    if (growth * maxRecords > PIPE_MAX_BATCH_RECORDS) {
+        maxRecords = (int)(PIPE_MAX_BATCH_RECORDS / growth);
+    }
+
+#ifdef H3_APP_THREADS
+    if (options->numWorkers >= 1) {
+        _pipeRunParallel(stages, numStages, options, maxRecords, in, out);
+        if (fflush(out)) error("writing output");
+        return;
+    }
+#endif
+
+    PipeBatch* batch;
+    while ((batch = _pipeRead(stages[0].input, maxRecords, options->binary,
+                              in)) != NULL) {
+        batch = _pipeRunStages(stages, numStages, batch);
+        _pipeWrite(batch, options->binary, out);
+        pipeDestroyBatch(batch);
+    }
+    if (fflush(out)) error("writing output");
+}
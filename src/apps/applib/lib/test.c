@@ -47,3 +47,24 @@ void t_assertBoundary(H3Index h3, const GeoBoundary* b1) {
 }
 
 int testCount() { return globalTestCount; }
+
+// Executors
+
+/**
+ * Executor running the task on small ranges in reverse order, to check that
+ * the ranges are written independently. Counts its calls of the task.
+ *
+ * @param executor The number of calls of the task, an int
+ * @param n The number of items
+ * @param task The task, run on ranges of at most 3 items
+ * @param data The data of the task
+ */
+void reverseParallelFor(void* executor, int n, H3ParallelTask task,
+                        void* data) {
+    int* numCalls = executor;
+    for (int end = n; end > 0; end -= 3) {
+        int begin = end > 3 ? end - 3 : 0;
+        task(data, begin, end);
+        (*numCalls)++;
+    }
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file threadPool.c
+ * @brief A pool of pthreads running H3ParallelFor tasks with work stealing.
+ *
+ * The calling thread works alongside the threads of the pool. Each worker
+ * starts on an equal share of the items, and claims chunks of it one at a
+ * time. A worker that runs out steals the upper half of what remains of
+ * the share of another worker, so uneven items, such as the cells of
+ * polygons of very different sizes, still keep every worker busy until the
+ * end.
+ */
+
+#include "threadPool.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** number of chunks in the share of each worker */
+#define CHUNKS_PER_WORKER 16
+/** bytes an item range is padded to, at least the size of a cache line */
+#define CACHE_LINE 128
+
+/** @brief The items not yet claimed of one worker */
+typedef struct {
+    pthread_mutex_t lock;  ///< guards next and end
+    int next;              ///< the first item not yet claimed
+    int end;               ///< one past the last item
+} WorkerRange;
+
+/** @brief A WorkerRange on cache lines of its own */
+typedef union {
+    WorkerRange range;     ///< the range
+    char pad[CACHE_LINE];  ///< padding
+} PaddedWorkerRange;
+
+/** @brief A thread of a pool */
+typedef struct {
+    ThreadPool* pool;  ///< the pool
+    int id;            ///< the worker, from 1, the caller being worker 0
+    pthread_t thread;  ///< the thread
+} Worker;
+
+struct ThreadPool {
+    int numThreads;             ///< the number of workers, with the caller
+    Worker* workers;            ///< numThreads - 1 threads
+    PaddedWorkerRange* ranges;  ///< the items of each worker
+    pthread_mutex_t lock;       ///< guards every field below
+    pthread_cond_t started;     ///< signalled when a job starts
+    pthread_cond_t finished;    ///< signalled when the last thread finishes
+    unsigned generation;        ///< the number of jobs started
+    int numBusy;                ///< threads still working on the job
+    int shutdown;               ///< whether the threads should exit
+    H3ParallelTask task;        ///< the task of the job
+    void* data;                 ///< the data of the job
+    int chunkSize;              ///< the most items claimed at a time
+};
+
+/**
+ * Claims the next chunk of the items of a worker, stealing some items of
+ * another worker if it has run out.
+ *
+ * @param pool The pool
+ * @param id The worker
+ * @param begin Output first item of the chunk
+ * @param end Output one past the last item of the chunk
+ * @return 1 if a chunk was claimed, 0 if no items are left to claim
+ */
+static int _claimChunk(ThreadPool* pool, int id, int* begin, int* end) {
+    WorkerRange* own = &pool->ranges[id].range;
+    for (;;) {
+        pthread_mutex_lock(&own->lock);
+        if (own->next < own->end) {
+            *begin = own->next;
+            *end = own->end - own->next > pool->chunkSize
+                       ? own->next + pool->chunkSize
+                       : own->end;
+            own->next = *end;
+            pthread_mutex_unlock(&own->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&own->lock);
+
+        // Only one lock is held at a time, so workers stealing from each
+        // other cannot deadlock. The range of this worker stays empty until
+        // the stolen items are moved into it.
+        int stolenBegin = 0;
+        int stolenEnd = 0;
+        for (int k = 1; k < pool->numThreads && stolenBegin == stolenEnd;
+             k++) {
+            WorkerRange* victim =
+                &pool->ranges[(id + k) % pool->numThreads].range;
+            pthread_mutex_lock(&victim->lock);
+            int remaining = victim->end - victim->next;
+            if (remaining > 0) {
+                stolenBegin = victim->next + remaining / 2;
+                stolenEnd = victim->end;
+                victim->end = stolenBegin;
+            }
+            pthread_mutex_unlock(&victim->lock);
+        }
+        if (stolenBegin == stolenEnd) {
+            return 0;
+        }
+        pthread_mutex_lock(&own->lock);
+        own->next = stolenBegin;
+        own->end = stolenEnd;
+        pthread_mutex_unlock(&own->lock);
+    }
+}
+
+/**
+ * Runs chunks of the current job until none are left.
+ *
+ * @param pool The pool
+ * @param id The worker
+ */
+static void _runChunks(ThreadPool* pool, int id) {
+    int begin;
+    int end;
+    while (_claimChunk(pool, id, &begin, &end)) {
+        pool->task(pool->data, begin, end);
+    }
+}
+
+/**
+ * Waits for jobs and works on them, until the pool is destroyed.
+ *
+ * @param arg The Worker
+ */
+static void* _workerMain(void* arg) {
+    Worker* worker = arg;
+    ThreadPool* pool = worker->pool;
+    unsigned seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->started, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        _runChunks(pool, worker->id);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->numBusy == 0) {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Creates a pool of threads.
+ *
+ * @param numThreads The number of threads working on each job, counting the
+ * calling thread, or 0 for the number of online processors
+ * @return The pool, which must be destroyed with destroyThreadPool, or NULL
+ * if the threads could not be created
+ */
+ThreadPool* createThreadPool(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (numThreads < 1) numThreads = 1;
+    }
+    ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) return NULL;
+    pool->workers = calloc(numThreads, sizeof(Worker));
+    pool->ranges = calloc(numThreads, sizeof(PaddedWorkerRange));
+    if (pool->workers == NULL || pool->ranges == NULL) {
+        free(pool->workers);
+        free(pool->ranges);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->started, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    // Worker 0 is the caller, and workers[0] is unused
+    pthread_mutex_init(&pool->ranges[0].range.lock, NULL);
+    pool->numThreads = 1;
+    for (int t = 1; t < numThreads; t++) {
+        pthread_mutex_init(&pool->ranges[t].range.lock, NULL);
+        pool->workers[t].pool = pool;
+        pool->workers[t].id = t;
+        if (pthread_create(&pool->workers[t].thread, NULL, _workerMain,
+                           &pool->workers[t])) {
+            pthread_mutex_destroy(&pool->ranges[t].range.lock);
+            destroyThreadPool(pool);
+            return NULL;
+        }
+        pool->numThreads++;
+    }
+    return pool;
+}
+
+/**
+ * The number of threads working on each job of a pool, counting the calling
+ * thread.
+ *
+ * @param pool The pool
+ * @return The number of threads
+ */
+int threadPoolSize(const ThreadPool* pool) { return pool->numThreads; }
+
+/**
+ * An H3ParallelFor running the task on the threads of a pool, and on the
+ * calling thread. It returns once the task has run on every item. It must
+ * not be called from two threads at once with the same pool, nor from
+ * within one of its own tasks.
+ *
+ * @param executor The ThreadPool
+ * @param n The number of items
+ * @param task The task, run on disjoint ranges covering [0, n)
+ * @param data Passed through to the task
+ */
+void threadPoolFor(void* executor, int n, H3ParallelTask task, void* data) {
+    ThreadPool* pool = executor;
+    if (n <= 0) return;
+    if (pool->numThreads == 1 || n == 1) {
+        task(data, 0, n);
+        return;
+    }
+
+    // No thread is working, so the ranges can be set without their locks;
+    // starting the job under the pool lock publishes them
+    for (int t = 0; t < pool->numThreads; t++) {
+        WorkerRange* range = &pool->ranges[t].range;
+        range->next = (int)((int64_t)n * t / pool->numThreads);
+        range->end = (int)((int64_t)n * (t + 1) / pool->numThreads);
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->data = data;
+    pool->chunkSize = n / (pool->numThreads * CHUNKS_PER_WORKER);
+    if (pool->chunkSize < 1) pool->chunkSize = 1;
+    pool->numBusy = pool->numThreads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->lock);
+
+    _runChunks(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->numBusy > 0) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Stops the threads of a pool and frees it.
+ *
+ * @param pool The pool
+ */
+void destroyThreadPool(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 1; t < pool->numThreads; t++) {
+        pthread_join(pool->workers[t].thread, NULL);
+    }
+    for (int t = 0; t < pool->numThreads; t++) {
+        pthread_mutex_destroy(&pool->ranges[t].range.lock);
+    }
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->started);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->ranges);
+    free(pool->workers);
+    free(pool);
+}
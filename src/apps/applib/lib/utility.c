@@ -163,3 +163,27 @@ int readBoundary(FILE* f, GeoBoundary* b) {
 
     return 0;
 }
+
+/**
+ * Reads lines of an index followed by the latitude and longitude of its
+ * center in degrees, as in the centers files in tests/inputfiles.
+ *
+ * @param f File to read from
+ * @param maxCount Maximum number of lines to read
+ * @param cells Output indexes, with room for maxCount
+ * @param centers Output centers in radians, with room for maxCount
+ * @return Number of lines read, or -1 if a line is malformed
+ */
+int readCenters(FILE* f, int maxCount, H3Index* cells, GeoCoord* centers) {
+    char buff[BUFF_SIZE];
+    char hex[BUFF_SIZE];
+    int n = 0;
+    while (n < maxCount && fgets(buff, BUFF_SIZE, f)) {
+        double lat, lon;
+        if (sscanf(buff, "%s %lf %lf", hex, &lat, &lon) != 3) return -1;
+        cells[n] = H3_EXPORT(stringToH3)(hex);
+        setGeoDegs(&centers[n], lat, lon);
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkAggregate.c
+ * @brief Benchmarks counting and summing 10^6 points by hexagon, against
+ * encoding them into an array, sorting it and counting its runs, and against
+ * encoding them alone.
+ *
+ * The points are spread over a disk about 200 km across, and aggregated at
+ * resolutions 5 and 9, so that hexagons hold many or few points.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define NUM_POINTS 1000000
+
+// Fixtures
+double lat[NUM_POINTS];
+double lon[NUM_POINTS];
+double values[NUM_POINTS];
+H3Index cells[NUM_POINTS];
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+int outInt;
+
+for (int i = 0; i < NUM_POINTS; i++) {
+    double r = 0.015 * sqrt((double)i / NUM_POINTS);
+    lat[i] = 0.659966917655 + r * cos(i * 2.399963);
+    lon[i] = -2.1364398519396 + r * sin(i * 2.399963);
+    values[i] = i % 10;
+}
+
+for (int res = 5; res <= 9; res += 4) {
+    snprintf(name, BUFF_SIZE, "geoToH3Batch_res%02d", res);
+    NAMED_BENCHMARK(name, 3, {
+        H3_EXPORT(geoToH3Batch)(lat, lon, NUM_POINTS, res, cells);
+        DO_NOT_OPTIMIZE(cells);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3AggregatePoints_res%02d", res);
+    NAMED_BENCHMARK(name, 3, {
+        H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(res, 0);
+        H3_EXPORT(h3AggregatePoints)(agg, lat, lon, values, NUM_POINTS);
+        outInt = H3_EXPORT(h3AggregateSize)(agg);
+        DO_NOT_OPTIMIZE(outInt);
+        H3_EXPORT(destroyH3Aggregate)(agg);
+    });
+
+    snprintf(name, BUFF_SIZE, "geoToH3BatchSortCount_res%02d", res);
+    NAMED_BENCHMARK(name, 3, {
+        H3_EXPORT(geoToH3Batch)(lat, lon, NUM_POINTS, res, cells);
+        H3_EXPORT(h3SortCells)(cells, NUM_POINTS);
+        outInt = 0;
+        for (int i = 0; i < NUM_POINTS; i++) {
+            if (i == 0 || cells[i] != cells[i - 1]) outInt++;
+        }
+        DO_NOT_OPTIMIZE(outInt);
+    });
+}
+
+END_BENCHMARKS();
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkBoundaryCache.c
+ * @brief Benchmarks the LRU cache of cell boundaries on zipfian workloads.
+ *
+ * The lookups are drawn from NUM_HOT_CELLS cells of a disk at resolution 9,
+ * the cell of rank r with probability proportional to 1 / r^s. Each
+ * iteration decodes one boundary, with h3ToGeoBoundary or through a cache
+ * holding a tenth or all of the cells, so the time per lookup of the cache
+ * can be compared to decoding. The hit rate of each cache is reported after
+ * it is benchmarked.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "boundaryCache.h"
+#include "h3api.h"
+#include "utility.h"
+
+/** radius of the disk the cells are drawn from */
+#define K 180
+/** number of cells in the disk */
+#define NUM_HOT_CELLS (3 * K * (K + 1) + 1)
+/** number of lookups drawn, cycled through by the benchmarks */
+#define NUM_LOOKUPS (1 << 20)
+
+/** exponents of the zipfian distributions benchmarked */
+static const double exponents[] = {0.8, 1.0, 1.2};
+
+// Fixtures
+H3Index cells[NUM_HOT_CELLS];
+H3Index lookups[NUM_LOOKUPS];
+double cdf[NUM_HOT_CELLS];
+
+/**
+ * Draws the lookups from the cells, with the zipfian distribution of
+ * exponent s. The ranks are shuffled by a multiplicative hash, so hot cells
+ * are spread across the disk.
+ */
+static void drawLookups(double s) {
+    double total = 0;
+    for (int r = 0; r < NUM_HOT_CELLS; r++) {
+        total += 1 / pow(r + 1, s);
+        cdf[r] = total;
+    }
+    srand(1);
+    for (int i = 0; i < NUM_LOOKUPS; i++) {
+        double u = total * rand() / ((double)RAND_MAX + 1);
+        int low = 0;
+        int high = NUM_HOT_CELLS - 1;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (cdf[mid] <= u) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        lookups[i] = cells[(int)((low * 2654435761u) % NUM_HOT_CELLS)];
+    }
+}
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+GeoBoundary outBoundary;
+int next = 0;
+
+H3_EXPORT(kRing)(0x89283470c27ffffl, K, cells);
+
+for (int e = 0; e < (int)(sizeof(exponents) / sizeof(exponents[0])); e++) {
+    drawLookups(exponents[e]);
+    int tenths = (int)(exponents[e] * 10 + 0.5);
+
+    snprintf(name, BUFF_SIZE, "h3ToGeoBoundaryZipf%02d", tenths);
+    NAMED_BENCHMARK(name, 1000000, {
+        H3_EXPORT(h3ToGeoBoundary)(lookups[next++ % NUM_LOOKUPS], &outBoundary);
+        DO_NOT_OPTIMIZE(outBoundary);
+    });
+
+    for (int c = 0; c < 2; c++) {
+        int capacity = c == 0 ? NUM_HOT_CELLS / 10 : NUM_HOT_CELLS;
+        BoundaryCache* cache = createBoundaryCache(capacity, 0);
+        if (cache == NULL) error("creating cache");
+        snprintf(name, BUFF_SIZE, "boundaryCache%sZipf%02d",
+                 c == 0 ? "Tenth" : "All", tenths);
+        NAMED_BENCHMARK(name, 1000000, {
+            boundaryCacheGet(cache, lookups[next++ % NUM_LOOKUPS],
+                             &outBoundary);
+            DO_NOT_OPTIMIZE(outBoundary);
+        });
+        BoundaryCacheStats stats;
+        boundaryCacheStats(cache, &stats);
+        fprintf(stderr, "%s: %.1f%% hits, %zu bytes\n", name,
+                100.0 * stats.hits / (stats.hits + stats.misses),
+                boundaryCacheMemorySize(cache));
+        destroyBoundaryCache(cache);
+    }
+}
+
+END_BENCHMARKS();
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkCompact.c
+ * @brief Benchmarks compact and uncompact on sets of 10^3 to 10^7 cells.
+ *
+ * The sets are filled disks of resolution 9 cells around a fixed hexagon
+ * far from pentagons, so that they compact to a mix of resolutions. compact
+ * takes its working memory from the stack, so it is only benchmarked on sets
+ * up to MAX_STACK_COMPACT; compactWithScratch and compactWithSort are
+ * benchmarked on every set. The sorted set operations combine each
+ * compacted disk with the same disk moved by half its radius. The binary
+ * encoding is benchmarked on every disk and its compacted set. The
+ * compacted sets updated in place are benchmarked building each disk, and
+ * removing and adding back one cell of it at a time, against compacting the
+ * whole disk again. The
+ * bitmaps of every resolution 7 cell are benchmarked on a disk of 10^6
+ * resolution 7 cells and the same disk moved, against adding the cells of
+ * the disk to a hash set.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "h3api.h"
+#include "utility.h"
+
+/** disk sizes benchmarked: 3k^2 + 3k + 1 is about 10^3 to 10^7 */
+#define NUM_DISKS 5
+static const int diskKs[NUM_DISKS] = {18, 57, 182, 577, 1825};
+/** iterations for each disk */
+static const int diskIterations[NUM_DISKS] = {1000, 100, 10, 2, 1};
+
+/** largest set compacted with stack working memory */
+#define MAX_STACK_COMPACT 100000
+
+#define RES 9
+
+/** radius of the disk of resolution 7 cells in the bitmap benchmarks */
+#define BITMAP_K 577
+
+// Fixtures
+H3Index origin = 0x89283080ddbffff;
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+H3Scratch scratch = {0};
+
+for (int t = 0; t < NUM_DISKS; t++) {
+    int k = diskKs[t];
+    int numCells = H3_EXPORT(maxKringSize)(k);
+    H3Index* cells = calloc(numCells, sizeof(H3Index));
+    H3Index* compacted = calloc(numCells, sizeof(H3Index));
+    if (H3_EXPORT(hexRange)(origin, k, cells) != 0) {
+        error("benchmark disk contains a pentagon");
+    }
+
+    if (numCells <= MAX_STACK_COMPACT) {
+        snprintf(name, BUFF_SIZE, "compact_%d", numCells);
+        NAMED_BENCHMARK(name, diskIterations[t], {
+            H3_EXPORT(compact)(cells, compacted, numCells);
+        });
+    }
+
+    snprintf(name, BUFF_SIZE, "compactWithScratch_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(compactWithScratch)(cells, compacted, numCells, &scratch);
+    });
+
+    snprintf(name, BUFF_SIZE, "compactWithSort_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(compactWithSort)(cells, compacted, numCells);
+    });
+
+    int numCompacted = 0;
+    for (int i = 0; i < numCells; i++) {
+        if (compacted[i] != 0) compacted[numCompacted++] = compacted[i];
+    }
+    int maxUncompacted =
+        H3_EXPORT(maxUncompactSize)(compacted, numCompacted, RES);
+
+    snprintf(name, BUFF_SIZE, "uncompact_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(uncompact)
+        (compacted, numCompacted, cells, maxUncompacted, RES);
+    });
+
+    H3CompactSet* compactSet = H3_EXPORT(createH3CompactSet)(RES);
+    snprintf(name, BUFF_SIZE, "h3CompactSetAdd_%d", numCells);
+    NAMED_BENCHMARK(name, 1, {
+        for (int i = 0; i < numCells; i++) {
+            H3_EXPORT(h3CompactSetAdd)(compactSet, cells[i]);
+        }
+    });
+
+    int next = 0;
+    snprintf(name, BUFF_SIZE, "h3CompactSetRemoveAdd_%d", numCells);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(h3CompactSetRemove)(compactSet, cells[next]);
+        H3_EXPORT(h3CompactSetAdd)(compactSet, cells[next]);
+        next = (next + 7919) % numCells;
+    });
+    H3_EXPORT(destroyH3CompactSet)(compactSet);
+
+    uint8_t* encoded = malloc(H3_EXPORT(maxH3SetToBinarySize)(numCells));
+    size_t encodedSize;
+    snprintf(name, BUFF_SIZE, "h3SetToBinary_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(h3SetToBinary)(cells, numCells, encoded, &encodedSize);
+    });
+
+    snprintf(name, BUFF_SIZE, "binaryToH3Set_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(binaryToH3Set)(encoded, encodedSize, cells, numCells);
+    });
+
+    snprintf(name, BUFF_SIZE, "binaryToH3SetCompacted_%d", numCells);
+    H3_EXPORT(h3SetToBinary)(compacted, numCompacted, encoded, &encodedSize);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(binaryToH3Set)(encoded, encodedSize, cells, numCells);
+    });
+    free(encoded);
+
+    H3Index* ring = calloc(6 * (k / 2), sizeof(H3Index));
+    if (H3_EXPORT(hexRing)(origin, k / 2, ring) != 0 ||
+        H3_EXPORT(hexRange)(ring[0], k, cells) != 0) {
+        error("benchmark disk contains a pentagon");
+    }
+    H3Index* moved = calloc(numCells, sizeof(H3Index));
+    H3_EXPORT(compactWithSort)(cells, moved, numCells);
+    H3SortedSet* a = H3_EXPORT(createH3SortedSet)(compacted, numCompacted);
+    H3SortedSet* b = H3_EXPORT(createH3SortedSet)(moved, numCells);
+    H3SortedSet* result;
+
+    snprintf(name, BUFF_SIZE, "h3SortedSetUnion_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        result = H3_EXPORT(h3SortedSetUnion)(a, b);
+        H3_EXPORT(destroyH3SortedSet)(result);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3SortedSetIntersection_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        result = H3_EXPORT(h3SortedSetIntersection)(a, b);
+        H3_EXPORT(destroyH3SortedSet)(result);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3SortedSetDifference_%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        result = H3_EXPORT(h3SortedSetDifference)(a, b);
+        H3_EXPORT(destroyH3SortedSet)(result);
+    });
+
+    H3_EXPORT(destroyH3SortedSet)(b);
+    H3_EXPORT(destroyH3SortedSet)(a);
+    free(moved);
+    free(ring);
+
+    free(compacted);
+    free(cells);
+}
+
+H3_EXPORT(destroyH3Scratch)(&scratch);
+
+int numBitmapCells = H3_EXPORT(maxKringSize)(BITMAP_K);
+H3Index bitmapOrigin = H3_EXPORT(h3ToParent)(origin, H3_BITMAP_MAX_RES);
+H3Index* cells = calloc(numBitmapCells, sizeof(H3Index));
+H3Index* compacted = calloc(numBitmapCells, sizeof(H3Index));
+H3Index* ring = calloc(6 * (BITMAP_K / 2), sizeof(H3Index));
+if (H3_EXPORT(hexRing)(bitmapOrigin, BITMAP_K / 2, ring) != 0 ||
+    H3_EXPORT(hexRange)(ring[0], BITMAP_K, cells) != 0) {
+    error("benchmark disk contains a pentagon");
+}
+H3Bitmap* moved = H3_EXPORT(createH3Bitmap)(H3_BITMAP_MAX_RES);
+for (int i = 0; i < numBitmapCells; i++) {
+    H3_EXPORT(h3BitmapAdd)(moved, cells[i]);
+}
+if (H3_EXPORT(hexRange)(bitmapOrigin, BITMAP_K, cells) != 0) {
+    error("benchmark disk contains a pentagon");
+}
+H3_EXPORT(compactWithSort)(cells, compacted, numBitmapCells);
+int numCompacted = 0;
+for (int i = 0; i < numBitmapCells; i++) {
+    if (compacted[i] != 0) compacted[numCompacted++] = compacted[i];
+}
+H3Bitmap* bitmap = H3_EXPORT(createH3Bitmap)(H3_BITMAP_MAX_RES);
+
+snprintf(name, BUFF_SIZE, "h3IndexSetAdd_%d", numBitmapCells);
+NAMED_BENCHMARK(name, 1, {
+    H3IndexSet* set = H3_EXPORT(createH3IndexSet)(numBitmapCells);
+    for (int i = 0; i < numBitmapCells; i++) {
+        H3_EXPORT(h3IndexSetAdd)(set, cells[i]);
+    }
+    H3_EXPORT(destroyH3IndexSet)(set);
+});
+
+snprintf(name, BUFF_SIZE, "h3BitmapAdd_%d", numBitmapCells);
+NAMED_BENCHMARK(name, 1, {
+    for (int i = 0; i < numBitmapCells; i++) {
+        H3_EXPORT(h3BitmapAdd)(bitmap, cells[i]);
+    }
+});
+
+snprintf(name, BUFF_SIZE, "h3BitmapAddCompact_%d", numBitmapCells);
+NAMED_BENCHMARK(name, 10, {
+    H3_EXPORT(h3BitmapAddCompact)(bitmap, compacted, numCompacted);
+});
+
+snprintf(name, BUFF_SIZE, "h3BitmapToCompact_%d", numBitmapCells);
+NAMED_BENCHMARK(name, 10, {
+    H3_EXPORT(h3BitmapToCompact)(bitmap, compacted, numBitmapCells);
+});
+
+NAMED_BENCHMARK("h3BitmapCount", 10, { H3_EXPORT(h3BitmapCount)(bitmap); });
+
+NAMED_BENCHMARK("h3BitmapUnion", 10,
+                { H3_EXPORT(h3BitmapUnion)(bitmap, moved); });
+
+NAMED_BENCHMARK("h3BitmapIntersection", 10,
+                { H3_EXPORT(h3BitmapIntersection)(bitmap, moved); });
+
+H3_EXPORT(destroyH3Bitmap)(bitmap);
+H3_EXPORT(destroyH3Bitmap)(moved);
+free(ring);
+free(compacted);
+free(cells);
+
+END_BENCHMARKS();
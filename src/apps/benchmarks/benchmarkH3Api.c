@@ -13,20 +13,121 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <stdlib.h>
+#include <string.h>
 #include "benchmark.h"
+#include "constants.h"
 #include "geoCoord.h"
+#include "faceijk.h"
+#include "faceIjkAp7.h"
+#include "h3Index.h"
 #include "h3api.h"
 
 // Fixtures
 GeoCoord coord = {0.659966917655, -2.1364398519396};
 H3Index hex = 0x89283080ddbffff;
 
+#define NUM_BATCH_COORDS 100
+double batchLat[NUM_BATCH_COORDS];
+double batchLon[NUM_BATCH_COORDS];
+GeoCoord batchCoords[NUM_BATCH_COORDS];
+H3Index batchOut[NUM_BATCH_COORDS];
+
 BEGIN_BENCHMARKS();
 
+H3Index outIndex;
 GeoCoord outCoord;
 GeoBoundary outBoundary;
 
-BENCHMARK(geoToH3, 10000, { H3_EXPORT(geoToH3)(&coord, 9); });
+for (int i = 0; i < NUM_BATCH_COORDS; i++) {
+    batchCoords[i].lat = batchLat[i] = coord.lat + i * 0.001;
+    batchCoords[i].lon = batchLon[i] = coord.lon + i * 0.001;
+}
+
+BENCHMARK(geoToH3, 10000, {
+    outIndex = H3_EXPORT(geoToH3)(&coord, 9);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+
+H3Index pyramid[12];
+BENCHMARK(geoToH3Loop0To11, 10000, {
+    for (int res = 0; res <= 11; res++) {
+        pyramid[res] = H3_EXPORT(geoToH3)(&coord, res);
+    }
+    DO_NOT_OPTIMIZE(pyramid);
+});
+
+BENCHMARK(geoToH3Multi0To11, 10000, {
+    H3_EXPORT(geoToH3Multi)(&coord, 11, pyramid);
+    DO_NOT_OPTIMIZE(pyramid);
+});
+
+BENCHMARK(geoToH3Loop100, 10000, {
+    for (int j = 0; j < NUM_BATCH_COORDS; j++) {
+        batchOut[j] = H3_EXPORT(geoToH3)(&batchCoords[j], 9);
+    }
+});
+
+BENCHMARK(geoToH3Batch100, 10000, {
+    H3_EXPORT(geoToH3Batch)(batchLat, batchLon, NUM_BATCH_COORDS, 9, batchOut);
+});
+
+FaceIJK fijk0, fijk5, fijk9, fijk12, fijk15;
+_geoToFaceIjk(&coord, 0, &fijk0);
+_geoToFaceIjk(&coord, 5, &fijk5);
+_geoToFaceIjk(&coord, 9, &fijk9);
+_geoToFaceIjk(&coord, 12, &fijk12);
+_geoToFaceIjk(&coord, 15, &fijk15);
+
+BENCHMARK(faceIjkToH3Res0, 10000, {
+    outIndex = _faceIjkToH3(&fijk0, 0);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Ap7Res0, 10000, {
+    outIndex = _faceIjkToH3Ap7(&fijk0, 0);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Res5, 10000, {
+    outIndex = _faceIjkToH3(&fijk5, 5);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Ap7Res5, 10000, {
+    outIndex = _faceIjkToH3Ap7(&fijk5, 5);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Res9, 10000, {
+    outIndex = _faceIjkToH3(&fijk9, 9);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Ap7Res9, 10000, {
+    outIndex = _faceIjkToH3Ap7(&fijk9, 9);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Res12, 10000, {
+    outIndex = _faceIjkToH3(&fijk12, 12);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Ap7Res12, 10000, {
+    outIndex = _faceIjkToH3Ap7(&fijk12, 12);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Res15, 10000, {
+    outIndex = _faceIjkToH3(&fijk15, 15);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+BENCHMARK(faceIjkToH3Ap7Res15, 10000, {
+    outIndex = _faceIjkToH3Ap7(&fijk15, 15);
+    DO_NOT_OPTIMIZE(outIndex);
+});
+
+H3Index pentagon = 0x89080000003ffff;
+H3Index kRingOut[1951];
+int kRingDistancesOut[1951];
+
+BENCHMARK(kRingPentagon25, 100, {
+    memset(kRingOut, 0, sizeof(kRingOut));
+    H3_EXPORT(kRingDistances)(pentagon, 25, kRingOut, kRingDistancesOut);
+});
 
 BENCHMARK(h3ToGeo, 10000, { H3_EXPORT(h3ToGeo)(hex, &outCoord); });
 
@@ -34,4 +135,42 @@ BENCHMARK(h3ToGeoBoundary, 10000, {
     H3_EXPORT(h3ToGeoBoundary)(hex, &outBoundary);
 });
 
+BENCHMARK(h3ToGeoThenBoundary, 10000, {
+    H3_EXPORT(h3ToGeo)(hex, &outCoord);
+    H3_EXPORT(h3ToGeoBoundary)(hex, &outBoundary);
+});
+
+BENCHMARK(h3ToGeoAndBoundary, 10000, {
+    H3_EXPORT(h3ToGeoAndBoundary)(hex, &outCoord, &outBoundary);
+});
+
+// The batch coordinates as a path, against sampling it every quarter edge
+int pathSize =
+    H3_EXPORT(maxPolylineToCellsSize)(batchCoords, NUM_BATCH_COORDS, 9);
+H3Index* pathOut = calloc(pathSize, sizeof(H3Index));
+double sampleRads = H3_EXPORT(edgeLengthKm)(9) / EARTH_RADIUS_KM / 4;
+
+BENCHMARK(polylineToCellsPath100, 100, {
+    H3_EXPORT(polylineToCells)
+    (batchCoords, NUM_BATCH_COORDS, 9, pathOut, pathSize);
+});
+
+BENCHMARK(geoToH3SamplesPath100, 100, {
+    int numOut = 0;
+    for (int j = 1; j < NUM_BATCH_COORDS; j++) {
+        double distance = _geoDistRads(&batchCoords[j - 1], &batchCoords[j]);
+        double azimuth = _geoAzimuthRads(&batchCoords[j - 1], &batchCoords[j]);
+        for (double d = 0; d < distance; d += sampleRads) {
+            GeoCoord sample;
+            _geoAzDistanceRads(&batchCoords[j - 1], azimuth, d, &sample);
+            H3Index h = H3_EXPORT(geoToH3)(&sample, 9);
+            if (numOut == 0 || pathOut[numOut - 1] != h) {
+                if (numOut < pathSize) pathOut[numOut++] = h;
+            }
+        }
+    }
+});
+
+free(pathOut);
+
 END_BENCHMARKS();
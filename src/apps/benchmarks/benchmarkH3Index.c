@@ -0,0 +1,170 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkH3Index.c
+ * @brief Benchmarks string conversion, boundary, hierarchy and shard routing
+ * functions over the random cells of resolutions 5 to 15 in the rand corpora.
+ *
+ * Each iteration converts one cell, cycling through the corpus.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "constants.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+#define MIN_INPUT_RES 5
+
+/** largest number of resolutions benchmarked below each cell */
+#define CHILD_RES_OFFSET 3
+
+// Fixtures
+H3Index cells[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+char strings[MAX_INPUT_CELLS][17];
+H3Index batchIndexes[MAX_INPUT_CELLS];
+uint8_t valid[MAX_INPUT_CELLS];
+// parents at three resolutions, for h3ToParentsBatch
+H3Index parents[3 * MAX_INPUT_CELLS];
+int shards[MAX_INPUT_CELLS];
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+H3Index outIndex;
+int outInt;
+char outString[17];
+GeoBoundary outBoundary;
+// 7^3 children, the most for CHILD_RES_OFFSET
+H3Index children[343];
+int next = 0;
+// 256 shards of the finest resolution of a shard table
+H3ShardTable* shardTable =
+    H3_EXPORT(createH3ShardTable)(H3_SHARD_MAX_RES, 256, NULL, NULL);
+
+for (int res = MIN_INPUT_RES; res <= MAX_H3_RES; res++) {
+    snprintf(name, BUFF_SIZE, "rand%02dcenters.txt", res);
+    int numCells =
+        benchmarkReadCenters(name, MAX_INPUT_CELLS, cells, centers);
+    for (int i = 0; i < numCells; i++) {
+        H3_EXPORT(h3ToString)(cells[i], strings[i], sizeof(strings[i]));
+    }
+
+    snprintf(name, BUFF_SIZE, "stringToH3_res%02d", res);
+    NAMED_BENCHMARK(name, 10000, {
+        outIndex = H3_EXPORT(stringToH3)(strings[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE, "stringToH3BatchStrict_res%02d", res);
+    NAMED_BENCHMARK(name, 10, {
+        H3_EXPORT(stringToH3Batch)
+        (strings[0], sizeof(strings[0]), numCells, 1, batchIndexes);
+        DO_NOT_OPTIMIZE(batchIndexes);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToString_res%02d", res);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(h3ToString)
+        (cells[next++ % numCells], outString, sizeof(outString));
+        DO_NOT_OPTIMIZE(outString);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3IsValid_res%02d", res);
+    NAMED_BENCHMARK(name, 10000, {
+        outInt = H3_EXPORT(h3IsValid)(cells[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outInt);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3IsValidBatch_res%02d", res);
+    NAMED_BENCHMARK(name, 100, {
+        H3_EXPORT(h3IsValidBatch)(cells, numCells, valid);
+        DO_NOT_OPTIMIZE(valid);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToGeoBoundary_res%02d", res);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(h3ToGeoBoundary)(cells[next++ % numCells], &outBoundary);
+        DO_NOT_OPTIMIZE(outBoundary);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToParent_res%02d_to_res%02d", res, res - 1);
+    NAMED_BENCHMARK(name, 10000, {
+        outIndex = H3_EXPORT(h3ToParent)(cells[next++ % numCells], res - 1);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToParent_res%02d_to_res00", res);
+    NAMED_BENCHMARK(name, 10000, {
+        outIndex = H3_EXPORT(h3ToParent)(cells[next++ % numCells], 0);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToParentBatch_res%02d_to_res%02d", res,
+             res - 1);
+    NAMED_BENCHMARK(name, 100, {
+        H3_EXPORT(h3ToParentBatch)(cells, numCells, res - 1, parents);
+        DO_NOT_OPTIMIZE(parents);
+    });
+
+    // the rollup resolutions of a typical aggregation
+    int parentRes[3] = {res - 1, res / 2, 0};
+    snprintf(name, BUFF_SIZE, "h3ToParentsBatch_res%02d_to_3res", res);
+    NAMED_BENCHMARK(name, 100, {
+        H3_EXPORT(h3ToParentsBatch)(cells, numCells, parentRes, 3, parents);
+        DO_NOT_OPTIMIZE(parents);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToShard_res%02d", res);
+    NAMED_BENCHMARK(name, 10000, {
+        outInt = H3_EXPORT(h3ToShard)(shardTable, cells[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outInt);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToShardBatch_res%02d", res);
+    NAMED_BENCHMARK(name, 100, {
+        H3_EXPORT(h3ToShardBatch)(shardTable, cells, numCells, shards);
+        DO_NOT_OPTIMIZE(shards);
+    });
+
+    for (int offset = 1; offset <= CHILD_RES_OFFSET; offset += 2) {
+        int childRes = res + offset;
+        if (childRes > MAX_H3_RES) break;
+        snprintf(name, BUFF_SIZE, "h3ToChildren_res%02d_to_res%02d", res,
+                 childRes);
+        NAMED_BENCHMARK(name, 1000, {
+            H3_EXPORT(h3ToChildren)
+            (cells[next++ % numCells], childRes, children);
+            DO_NOT_OPTIMIZE(children);
+        });
+
+        snprintf(name, BUFF_SIZE, "childIter_res%02d_to_res%02d", res,
+                 childRes);
+        NAMED_BENCHMARK(name, 1000, {
+            ChildIterator iter;
+            H3_EXPORT(childIterInit)(&iter, cells[next++ % numCells], childRes);
+            while ((outIndex = H3_EXPORT(childIterNext)(&iter))) {
+                DO_NOT_OPTIMIZE(outIndex);
+            }
+        });
+    }
+}
+
+H3_EXPORT(destroyH3ShardTable)(shardTable);
+
+END_BENCHMARKS();
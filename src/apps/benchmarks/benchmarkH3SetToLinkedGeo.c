@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkH3SetToLinkedGeo.c
+ * @brief Benchmarks h3SetToLinkedGeo on contiguous sets from the bc corpora,
+ * around a hexagon and around a pentagon, on filled disks, and on the
+ * scattered cells of the rand09 corpus.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "algos.h"
+#include "benchmark.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+
+/** @brief corpora benchmarked, with the iterations for each */
+static const char* corpora[] = {"bc19r12centers.txt", "bc14r12centers.txt",
+                                "bc19r14centers.txt", "bc14r14centers.txt",
+                                "rand09centers.txt"};
+static const int corpusIterations[] = {100, 100, 20, 20, 10};
+#define NUM_CORPORA 5
+
+/** disk sizes benchmarked, with the iterations for each */
+static const int diskKs[] = {10, 100};
+static const int diskIterations[] = {100, 5};
+#define NUM_DISKS 2
+
+/** resolutions of the vertex graph benchmarks */
+static const int graphResolutions[] = {9, 12, 15};
+#define NUM_GRAPH_RESOLUTIONS 3
+
+// Fixtures
+H3Index origin = 0x89283080ddbffff;
+H3Index cells[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+LinkedGeoPolygon polygon;
+
+for (int c = 0; c < NUM_CORPORA; c++) {
+    int numCells =
+        benchmarkReadCenters(corpora[c], MAX_INPUT_CELLS, cells, centers);
+    // name the benchmark by the corpus, without the "centers.txt" suffix
+    int corpusLen = (int)(strstr(corpora[c], "centers") - corpora[c]);
+    snprintf(name, BUFF_SIZE, "h3SetToLinkedGeo_%.*s", corpusLen, corpora[c]);
+    NAMED_BENCHMARK(name, corpusIterations[c], {
+        H3_EXPORT(h3SetToLinkedGeo)(cells, numCells, &polygon);
+        H3_EXPORT(destroyLinkedPolygon)(&polygon);
+    });
+}
+
+for (int t = 0; t < NUM_DISKS; t++) {
+    int k = diskKs[t];
+    int numCells = H3_EXPORT(maxKringSize)(k);
+    H3Index* disk = calloc(numCells, sizeof(H3Index));
+    H3_EXPORT(hexRange)(origin, k, disk);
+    snprintf(name, BUFF_SIZE, "h3SetToLinkedGeo_disk%d", numCells);
+    NAMED_BENCHMARK(name, diskIterations[t], {
+        H3_EXPORT(h3SetToLinkedGeo)(disk, numCells, &polygon);
+        H3_EXPORT(destroyLinkedPolygon)(&polygon);
+    });
+    free(disk);
+}
+
+for (int t = 0; t < NUM_GRAPH_RESOLUTIONS; t++) {
+    int res = graphResolutions[t];
+    int numCells = H3_EXPORT(maxKringSize)(30);
+    H3Index* disk = calloc(numCells, sizeof(H3Index));
+    H3Index resOrigin = H3_EXPORT(h3ToParent)(origin, 9);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(resOrigin, &center);
+    H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(&center, res), 30, disk);
+    snprintf(name, BUFF_SIZE, "h3SetToVertexGraph_disk%d_res%d", numCells,
+             res);
+    VertexGraph graph;
+    NAMED_BENCHMARK(name, 20, {
+        h3SetToVertexGraph(disk, numCells, &graph);
+        destroyVertexGraph(&graph);
+    });
+    free(disk);
+}
+
+END_BENCHMARKS();
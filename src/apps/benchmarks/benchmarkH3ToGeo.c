@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkH3ToGeo.c
+ * @brief Benchmarks decoding cell centers over the descendants of base cells
+ * 5, 14 and 19 in the bc corpora and the random cells of the rand corpora,
+ * at resolutions 8 to 15.
+ *
+ * Each iteration of h3ToGeo decodes one cell, cycling through the corpus;
+ * each iteration of h3ToGeoBatch decodes the whole corpus.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "constants.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+#define MIN_INPUT_RES 8
+
+/** @brief corpora benchmarked, by the prefix of their file names and the
+ * name of each in benchmark names */
+static const char* corpora[][2] = {
+    {"bc05r", "bc05"}, {"bc14r", "bc14"}, {"bc19r", "bc19"}, {"rand", "rand"}};
+
+// Fixtures
+H3Index cells[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+double lats[MAX_INPUT_CELLS];
+double lons[MAX_INPUT_CELLS];
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+GeoCoord outCoord;
+int next = 0;
+
+for (int c = 0; c < 4; c++) {
+    for (int res = MIN_INPUT_RES; res <= MAX_H3_RES; res++) {
+        snprintf(name, BUFF_SIZE, "%s%02dcenters.txt", corpora[c][0], res);
+        int numCells =
+            benchmarkReadCenters(name, MAX_INPUT_CELLS, cells, centers);
+
+        snprintf(name, BUFF_SIZE, "h3ToGeo_%s_res%02d", corpora[c][1], res);
+        NAMED_BENCHMARK(name, 10000, {
+            H3_EXPORT(h3ToGeo)(cells[next++ % numCells], &outCoord);
+            DO_NOT_OPTIMIZE(outCoord);
+        });
+
+        snprintf(name, BUFF_SIZE, "h3ToGeoBatch_%s_res%02d", corpora[c][1],
+                 res);
+        NAMED_BENCHMARK(name, 100000 / numCells + 1, {
+            H3_EXPORT(h3ToGeoBatch)(cells, numCells, lats, lons);
+            DO_NOT_OPTIMIZE(lats);
+        });
+    }
+}
+
+END_BENCHMARKS();
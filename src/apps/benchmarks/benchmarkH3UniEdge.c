@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkH3UniEdge.c
+ * @brief Benchmarks the unidirectional edge functions over the random
+ * hexagons of the rand09 corpus and the pentagon neighborhood of the bc14r09
+ * corpus.
+ *
+ * Each iteration handles one cell or edge, cycling through the corpus, except
+ * for the batch benchmarks, which handle the whole corpus per iteration.
+ * h3SetToAdjacency is benchmarked over a disk of k = 100 around a hexagon.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "benchmark.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+/** radius of the disk whose adjacency is benchmarked */
+#define ADJACENCY_K 100
+
+/** @brief corpora benchmarked, with the name of each in benchmark names */
+static const char* corpora[][2] = {{"rand09centers.txt", "Hexagons"},
+                                   {"bc14r09centers.txt", "Pentagons"}};
+
+// Fixtures
+H3Index cells[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+H3Index neighbors[MAX_INPUT_CELLS];
+H3Index edges[MAX_INPUT_CELLS];
+
+BEGIN_BENCHMARKS();
+
+char name[BUFF_SIZE];
+H3Index outIndex;
+H3Index outIndexes[6];
+GeoBoundary outBoundary;
+H3Index outEdges[6 * MAX_INPUT_CELLS];
+double outVerts[36 * MAX_INPUT_CELLS];
+int outNumVerts[6 * MAX_INPUT_CELLS];
+int outInt;
+int next = 0;
+
+for (int c = 0; c < 2; c++) {
+    int numCells =
+        benchmarkReadCenters(corpora[c][0], MAX_INPUT_CELLS, cells, centers);
+    const char* kind = corpora[c][1];
+    // the first edge of each cell gives a neighbor, skipping the deleted
+    // edge of pentagons
+    for (int i = 0; i < numCells; i++) {
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(cells[i], outIndexes);
+        edges[i] = outIndexes[0] ? outIndexes[0] : outIndexes[1];
+        neighbors[i] =
+            H3_EXPORT(getDestinationH3IndexFromUnidirectionalEdge)(edges[i]);
+    }
+
+    snprintf(name, BUFF_SIZE, "h3IndexesAreNeighbors%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        int j = next++ % numCells;
+        outInt = H3_EXPORT(h3IndexesAreNeighbors)(cells[j], neighbors[j]);
+        DO_NOT_OPTIMIZE(outInt);
+    });
+
+    snprintf(name, BUFF_SIZE, "getH3UnidirectionalEdge%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        int j = next++ % numCells;
+        outIndex = H3_EXPORT(getH3UnidirectionalEdge)(cells[j], neighbors[j]);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3UnidirectionalEdgeIsValid%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        outInt = H3_EXPORT(h3UnidirectionalEdgeIsValid)(
+            edges[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outInt);
+    });
+
+    snprintf(name, BUFF_SIZE, "getOriginH3IndexFromUnidirectionalEdge%s",
+             kind);
+    NAMED_BENCHMARK(name, 10000, {
+        outIndex = H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(
+            edges[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE,
+             "getDestinationH3IndexFromUnidirectionalEdge%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        outIndex = H3_EXPORT(getDestinationH3IndexFromUnidirectionalEdge)(
+            edges[next++ % numCells]);
+        DO_NOT_OPTIMIZE(outIndex);
+    });
+
+    snprintf(name, BUFF_SIZE, "getH3IndexesFromUnidirectionalEdge%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(getH3IndexesFromUnidirectionalEdge)
+        (edges[next++ % numCells], outIndexes);
+        DO_NOT_OPTIMIZE(outIndexes);
+    });
+
+    snprintf(name, BUFF_SIZE, "getH3UnidirectionalEdgesFromHexagon%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)
+        (cells[next++ % numCells], outIndexes);
+        DO_NOT_OPTIMIZE(outIndexes);
+    });
+
+    snprintf(name, BUFF_SIZE, "getH3UnidirectionalEdgeBoundary%s", kind);
+    NAMED_BENCHMARK(name, 10000, {
+        H3_EXPORT(getH3UnidirectionalEdgeBoundary)
+        (edges[next++ % numCells], &outBoundary);
+        DO_NOT_OPTIMIZE(outBoundary);
+    });
+
+    // every edge of the corpus, edge by edge and then in a batch
+    snprintf(name, BUFF_SIZE, "getH3UnidirectionalEdgeBoundaryLoop%s", kind);
+    NAMED_BENCHMARK(name, 10, {
+        for (int j = 0; j < numCells; j++) {
+            H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)
+            (cells[j], outIndexes);
+            for (int d = 0; d < 6; d++) {
+                if (outIndexes[d] == 0) continue;
+                H3_EXPORT(getH3UnidirectionalEdgeBoundary)
+                (outIndexes[d], &outBoundary);
+                DO_NOT_OPTIMIZE(outBoundary);
+            }
+        }
+    });
+
+    snprintf(name, BUFF_SIZE, "getH3UnidirectionalEdgesFromHexagonBatch%s",
+             kind);
+    NAMED_BENCHMARK(name, 10, {
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagonBatch)
+        (cells, numCells, outEdges);
+        DO_NOT_OPTIMIZE(outEdges);
+    });
+
+    snprintf(name, BUFF_SIZE,
+             "getH3UnidirectionalEdgeBoundariesFromHexagonBatch%s", kind);
+    NAMED_BENCHMARK(name, 10, {
+        outInt =
+            H3_EXPORT(getH3UnidirectionalEdgeBoundariesFromHexagonBatch)(
+                cells, numCells, outVerts, outNumVerts);
+        DO_NOT_OPTIMIZE(outInt);
+    });
+}
+
+int numDiskCells = H3_EXPORT(maxKringSize)(ADJACENCY_K);
+H3Index* disk = calloc(numDiskCells, sizeof(H3Index));
+H3_EXPORT(kRing)(0x89283470c27ffffL, ADJACENCY_K, disk);
+H3Adjacency adjacency;
+
+snprintf(name, BUFF_SIZE, "h3SetToAdjacency_k%d", ADJACENCY_K);
+NAMED_BENCHMARK(name, 10, {
+    H3_EXPORT(h3SetToAdjacency)
+    (disk, numDiskCells, NULL, NULL, &adjacency);
+    H3_EXPORT(destroyH3Adjacency)(&adjacency);
+});
+
+free(disk);
+
+END_BENCHMARKS();
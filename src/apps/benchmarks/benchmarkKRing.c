@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkKRing.c
+ * @brief Benchmarks kRing, kRingOrdered and hexRange around random hexagons
+ * and around pentagons.
+ *
+ * Hexagon origins are the rand09 corpus. Pentagon origins are the bc14r09
+ * corpus, a pentagon and its neighbors. hexRange fails on pentagon origins,
+ * so those benchmarks measure the time to detect the pentagon.
+ *
+ * geoRadiusToCells is compared with filtering the k-ring that the radius
+ * needs at the average edge length, and the nearest cells iterator with
+ * finding the same number of cells with geoRadiusToCells.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.h"
+#include "geoCoord.h"
+#include "h3api.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+
+/** ring sizes benchmarked */
+#define NUM_KS 3
+static const int ks[NUM_KS] = {1, 10, 100};
+/** iterations for each ring size */
+static const int kIterations[NUM_KS] = {10000, 1000, 20};
+
+// Fixtures
+H3Index hexOrigins[MAX_INPUT_CELLS];
+H3Index pentOrigins[MAX_INPUT_CELLS];
+GeoCoord hexCenters[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+
+BEGIN_BENCHMARKS();
+
+int numHexOrigins = benchmarkReadCenters("rand09centers.txt", MAX_INPUT_CELLS,
+                                         hexOrigins, hexCenters);
+int numPentOrigins = benchmarkReadCenters(
+    "bc14r09centers.txt", MAX_INPUT_CELLS, pentOrigins, centers);
+
+H3Index* out = calloc(H3_EXPORT(maxKringSize)(ks[NUM_KS - 1]), sizeof(H3Index));
+int* distances =
+    calloc(H3_EXPORT(maxKringSize)(ks[NUM_KS - 1]), sizeof(int));
+int* ringOffsets = calloc(ks[NUM_KS - 1] + 2, sizeof(int));
+char name[BUFF_SIZE];
+int next = 0;
+
+for (int t = 0; t < NUM_KS; t++) {
+    int k = ks[t];
+    size_t outSize = H3_EXPORT(maxKringSize)(k) * sizeof(H3Index);
+
+    snprintf(name, BUFF_SIZE, "kRingHexagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        memset(out, 0, outSize);
+        H3_EXPORT(kRing)(hexOrigins[next++ % numHexOrigins], k, out);
+    });
+
+    snprintf(name, BUFF_SIZE, "kRingPentagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        memset(out, 0, outSize);
+        H3_EXPORT(kRing)(pentOrigins[next++ % numPentOrigins], k, out);
+    });
+
+    snprintf(name, BUFF_SIZE, "kRingDistancesHexagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        memset(out, 0, outSize);
+        H3_EXPORT(kRingDistances)
+        (hexOrigins[next++ % numHexOrigins], k, out, distances);
+    });
+
+    snprintf(name, BUFF_SIZE, "kRingOrderedHexagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        H3_EXPORT(kRingOrdered)
+        (hexOrigins[next++ % numHexOrigins], k, out, ringOffsets);
+    });
+
+    snprintf(name, BUFF_SIZE, "kRingOrderedPentagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        H3_EXPORT(kRingOrdered)
+        (pentOrigins[next++ % numPentOrigins], k, out, ringOffsets);
+    });
+
+    snprintf(name, BUFF_SIZE, "hexRangeHexagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        H3_EXPORT(hexRange)(hexOrigins[next++ % numHexOrigins], k, out);
+    });
+
+    snprintf(name, BUFF_SIZE, "hexRangePentagons_k%d", k);
+    NAMED_BENCHMARK(name, kIterations[t], {
+        H3_EXPORT(hexRange)(pentOrigins[next++ % numPentOrigins], k, out);
+    });
+}
+
+/** radius of the geoRadiusToCells benchmarks, in km */
+#define RADIUS_KM 2.0
+int radiusSize = H3_EXPORT(maxGeoRadiusToCellsSize)(RADIUS_KM, 9);
+int radiusK = (int)ceil(RADIUS_KM / H3_EXPORT(edgeLengthKm)(9)) + 1;
+H3Index* radiusOut = calloc(radiusSize, sizeof(H3Index));
+double* radiusDistances = calloc(radiusSize, sizeof(double));
+int radiusKSize = H3_EXPORT(maxKringSize)(radiusK);
+H3Index* radiusRing = calloc(radiusKSize, sizeof(H3Index));
+
+BENCHMARK(geoRadiusToCells_2km, 1000, {
+    H3_EXPORT(geoRadiusToCells)
+    (&hexCenters[next++ % numHexOrigins], RADIUS_KM, 9, radiusOut,
+     radiusDistances);
+});
+
+BENCHMARK(kRingFilter_2km, 1000, {
+    GeoCoord* center = &hexCenters[next++ % numHexOrigins];
+    memset(radiusRing, 0, radiusKSize * sizeof(H3Index));
+    H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(center, 9), radiusK, radiusRing);
+    int count = 0;
+    for (int i = 0; i < radiusKSize; i++) {
+        if (radiusRing[i] == 0) continue;
+        GeoCoord cellCenter;
+        H3_EXPORT(h3ToGeo)(radiusRing[i], &cellCenter);
+        if (_geoDistKm(center, &cellCenter) <= RADIUS_KM) count++;
+    }
+});
+
+#define NUM_NEAREST 100
+H3Index nearestOut[NUM_NEAREST];
+double nearestDistances[NUM_NEAREST];
+
+BENCHMARK(nearestCellsIter_100, 1000, {
+    NearestCellsIterator* iter =
+        H3_EXPORT(nearestCellsIterInit)(&hexCenters[next++ % numHexOrigins], 9);
+    H3_EXPORT(nearestCellsIterNext)
+    (iter, nearestOut, nearestDistances, NUM_NEAREST);
+    H3_EXPORT(nearestCellsIterDestroy)(iter);
+});
+
+// About NUM_NEAREST cells have centers within this radius
+BENCHMARK(geoRadiusToCells_100, 1000, {
+    H3_EXPORT(geoRadiusToCells)
+    (&hexCenters[next++ % numHexOrigins], 1.8, 9, radiusOut, radiusDistances);
+});
+
+free(radiusRing);
+free(radiusDistances);
+free(radiusOut);
+free(ringOffsets);
+free(distances);
+free(out);
+
+END_BENCHMARKS();
@@ -13,8 +13,12 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "algos.h"
 #include "benchmark.h"
+#include "constants.h"
 #include "h3api.h"
 #include "stackAlloc.h"
 
@@ -105,6 +109,11 @@ GeoCoord southernVerts[] = {{0.6367481147484843, -2.1290865397798906},
 Geofence southernGeofence;
 GeoPolygon southernGeoPolygon;
 
+/** vertices of a coastline detailed far below the hexagon edge length */
+#define COAST_VERTS 20000
+GeoCoord coastVerts[COAST_VERTS];
+GeoPolygon coastGeoPolygon;
+
 BEGIN_BENCHMARKS();
 
 sfGeofence.numVerts = 6;
@@ -119,6 +128,16 @@ southernGeofence.numVerts = 23;
 southernGeofence.verts = southernVerts;
 southernGeoPolygon.geofence = southernGeofence;
 
+// A loop around San Francisco with a zigzag of about 10m
+for (int i = 0; i < COAST_VERTS; i++) {
+    double angle = M_2PI * i / COAST_VERTS;
+    double r = 0.02 + (i % 2 ? 1.5e-6 : -1.5e-6) + 0.004 * sin(7 * angle);
+    coastVerts[i].lat = 0.659 + r * sin(angle);
+    coastVerts[i].lon = -2.136 + r * cos(angle);
+}
+coastGeoPolygon.geofence.numVerts = COAST_VERTS;
+coastGeoPolygon.geofence.verts = coastVerts;
+
 int numHexagons;
 
 BENCHMARK(polyfillSF, 500, {
@@ -139,4 +158,83 @@ BENCHMARK(polyfillSouthernExpansion, 10, {
     H3_EXPORT(polyfill)(&southernGeoPolygon, 9, hexagons);
 });
 
+int coverageSize =
+    H3_EXPORT(polyfillCoverage)(&southernGeoPolygon, 9, NULL, 0);
+H3Index* coverage = calloc(coverageSize, sizeof(H3Index));
+
+BENCHMARK(polyfillCoverageSouthernExpansion, 10, {
+    H3_EXPORT(polyfillCoverage)(&southernGeoPolygon, 9, coverage, coverageSize);
+});
+
+free(coverage);
+
+int coastSize = H3_EXPORT(polyfillDense)(&coastGeoPolygon, 7, NULL, 0);
+H3Index* coast = calloc(coastSize, sizeof(H3Index));
+
+BENCHMARK(polyfillDenseCoast, 10, {
+    H3_EXPORT(polyfillDense)(&coastGeoPolygon, 7, coast, coastSize);
+});
+
+BENCHMARK(polyfillSimplifiedCoastFirstCall, 10, {
+    SimplifiedGeoPolygon* simplified =
+        H3_EXPORT(createSimplifiedGeoPolygon)(&coastGeoPolygon);
+    H3_EXPORT(polyfillSimplified)(simplified, 7, coast, coastSize);
+    H3_EXPORT(destroySimplifiedGeoPolygon)(simplified);
+});
+
+SimplifiedGeoPolygon* simplifiedCoast =
+    H3_EXPORT(createSimplifiedGeoPolygon)(&coastGeoPolygon);
+H3_EXPORT(simplifiedGeoPolygonAtRes)(simplifiedCoast, 7);
+
+BENCHMARK(polyfillSimplifiedCoastCached, 10, {
+    H3_EXPORT(polyfillSimplified)(simplifiedCoast, 7, coast, coastSize);
+});
+
+H3_EXPORT(destroySimplifiedGeoPolygon)(simplifiedCoast);
+free(coast);
+
+// An edit of one vertex of a polygon of half a million hexagons
+GeoCoord editedSouthernVerts[23];
+memcpy(editedSouthernVerts, southernVerts, sizeof(southernVerts));
+editedSouthernVerts[5].lat += 0.0002;
+GeoPolygon editedSouthernGeoPolygon = southernGeoPolygon;
+editedSouthernGeoPolygon.geofence.verts = editedSouthernVerts;
+int southernSize = H3_EXPORT(polyfillDense)(&southernGeoPolygon, 10, NULL, 0);
+H3Index* southern = calloc(southernSize, sizeof(H3Index));
+int numAdded;
+int numRemoved;
+
+BENCHMARK(polyfillDenseSouthernRes10, 1, {
+    H3_EXPORT(polyfillDense)
+    (&editedSouthernGeoPolygon, 10, southern, southernSize);
+});
+
+BENCHMARK(polyfillDeltaSouthernRes10, 10, {
+    H3_EXPORT(polyfillDelta)
+    (&southernGeoPolygon, &editedSouthernGeoPolygon, 10, southern,
+     southernSize, &numAdded, southern, southernSize, &numRemoved);
+});
+
+free(southern);
+
+GeoPolygon regions[] = {sfGeoPolygon, alamedaGeoPolygon, southernGeoPolygon};
+size_t regionIndexSize;
+void* regionIndex =
+    H3_EXPORT(createH3RegionIndex)(regions, NULL, 3, 9, &regionIndexSize);
+GeoCoord lookupPoints[64];
+for (int i = 0; i < 64; i++) {
+    lookupPoints[i].lat = 0.625 + 0.015 * (i % 8) / 8;
+    lookupPoints[i].lon = -2.14 + 0.035 * (i / 8) / 8;
+}
+int regionId;
+
+BENCHMARK(h3RegionIndexLookup, 10000, {
+    for (int i = 0; i < 64; i++) {
+        H3_EXPORT(h3RegionIndexLookup)
+        (regionIndex, &lookupPoints[i], &regionId);
+    }
+});
+
+H3_EXPORT(destroyH3RegionIndex)(regionIndex);
+
 END_BENCHMARKS();
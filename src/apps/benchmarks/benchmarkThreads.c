@@ -0,0 +1,278 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file benchmarkThreads.c
+ * @brief Benchmarks the scaling of core functions over 1 to N threads.
+ *
+ * Every thread makes the same number of calls, on its own slice of the
+ * rand09 corpus and into its own output buffers. On Linux each thread is
+ * pinned to its own processor. The reported time is per call on each
+ * thread, so it stays constant as threads are added if the library scales.
+ * Growth points to contention such as false sharing, locks or other shared
+ * state.
+ *
+ * Threads double from 1 up to the number of online processors, or up to
+ * the number given with --threads.
+ *
+ * The parallel batch functions are then run on thread pools of the same
+ * sizes, over NUM_BATCH_POINTS points. Their reported time is per batch, so
+ * it falls as threads are added if the work is spread evenly.
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "h3api.h"
+#include "threadPool.h"
+#include "utility.h"
+
+#define MAX_INPUT_CELLS 5000
+#define RES 9
+#define K 10
+/** number of cells in a k-ring with K */
+#define K_RING_SIZE (3 * K * (K + 1) + 1)
+/** alignment of per thread memory, at least the size of a cache line */
+#define CACHE_LINE 128
+/** number of points in each batch */
+#define NUM_BATCH_POINTS 1000000
+
+/** @brief functions benchmarked */
+typedef enum {
+    GEO_TO_H3,
+    H3_TO_GEO,
+    H3_TO_GEO_BOUNDARY,
+    K_RING,
+    COMPACT,
+    POLYFILL,
+    NUM_FUNCS
+} Func;
+
+static const char* funcNames[NUM_FUNCS] = {
+    "geoToH3", "h3ToGeo", "h3ToGeoBoundary", "kRing", "compact", "polyfill"};
+/** calls each thread makes per sample, for each function */
+static const int funcCalls[NUM_FUNCS] = {5000, 5000, 1000, 100, 100, 20};
+
+/**
+ * @brief The state of one benchmark thread. States and output buffers are
+ * allocated on their own cache lines so that threads never write to shared
+ * cache lines.
+ */
+typedef struct {
+    pthread_t thread;
+    Func func;
+    int offset;           ///< first corpus cell used by the thread
+    H3Index* ring;        ///< kRing output and compact input
+    H3Index* compacted;   ///< compact output
+    H3Index* polyfilled;  ///< polyfill output
+    GeoBoundary* boundary;
+} ThreadState;
+
+// Fixtures
+H3Index cells[MAX_INPUT_CELLS];
+GeoCoord centers[MAX_INPUT_CELLS];
+int numCells;
+
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoPolygon sfGeoPolygon = {{6, sfVerts}, 0, NULL};
+int polyfillSize;
+
+/**
+ * Allocates zeroed memory on cache lines of its own.
+ */
+static void* callocLines(size_t size) {
+    void* p = NULL;
+    size = (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    if (posix_memalign(&p, CACHE_LINE, size)) {
+        error("allocating benchmark thread memory");
+    }
+    memset(p, 0, size);
+    return p;
+}
+
+static void* runThread(void* arg) {
+    ThreadState* state = arg;
+    int calls = funcCalls[state->func];
+    H3Index h;
+    GeoCoord center;
+    for (int i = 0; i < calls; i++) {
+        int c = (state->offset + i) % numCells;
+        switch (state->func) {
+            case GEO_TO_H3:
+                h = H3_EXPORT(geoToH3)(&centers[c], RES);
+                DO_NOT_OPTIMIZE(h);
+                break;
+            case H3_TO_GEO:
+                H3_EXPORT(h3ToGeo)(cells[c], &center);
+                DO_NOT_OPTIMIZE(center);
+                break;
+            case H3_TO_GEO_BOUNDARY:
+                H3_EXPORT(h3ToGeoBoundary)(cells[c], state->boundary);
+                break;
+            case K_RING:
+                memset(state->ring, 0, K_RING_SIZE * sizeof(H3Index));
+                H3_EXPORT(kRing)(cells[c], K, state->ring);
+                break;
+            case COMPACT:
+                H3_EXPORT(compact)
+                (state->ring, state->compacted, K_RING_SIZE);
+                break;
+            case POLYFILL:
+                memset(state->polyfilled, 0, polyfillSize * sizeof(H3Index));
+                H3_EXPORT(polyfill)(&sfGeoPolygon, RES, state->polyfilled);
+                break;
+            default:
+                break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Runs the function on the given number of threads and returns the time
+ * per call on each thread in nanoseconds.
+ */
+static double runThreads(ThreadState** states, int numThreads, Func func) {
+#ifdef __linux__
+    int numCpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    int64_t start = benchmarkNowNs();
+    for (int t = 0; t < numThreads; t++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(t % numCpus, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+#endif
+        states[t]->func = func;
+        if (pthread_create(&states[t]->thread, &attr, runThread, states[t])) {
+            error("creating benchmark thread");
+        }
+        pthread_attr_destroy(&attr);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(states[t]->thread, NULL);
+    }
+    return (double)(benchmarkNowNs() - start) / funcCalls[func];
+}
+
+BEGIN_BENCHMARKS();
+
+numCells = benchmarkReadCenters("rand09centers.txt", MAX_INPUT_CELLS, cells,
+                                centers);
+polyfillSize = H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, RES);
+
+int maxThreads = benchmarkMaxThreads();
+if (maxThreads == 0) {
+    maxThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxThreads < 1) maxThreads = 1;
+}
+
+ThreadState** states = calloc(maxThreads, sizeof(ThreadState*));
+for (int t = 0; t < maxThreads; t++) {
+    states[t] = callocLines(sizeof(ThreadState));
+    states[t]->offset = (int)((long)t * numCells / maxThreads);
+    states[t]->ring = callocLines(K_RING_SIZE * sizeof(H3Index));
+    states[t]->compacted = callocLines(K_RING_SIZE * sizeof(H3Index));
+    states[t]->polyfilled = callocLines(polyfillSize * sizeof(H3Index));
+    states[t]->boundary = callocLines(sizeof(GeoBoundary));
+}
+
+char name[BUFF_SIZE];
+double sampleNs[BENCHMARK_MAX_SAMPLES];
+int numSamples = benchmarkNumSamples(BENCHMARK_MAX_SAMPLES);
+
+for (Func func = 0; func < NUM_FUNCS; func++) {
+    for (int numThreads = 1;; numThreads *= 2) {
+        if (numThreads > maxThreads) numThreads = maxThreads;
+        // compact reads the k-ring of each thread's first cell
+        for (int t = 0; t < numThreads; t++) {
+            memset(states[t]->ring, 0, K_RING_SIZE * sizeof(H3Index));
+            H3_EXPORT(kRing)(cells[states[t]->offset], K, states[t]->ring);
+        }
+
+        runThreads(states, numThreads, func);
+        for (int s = 0; s < numSamples; s++) {
+            sampleNs[s] = runThreads(states, numThreads, func);
+        }
+        snprintf(name, BUFF_SIZE, "%s_threads%d", funcNames[func],
+                 numThreads);
+        benchmarkReport(name, funcCalls[func], numSamples, sampleNs);
+
+        if (numThreads == maxThreads) break;
+    }
+}
+
+double* lat = malloc(NUM_BATCH_POINTS * sizeof(double));
+double* lon = malloc(NUM_BATCH_POINTS * sizeof(double));
+H3Index* batchCells = malloc(NUM_BATCH_POINTS * sizeof(H3Index));
+double* verts =
+    malloc(2 * NUM_BATCH_POINTS * MAX_CELL_BNDRY_VERTS * sizeof(double));
+int* numVerts = malloc(NUM_BATCH_POINTS * sizeof(int));
+for (int i = 0; i < NUM_BATCH_POINTS; i++) {
+    lat[i] = centers[i % numCells].lat + (i / numCells) * 1e-6;
+    lon[i] = centers[i % numCells].lon;
+}
+for (int numThreads = 1;; numThreads *= 2) {
+    if (numThreads > maxThreads) numThreads = maxThreads;
+    ThreadPool* pool = createThreadPool(numThreads);
+    if (pool == NULL) {
+        error("creating benchmark thread pool");
+    }
+
+    snprintf(name, BUFF_SIZE, "geoToH3BatchParallel_threads%d", numThreads);
+    NAMED_BENCHMARK(name, 1, {
+        H3_EXPORT(geoToH3BatchParallel)
+        (lat, lon, NUM_BATCH_POINTS, RES, batchCells, threadPoolFor, pool);
+    });
+
+    snprintf(name, BUFF_SIZE, "h3ToGeoBoundaryBatchParallel_threads%d",
+             numThreads);
+    NAMED_BENCHMARK(name, 1, {
+        H3_EXPORT(h3ToGeoBoundaryBatchParallel)
+        (batchCells, NUM_BATCH_POINTS, verts, numVerts, threadPoolFor, pool);
+    });
+
+    destroyThreadPool(pool);
+    if (numThreads == maxThreads) break;
+}
+free(numVerts);
+free(verts);
+free(batchCells);
+free(lon);
+free(lat);
+
+for (int t = 0; t < maxThreads; t++) {
+    free(states[t]->ring);
+    free(states[t]->compacted);
+    free(states[t]->polyfilled);
+    free(states[t]->boundary);
+    free(states[t]);
+}
+free(states);
+
+END_BENCHMARKS();
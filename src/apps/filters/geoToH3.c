@@ -17,7 +17,7 @@
  * @brief stdin/stdout filter that converts from lat/lon coordinates to integer
  * H3 indexes
  *
- *  usage: `geoToH3 resolution`
+ *  usage: `geoToH3 [--binary] resolution`
  *
  *  The program reads lat/lon pairs from stdin until EOF is encountered. For
  *  each lat/lon the program outputs to stdout the integer H3 index of the
@@ -30,23 +30,55 @@
  *       lat1 lon1
  *       ...
  *       latN lonN
+ *
+ *  With `--binary`, stdin is instead read as packed lat/lon pairs of little
+ *  endian doubles in decimal degrees, and the indexes are written to stdout
+ *  as packed little endian 64 bit integers (see binaryIO.h).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "binaryIO.h"
 #include "coordijk.h"
 #include "h3Index.h"
 #include "utility.h"
 
+/**
+ * Converts packed binary lat/lon pairs on stdin a block at a time.
+ */
+void doBinary(int res) {
+    double lat[BINARY_BLOCK_SIZE];
+    double lon[BINARY_BLOCK_SIZE];
+    H3Index out[BINARY_BLOCK_SIZE];
+    binaryMode(stdin);
+    binaryMode(stdout);
+    int n;
+    while ((n = binaryReadCoords(stdin, lat, lon, BINARY_BLOCK_SIZE)) > 0) {
+        for (int i = 0; i < n; i++) {
+            lat[i] = H3_EXPORT(degsToRads)(lat[i]);
+            lon[i] = H3_EXPORT(degsToRads)(lon[i]);
+        }
+        H3_EXPORT(geoToH3Batch)(lat, lon, n, res, out);
+        binaryWriteIndexes(stdout, out, n);
+    }
+}
+
 int main(int argc, char* argv[]) {
     // get the command line argument resolution
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s resolution\n", argv[0]);
+    int binary = argc > 1 && strcmp(argv[1], "--binary") == 0;
+    if (argc != 2 + binary) {
+        fprintf(stderr, "usage: %s [--binary] resolution\n", argv[0]);
         exit(1);
     }
 
     int res;
-    if (!sscanf(argv[1], "%d", &res)) error("parsing resolution");
+    if (!sscanf(argv[1 + binary], "%d", &res)) error("parsing resolution");
+
+    if (binary) {
+        doBinary(res);
+        return 0;
+    }
 
     // process the lat/lon's on stdin
     char buff[BUFF_SIZE];
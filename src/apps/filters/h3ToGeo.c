@@ -17,7 +17,7 @@
  * @brief stdin/stdout filter that converts from integer H3 indexes to lat/lon
  * cell center point
  *
- *  usage: `h3ToGeo [outputMode kmlName kmlDesc]`
+ *  usage: `h3ToGeo [--binary | outputMode kmlName kmlDesc]`
  *
  *  The program reads H3 indexes from stdin and outputs the corresponding
  *  cell center points to stdout, until EOF is encountered. The H3 indexes
@@ -32,6 +32,10 @@
  *  `kmlName` indicates the string for the desc tag in KML output (only used
  *       when `outputMode` == 1). The default is "generated by h3ToGeo".
  *
+ *  `--binary` reads the H3 indexes as packed little endian 64 bit integers,
+ *       and outputs the cell center points as packed lat/lon pairs of little
+ *       endian doubles in decimal degrees (see binaryIO.h).
+ *
  *  Examples:
  *
  *     `h3ToGeo < indexes.txt`
@@ -41,12 +45,17 @@
  *     `h3ToGeo 1 "kml file" "h3 cells" < indexes.txt > cells.kml`
  *        - creates the KML file `cells.kml` containing the cell center points
  *          for all of the H3 indexes contained in the file `indexes.txt`.
+ *
+ *     `h3ToGeo --binary < indexes.bin > centers.bin`
+ *        - outputs packed cell center points for the packed H3 indexes
+ *          contained in the file `indexes.bin`
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "baseCells.h"
+#include "binaryIO.h"
 #include "coordijk.h"
 #include "geoCoord.h"
 #include "h3Index.h"
@@ -71,13 +80,39 @@ void doCell(H3Index h, int isKmlOut) {
     }
 }
 
+/**
+ * Converts packed binary indexes on stdin a block at a time.
+ */
+void doBinary(void) {
+    H3Index h3[BINARY_BLOCK_SIZE];
+    double lat[BINARY_BLOCK_SIZE];
+    double lon[BINARY_BLOCK_SIZE];
+    binaryMode(stdin);
+    binaryMode(stdout);
+    int n;
+    while ((n = binaryReadIndexes(stdin, h3, BINARY_BLOCK_SIZE)) > 0) {
+        H3_EXPORT(h3ToGeoBatch)(h3, n, lat, lon);
+        for (int i = 0; i < n; i++) {
+            lat[i] = H3_EXPORT(radsToDegs)(lat[i]);
+            lon[i] = H3_EXPORT(radsToDegs)(lon[i]);
+        }
+        binaryWriteCoords(stdout, lat, lon, n);
+    }
+}
+
 int main(int argc, char *argv[]) {
     // check command line args
     if (argc > 5) {
-        fprintf(stderr, "usage: %s [outputMode kmlName kmlDesc]\n", argv[0]);
+        fprintf(stderr, "usage: %s [--binary | outputMode kmlName kmlDesc]\n",
+                argv[0]);
         exit(1);
     }
 
+    if (argc == 2 && strcmp(argv[1], "--binary") == 0) {
+        doBinary();
+        return 0;
+    }
+
     int isKmlOut = 0;
     if (argc > 1) {
         if (!sscanf(argv[1], "%d", &isKmlOut))
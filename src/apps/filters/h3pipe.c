@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief stdin/stdout filter that runs a pipeline of the other filters in
+ * one process
+ *
+ *  usage: `h3pipe [--binary] [--threads n] stage...`
+ *
+ *  The program reads records from stdin until EOF, passes them through the
+ *  stages in order, and writes the records of the last stage to stdout, in
+ *  the order they were read. The stages are:
+ *
+ *  `encode:res` indexes lat/lon pairs at resolution `res`, as geoToH3
+ *  `kring:k` replaces each index by its k-ring, as kRing
+ *  `parent:res` replaces each index by its parent at resolution `res`
+ *  `center` replaces each index by the lat/lon of its center, as h3ToGeo
+ *  `boundary` writes the cell boundary of each index, as h3ToGeoBoundary
+ *
+ *  Each stage reads what the stage before it writes. Input and output are
+ *  in the text formats of those filters, or with `--binary` packed little
+ *  endian records (see binaryIO.h); boundaries are only written as text.
+ *  Records are passed between stages in binary batches, without text.
+ *
+ *  Where the filters are built with threads, every stage runs on `n`
+ *  threads of its own (1 by default), concurrently with the other stages
+ *  and with reading and writing; `--threads 0` runs everything on one
+ *  thread.
+ *
+ *  Example:
+ *
+ *     `h3pipe encode:9 kring:2 boundary < coords.txt`
+ *        - outputs the cell boundaries of the resolution 9 hexagons within
+ *          2 of each coordinate, as would
+ *          `geoToH3 9 | kRing 2 | h3ToGeoBoundary`
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pipeline.h"
+#include "utility.h"
+
+int main(int argc, char* argv[]) {
+    PipeOptions options = {0, 1};
+    PipeStage stages[PIPE_MAX_STAGES];
+    int numStages = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--binary") == 0) {
+            options.binary = 1;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            if (++i == argc || !sscanf(argv[i], "%d", &options.numWorkers) ||
+                options.numWorkers < 0) {
+                error("--threads must be a non-negative integer");
+            }
+        } else if (numStages == PIPE_MAX_STAGES) {
+            error("too many stages");
+        } else if (pipeParseStage(argv[i], &stages[numStages++])) {
+            fprintf(stderr, "unknown stage or bad argument: %s\n", argv[i]);
+            fprintf(stderr,
+                    "usage: %s [--binary] [--threads n] stage...\n"
+                    "stages: encode:res kring:k parent:res center boundary\n",
+                    argv[0]);
+            exit(1);
+        }
+    }
+
+    const char* problem = pipeCheck(stages, numStages, &options);
+    if (problem != NULL) {
+        fprintf(stderr, "usage: %s [--binary] [--threads n] stage...\n",
+                argv[0]);
+        error(problem);
+    }
+
+    setvbuf(stdin, NULL, _IOFBF, PIPE_IO_BUFFER_SIZE);
+    setvbuf(stdout, NULL, _IOFBF, PIPE_IO_BUFFER_SIZE);
+    pipeRun(stages, numStages, &options, stdin, stdout);
+}
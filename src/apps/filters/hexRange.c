@@ -17,7 +17,7 @@
  * @brief stdin/stdout filter that converts from integer H3 indexes to
  * k-rings
  *
- *  usage: `hexRange [k]`
+ *  usage: `hexRange [--binary] [k]`
  *
  *  The program reads H3 indexes from stdin until EOF and outputs
  *  the H3 indexes within k-ring `k` to stdout. Requires all indexes
@@ -26,11 +26,17 @@
  *
  *  If a pentagon or pentagon distortion is encountered, 0 is printed
  *  as the only output.
+ *
+ *  With `--binary`, the indexes are read from stdin and written to stdout as
+ *  packed little endian 64 bit integers (see binaryIO.h), with a single 0
+ *  written on failure as above.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "algos.h"
+#include "binaryIO.h"
 #include "h3Index.h"
 #include "stackAlloc.h"
 #include "utility.h"
@@ -48,16 +54,47 @@ void doCell(H3Index h, int k) {
     }
 }
 
+/**
+ * Converts packed binary indexes on stdin a block at a time.
+ */
+void doBinary(int k) {
+    int maxSize = H3_EXPORT(maxKringSize)(k);
+    H3Index* rings = calloc(maxSize, sizeof(H3Index));
+    if (!rings) error("allocating k-ring");
+    H3Index cells[BINARY_BLOCK_SIZE];
+    binaryMode(stdin);
+    binaryMode(stdout);
+    int n;
+    while ((n = binaryReadIndexes(stdin, cells, BINARY_BLOCK_SIZE)) > 0) {
+        for (int c = 0; c < n; c++) {
+            if (!H3_EXPORT(hexRange)(cells[c], k, rings)) {
+                binaryWriteIndexes(stdout, rings, maxSize);
+            } else {
+                H3Index failed = 0;
+                binaryWriteIndexes(stdout, &failed, 1);
+            }
+        }
+    }
+    free(rings);
+}
+
 int main(int argc, char* argv[]) {
     // check command line args
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s [k]\n", argv[0]);
+    int binary = argc > 1 && strcmp(argv[1], "--binary") == 0;
+    if (argc != 2 + binary) {
+        fprintf(stderr, "usage: %s [--binary] [k]\n", argv[0]);
         exit(1);
     }
 
     int k = 0;
-    if (argc > 1) {
-        if (!sscanf(argv[1], "%d", &k)) error("k must be an integer");
+    if (argc > 1 + binary) {
+        if (!sscanf(argv[1 + binary], "%d", &k)) error("k must be an integer");
+    }
+    if (H3_EXPORT(maxKringSize)(k) < 0) error("k is too large");
+
+    if (binary) {
+        doBinary(k);
+        return 0;
     }
 
     // process the indexes on stdin
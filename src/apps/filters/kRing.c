@@ -17,15 +17,20 @@
  * @brief stdin/stdout filter that converts from integer H3 indexes to
  * k-rings
  *
- *  usage: `kRing [k]`
+ *  usage: `kRing [--binary] [k]`
  *
  *  The program reads H3 indexes from stdin until EOF and outputs
  *  the H3 indexes within k-ring `k` to stdout.
+ *
+ *  With `--binary`, the indexes are read from stdin and written to stdout as
+ *  packed little endian 64 bit integers (see binaryIO.h).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "algos.h"
+#include "binaryIO.h"
 #include "h3Index.h"
 #include "stackAlloc.h"
 #include "utility.h"
@@ -42,16 +47,49 @@ void doCell(H3Index h, int k) {
     }
 }
 
+/**
+ * Converts packed binary indexes on stdin a block at a time, writing the
+ * k-ring of each without the empty slots.
+ */
+void doBinary(int k) {
+    int maxSize = H3_EXPORT(maxKringSize)(k);
+    H3Index* rings = calloc(maxSize, sizeof(H3Index));
+    if (!rings) error("allocating k-ring");
+    H3Index cells[BINARY_BLOCK_SIZE];
+    binaryMode(stdin);
+    binaryMode(stdout);
+    int n;
+    while ((n = binaryReadIndexes(stdin, cells, BINARY_BLOCK_SIZE)) > 0) {
+        for (int c = 0; c < n; c++) {
+            memset(rings, 0, maxSize * sizeof(H3Index));
+            H3_EXPORT(kRing)(cells[c], k, rings);
+            int count = 0;
+            for (int i = 0; i < maxSize; i++) {
+                if (rings[i] != 0) rings[count++] = rings[i];
+            }
+            binaryWriteIndexes(stdout, rings, count);
+        }
+    }
+    free(rings);
+}
+
 int main(int argc, char* argv[]) {
     // check command line args
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s [k]\n", argv[0]);
+    int binary = argc > 1 && strcmp(argv[1], "--binary") == 0;
+    if (argc != 2 + binary) {
+        fprintf(stderr, "usage: %s [--binary] [k]\n", argv[0]);
         exit(1);
     }
 
     int k = 0;
-    if (argc > 1) {
-        if (!sscanf(argv[1], "%d", &k)) error("k must be an integer");
+    if (argc > 1 + binary) {
+        if (!sscanf(argv[1 + binary], "%d", &k)) error("k must be an integer");
+    }
+    if (H3_EXPORT(maxKringSize)(k) < 0) error("k is too large");
+
+    if (binary) {
+        doBinary(k);
+        return 0;
     }
 
     // process the indexes on stdin
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief measures how far the library's encoding and decoding are from the
+ * test corpus and from another build, to check a build with H3_FAST_MATH
+ * against an exact one.
+ *
+ *  usage: `fastMathAccuracy [--write reference | --read reference] file...`
+ *
+ *  Each file is one of the test input files. Those named `*cells.txt` hold
+ *  cell boundaries, `rand*centers.txt` points inside cells and the others
+ *  cell centers. For every file the program reports the largest distance
+ *  between the centers or boundary vertices `h3ToGeo` and `h3ToGeoBoundary`
+ *  return and those of the file, and counts the points `geoToH3` does not
+ *  encode to their own cell.
+ *
+ *  For boundaries it also moves from each vertex toward the middle of the
+ *  cell by 1 cm, 1 mm and 0.1 mm, and counts the points `geoToH3` does not
+ *  encode to the cell. The files store degrees to 6 to 10 decimal places,
+ *  from about 10 cm to 0.01 mm, which bounds what the comparison with them
+ *  can show.
+ *
+ *  `--write` saves every coordinate and index computed to the reference
+ *  file, and `--read` compares those computed with the reference saved by
+ *  another build with the same files, reporting the largest distance
+ *  between the coordinates and the number of indexes that differ.
+ *  Distances are computed here with libm.
+ *
+ *  Examples:
+ *  ---------
+ *
+ *     `fastMathAccuracy --write exact.txt tests/inputfiles/res03ic.txt`
+ *        - with an exact build, saves the reference
+ *
+ *     `fastMathAccuracy --read exact.txt tests/inputfiles/res03ic.txt`
+ *        - with a build with H3_FAST_MATH, compares with the reference
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "constants.h"
+#include "h3api.h"
+#include "utility.h"
+
+/** distances in meters from the vertices at which points are encoded */
+static const double insetMeters[] = {1e-2, 1e-3, 1e-4};
+#define NUM_INSETS (int)(sizeof(insetMeters) / sizeof(insetMeters[0]))
+
+/** The reference file, and whether it is written or read */
+static FILE* reference = NULL;
+static int writeReference = 0;
+
+/** @brief The measurements of one file */
+typedef struct {
+    int numCells;
+    double maxErrorMm;
+    int mismatches;
+    int insetMismatches[NUM_INSETS];
+    double maxReferenceMm;
+    int referenceMismatches;
+} Accuracy;
+
+/**
+ * Converts a coordinate to a unit vector with libm.
+ */
+static void toUnit(const GeoCoord* g, double v[3]) {
+    v[0] = cos(g->lat) * cos(g->lon);
+    v[1] = cos(g->lat) * sin(g->lon);
+    v[2] = sin(g->lat);
+}
+
+/**
+ * Converts a unit vector to a coordinate with libm.
+ */
+static void fromUnit(const double v[3], GeoCoord* g) {
+    g->lat = atan2(v[2], sqrt(v[0] * v[0] + v[1] * v[1]));
+    g->lon = atan2(v[1], v[0]);
+}
+
+/**
+ * The distance between two coordinates in millimeters, along the chord,
+ * which is indistinguishable from the arc at these distances.
+ */
+static double distMm(const GeoCoord* a, const GeoCoord* b) {
+    double u[3], v[3];
+    toUnit(a, u);
+    toUnit(b, v);
+    double d = 0;
+    for (int i = 0; i < 3; i++) d += (u[i] - v[i]) * (u[i] - v[i]);
+    return sqrt(d) * EARTH_RADIUS_KM * 1e6;
+}
+
+/**
+ * Writes a computed coordinate to the reference, or compares it with the
+ * reference.
+ */
+static void referenceCoord(const GeoCoord* g, Accuracy* acc) {
+    if (!reference) return;
+    if (writeReference) {
+        fprintf(reference, "%.17g %.17g\n", g->lat, g->lon);
+        return;
+    }
+    GeoCoord r;
+    if (fscanf(reference, "%lf %lf", &r.lat, &r.lon) != 2) {
+        error("reading coordinate from reference");
+    }
+    double d = distMm(g, &r);
+    if (d > acc->maxReferenceMm) acc->maxReferenceMm = d;
+}
+
+/**
+ * Writes a computed index to the reference, or compares it with the
+ * reference.
+ */
+static void referenceIndex(H3Index h, Accuracy* acc) {
+    if (!reference) return;
+    if (writeReference) {
+        fprintf(reference, "%" PRIx64 "\n", h);
+        return;
+    }
+    H3Index r;
+    if (fscanf(reference, "%" SCNx64, &r) != 1) {
+        error("reading index from reference");
+    }
+    if (r != h) acc->referenceMismatches++;
+}
+
+/**
+ * Measures a file of cell centers, or of points in cells.
+ */
+static void measureCenters(FILE* f, int isCenters, Accuracy* acc) {
+    H3Index h;
+    GeoCoord expected;
+    while (readCenters(f, 1, &h, &expected) == 1) {
+        acc->numCells++;
+        if (isCenters) {
+            GeoCoord g;
+            H3_EXPORT(h3ToGeo)(h, &g);
+            double err = distMm(&g, &expected);
+            if (err > acc->maxErrorMm) acc->maxErrorMm = err;
+            referenceCoord(&g, acc);
+        }
+        int res = H3_EXPORT(h3GetResolution)(h);
+        H3Index encoded = H3_EXPORT(geoToH3)(&expected, res);
+        if (encoded != h) acc->mismatches++;
+        referenceIndex(encoded, acc);
+    }
+}
+
+/**
+ * Measures a file of cell boundaries.
+ */
+static void measureBoundaries(FILE* f, Accuracy* acc) {
+    char buff[BUFF_SIZE];
+    while (fgets(buff, BUFF_SIZE, f)) {
+        H3Index h = H3_EXPORT(stringToH3)(buff);
+        GeoBoundary expected;
+        if (readBoundary(f, &expected) != 0) error("reading cell boundary");
+        int res = H3_EXPORT(h3GetResolution)(h);
+        acc->numCells++;
+
+        GeoBoundary b;
+        H3_EXPORT(h3ToGeoBoundary)(h, &b);
+        if (b.numVerts != expected.numVerts) {
+            error("number of vertices differs from input");
+        }
+        for (int v = 0; v < b.numVerts; v++) {
+            double err = distMm(&b.verts[v], &expected.verts[v]);
+            if (err > acc->maxErrorMm) acc->maxErrorMm = err;
+            referenceCoord(&b.verts[v], acc);
+        }
+
+        // The middle of the cell, as the direction of the sum of its vertices
+        double mid[3] = {0, 0, 0};
+        for (int v = 0; v < expected.numVerts; v++) {
+            double u[3];
+            toUnit(&expected.verts[v], u);
+            for (int i = 0; i < 3; i++) mid[i] += u[i];
+        }
+        for (int v = 0; v < expected.numVerts; v++) {
+            double u[3];
+            toUnit(&expected.verts[v], u);
+            // The unit tangent at the vertex toward the middle
+            double dot = u[0] * mid[0] + u[1] * mid[1] + u[2] * mid[2];
+            double t[3];
+            double norm = 0;
+            for (int i = 0; i < 3; i++) {
+                t[i] = mid[i] - dot * u[i];
+                norm += t[i] * t[i];
+            }
+            norm = sqrt(norm);
+            for (int k = 0; k < NUM_INSETS; k++) {
+                double a = insetMeters[k] / (EARTH_RADIUS_KM * 1e3);
+                double p[3];
+                for (int i = 0; i < 3; i++) {
+                    p[i] = cos(a) * u[i] + sin(a) * t[i] / norm;
+                }
+                GeoCoord g;
+                fromUnit(p, &g);
+                H3Index encoded = H3_EXPORT(geoToH3)(&g, res);
+                if (encoded != h) acc->insetMismatches[k]++;
+                referenceIndex(encoded, acc);
+            }
+        }
+    }
+}
+
+static void printAccuracy(const char* name, const Accuracy* acc) {
+    printf("%-20s %7d %10.6f %6d ", name, acc->numCells, acc->maxErrorMm,
+           acc->mismatches);
+    for (int k = 0; k < NUM_INSETS; k++) {
+        printf(" %6d", acc->insetMismatches[k]);
+    }
+    if (reference && !writeReference) {
+        printf("  %10.6f %6d", acc->maxReferenceMm, acc->referenceMismatches);
+    }
+    printf("\n");
+}
+
+static void addAccuracy(Accuracy* total, const Accuracy* acc) {
+    total->numCells += acc->numCells;
+    total->maxErrorMm = fmax(total->maxErrorMm, acc->maxErrorMm);
+    total->mismatches += acc->mismatches;
+    for (int k = 0; k < NUM_INSETS; k++) {
+        total->insetMismatches[k] += acc->insetMismatches[k];
+    }
+    total->maxReferenceMm = fmax(total->maxReferenceMm, acc->maxReferenceMm);
+    total->referenceMismatches += acc->referenceMismatches;
+}
+
+/**
+ * Tests whether a file name ends with a suffix.
+ */
+static int endsWith(const char* name, const char* suffix) {
+    size_t len = strlen(name);
+    size_t suffixLen = strlen(suffix);
+    return len >= suffixLen && !strcmp(name + len - suffixLen, suffix);
+}
+
+int main(int argc, char* argv[]) {
+    int first = 1;
+    if (argc > 2 &&
+        (!strcmp(argv[1], "--write") || !strcmp(argv[1], "--read"))) {
+        writeReference = !strcmp(argv[1], "--write");
+        reference = fopen(argv[2], writeReference ? "w" : "r");
+        if (!reference) error("opening reference file");
+        first = 3;
+    }
+    if (first >= argc) {
+        printf("usage: %s [--write reference | --read reference] file...\n",
+               argv[0]);
+        return 1;
+    }
+
+    printf("%-20s %7s %10s %6s ", "file", "cells", "max err mm", "misses");
+    for (int k = 0; k < NUM_INSETS; k++) {
+        printf(" %5gm", insetMeters[k]);
+    }
+    if (reference && !writeReference) {
+        printf("  %10s %6s", "ref max mm", "ref misses");
+    }
+    printf("\n");
+
+    Accuracy total = {0};
+    for (int i = first; i < argc; i++) {
+        FILE* f = fopen(argv[i], "r");
+        if (!f) error("opening input file");
+        const char* name = strrchr(argv[i], '/');
+        name = name ? name + 1 : argv[i];
+
+        Accuracy acc = {0};
+        if (endsWith(name, "cells.txt")) {
+            measureBoundaries(f, &acc);
+        } else {
+            measureCenters(f, strncmp(name, "rand", 4) != 0, &acc);
+        }
+        fclose(f);
+        printAccuracy(name, &acc);
+        addAccuracy(&total, &acc);
+    }
+    printAccuracy("all", &total);
+
+    if (reference) fclose(reference);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file generateHexRadiusTable.c
+ * @brief Generates the minHexRadiusKm table used by bboxHexRadius
+ *
+ *  usage: `generateHexRadiusTable`
+ *
+ *  The program generates, for each resolution, a lower bound on the
+ *  distance in Km from the center of any cell to its first vertex, as
+ *  measured by _hexRadiusKm.
+ *
+ *  Resolutions up to EXHAUSTIVE_RES are measured over every cell. Each
+ *  finer resolution is derived from the one two resolutions coarser, whose
+ *  cells have 7 times the radius once distortion is accounted for. The
+ *  measured ratio between resolutions two apart approaches 7 from above and
+ *  is below 7.08 past resolution 2, so dividing by MAX_RATIO keeps the
+ *  derived values below the true minimums. The derived values are checked
+ *  against the cells within CHECK_K of every pentagon, where the smallest
+ *  cells are, and the program fails if any is smaller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "baseCells.h"
+#include "bbox.h"
+#include "constants.h"
+#include "h3Index.h"
+
+/** finest resolution measured over every cell */
+#define EXHAUSTIVE_RES 5
+
+/** upper bound on the ratio of minimum radii two resolutions apart */
+#define MAX_RATIO 7.1
+
+/** distance from each pentagon of the cells checked at derived resolutions */
+#define CHECK_K 3
+
+/**
+ * Returns the smallest radius of any cell at the given resolution.
+ *
+ * @param res The resolution
+ * @return The smallest radius in Km
+ */
+static double minRadiusKm(int res) {
+    double minRadius = -1;
+    H3Index* children = calloc(H3_EXPORT(maxH3ToChildrenSize)(0, res),
+                               sizeof(H3Index));
+    for (int i = 0; i < NUM_BASE_CELLS; i++) {
+        H3Index bc;
+        setH3Index(&bc, 0, i, 0);
+        int childrenSz = H3_EXPORT(maxH3ToChildrenSize)(bc, res);
+        for (int j = 0; j < childrenSz; j++) {
+            children[j] = 0;
+        }
+        H3_EXPORT(h3ToChildren)(bc, res, children);
+        for (int j = 0; j < childrenSz; j++) {
+            if (children[j] == 0) continue;
+            double radius = _hexRadiusKm(children[j]);
+            if (minRadius < 0 || radius < minRadius) {
+                minRadius = radius;
+            }
+        }
+    }
+    free(children);
+    return minRadius;
+}
+
+/**
+ * Returns the smallest radius of the cells within CHECK_K of any pentagon
+ * at the given resolution.
+ *
+ * @param res The resolution
+ * @return The smallest radius in Km
+ */
+static double minPentagonRadiusKm(int res) {
+    double minRadius = -1;
+    H3Index ring[H3_MAX_KRING_SIZE(CHECK_K)];
+    for (int i = 0; i < NUM_BASE_CELLS; i++) {
+        if (!_isBaseCellPentagon(i)) continue;
+        H3Index pentagon;
+        setH3Index(&pentagon, res, i, 0);
+        for (int j = 0; j < H3_MAX_KRING_SIZE(CHECK_K); j++) {
+            ring[j] = 0;
+        }
+        H3_EXPORT(kRing)(pentagon, CHECK_K, ring);
+        for (int j = 0; j < H3_MAX_KRING_SIZE(CHECK_K); j++) {
+            if (ring[j] == 0) continue;
+            double radius = _hexRadiusKm(ring[j]);
+            if (minRadius < 0 || radius < minRadius) {
+                minRadius = radius;
+            }
+        }
+    }
+    return minRadius;
+}
+
+/**
+ * Generates and prints the minHexRadiusKm table.
+ */
+static void generate() {
+    double table[MAX_H3_RES + 1];
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        if (res <= EXHAUSTIVE_RES) {
+            table[res] = minRadiusKm(res);
+        } else {
+            table[res] = table[res - 2] / MAX_RATIO;
+            if (minPentagonRadiusKm(res) < table[res]) {
+                fprintf(stderr, "derived radius at res %d is not a bound\n",
+                        res);
+                exit(1);
+            }
+        }
+    }
+
+    printf("static const double minHexRadiusKm[MAX_H3_RES + 1] = {\n");
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        printf("    %.12e,  // res %d%s\n", table[res], res,
+               res > EXHAUSTIVE_RES ? " (derived)" : "");
+    }
+    printf("};\n");
+}
+
+int main(int argc, char* argv[]) {
+    // check command line args
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        exit(1);
+    }
+
+    generate();
+}
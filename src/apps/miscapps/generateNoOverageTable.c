@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file generateNoOverageTable.c
+ * @brief Generates the baseCellNoOverage table used by _h3ToFaceIjk
+ *
+ *  usage: `generateNoOverageTable`
+ *
+ *  The program marks, for each base cell, the cells of resolution
+ *  NO_OVERAGE_RES whose descendants all lie on the home face of the base
+ *  cell, so that decoding them needs no overage adjustment.
+ *
+ *  Relative to the center of a cell, the center of a descendant n
+ *  resolutions finer is the sum of n digit vectors, each shorter than the
+ *  one before by a factor sqrt(7). In units of the distance between the
+ *  centers of the cell's resolution, they are all within
+ *  1 / (sqrt(7) - 1) of its center. The home face is the triangle
+ *  i + j + k <= maxDim of normalized Class II coordinates, whose vertices
+ *  are maxDim along each of the axes, so the descendants are on it when
+ *  that disk is. The marked cells are then audited by decoding their
+ *  descendants to AUDIT_RES with the overage adjustment.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "baseCells.h"
+#include "constants.h"
+#include "coordijk.h"
+#include "faceijk.h"
+#include "h3Index.h"
+#include "vec2d.h"
+
+/** finest resolution whose descendants the audit decodes */
+#define AUDIT_RES 7
+
+/** margin kept from the face edges, for rounding */
+#define EDGE_MARGIN 1e-9
+
+/** 7 to the power NO_OVERAGE_RES, the number of digit sequences */
+#define NUM_PREFIXES 49
+
+/**
+ * Determines whether every descendant of a cell of resolution
+ * NO_OVERAGE_RES lies on the home face of its base cell.
+ *
+ * @param baseCell The base cell
+ * @param digits The digits of the cell, from resolution 1
+ * @return 1 if no descendant needs an overage adjustment
+ */
+static int noOverage(int baseCell, const int* digits) {
+    int cellDigits[MAX_H3_RES + 1];
+    for (int r = 1; r <= NO_OVERAGE_RES; r++) {
+        cellDigits[r] = digits[r - 1];
+    }
+    CoordIJK ijk = baseCellData[baseCell].homeFijk.coord;
+    _downAp7Digits(&ijk, NO_OVERAGE_RES, cellDigits);
+
+    // The same center in Class II coordinates
+    int res = NO_OVERAGE_RES;
+    double radius = 1.0 / (sqrt(7.0) - 1.0);
+    if (isResClassIII(res)) {
+        _downAp7r(&ijk);
+        res++;
+        radius *= sqrt(7.0);
+    }
+    double maxDim = 2.0;
+    for (int r = 0; r < res; r += 2) maxDim *= 7.0;
+
+    Vec2d v;
+    _ijkToHex2d(&ijk, &v);
+    // the inward distance to each edge is maxDim / 2 plus the projection of
+    // the center onto the axis of the opposite vertex
+    double axes[3][2] = {{1.0, 0.0}, {-0.5, M_SQRT3_2}, {-0.5, -M_SQRT3_2}};
+    for (int a = 0; a < 3; a++) {
+        double distance = maxDim / 2 + v.x * axes[a][0] + v.y * axes[a][1];
+        if (distance < radius + EDGE_MARGIN) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks that no descendant of a marked cell, down to AUDIT_RES, needs an
+ * overage adjustment when decoded.
+ *
+ * @param table The generated table
+ */
+static void auditNoOverage(const uint64_t* table) {
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index bc;
+        setH3Index(&bc, 0, baseCell, CENTER_DIGIT);
+        for (int res = NO_OVERAGE_RES; res <= AUDIT_RES; res++) {
+            int numChildren = H3_EXPORT(maxH3ToChildrenSize)(bc, res);
+            H3Index* children = calloc(numChildren, sizeof(H3Index));
+            H3_EXPORT(h3ToChildren)(bc, res, children);
+            for (int i = 0; i < numChildren; i++) {
+                H3Index h = children[i];
+                if (h == 0) continue;
+                if (_isBaseCellPentagon(baseCell) &&
+                    _h3LeadingNonZeroDigit(h) == 5) {
+                    h = _h3Rotate60cw(h);
+                }
+                int prefix = H3_GET_INDEX_DIGIT(h, 1) * 8 +
+                             H3_GET_INDEX_DIGIT(h, 2);
+                if (!((table[baseCell] >> prefix) & 1)) continue;
+
+                FaceIJK fijk = baseCellData[baseCell].homeFijk;
+                _h3ToFaceIjkWithInitializedFijk(h, &fijk);
+                int classIIRes = res;
+                if (isResClassIII(res)) {
+                    _downAp7r(&fijk.coord);
+                    classIIRes++;
+                }
+                if (_adjustOverageClassII(&fijk, classIIRes, 0, 0)) {
+                    printf("overage for marked cell %" PRIx64 "\n", h);
+                    exit(1);
+                }
+            }
+            free(children);
+        }
+    }
+}
+
+/**
+ * Generates and prints the baseCellNoOverage table.
+ */
+static void generate() {
+    uint64_t table[NUM_BASE_CELLS] = {0};
+    int numMarked = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        for (int p = 0; p < NUM_PREFIXES; p++) {
+            int digits[NO_OVERAGE_RES] = {p / 7, p % 7};
+            if (noOverage(baseCell, digits)) {
+                table[baseCell] |= UINT64_C(1) << (digits[0] * 8 + digits[1]);
+                numMarked++;
+            }
+        }
+    }
+    auditNoOverage(table);
+
+    printf("// %d of %d cells of resolution %d are marked\n", numMarked,
+           NUM_BASE_CELLS * NUM_PREFIXES, NO_OVERAGE_RES);
+    printf("const uint64_t baseCellNoOverage[NUM_BASE_CELLS] = {\n");
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        printf("    UINT64_C(0x%016" PRIx64 "),  // base cell %d\n",
+               table[baseCell], baseCell);
+    }
+    printf("};\n");
+}
+
+int main(int argc, char* argv[]) {
+    // check command line args
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        exit(1);
+    }
+
+    generate();
+}
@@ -17,7 +17,8 @@
  * @brief takes an H3 index and generates cell boundaries for all descendants
  * at a specified resolution.
  *
- *  usage: `h3ToGeoBoundaryHier H3Index [resolution outputMode]`
+ *  usage: `h3ToGeoBoundaryHier [--threads n --output prefix] H3Index
+ *  [resolution outputMode]`
  *
  *  The program generates the cell boundaries in lat/lon coordinates for all
  *  hierarchical children of H3Index at the specified resolution. If the
@@ -28,7 +29,14 @@
  *       specified cell H3Index would be processed).
  *
  *  `outputMode` indicates the type of output; currently the choices are 0 for
- *       plain text output (the default) and 1 for KML output.
+ *       plain text output (the default), 1 for KML output and 2 for GeoJSON
+ *       output.
+ *
+ *  `--threads` splits the cells between n threads, 0 for one per processor,
+ *       each writing to a shard file of its own, `prefix.0` to
+ *       `prefix.<n - 1>`, named by `--output`. Every shard is a complete
+ *       output in the chosen mode, and its cells are in no particular order.
+ *       Without `--output`, the cells are written to stdout in order.
  *
  *  Examples:
  *  ---------
@@ -41,10 +49,19 @@
  *        - outputs the cell boundaries of all of the resolution 4 descendants
  *          of cell `820ceffffffffff` as a KML file (redirected to `cells.kml`).
  *
+ *     `h3ToGeoBoundaryHier 8029fffffffffff 6 2 > cells.geojson`
+ *        - outputs the cell boundaries of all of the resolution 6
+ *          descendants of cell `8029fffffffffff` as a GeoJSON
+ *          FeatureCollection.
+ *
  *     `h3ToGeoBoundaryHier 86283082fffffff 9 1 > uber9cells.kml`
  *        - creates a KML file containing the cell boundaries of all of the
  *          resolution 9 hexagons covering Uber HQ and the surrounding region of
  *          San Francisco
+ *
+ *     `h3ToGeoBoundaryHier --threads 4 --output res5 8001fffffffffff 5 2`
+ *        - writes the cell boundaries of the resolution 5 descendants of base
+ *          cell 0 to four GeoJSON files, `res5.0` to `res5.3`.
  */
 
 #include <stdio.h>
@@ -52,63 +69,99 @@
 #include <string.h>
 #include "baseCells.h"
 #include "coordijk.h"
+#include "geoWriter.h"
 #include "geoCoord.h"
 #include "h3Index.h"
 #include "h3api.h"
-#include "kml.h"
+#include "hierDump.h"
 #include "utility.h"
 #include "vec2d.h"
 
-void doCell(H3Index h, int isKmlOut) {
+/** @brief How the shards are written */
+typedef struct {
+    const HierOptions* options;  ///< the common options
+    int outputMode;              ///< 0 for text, 1 for KML, 2 for GeoJSON
+    char name[BUFF_SIZE];        ///< the name of KML and GeoJSON documents
+} BoundaryOutput;
+
+/** @brief A shard of the output */
+typedef struct {
+    FILE* f;            ///< the file of the shard
+    GeoWriter* writer;  ///< the KML or GeoJSON writer, or NULL for text
+} BoundaryShard;
+
+void doCell(H3Index h, BoundaryShard* shard) {
     GeoBoundary b;
     H3_EXPORT(h3ToGeoBoundary)(h, &b);
 
     char label[BUFF_SIZE];
     H3_EXPORT(h3ToString)(h, label, BUFF_SIZE);
 
-    if (isKmlOut) {
-        outputBoundaryKML(&b, label);
+    if (shard->writer) {
+        geoWriterBoundary(shard->writer, &b, label);
     } else {
-        printf("%s\n", label);
-        geoBoundaryPrintln(&b);
+        fprintf(shard->f, "%s\n{\n", label);
+        for (int v = 0; v < b.numVerts; v++) {
+            char coords[BUFF_SIZE];
+            geoToStringDegsNoFmt(&b.verts[v], coords);
+            fprintf(shard->f, "   %s\n", coords);
+        }
+        fprintf(shard->f, "}\n");
     }
 }
 
-void recursiveH3IndexToGeo(H3Index h, int res, int isKmlOut) {
-    for (int d = 0; d < 7; d++) {
-        H3_SET_INDEX_DIGIT(h, res, d);
-
-        // skip the pentagonal deleted subsequence
-
-        if (_isBaseCellPentagon(H3_GET_BASE_CELL(h)) &&
-            _h3LeadingNonZeroDigit(h) == 1) {
-            continue;
-        }
+void* openShard(void* context, int shard, int numShards) {
+    (void)numShards;
+    const BoundaryOutput* output = context;
+    BoundaryShard* s = malloc(sizeof(BoundaryShard));
+    if (s == NULL) error("allocating shard");
+    s->f = hierOpenShard(output->options, shard);
+    s->writer = NULL;
+    if (output->outputMode) {
+        GeoWriterFormat format =
+            output->outputMode == 1 ? GEO_WRITER_KML : GEO_WRITER_GEOJSON;
+        s->writer =
+            geoWriterCreate(s->f, format, output->name, "cell boundary");
+    }
+    return s;
+}
 
-        if (res == H3_GET_RESOLUTION(h)) {
-            doCell(h, isKmlOut);
-        } else {
-            recursiveH3IndexToGeo(h, res + 1, isKmlOut);
-        }
+void writeShard(void* shard, const H3Index* cells, int numCells) {
+    for (int i = 0; i < numCells; i++) {
+        doCell(cells[i], shard);
     }
 }
 
+void closeShard(void* shard) {
+    BoundaryShard* s = shard;
+    if (s->writer) geoWriterClose(s->writer);
+    hierCloseShard(s->f);
+    free(s);
+}
+
 int main(int argc, char* argv[]) {
+    HierOptions options;
+    argc = hierParseOptions(argc, argv, &options);
+
     // check command line args
     if (argc < 2 || argc > 5) {
-        fprintf(stderr, "usage: %s H3Index [resolution outputMode]\n", argv[0]);
+        fprintf(stderr,
+                "usage: %s [--threads n --output prefix] H3Index "
+                "[resolution outputMode]\n",
+                argv[0]);
         exit(1);
     }
+    if (options.binary) error("cell boundaries have no binary output");
 
     H3Index rootCell = H3_EXPORT(stringToH3)(argv[1]);
     int baseCell = H3_GET_BASE_CELL(rootCell);
     int rootRes = H3_GET_RESOLUTION(rootCell);
-    if (baseCell < 0 || baseCell >= NUM_BASE_CELLS) {
+    if (rootCell == 0 || baseCell < 0 || baseCell >= NUM_BASE_CELLS) {
         error("invalid base cell number");
     }
 
     int res = 0;
-    int isKmlOut = 0;
+    BoundaryOutput output = {&options, 0, ""};
     if (argc > 2) {
         if (!sscanf(argv[2], "%d", &res))
             error("resolution must be an integer");
@@ -117,35 +170,21 @@ int main(int argc, char* argv[]) {
             error("specified resolution exceeds max resolution");
 
         if (argc > 3) {
-            if (!sscanf(argv[3], "%d", &isKmlOut))
+            if (!sscanf(argv[3], "%d", &output.outputMode))
                 error("outputMode must be an integer");
 
-            if (isKmlOut != 0 && isKmlOut != 1)
-                error("outputMode must be 0 or 1");
+            if (output.outputMode < 0 || output.outputMode > 2)
+                error("outputMode must be 0, 1 or 2");
 
-            if (isKmlOut) {
-                char index[BUFF_SIZE];
-                char name[BUFF_SIZE];
-                char desc[BUFF_SIZE];
-
-                H3_EXPORT(h3ToString)(rootCell, index, BUFF_SIZE);
-                sprintf(name, "Cell %s Res %d", index,
-                        ((res <= rootRes) ? rootRes : res));
-                sprintf(desc, "cell boundary");
-
-                kmlBoundaryHeader(name, desc);
-            }
+            char index[17];
+            H3_EXPORT(h3ToString)(rootCell, index, sizeof(index));
+            sprintf(output.name, "Cell %s Res %d", index,
+                    ((res <= rootRes) ? rootRes : res));
         }
     }
 
-    // generate the points
-
-    if (res <= rootRes) {
-        doCell(rootCell, isKmlOut);
-    } else {
-        H3_SET_RESOLUTION(rootCell, res);
-        recursiveH3IndexToGeo(rootCell, rootRes + 1, isKmlOut);
-    }
+    // generate the cells
 
-    if (isKmlOut) kmlBoundaryFooter();
+    HierOutput hierOutput = {openShard, writeShard, closeShard, &output};
+    hierDump(rootCell, res, options.numThreads, &hierOutput);
 }
@@ -17,7 +17,8 @@
  * @brief takes an optional H3 index and generates all descendant cells at the
  * specified resolution.
  *
- *  usage: `h3ToHier [resolution H3Index]`
+ *  usage: `h3ToHier [--threads n --output prefix --binary] [resolution
+ *  H3Index]`
  *
  *  The program generates all cells at the specified resolution, optionally
  *  only the children of the given index.
@@ -27,45 +28,77 @@
  *
  *  `H3Index` should be an H3Index. By default, all indices at the specified
  *       resolution are generated.
+ *
+ *  `--threads` splits the cells between n threads, 0 for one per processor,
+ *       each writing to a shard file of its own, `prefix.0` to
+ *       `prefix.<n - 1>`, named by `--output`. The cells of a shard are in no
+ *       particular order. Without `--output`, the cells are written to
+ *       stdout in order.
+ *
+ *  `--binary` writes the indexes as packed little endian 64 bit integers
+ *       (see binaryIO.h), instead of hexadecimal text.
+ *
+ *  Examples:
+ *  ---------
+ *
+ *     `h3ToHier --threads 8 --output res10 --binary 10`
+ *        - writes every resolution 10 cell to the binary shards `res10.0` to
+ *          `res10.7`
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 #include "baseCells.h"
-#include "coordijk.h"
-#include "geoCoord.h"
+#include "binaryIO.h"
 #include "h3Index.h"
 #include "h3api.h"
-#include "kml.h"
+#include "hierDump.h"
 #include "utility.h"
-#include "vec2d.h"
 
-#include "algos.h"
+/** @brief A shard of the output */
+typedef struct {
+    FILE* f;     ///< the file of the shard
+    int binary;  ///< whether the indexes are written packed
+} IndexShard;
 
-void recursiveH3IndexToHier(H3Index h, int res) {
-    for (int d = 0; d < 7; d++) {
-        H3_SET_INDEX_DIGIT(h, res, d);
-
-        // skip the pentagonal deleted subsequence
-
-        if (_isBaseCellPentagon(H3_GET_BASE_CELL(h)) &&
-            _h3LeadingNonZeroDigit(h) == 1) {
-            continue;
-        }
+void* openShard(void* context, int shard, int numShards) {
+    (void)numShards;
+    const HierOptions* options = context;
+    IndexShard* s = malloc(sizeof(IndexShard));
+    if (s == NULL) error("allocating shard");
+    s->f = hierOpenShard(options, shard);
+    s->binary = options->binary;
+    return s;
+}
 
-        if (res == H3_GET_RESOLUTION(h)) {
-            h3Println(h);
-        } else {
-            recursiveH3IndexToHier(h, res + 1);
+void writeShard(void* shard, const H3Index* cells, int numCells) {
+    IndexShard* s = shard;
+    if (s->binary) {
+        binaryWriteIndexes(s->f, cells, numCells);
+    } else {
+        for (int i = 0; i < numCells; i++) {
+            fprintf(s->f, "%" PRIx64 "\n", cells[i]);
         }
     }
 }
 
+void closeShard(void* shard) {
+    IndexShard* s = shard;
+    hierCloseShard(s->f);
+    free(s);
+}
+
 int main(int argc, char* argv[]) {
+    HierOptions options;
+    argc = hierParseOptions(argc, argv, &options);
+
     // check command line args
     if (argc < 2 || argc > 3) {
-        fprintf(stderr, "usage: %s [resolution H3Index]\n", argv[0]);
+        fprintf(stderr,
+                "usage: %s [--threads n --output prefix --binary] "
+                "[resolution H3Index]\n",
+                argv[0]);
         exit(1);
     }
 
@@ -83,28 +116,6 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    if (prefixIndex == 0) {
-        // Generate all
-        for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
-            H3Index rootCell = H3_INIT;
-            H3_SET_MODE(rootCell, H3_HEXAGON_MODE);
-            H3_SET_BASE_CELL(rootCell, bc);
-            if (res == 0) {
-                h3Println(rootCell);
-            } else {
-                H3_SET_RESOLUTION(rootCell, res);
-                recursiveH3IndexToHier(rootCell, 1);
-            }
-        }
-    } else {
-        // prefix is the same or higher resolution than
-        // the target.
-        if (res <= H3_GET_RESOLUTION(prefixIndex)) {
-            h3Println(prefixIndex);
-        } else {
-            int rootRes = H3_GET_RESOLUTION(prefixIndex);
-            H3_SET_RESOLUTION(prefixIndex, res);
-            recursiveH3IndexToHier(prefixIndex, rootRes + 1);
-        }
-    }
+    HierOutput output = {openShard, writeShard, closeShard, &options};
+    hierDump(prefixIndex, res, options.numThreads, &output);
 }
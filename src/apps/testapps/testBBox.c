@@ -110,6 +110,25 @@ TEST(transmeridian) {
              "Does not contain expected east outside point");
 }
 
+TEST(transmeridianUneven) {
+    // Vertices on each side of the antimeridian are not all at the same
+    // longitude, so the box must span the innermost vertex on each side
+    const GeoCoord verts[] = {{0.4, M_PI - 0.1},
+                              {0.4, -M_PI + 0.2},
+                              {-0.4, -M_PI + 0.1},
+                              {-0.4, M_PI - 0.2}};
+    const BBox expected = {0.4, -0.4, -M_PI + 0.2, M_PI - 0.2};
+    const GeoCoord inside = {0.3, -M_PI + 0.15};
+    const GeoCoord outside = {0.3, M_PI - 0.3};
+    assertBBox(verts, &expected, &inside, &outside);
+
+    BBox result;
+    bboxFromVertices(verts, 4, &result);
+    const GeoCoord westInside = {-0.3, M_PI - 0.15};
+    t_assert(bboxContains(&result, &westInside),
+             "Contains point between the west vertices");
+}
+
 TEST(edgeOnNorthPole) {
     const GeoCoord verts[] = {
         {M_PI_2 - 0.1, 0.1}, {M_PI_2 - 0.1, 0.8}, {M_PI_2, 0.8}, {M_PI_2, 0.1}};
@@ -158,6 +177,38 @@ TEST(containsEdgesTransmeridian) {
     }
 }
 
+TEST(bboxIntersects) {
+    const BBox a = {1.0, 0.0, 1.0, 0.0};
+    const BBox overlapping = {1.5, 0.5, 1.5, 0.5};
+    const BBox touching = {2.0, 1.0, 2.0, 1.0};
+    const BBox north = {2.0, 1.1, 1.0, 0.0};
+    const BBox east = {1.0, 0.0, 2.0, 1.1};
+
+    t_assert(bboxIntersects(&a, &a), "box intersects itself");
+    t_assert(bboxIntersects(&a, &overlapping), "overlapping boxes intersect");
+    t_assert(bboxIntersects(&overlapping, &a), "intersection is symmetric");
+    t_assert(bboxIntersects(&a, &touching), "touching boxes intersect");
+    t_assert(!bboxIntersects(&a, &north), "box to the north is disjoint");
+    t_assert(!bboxIntersects(&a, &east), "box to the east is disjoint");
+}
+
+TEST(bboxIntersectsTransmeridian) {
+    const BBox transmeridian = {0.1, -0.1, -M_PI + 0.2, M_PI - 0.2};
+    const BBox west = {0.1, -0.1, M_PI - 0.1, M_PI - 0.3};
+    const BBox east = {0.1, -0.1, -M_PI + 0.3, -M_PI + 0.1};
+    const BBox middle = {0.1, -0.1, 0.1, -0.1};
+    const BBox otherTransmeridian = {0.1, -0.1, -M_PI + 0.1, M_PI - 0.1};
+
+    t_assert(bboxIntersects(&transmeridian, &west), "intersects west side");
+    t_assert(bboxIntersects(&east, &transmeridian), "intersects east side");
+    t_assert(!bboxIntersects(&transmeridian, &middle),
+             "disjoint from prime meridian box");
+    t_assert(!bboxIntersects(&middle, &transmeridian),
+             "disjoint from prime meridian box, reversed");
+    t_assert(bboxIntersects(&transmeridian, &otherTransmeridian),
+             "transmeridian boxes intersect");
+}
+
 TEST(noVertices) {
     const BBox expected = {0.0, 0.0, 0.0, 0.0};
 
@@ -291,4 +342,29 @@ TEST(bboxIsTransmeridian) {
              "Transmeridian bbox is transmeridian");
 }
 
+TEST(bboxHexRadius) {
+    // Boxes centered near a pentagon, on the equator and at high latitude
+    BBox bboxes[] = {{1.13, 1.12, 0.19, 0.18},
+                     {0.001, -0.001, 0.001, -0.001},
+                     {1.4, 1.3, 2.1, 2.0}};
+    for (int i = 0; i < 3; i++) {
+        GeoCoord center;
+        bboxCenter(&bboxes[i], &center);
+        double lat = fabs(bboxes[i].north) > fabs(bboxes[i].south)
+                         ? bboxes[i].south
+                         : bboxes[i].north;
+        GeoCoord vertex = {lat, bboxes[i].east};
+        double bboxRadiusKm = _geoDistKm(&center, &vertex);
+        for (int res = 0; res <= MAX_H3_RES; res++) {
+            // The radius must be at least that given by the hexagon at the
+            // center of the box
+            double centerHexRadiusKm =
+                _hexRadiusKm(H3_EXPORT(geoToH3)(&center, res));
+            int centerK = (int)ceil(bboxRadiusKm / (1.5 * centerHexRadiusKm));
+            t_assert(bboxHexRadius(&bboxes[i], res) >= centerK,
+                     "radius covers the estimate from the center hexagon");
+        }
+    }
+}
+
 END_TESTS();
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the packed binary format used by the filter applications
+ *
+ *  usage: `testBinaryIO`
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "binaryIO.h"
+#include "test.h"
+
+#define NUM_RECORDS (BINARY_BLOCK_SIZE + 10)
+
+H3Index indexes[NUM_RECORDS];
+H3Index readIndexes[BINARY_BLOCK_SIZE];
+double lat[NUM_RECORDS];
+double lon[NUM_RECORDS];
+double readLat[BINARY_BLOCK_SIZE];
+double readLon[BINARY_BLOCK_SIZE];
+
+BEGIN_TESTS(binaryIO);
+
+TEST(littleEndianIndexes) {
+    FILE* f = tmpfile();
+    H3Index h = 0x8928308280fffff;
+    binaryWriteIndexes(f, &h, 1);
+    rewind(f);
+    unsigned char bytes[8];
+    t_assert(fread(bytes, 1, 8, f) == 8, "wrote 8 bytes");
+    unsigned char expected[8] = {0xff, 0xff, 0x0f, 0x28,
+                                 0x08, 0x83, 0x92, 0x08};
+    t_assert(memcmp(bytes, expected, 8) == 0, "wrote little endian");
+    fclose(f);
+}
+
+TEST(indexesRoundTrip) {
+    FILE* f = tmpfile();
+    for (int i = 0; i < NUM_RECORDS; i++) {
+        indexes[i] = 0x8928308280fffff + ((H3Index)i << 40);
+    }
+    binaryWriteIndexes(f, indexes, NUM_RECORDS);
+    rewind(f);
+    int n = binaryReadIndexes(f, readIndexes, NUM_RECORDS);
+    t_assert(n == BINARY_BLOCK_SIZE, "read a full block");
+    t_assert(memcmp(readIndexes, indexes, n * sizeof(H3Index)) == 0,
+             "read the first block");
+    n = binaryReadIndexes(f, readIndexes, NUM_RECORDS);
+    t_assert(n == 10, "read the rest");
+    t_assert(memcmp(readIndexes, &indexes[BINARY_BLOCK_SIZE],
+                    n * sizeof(H3Index)) == 0,
+             "read the last block");
+    t_assert(binaryReadIndexes(f, readIndexes, NUM_RECORDS) == 0,
+             "read nothing at the end");
+    fclose(f);
+}
+
+TEST(coordsRoundTrip) {
+    FILE* f = tmpfile();
+    for (int i = 0; i < NUM_RECORDS; i++) {
+        lat[i] = i * 0.01 - 45.5;
+        lon[i] = -i * 0.03 + 120.25;
+    }
+    binaryWriteCoords(f, lat, lon, NUM_RECORDS);
+    rewind(f);
+    int n = binaryReadCoords(f, readLat, readLon, 20);
+    t_assert(n == 20, "read the requested pairs");
+    t_assert(memcmp(readLat, lat, n * sizeof(double)) == 0, "read lats");
+    t_assert(memcmp(readLon, lon, n * sizeof(double)) == 0, "read lons");
+    fclose(f);
+}
+
+TEST(cellsRoundTrip) {
+    FILE* f = tmpfile();
+    for (int i = 0; i < NUM_RECORDS; i++) {
+        indexes[i] = 0x8928308280fffff + ((H3Index)i << 40);
+        lat[i] = i * 0.01 - 45.5;
+        lon[i] = -i * 0.03 + 120.25;
+    }
+    binaryWriteCells(f, indexes, lat, lon, NUM_RECORDS);
+    t_assert(ftell(f) == NUM_RECORDS * 24, "wrote 24 bytes per cell");
+    rewind(f);
+    int n = binaryReadCells(f, readIndexes, readLat, readLon, NUM_RECORDS);
+    t_assert(n == BINARY_BLOCK_SIZE, "read a full block");
+    t_assert(memcmp(readIndexes, indexes, n * sizeof(H3Index)) == 0,
+             "read indexes");
+    t_assert(memcmp(readLat, lat, n * sizeof(double)) == 0, "read lats");
+    t_assert(memcmp(readLon, lon, n * sizeof(double)) == 0, "read lons");
+    n = binaryReadCells(f, readIndexes, readLat, readLon, NUM_RECORDS);
+    t_assert(n == 10, "read the rest");
+    t_assert(readIndexes[9] == indexes[NUM_RECORDS - 1], "read the last cell");
+    fclose(f);
+}
+
+END_TESTS();
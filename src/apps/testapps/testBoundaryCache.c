@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the LRU cache of cell boundaries
+ *
+ *  usage: `testBoundaryCache`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "boundaryCache.h"
+#include "h3api.h"
+#include "test.h"
+#include "threadPool.h"
+
+#define NUM_THREADS 4
+#define NUM_CELLS 331
+#define NUM_LOOKUPS 20000
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+H3Index pentagon = 0x89080000003ffffl;
+H3Index disk[NUM_CELLS];
+
+static int boundariesEqual(const GeoBoundary* a, const GeoBoundary* b) {
+    return a->numVerts == b->numVerts &&
+           memcmp(a->verts, b->verts, a->numVerts * sizeof(GeoCoord)) == 0;
+}
+
+/** @brief Lookups run on a pool, and whether they all matched */
+typedef struct {
+    BoundaryCache* cache;
+    int mismatches[NUM_LOOKUPS];
+} LookupJob;
+
+static void lookupTask(void* data, int begin, int end) {
+    LookupJob* job = data;
+    for (int i = begin; i < end; i++) {
+        // A few hot cells, and colder ones that fit in the cache
+        H3Index h = disk[(i % 3 == 0) ? i % 7 : (i * 7919) % (NUM_CELLS / 4)];
+        GeoBoundary cached;
+        GeoBoundary expected;
+        boundaryCacheGet(job->cache, h, &cached);
+        H3_EXPORT(h3ToGeoBoundary)(h, &expected);
+        job->mismatches[i] = !boundariesEqual(&cached, &expected);
+    }
+}
+
+LookupJob job;
+
+BEGIN_TESTS(boundaryCache);
+
+H3_EXPORT(kRing)(sunnyvale, 10, disk);
+
+TEST(matchesH3ToGeoBoundary) {
+    BoundaryCache* cache = createBoundaryCache(1000, 0);
+    t_assert(cache != NULL, "created cache");
+    t_assert(H3_EXPORT(h3IsPentagon)(pentagon), "checks a pentagon");
+    H3Index cells[] = {sunnyvale, pentagon, disk[NUM_CELLS - 1]};
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 3; i++) {
+            GeoBoundary cached;
+            GeoBoundary expected;
+            boundaryCacheGet(cache, cells[i], &cached);
+            H3_EXPORT(h3ToGeoBoundary)(cells[i], &expected);
+            t_assert(boundariesEqual(&cached, &expected), "boundary matches");
+        }
+    }
+    BoundaryCacheStats stats;
+    boundaryCacheStats(cache, &stats);
+    t_assert(stats.misses == 3, "decoded each cell once");
+    t_assert(stats.hits == 3, "found each cell again");
+    t_assert(stats.evictions == 0, "evicted nothing");
+    t_assert(stats.size == 3, "holds the cells");
+    destroyBoundaryCache(cache);
+}
+
+TEST(evictsLeastRecentlyUsed) {
+    BoundaryCache* cache = createBoundaryCache(4, 1);
+    GeoBoundary gb;
+    for (int i = 0; i < 4; i++) {
+        boundaryCacheGet(cache, disk[i], &gb);
+    }
+    // Touch the first cell, so the second is the least recently used
+    boundaryCacheGet(cache, disk[0], &gb);
+    boundaryCacheGet(cache, disk[4], &gb);
+
+    BoundaryCacheStats stats;
+    boundaryCacheStats(cache, &stats);
+    t_assert(stats.size == 4, "capacity is bounded");
+    t_assert(stats.evictions == 1, "evicted one cell");
+
+    boundaryCacheGet(cache, disk[0], &gb);
+    boundaryCacheGet(cache, disk[2], &gb);
+    boundaryCacheGet(cache, disk[3], &gb);
+    boundaryCacheGet(cache, disk[4], &gb);
+    boundaryCacheStats(cache, &stats);
+    t_assert(stats.hits == 5, "kept the recently used cells");
+    boundaryCacheGet(cache, disk[1], &gb);
+    boundaryCacheStats(cache, &stats);
+    t_assert(stats.misses == 6, "evicted the least recently used cell");
+
+    size_t size = boundaryCacheMemorySize(cache);
+    t_assert(size >= 4 * sizeof(GeoBoundary), "holds the boundaries");
+    t_assert(size < 4096, "memory is bounded");
+    destroyBoundaryCache(cache);
+}
+
+TEST(concurrentLookups) {
+    ThreadPool* pool = createThreadPool(NUM_THREADS);
+    t_assert(pool != NULL, "created pool");
+    job.cache = createBoundaryCache(NUM_CELLS / 2, 4);
+    threadPoolFor(pool, NUM_LOOKUPS, lookupTask, &job);
+    int numMismatches = 0;
+    for (int i = 0; i < NUM_LOOKUPS; i++) {
+        numMismatches += job.mismatches[i];
+    }
+    t_assert(numMismatches == 0, "every lookup matched");
+
+    BoundaryCacheStats stats;
+    boundaryCacheStats(job.cache, &stats);
+    t_assert(stats.hits + stats.misses == NUM_LOOKUPS, "counted lookups");
+    t_assert(stats.hits > stats.misses, "hot cells hit");
+    t_assert(stats.size <= NUM_CELLS / 2 + 4, "capacity is bounded");
+    destroyBoundaryCache(job.cache);
+    destroyThreadPool(pool);
+}
+
+END_TESTS();
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testCellArea.c
+ * @brief Tests the exact area of cells and length of edges
+ *
+ * usage: `testCellArea`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "h3Index.h"
+#include "test.h"
+
+BEGIN_TESTS(cellArea);
+
+GeoCoord sfGeo = {0.659966917655, -2.1364398519396};
+
+TEST(areasCoverTheSphere) {
+    double sphereKm2 = 4 * M_PI * EARTH_RADIUS_KM * EARTH_RADIUS_KM;
+    for (int res = 0; res < 3; res++) {
+        H3Index bc;
+        int sz = (int)H3_EXPORT(numHexagons)(res);
+        H3Index* cells = calloc(sz, sizeof(H3Index));
+        double* areas = calloc(sz, sizeof(double));
+        int n = 0;
+        for (int i = 0; i < NUM_BASE_CELLS; i++) {
+            setH3Index(&bc, 0, i, 0);
+            int childrenSz = H3_EXPORT(maxH3ToChildrenSize)(bc, res);
+            H3Index* children = calloc(childrenSz, sizeof(H3Index));
+            H3_EXPORT(h3ToChildren)(bc, res, children);
+            for (int j = 0; j < childrenSz; j++) {
+                if (children[j] != 0) {
+                    cells[n++] = children[j];
+                }
+            }
+            free(children);
+        }
+        t_assert(n == sz, "found every cell");
+
+        H3_EXPORT(cellAreaKm2Batch)(cells, n, areas);
+        double total = 0;
+        for (int i = 0; i < n; i++) {
+            t_assert(areas[i] == H3_EXPORT(cellAreaKm2)(cells[i]),
+                     "batch matches single cell area");
+            total += areas[i];
+        }
+        t_assert(fabs(total - sphereKm2) < 1e-6 * sphereKm2,
+                 "areas sum to the area of the sphere");
+
+        free(areas);
+        free(cells);
+    }
+}
+
+TEST(areaFineRes) {
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        H3Index h = H3_EXPORT(geoToH3)(&sfGeo, res);
+        double area = H3_EXPORT(cellAreaKm2)(h);
+        t_assert(area > 0.5 * H3_EXPORT(hexAreaKm2)(res) &&
+                     area < 2 * H3_EXPORT(hexAreaKm2)(res),
+                 "area is near the average");
+        double areaM2 = H3_EXPORT(cellAreaM2)(h);
+        t_assert(fabs(areaM2 - area * 1e6) < 1e-9 * areaM2,
+                 "area in m2 matches km2");
+    }
+}
+
+TEST(pentagonArea) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 5, 4, 0);
+    H3Index neighbor;
+    setH3Index(&neighbor, 5, 4, 0);
+    H3_SET_INDEX_DIGIT(neighbor, 5, J_AXES_DIGIT);
+    t_assert(H3_EXPORT(cellAreaKm2)(pentagon) <
+                 H3_EXPORT(cellAreaKm2)(neighbor),
+             "pentagon is smaller than its neighbor");
+}
+
+TEST(exactEdgeLength) {
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        H3Index h = H3_EXPORT(geoToH3)(&sfGeo, res);
+        H3Index edges[6];
+        double lengths[6];
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(h, edges);
+        H3_EXPORT(exactEdgeLengthKmBatch)(edges, 6, lengths);
+
+        double perimeter = 0;
+        for (int i = 0; i < 6; i++) {
+            t_assert(lengths[i] == H3_EXPORT(exactEdgeLengthKm)(edges[i]),
+                     "batch matches single edge length");
+            t_assert(lengths[i] > 0.5 * H3_EXPORT(edgeLengthKm)(res) &&
+                         lengths[i] < 2 * H3_EXPORT(edgeLengthKm)(res),
+                     "length is near the average");
+            t_assert(fabs(H3_EXPORT(exactEdgeLengthM)(edges[i]) -
+                          lengths[i] * 1000) < 1e-9 * lengths[i] * 1000,
+                     "length in m matches km");
+            perimeter += lengths[i];
+        }
+
+        // The area of a regular hexagon is 3 sqrt(3) / 2 s^2, which the cell
+        // should approximate closely away from distortion.
+        double side = perimeter / 6;
+        double regularArea = 3 * sqrt(3) / 2 * side * side;
+        double area = H3_EXPORT(cellAreaKm2)(h);
+        t_assert(fabs(area - regularArea) < 0.05 * regularArea,
+                 "area matches the edge lengths");
+    }
+}
+
+END_TESTS();
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testChildIterator.c
+ * @brief Tests the children iterator against h3ToChildren.
+ *
+ *  usage: `testChildIterator`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "coordijk.h"
+#include "h3Index.h"
+#include "test.h"
+
+/** largest number of resolutions enumerated below a parent */
+#define MAX_OFFSET 4
+/** 7^MAX_OFFSET, the most children */
+#define MAX_CHILDREN 2401
+
+H3Index expected[MAX_CHILDREN];
+
+/**
+ * Fills the fixture with the children of h from h3ToChildren, dropping the
+ * deleted children of pentagons, and returns how many there are.
+ */
+static int expectedChildren(H3Index h, int childRes) {
+    int maxChildren = H3_EXPORT(maxH3ToChildrenSize)(h, childRes);
+    H3Index* children = calloc(maxChildren, sizeof(H3Index));
+    H3_EXPORT(h3ToChildren)(h, childRes, children);
+    int numChildren = 0;
+    for (int i = 0; i < maxChildren; i++) {
+        if (children[i]) expected[numChildren++] = children[i];
+    }
+    free(children);
+    return numChildren;
+}
+
+/**
+ * Checks that the iterator returns the expected children from the given
+ * one onward, and then stays exhausted.
+ */
+static void assertRemaining(ChildIterator* iter, int first, int numChildren) {
+    for (int i = first; i < numChildren; i++) {
+        t_assert(H3_EXPORT(childIterNext)(iter) == expected[i],
+                 "child matches h3ToChildren");
+    }
+    t_assert(H3_EXPORT(childIterNext)(iter) == H3_INVALID_INDEX,
+             "exhausted after the last child");
+    t_assert(H3_EXPORT(childIterNext)(iter) == H3_INVALID_INDEX,
+             "stays exhausted");
+}
+
+/**
+ * Returns the first child of h at childRes, its center child.
+ */
+static H3Index centerChild(H3Index h, int childRes) {
+    ChildIterator iter;
+    H3_EXPORT(childIterInit)(&iter, h, childRes);
+    return H3_EXPORT(childIterNext)(&iter);
+}
+
+BEGIN_TESTS(childIterator);
+
+H3Index hexagon = 0x85283473fffffff;
+H3Index pentagon;
+setH3Index(&pentagon, 2, 4, CENTER_DIGIT);
+H3Index parents[] = {hexagon, pentagon};
+
+TEST(matchesH3ToChildren) {
+    for (int p = 0; p < 2; p++) {
+        H3Index parent = parents[p];
+        int parentRes = H3_GET_RESOLUTION(parent);
+        for (int childRes = parentRes; childRes <= parentRes + MAX_OFFSET;
+             childRes++) {
+            int numChildren = expectedChildren(parent, childRes);
+            ChildIterator iter;
+            H3_EXPORT(childIterInit)(&iter, parent, childRes);
+            assertRemaining(&iter, 0, numChildren);
+        }
+    }
+}
+
+TEST(pentagonChildCount) {
+    ChildIterator iter;
+    H3_EXPORT(childIterInit)(&iter, pentagon, 5);
+    int count = 0;
+    while (H3_EXPORT(childIterNext)(&iter)) count++;
+    // one center pentagon and 5 * (7^3 - 1) / 6 hexagons
+    t_assert(count == 1 + 5 * 57, "pentagon has expected children");
+}
+
+TEST(skipTo) {
+    for (int p = 0; p < 2; p++) {
+        H3Index parent = parents[p];
+        int childRes = H3_GET_RESOLUTION(parent) + 2;
+        int numChildren = expectedChildren(parent, childRes);
+        ChildIterator iter;
+        H3_EXPORT(childIterInit)(&iter, parent, childRes);
+        for (int i = numChildren - 1; i >= 0; i--) {
+            H3_EXPORT(childIterSkipTo)(&iter, expected[i]);
+            assertRemaining(&iter, i, numChildren);
+        }
+    }
+}
+
+TEST(skipToDeletedChild) {
+    int childRes = 5;
+    int numChildren = expectedChildren(pentagon, childRes);
+    ChildIterator iter;
+    H3_EXPORT(childIterInit)(&iter, pentagon, childRes);
+
+    // 0 1 3 is deleted, as is everything up to 0 2 0
+    H3Index deleted = pentagon;
+    H3_SET_RESOLUTION(deleted, childRes);
+    H3_SET_INDEX_DIGIT(deleted, 3, CENTER_DIGIT);
+    H3_SET_INDEX_DIGIT(deleted, 4, K_AXES_DIGIT);
+    H3_SET_INDEX_DIGIT(deleted, 5, JK_AXES_DIGIT);
+    H3Index after = deleted;
+    H3_SET_INDEX_DIGIT(after, 4, J_AXES_DIGIT);
+    H3_SET_INDEX_DIGIT(after, 5, CENTER_DIGIT);
+
+    int first = 0;
+    while (expected[first] != after) first++;
+    H3_EXPORT(childIterSkipTo)(&iter, deleted);
+    assertRemaining(&iter, first, numChildren);
+}
+
+TEST(invalidInputs) {
+    ChildIterator iter;
+    H3_EXPORT(childIterInit)(&iter, hexagon, 4);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == H3_INVALID_INDEX,
+             "coarser resolution is empty");
+    H3_EXPORT(childIterInit)(&iter, hexagon, 16);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == H3_INVALID_INDEX,
+             "invalid resolution is empty");
+
+    H3_EXPORT(childIterInit)(&iter, hexagon, 7);
+    H3Index other = 0x85283477fffffff;
+    H3Index otherChild = centerChild(other, 7);
+    H3_EXPORT(childIterSkipTo)(&iter, otherChild);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == H3_INVALID_INDEX,
+             "skipping to another parent's child ends the enumeration");
+
+    H3Index center = centerChild(hexagon, 7);
+    H3Index wrongRes = centerChild(hexagon, 8);
+    H3_EXPORT(childIterSkipTo)(&iter, wrongRes);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == H3_INVALID_INDEX,
+             "skipping to another resolution ends the enumeration");
+
+    H3Index digit7 = center;
+    H3_SET_INDEX_DIGIT(digit7, 7, H3_DIGIT_MASK);
+    H3_EXPORT(childIterSkipTo)(&iter, digit7);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == H3_INVALID_INDEX,
+             "skipping to an invalid digit ends the enumeration");
+
+    H3_EXPORT(childIterSkipTo)(&iter, center);
+    t_assert(H3_EXPORT(childIterNext)(&iter) == center,
+             "skipping restarts an ended enumeration");
+}
+
+END_TESTS();
@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "constants.h"
 #include "h3Index.h"
 #include "test.h"
@@ -24,6 +25,12 @@ H3Index sunnyvale = 0x89283470c27ffffl;
 H3Index uncompactable[] = {0x89283470803ffffl, 0x8928347081bffffl,
                            0x8928347080bffffl};
 
+static int compareH3Index(const void* a, const void* b) {
+    H3Index ha = *(const H3Index*)a;
+    H3Index hb = *(const H3Index*)b;
+    return (ha > hb) - (ha < hb);
+}
+
 BEGIN_TESTS(compact);
 
 TEST(roundtrip) {
@@ -66,6 +73,101 @@ TEST(roundtrip) {
     free(sunnyvaleExpanded);
 }
 
+TEST(compactWithScratch) {
+    H3Scratch scratch = {0};
+    for (int k = 0; k < 12; k += 3) {
+        int hexCount = H3_EXPORT(maxKringSize)(k);
+        H3Index* expanded = calloc(hexCount, sizeof(H3Index));
+        H3_EXPORT(kRing)(sunnyvale, k, expanded);
+
+        H3Index* expected = calloc(hexCount, sizeof(H3Index));
+        H3Index* compressed = calloc(hexCount, sizeof(H3Index));
+        t_assert(H3_EXPORT(compact)(expanded, expected, hexCount) == 0,
+                 "no error on compact");
+        t_assert(H3_EXPORT(compactWithScratch)(expanded, compressed, hexCount,
+                                               &scratch) == 0,
+                 "no error on compactWithScratch");
+        for (int i = 0; i < hexCount; i++) {
+            t_assert(compressed[i] == expected[i],
+                     "compactWithScratch matches compact");
+        }
+
+        free(compressed);
+        free(expected);
+        free(expanded);
+    }
+    t_assert(scratch.capacity > 0, "scratch was grown");
+
+    H3Index dupeInput[10] = {0};
+    for (int i = 0; i < 10; i++) {
+        setH3Index(&dupeInput[i], 5, 0, 2);
+    }
+    H3Index output[10];
+    t_assert(H3_EXPORT(compactWithScratch)(dupeInput, output, 10, &scratch) !=
+                 0,
+             "duplicate input is rejected with a reused scratch");
+
+    H3_EXPORT(destroyH3Scratch)(&scratch);
+    t_assert(scratch.buffer == NULL && scratch.capacity == 0,
+             "scratch was freed");
+}
+
+TEST(compactWithSort) {
+    for (int k = 0; k < 12; k += 3) {
+        int hexCount = H3_EXPORT(maxKringSize)(k);
+        H3Index* expanded = calloc(hexCount, sizeof(H3Index));
+        H3_EXPORT(kRing)(sunnyvale, k, expanded);
+
+        H3Index* expected = calloc(hexCount, sizeof(H3Index));
+        H3Index* compressed = calloc(hexCount, sizeof(H3Index));
+        t_assert(H3_EXPORT(compact)(expanded, expected, hexCount) == 0,
+                 "no error on compact");
+        t_assert(H3_EXPORT(compactWithSort)(expanded, compressed, hexCount) ==
+                     0,
+                 "no error on compactWithSort");
+        qsort(expected, hexCount, sizeof(H3Index), compareH3Index);
+        qsort(compressed, hexCount, sizeof(H3Index), compareH3Index);
+        for (int i = 0; i < hexCount; i++) {
+            t_assert(compressed[i] == expected[i],
+                     "compactWithSort matches compact");
+        }
+
+        // Sorted input takes the fast path
+        qsort(expanded, hexCount, sizeof(H3Index), compareH3Index);
+        memset(compressed, 0, hexCount * sizeof(H3Index));
+        t_assert(H3_EXPORT(compactWithSort)(expanded, compressed, hexCount) ==
+                     0,
+                 "no error on compactWithSort of sorted input");
+        qsort(compressed, hexCount, sizeof(H3Index), compareH3Index);
+        for (int i = 0; i < hexCount; i++) {
+            t_assert(compressed[i] == expected[i],
+                     "compactWithSort of sorted input matches compact");
+        }
+
+        free(compressed);
+        free(expected);
+        free(expanded);
+    }
+
+    H3Index pentagon;
+    setH3Index(&pentagon, 1, 4, 0);
+    H3Index children[49] = {0};
+    H3_EXPORT(h3ToChildren)(pentagon, 3, children);
+    H3Index result[49] = {0};
+    t_assert(H3_EXPORT(compactWithSort)(children, result, 49) == 0,
+             "compactWithSort pentagon succeeds");
+    t_assert(result[0] == pentagon && result[1] == 0,
+             "compacted to a single pentagon");
+
+    H3Index dupeInput[10] = {0};
+    for (int i = 0; i < 10; i++) {
+        setH3Index(&dupeInput[i], 5, 0, 2);
+    }
+    H3Index output[10];
+    t_assert(H3_EXPORT(compactWithSort)(dupeInput, output, 10) != 0,
+             "compactWithSort fails on duplicate input");
+}
+
 TEST(res0) {
     int hexCount = NUM_BASE_CELLS;
 
@@ -164,6 +266,21 @@ TEST(uncompact_wrongRes) {
     t_assert(sizeResult < 0,
              "maxUncompactSize fails when given illegal resolutions");
 
+    // 3 * 7^10 children fit in an int, 3 * 7^11 do not
+    t_assert(H3_EXPORT(maxUncompactSize)(someHexagons, numHex, 15) ==
+                 3 * 282475249,
+             "maxUncompactSize of many children");
+    someHexagons[0] = H3_EXPORT(h3ToParent)(someHexagons[0], 4);
+    sizeResult = H3_EXPORT(maxUncompactSize)(someHexagons, numHex, 15);
+    t_assert(sizeResult < 0,
+             "maxUncompactSize fails when the size does not fit in an int");
+    someHexagons[0] = H3_EXPORT(h3ToParent)(someHexagons[0], 0);
+    H3Index tooSmall[] = {0, 0, 0};
+    t_assert(H3_EXPORT(uncompact)(someHexagons, numHex, tooSmall, numHex,
+                                  15) != 0,
+             "uncompact fails when the size does not fit in an int");
+    setH3Index(&someHexagons[0], 5, 0, 0);
+
     H3Index uncompressed[] = {0, 0, 0};
     int uncompactResult =
         H3_EXPORT(uncompact)(someHexagons, numHex, uncompressed, numHex, 0);
@@ -179,6 +296,51 @@ TEST(uncompact_wrongRes) {
              "uncompact fails when given too little buffer (same resolution)");
 }
 
+TEST(uncompactParallel) {
+    int hexCount = H3_EXPORT(maxKringSize)(9);
+    H3Index* sunnyvaleExpanded = calloc(hexCount, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 9, sunnyvaleExpanded);
+    H3Index* compressed = calloc(hexCount, sizeof(H3Index));
+    H3_EXPORT(compact)(sunnyvaleExpanded, compressed, hexCount);
+
+    H3Index pentagon;
+    setH3Index(&pentagon, 1, 4, 0);
+    compressed[hexCount - 1] = pentagon;
+
+    int size = H3_EXPORT(maxUncompactSize)(compressed, hexCount, 9);
+    H3Index* expected = calloc(size, sizeof(H3Index));
+    H3Index* serial = calloc(size, sizeof(H3Index));
+    H3Index* parallel = calloc(size, sizeof(H3Index));
+    t_assert(H3_EXPORT(uncompact)(compressed, hexCount, expected, size, 9) == 0,
+             "uncompact succeeds");
+    t_assert(H3_EXPORT(uncompactParallel)(compressed, hexCount, serial, size,
+                                          9, NULL, NULL) == 0,
+             "uncompactParallel without executor succeeds");
+    int numCalls = 0;
+    t_assert(H3_EXPORT(uncompactParallel)(compressed, hexCount, parallel, size,
+                                          9, reverseParallelFor,
+                                          &numCalls) == 0,
+             "uncompactParallel succeeds");
+    t_assert(numCalls > 1, "executor was used");
+    t_assert(memcmp(serial, expected, size * sizeof(H3Index)) == 0,
+             "serial matches uncompact");
+    t_assert(memcmp(parallel, expected, size * sizeof(H3Index)) == 0,
+             "parallel matches uncompact");
+
+    t_assert(H3_EXPORT(uncompactParallel)(compressed, hexCount, parallel,
+                                          size - 1, 9, NULL, NULL) == -1,
+             "uncompactParallel fails when given too little buffer");
+    t_assert(H3_EXPORT(uncompactParallel)(&pentagon, 1, parallel, size, 0,
+                                          NULL, NULL) == -2,
+             "uncompactParallel fails when given illogical resolutions");
+
+    free(parallel);
+    free(serial);
+    free(expected);
+    free(compressed);
+    free(sunnyvaleExpanded);
+}
+
 TEST(someHexagon) {
     H3Index origin;
     setH3Index(&origin, 1, 5, 0);
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the polynomial approximations of the trigonometric functions
+ * and the vector gnomonic projection used with H3_FAST_MATH
+ *
+ *  usage: `testFastMath`
+ *
+ *  The approximations are compiled into every build, so they are tested
+ *  against libm whether or not the library uses them.
+ */
+
+#include <math.h>
+#include "fastMath.h"
+#include "faceijk.h"
+#include "geoCoord.h"
+#include "test.h"
+#include "vec3d.h"
+
+/** Allowed error, relative to the larger of 1 and the exact value */
+#define FAST_MATH_TOLERANCE 2e-15
+
+static int closeTo(double approx, double exact) {
+    return fabs(approx - exact) <= FAST_MATH_TOLERANCE * fmax(1.0, fabs(exact));
+}
+
+BEGIN_TESTS(fastMath);
+
+TEST(approximationsMatchLibm) {
+    for (double x = -20.0; x <= 20.0; x += 0.001) {
+        t_assert(closeTo(_fastSin(x), sin(x)), "sin matches");
+        t_assert(closeTo(_fastCos(x), cos(x)), "cos matches");
+        t_assert(closeTo(_fastTan(x), tan(x)), "tan matches");
+    }
+    for (double x = -1e3; x <= 1e3; x += 0.01) {
+        t_assert(closeTo(_fastAtan(x), atan(x)), "atan matches");
+    }
+    for (double a = -M_PI; a <= M_PI; a += 0.0001) {
+        double y = sin(a);
+        double x = cos(a);
+        t_assert(closeTo(_fastAtan2(y, x), atan2(y, x)), "atan2 matches");
+        t_assert(closeTo(_fastAtan2(1e-3 * y, 1e-3 * x), atan2(y, x)),
+                 "atan2 of small arguments matches");
+    }
+    for (double x = -1.0; x <= 1.0; x += 0.0001) {
+        t_assert(closeTo(_fastAsin(x), asin(x)), "asin matches");
+        t_assert(closeTo(_fastAcos(x), acos(x)), "acos matches");
+    }
+}
+
+TEST(specialValues) {
+    t_assert(_fastSin(0.0) == 0.0, "sin of 0");
+    t_assert(_fastCos(0.0) == 1.0, "cos of 0");
+    t_assert(_fastAtan(0.0) == 0.0, "atan of 0");
+    t_assert(_fastAsin(1.0) == M_PI_2, "asin of 1");
+    t_assert(_fastAcos(1.0) == 0.0, "acos of 1");
+    t_assert(_fastAcos(-1.0) == M_PI, "acos of -1");
+    t_assert(_fastAtan2(0.0, -1.0) == M_PI, "atan2 on the negative x axis");
+    t_assert(_fastAtan2(-0.0, -1.0) == -M_PI,
+             "atan2 on the negative x axis from below");
+    t_assert(_fastAtan2(0.0, 0.0) == atan2(0.0, 0.0), "atan2 of 0, 0");
+    t_assert(_fastAtan(INFINITY) == M_PI_2, "atan of infinity");
+    t_assert(_fastAtan2(1.0, INFINITY) == 0.0, "atan2 with infinite x");
+
+    t_assert(isnan(_fastSin(NAN)), "sin of NaN");
+    t_assert(isnan(_fastCos(INFINITY)), "cos of infinity");
+    t_assert(isnan(_fastTan(NAN)), "tan of NaN");
+    t_assert(isnan(_fastAtan(NAN)), "atan of NaN");
+    t_assert(isnan(_fastAtan2(NAN, 1.0)), "atan2 of NaN");
+    t_assert(isnan(_fastAsin(2.0)), "asin out of range");
+    t_assert(isnan(_fastAcos(-2.0)), "acos out of range");
+
+    t_assert(_fastSin(1e10) == sin(1e10), "sin of a huge angle uses libm");
+    t_assert(_fastCos(-1e10) == cos(-1e10), "cos of a huge angle uses libm");
+}
+
+TEST(gnomonicMatchesTrig) {
+    for (int f = 0; f < NUM_ICOSA_FACES; f++) {
+        const GeoCoord* center = &faceCenterGeo[f];
+        for (double az = 0.05; az < 2 * M_PI; az += 0.3) {
+            for (double dist = 0.01; dist < 0.7; dist += 0.05) {
+                GeoCoord g;
+                _geoAzDistanceRads(center, az, dist, &g);
+                Vec3d p;
+                _geoToVec3d(&g, &p);
+                for (int classIII = 0; classIII <= 1; classIII++) {
+                    // As _geoToHex2d computes it from the azimuth
+                    double theta = _posAngleRads(faceAxesAzRadsCII[f][0] -
+                                                 _posAngleRads(az));
+                    if (classIII) {
+                        theta = _posAngleRads(theta - M_AP7_ROT_RADS);
+                    }
+                    double r = tan(dist);
+
+                    double x, y;
+                    _vec3dToGnomonic(&p, &faceCenterPoint[f], faceAxesCII[f],
+                                     classIII, &x, &y);
+                    t_assert(fabs(x - r * cos(theta)) < 1e-13,
+                             "gnomonic x matches");
+                    t_assert(fabs(y - r * sin(theta)) < 1e-13,
+                             "gnomonic y matches");
+
+                    GeoCoord back;
+                    _gnomonicToGeo(x, y, &faceCenterPoint[f], faceAxesCII[f],
+                                   classIII, &back.lat, &back.lon);
+                    Vec3d q;
+                    _geoToVec3d(&back, &q);
+                    t_assert(_pointSquareDist(&p, &q) < 1e-26,
+                             "gnomonic projection inverts");
+                }
+            }
+        }
+    }
+}
+
+END_TESTS();
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests H3 functions `geoRadiusToCells` and `maxGeoRadiusToCellsSize`
+ *
+ *  usage: `testGeoRadiusToCells`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+
+/**
+ * Checks geoRadiusToCells against filtering a k-ring two rings wider than
+ * the one it searches, for the given circle.
+ */
+static void assertMatchesKRing(const GeoCoord* center, double radiusKm,
+                               int res) {
+    int maxSize = H3_EXPORT(maxGeoRadiusToCellsSize)(radiusKm, res);
+    t_assert(maxSize > 0, "has a size");
+    H3Index* out = calloc(maxSize, sizeof(H3Index));
+    double* distances = calloc(maxSize, sizeof(double));
+    int count =
+        H3_EXPORT(geoRadiusToCells)(center, radiusKm, res, out, distances);
+    t_assert(count > 0 && count <= maxSize, "count within bounds");
+
+    for (int i = 0; i < count; i++) {
+        GeoCoord cellCenter;
+        H3_EXPORT(h3ToGeo)(out[i], &cellCenter);
+        t_assert(_geoDistKm(center, &cellCenter) == distances[i],
+                 "distance reported");
+        t_assert(distances[i] <= radiusKm, "center within radius");
+        t_assert(i == 0 || distances[i - 1] <= distances[i],
+                 "sorted by distance");
+    }
+
+    // Every center within the radius is found
+    int k = 1;
+    while (H3_EXPORT(maxKringSize)(k) < maxSize) k++;
+    k += 2;
+    int ringSize = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(ringSize, sizeof(H3Index));
+    H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(center, res), k, ring);
+    int expected = 0;
+    for (int i = 0; i < ringSize; i++) {
+        if (ring[i] == 0) continue;
+        GeoCoord cellCenter;
+        H3_EXPORT(h3ToGeo)(ring[i], &cellCenter);
+        if (_geoDistKm(center, &cellCenter) <= radiusKm) {
+            expected++;
+            int found = 0;
+            for (int j = 0; j < count; j++) {
+                if (out[j] == ring[i]) found++;
+            }
+            t_assert(found == 1, "found exactly once");
+        }
+    }
+    t_assert(count == expected, "no extra indexes");
+
+    // The output does not depend on distances being requested
+    H3Index* withoutDistances = calloc(maxSize, sizeof(H3Index));
+    t_assert(H3_EXPORT(geoRadiusToCells)(center, radiusKm, res,
+                                         withoutDistances, NULL) == count,
+             "same count without distances");
+    for (int i = 0; i < count; i++) {
+        t_assert(withoutDistances[i] == out[i], "same order");
+    }
+
+    free(withoutDistances);
+    free(ring);
+    free(distances);
+    free(out);
+}
+
+BEGIN_TESTS(geoRadiusToCells);
+
+TEST(radiusAroundSf) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    assertMatchesKRing(&sf, 2.0, 9);
+    assertMatchesKRing(&sf, 0.5, 10);
+    assertMatchesKRing(&sf, 25.0, 7);
+    assertMatchesKRing(&sf, 1500.0, 2);
+}
+
+TEST(radiusAroundPentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 5, 4, 0);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(pentagon, &center);
+    assertMatchesKRing(&center, 100.0, 5);
+    center.lat += 0.002;
+    assertMatchesKRing(&center, 60.0, 6);
+    assertMatchesKRing(&center, 5000.0, 0);
+}
+
+TEST(zeroRadius) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    H3Index h = H3_EXPORT(geoToH3)(&sf, 9);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(h, &center);
+
+    H3Index out[7];
+    double distance;
+    t_assert(H3_EXPORT(maxGeoRadiusToCellsSize)(0, 9) == 7,
+             "one ring for zero radius");
+    t_assert(H3_EXPORT(geoRadiusToCells)(&center, 0, 9, out, &distance) == 1,
+             "only the hexagon at the center");
+    t_assert(out[0] == h, "hexagon at the center");
+    t_assert(distance == 0, "no distance");
+}
+
+TEST(invalidArguments) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    GeoCoord invalid = {NAN, 0};
+    H3Index out[7];
+    t_assert(H3_EXPORT(maxGeoRadiusToCellsSize)(1, -1) == 0, "negative res");
+    t_assert(H3_EXPORT(maxGeoRadiusToCellsSize)(1, 16) == 0, "res too high");
+    t_assert(H3_EXPORT(maxGeoRadiusToCellsSize)(-1, 9) == 0,
+             "negative radius");
+    t_assert(H3_EXPORT(maxGeoRadiusToCellsSize)(NAN, 9) == 0, "NaN radius");
+    t_assert(H3_EXPORT(geoRadiusToCells)(&sf, -1, 9, out, NULL) == 0,
+             "nothing for negative radius");
+    t_assert(H3_EXPORT(geoRadiusToCells)(&sf, 1, 16, out, NULL) == 0,
+             "nothing for invalid res");
+    t_assert(H3_EXPORT(geoRadiusToCells)(&invalid, 0.1, 9, out, NULL) == 0,
+             "nothing for invalid center");
+}
+
+END_TESTS();
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests H3 function `geoToH3Batch`
+ *
+ *  usage: `testGeoToH3Batch`
+ *
+ *  The program reads lines containing H3 indexes and lat/lon pairs from
+ *  stdin until EOF is encountered. The lat/lons are converted to H3 indexes
+ *  in batches with `geoToH3Batch`, and each output index is validated
+ *  against both the original input index and the output of `geoToH3`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+#include "utility.h"
+
+/** number of input lines accumulated before each batch call */
+#define BATCH_LINES 200
+
+static H3Index expected[BATCH_LINES];
+static double lats[BATCH_LINES];
+static double lons[BATCH_LINES];
+static H3Index out[BATCH_LINES];
+
+void assertExpected(int n, int res) {
+    H3_EXPORT(geoToH3Batch)(lats, lons, n, res, out);
+    for (int i = 0; i < n; i++) {
+        GeoCoord g = {lats[i], lons[i]};
+        t_assert(out[i] == expected[i], "got expected geoToH3Batch output");
+        t_assert(out[i] == H3_EXPORT(geoToH3)(&g, res),
+                 "geoToH3Batch matches geoToH3");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // check command line args
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        exit(1);
+    }
+
+    // process the indexes and lat/lons on stdin
+    char buff[BUFF_SIZE];
+    char h3Str[BUFF_SIZE];
+    int n = 0;
+    int res = 0;
+    while (1) {
+        // get an index from stdin
+        if (!fgets(buff, BUFF_SIZE, stdin)) {
+            if (feof(stdin))
+                break;
+            else
+                error("reading input from stdin");
+        }
+
+        double latDegs, lonDegs;
+        if (sscanf(buff, "%s %lf %lf", h3Str, &latDegs, &lonDegs) != 3)
+            error("parsing input (should be \"H3Index lat lon\")");
+
+        H3Index h3 = H3_EXPORT(stringToH3)(h3Str);
+        int h3Res = H3_EXPORT(h3GetResolution)(h3);
+
+        // flush the batch when full or when the resolution changes
+        if (n == BATCH_LINES || (n > 0 && h3Res != res)) {
+            assertExpected(n, res);
+            n = 0;
+        }
+
+        GeoCoord coord;
+        setGeoDegs(&coord, latDegs, lonDegs);
+        expected[n] = h3;
+        lats[n] = coord.lat;
+        lons[n] = coord.lon;
+        res = h3Res;
+        n++;
+    }
+
+    if (n > 0) assertExpected(n, res);
+}
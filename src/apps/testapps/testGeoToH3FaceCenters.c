@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testGeoToH3FaceCenters.c
+ * @brief tests encoding points close to the icosahedron face centers
+ *
+ *  usage: `testGeoToH3FaceCenters`
+ *
+ *  The distance from the face center is compared with the haversine
+ *  distance, which is accurate there, unlike the arc cosine of the squared
+ *  chord distance.
+ */
+
+#include <math.h>
+#include "constants.h"
+#include "coordijk.h"
+#include "faceijk.h"
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+
+/** number of points encoded around each face center */
+#define POINTS_PER_FACE 1000
+
+/** smallest distance of the points from the face center in radians */
+#define MIN_DIST_RADS 1e-9
+
+/** largest distance of the points from the face center in radians */
+#define MAX_DIST_RADS 1e-4
+
+/** resolution of the cells */
+#define RES 15
+
+/**
+ * The great circle distance between two points by the haversine formula.
+ */
+static double haversineRads(const GeoCoord* a, const GeoCoord* b) {
+    double sinLat = sin((b->lat - a->lat) / 2);
+    double sinLon = sin((b->lon - a->lon) / 2);
+    return 2 * asin(sqrt(sinLat * sinLat +
+                         cos(a->lat) * cos(b->lat) * sinLon * sinLon));
+}
+
+/**
+ * The cell containing a point, with its hex2d coordinates on the face
+ * scaled to the haversine distance from the face center.
+ */
+static H3Index haversineCell(const GeoCoord* center, const GeoCoord* g,
+                             int face) {
+    int gFace;
+    Vec2d v;
+    _geoToHex2d(g, RES, &gFace, &v);
+    t_assert(gFace == face, "point is on the face");
+
+    double scale = pow(sqrt(7.0), RES) / RES0_U_GNOMONIC;
+    double ratio = tan(haversineRads(center, g)) * scale / hypot(v.x, v.y);
+    Vec2d ref = {v.x * ratio, v.y * ratio};
+    FaceIJK fijk = {face, {0, 0, 0}};
+    _hex2dToCoordIJK(&ref, &fijk.coord);
+    return _faceIjkToH3(&fijk, RES);
+}
+
+BEGIN_TESTS(geoToH3FaceCenters);
+
+TEST(nearFaceCenters) {
+    for (int face = 0; face < NUM_ICOSA_FACES; face++) {
+        FaceIJK centerIjk = {face, {0, 0, 0}};
+        GeoCoord center;
+        _faceIjkToGeo(&centerIjk, 0, &center);
+
+        double lat[POINTS_PER_FACE];
+        double lon[POINTS_PER_FACE];
+        H3Index expected[POINTS_PER_FACE];
+        for (int i = 0; i < POINTS_PER_FACE; i++) {
+            // a spiral out to about MAX_DIST_RADS at golden angle steps,
+            // with distances spread evenly on a log scale, as the error of
+            // the arc cosine is largest near the center
+            double az = i * 2.39996322972865332;
+            double dist = MIN_DIST_RADS * pow(MAX_DIST_RADS / MIN_DIST_RADS,
+                                              (double)i / POINTS_PER_FACE);
+            GeoCoord g = {center.lat + dist * cos(az),
+                          constrainLng(center.lon +
+                                       dist * sin(az) / cos(center.lat))};
+            lat[i] = g.lat;
+            lon[i] = g.lon;
+            expected[i] = haversineCell(&center, &g, face);
+            t_assert(H3_EXPORT(geoToH3)(&g, RES) == expected[i],
+                     "geoToH3 matches the haversine distance");
+        }
+
+        H3Index batch[POINTS_PER_FACE];
+        H3_EXPORT(geoToH3Batch)(lat, lon, POINTS_PER_FACE, RES, batch);
+        for (int i = 0; i < POINTS_PER_FACE; i++) {
+            t_assert(batch[i] == expected[i],
+                     "geoToH3Batch matches the haversine distance");
+        }
+    }
+}
+
+END_TESTS();
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests H3 function `geoToH3Multi`
+ *
+ *  usage: `testGeoToH3Multi`
+ *
+ *  The program reads lines containing H3 indexes and lat/lon pairs from
+ *  stdin until EOF is encountered. Each lat/lon is converted to H3 indexes
+ *  at every resolution with `geoToH3Multi`, and the output is validated
+ *  against both the original input index and the output of `geoToH3` at
+ *  each resolution.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+#include "utility.h"
+
+void assertExpected(H3Index h1, const GeoCoord* g1) {
+    H3Index out[MAX_H3_RES + 1];
+    int res = H3_EXPORT(h3GetResolution)(h1);
+    H3_EXPORT(geoToH3Multi)(g1, MAX_H3_RES, out);
+    t_assert(out[res] == h1, "got expected geoToH3Multi output");
+    for (int r = 0; r <= MAX_H3_RES; r++) {
+        t_assert(out[r] == H3_EXPORT(geoToH3)(g1, r),
+                 "geoToH3Multi matches geoToH3");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // check command line args
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        exit(1);
+    }
+
+    // process the indexes and lat/lons on stdin
+    char buff[BUFF_SIZE];
+    char h3Str[BUFF_SIZE];
+    while (1) {
+        // get an index from stdin
+        if (!fgets(buff, BUFF_SIZE, stdin)) {
+            if (feof(stdin))
+                break;
+            else
+                error("reading input from stdin");
+        }
+
+        double latDegs, lonDegs;
+        if (sscanf(buff, "%s %lf %lf", h3Str, &latDegs, &lonDegs) != 3)
+            error("parsing input (should be \"H3Index lat lon\")");
+
+        H3Index h3 = H3_EXPORT(stringToH3)(h3Str);
+
+        GeoCoord coord;
+        setGeoDegs(&coord, latDegs, lonDegs);
+
+        assertExpected(h3, &coord);
+    }
+
+    // invalid inputs
+    H3Index out[MAX_H3_RES + 1] = {0};
+    GeoCoord origin = {0.0, 0.0};
+    H3_EXPORT(geoToH3Multi)(&origin, -1, out);
+    H3_EXPORT(geoToH3Multi)(&origin, MAX_H3_RES + 1, out);
+    for (int r = 0; r <= MAX_H3_RES; r++) {
+        t_assert(out[r] == 0, "invalid resolution writes nothing");
+    }
+    GeoCoord notFinite = {0.0, 1.0 / 0.0};
+    out[0] = 1;
+    H3_EXPORT(geoToH3Multi)(&notFinite, 0, out);
+    t_assert(out[0] == H3_INVALID_INDEX, "non-finite coordinates fail");
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the buffered KML and GeoJSON writer of the applications
+ *
+ *  usage: `testGeoWriter`
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "geoWriter.h"
+#include "test.h"
+
+/**
+ * Reads back everything written to a file, as a string the caller frees.
+ */
+static char* readAll(FILE* f) {
+    long size = ftell(f);
+    rewind(f);
+    char* str = malloc(size + 1);
+    t_assert(fread(str, 1, size, f) == (size_t)size, "read the output");
+    str[size] = '\0';
+    return str;
+}
+
+static int countOf(const char* str, const char* pattern) {
+    int count = 0;
+    for (const char* p = strstr(str, pattern); p; p = strstr(p + 1, pattern)) {
+        count++;
+    }
+    return count;
+}
+
+BEGIN_TESTS(geoWriter);
+
+TEST(formatFixedMatchesPrintf) {
+    char fixed[GEO_WRITER_FIXED_SIZE];
+    char printed[GEO_WRITER_FIXED_SIZE];
+    double special[] = {0.0, 1.0, -1.0, 0.25, -179.999999, 180.0,
+                        -0.0000004, 9.9999996, 123456.5, 1e13, -2e15};
+    for (size_t i = 0; i < sizeof(special) / sizeof(special[0]); i++) {
+        int len = geoWriterFormatFixed(special[i], fixed);
+        snprintf(printed, sizeof(printed), "%.6f", special[i]);
+        t_assert(strcmp(fixed, printed) == 0, "special value matches printf");
+        t_assert(len == (int)strlen(fixed), "length is returned");
+    }
+
+    unsigned int seed = 1;
+    for (int i = 0; i < 100000; i++) {
+        seed = seed * 1103515245 + 12345;
+        double value = ((seed >> 8) / (double)(1 << 24) - 0.5) * 360.0;
+        geoWriterFormatFixed(value, fixed);
+        snprintf(printed, sizeof(printed), "%.6f", value);
+        t_assert(strcmp(fixed, printed) == 0, "value matches printf");
+    }
+}
+
+TEST(geoJsonBoundaries) {
+    H3Index disk[7];
+    H3_EXPORT(kRing)(0x8928308280fffff, 1, disk);
+
+    FILE* f = tmpfile();
+    GeoWriter* writer = geoWriterCreate(f, GEO_WRITER_GEOJSON, "a \"name\"",
+                                        "ignored");
+    for (int i = 0; i < 7; i++) {
+        GeoBoundary b;
+        H3_EXPORT(h3ToGeoBoundary)(disk[i], &b);
+        geoWriterBoundary(writer, &b, "cell");
+    }
+    geoWriterClose(writer);
+    char* out = readAll(f);
+
+    t_assert(strncmp(out,
+                     "{\"type\":\"FeatureCollection\",\"name\":\"a "
+                     "\\\"name\\\"\",\"features\":[\n",
+                     strlen("{\"type\":\"FeatureCollection\"")) == 0,
+             "starts the collection");
+    t_assert(strstr(out, "\"name\":\"a \\\"name\\\"\"") != NULL,
+             "escapes the name");
+    t_assert(countOf(out, "\"type\":\"Feature\"") == 7, "wrote every cell");
+    t_assert(countOf(out, "\"type\":\"Polygon\"") == 7, "cells are polygons");
+    // each hexagon is closed, with 7 coordinates in one ring
+    t_assert(countOf(out, "[") == 1 + 7 * (2 + 7), "wrote closed rings");
+    t_assert(strcmp(out + strlen(out) - 4, "\n]}\n") == 0,
+             "ends the collection");
+
+    GeoBoundary b;
+    H3_EXPORT(h3ToGeoBoundary)(disk[0], &b);
+    char expected[128];
+    snprintf(expected, sizeof(expected), "[[[%.6f,%.6f]",
+             H3_EXPORT(radsToDegs)(b.verts[0].lon),
+             H3_EXPORT(radsToDegs)(b.verts[0].lat));
+    t_assert(strstr(out, expected) != NULL, "wrote lon,lat in degrees");
+
+    free(out);
+    fclose(f);
+}
+
+TEST(kmlLargerThanBuffer) {
+    int numHexes = H3_EXPORT(maxKringSize)(60);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(0x8928308280fffff, 60, disk);
+
+    FILE* f = tmpfile();
+    GeoWriter* writer = geoWriterCreate(f, GEO_WRITER_KML, "cells <&>", "");
+    for (int i = 0; i < numHexes; i++) {
+        GeoBoundary b;
+        H3_EXPORT(h3ToGeoBoundary)(disk[i], &b);
+        geoWriterBoundary(writer, &b, "cell");
+        GeoCoord center;
+        H3_EXPORT(h3ToGeo)(disk[i], &center);
+        geoWriterPoint(writer, &center, "center");
+    }
+    geoWriterClose(writer);
+    t_assert(ftell(f) > GEO_WRITER_BUFFER_SIZE, "output spans many buffers");
+    char* out = readAll(f);
+
+    t_assert(strstr(out, "<name>cells &lt;&amp;&gt;</name>") != NULL,
+             "escapes the name");
+    t_assert(countOf(out, "<Placemark>") == 2 * numHexes,
+             "wrote every placemark");
+    t_assert(countOf(out, "</Placemark>") == 2 * numHexes,
+             "closed every placemark");
+    t_assert(countOf(out, ",5.0\n") == numHexes * (7 + 1),
+             "wrote every coordinate");
+    t_assert(strcmp(out + strlen(out) - 7, "</kml>\n") == 0, "ends the kml");
+
+    free(out);
+    fclose(f);
+    free(disk);
+}
+
+TEST(linkedGeoWithHole) {
+    H3Index ring[12];
+    t_assert(H3_EXPORT(hexRing)(0x8928308280fffff, 2, ring) == 0, "hexRing");
+    LinkedGeoPolygon polygon;
+    H3_EXPORT(h3SetToLinkedGeo)(ring, 12, &polygon);
+    int numCoords = 0;
+    int numLoops = 0;
+    for (LinkedGeoLoop* loop = polygon.first; loop; loop = loop->next) {
+        numLoops++;
+        for (LinkedGeoCoord* c = loop->first; c; c = c->next) numCoords++;
+    }
+    t_assert(numLoops == 2, "outline has a hole");
+
+    FILE* f = tmpfile();
+    GeoWriter* writer = geoWriterCreate(f, GEO_WRITER_GEOJSON, "ring", "");
+    geoWriterLinkedGeo(writer, &polygon, "outline");
+    geoWriterClose(writer);
+    char* out = readAll(f);
+    t_assert(countOf(out, "\"type\":\"MultiPolygon\"") == 1, "multipolygon");
+    t_assert(countOf(out, "[") == 1 + 2 + numLoops + numCoords + numLoops,
+             "wrote one polygon of closed loops");
+    free(out);
+    fclose(f);
+
+    f = tmpfile();
+    writer = geoWriterCreate(f, GEO_WRITER_KML, "ring", "");
+    geoWriterLinkedGeo(writer, &polygon, "outline");
+    geoWriterClose(writer);
+    out = readAll(f);
+    t_assert(countOf(out, "<outerBoundaryIs>") == 1, "one outer loop");
+    t_assert(countOf(out, "<innerBoundaryIs>") == 1, "one hole");
+    t_assert(countOf(out, ",5.0\n") == numCoords + numLoops,
+             "wrote closed loops");
+    free(out);
+    fclose(f);
+
+    H3_EXPORT(destroyLinkedPolygon)(&polygon);
+}
+
+END_TESTS();
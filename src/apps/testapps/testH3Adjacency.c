@@ -0,0 +1,164 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Adjacency.c
+ * @brief Tests the adjacency of the cells of a set.
+ *
+ *  usage: `testH3Adjacency`
+ */
+
+#include <stdlib.h>
+#include "h3Index.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+/**
+ * Checks an adjacency against testing every pair of cells of the set.
+ */
+static void assertAdjacency(const H3Index* h3Set, int numHexes,
+                            const H3Adjacency* adjacency) {
+    t_assert(adjacency->numCells == numHexes, "every cell has a row");
+    t_assert(adjacency->offsets[0] == 0, "first row starts at 0");
+    t_assert(adjacency->offsets[numHexes] == adjacency->numEdges,
+             "last row ends at the number of edges");
+    int numEdges = 0;
+    for (int i = 0; i < numHexes; i++) {
+        int numNeighbors = 0;
+        for (int j = 0; j < numHexes; j++) {
+            if (h3Set[i] == 0 || h3Set[j] == 0) continue;
+            if (!H3_EXPORT(h3IndexesAreNeighbors)(h3Set[i], h3Set[j])) {
+                continue;
+            }
+            numNeighbors++;
+            int found = 0;
+            for (int e = adjacency->offsets[i]; e < adjacency->offsets[i + 1];
+                 e++) {
+                if (adjacency->neighbors[e] == j) {
+                    found = 1;
+                    t_assert(adjacency->edges[e] ==
+                                 H3_EXPORT(getH3UnidirectionalEdge)(h3Set[i],
+                                                                    h3Set[j]),
+                             "edge matches");
+                }
+            }
+            t_assert(found, "neighbor found");
+        }
+        t_assert(adjacency->offsets[i + 1] - adjacency->offsets[i] ==
+                     numNeighbors,
+                 "only neighbors found");
+        for (int e = adjacency->offsets[i] + 1; e < adjacency->offsets[i + 1];
+             e++) {
+            t_assert(H3_GET_RESERVED_BITS(adjacency->edges[e - 1]) <
+                         H3_GET_RESERVED_BITS(adjacency->edges[e]),
+                     "edges in order of direction");
+        }
+        numEdges += numNeighbors;
+    }
+    t_assert(adjacency->numEdges == numEdges, "as many edges as neighbors");
+}
+
+BEGIN_TESTS(h3Adjacency);
+
+TEST(disk) {
+    int numHexes = H3_EXPORT(maxKringSize)(4);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 4, disk);
+    // Leave holes in the set, and a cell of another resolution
+    disk[7] = 0;
+    disk[20] = 0;
+    disk[40] = H3_EXPORT(h3ToParent)(disk[40], 8);
+
+    H3Adjacency adjacency;
+    t_assert(H3_EXPORT(h3SetToAdjacency)(disk, numHexes, NULL, NULL,
+                                         &adjacency) == 0,
+             "adjacency found");
+    assertAdjacency(disk, numHexes, &adjacency);
+    t_assert(adjacency.offsets[8] == adjacency.offsets[7],
+             "0 has no edges");
+    t_assert(adjacency.offsets[41] == adjacency.offsets[40],
+             "cell of another resolution has no edges");
+
+    int numCalls = 0;
+    H3Adjacency parallel;
+    t_assert(H3_EXPORT(h3SetToAdjacency)(disk, numHexes, reverseParallelFor,
+                                         &numCalls, &parallel) == 0,
+             "adjacency found in parallel");
+    t_assert(numCalls > 2, "ran in many tasks");
+    t_assert(parallel.numEdges == adjacency.numEdges, "same edges");
+    for (int i = 0; i <= numHexes; i++) {
+        t_assert(parallel.offsets[i] == adjacency.offsets[i], "same offsets");
+    }
+    for (int e = 0; e < adjacency.numEdges; e++) {
+        t_assert(parallel.neighbors[e] == adjacency.neighbors[e] &&
+                     parallel.edges[e] == adjacency.edges[e],
+                 "same rows");
+    }
+
+    H3_EXPORT(destroyH3Adjacency)(&parallel);
+    H3_EXPORT(destroyH3Adjacency)(&adjacency);
+    free(disk);
+}
+
+TEST(pentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 9, 4, 0);
+    int numHexes = H3_EXPORT(maxKringSize)(2);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(pentagon, 2, disk);
+
+    H3Adjacency adjacency;
+    t_assert(H3_EXPORT(h3SetToAdjacency)(disk, numHexes, NULL, NULL,
+                                         &adjacency) == 0,
+             "adjacency found");
+    assertAdjacency(disk, numHexes, &adjacency);
+    // The disk of a pentagon is not in ring order
+    for (int i = 0; i < numHexes; i++) {
+        if (disk[i] == pentagon) {
+            t_assert(adjacency.offsets[i + 1] - adjacency.offsets[i] == 5,
+                     "pentagon has 5 neighbors");
+        }
+    }
+
+    H3_EXPORT(destroyH3Adjacency)(&adjacency);
+    free(disk);
+}
+
+TEST(invalidSets) {
+    H3Adjacency adjacency;
+    t_assert(H3_EXPORT(h3SetToAdjacency)(NULL, 0, NULL, NULL, &adjacency) ==
+                 0,
+             "empty set");
+    t_assert(adjacency.numCells == 0 && adjacency.numEdges == 0,
+             "empty adjacency");
+    H3_EXPORT(destroyH3Adjacency)(&adjacency);
+
+    H3Index zeros[] = {0, 0};
+    t_assert(H3_EXPORT(h3SetToAdjacency)(zeros, 2, NULL, NULL, &adjacency) ==
+                 0,
+             "set of 0's");
+    t_assert(adjacency.numCells == 2 && adjacency.numEdges == 0,
+             "no edges between 0's");
+    H3_EXPORT(destroyH3Adjacency)(&adjacency);
+
+    H3Index duplicates[] = {sunnyvale, 0, sunnyvale};
+    t_assert(H3_EXPORT(h3SetToAdjacency)(duplicates, 3, NULL, NULL,
+                                         &adjacency) == -1,
+             "duplicate cells fail");
+    t_assert(adjacency.numCells == 0 && adjacency.offsets == NULL,
+             "failed adjacency is empty");
+}
+
+END_TESTS();
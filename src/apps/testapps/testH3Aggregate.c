@@ -0,0 +1,240 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Aggregate.c
+ * @brief Tests the counts and sums of points grouped by hexagon.
+ *
+ *  usage: `testH3Aggregate`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "h3Aggregate.h"
+#include "h3api.h"
+#include "test.h"
+
+#define NUM_POINTS 150011
+#define RES 7
+
+static double lat[NUM_POINTS];
+static double lon[NUM_POINTS];
+static double values[NUM_POINTS];
+
+/**
+ * Runs a task on uneven ranges, one after another, as a stand in for a
+ * thread pool.
+ */
+static void sequentialFor(void* executor, int n, H3ParallelTask task,
+                          void* data) {
+    int* numCalls = executor;
+    int begin = 0;
+    for (int size = 1; begin < n; size += 2) {
+        int end = begin + size < n ? begin + size : n;
+        task(data, begin, end);
+        (*numCalls)++;
+        begin = end;
+    }
+}
+
+/**
+ * Asserts that two aggregates hold the same hexagons, counts and sums.
+ */
+static void assertSameAggregate(const H3Aggregate* a, const H3Aggregate* b) {
+    int size = H3_EXPORT(h3AggregateSize)(a);
+    t_assert(H3_EXPORT(h3AggregateSize)(b) == size, "same size");
+    H3Index* cells = calloc(size, sizeof(H3Index));
+    int64_t* counts = calloc(size, sizeof(int64_t));
+    double* sums = calloc(size, sizeof(double));
+    t_assert(H3_EXPORT(h3AggregateToArrays)(a, cells, counts, sums) == size,
+             "wrote every hexagon");
+    for (int i = 0; i < size; i++) {
+        int64_t count;
+        double sum;
+        t_assert(H3_EXPORT(h3AggregateGet)(b, cells[i], &count, &sum),
+                 "hexagon is in both");
+        t_assert(count == counts[i] && sum == sums[i], "same count and sum");
+    }
+    free(sums);
+    free(counts);
+    free(cells);
+}
+
+BEGIN_TESTS(h3Aggregate);
+
+// Points spiralling around San Francisco, with small whole number values so
+// that sums are exact in any order
+for (int i = 0; i < NUM_POINTS; i++) {
+    double r = 0.02 * sqrt((double)i / NUM_POINTS);
+    lat[i] = 0.659966917655 + r * cos(i * 2.399963);
+    lon[i] = -2.1364398519396 + r * sin(i * 2.399963);
+    values[i] = i % 10;
+}
+
+TEST(invalidResolution) {
+    t_assert(H3_EXPORT(createH3Aggregate)(-1, 0) == NULL, "negative res");
+    t_assert(H3_EXPORT(createH3Aggregate)(16, 0) == NULL, "res too fine");
+}
+
+TEST(matchesGeoToH3) {
+    H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePoints)(agg, lat, lon, values, NUM_POINTS);
+
+    int size = H3_EXPORT(h3AggregateSize)(agg);
+    t_assert(size > 1000, "many hexagons");
+    H3Index* cells = calloc(size, sizeof(H3Index));
+    int64_t* counts = calloc(size, sizeof(int64_t));
+    double* sums = calloc(size, sizeof(double));
+    t_assert(H3_EXPORT(h3AggregateToArrays)(agg, cells, counts, sums) == size,
+             "wrote every hexagon");
+    int64_t totalCount = 0;
+    double totalSum = 0;
+    for (int i = 0; i < size; i++) {
+        t_assert(H3_EXPORT(h3GetResolution)(cells[i]) == RES,
+                 "hexagons are of the resolution");
+        totalCount += counts[i];
+        totalSum += sums[i];
+    }
+    double expectedSum = 0;
+    for (int i = 0; i < NUM_POINTS; i++) expectedSum += values[i];
+    t_assert(totalCount == NUM_POINTS, "counts every point");
+    t_assert(totalSum == expectedSum, "sums every value");
+
+    // Recount one hexagon point by point
+    int64_t expectedCount = 0;
+    double expectedCellSum = 0;
+    for (int i = 0; i < NUM_POINTS; i++) {
+        GeoCoord g = {lat[i], lon[i]};
+        if (H3_EXPORT(geoToH3)(&g, RES) == cells[0]) {
+            expectedCount++;
+            expectedCellSum += values[i];
+        }
+    }
+    int64_t count;
+    double sum;
+    t_assert(H3_EXPORT(h3AggregateGet)(agg, cells[0], &count, &sum) == 1,
+             "hexagon has points");
+    t_assert(count == expectedCount, "count matches geoToH3");
+    t_assert(sum == expectedCellSum, "sum matches geoToH3");
+    t_assert(H3_EXPORT(h3AggregateGet)(agg, 0x89283470c27ffffL, &count,
+                                       &sum) == 0 &&
+                 count == 0 && sum == 0,
+             "hexagon without points");
+
+    free(sums);
+    free(counts);
+    free(cells);
+    H3_EXPORT(destroyH3Aggregate)(agg);
+}
+
+TEST(countOnly) {
+    double badLat[] = {0.5, NAN, 0.5, 0.5};
+    double badLon[] = {0.5, 0.5, INFINITY, 0.5};
+    H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(RES, 1);
+    H3_EXPORT(h3AggregatePoints)(agg, badLat, badLon, NULL, 4);
+    t_assert(H3_EXPORT(h3AggregateSize)(agg) == 1, "one hexagon");
+    H3Index cell;
+    int64_t count;
+    double sum;
+    H3_EXPORT(h3AggregateToArrays)(agg, &cell, &count, &sum);
+    t_assert(count == 2, "non-finite points are skipped");
+    t_assert(sum == 0, "sums are 0 without values");
+    H3_EXPORT(destroyH3Aggregate)(agg);
+}
+
+TEST(mergeAndParallel) {
+    H3Aggregate* whole = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePoints)(whole, lat, lon, values, NUM_POINTS);
+
+    int half = NUM_POINTS / 2;
+    H3Aggregate* merged = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3Aggregate* second = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePoints)(merged, lat, lon, values, half);
+    H3_EXPORT(h3AggregatePoints)
+    (second, lat + half, lon + half, values + half, NUM_POINTS - half);
+    t_assert(H3_EXPORT(h3AggregateMerge)(merged, second) == 0, "merged");
+    assertSameAggregate(whole, merged);
+
+    H3Aggregate* coarse = H3_EXPORT(createH3Aggregate)(RES - 1, 0);
+    t_assert(H3_EXPORT(h3AggregateMerge)(merged, coarse) == -1,
+             "resolutions must match");
+
+    int numCalls = 0;
+    H3Aggregate* parallel = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePointsParallel)
+    (parallel, lat, lon, values, NUM_POINTS, sequentialFor, &numCalls);
+    t_assert(numCalls > 1, "aggregated in parts");
+    assertSameAggregate(whole, parallel);
+
+    H3Aggregate* serial = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePointsParallel)
+    (serial, lat, lon, values, NUM_POINTS, NULL, NULL);
+    assertSameAggregate(whole, serial);
+
+    H3_EXPORT(destroyH3Aggregate)(serial);
+    H3_EXPORT(destroyH3Aggregate)(parallel);
+    H3_EXPORT(destroyH3Aggregate)(coarse);
+    H3_EXPORT(destroyH3Aggregate)(second);
+    H3_EXPORT(destroyH3Aggregate)(merged);
+    H3_EXPORT(destroyH3Aggregate)(whole);
+}
+
+TEST(toParent) {
+    H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePoints)(agg, lat, lon, values, NUM_POINTS);
+    t_assert(H3_EXPORT(h3AggregateToParent)(agg, RES + 1) == NULL,
+             "no finer parents");
+    t_assert(H3_EXPORT(h3AggregateToParent)(agg, -1) == NULL,
+             "no negative resolution");
+
+    int size = H3_EXPORT(h3AggregateSize)(agg);
+    H3Index* cells = calloc(size, sizeof(H3Index));
+    int64_t* counts = calloc(size, sizeof(int64_t));
+    double* sums = calloc(size, sizeof(double));
+    H3_EXPORT(h3AggregateToArrays)(agg, cells, counts, sums);
+    for (int parentRes = 0; parentRes <= RES; parentRes += RES / 2) {
+        H3Aggregate* parents = H3_EXPORT(h3AggregateToParent)(agg, parentRes);
+        int numParents = H3_EXPORT(h3AggregateSize)(parents);
+        H3Index* parentCells = calloc(numParents, sizeof(H3Index));
+        int64_t* parentCounts = calloc(numParents, sizeof(int64_t));
+        double* parentSums = calloc(numParents, sizeof(double));
+        H3_EXPORT(h3AggregateToArrays)
+        (parents, parentCells, parentCounts, parentSums);
+        for (int p = 0; p < numParents; p++) {
+            int64_t expectedCount = 0;
+            double expectedSum = 0;
+            for (int i = 0; i < size; i++) {
+                if (H3_EXPORT(h3ToParent)(cells[i], parentRes) ==
+                    parentCells[p]) {
+                    expectedCount += counts[i];
+                    expectedSum += sums[i];
+                }
+            }
+            t_assert(parentCounts[p] == expectedCount,
+                     "parent count is the sum of its children's");
+            t_assert(parentSums[p] == expectedSum,
+                     "parent sum is the sum of its children's");
+        }
+        free(parentSums);
+        free(parentCounts);
+        free(parentCells);
+        H3_EXPORT(destroyH3Aggregate)(parents);
+    }
+    free(sums);
+    free(counts);
+    free(cells);
+    H3_EXPORT(destroyH3Aggregate)(agg);
+}
+
+END_TESTS();
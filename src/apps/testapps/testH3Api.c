@@ -20,11 +20,35 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
+#include "constants.h"
 #include "geoCoord.h"
+#include "h3Index.h"
 #include "h3api.h"
 #include "test.h"
 #include "utility.h"
 
+/**
+ * Asserts that a center and boundary are exactly those given by h3ToGeo and
+ * h3ToGeoBoundary.
+ */
+static void assertGeoMatches(H3Index h, const GeoCoord* center,
+                             const GeoBoundary* gb) {
+    GeoCoord expected;
+    H3_EXPORT(h3ToGeo)(h, &expected);
+    t_assert(center->lat == expected.lat && center->lon == expected.lon,
+             "center matches h3ToGeo");
+    GeoBoundary expectedBoundary;
+    H3_EXPORT(h3ToGeoBoundary)(h, &expectedBoundary);
+    t_assert(gb->numVerts == expectedBoundary.numVerts,
+             "vertex count matches h3ToGeoBoundary");
+    for (int v = 0; v < gb->numVerts; v++) {
+        t_assert(gb->verts[v].lat == expectedBoundary.verts[v].lat &&
+                     gb->verts[v].lon == expectedBoundary.verts[v].lon,
+                 "vertex matches h3ToGeoBoundary");
+    }
+}
+
 BEGIN_TESTS(h3Api);
 
 TEST(geoToH3_res) {
@@ -49,6 +73,238 @@ TEST(geoToH3_coord) {
              "coordinates with infinity are rejected");
 }
 
+TEST(geoToH3Batch_invalid) {
+    double lat[] = {0, NAN, 0, INFINITY, 0.5};
+    double lon[] = {0, 0, NAN, 0, 0.5};
+    H3Index out[5];
+
+    H3_EXPORT(geoToH3Batch)(lat, lon, 5, 16, out);
+    for (int i = 0; i < 5; i++) {
+        t_assert(out[i] == 0, "resolution above 15 is invalid");
+    }
+
+    H3_EXPORT(geoToH3Batch)(lat, lon, 5, 5, out);
+    t_assert(out[0] != 0, "valid coordinate is encoded");
+    t_assert(out[1] == 0, "invalid latitude is rejected");
+    t_assert(out[2] == 0, "invalid longitude is rejected");
+    t_assert(out[3] == 0, "coordinates with infinity are rejected");
+    t_assert(out[4] != 0, "valid coordinate after invalid is encoded");
+
+    H3_EXPORT(geoToH3Batch)(lat, lon, 0, 5, out);
+}
+
+TEST(geoToH3Batch_matchesGeoToH3) {
+    // a grid over the whole sphere, not a multiple of the block size
+    const int n = 181 * 73;
+    double* lat = malloc(n * sizeof(double));
+    double* lon = malloc(n * sizeof(double));
+    H3Index* out = malloc(n * sizeof(H3Index));
+    for (int i = 0; i < n; i++) {
+        lat[i] = H3_EXPORT(degsToRads)(-90 + 2.5 * (i % 73));
+        lon[i] = H3_EXPORT(degsToRads)(-180 + 2 * (i / 73));
+    }
+
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        H3_EXPORT(geoToH3Batch)(lat, lon, n, res, out);
+        for (int i = 0; i < n; i++) {
+            GeoCoord g = {lat[i], lon[i]};
+            t_assert(out[i] == H3_EXPORT(geoToH3)(&g, res),
+                     "batch and scalar output match");
+        }
+    }
+
+    free(lat);
+    free(lon);
+    free(out);
+}
+
+TEST(h3ToGeoBatch_matchesH3ToGeo) {
+    // a pentagon, a class III hexagon and their neighbors
+    H3Index origins[] = {0x821c07fffffffff, 0x8928308280fffff};
+    for (int o = 0; o < 2; o++) {
+        H3Index cells[37] = {0};
+        H3_EXPORT(kRing)(origins[o], 3, cells);
+        int n = 0;
+        for (int i = 0; i < 37; i++) {
+            if (cells[i]) cells[n++] = cells[i];
+        }
+
+        double lat[37];
+        double lon[37];
+        H3_EXPORT(h3ToGeoBatch)(cells, n, lat, lon);
+
+        double verts[2 * 37 * MAX_CELL_BNDRY_VERTS];
+        int numVerts[37];
+        int total = H3_EXPORT(h3ToGeoBoundaryBatch)(cells, n, verts, numVerts);
+
+        int offset = 0;
+        for (int i = 0; i < n; i++) {
+            GeoCoord g;
+            H3_EXPORT(h3ToGeo)(cells[i], &g);
+            t_assert(lat[i] == g.lat && lon[i] == g.lon,
+                     "batch center matches h3ToGeo");
+
+            GeoBoundary gb;
+            H3_EXPORT(h3ToGeoBoundary)(cells[i], &gb);
+            t_assert(numVerts[i] == gb.numVerts,
+                     "batch vertex count matches h3ToGeoBoundary");
+            for (int v = 0; v < gb.numVerts; v++) {
+                t_assert(verts[2 * (offset + v)] == gb.verts[v].lat &&
+                             verts[2 * (offset + v) + 1] == gb.verts[v].lon,
+                         "batch vertex matches h3ToGeoBoundary");
+            }
+            offset += numVerts[i];
+        }
+        t_assert(total == offset, "total vertex count is the sum of counts");
+    }
+}
+
+TEST(h3ToGeoAndBoundary_matchesSeparateCalls) {
+    // every resolution, and every pentagon and its neighbors at res 2
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        for (int i = 0; i < 100; i++) {
+            GeoCoord g = {(i % 19) * 0.165 - 1.5, (i % 37) * 0.17 - 3.1};
+            H3Index h = H3_EXPORT(geoToH3)(&g, res);
+            GeoCoord center;
+            GeoBoundary gb;
+            H3_EXPORT(h3ToGeoAndBoundary)(h, &center, &gb);
+            assertGeoMatches(h, &center, &gb);
+        }
+    }
+    for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+        H3Index h;
+        setH3Index(&h, 2, bc, 0);
+        if (!H3_EXPORT(h3IsPentagon)(h)) continue;
+        H3Index ring[7] = {0};
+        H3_EXPORT(kRing)(h, 1, ring);
+        for (int i = 0; i < 7; i++) {
+            if (ring[i] == 0) continue;
+            GeoCoord center;
+            GeoBoundary gb;
+            H3_EXPORT(h3ToGeoAndBoundary)(ring[i], &center, &gb);
+            assertGeoMatches(ring[i], &center, &gb);
+        }
+    }
+}
+
+TEST(batchParallel_matchesBatch) {
+    // a pentagon, class III hexagons and their neighbors, with boundaries
+    // of every number of vertices
+    H3Index cells[37] = {0};
+    H3_EXPORT(kRing)(0x811c3ffffffffffL, 3, cells);
+    int n = 0;
+    for (int i = 0; i < 37; i++) {
+        if (cells[i]) cells[n++] = cells[i];
+    }
+    int numCalls = 0;
+
+    double lat[37];
+    double lon[37];
+    double parallelLat[37];
+    double parallelLon[37];
+    H3_EXPORT(h3ToGeoBatch)(cells, n, lat, lon);
+    H3_EXPORT(h3ToGeoBatchParallel)
+    (cells, n, parallelLat, parallelLon, reverseParallelFor, &numCalls);
+    H3Index indexed[37];
+    H3Index parents[37];
+    H3_EXPORT(geoToH3BatchParallel)
+    (lat, lon, n, 1, indexed, reverseParallelFor, &numCalls);
+    H3_EXPORT(h3ToParentBatchParallel)
+    (cells, n, 0, parents, reverseParallelFor, &numCalls);
+    for (int i = 0; i < n; i++) {
+        t_assert(parallelLat[i] == lat[i] && parallelLon[i] == lon[i],
+                 "h3ToGeoBatchParallel matches");
+        t_assert(indexed[i] == cells[i], "geoToH3BatchParallel matches");
+        t_assert(parents[i] == H3_EXPORT(h3ToParent)(cells[i], 0),
+                 "h3ToParentBatchParallel matches");
+    }
+
+    double verts[2 * 37 * MAX_CELL_BNDRY_VERTS];
+    double parallelVerts[2 * 37 * MAX_CELL_BNDRY_VERTS];
+    int numVerts[37];
+    int parallelNumVerts[37];
+    int total = H3_EXPORT(h3ToGeoBoundaryBatch)(cells, n, verts, numVerts);
+    t_assert(H3_EXPORT(h3ToGeoBoundaryBatchParallel)(
+                 cells, n, parallelVerts, parallelNumVerts,
+                 reverseParallelFor, &numCalls) == total,
+             "same total vertex count");
+    for (int i = 0; i < n; i++) {
+        t_assert(parallelNumVerts[i] == numVerts[i], "same vertex count");
+    }
+    for (int v = 0; v < 2 * total; v++) {
+        t_assert(parallelVerts[v] == verts[v],
+                 "h3ToGeoBoundaryBatchParallel matches");
+    }
+    t_assert(numCalls > 4, "ran in many tasks");
+
+    H3_EXPORT(h3ToGeoBoundaryBatchParallel)
+    (cells, 0, parallelVerts, parallelNumVerts, reverseParallelFor, &numCalls);
+}
+
+TEST(h3ToGeoBoundaryPacked_withinTolerance) {
+    // every resolution 0 and 1 cell, including the pentagons and the cells
+    // crossing the antimeridian, and a few fine cells
+    static H3Index cells[NUM_BASE_CELLS * 8 + 3];
+    int n = 0;
+    for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+        H3Index baseCell;
+        setH3Index(&baseCell, 0, bc, CENTER_DIGIT);
+        cells[n++] = baseCell;
+        H3Index children[7] = {0};
+        H3_EXPORT(h3ToChildren)(baseCell, 1, children);
+        for (int c = 0; c < 7; c++) {
+            if (children[c]) cells[n++] = children[c];
+        }
+    }
+    cells[n++] = 0x8f2830828052d25;
+    cells[n++] = 0x8f0800000000000;
+    cells[n++] = 0x89283470c27ffff;
+    for (int i = n - 3; i < n; i++) {
+        t_assert(H3_EXPORT(h3IsValid)(cells[i]), "fine cell is valid");
+    }
+
+    static int32_t centers[2 * (NUM_BASE_CELLS * 8 + 3)];
+    static float offsets[2 * MAX_CELL_BNDRY_VERTS * (NUM_BASE_CELLS * 8 + 3)];
+    static uint8_t numVerts[NUM_BASE_CELLS * 8 + 3];
+    int total =
+        H3_EXPORT(h3ToGeoBoundaryPacked)(cells, n, centers, offsets, numVerts);
+    static int32_t packedCenters[2 * (NUM_BASE_CELLS * 8 + 3)];
+    H3_EXPORT(h3ToGeoPacked)(cells, n, packedCenters);
+
+    int offset = 0;
+    double maxError = 0;
+    for (int i = 0; i < n; i++) {
+        t_assert(packedCenters[2 * i] == centers[2 * i] &&
+                     packedCenters[2 * i + 1] == centers[2 * i + 1],
+                 "packed centers match");
+        GeoCoord g;
+        H3_EXPORT(h3ToGeo)(cells[i], &g);
+        t_assert(fabs(centers[2 * i] / 1e6 - H3_EXPORT(radsToDegs)(g.lat)) <=
+                         0.5e-6 &&
+                     fabs(centers[2 * i + 1] / 1e6 -
+                          H3_EXPORT(radsToDegs)(g.lon)) <= 0.5e-6,
+                 "center is rounded to microdegrees");
+
+        GeoBoundary expected;
+        GeoBoundary unpacked;
+        H3_EXPORT(h3ToGeoBoundary)(cells[i], &expected);
+        t_assert(numVerts[i] == expected.numVerts, "vertex count matches");
+        H3_EXPORT(packedToGeoBoundary)
+        (&centers[2 * i], &offsets[2 * offset], numVerts[i], &unpacked);
+        t_assert(unpacked.numVerts == expected.numVerts, "unpacked count");
+        for (int v = 0; v < expected.numVerts; v++) {
+            double dLat = fabs(unpacked.verts[v].lat - expected.verts[v].lat);
+            double dLon = fabs(unpacked.verts[v].lon - expected.verts[v].lon);
+            if (dLon > M_PI) dLon = 2 * M_PI - dLon;
+            if (dLat > maxError) maxError = dLat;
+            if (dLon > maxError) maxError = dLon;
+        }
+        offset += numVerts[i];
+    }
+    t_assert(total == offset, "total vertex count is the sum of counts");
+    t_assert(maxError < 1e-7, "unpacked vertices are within 1e-7 radians");
+}
+
 TEST(h3ToGeoBoundary_classIIIEdgeVertex) {
     // Bug test for https://github.com/uber/h3/issues/45
     char* hexes[] = {"894cc5349b7ffff", "894cc534d97ffff", "894cc53682bffff",
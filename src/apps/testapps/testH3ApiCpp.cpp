@@ -0,0 +1,217 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3ApiCpp.cpp
+ * @brief Tests the C++ layer of h3api.hpp against the C functions it wraps.
+ *
+ *  usage: `testH3ApiCpp`
+ */
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "h3api.hpp"
+
+extern "C" {
+#include "test.h"
+}
+
+static const H3Index sunnyvale = 0x89283470c27ffffULL;
+static const H3Index pentagon = 0x8009fffffffffffULL;
+
+static GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+
+// Buffer sizes are compile time constants
+static_assert(h3::maxKringSize(0) == 1, "maxKringSize(0)");
+static_assert(h3::maxKringSize(2) == 19, "maxKringSize(2)");
+static_assert(h3::numHexagons(0) == 122, "numHexagons(0)");
+static_assert(h3::numHexagons(15) == 569707381193162LL, "numHexagons(15)");
+static_assert(h3::maxH3ToChildrenSize(sunnyvale, 11) == 49,
+              "maxH3ToChildrenSize");
+static_assert(h3::maxH3ToChildrenSize(sunnyvale, 8) == 0,
+              "maxH3ToChildrenSize of a coarser resolution");
+static_assert(h3::maxKringSize(H3_MAX_KRING_K + 1) == -1,
+              "maxKringSize overflow");
+static_assert(h3::maxKringSize64(H3_MAX_KRING_K + 1) == 2147570341LL,
+              "maxKringSize64");
+static_assert(h3::maxH3ToChildrenSize(0, 12) == -1,
+              "maxH3ToChildrenSize overflow");
+static_assert(h3::maxH3ToChildrenSize64(0, 15) == 4747561509943LL,
+              "maxH3ToChildrenSize64");
+
+/** Sorts a copy of a span of indexes, for comparing sets */
+static std::vector<H3Index> sorted(h3::span<const H3Index> h3Set) {
+    std::vector<H3Index> copy(h3Set.begin(), h3Set.end());
+    std::sort(copy.begin(), copy.end());
+    return copy;
+}
+
+/** Sorts the nonzero indexes of a C output array */
+static std::vector<H3Index> sortedNonzero(const H3Index* out, int n) {
+    std::vector<H3Index> copy;
+    for (int i = 0; i < n; i++) {
+        if (out[i] != 0) copy.push_back(out[i]);
+    }
+    std::sort(copy.begin(), copy.end());
+    return copy;
+}
+
+BEGIN_TESTS(h3ApiCpp);
+
+TEST(constexprSizes) {
+    for (int k = -1; k < 50; k++) {
+        t_assert(h3::maxKringSize(k) == H3_EXPORT(maxKringSize)(k),
+                 "maxKringSize matches");
+        t_assert(h3::maxKringSize64(k) == H3_EXPORT(maxKringSize64)(k),
+                 "maxKringSize64 matches");
+    }
+    for (int res = 0; res <= 15; res++) {
+        t_assert(h3::numHexagons(res) == H3_EXPORT(numHexagons)(res),
+                 "numHexagons matches");
+    }
+    t_assert(h3::numHexagons(-1) == 0 && h3::numHexagons(16) == 0,
+             "numHexagons of an invalid resolution");
+    for (int childRes = 0; childRes <= 15; childRes++) {
+        t_assert(h3::maxH3ToChildrenSize(sunnyvale, childRes) ==
+                     H3_EXPORT(maxH3ToChildrenSize)(sunnyvale, childRes),
+                 "maxH3ToChildrenSize matches");
+        t_assert(h3::maxH3ToChildrenSize64(0, childRes) ==
+                     H3_EXPORT(maxH3ToChildrenSize64)(pentagon, childRes),
+                 "maxH3ToChildrenSize64 matches");
+    }
+}
+
+TEST(kRing) {
+    H3Index expected[19] = {0};
+    H3_EXPORT(kRing)(sunnyvale, 2, expected);
+
+    std::array<H3Index, h3::maxKringSize(2)> out;
+    t_assert(h3::kRing(sunnyvale, 2, out) == 19, "wrote the disk");
+    t_assert(out[0] == sunnyvale, "origin is first");
+    t_assert(sorted(out) == sortedNonzero(expected, 19), "same disk");
+
+    std::array<H3Index, 18> small;
+    t_assert(h3::kRing(sunnyvale, 2, small) == -1, "too small");
+    t_assert(h3::kRing(sunnyvale, -1, out) == -1, "negative k");
+
+    h3::span<const H3Index> disk = h3::kRing(sunnyvale, 2);
+    t_assert(disk.size() == 19, "thread buffer holds the disk");
+    t_assert(sorted(disk) == sortedNonzero(expected, 19),
+             "same disk in thread buffer");
+    t_assert(h3::kRing(sunnyvale, -1).empty(), "negative k is empty");
+
+    // Around a pentagon there are fewer than maxKringSize(k) indexes
+    H3Index pentagonExpected[61] = {0};
+    H3_EXPORT(kRing)(pentagon, 4, pentagonExpected);
+    h3::span<const H3Index> pentagonDisk = h3::kRing(pentagon, 4);
+    t_assert(pentagonDisk.size() < 61, "pentagon disk is smaller");
+    t_assert(sorted(pentagonDisk) == sortedNonzero(pentagonExpected, 61),
+             "same pentagon disk");
+}
+
+TEST(polyfill) {
+    Geofence geofence = {6, sfVerts};
+    GeoPolygon geoPolygon = {geofence, 0, NULL};
+    int maxSize = H3_EXPORT(maxPolyfillSize)(&geoPolygon, 9);
+    H3Index* expected = static_cast<H3Index*>(calloc(maxSize, sizeof(H3Index)));
+    H3_EXPORT(polyfill)(&geoPolygon, 9, expected);
+    std::vector<H3Index> expectedSet = sortedNonzero(expected, maxSize);
+    free(expected);
+
+    // Grows from empty, then is reused for a smaller resolution
+    h3::span<const H3Index> cells = h3::polyfill(geoPolygon, 9);
+    t_assert(sorted(cells) == expectedSet, "same polyfill");
+    h3::span<const H3Index> coarser = h3::polyfill(geoPolygon, 7);
+    t_assert(coarser.size() > 0 && coarser.size() < expectedSet.size(),
+             "coarser polyfill");
+    t_assert(coarser.data() == cells.data(), "thread buffer is reused");
+
+    std::vector<H3Index> out(expectedSet.size());
+    t_assert(h3::polyfill(geoPolygon, 9, out) ==
+                 static_cast<int>(expectedSet.size()),
+             "polyfill into a span");
+    t_assert(sorted(out) == expectedSet, "same polyfill in span");
+    std::array<H3Index, 10> small;
+    t_assert(h3::polyfill(geoPolygon, 9, small) ==
+                 static_cast<int>(expectedSet.size()),
+             "total is returned when the span is too small");
+
+    // A span longer than INT_MAX is filled as if it held INT_MAX cells
+    std::fill(out.begin(), out.end(), 0);
+    h3::span<H3Index> huge(out.data(), static_cast<std::size_t>(INT_MAX) + 1);
+    t_assert(h3::polyfill(geoPolygon, 9, huge) ==
+                 static_cast<int>(expectedSet.size()),
+             "polyfill into a span longer than INT_MAX");
+    t_assert(sorted(out) == expectedSet, "same polyfill in long span");
+}
+
+TEST(batch) {
+    std::array<H3Index, h3::maxKringSize(3)> cells;
+    int numCells = h3::kRing(sunnyvale, 3, cells);
+    std::array<double, h3::maxKringSize(3)> lat;
+    std::array<double, h3::maxKringSize(3)> lon;
+    t_assert(h3::h3ToGeoBatch(cells, lat, lon) == 0, "decoded");
+    for (int i = 0; i < numCells; i++) {
+        GeoCoord center;
+        H3_EXPORT(h3ToGeo)(cells[i], &center);
+        t_assert(lat[i] == center.lat && lon[i] == center.lon,
+                 "same center");
+    }
+    std::array<H3Index, h3::maxKringSize(3)> encoded;
+    t_assert(h3::geoToH3Batch(lat, lon, 9, encoded) == 0, "encoded");
+    t_assert(encoded == cells, "centers encode to their cells");
+
+    t_assert(h3::h3ToGeoBatch(cells, lat, h3::span<double>(lon.data(), 3)) ==
+                 -1,
+             "decoding reports a size mismatch");
+    t_assert(h3::geoToH3Batch(lat, lon, 9,
+                              h3::span<H3Index>(encoded.data(), 3)) == -1,
+             "encoding reports a size mismatch");
+}
+
+TEST(linkedPolygon) {
+    h3::LinkedPolygon empty;
+    t_assert(empty.empty() && empty.numPolygons() == 0, "empty by default");
+
+    std::array<H3Index, h3::maxKringSize(1)> disk;
+    h3::kRing(sunnyvale, 1, disk);
+    h3::LinkedPolygon outline(disk);
+    t_assert(outline.numPolygons() == 1, "one polygon");
+    t_assert(outline->first != NULL && outline->first->next == NULL,
+             "one loop");
+    const LinkedGeoLoop* loop = outline->first;
+
+    // Moving transfers the loops without copying them
+    h3::LinkedPolygon moved(std::move(outline));
+    t_assert(outline.empty(), "moved from is empty");
+    t_assert(moved->first == loop, "moved the loops");
+
+    std::array<H3Index, h3::maxKringSize(3)> wider;
+    h3::kRing(sunnyvale, 3, wider);
+    std::array<H3Index, 2> apart = {sunnyvale, wider.back()};
+    h3::LinkedPolygon separate(apart);
+    t_assert(separate.numPolygons() == 2, "two polygons");
+    separate = std::move(moved);
+    t_assert(separate->first == loop, "assigned the loops");
+    t_assert(moved.empty(), "assigned from is empty");
+}
+
+END_TESTS();
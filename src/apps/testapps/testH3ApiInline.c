@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3ApiInline.c
+ * @brief Tests the inline functions of h3api_inline.h against the index bit
+ * field macros and the digit by digit definitions they replace.
+ *
+ *  usage: `testH3ApiInline`
+ */
+
+#include <string.h>
+#include "baseCells.h"
+#include "constants.h"
+#include "h3Index.h"
+#include "h3api_inline.h"
+#include "test.h"
+
+/** cells checked: every cell at resolution 2 */
+#define MAX_CELLS (NUM_BASE_CELLS * 49)
+
+H3Index cells[MAX_CELLS];
+int numCells;
+
+/**
+ * Fills the fixture with every cell at resolution 2.
+ */
+static void setupCells(void) {
+    H3Index children[49];
+    numCells = 0;
+    for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+        H3Index base;
+        setH3Index(&base, 0, bc, 0);
+        int maxChildren = H3_EXPORT(maxH3ToChildrenSize)(base, 2);
+        memset(children, 0, sizeof(children));
+        H3_EXPORT(h3ToChildren)(base, 2, children);
+        // pentagons leave the deleted children as 0
+        for (int i = 0; i < maxChildren; i++) {
+            if (children[i]) cells[numCells++] = children[i];
+        }
+    }
+}
+
+/**
+ * The parent as computed before the inline version, one digit at a time.
+ */
+static H3Index referenceParent(H3Index h, int parentRes) {
+    H3_SET_RESOLUTION(h, parentRes);
+    for (int r = parentRes + 1; r <= MAX_H3_RES; r++) {
+        H3_SET_INDEX_DIGIT(h, r, H3_DIGIT_MASK);
+    }
+    return h;
+}
+
+BEGIN_TESTS(h3ApiInline);
+
+setupCells();
+
+TEST(bitFields) {
+    for (int i = 0; i < numCells; i++) {
+        H3Index h = cells[i];
+        // fill the reserved bits to check they are ignored
+        H3Index marked = h | H3_RESERVED_MASK;
+        t_assert(h3GetResolutionInline(h) == H3_GET_RESOLUTION(h),
+                 "resolution matches");
+        t_assert(h3GetBaseCellInline(h) == H3_GET_BASE_CELL(h),
+                 "base cell matches");
+        t_assert(h3IsResClassIIIInline(h) == H3_GET_RESOLUTION(h) % 2,
+                 "class III matches");
+        t_assert(h3GetResolutionInline(marked) == H3_GET_RESOLUTION(h),
+                 "resolution ignores other fields");
+    }
+}
+
+TEST(h3IsPentagonInline) {
+    int numPentagons = 0;
+    for (int i = 0; i < numCells; i++) {
+        H3Index h = cells[i];
+        int expected = _isBaseCellPentagon(H3_GET_BASE_CELL(h)) &&
+                       !_h3LeadingNonZeroDigit(h);
+        t_assert(h3IsPentagonInline(h) == expected, "pentagon matches");
+        numPentagons += h3IsPentagonInline(h);
+    }
+    t_assert(numPentagons == 12, "found every pentagon");
+    for (int bc = 0; bc < 128; bc++) {
+        t_assert(h3BaseCellIsPentagonInline(bc) ==
+                     (bc < NUM_BASE_CELLS && baseCellData[bc].isPentagon),
+                 "base cell pentagon bit matches");
+    }
+}
+
+TEST(h3IsValidInline) {
+    for (int i = 0; i < numCells; i++) {
+        H3Index h = cells[i];
+        t_assert(h3IsValidInline(h), "cell is valid");
+
+        H3Index wrongMode = h;
+        H3_SET_MODE(wrongMode, H3_UNIEDGE_MODE);
+        t_assert(!h3IsValidInline(wrongMode), "edge mode is not valid");
+
+        H3Index unusedDigit = h;
+        H3_SET_INDEX_DIGIT(unusedDigit, 5, CENTER_DIGIT);
+        t_assert(!h3IsValidInline(unusedDigit), "unused digit is not valid");
+
+        H3Index invalidDigit = h;
+        H3_SET_INDEX_DIGIT(invalidDigit, 2, H3_DIGIT_MASK);
+        t_assert(!h3IsValidInline(invalidDigit), "digit 7 is not valid");
+    }
+}
+
+TEST(h3ToParentInline) {
+    for (int i = 0; i < numCells; i++) {
+        H3Index h = cells[i];
+        for (int parentRes = 0; parentRes <= 2; parentRes++) {
+            t_assert(h3ToParentInline(h, parentRes) ==
+                         referenceParent(h, parentRes),
+                     "parent matches");
+        }
+        t_assert(h3ToParentInline(h, 3) == 0, "finer parent fails");
+        t_assert(h3ToParentInline(h, -1) == 0, "invalid resolution fails");
+        t_assert(h3ToParentInline(h, 16) == 0, "invalid resolution fails");
+    }
+}
+
+TEST(edgesInline) {
+    for (int i = 0; i < numCells; i++) {
+        H3Index h = cells[i];
+        for (int direction = 0; direction <= 7; direction++) {
+            H3Index edge = h;
+            H3_SET_MODE(edge, H3_UNIEDGE_MODE);
+            H3_SET_RESERVED_BITS(edge, direction);
+            int expected = direction >= 1 && direction <= 6 &&
+                           !(direction == 1 && h3IsPentagonInline(h));
+            t_assert(h3UnidirectionalEdgeIsValidInline(edge) == expected,
+                     "edge validity matches");
+            t_assert(getOriginH3IndexFromUnidirectionalEdgeInline(edge) == h,
+                     "origin matches");
+        }
+        t_assert(!h3UnidirectionalEdgeIsValidInline(h),
+                 "cell is not a valid edge");
+    }
+}
+
+END_TESTS();
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Bitmap.c
+ * @brief Tests the ordinals of hexagons and the bitmaps of hexagons.
+ *
+ *  usage: `testH3Bitmap`
+ */
+
+#include <stdlib.h>
+#include "baseCells.h"
+#include "constants.h"
+#include "h3Bitmap.h"
+#include "h3Index.h"
+#include "test.h"
+
+/** the resolution 3 pentagon of base cell 4 */
+static H3Index pentagon = 0x830800fffffffffL;
+
+/**
+ * The resolution 3 hexagons within k of the pentagon, compacted, into
+ * compacted, which holds maxKringSize(k) indexes.
+ */
+static void compactDisk(int k, H3Index* compacted) {
+    int numHexes = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(pentagon, k, ring);
+    t_assert(H3_EXPORT(compact)(ring, compacted, numHexes) == 0,
+             "compact succeeds");
+    free(ring);
+}
+
+static int compareIndexes(const void* a, const void* b) {
+    H3Index x = *(const H3Index*)a;
+    H3Index y = *(const H3Index*)b;
+    return x < y ? -1 : x > y;
+}
+
+BEGIN_TESTS(h3Bitmap);
+
+TEST(ordinalsAreDense) {
+    for (int res = 0; res <= 3; res++) {
+        int64_t numHexes = H3_EXPORT(numHexagons)(res);
+        H3Index previous = 0;
+        for (int64_t i = 0; i < numHexes; i++) {
+            H3Index h = H3_EXPORT(ordinalToH3)(i, res);
+            t_assert(H3_EXPORT(h3IsValid)(h), "ordinal gives a valid index");
+            t_assert(H3_EXPORT(h3GetResolution)(h) == res,
+                     "ordinal gives an index of its resolution");
+            t_assert(H3_EXPORT(h3ToOrdinal)(h) == i, "ordinal round trips");
+            t_assert(i == 0 || H3_EXPORT(h3ToOrderKey)(h) >
+                                   H3_EXPORT(h3ToOrderKey)(previous),
+                     "ordinals follow base cells and digits");
+            previous = h;
+        }
+    }
+}
+
+TEST(ordinalsOfFineHexagons) {
+    H3Index sunnyvale = 0x89283470c27ffffL;
+    int64_t ordinal = H3_EXPORT(h3ToOrdinal)(sunnyvale);
+    t_assert(H3_EXPORT(ordinalToH3)(ordinal, 9) == sunnyvale,
+             "resolution 9 ordinal round trips");
+
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        int64_t last = H3_EXPORT(numHexagons)(res) - 1;
+        H3Index h = H3_EXPORT(ordinalToH3)(last, res);
+        t_assert(H3_EXPORT(h3IsValid)(h), "last ordinal is valid");
+        t_assert(H3_EXPORT(h3GetBaseCell)(h) == NUM_BASE_CELLS - 1,
+                 "last ordinal is in the last base cell");
+        t_assert(H3_EXPORT(h3ToOrdinal)(h) == last, "last ordinal round trips");
+
+        // The first non center digit of a pentagon descendant follows the
+        // descendants with more leading centers
+        H3Index p;
+        setH3Index(&p, res, 4, CENTER_DIGIT);
+        int64_t first = H3_EXPORT(h3ToOrdinal)(p);
+        if (res > 0) {
+            H3Index h2 = p;
+            H3_SET_INDEX_DIGIT(h2, 1, J_AXES_DIGIT);
+            t_assert(H3_EXPORT(h3ToOrdinal)(h2) ==
+                         first + _h3NumDescendants(1, res - 1),
+                     "pentagon ordinals skip the K axis");
+            t_assert(H3_EXPORT(ordinalToH3)(first + 1, res) != p &&
+                         H3_EXPORT(h3IsValid)(
+                             H3_EXPORT(ordinalToH3)(first + 1, res)),
+                     "next ordinal after a pentagon is valid");
+        }
+    }
+
+    t_assert(H3_EXPORT(ordinalToH3)(-1, 0) == 0, "negative ordinal");
+    t_assert(H3_EXPORT(ordinalToH3)(NUM_BASE_CELLS, 0) == 0,
+             "ordinal past the last hexagon");
+    t_assert(H3_EXPORT(ordinalToH3)(0, -1) == 0, "negative resolution");
+    t_assert(H3_EXPORT(ordinalToH3)(0, MAX_H3_RES + 1) == 0,
+             "resolution too fine");
+}
+
+TEST(addAndContains) {
+    t_assert(H3_EXPORT(createH3Bitmap)(H3_BITMAP_MAX_RES + 1) == NULL,
+             "no bitmap finer than the maximum");
+    t_assert(H3_EXPORT(createH3Bitmap)(-1) == NULL, "no negative resolution");
+
+    H3Bitmap* bitmap = H3_EXPORT(createH3Bitmap)(3);
+    int numHexes = H3_EXPORT(maxKringSize)(5);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(pentagon, 5, disk);
+    int numAdded = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (disk[i] == 0) continue;
+        t_assert(H3_EXPORT(h3BitmapAdd)(bitmap, disk[i]) == 1, "added");
+        t_assert(H3_EXPORT(h3BitmapAdd)(bitmap, disk[i]) == 0,
+                 "added only once");
+        numAdded++;
+    }
+    t_assert(H3_EXPORT(h3BitmapCount)(bitmap) == numAdded, "count matches");
+    for (int i = 0; i < numHexes; i++) {
+        if (disk[i] == 0) continue;
+        t_assert(H3_EXPORT(h3BitmapContains)(bitmap, disk[i]), "contains");
+    }
+    H3Index parent = H3_EXPORT(h3ToParent)(pentagon, 2);
+    t_assert(H3_EXPORT(h3BitmapAdd)(bitmap, parent) == -1,
+             "other resolutions are not added");
+    t_assert(!H3_EXPORT(h3BitmapContains)(bitmap, parent),
+             "other resolutions are not contained");
+    H3Index far = H3_EXPORT(ordinalToH3)(H3_EXPORT(numHexagons)(3) - 1, 3);
+    t_assert(!H3_EXPORT(h3BitmapContains)(bitmap, far),
+             "does not contain a far hexagon");
+
+    H3_EXPORT(destroyH3Bitmap)(bitmap);
+    free(disk);
+}
+
+TEST(compactRoundTrip) {
+    int numHexes = H3_EXPORT(maxKringSize)(12);
+    H3Index* compacted = calloc(numHexes, sizeof(H3Index));
+    compactDisk(12, compacted);
+    int numCompacted = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (compacted[i] != 0) compacted[numCompacted++] = compacted[i];
+    }
+
+    H3Bitmap* bitmap = H3_EXPORT(createH3Bitmap)(5);
+    t_assert(
+        H3_EXPORT(h3BitmapAddCompact)(bitmap, compacted, numCompacted) == 0,
+        "added compacted set");
+    int numUncompacted =
+        H3_EXPORT(maxUncompactSize)(compacted, numCompacted, 5);
+    H3Index* uncompacted = calloc(numUncompacted, sizeof(H3Index));
+    t_assert(H3_EXPORT(uncompact)(compacted, numCompacted, uncompacted,
+                                  numUncompacted, 5) == 0,
+             "uncompact succeeds");
+    int numNonZero = 0;
+    for (int i = 0; i < numUncompacted; i++) {
+        if (uncompacted[i] == 0) continue;
+        numNonZero++;
+        t_assert(H3_EXPORT(h3BitmapContains)(bitmap, uncompacted[i]),
+                 "contains every uncompacted hexagon");
+    }
+    t_assert(H3_EXPORT(h3BitmapCount)(bitmap) == numNonZero,
+             "count matches uncompacted set");
+
+    // The bitmap of a resolution 3 set compacts back to the same set
+    H3Index* out = calloc(numHexes, sizeof(H3Index));
+    int numOut = H3_EXPORT(h3BitmapToCompact)(bitmap, out, numHexes);
+    t_assert(numOut == numCompacted, "compacts to as many hexagons");
+    qsort(compacted, numCompacted, sizeof(H3Index), compareIndexes);
+    qsort(out, numOut, sizeof(H3Index), compareIndexes);
+    for (int i = 0; i < numOut; i++) {
+        t_assert(out[i] == compacted[i], "compacts to the same hexagons");
+    }
+    t_assert(H3_EXPORT(h3BitmapToCompact)(bitmap, out, numOut - 1) == -1,
+             "output too small");
+
+    H3Index fine = H3_EXPORT(ordinalToH3)(0, 6);
+    t_assert(H3_EXPORT(h3BitmapAddCompact)(bitmap, &fine, 1) == -1,
+             "finer hexagons are not added");
+
+    H3_EXPORT(destroyH3Bitmap)(bitmap);
+    free(out);
+    free(uncompacted);
+    free(compacted);
+}
+
+TEST(everyHexagon) {
+    H3Index baseCells[NUM_BASE_CELLS];
+    for (int i = 0; i < NUM_BASE_CELLS; i++) {
+        setH3Index(&baseCells[i], 0, i, CENTER_DIGIT);
+    }
+    H3Bitmap* bitmap = H3_EXPORT(createH3Bitmap)(4);
+    H3_EXPORT(h3BitmapAddCompact)(bitmap, baseCells, NUM_BASE_CELLS);
+    t_assert(H3_EXPORT(h3BitmapCount)(bitmap) == H3_EXPORT(numHexagons)(4),
+             "holds every hexagon");
+    H3Index out[NUM_BASE_CELLS];
+    t_assert(H3_EXPORT(h3BitmapToCompact)(bitmap, out, NUM_BASE_CELLS) ==
+                 NUM_BASE_CELLS,
+             "compacts to the base cells");
+    for (int i = 0; i < NUM_BASE_CELLS; i++) {
+        t_assert(out[i] == baseCells[i], "base cells in order");
+    }
+    H3_EXPORT(destroyH3Bitmap)(bitmap);
+}
+
+TEST(unionAndIntersection) {
+    int numHexes = H3_EXPORT(maxKringSize)(6);
+    H3Index* diskA = calloc(numHexes, sizeof(H3Index));
+    H3Index* diskB = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(pentagon, 6, diskA);
+    H3Index other = H3_EXPORT(ordinalToH3)(
+        H3_EXPORT(h3ToOrdinal)(pentagon) + 40, 3);
+    H3_EXPORT(kRing)(other, 6, diskB);
+
+    H3Bitmap* a = H3_EXPORT(createH3Bitmap)(3);
+    H3Bitmap* b = H3_EXPORT(createH3Bitmap)(3);
+    for (int i = 0; i < numHexes; i++) {
+        if (diskA[i]) H3_EXPORT(h3BitmapAdd)(a, diskA[i]);
+        if (diskB[i]) H3_EXPORT(h3BitmapAdd)(b, diskB[i]);
+    }
+    int64_t countA = H3_EXPORT(h3BitmapCount)(a);
+    int64_t countB = H3_EXPORT(h3BitmapCount)(b);
+
+    H3Bitmap* both = H3_EXPORT(createH3Bitmap)(3);
+    H3_EXPORT(h3BitmapUnion)(both, a);
+    t_assert(H3_EXPORT(h3BitmapIntersection)(both, b) == 0, "intersected");
+    for (int i = 0; i < numHexes; i++) {
+        if (diskA[i] == 0) continue;
+        t_assert(H3_EXPORT(h3BitmapContains)(both, diskA[i]) ==
+                     H3_EXPORT(h3BitmapContains)(b, diskA[i]),
+                 "intersection holds the hexagons of a in b");
+    }
+    int64_t countBoth = H3_EXPORT(h3BitmapCount)(both);
+    t_assert(countBoth > 0, "disks overlap");
+
+    t_assert(H3_EXPORT(h3BitmapUnion)(a, b) == 0, "united");
+    t_assert(H3_EXPORT(h3BitmapCount)(a) + countBoth == countA + countB,
+             "union and intersection counts agree");
+    for (int i = 0; i < numHexes; i++) {
+        if (diskB[i] == 0) continue;
+        t_assert(H3_EXPORT(h3BitmapContains)(a, diskB[i]),
+                 "union holds the hexagons of b");
+    }
+
+    H3Bitmap* coarse = H3_EXPORT(createH3Bitmap)(2);
+    t_assert(H3_EXPORT(h3BitmapUnion)(a, coarse) == -1,
+             "union of resolutions differing");
+    t_assert(H3_EXPORT(h3BitmapIntersection)(a, coarse) == -1,
+             "intersection of resolutions differing");
+
+    H3_EXPORT(destroyH3Bitmap)(coarse);
+    H3_EXPORT(destroyH3Bitmap)(both);
+    H3_EXPORT(destroyH3Bitmap)(b);
+    H3_EXPORT(destroyH3Bitmap)(a);
+    free(diskB);
+    free(diskA);
+}
+
+END_TESTS();
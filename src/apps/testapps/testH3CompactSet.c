@@ -0,0 +1,169 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3CompactSet.c
+ * @brief Tests the sets of hexagons kept compacted.
+ *
+ *  usage: `testH3CompactSet`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "h3Index.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+/**
+ * Tests that a compacted set holds what compact writes for the hexagons
+ * marked present.
+ */
+static void assertCompacted(const H3CompactSet* set, const H3Index* hexes,
+                            const int* present, int numHexes) {
+    H3Index* h3Set = calloc(numHexes, sizeof(H3Index));
+    int numPresent = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (present[i]) h3Set[numPresent++] = hexes[i];
+    }
+    H3Index* expected = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(compact)(h3Set, expected, numPresent) == 0,
+             "compacted");
+    int numExpected = 0;
+    for (int i = 0; i < numPresent; i++) {
+        if (expected[i] != 0) expected[numExpected++] = expected[i];
+    }
+    H3_EXPORT(h3SortCells)(expected, numExpected);
+
+    t_assert(H3_EXPORT(h3CompactSetSize)(set) == numExpected,
+             "size matches compact");
+    H3Index* out = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(h3CompactSetToArray)(set, out) == numExpected,
+             "wrote every hexagon");
+    t_assert(memcmp(out, expected, numExpected * sizeof(H3Index)) == 0,
+             "hexagons match compact, sorted");
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3CompactSetContains)(set, hexes[i]) == present[i],
+                 "contains the hexagons present");
+    }
+    free(out);
+    free(expected);
+    free(h3Set);
+}
+
+/**
+ * Adds and removes hexagons in random order, checking the set against
+ * compact after each step.
+ */
+static void randomUpdates(int res, const H3Index* hexes, int numHexes,
+                          int numSteps) {
+    H3CompactSet* set = H3_EXPORT(createH3CompactSet)(res);
+    int* present = calloc(numHexes, sizeof(int));
+    for (int step = 0; step < numSteps; step++) {
+        int i = rand() % numHexes;
+        // Adding more often than removing fills the set so groups merge
+        if (rand() % 3 != 0) {
+            t_assert(H3_EXPORT(h3CompactSetAdd)(set, hexes[i]) == !present[i],
+                     "added if not present");
+            present[i] = 1;
+        } else {
+            t_assert(
+                H3_EXPORT(h3CompactSetRemove)(set, hexes[i]) == present[i],
+                "removed if present");
+            present[i] = 0;
+        }
+        assertCompacted(set, hexes, present, numHexes);
+    }
+    H3_EXPORT(destroyH3CompactSet)(set);
+    free(present);
+}
+
+BEGIN_TESTS(h3CompactSet);
+
+TEST(createInvalid) {
+    t_assert(H3_EXPORT(createH3CompactSet)(-1) == NULL, "negative res");
+    t_assert(H3_EXPORT(createH3CompactSet)(MAX_H3_RES + 1) == NULL,
+             "res too fine");
+}
+
+TEST(wrongResolution) {
+    H3CompactSet* set = H3_EXPORT(createH3CompactSet)(9);
+    H3Index parent = H3_EXPORT(h3ToParent)(sunnyvale, 8);
+    t_assert(H3_EXPORT(h3CompactSetAdd)(set, parent) == -1,
+             "coarser hexagon not added");
+    t_assert(H3_EXPORT(h3CompactSetRemove)(set, parent) == -1,
+             "coarser hexagon not removed");
+    t_assert(H3_EXPORT(h3CompactSetAdd)(set, 0) == -1, "0 not added");
+    t_assert(H3_EXPORT(h3CompactSetSize)(set) == 0, "set is empty");
+    t_assert(!H3_EXPORT(h3CompactSetContains)(set, 0), "0 not contained");
+    H3_EXPORT(destroyH3CompactSet)(set);
+}
+
+TEST(mergeAndSplit) {
+    H3Index parent = H3_EXPORT(h3ToParent)(sunnyvale, 7);
+    H3Index children[49];
+    H3_EXPORT(h3ToChildren)(parent, 9, children);
+    H3CompactSet* set = H3_EXPORT(createH3CompactSet)(9);
+    for (int i = 0; i < 49; i++) {
+        t_assert(H3_EXPORT(h3CompactSetAdd)(set, children[i]) == 1, "added");
+    }
+    t_assert(H3_EXPORT(h3CompactSetSize)(set) == 1, "merged to one hexagon");
+    H3Index out[49];
+    H3_EXPORT(h3CompactSetToArray)(set, out);
+    t_assert(out[0] == parent, "merged to the parent");
+    t_assert(H3_EXPORT(h3CompactSetContains)(set, parent), "contains parent");
+    H3Index finer[7];
+    H3_EXPORT(h3ToChildren)(sunnyvale, 10, finer);
+    t_assert(H3_EXPORT(h3CompactSetContains)(set, finer[3]),
+             "contains finer descendants");
+    t_assert(!H3_EXPORT(h3CompactSetContains)(
+                 set, H3_EXPORT(h3ToParent)(parent, 6)),
+             "does not contain a partly covered hexagon");
+    t_assert(H3_EXPORT(h3CompactSetAdd)(set, sunnyvale) == 0,
+             "not added again");
+
+    t_assert(H3_EXPORT(h3CompactSetRemove)(set, sunnyvale) == 1, "removed");
+    t_assert(H3_EXPORT(h3CompactSetSize)(set) == 12,
+             "split into 6 + 6 siblings");
+    t_assert(!H3_EXPORT(h3CompactSetContains)(set, sunnyvale),
+             "does not contain removed");
+    t_assert(H3_EXPORT(h3CompactSetRemove)(set, sunnyvale) == 0,
+             "not removed again");
+    t_assert(H3_EXPORT(h3CompactSetAdd)(set, sunnyvale) == 1, "added back");
+    t_assert(H3_EXPORT(h3CompactSetSize)(set) == 1, "merged again");
+    H3_EXPORT(destroyH3CompactSet)(set);
+}
+
+TEST(randomUpdates) {
+    // The descendants of a hexagon, so that whole groups fill up
+    H3Index hexes[343];
+    H3_EXPORT(h3ToChildren)(H3_EXPORT(h3ToParent)(sunnyvale, 6), 9, hexes);
+    randomUpdates(9, hexes, 343, 2000);
+}
+
+TEST(randomUpdatesPentagon) {
+    // The descendants of a pentagon, without the deleted ones
+    H3Index pentagon;
+    setH3Index(&pentagon, 0, 4, CENTER_DIGIT);
+    H3Index children[343] = {0};
+    H3_EXPORT(h3ToChildren)(pentagon, 3, children);
+    int numHexes = 0;
+    for (int i = 0; i < 343; i++) {
+        if (children[i] != 0) children[numHexes++] = children[i];
+    }
+    t_assert(numHexes == 1 + 5 * (1 + 7 + 49), "pentagon descendants");
+    randomUpdates(3, children, numHexes, 2000);
+}
+
+END_TESTS();
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Distance.c
+ * @brief Tests the grid distance between indexes
+ *
+ * usage: `testH3Distance`
+ */
+
+#include <stdlib.h>
+#include "constants.h"
+#include "h3Index.h"
+#include "test.h"
+
+/**
+ * Checks that the distance to every index near the origin is its k-ring
+ * distance, wherever the distance can be computed.
+ */
+static void assertMatchesKRing(H3Index origin, int k) {
+    int numHexes = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    int* distances = calloc(numHexes, sizeof(int));
+    H3_EXPORT(kRingDistances)(origin, k, ring, distances);
+    for (int i = 0; i < numHexes; i++) {
+        if (ring[i] == 0) continue;
+        int distance = H3_EXPORT(h3Distance)(origin, ring[i]);
+        t_assert(distance < 0 || distance == distances[i],
+                 "distance matches kRingDistances");
+    }
+    free(distances);
+    free(ring);
+}
+
+BEGIN_TESTS(h3Distance);
+
+H3Index sf = 0x8928308280fffffL;
+
+TEST(self) {
+    t_assert(H3_EXPORT(h3Distance)(sf, sf) == 0, "distance to self is 0");
+}
+
+TEST(kRing) {
+    int numHexes = H3_EXPORT(maxKringSize)(10);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    int* distances = calloc(numHexes, sizeof(int));
+    H3_EXPORT(kRingDistances)(sf, 10, ring, distances);
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3Distance)(sf, ring[i]) == distances[i],
+                 "distance matches kRingDistances away from pentagons");
+    }
+    free(distances);
+    free(ring);
+}
+
+TEST(allBaseCells) {
+    for (int res = 0; res < 3; res++) {
+        for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+            H3Index origin;
+            setH3Index(&origin, res, baseCell, 0);
+            assertMatchesKRing(origin, 3);
+            if (res > 0) {
+                setH3Index(&origin, res, baseCell, 6);
+                assertMatchesKRing(origin, 3);
+            }
+        }
+    }
+}
+
+TEST(failures) {
+    H3Index coarser = H3_EXPORT(h3ToParent)(sf, 7);
+    t_assert(H3_EXPORT(h3Distance)(sf, coarser) < 0,
+             "fails for a different resolution");
+
+    H3Index antipode;
+    setH3Index(&antipode, 9, 117, 0);
+    t_assert(H3_EXPORT(h3Distance)(sf, antipode) < 0,
+             "fails for base cells that are not neighbors");
+}
+
+END_TESTS();
@@ -22,11 +22,31 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "baseCells.h"
 #include "constants.h"
+#include "faceijk.h"
+#include "faceIjkAp7.h"
 #include "h3Index.h"
 #include "test.h"
 #include "utility.h"
 
+/**
+ * Checks that a cell on the home face of its base cell, as decoded, needs no
+ * overage adjustment.
+ */
+static void assertNoOverage(H3Index h) {
+    int baseCell = H3_GET_BASE_CELL(h);
+    int res = H3_GET_RESOLUTION(h);
+    FaceIJK fijk = baseCellData[baseCell].homeFijk;
+    _h3ToFaceIjkWithInitializedFijk(h, &fijk);
+    if (isResClassIII(res)) {
+        _downAp7r(&fijk.coord);
+        res++;
+    }
+    t_assert(_adjustOverageClassII(&fijk, res, 0, 0) == 0,
+             "marked cell needs no overage adjustment");
+}
+
 BEGIN_TESTS(h3Index);
 
 TEST(geoToH3ExtremeCoordinates) {
@@ -65,6 +85,53 @@ TEST(faceIjkToH3ExtremeCoordinates) {
     t_assert(_faceIjkToH3(&fijk2K, 2) == 0, "k out of bounds at res 2");
 }
 
+TEST(faceIjkToH3MatchesAp7) {
+    // exhaustive over a window of coordinates on every face, including ones
+    // that overflow onto neighboring faces
+    for (int res = 0; res <= 4; res++) {
+        for (int face = 0; face < NUM_ICOSA_FACES; face++) {
+            for (int i = 0; i < 60; i++) {
+                for (int j = 0; j < 60; j++) {
+                    FaceIJK fijk = {face, {i, j, 0}};
+                    _ijkNormalize(&fijk.coord);
+                    t_assert(_faceIjkToH3(&fijk, res) ==
+                                 _faceIjkToH3Ap7(&fijk, res),
+                             "digit generation matches reference");
+                }
+            }
+        }
+    }
+}
+
+TEST(upAp7Digit) {
+    for (int i = -50; i <= 50; i++) {
+        for (int j = -50; j <= 50; j++) {
+            CoordIJK ijk = {i, j, 0};
+            _ijkNormalize(&ijk);
+
+            CoordIJK parent = ijk;
+            int digit = _upAp7Digit(&parent);
+            CoordIJK expected = ijk;
+            _upAp7(&expected);
+            t_assert(_ijkMatches(&parent, &expected), "ccw parent matches");
+            CoordIJK child = parent;
+            _downAp7(&child);
+            _neighbor(&child, digit);
+            t_assert(_ijkMatches(&child, &ijk), "ccw digit is correct");
+
+            parent = ijk;
+            digit = _upAp7rDigit(&parent);
+            expected = ijk;
+            _upAp7r(&expected);
+            t_assert(_ijkMatches(&parent, &expected), "cw parent matches");
+            child = parent;
+            _downAp7r(&child);
+            _neighbor(&child, digit);
+            t_assert(_ijkMatches(&child, &ijk), "cw digit is correct");
+        }
+    }
+}
+
 TEST(h3IsValidAtResolution) {
     for (int i = 0; i <= MAX_H3_RES; i++) {
         GeoCoord geoCoord = {0, 0};
@@ -123,6 +190,38 @@ TEST(h3BadDigitInvalid) {
     t_assert(!H3_EXPORT(h3IsValid)(h), "h3IsValid failed on too large digit");
 }
 
+TEST(h3IsValidDeletedSubsequence) {
+    // base cell 4 is a pentagon, where digit 1 is deleted
+    H3Index h;
+    setH3Index(&h, 3, 4, CENTER_DIGIT);
+    t_assert(H3_EXPORT(h3IsValid)(h), "pentagon center child is valid");
+    H3_SET_INDEX_DIGIT(h, 2, K_AXES_DIGIT);
+    t_assert(!H3_EXPORT(h3IsValid)(h),
+             "leading digit 1 of a pentagon is invalid");
+    H3_SET_INDEX_DIGIT(h, 1, J_AXES_DIGIT);
+    t_assert(H3_EXPORT(h3IsValid)(h),
+             "digit 1 after another leading digit is valid");
+
+    setH3Index(&h, 3, 5, CENTER_DIGIT);
+    H3_SET_INDEX_DIGIT(h, 2, K_AXES_DIGIT);
+    t_assert(H3_EXPORT(h3IsValid)(h), "leading digit 1 of a hexagon is valid");
+}
+
+TEST(h3IsValidBatch) {
+    H3Index h3[] = {0x8928308280fffff, 0x8928308280fffff ^ 1, 0,
+                    0x821c07fffffffff, 0x8009fffffffffff, 0x80f3fffffffffff,
+                    0x8f28308280f18f2, 0x8f28308280f18f7};
+    int n = sizeof(h3) / sizeof(h3[0]);
+    uint8_t out[8];
+    H3_EXPORT(h3IsValidBatch)(h3, n, out);
+    for (int i = 0; i < n; i++) {
+        t_assert(out[i] == H3_EXPORT(h3IsValid)(h3[i]),
+                 "batch matches h3IsValid");
+    }
+    t_assert(out[0] && !out[1] && !out[2] && out[3],
+             "batch validated indexes");
+}
+
 TEST(h3ToString) {
     const size_t bufSz = 17;
     char buf[17] = {0};
@@ -143,6 +242,56 @@ TEST(stringToH3) {
     t_assert(H3_EXPORT(stringToH3)("**") == 0, "got an index from junk");
     t_assert(H3_EXPORT(stringToH3)("ffffffffffffffff") == 0xffffffffffffffff,
              "failed on large input");
+    t_assert(H3_EXPORT(stringToH3)("  0x8928308280FFFFF") == 0x8928308280fffff,
+             "skipped white space and prefix, and read upper case");
+    t_assert(H3_EXPORT(stringToH3)("8928308280fffff,12") == 0x8928308280fffff,
+             "stopped at the first non digit");
+    t_assert(H3_EXPORT(stringToH3)("000000008928308280fffff") ==
+                 0x8928308280fffff,
+             "leading zeros are not significant");
+    t_assert(H3_EXPORT(stringToH3)("10000000000000000") == 0,
+             "rejected more than 16 significant digits");
+}
+
+TEST(stringToH3Batch) {
+    const char strs[][16] = {"8928308280fffff", "8928308280bffff", "**",
+                             "  8928308280fff", "ffffffffffffffff"};
+    H3Index out[5];
+    int numInvalid = H3_EXPORT(stringToH3Batch)(&strs[0][0], 16, 5, 0, out);
+    t_assert(numInvalid == 1, "only junk is invalid without strict");
+    t_assert(out[0] == 0x8928308280fffff, "parsed first string");
+    t_assert(out[1] == 0x8928308280bffff, "parsed second string");
+    t_assert(out[2] == 0, "junk gives 0");
+    t_assert(out[3] == 0x8928308280fff, "skipped white space");
+    t_assert(out[4] == 0xffffffffffffffff,
+             "read a string filling the stride");
+
+    numInvalid = H3_EXPORT(stringToH3Batch)(&strs[0][0], 16, 5, 1, out);
+    t_assert(numInvalid == 3, "strict rejects all but valid cells");
+    t_assert(out[0] == 0x8928308280fffff && out[1] == 0x8928308280bffff,
+             "strict accepts valid cells");
+    t_assert(out[2] == 0 && out[3] == 0 && out[4] == 0,
+             "strict rejects junk, white space and invalid indexes");
+
+    const char trailing[] = "8928308280fffff ";
+    H3_EXPORT(stringToH3Batch)(trailing, sizeof(trailing), 1, 1, out);
+    t_assert(out[0] == 0, "strict rejects trailing characters");
+}
+
+TEST(h3ToStringBatch) {
+    H3Index h3[] = {0x8928308280fffff, 0, 0xcafe};
+    char strs[3][20];
+    memset(strs, 'x', sizeof(strs));
+    H3_EXPORT(h3ToStringBatch)(h3, 3, &strs[0][0], 16);
+    t_assert(strs[0][0] == 'x', "nothing written for a small stride");
+    H3_EXPORT(h3ToStringBatch)(h3, 3, &strs[0][0], 20);
+    t_assert(strcmp(strs[0], "8928308280fffff") == 0, "formatted index");
+    t_assert(strcmp(strs[1], "0") == 0, "formatted zero");
+    t_assert(strcmp(strs[2], "cafe") == 0, "formatted small value");
+
+    H3Index out[3];
+    H3_EXPORT(stringToH3Batch)(&strs[0][0], 20, 3, 0, out);
+    t_assert(memcmp(out, h3, sizeof(h3)) == 0, "round trip");
 }
 
 TEST(setH3Index) {
@@ -169,4 +318,45 @@ TEST(h3IsResClassIII) {
     }
 }
 
+TEST(baseCellNoOverage) {
+    int numMarkedPentagon = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        for (int d1 = 0; d1 < 7; d1++) {
+            for (int d2 = 0; d2 < 7; d2++) {
+                if (!((baseCellNoOverage[baseCell] >> (d1 * 8 + d2)) & 1))
+                    continue;
+                if (_isBaseCellPentagon(baseCell)) numMarkedPentagon++;
+
+                H3Index h;
+                setH3Index(&h, 5, baseCell, CENTER_DIGIT);
+                H3_SET_INDEX_DIGIT(h, 1, d1);
+                H3_SET_INDEX_DIGIT(h, 2, d2);
+                // every descendant to resolution 5
+                for (int d = 0; d < 343; d++) {
+                    H3_SET_INDEX_DIGIT(h, 3, d / 49);
+                    H3_SET_INDEX_DIGIT(h, 4, d / 7 % 7);
+                    H3_SET_INDEX_DIGIT(h, 5, d % 7);
+                    assertNoOverage(h);
+                    assertNoOverage(H3_EXPORT(h3ToParent)(h, 4));
+                    assertNoOverage(H3_EXPORT(h3ToParent)(h, 3));
+                }
+                // and descendants at resolution 15 running along the edges
+                // of the cell
+                H3_SET_RESOLUTION(h, MAX_H3_RES);
+                for (int d = 1; d < 7; d++) {
+                    for (int r = 3; r <= MAX_H3_RES; r++) {
+                        H3_SET_INDEX_DIGIT(h, r, d);
+                    }
+                    assertNoOverage(h);
+                    for (int r = 4; r <= MAX_H3_RES; r++) {
+                        H3_SET_INDEX_DIGIT(h, r, (d % 6) + 1);
+                    }
+                    assertNoOverage(h);
+                }
+            }
+        }
+    }
+    t_assert(numMarkedPentagon > 0, "cells of pentagons are marked");
+}
+
 END_TESTS();
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3IndexSet.c
+ * @brief Tests the hash set of indexes.
+ *
+ *  usage: `testH3IndexSet`
+ */
+
+#include <stdlib.h>
+#include "constants.h"
+#include "coordijk.h"
+#include "h3Index.h"
+#include "h3IndexSet.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+BEGIN_TESTS(h3IndexSet);
+
+TEST(addAndContains) {
+    int numHexes = H3_EXPORT(maxKringSize)(10);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 10, disk);
+
+    // Start small so the set grows many times
+    H3IndexSet* set = H3_EXPORT(createH3IndexSet)(0);
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3IndexSetAdd)(set, disk[i]) == 1, "added");
+        t_assert(H3_EXPORT(h3IndexSetAdd)(set, disk[i]) == 0,
+                 "added only once");
+    }
+    t_assert(H3_EXPORT(h3IndexSetSize)(set) == numHexes, "size matches");
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3IndexSetContains)(set, disk[i]), "contains");
+    }
+    t_assert(!H3_EXPORT(h3IndexSetContains)(
+                 set, H3_EXPORT(h3ToParent)(sunnyvale, 8)),
+             "does not contain a parent");
+    t_assert(H3_EXPORT(h3IndexSetAdd)(set, 0) == 0, "0 is not added");
+    t_assert(!H3_EXPORT(h3IndexSetContains)(set, 0), "0 is not contained");
+
+    H3Index* out = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(h3IndexSetToArray)(set, out) == numHexes,
+             "wrote every index");
+    H3IndexSet* copy = H3_EXPORT(createH3IndexSet)(numHexes);
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3IndexSetContains)(set, out[i]),
+                 "wrote indexes in the set");
+        t_assert(H3_EXPORT(h3IndexSetAdd)(copy, out[i]) == 1,
+                 "wrote each index once");
+    }
+
+    H3_EXPORT(destroyH3IndexSet)(copy);
+    H3_EXPORT(destroyH3IndexSet)(set);
+    free(out);
+    free(disk);
+}
+
+TEST(remove) {
+    int numHexes = H3_EXPORT(maxKringSize)(10);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 10, disk);
+    // A small set, so that probe sequences are long and wrap around
+    H3IndexSet* set = H3_EXPORT(createH3IndexSet)(numHexes / 2);
+    for (int i = 0; i < numHexes; i++) {
+        H3_EXPORT(h3IndexSetAdd)(set, disk[i]);
+    }
+
+    // Remove every third index, then the rest
+    for (int start = 0; start < 3; start++) {
+        for (int i = start; i < numHexes; i += 3) {
+            t_assert(H3_EXPORT(h3IndexSetRemove)(set, disk[i]) == 1,
+                     "removed");
+            t_assert(H3_EXPORT(h3IndexSetRemove)(set, disk[i]) == 0,
+                     "removed only once");
+        }
+        for (int i = 0; i < numHexes; i++) {
+            t_assert(H3_EXPORT(h3IndexSetContains)(set, disk[i]) ==
+                         (i % 3 > start),
+                     "contains exactly the indexes not removed");
+        }
+    }
+    t_assert(H3_EXPORT(h3IndexSetSize)(set) == 0, "set is empty");
+    t_assert(H3_EXPORT(h3IndexSetRemove)(set, 0) == 0, "0 is not removed");
+    t_assert(H3_EXPORT(h3IndexSetAdd)(set, sunnyvale) == 1,
+             "added after removing");
+
+    H3_EXPORT(destroyH3IndexSet)(set);
+    free(disk);
+}
+
+TEST(coarseIndexes) {
+    // Every resolution 0 and 1 index, whose low bits are all 1's
+    H3IndexSet* set = H3_EXPORT(createH3IndexSet)(16);
+    int numAdded = 0;
+    for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+        H3Index h;
+        setH3Index(&h, 0, bc, CENTER_DIGIT);
+        numAdded += H3_EXPORT(h3IndexSetAdd)(set, h);
+        for (int d = 0; d < 7; d++) {
+            setH3Index(&h, 1, bc, d);
+            numAdded += H3_EXPORT(h3IndexSetAdd)(set, h);
+        }
+    }
+    t_assert(numAdded == NUM_BASE_CELLS * 8, "added every index");
+    t_assert(H3_EXPORT(h3IndexSetSize)(set) == numAdded, "size matches");
+    H3_EXPORT(destroyH3IndexSet)(set);
+}
+
+TEST(addConcurrentWhenFull) {
+    int numHexes = H3_EXPORT(maxKringSize)(2);
+    H3IndexSet* set = H3_EXPORT(createH3IndexSet)(numHexes);
+    H3Index disk[19];
+    H3_EXPORT(kRing)(sunnyvale, 2, disk);
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3IndexSetAddConcurrent)(set, disk[i]) == 1,
+                 "added");
+        t_assert(H3_EXPORT(h3IndexSetAddConcurrent)(set, disk[i]) == 0,
+                 "added only once");
+    }
+
+    // The smallest set has 16 slots, and never grows when added to
+    // concurrently
+    H3IndexSet* small = H3_EXPORT(createH3IndexSet)(0);
+    int numAdded = 0;
+    for (int i = 0; i < numHexes; i++) {
+        int added = H3_EXPORT(h3IndexSetAddConcurrent)(small, disk[i]);
+        if (added == 1) {
+            numAdded++;
+        } else {
+            t_assert(added == -1, "full set is reported");
+        }
+    }
+    t_assert(numAdded == 16, "filled every slot");
+    t_assert(H3_EXPORT(h3IndexSetSize)(small) == 16, "size matches");
+    H3_EXPORT(destroyH3IndexSet)(small);
+    H3_EXPORT(destroyH3IndexSet)(set);
+}
+
+END_TESTS();
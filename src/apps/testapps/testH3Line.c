@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Line.c
+ * @brief Tests lines of indexes between two indexes
+ *
+ * usage: `testH3Line`
+ */
+
+#include <stdlib.h>
+#include "constants.h"
+#include "h3Index.h"
+#include "test.h"
+
+/**
+ * Checks the line between two indexes, if it can be computed: it must have
+ * the expected size, run from start to end, and step between neighbors.
+ */
+static void assertLine(H3Index start, H3Index end) {
+    int size = H3_EXPORT(h3LineSize)(start, end);
+    if (size < 0) {
+        t_assert(H3_EXPORT(h3Line)(start, end, NULL) != 0,
+                 "line fails when its size fails");
+        return;
+    }
+    t_assert(size == H3_EXPORT(h3Distance)(start, end) + 1,
+             "line size is the distance plus one");
+    H3Index* line = calloc(size, sizeof(H3Index));
+    if (H3_EXPORT(h3Line)(start, end, line) == 0) {
+        t_assert(line[0] == start, "line starts at start");
+        t_assert(line[size - 1] == end, "line ends at end");
+        for (int i = 1; i < size; i++) {
+            t_assert(H3_EXPORT(h3IndexesAreNeighbors)(line[i - 1], line[i]),
+                     "line steps between neighbors");
+        }
+    }
+    free(line);
+}
+
+BEGIN_TESTS(h3Line);
+
+H3Index sf = 0x8928308280fffffL;
+
+TEST(self) {
+    H3Index line[1] = {0};
+    t_assert(H3_EXPORT(h3LineSize)(sf, sf) == 1, "line to self has size 1");
+    t_assert(H3_EXPORT(h3Line)(sf, sf, line) == 0, "line to self succeeds");
+    t_assert(line[0] == sf, "line to self is the index");
+}
+
+TEST(kRing) {
+    int numHexes = H3_EXPORT(maxKringSize)(8);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sf, 8, ring);
+    for (int i = 0; i < numHexes; i++) {
+        assertLine(sf, ring[i]);
+    }
+    free(ring);
+}
+
+TEST(aroundPentagons) {
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index origin;
+        setH3Index(&origin, 2, baseCell, 0);
+        H3Index ring[19] = {0};
+        H3_EXPORT(kRing)(origin, 2, ring);
+        for (int i = 0; i < 19; i++) {
+            if (ring[i] != 0) {
+                assertLine(origin, ring[i]);
+            }
+        }
+    }
+}
+
+TEST(failures) {
+    H3Index antipode;
+    setH3Index(&antipode, 9, 117, 0);
+    t_assert(H3_EXPORT(h3LineSize)(sf, antipode) < 0,
+             "line size fails for distant indexes");
+    t_assert(H3_EXPORT(h3Line)(sf, antipode, NULL) != 0,
+             "line fails for distant indexes");
+}
+
+END_TESTS();
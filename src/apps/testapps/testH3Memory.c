@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests that the library allocates through the H3_ALLOC_PREFIX hooks
+ *
+ *  usage: `testH3Memory`
+ */
+
+#include <stdlib.h>
+#include "h3Alloc.h"
+#include "h3api.h"
+#include "test.h"
+
+static int numAllocations = 0;
+static int numLive = 0;
+
+void* H3_ALLOC_FUNC(malloc)(size_t size) {
+    numAllocations++;
+    numLive++;
+    return malloc(size);
+}
+
+void* H3_ALLOC_FUNC(calloc)(size_t num, size_t size) {
+    numAllocations++;
+    numLive++;
+    return calloc(num, size);
+}
+
+void* H3_ALLOC_FUNC(realloc)(void* ptr, size_t size) {
+    numAllocations++;
+    if (ptr == NULL) numLive++;
+    return realloc(ptr, size);
+}
+
+void H3_ALLOC_FUNC(free)(void* ptr) {
+    if (ptr != NULL) numLive--;
+    free(ptr);
+}
+
+// Fixtures
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoPolygon sfGeoPolygon = {{6, sfVerts}, 0, NULL};
+
+BEGIN_TESTS(h3Memory);
+
+TEST(polyfill) {
+    numAllocations = 0;
+    int numHexagons = H3_EXPORT(polyfillDense)(&sfGeoPolygon, 9, NULL, 0);
+    t_assert(numHexagons == 1253, "got expected polyfill size");
+    t_assert(numAllocations > 0, "polyfill allocated through the hooks");
+    t_assert(numLive == 0, "polyfill freed through the hooks");
+
+    numAllocations = 0;
+    PolyfillIterator* iter = H3_EXPORT(polyfillIterInit)(&sfGeoPolygon, 9);
+    H3_EXPORT(polyfillIterDestroy)(iter);
+    t_assert(numAllocations > 0, "iterator allocated through the hooks");
+    t_assert(numLive == 0, "iterator freed through the hooks");
+}
+
+TEST(h3SetToLinkedGeo) {
+    H3Index set[] = {0x8928308280fffff, 0x8928308280bffff};
+    LinkedGeoPolygon polygon;
+
+    numAllocations = 0;
+    H3_EXPORT(h3SetToLinkedGeo)(set, 2, &polygon);
+    t_assert(numAllocations > 0, "outline allocated through the hooks");
+    t_assert(numLive > 0, "outline is live");
+    H3_EXPORT(destroyLinkedPolygon)(&polygon);
+    t_assert(numLive == 0, "outline freed through the hooks");
+}
+
+TEST(h3SetToFlatGeo) {
+    H3Index set[] = {0x8928308280fffff, 0x8928308280bffff};
+    FlatGeoMultiPolygon polygons;
+
+    H3_EXPORT(h3SetToFlatGeo)(set, 2, &polygons);
+    t_assert(numLive == 1, "flat outline held in a single allocation");
+    H3_EXPORT(destroyFlatGeo)(&polygons);
+    t_assert(numLive == 0, "flat outline freed through the hooks");
+}
+
+TEST(scratch) {
+    H3Scratch scratch = {0};
+    H3Index out[19];
+
+    numAllocations = 0;
+    H3_EXPORT(kRingWithScratch)(0x8928308280fffff, 2, out, &scratch);
+    H3_EXPORT(kRingWithScratch)(0x8928308280fffff, 2, out, &scratch);
+    t_assert(numAllocations == 1, "scratch allocated once through the hooks");
+    H3_EXPORT(destroyH3Scratch)(&scratch);
+    t_assert(numLive == 0, "scratch freed through the hooks");
+}
+
+END_TESTS();
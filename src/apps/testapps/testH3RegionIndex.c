@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3RegionIndex.c
+ * @brief Tests the flat index of regions against polyfillMany.
+ *
+ *  usage: `testH3RegionIndex`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "h3Index.h"
+#include "h3RegionIndex.h"
+#include "test.h"
+
+#define RES 9
+
+// Fixtures
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoCoord holeVerts[] = {{0.6595072188743, -2.1371053983433},
+                        {0.6591482046471, -2.1373141048153},
+                        {0.6592295020837, -2.1365222838402}};
+
+BEGIN_TESTS(h3RegionIndex);
+
+Geofence sfGeofence = {6, sfVerts};
+Geofence holeGeofence = {3, holeVerts};
+GeoPolygon sfWithHole = {sfGeofence, 1, &holeGeofence};
+GeoPolygon hole = {holeGeofence, 0, NULL};
+GeoPolygon polygons[] = {sfWithHole, hole};
+int regionIds[] = {10, 20};
+
+TEST(matchesPolyfillMany) {
+    size_t size;
+    void* index =
+        H3_EXPORT(createH3RegionIndex)(polygons, regionIds, 2, RES, &size);
+    t_assert(index != NULL, "created index");
+    t_assert(H3_EXPORT(h3RegionIndexIsValid)(index, size), "index is valid");
+
+    int numCells = H3_EXPORT(polyfillMany)(polygons, 2, RES, NULL, 0);
+    PolyfillCell* cells = malloc(numCells * sizeof(PolyfillCell));
+    H3_EXPORT(polyfillMany)(polygons, 2, RES, cells, numCells);
+    const H3RegionIndexHeader* header = index;
+    t_assert(header->numRanges < (uint64_t)numCells / 2,
+             "hexagons are compacted");
+
+    // Query a copy at another address, as a mapped file would be
+    void* copy = malloc(size);
+    memcpy(copy, index, size);
+    for (int i = 0; i < numCells; i++) {
+        int expected = regionIds[cells[i].polygon];
+        int regionId = -1;
+        t_assert(H3_EXPORT(h3RegionIndexLookupCell)(copy, cells[i].h3,
+                                                    &regionId) == 1,
+                 "hexagon found");
+        t_assert(regionId == expected, "hexagon has its region");
+
+        GeoCoord center;
+        H3_EXPORT(h3ToGeo)(cells[i].h3, &center);
+        regionId = -1;
+        t_assert(H3_EXPORT(h3RegionIndexLookup)(copy, &center, &regionId) ==
+                     1,
+                 "point found");
+        t_assert(regionId == expected, "point has its region");
+
+        GeoCoord offCenter = {center.lat + 1e-6, center.lon};
+        H3Index child = H3_EXPORT(geoToH3)(&offCenter, RES + 2);
+        if (H3_EXPORT(h3ToParent)(child, RES) == cells[i].h3) {
+            t_assert(H3_EXPORT(h3RegionIndexLookupCell)(copy, child,
+                                                        &regionId) == 1 &&
+                         regionId == expected,
+                     "finer hexagon has its region");
+        }
+    }
+
+    H3Index outside = H3_EXPORT(geoToH3)(&sfVerts[0], RES);
+    H3Index ring[6 * 3];
+    t_assert(H3_EXPORT(hexRing)(outside, 3, ring) == 0, "hexRing");
+    int numOutside = 0;
+    for (int i = 0; i < 6 * 3; i++) {
+        int covered = 0;
+        for (int j = 0; j < numCells; j++) {
+            if (cells[j].h3 == ring[i]) covered = 1;
+        }
+        int regionId;
+        int found = H3_EXPORT(h3RegionIndexLookupCell)(copy, ring[i],
+                                                       &regionId);
+        t_assert(found == covered, "only covered hexagons are found");
+        numOutside += !covered;
+    }
+    t_assert(numOutside > 0, "checked hexagons outside");
+
+    int regionId;
+    t_assert(!H3_EXPORT(h3RegionIndexLookupCell)(
+                 copy, H3_EXPORT(h3ToParent)(cells[0].h3, 4), &regionId),
+             "partly covered hexagon is not found");
+
+    free(copy);
+    free(cells);
+    H3_EXPORT(destroyH3RegionIndex)(index);
+}
+
+TEST(defaultRegionIds) {
+    size_t size;
+    void* index = H3_EXPORT(createH3RegionIndex)(polygons, NULL, 2, RES, &size);
+    GeoCoord inHole = {
+        (holeVerts[0].lat + holeVerts[1].lat + holeVerts[2].lat) / 3,
+        (holeVerts[0].lon + holeVerts[1].lon + holeVerts[2].lon) / 3};
+    int regionId = -1;
+    t_assert(H3_EXPORT(h3RegionIndexLookup)(index, &inHole, &regionId) &&
+                 regionId == 1,
+             "hole is the second polygon");
+    H3_EXPORT(destroyH3RegionIndex)(index);
+}
+
+TEST(invalidIndex) {
+    size_t size;
+    t_assert(H3_EXPORT(createH3RegionIndex)(polygons, NULL, 2, 16, &size) ==
+                 NULL,
+             "invalid resolution fails");
+
+    void* empty = H3_EXPORT(createH3RegionIndex)(polygons, NULL, 0, RES, &size);
+    t_assert(H3_EXPORT(h3RegionIndexIsValid)(empty, size), "empty is valid");
+    int regionId;
+    t_assert(!H3_EXPORT(h3RegionIndexLookup)(empty, &sfVerts[0], &regionId),
+             "empty index contains nothing");
+    H3_EXPORT(destroyH3RegionIndex)(empty);
+
+    void* index = H3_EXPORT(createH3RegionIndex)(polygons, NULL, 2, RES, &size);
+    t_assert(!H3_EXPORT(h3RegionIndexIsValid)(index, size - 1),
+             "truncated index is invalid");
+    t_assert(!H3_EXPORT(h3RegionIndexIsValid)(index, 16),
+             "truncated header is invalid");
+    H3RegionIndexHeader* header = index;
+    header->byteOrder = 0x04030201;
+    t_assert(!H3_EXPORT(h3RegionIndexIsValid)(index, size),
+             "other byte order is invalid");
+    header->byteOrder = H3_REGION_INDEX_BYTE_ORDER;
+    header->magic[0] = 'X';
+    t_assert(!H3_EXPORT(h3RegionIndexIsValid)(index, size),
+             "wrong magic is invalid");
+    H3_EXPORT(destroyH3RegionIndex)(index);
+}
+
+END_TESTS();
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3SetBinary.c
+ * @brief Tests the binary encoding of sets of hexagons.
+ *
+ *  usage: `testH3SetBinary`
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "h3Index.h"
+#include "h3SetBinary.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+/**
+ * Sorts indexes in ascending order.
+ */
+static int compareH3Index(const void* a, const void* b) {
+    H3Index x = *(const H3Index*)a;
+    H3Index y = *(const H3Index*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Encodes and decodes a set, checking that the decoded set holds the
+ * distinct hexagons of the input in ascending order, and returns the number
+ * of encoded bytes.
+ */
+static size_t assertRoundTrip(const H3Index* h3Set, int numHexes) {
+    uint8_t* encoded = malloc(H3_EXPORT(maxH3SetToBinarySize)(numHexes));
+    size_t size;
+    t_assert(H3_EXPORT(h3SetToBinary)(h3Set, numHexes, encoded, &size) == 0,
+             "encode succeeds");
+    t_assert(size <= H3_EXPORT(maxH3SetToBinarySize)(numHexes),
+             "fits in the maximum size");
+
+    H3Index* expected = calloc(numHexes + 1, sizeof(H3Index));
+    int numExpected = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i]) expected[numExpected++] = h3Set[i];
+    }
+    qsort(expected, numExpected, sizeof(H3Index), compareH3Index);
+    int numDistinct = 0;
+    for (int i = 0; i < numExpected; i++) {
+        if (i == 0 || expected[i] != expected[i - 1]) {
+            expected[numDistinct++] = expected[i];
+        }
+    }
+
+    t_assert(H3_EXPORT(binaryToH3SetSize)(encoded, size) == numDistinct,
+             "decoded size is the number of distinct hexagons");
+    H3Index* decoded = calloc(numDistinct + 1, sizeof(H3Index));
+    t_assert(H3_EXPORT(binaryToH3Set)(encoded, size, decoded, numDistinct) ==
+                 numDistinct,
+             "decode succeeds");
+    t_assert(memcmp(decoded, expected, numDistinct * sizeof(H3Index)) == 0,
+             "decoded hexagons match");
+    if (numDistinct > 0) {
+        t_assert(H3_EXPORT(binaryToH3Set)(encoded, size, decoded,
+                                          numDistinct - 1) == -2,
+                 "decode fails into a smaller array");
+    }
+
+    free(decoded);
+    free(expected);
+    free(encoded);
+    return size;
+}
+
+BEGIN_TESTS(h3SetBinary);
+
+TEST(varint) {
+    uint64_t values[] = {0, 1, 127, 128, 300, UINT64_C(1) << 52, UINT64_MAX};
+    for (int i = 0; i < 7; i++) {
+        uint8_t bytes[10];
+        size_t size = _writeVarint(values[i], bytes);
+        uint64_t value;
+        t_assert(_readVarint(bytes, size, &value) == size, "reads every byte");
+        t_assert(value == values[i], "value round trips");
+        t_assert(_readVarint(bytes, size - 1, &value) == 0,
+                 "truncated varint fails");
+    }
+}
+
+TEST(disk) {
+    int numHexes = H3_EXPORT(maxKringSize)(20);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 20, disk);
+    size_t size = assertRoundTrip(disk, numHexes);
+    t_assert(size < 2 * (size_t)numHexes,
+             "contiguous hexagons take under 2 bytes each");
+
+    H3Index* compacted = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(compact)(disk, compacted, numHexes) == 0, "compact");
+    assertRoundTrip(compacted, numHexes);
+    free(compacted);
+    free(disk);
+}
+
+TEST(mixedInput) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 0, 4, 0);
+    H3Index last;
+    setH3Index(&last, 15, 121, 6);
+    H3Index input[] = {sunnyvale, 0, pentagon, sunnyvale, last, 0,
+                       H3_EXPORT(h3ToParent)(sunnyvale, 3)};
+    assertRoundTrip(input, 7);
+    assertRoundTrip(input, 0);
+    assertRoundTrip(&last, 1);
+}
+
+TEST(invalidInput) {
+    uint8_t encoded[64];
+    size_t size;
+    H3Index invalid = sunnyvale;
+    H3_SET_MODE(invalid, H3_UNIEDGE_MODE);
+    t_assert(H3_EXPORT(h3SetToBinary)(&invalid, 1, encoded, &size) == -1,
+             "edge does not encode");
+
+    H3Index input[] = {sunnyvale, H3_EXPORT(h3ToParent)(sunnyvale, 5)};
+    t_assert(H3_EXPORT(h3SetToBinary)(input, 2, encoded, &size) == 0,
+             "encode succeeds");
+    H3Index out[2];
+    t_assert(H3_EXPORT(binaryToH3Set)(encoded, size - 1, out, 2) == -1,
+             "truncated encoding fails");
+    t_assert(H3_EXPORT(binaryToH3Set)(encoded, 3, out, 2) == -1,
+             "truncated magic fails");
+
+    uint8_t trailing[65];
+    memcpy(trailing, encoded, size);
+    trailing[size] = 0;
+    t_assert(H3_EXPORT(binaryToH3Set)(trailing, size + 1, out, 2) == -1,
+             "trailing bytes fail");
+
+    uint8_t corrupted[64];
+    memcpy(corrupted, encoded, size);
+    corrupted[0] = 'X';
+    t_assert(H3_EXPORT(binaryToH3SetSize)(corrupted, size) == -1,
+             "wrong magic fails");
+
+    // a group of resolution 16
+    memcpy(corrupted, encoded, size);
+    corrupted[H3_SET_BINARY_MAGIC_SIZE + 1] = 16;
+    t_assert(H3_EXPORT(binaryToH3Set)(corrupted, size, out, 2) == -1,
+             "invalid resolution fails");
+
+    // one resolution 1 hexagon of base cell 0 with digit 7
+    uint8_t digit7[] = {'H', '3', 'S', 1, 1, 1, 1, 7};
+    t_assert(H3_EXPORT(binaryToH3Set)(digit7, sizeof(digit7), out, 2) == -1,
+             "invalid digit fails");
+    digit7[7] = 6;
+    t_assert(H3_EXPORT(binaryToH3Set)(digit7, sizeof(digit7), out, 2) == 1,
+             "valid digit decodes");
+
+    // two hexagons at the same position
+    uint8_t duplicate[] = {'H', '3', 'S', 1, 2, 1, 2, 6, 0};
+    t_assert(H3_EXPORT(binaryToH3Set)(duplicate, sizeof(duplicate), out, 2) ==
+                 -1,
+             "repeated position fails");
+}
+
+END_TESTS();
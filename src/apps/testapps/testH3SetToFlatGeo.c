@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include "algos.h"
+#include "test.h"
+
+/**
+ * Whether a flat output holds the same polygons, loops and coordinates as a
+ * linked output.
+ */
+static int flatMatchesLinked(const FlatGeoMultiPolygon* flat,
+                             LinkedGeoPolygon* linked) {
+    int p = 0;
+    int l = 0;
+    int c = 0;
+    for (LinkedGeoPolygon* polygon = linked;
+         polygon != NULL && polygon->first != NULL; polygon = polygon->next) {
+        if (p >= flat->numPolygons || flat->polygonOffsets[p] != l) {
+            return 0;
+        }
+        for (LinkedGeoLoop* loop = polygon->first; loop != NULL;
+             loop = loop->next) {
+            if (flat->loopOffsets[l] != c) {
+                return 0;
+            }
+            for (LinkedGeoCoord* coord = loop->first; coord != NULL;
+                 coord = coord->next) {
+                if (!geoAlmostEqual(&flat->coords[c], &coord->vertex)) {
+                    return 0;
+                }
+                c++;
+            }
+            l++;
+        }
+        p++;
+    }
+    return p == flat->numPolygons && l == flat->numLoops &&
+           c == flat->numCoords && flat->polygonOffsets[p] == l &&
+           flat->loopOffsets[l] == c;
+}
+
+BEGIN_TESTS(h3SetToFlatGeo);
+
+TEST(empty) {
+    FlatGeoMultiPolygon flat;
+    H3_EXPORT(h3SetToFlatGeo)(NULL, 0, &flat);
+    t_assert(flat.numPolygons == 0, "No polygons");
+    t_assert(flat.numLoops == 0, "No loops");
+    t_assert(flat.numCoords == 0, "No coords");
+    t_assert(flat.polygonOffsets[0] == 0, "Polygon offsets terminated");
+    t_assert(flat.loopOffsets[0] == 0, "Loop offsets terminated");
+    H3_EXPORT(destroyFlatGeo)(&flat);
+    t_assert(flat.coords == NULL, "Coords released");
+}
+
+TEST(singleHex) {
+    FlatGeoMultiPolygon flat;
+    H3Index set[] = {0x890dab6220bffff};
+    H3_EXPORT(h3SetToFlatGeo)(set, 1, &flat);
+    t_assert(flat.numPolygons == 1, "1 polygon");
+    t_assert(flat.numLoops == 1, "1 loop");
+    t_assert(flat.numCoords == 6, "6 coords");
+    t_assert(flat.polygonOffsets[1] == 1, "Polygon ends after its loop");
+    t_assert(flat.loopOffsets[1] == 6, "Loop ends after its coords");
+    H3_EXPORT(destroyFlatGeo)(&flat);
+}
+
+TEST(matchesLinked) {
+    // A ring with a hole and an island inside the hole, plus a separate
+    // hexagon
+    H3Index set[1 + 6 * 3 + 6 * 4 + 1];
+    H3Index center = 0x8928308288bffff;
+    set[0] = center;
+    t_assert(H3_EXPORT(hexRing)(center, 3, set + 1) == 0, "ring computed");
+    t_assert(H3_EXPORT(hexRing)(center, 4, set + 1 + 6 * 3) == 0,
+             "ring computed");
+    set[1 + 6 * 3 + 6 * 4] = 0x8928308291bffff;
+    int numHexes = sizeof(set) / sizeof(set[0]);
+
+    FlatGeoMultiPolygon flat;
+    LinkedGeoPolygon linked;
+    H3_EXPORT(h3SetToFlatGeo)(set, numHexes, &flat);
+    H3_EXPORT(h3SetToLinkedGeo)(set, numHexes, &linked);
+
+    t_assert(flat.numPolygons == 3, "3 polygons");
+    t_assert(flat.numLoops == 4, "3 outer loops and 1 hole");
+    t_assert(flatMatchesLinked(&flat, &linked), "Flat output matches linked");
+
+    H3_EXPORT(destroyFlatGeo)(&flat);
+    H3_EXPORT(destroyLinkedPolygon)(&linked);
+}
+
+END_TESTS();
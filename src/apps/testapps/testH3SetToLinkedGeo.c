@@ -75,9 +75,6 @@ TEST(contiguous2) {
     free(polygon);
 }
 
-// TODO: This test asserts incorrect behavior - we should be creating multiple
-// polygons, each with their own single loop. Update when the algorithm is
-// corrected.
 TEST(nonContiguous2) {
     LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
     char* hexes[] = {"8928308291bffff", "89283082943ffff"};
@@ -86,10 +83,13 @@ TEST(nonContiguous2) {
 
     H3_EXPORT(h3SetToLinkedGeo)(set, numHexes, polygon);
 
-    t_assert(countLinkedLoops(polygon) == 2, "2 loops added to polygon");
+    t_assert(countLinkedPolygons(polygon) == 2, "2 polygons added");
+    t_assert(countLinkedLoops(polygon) == 1, "1 loop on the first polygon");
     t_assert(countLinkedCoords(polygon->first) == 6,
              "All coords for one hex added to first loop");
-    t_assert(countLinkedCoords(polygon->first->next) == 6,
+    t_assert(countLinkedLoops(polygon->next) == 1,
+             "1 loop on the second polygon");
+    t_assert(countLinkedCoords(polygon->next->first) == 6,
              "All coords for one hex added to second loop");
 
     H3_EXPORT(destroyLinkedPolygon)(polygon);
@@ -216,4 +216,119 @@ TEST(contiguous2distorted) {
     free(polygon);
 }
 
+TEST(pentagonRingDistorted) {
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    // Class III pentagon and its neighbors, whose shared edges carry
+    // distortion vertices that do not match exactly between cells
+    char* hexes[] = {"830800fffffffff", "830802fffffffff", "830803fffffffff",
+                     "830804fffffffff", "830805fffffffff", "830806fffffffff"};
+    int numHexes = sizeof(hexes) / sizeof(hexes[0]);
+    H3Index* set = makeSet(hexes, numHexes);
+
+    H3_EXPORT(h3SetToLinkedGeo)(set, numHexes, polygon);
+
+    t_assert(countLinkedLoops(polygon) == 1, "1 loop added to polygon");
+    t_assert(countLinkedCoords(polygon->first) == 5 * 3,
+             "Three outer edges added for each neighbor");
+
+    H3_EXPORT(destroyLinkedPolygon)(polygon);
+    free(set);
+    free(polygon);
+}
+
+TEST(holeOrderIndependent) {
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    // Same ring as the hole test, starting from a different hexagon
+    char* hexes[] = {"89283082883ffff", "8928308288fffff", "89283082813ffff",
+                     "8928308289bffff", "892830828d7ffff", "892830828c7ffff"};
+    int numHexes = sizeof(hexes) / sizeof(hexes[0]);
+    H3Index* set = makeSet(hexes, numHexes);
+
+    H3_EXPORT(h3SetToLinkedGeo)(set, numHexes, polygon);
+
+    t_assert(countLinkedLoops(polygon) == 2, "2 loops added to polygon");
+    t_assert(countLinkedCoords(polygon->first) == 6 * 3,
+             "All outer coords added to first loop");
+    t_assert(countLinkedCoords(polygon->first->next) == 6,
+             "All inner coords added to second loop");
+
+    H3_EXPORT(destroyLinkedPolygon)(polygon);
+    free(set);
+    free(polygon);
+}
+
+TEST(mixedResolution) {
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    LinkedGeoPolygon* uncompactedPolygon = calloc(1, sizeof(LinkedGeoPolygon));
+    H3Index parent = H3_EXPORT(stringToH3)("872830828ffffff");
+    H3Index uncompacted[49];
+    H3_EXPORT(h3ToChildren)(parent, 9, uncompacted);
+
+    // Six res 8 children, plus the res 9 children of the center child
+    H3Index children[7];
+    H3Index set[13];
+    H3_EXPORT(h3ToChildren)(parent, 8, children);
+    for (int i = 0; i < 6; i++) {
+        set[i] = children[i + 1];
+    }
+    H3_EXPORT(h3ToChildren)(children[0], 9, set + 6);
+
+    H3_EXPORT(h3SetToLinkedGeo)(set, 13, polygon);
+    H3_EXPORT(h3SetToLinkedGeo)(uncompacted, 49, uncompactedPolygon);
+
+    t_assert(countLinkedLoops(polygon) == 1, "1 loop added to polygon");
+    t_assert(countLinkedCoords(polygon->first) ==
+                 countLinkedCoords(uncompactedPolygon->first),
+             "Mixed resolution outline traced at finest resolution");
+
+    H3_EXPORT(destroyLinkedPolygon)(polygon);
+    H3_EXPORT(destroyLinkedPolygon)(uncompactedPolygon);
+    free(polygon);
+    free(uncompactedPolygon);
+}
+
+TEST(holeAndSeparateShell) {
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    // A single hex, then a ring with a hole, traced in that order
+    char* hexes[] = {"8928308291bffff", "892830828c7ffff", "892830828d7ffff",
+                     "8928308289bffff", "89283082813ffff", "8928308288fffff",
+                     "89283082883ffff"};
+    int numHexes = sizeof(hexes) / sizeof(hexes[0]);
+    H3Index* set = makeSet(hexes, numHexes);
+
+    H3_EXPORT(h3SetToLinkedGeo)(set, numHexes, polygon);
+
+    t_assert(countLinkedPolygons(polygon) == 2, "2 polygons added");
+    t_assert(countLinkedLoops(polygon) == 1, "Single hex has no hole");
+    t_assert(countLinkedCoords(polygon->first) == 6, "Single hex outline");
+    t_assert(countLinkedLoops(polygon->next) == 2,
+             "Hole attached to the ring");
+    t_assert(countLinkedCoords(polygon->next->first) == 6 * 3,
+             "Ring outer loop first");
+    t_assert(countLinkedCoords(polygon->next->first->next) == 6,
+             "Ring hole second");
+
+    H3_EXPORT(destroyLinkedPolygon)(polygon);
+    free(set);
+    free(polygon);
+}
+
+TEST(islandInHole) {
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    // A hex, then the ring at distance 3 around it
+    H3Index set[1 + 6 * 3];
+    set[0] = H3_EXPORT(stringToH3)("8928308288bffff");
+    t_assert(H3_EXPORT(hexRing)(set[0], 3, set + 1) == 0, "ring computed");
+
+    H3_EXPORT(h3SetToLinkedGeo)(set, 1 + 6 * 3, polygon);
+
+    t_assert(countLinkedPolygons(polygon) == 2, "2 polygons added");
+    t_assert(countLinkedLoops(polygon) == 1, "Island has no hole");
+    t_assert(countLinkedLoops(polygon->next) == 2,
+             "Hole attached to the ring, not the island inside it");
+
+    H3_EXPORT(destroyLinkedPolygon)(polygon);
+    free(polygon);
+}
+
 END_TESTS();
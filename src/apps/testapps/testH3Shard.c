@@ -0,0 +1,215 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3Shard.c
+ * @brief Tests the tables of contiguous ranges of hexagons assigned to
+ * shards.
+ *
+ *  usage: `testH3Shard`
+ */
+
+#include <stdlib.h>
+#include "h3Index.h"
+#include "h3Shard.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+/** Weighs the hexagons of one base cell much more than the others */
+static double baseCellWeight(void* data, H3Index h) {
+    int* heavyBaseCell = data;
+    return H3_GET_BASE_CELL(h) == *heavyBaseCell ? 1000.0 : 1.0;
+}
+
+/**
+ * Checks that the shards of a table are contiguous ranges covering every
+ * hexagon of its resolution in index order, each holding the weight the
+ * table reports, and returns the largest weight of a shard.
+ */
+static double assertContiguous(const H3ShardTable* table,
+                               H3CellWeightFunc weight, void* data) {
+    int res = H3_EXPORT(h3ShardTableRes)(table);
+    int numShards = H3_EXPORT(h3ShardTableNumShards)(table);
+    double* weights = calloc(numShards, sizeof(double));
+    int previous = 0;
+    for (int64_t i = 0; i < H3_EXPORT(numHexagons)(res); i++) {
+        H3Index h = H3_EXPORT(ordinalToH3)(i, res);
+        int shard = H3_EXPORT(h3ToShard)(table, h);
+        t_assert(shard == previous || shard == previous + 1,
+                 "shards are contiguous and in order");
+        weights[shard] += weight == NULL ? 1.0 : weight(data, h);
+        previous = shard;
+    }
+    t_assert(previous == numShards - 1, "every shard has hexagons");
+    double maxWeight = 0;
+    for (int s = 0; s < numShards; s++) {
+        t_assert(weights[s] == H3_EXPORT(h3ShardWeight)(table, s),
+                 "shard weight matches its hexagons");
+        if (weights[s] > maxWeight) maxWeight = weights[s];
+    }
+    free(weights);
+    return maxWeight;
+}
+
+BEGIN_TESTS(h3Shard);
+
+TEST(uniform) {
+    H3ShardTable* table = H3_EXPORT(createH3ShardTable)(2, 256, NULL, NULL);
+    t_assert(table != NULL, "created");
+    t_assert(H3_EXPORT(h3ShardTableNumShards)(table) == 256, "shards");
+    t_assert(H3_EXPORT(h3ShardTableRes)(table) == 2, "resolution");
+    assertContiguous(table, NULL, NULL);
+    // 5882 hexagons are 22.98 per shard
+    for (int s = 0; s < 256; s++) {
+        double count = H3_EXPORT(h3ShardWeight)(table, s);
+        t_assert(count == 22 || count == 23, "shards are balanced");
+    }
+    H3_EXPORT(destroyH3ShardTable)(table);
+
+    // As many shards as hexagons
+    table = H3_EXPORT(createH3ShardTable)(0, 122, NULL, NULL);
+    for (int bc = 0; bc < 122; bc++) {
+        H3Index h;
+        setH3Index(&h, 0, bc, CENTER_DIGIT);
+        t_assert(H3_EXPORT(h3ToShard)(table, h) == bc,
+                 "one base cell per shard");
+    }
+    H3_EXPORT(destroyH3ShardTable)(table);
+}
+
+TEST(weightFunction) {
+    int heavyBaseCell = 20;
+    H3ShardTable* table =
+        H3_EXPORT(createH3ShardTable)(3, 64, baseCellWeight, &heavyBaseCell);
+    double maxWeight = assertContiguous(table, baseCellWeight, &heavyBaseCell);
+    double total = 0;
+    for (int s = 0; s < 64; s++) {
+        total += H3_EXPORT(h3ShardWeight)(table, s);
+    }
+    // Each end of a range is within half the heaviest hexagon of its share
+    t_assert(maxWeight <= total / 64 + 1000, "shards are balanced");
+
+    // Most shards hold part of the heavy base cell
+    H3Index first;
+    setH3Index(&first, 3, heavyBaseCell, CENTER_DIGIT);
+    H3Index last;
+    setH3Index(&last, 3, heavyBaseCell, IJ_AXES_DIGIT);
+    int firstShard = H3_EXPORT(h3ToShard)(table, first);
+    int lastShard = H3_EXPORT(h3ToShard)(table, last);
+    t_assert(lastShard - firstShard > 32, "heavy base cell is split");
+    H3_EXPORT(destroyH3ShardTable)(table);
+}
+
+TEST(samples) {
+    // Resolution 7 hexagons spanning several resolution 5 hexagons
+    int k = 20;
+    int numSamples = H3_EXPORT(maxKringSize)(k);
+    H3Index* samples = calloc(numSamples, sizeof(H3Index));
+    H3_EXPORT(kRing)(H3_EXPORT(h3ToParent)(sunnyvale, 7), k, samples);
+    double* weights = calloc(numSamples, sizeof(double));
+    for (int i = 0; i < numSamples; i++) {
+        weights[i] = 1.0 + i % 3;
+    }
+
+    H3ShardTable* table = H3_EXPORT(createH3ShardTableFromSamples)(
+        5, 16, samples, weights, numSamples);
+    t_assert(table != NULL, "created");
+    double shardWeights[16] = {0};
+    double total = 0;
+    int* shards = calloc(numSamples, sizeof(int));
+    H3_EXPORT(h3ToShardBatch)(table, samples, numSamples, shards);
+    for (int i = 0; i < numSamples; i++) {
+        t_assert(shards[i] == H3_EXPORT(h3ToShard)(table, samples[i]),
+                 "batch gives the same shard");
+        shardWeights[shards[i]] += weights[i];
+        total += weights[i];
+    }
+    int numUsed = 0;
+    for (int s = 0; s < 16; s++) {
+        t_assert(shardWeights[s] == H3_EXPORT(h3ShardWeight)(table, s),
+                 "shard weight is the weight of its samples");
+        numUsed += shardWeights[s] > 0;
+        // A resolution 5 hexagon holds at most 49 samples of weight 3
+        t_assert(shardWeights[s] <= total / 16 + 49 * 3,
+                 "shards are balanced");
+    }
+    t_assert(numUsed == 16, "samples are split across every shard");
+    t_assert(H3_EXPORT(h3ToShard)(table, H3_EXPORT(h3ToParent)(
+                                             sunnyvale, 4)) == -1,
+             "coarser hexagons have no shard");
+
+    // Rebuilt from its starts, a table routes the same
+    H3Index starts[16];
+    t_assert(H3_EXPORT(h3ShardTableToArray)(table, starts) == 16, "wrote");
+    H3ShardTable* rebuilt =
+        H3_EXPORT(createH3ShardTableFromStarts)(starts, 16);
+    t_assert(rebuilt != NULL, "rebuilt");
+    t_assert(H3_EXPORT(h3ShardTableRes)(rebuilt) == 5, "same resolution");
+    for (int i = 0; i < numSamples; i++) {
+        t_assert(H3_EXPORT(h3ToShard)(rebuilt, samples[i]) == shards[i],
+                 "same shard");
+    }
+    t_assert(H3_EXPORT(h3ShardWeight)(rebuilt, 0) == 0, "weights unknown");
+
+    // Counting the samples instead of weighing them
+    H3ShardTable* counted = H3_EXPORT(createH3ShardTableFromSamples)(
+        5, 16, samples, NULL, numSamples);
+    double numCounted = 0;
+    for (int s = 0; s < 16; s++) {
+        numCounted += H3_EXPORT(h3ShardWeight)(counted, s);
+    }
+    t_assert(numCounted == numSamples, "samples are counted");
+
+    H3_EXPORT(destroyH3ShardTable)(counted);
+    H3_EXPORT(destroyH3ShardTable)(rebuilt);
+    H3_EXPORT(destroyH3ShardTable)(table);
+    free(shards);
+    free(weights);
+    free(samples);
+}
+
+TEST(invalidArguments) {
+    t_assert(H3_EXPORT(createH3ShardTable)(-1, 1, NULL, NULL) == NULL,
+             "negative resolution");
+    t_assert(H3_EXPORT(createH3ShardTable)(H3_SHARD_MAX_RES + 1, 1, NULL,
+                                           NULL) == NULL,
+             "resolution too fine");
+    t_assert(H3_EXPORT(createH3ShardTable)(0, 0, NULL, NULL) == NULL,
+             "no shards");
+    t_assert(H3_EXPORT(createH3ShardTable)(0, 123, NULL, NULL) == NULL,
+             "more shards than hexagons");
+    t_assert(H3_EXPORT(createH3ShardTableFromSamples)(0, 123, NULL, NULL,
+                                                      0) == NULL,
+             "more shards than hexagons from samples");
+
+    H3Index starts[2];
+    setH3Index(&starts[0], 1, 5, 3);
+    setH3Index(&starts[1], 1, 4, 3);
+    t_assert(H3_EXPORT(createH3ShardTableFromStarts)(starts, 2) == NULL,
+             "starts out of order");
+    setH3Index(&starts[1], 2, 6, 3);
+    t_assert(H3_EXPORT(createH3ShardTableFromStarts)(starts, 2) == NULL,
+             "starts of different resolutions");
+    t_assert(H3_EXPORT(createH3ShardTableFromStarts)(starts, 0) == NULL,
+             "no starts");
+
+    // Samples of no weight are split by count
+    H3ShardTable* table =
+        H3_EXPORT(createH3ShardTableFromSamples)(1, 4, NULL, NULL, 0);
+    assertContiguous(table, NULL, NULL);
+    H3_EXPORT(destroyH3ShardTable)(table);
+}
+
+END_TESTS();
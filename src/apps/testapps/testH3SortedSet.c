@@ -0,0 +1,376 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "h3Index.h"
+#include "h3IndexSet.h"
+#include "h3SortedSet.h"
+#include "test.h"
+
+H3Index sunnyvale = 0x89283470c27ffffl;
+
+/** @brief set operations checked against their definition */
+typedef enum { UNION, INTERSECTION, DIFFERENCE } SetOp;
+
+/**
+ * Creates the compacted set of the resolution 9 hexagons within k of origin.
+ */
+static H3SortedSet* diskSet(H3Index origin, int k) {
+    int numHexes = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(origin, k, ring);
+    H3Index* compacted = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(compact)(ring, compacted, numHexes) == 0,
+             "compact succeeds");
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(compacted, numHexes);
+    free(compacted);
+    free(ring);
+    return set;
+}
+
+/**
+ * Checks the result of a set operation on every hexagon of a universe, and
+ * checks that it holds valid, ascending hexagons which do not compact any
+ * further.
+ */
+static void assertSetOp(const H3SortedSet* a, const H3SortedSet* b,
+                        SetOp op, const H3Index* universe, int numUniverse) {
+    H3SortedSet* result =
+        op == UNION ? H3_EXPORT(h3SortedSetUnion)(a, b)
+                    : op == INTERSECTION
+                          ? H3_EXPORT(h3SortedSetIntersection)(a, b)
+                          : H3_EXPORT(h3SortedSetDifference)(a, b);
+    for (int i = 0; i < numUniverse; i++) {
+        if (universe[i] == 0) continue;
+        int inA = H3_EXPORT(h3SortedSetContains)(a, universe[i]);
+        int inB = H3_EXPORT(h3SortedSetContains)(b, universe[i]);
+        int expected = op == UNION ? inA || inB
+                                   : op == INTERSECTION ? inA && inB
+                                                        : inA && !inB;
+        t_assert(H3_EXPORT(h3SortedSetContains)(result, universe[i]) ==
+                     expected,
+                 "result matches the set operation");
+    }
+
+    int numHexes = H3_EXPORT(h3SortedSetSize)(result);
+    H3Index* hexes = calloc(numHexes + 1, sizeof(H3Index));
+    H3_EXPORT(h3SortedSetToArray)(result, hexes);
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3IsValid)(hexes[i]), "result hexagon is valid");
+        t_assert(i == 0 || (hexes[i - 1] & H3_SORTED_SET_KEY_MASK) <
+                               (hexes[i] & H3_SORTED_SET_KEY_MASK),
+                 "result is in ascending key order");
+    }
+    H3SortedSet* again = H3_EXPORT(createH3SortedSet)(hexes, numHexes);
+    H3SortedSet* merged = H3_EXPORT(h3SortedSetUnion)(again, again);
+    t_assert(H3_EXPORT(h3SortedSetSize)(merged) == numHexes,
+             "result is compacted");
+    H3_EXPORT(destroyH3SortedSet)(merged);
+    H3_EXPORT(destroyH3SortedSet)(again);
+    free(hexes);
+    H3_EXPORT(destroyH3SortedSet)(result);
+}
+
+BEGIN_TESTS(h3SortedSet);
+
+TEST(rangeStart) {
+    H3Index key = sunnyvale & H3_SORTED_SET_KEY_MASK;
+    H3Index start = _h3SortedSetRangeStart(key);
+    t_assert((start & 0x3ffffl) == 0, "unused digits cleared");
+    t_assert((start >> 18) == (key >> 18), "used digits kept");
+
+    H3Index baseCell;
+    setH3Index(&baseCell, 0, 20, 0);
+    t_assert(_h3SortedSetRangeStart(baseCell & H3_SORTED_SET_KEY_MASK) ==
+                 (H3Index)20 << H3_BC_OFFSET,
+             "res 0 range starts at the base cell");
+}
+
+TEST(compacted) {
+    int numHexes = H3_EXPORT(maxKringSize)(8);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 8, ring);
+    H3Index* compacted = calloc(numHexes, sizeof(H3Index));
+    t_assert(H3_EXPORT(compact)(ring, compacted, numHexes) == 0,
+             "compact succeeds");
+
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(compacted, numHexes);
+    int numCompacted = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (compacted[i] != 0) numCompacted++;
+    }
+    t_assert(H3_EXPORT(h3SortedSetSize)(set) == numCompacted,
+             "holds the compacted hexagons");
+
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3SortedSetContains)(set, ring[i]),
+                 "contains each hexagon of the ring");
+        H3Index children[49] = {0};
+        H3_EXPORT(h3ToChildren)(ring[i], 11, children);
+        for (int j = 0; j < 49; j++) {
+            t_assert(H3_EXPORT(h3SortedSetContains)(set, children[j]),
+                     "contains finer descendants");
+        }
+    }
+
+    H3Index outside[6 * 9] = {0};
+    t_assert(H3_EXPORT(hexRing)(sunnyvale, 9, outside) == 0, "hexRing");
+    for (int i = 0; i < 6 * 9; i++) {
+        t_assert(!H3_EXPORT(h3SortedSetContains)(set, outside[i]),
+                 "does not contain the next ring");
+    }
+    t_assert(!H3_EXPORT(h3SortedSetContains)(
+                 set, H3_EXPORT(h3ToParent)(sunnyvale, 6)),
+             "does not contain a partially covered ancestor");
+
+    H3_EXPORT(destroyH3SortedSet)(set);
+    free(compacted);
+    free(ring);
+}
+
+TEST(overlappingInput) {
+    H3Index parent = H3_EXPORT(h3ToParent)(sunnyvale, 7);
+    H3Index input[] = {sunnyvale, 0, parent, sunnyvale,
+                       H3_EXPORT(h3ToParent)(sunnyvale, 8)};
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(input, 5);
+    t_assert(H3_EXPORT(h3SortedSetSize)(set) == 1,
+             "contained and duplicate hexagons dropped");
+    t_assert(H3_EXPORT(h3SortedSetContains)(set, parent), "contains parent");
+    t_assert(!H3_EXPORT(h3SortedSetContains)(
+                 set, H3_EXPORT(h3ToParent)(sunnyvale, 6)),
+             "does not contain grandparent");
+    H3_EXPORT(destroyH3SortedSet)(set);
+}
+
+TEST(pentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 1, 4, 0);
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(&pentagon, 1);
+
+    H3Index children[49] = {0};
+    H3_EXPORT(h3ToChildren)(pentagon, 3, children);
+    for (int i = 0; i < 49; i++) {
+        if (children[i] != 0) {
+            t_assert(H3_EXPORT(h3SortedSetContains)(set, children[i]),
+                     "contains pentagon descendants");
+        }
+    }
+    H3Index neighbors[7] = {0};
+    H3_EXPORT(kRing)(pentagon, 1, neighbors);
+    for (int i = 0; i < 7; i++) {
+        if (neighbors[i] != 0 && neighbors[i] != pentagon) {
+            t_assert(!H3_EXPORT(h3SortedSetContains)(set, neighbors[i]),
+                     "does not contain neighbors");
+        }
+    }
+    H3_EXPORT(destroyH3SortedSet)(set);
+}
+
+TEST(toArray) {
+    H3Index input[2];
+    input[0] = H3_EXPORT(h3ToParent)(sunnyvale, 5);
+    setH3Index(&input[1], 1, 4, 0);
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(input, 2);
+    t_assert(H3_EXPORT(h3SortedSetSize)(set) == 2, "holds both hexagons");
+    H3Index out[2];
+    H3_EXPORT(h3SortedSetToArray)(set, out);
+    t_assert(out[0] == input[1], "round trips the pentagon first");
+    t_assert(out[1] == input[0], "round trips the other resolution");
+    H3_EXPORT(destroyH3SortedSet)(set);
+}
+
+TEST(setOperations) {
+    int numUniverse = H3_EXPORT(maxKringSize)(20);
+    H3Index* universe = calloc(numUniverse, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 20, universe);
+
+    H3Index offset[6 * 7] = {0};
+    t_assert(H3_EXPORT(hexRing)(sunnyvale, 7, offset) == 0, "hexRing");
+    H3SortedSet* a = diskSet(sunnyvale, 8);
+    H3SortedSet* b = diskSet(offset[0], 8);
+    H3SortedSet* empty = H3_EXPORT(createH3SortedSet)(NULL, 0);
+    for (SetOp op = UNION; op <= DIFFERENCE; op++) {
+        assertSetOp(a, b, op, universe, numUniverse);
+        assertSetOp(b, a, op, universe, numUniverse);
+        assertSetOp(a, a, op, universe, numUniverse);
+        assertSetOp(a, empty, op, universe, numUniverse);
+        assertSetOp(empty, a, op, universe, numUniverse);
+    }
+
+    // a coarse hexagon partly covering both disks
+    H3Index coarse = H3_EXPORT(h3ToParent)(sunnyvale, 6);
+    H3SortedSet* c = H3_EXPORT(createH3SortedSet)(&coarse, 1);
+    for (SetOp op = UNION; op <= DIFFERENCE; op++) {
+        assertSetOp(a, c, op, universe, numUniverse);
+        assertSetOp(c, a, op, universe, numUniverse);
+    }
+
+    H3SortedSet* u = H3_EXPORT(h3SortedSetUnion)(a, b);
+    H3SortedSet* aMinusB = H3_EXPORT(h3SortedSetDifference)(a, b);
+    H3SortedSet* restored = H3_EXPORT(h3SortedSetUnion)(aMinusB, b);
+    t_assert(H3_EXPORT(h3SortedSetSize)(restored) ==
+                 H3_EXPORT(h3SortedSetSize)(u),
+             "difference and union restore the compacted union");
+    H3_EXPORT(destroyH3SortedSet)(restored);
+    H3_EXPORT(destroyH3SortedSet)(aMinusB);
+    H3_EXPORT(destroyH3SortedSet)(u);
+
+    H3_EXPORT(destroyH3SortedSet)(c);
+    H3_EXPORT(destroyH3SortedSet)(empty);
+    H3_EXPORT(destroyH3SortedSet)(b);
+    H3_EXPORT(destroyH3SortedSet)(a);
+    free(universe);
+}
+
+TEST(pentagonSetOperations) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 1, 4, 0);
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(pentagon, 2, children);
+    H3Index universe[49] = {0};
+    H3_EXPORT(h3ToChildren)(pentagon, 3, universe);
+
+    H3SortedSet* whole = H3_EXPORT(createH3SortedSet)(&pentagon, 1);
+    H3SortedSet* center = H3_EXPORT(createH3SortedSet)(&children[0], 1);
+    H3SortedSet* others = H3_EXPORT(createH3SortedSet)(children + 1, 6);
+    H3SortedSet* u = H3_EXPORT(h3SortedSetUnion)(center, others);
+    t_assert(H3_EXPORT(h3SortedSetSize)(u) == 1,
+             "six children compact to the pentagon");
+    H3Index out;
+    H3_EXPORT(h3SortedSetToArray)(u, &out);
+    t_assert(out == pentagon, "union is the pentagon");
+
+    H3SortedSet* d = H3_EXPORT(h3SortedSetDifference)(whole, center);
+    t_assert(H3_EXPORT(h3SortedSetSize)(d) == 5,
+             "pentagon minus its center is five hexagons");
+    for (SetOp op = UNION; op <= DIFFERENCE; op++) {
+        assertSetOp(whole, center, op, universe, 49);
+        assertSetOp(center, others, op, universe, 49);
+    }
+
+    H3_EXPORT(destroyH3SortedSet)(d);
+    H3_EXPORT(destroyH3SortedSet)(u);
+    H3_EXPORT(destroyH3SortedSet)(others);
+    H3_EXPORT(destroyH3SortedSet)(center);
+    H3_EXPORT(destroyH3SortedSet)(whole);
+}
+
+TEST(empty) {
+    H3Index zeros[] = {0, 0};
+    H3SortedSet* set = H3_EXPORT(createH3SortedSet)(zeros, 2);
+    t_assert(H3_EXPORT(h3SortedSetSize)(set) == 0, "empty set");
+    t_assert(!H3_EXPORT(h3SortedSetContains)(set, sunnyvale),
+             "empty set contains nothing");
+    H3_EXPORT(destroyH3SortedSet)(set);
+
+    set = H3_EXPORT(createH3SortedSet)(NULL, 0);
+    t_assert(!H3_EXPORT(h3SortedSetContains)(set, sunnyvale),
+             "set of no hexagons contains nothing");
+    H3_EXPORT(destroyH3SortedSet)(set);
+}
+
+TEST(sortCells) {
+    // Hexagons of resolutions 7 to 10 around one place, in arbitrary order
+    int numRing = H3_EXPORT(maxKringSize)(2);
+    int numHexes = 4 * numRing + 7;
+    H3Index* h3Set = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(sunnyvale, 2, h3Set);
+    for (int i = 0; i < numRing; i++) {
+        h3Set[numRing + i] = H3_EXPORT(h3ToParent)(h3Set[i], 8);
+        h3Set[2 * numRing + i] = H3_EXPORT(h3ToParent)(h3Set[i], 7);
+        h3Set[3 * numRing + i] = H3_EXPORT(h3ToParent)(h3Set[i], 7);
+    }
+    H3_EXPORT(h3ToChildren)(h3Set[3], 10, h3Set + 4 * numRing);
+    for (int i = numHexes - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        H3Index swap = h3Set[i];
+        h3Set[i] = h3Set[j];
+        h3Set[j] = swap;
+    }
+
+    H3_EXPORT(h3SortCells)(h3Set, numHexes);
+    for (int i = 1; i < numHexes; i++) {
+        t_assert(H3_EXPORT(h3ToOrderKey)(h3Set[i - 1]) <=
+                     H3_EXPORT(h3ToOrderKey)(h3Set[i]),
+                 "sorted by key");
+    }
+    for (int i = 0; i < numHexes; i++) {
+        // The descendants of each hexagon come just before it
+        int res = H3_EXPORT(h3GetResolution)(h3Set[i]);
+        int first = i;
+        while (first > 0 &&
+               H3_EXPORT(h3GetResolution)(h3Set[first - 1]) >= res &&
+               H3_EXPORT(h3ToParent)(h3Set[first - 1], res) == h3Set[i]) {
+            first--;
+        }
+        for (int j = 0; j < first; j++) {
+            t_assert(H3_EXPORT(h3GetResolution)(h3Set[j]) <= res ||
+                         H3_EXPORT(h3ToParent)(h3Set[j], res) != h3Set[i],
+                     "descendants are contiguous");
+        }
+    }
+
+    int numUnique = H3_EXPORT(h3SortUniqueCells)(h3Set, numHexes);
+    for (int i = 1; i < numUnique; i++) {
+        t_assert(H3_EXPORT(h3ToOrderKey)(h3Set[i - 1]) <
+                     H3_EXPORT(h3ToOrderKey)(h3Set[i]),
+                 "unique hexagons are strictly sorted");
+    }
+    H3IndexSet* distinct = H3_EXPORT(createH3IndexSet)(0);
+    H3_EXPORT(kRing)(sunnyvale, 2, h3Set + numUnique);
+    for (int i = 0; i < numRing; i++) {
+        H3Index h = h3Set[numUnique + i];
+        H3_EXPORT(h3IndexSetAdd)(distinct, h);
+        H3_EXPORT(h3IndexSetAdd)(distinct, H3_EXPORT(h3ToParent)(h, 8));
+        H3_EXPORT(h3IndexSetAdd)(distinct, H3_EXPORT(h3ToParent)(h, 7));
+    }
+    t_assert(numUnique == H3_EXPORT(h3IndexSetSize)(distinct) + 7,
+             "each hexagon kept once");
+    H3_EXPORT(destroyH3IndexSet)(distinct);
+    free(h3Set);
+}
+
+TEST(sortCellsMatchesSortedSet) {
+    H3SortedSet* set = diskSet(sunnyvale, 6);
+    int numHexes = H3_EXPORT(h3SortedSetSize)(set);
+    H3Index* expected = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(h3SortedSetToArray)(set, expected);
+
+    // Reversed, with zeros and duplicates, as kRing output may have
+    H3Index* h3Set = calloc(2 * numHexes + 2, sizeof(H3Index));
+    for (int i = 0; i < numHexes; i++) {
+        h3Set[i] = expected[numHexes - 1 - i];
+        h3Set[numHexes + 2 + i] = expected[i];
+    }
+    t_assert(H3_EXPORT(h3SortUniqueCells)(h3Set, 2 * numHexes + 2) ==
+                 numHexes,
+             "zeros and duplicates dropped");
+    for (int i = 0; i < numHexes; i++) {
+        t_assert(h3Set[i] == expected[i], "same order as the sorted set");
+    }
+
+    H3_EXPORT(h3SortCells)(h3Set, 0);
+    t_assert(H3_EXPORT(h3SortUniqueCells)(h3Set, 1) == 1, "one hexagon");
+    t_assert(h3Set[0] == expected[0], "one hexagon is unchanged");
+    H3Index zero = 0;
+    t_assert(H3_EXPORT(h3SortUniqueCells)(&zero, 1) == 0, "zero dropped");
+
+    free(h3Set);
+    free(expected);
+    H3_EXPORT(destroyH3SortedSet)(set);
+}
+
+END_TESTS();
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the hot path counters reported by h3GetStats
+ *
+ *  usage: `testH3Stats`
+ *
+ *  The counters are only checked when the library is built with
+ *  H3_ENABLE_STATS; otherwise h3GetStats must report zeros.
+ */
+
+#include <string.h>
+#include "algos.h"
+#include "h3api.h"
+#include "test.h"
+
+// Fixtures
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoPolygon sfGeoPolygon = {{6, sfVerts}, 0, NULL};
+
+static const H3Stats zeroStats = {0};
+H3Stats stats;
+
+/** whether the library was built with H3_ENABLE_STATS */
+static int statsCollected(void) { return H3_EXPORT(h3GetStats)(&stats) == 0; }
+
+BEGIN_TESTS(h3Stats);
+
+TEST(disabled) {
+    if (!statsCollected()) {
+        H3_EXPORT(kRing)(0x821c07fffffffff, 1, (H3Index[7]){0});
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(memcmp(&stats, &zeroStats, sizeof(stats)) == 0,
+                 "stats are zero when not collected");
+    }
+}
+
+TEST(reset) {
+    if (statsCollected()) {
+        H3Index out[1253];
+        H3_EXPORT(polyfill)(&sfGeoPolygon, 9, out);
+        H3_EXPORT(h3ResetStats)();
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(memcmp(&stats, &zeroStats, sizeof(stats)) == 0,
+                 "reset zeroes the stats");
+    }
+}
+
+TEST(kRingFallbacks) {
+    if (statsCollected()) {
+        H3Index ring[7];
+
+        H3_EXPORT(h3ResetStats)();
+        memset(ring, 0, sizeof(ring));
+        H3_EXPORT(kRing)(0x8928308280fffff, 1, ring);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.kRingFallbacks == 0,
+                 "hexagon k-ring does not fall back");
+
+        memset(ring, 0, sizeof(ring));
+        H3_EXPORT(kRing)(0x821c07fffffffff, 1, ring);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.kRingFallbacks == 1, "pentagon k-ring falls back");
+    }
+}
+
+TEST(polyfill) {
+    if (statsCollected()) {
+        H3Index out[1253];
+
+        H3_EXPORT(h3ResetStats)();
+        int numHexagons = H3_EXPORT(polyfillDense)(&sfGeoPolygon, 9, out, 1253);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(numHexagons == 1253, "got expected polyfill size");
+        t_assert(stats.polyfillKept == 1253, "counted the cells kept");
+        t_assert(stats.polyfillCandidates > 0, "counted the candidates");
+        t_assert(stats.pointInPolyEdges > 0, "counted the edges tested");
+        t_assert(stats.allocations > 0, "counted the allocations");
+        t_assert(stats.allocatedBytes > 0, "counted the bytes allocated");
+    }
+}
+
+TEST(vertexGraph) {
+    if (statsCollected()) {
+        H3Index set[] = {0x8928308280fffff, 0x8928308280bffff};
+        VertexGraph graph;
+
+        H3_EXPORT(h3ResetStats)();
+        h3SetToVertexGraph(set, 2, &graph);
+        destroyVertexGraph(&graph);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.vertexGraphLookups == 12, "looked up each edge once");
+        t_assert(stats.vertexGraphProbes > 0, "counted the vertex probes");
+    }
+}
+
+TEST(compact) {
+    if (statsCollected()) {
+        H3Index children[7] = {0};
+        H3Index compacted[7] = {0};
+        H3_EXPORT(h3ToChildren)(0x8928308280fffff, 10, children);
+
+        H3_EXPORT(h3ResetStats)();
+        t_assert(H3_EXPORT(compact)(children, compacted, 7) == 0, "compacted");
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.compactProbes >= 14,
+                 "probed once per insert and lookup");
+    }
+}
+
+TEST(liveBytes) {
+    if (statsCollected()) {
+        H3Index set[] = {0x8928308280fffff, 0x8928308280bffff};
+        LinkedGeoPolygon polygon;
+
+        H3_EXPORT(h3ResetStats)();
+        H3_EXPORT(h3SetToLinkedGeo)(set, 2, &polygon);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.liveBytes > 0, "outline is live");
+        t_assert(stats.peakBytes >= stats.liveBytes,
+                 "peak is at least the live bytes");
+        int64_t peak = stats.peakBytes;
+
+        H3_EXPORT(destroyLinkedPolygon)(&polygon);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.liveBytes == 0, "every byte allocated was freed");
+        t_assert(stats.peakBytes == peak, "freeing keeps the peak");
+        t_assert(stats.frees > 0, "counted the frees");
+        t_assert((int64_t)stats.allocatedBytes >= stats.peakBytes,
+                 "no more bytes live than allocated");
+    }
+}
+
+TEST(peakStackBytes) {
+    if (statsCollected()) {
+        H3Index ring[19];
+        H3Index children[49];
+        H3Index compacted[49];
+
+        H3_EXPORT(h3ResetStats)();
+        H3_EXPORT(kRing)(0x821c07fffffffff, 2, ring);
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.peakStackBytes > 0, "counted the k-ring scratch");
+
+        H3_EXPORT(h3ToChildren)(0x8928308280fffff, 11, children);
+        H3_EXPORT(h3ResetStats)();
+        t_assert(H3_EXPORT(compact)(children, compacted, 49) == 0,
+                 "compacted");
+        H3_EXPORT(h3GetStats)(&stats);
+        t_assert(stats.peakStackBytes >= 49 * sizeof(H3Index),
+                 "counted the compact buffer");
+    }
+}
+
+END_TESTS();
@@ -15,6 +15,9 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "coordijk.h"
 #include "h3Index.h"
 #include "test.h"
 
@@ -41,6 +44,29 @@ void verifyCountAndUniqueness(H3Index* children, int paddedCount,
     t_assert(numFound == expectedCount, "got expected number of children");
 }
 
+/**
+ * Reference enumeration of children by recursing one resolution at a time,
+ * leaving the slots of deleted pentagon children untouched.
+ */
+static void recursiveChildren(H3Index h, int childRes, H3Index* children) {
+    int parentRes = H3_GET_RESOLUTION(h);
+    if (parentRes == childRes) {
+        *children = h;
+        return;
+    }
+    int step = H3_EXPORT(maxH3ToChildrenSize)(h, childRes) / 7;
+    int isAPentagon = H3_EXPORT(h3IsPentagon)(h);
+    for (int i = 0; i < 7; i++) {
+        if (!isAPentagon || i != K_AXES_DIGIT) {
+            H3Index child = h;
+            H3_SET_RESOLUTION(child, parentRes + 1);
+            H3_SET_INDEX_DIGIT(child, parentRes + 1, i);
+            recursiveChildren(child, childRes, children);
+        }
+        children += step;
+    }
+}
+
 BEGIN_TESTS(h3ToChildren);
 
 GeoCoord sf = {0.659966917655, 2 * 3.14159 - 2.1364398519396};
@@ -121,4 +147,55 @@ TEST(childResTooHigh) {
     free(children);
 }
 
+TEST(childrenSizeOverflow) {
+    // 7^15 children of a res 0 cell do not fit in an int
+    H3Index h;
+    setH3Index(&h, 0, 2, 0);
+    t_assert(H3_EXPORT(maxH3ToChildrenSize)(h, 15) == -1, "overflow reported");
+    H3Index children[1] = {0};
+    H3_EXPORT(h3ToChildren)(h, 15, children);
+    t_assert(children[0] == 0, "nothing written");
+}
+
+TEST(matchesRecursive) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 0, 4, 0);
+    H3Index parents[] = {sfHex8, pentagon, 0};
+    setH3Index(&parents[2], 2, 14, 0);
+    H3_SET_INDEX_DIGIT(parents[2], 2, 5);
+
+    for (int p = 0; p < 3; p++) {
+        int parentRes = H3_GET_RESOLUTION(parents[p]);
+        for (int childRes = parentRes; childRes <= parentRes + 4;
+             childRes++) {
+            int size = H3_EXPORT(maxH3ToChildrenSize)(parents[p], childRes);
+            H3Index* children = calloc(size, sizeof(H3Index));
+            H3Index* expected = calloc(size, sizeof(H3Index));
+            H3_EXPORT(h3ToChildren)(parents[p], childRes, children);
+            recursiveChildren(parents[p], childRes, expected);
+            t_assert(memcmp(children, expected, size * sizeof(H3Index)) == 0,
+                     "children match recursive enumeration");
+            free(children);
+            free(expected);
+        }
+    }
+}
+
+TEST(pentagonChildren) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 1, 4, 0);
+    const int paddedCount = 49;
+
+    H3Index* children = calloc(paddedCount, sizeof(H3Index));
+    H3_EXPORT(h3ToChildren)(pentagon, 3, children);
+
+    verifyCountAndUniqueness(children, paddedCount, 1 + 5 + 5 * 7);
+    for (int i = 0; i < paddedCount; i++) {
+        if (children[i] != 0) {
+            t_assert(H3_EXPORT(h3IsValid)(children[i]), "child is valid");
+        }
+    }
+    free(children);
+}
+
 END_TESTS();
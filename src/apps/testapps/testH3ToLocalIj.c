@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testH3ToLocalIj.c
+ * @brief Tests converting indexes to and from local IJ coordinates
+ *
+ * usage: `testH3ToLocalIj`
+ */
+
+#include <stdlib.h>
+#include "baseCells.h"
+#include "constants.h"
+#include "h3Index.h"
+#include "localij.h"
+#include "test.h"
+
+/**
+ * Checks that every index near the origin that can be placed in local
+ * coordinates converts back to the same index.
+ */
+static void assertRoundTrip(H3Index origin, int k) {
+    int numHexes = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(numHexes, sizeof(H3Index));
+    H3_EXPORT(kRing)(origin, k, ring);
+    for (int i = 0; i < numHexes; i++) {
+        if (ring[i] == 0) continue;
+        CoordIJ ij;
+        if (H3_EXPORT(h3ToLocalIj)(origin, ring[i], &ij) == 0) {
+            H3Index back;
+            t_assert(H3_EXPORT(localIjToH3)(origin, &ij, &back) == 0,
+                     "converts back from local coordinates");
+            t_assert(back == ring[i], "round trips to the same index");
+        }
+    }
+    free(ring);
+}
+
+BEGIN_TESTS(h3ToLocalIj);
+
+TEST(origin) {
+    H3Index origin = 0x8928308280fffffL;
+    CoordIJ ij;
+    t_assert(H3_EXPORT(h3ToLocalIj)(origin, origin, &ij) == 0,
+             "origin has local coordinates");
+    H3Index back;
+    t_assert(H3_EXPORT(localIjToH3)(origin, &ij, &back) == 0 && back == origin,
+             "origin round trips");
+}
+
+TEST(neighbors) {
+    H3Index origin = 0x8928308280fffffL;
+    CoordIJ originIj;
+    H3_EXPORT(h3ToLocalIj)(origin, origin, &originIj);
+    H3Index ring[7] = {0};
+    H3_EXPORT(kRing)(origin, 1, ring);
+    for (int i = 0; i < 7; i++) {
+        if (ring[i] == origin) continue;
+        CoordIJ ij;
+        t_assert(H3_EXPORT(h3ToLocalIj)(origin, ring[i], &ij) == 0,
+                 "neighbor has local coordinates");
+        CoordIJK a, b;
+        _ijToIjk(&originIj, &a);
+        _ijToIjk(&ij, &b);
+        t_assert(_ijkDistance(&a, &b) == 1, "neighbor is one step away");
+    }
+}
+
+TEST(roundTrip) {
+    for (int res = 0; res < 3; res++) {
+        for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+            H3Index origin;
+            setH3Index(&origin, res, baseCell, 0);
+            assertRoundTrip(origin, 3);
+            if (res > 0) {
+                setH3Index(&origin, res, baseCell, 5);
+                assertRoundTrip(origin, 3);
+            }
+        }
+    }
+}
+
+TEST(failures) {
+    H3Index origin = 0x8928308280fffffL;
+    H3Index coarser = H3_EXPORT(h3ToParent)(origin, 7);
+    CoordIJ ij;
+    t_assert(H3_EXPORT(h3ToLocalIj)(origin, coarser, &ij) != 0,
+             "fails for a different resolution");
+
+    H3Index antipode;
+    setH3Index(&antipode, 9, 117, 0);
+    t_assert(H3_EXPORT(h3ToLocalIj)(origin, antipode, &ij) != 0,
+             "fails for base cells that are not neighbors");
+
+    H3Index pentagon;
+    setH3Index(&pentagon, 0, 4, 0);
+    CoordIJ kDirection = {0, 0};
+    CoordIJK kUnit = {0, 0, 1};
+    _ijkToIj(&kUnit, &kDirection);
+    H3Index out;
+    t_assert(H3_EXPORT(localIjToH3)(pentagon, &kDirection, &out) != 0,
+             "fails in the deleted direction of a pentagon");
+
+    CoordIJ farAway = {100, 0};
+    t_assert(H3_EXPORT(localIjToH3)(pentagon, &farAway, &out) != 0,
+             "fails outside of the neighboring base cells");
+}
+
+END_TESTS();
@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include "constants.h"
 #include "h3Index.h"
 #include "test.h"
 
@@ -46,4 +47,59 @@ TEST(invalidInputs) {
     t_assert(H3_EXPORT(h3ToParent)(child, 15) == 0, "Invalid resolution fails");
 }
 
+TEST(h3ToParentBatch) {
+    H3Index children[15];
+    H3Index parents[15];
+    for (int res = 0; res < 15; res++) {
+        children[res] = H3_EXPORT(geoToH3)(&sf, res + 1);
+    }
+
+    for (int parentRes = 0; parentRes <= MAX_H3_RES; parentRes++) {
+        H3_EXPORT(h3ToParentBatch)(children, 15, parentRes, parents);
+        for (int i = 0; i < 15; i++) {
+            t_assert(parents[i] ==
+                         H3_EXPORT(h3ToParent)(children[i], parentRes),
+                     "batch parent matches h3ToParent");
+        }
+    }
+
+    H3_EXPORT(h3ToParentBatch)(children, 15, -1, parents);
+    for (int i = 0; i < 15; i++) {
+        t_assert(parents[i] == 0, "invalid resolution gives no parents");
+    }
+}
+
+TEST(h3ToParentsBatch) {
+    H3Index children[15];
+    int parentRes[] = {7, 16, 5, 0};
+    H3Index parents[4 * 15];
+    for (int res = 0; res < 15; res++) {
+        children[res] = H3_EXPORT(geoToH3)(&sf, res + 1);
+    }
+
+    H3_EXPORT(h3ToParentsBatch)(children, 15, parentRes, 4, parents);
+    for (int r = 0; r < 4; r++) {
+        for (int i = 0; i < 15; i++) {
+            t_assert(parents[r * 15 + i] ==
+                         H3_EXPORT(h3ToParent)(children[i], parentRes[r]),
+                     "parent column matches h3ToParent");
+        }
+    }
+    t_assert(parents[3 * 15] == H3_EXPORT(geoToH3)(&sf, 0),
+             "got expected base cell");
+}
+
+TEST(h3GetResolutionBatch) {
+    H3Index cells[16];
+    int resolutions[16];
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        cells[res] = H3_EXPORT(geoToH3)(&sf, res);
+    }
+
+    H3_EXPORT(h3GetResolutionBatch)(cells, 16, resolutions);
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        t_assert(resolutions[res] == res, "got expected resolution");
+    }
+}
+
 END_TESTS();
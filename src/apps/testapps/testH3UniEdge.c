@@ -20,13 +20,93 @@
  */
 
 #include <stdlib.h>
+#include "baseCells.h"
 #include "constants.h"
+#include "geoCoord.h"
 #include "h3Index.h"
 #include "test.h"
 
 // Fixtures
 GeoCoord sfGeo = {0.659966917655, -2.1364398519396};
 
+/**
+ * Checks edge vertices against those the origin and destination boundaries
+ * share, found by decoding both cells and matching their vertices.
+ */
+static void assertSharedVertices(H3Index edge, const GeoCoord* verts,
+                                 int numVerts) {
+    GeoBoundary origin;
+    GeoBoundary destination;
+    H3_EXPORT(h3ToGeoBoundary)
+    (H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(edge), &origin);
+    H3_EXPORT(h3ToGeoBoundary)
+    (H3_EXPORT(getDestinationH3IndexFromUnidirectionalEdge)(edge),
+     &destination);
+    double threshold = 0.0001 *
+                       H3_EXPORT(edgeLengthKm)(H3_GET_RESOLUTION(edge)) /
+                       EARTH_RADIUS_KM;
+    int numShared = 0;
+    for (int i = 0; i < origin.numVerts; i++) {
+        for (int j = 0; j < destination.numVerts; j++) {
+            if (geoAlmostEqualThreshold(&origin.verts[i],
+                                        &destination.verts[j], threshold)) {
+                numShared++;
+                break;
+            }
+        }
+    }
+    t_assert(numVerts == numShared, "as many vertices as the cells share");
+    for (int v = 0; v < numVerts; v++) {
+        int found = 0;
+        for (int j = 0; j < destination.numVerts; j++) {
+            found |= geoAlmostEqualThreshold(&verts[v], &destination.verts[j],
+                                             threshold);
+        }
+        t_assert(found, "vertex is shared with the destination");
+    }
+}
+
+/**
+ * Checks the boundaries of every edge of some cells, one at a time and in a
+ * batch, against the vertices the cells share with their neighbors.
+ */
+static void assertEdgeBoundaries(const H3Index* cells, int numCells) {
+    H3Index* edges = calloc(6 * numCells, sizeof(H3Index));
+    double* verts = calloc(36 * numCells, sizeof(double));
+    int* numVerts = calloc(6 * numCells, sizeof(int));
+    H3_EXPORT(getH3UnidirectionalEdgesFromHexagonBatch)(cells, numCells, edges);
+    int total = H3_EXPORT(getH3UnidirectionalEdgeBoundariesFromHexagonBatch)(
+        cells, numCells, verts, numVerts);
+
+    int offset = 0;
+    for (int i = 0; i < numCells; i++) {
+        H3Index single[6];
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(cells[i], single);
+        for (int d = 0; d < 6; d++) {
+            H3Index edge = edges[6 * i + d];
+            t_assert(edge == single[d], "batch edge matches");
+            if (edge == 0) {
+                t_assert(numVerts[6 * i + d] == 0, "deleted edge is empty");
+                continue;
+            }
+            GeoBoundary gb;
+            H3_EXPORT(getH3UnidirectionalEdgeBoundary)(edge, &gb);
+            assertSharedVertices(edge, gb.verts, gb.numVerts);
+            t_assert(numVerts[6 * i + d] == gb.numVerts,
+                     "batch boundary has as many vertices");
+            for (int v = 0; v < gb.numVerts; v++, offset++) {
+                t_assert(verts[2 * offset] == gb.verts[v].lat &&
+                             verts[2 * offset + 1] == gb.verts[v].lon,
+                         "batch vertex matches");
+            }
+        }
+    }
+    t_assert(total == offset, "batch wrote every vertex");
+    free(numVerts);
+    free(verts);
+    free(edges);
+}
+
 BEGIN_TESTS(h3UniEdge);
 
 TEST(h3IndexesAreNeighbors) {
@@ -114,6 +194,49 @@ TEST(getH3UnidirectionalEdgeFromPentagon) {
     t_assert(edge != 0, "Produces a valid edge");
 }
 
+TEST(neighborsMatchKRing) {
+    // Every cell of the first two resolutions, which covers moves across
+    // base cells and around every pentagon.
+    for (int res = 0; res < 2; res++) {
+        for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+            H3Index parent;
+            setH3Index(&parent, 0, baseCell, 0);
+            H3Index children[7] = {0};
+            H3_EXPORT(h3ToChildren)(parent, res, children);
+            for (int c = 0; c < 7; c++) {
+                H3Index origin = children[c];
+                if (origin == 0) continue;
+                H3Index neighbors[7] = {0};
+                H3_EXPORT(kRing)(origin, 1, neighbors);
+                H3Index ring[19] = {0};
+                H3_EXPORT(kRing)(origin, 2, ring);
+                for (int i = 0; i < 19; i++) {
+                    if (ring[i] == 0) continue;
+                    int expected = 0;
+                    for (int j = 0; j < 7; j++) {
+                        if (neighbors[j] == ring[i] && ring[i] != origin) {
+                            expected = 1;
+                        }
+                    }
+                    t_assert(H3_EXPORT(h3IndexesAreNeighbors)(
+                                 origin, ring[i]) == expected,
+                             "neighbors match kRing");
+                    H3Index edge =
+                        H3_EXPORT(getH3UnidirectionalEdge)(origin, ring[i]);
+                    t_assert((edge != 0) == expected,
+                             "edge exists for neighbors only");
+                    if (edge != 0) {
+                        H3Index destination = H3_EXPORT(
+                            getDestinationH3IndexFromUnidirectionalEdge)(edge);
+                        t_assert(destination == ring[i],
+                                 "edge leads to the destination");
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST(h3UnidirectionalEdgeIsValid) {
     H3Index sf = H3_EXPORT(geoToH3)(&sfGeo, 9);
     H3Index* ring = calloc(H3_EXPORT(maxKringSize)(1), sizeof(H3Index));
@@ -220,4 +343,58 @@ TEST(getH3UnidirectionalEdgeBoundary) {
     free(edges);
 }
 
+TEST(edgeBoundariesMatchSharedVertices) {
+    // Every cell at resolutions 0 to 2, on every face and around every
+    // pentagon, in both classes
+    for (int res = 0; res <= 2; res++) {
+        H3Index* cells = calloc(NUM_BASE_CELLS * 49, sizeof(H3Index));
+        int numCells = 0;
+        for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+            H3Index base;
+            setH3Index(&base, 0, bc, 0);
+            int numChildren = H3_EXPORT(maxH3ToChildrenSize)(base, res);
+            H3_EXPORT(h3ToChildren)(base, res, cells + numCells);
+            for (int c = 0; c < numChildren; c++) {
+                if (cells[numCells]) numCells++;
+            }
+        }
+        assertEdgeBoundaries(cells, numCells);
+        free(cells);
+    }
+
+    // The cells around every pentagon and a hexagon at finer resolutions
+    H3Index ring[19];
+    for (int res = 3; res <= MAX_H3_RES; res++) {
+        for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+            if (!_isBaseCellPentagon(bc)) continue;
+            H3Index pentagon;
+            setH3Index(&pentagon, res, bc, 0);
+            for (int i = 0; i < 19; i++) ring[i] = 0;
+            H3_EXPORT(kRing)(pentagon, 2, ring);
+            int numCells = 0;
+            for (int i = 0; i < 19; i++) {
+                if (ring[i]) ring[numCells++] = ring[i];
+            }
+            assertEdgeBoundaries(ring, numCells);
+        }
+        H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(&sfGeo, res), 2, ring);
+        assertEdgeBoundaries(ring, 19);
+    }
+}
+
+TEST(getH3UnidirectionalEdgeBoundaryFineRes) {
+    H3Index edges[6];
+    GeoBoundary gb;
+    for (int res = 10; res <= MAX_H3_RES; res++) {
+        H3Index h = H3_EXPORT(geoToH3)(&sfGeo, res);
+        H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(h, edges);
+        for (int i = 0; i < 6; i++) {
+            H3_EXPORT(getH3UnidirectionalEdgeBoundary)(edges[i], &gb);
+            t_assert(gb.numVerts == 2,
+                     "Got the expected number of vertices back at a fine "
+                     "resolution");
+        }
+    }
+}
+
 END_TESTS();
@@ -182,4 +182,63 @@ TEST(hexRing_matches_kRingInternal) {
     }
 }
 
+TEST(iterMatchesHexRing) {
+    H3Index ring[6 * 4];
+    H3Index expected[6 * 4];
+    for (int res = 0; res < 2; res++) {
+        for (int i = 0; i < NUM_BASE_CELLS; i++) {
+            H3Index bc;
+            setH3Index(&bc, 0, i, 0);
+            int childrenSz = H3_EXPORT(maxUncompactSize)(&bc, 1, res);
+            H3Index *children = calloc(childrenSz, sizeof(H3Index));
+            H3_EXPORT(uncompact)(&bc, 1, children, childrenSz, res);
+
+            for (int j = 0; j < childrenSz; j++) {
+                if (children[j] == 0) {
+                    continue;
+                }
+
+                HexRingIterator iter;
+                H3_EXPORT(hexRingIterInit)(&iter, children[j]);
+                for (int k = 0; k < 5; k++) {
+                    int ringSz = k != 0 ? 6 * k : 1;
+                    int failed = H3_EXPORT(hexRingIterNext)(&iter, ring);
+                    int expectedFailed =
+                        H3_EXPORT(hexRing)(children[j], k, expected);
+                    t_assert(failed == expectedFailed,
+                             "iterator and hexRing agree on failure");
+                    if (failed) {
+                        t_assert(H3_EXPORT(hexRingIterNext)(&iter, ring) ==
+                                     failed,
+                                 "iterator stays failed");
+                        break;
+                    }
+                    t_assert(iter.ring == k + 1, "iterator advanced");
+                    for (int r = 0; r < ringSz; r++) {
+                        t_assert(ring[r] == expected[r],
+                                 "iterator and hexRing agree on output");
+                    }
+                }
+            }
+
+            free(children);
+        }
+    }
+}
+
+TEST(iterOnPentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 0, 4, 0);
+    H3Index out[6];
+
+    HexRingIterator iter;
+    H3_EXPORT(hexRingIterInit)(&iter, pentagon);
+    t_assert(H3_EXPORT(hexRingIterNext)(&iter, out) == 0,
+             "ring 0 succeeds on a pentagon");
+    t_assert(out[0] == pentagon, "ring 0 is the origin");
+    t_assert(H3_EXPORT(hexRingIterNext)(&iter, out) != 0,
+             "ring 1 fails on a pentagon");
+    t_assert(iter.ring == 1, "iterator did not advance past the failure");
+}
+
 END_TESTS();
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the enumeration of descendants by the hierarchy applications
+ *
+ *  usage: `testHierDump`
+ */
+
+#include <stdlib.h>
+#include "baseCells.h"
+#include "h3Index.h"
+#include "h3IndexSet.h"
+#include "hierDump.h"
+#include "test.h"
+
+#define MAX_SHARDS 8
+
+/** @brief The cells written to each shard */
+typedef struct {
+    H3IndexSet* sets[MAX_SHARDS];  ///< the cells of each shard
+    int numShards;                 ///< the number of shards opened
+    int numClosed;                 ///< the number of shards closed
+    int numCells[MAX_SHARDS];      ///< the cells written to each shard
+    int inOrder;                   ///< whether the cells were in order
+    H3Index last;                  ///< the last cell written to shard 0
+} Collected;
+
+/** @brief A shard of the collected cells */
+typedef struct {
+    Collected* collected;  ///< the cells of every shard
+    int shard;             ///< the shard
+} CollectedShard;
+
+CollectedShard shards[MAX_SHARDS];
+
+static void* openCollected(void* context, int shard, int numShards) {
+    Collected* collected = context;
+    t_assert(shard < numShards && numShards <= MAX_SHARDS, "shard in range");
+    collected->sets[shard] = H3_EXPORT(createH3IndexSet)(0);
+    collected->numShards++;
+    shards[shard].collected = collected;
+    shards[shard].shard = shard;
+    return &shards[shard];
+}
+
+static void writeCollected(void* shard, const H3Index* cells, int numCells) {
+    CollectedShard* s = shard;
+    Collected* collected = s->collected;
+    for (int i = 0; i < numCells; i++) {
+        if (s->shard == 0) {
+            if (cells[i] <= collected->last) collected->inOrder = 0;
+            collected->last = cells[i];
+        }
+        H3_EXPORT(h3IndexSetAdd)(collected->sets[s->shard], cells[i]);
+    }
+    collected->numCells[s->shard] += numCells;
+}
+
+static void closeCollected(void* shard) {
+    CollectedShard* s = shard;
+    s->collected->numClosed++;
+}
+
+/**
+ * Enumerates the descendants of a cell, checking they are each written once
+ * and are all valid descendants.
+ *
+ * @return The number of shards written
+ */
+static int checkDump(H3Index root, int res, int numThreads,
+                     long long expected) {
+    Collected collected = {{NULL}, 0, 0, {0}, 1, 0};
+    HierOutput output = {openCollected, writeCollected, closeCollected,
+                         &collected};
+    hierDump(root, res, numThreads, &output);
+    t_assert(collected.numClosed == collected.numShards,
+             "closed every shard");
+    long long numCells = 0;
+    for (int s = 0; s < collected.numShards; s++) {
+        numCells += collected.numCells[s];
+    }
+    t_assert(numCells == expected, "wrote every cell");
+
+    H3IndexSet* all = H3_EXPORT(createH3IndexSet)((int)numCells);
+    for (int s = 0; s < collected.numShards; s++) {
+        int n = H3_EXPORT(h3IndexSetSize)(collected.sets[s]);
+        H3Index* cells = calloc(n, sizeof(H3Index));
+        H3_EXPORT(h3IndexSetToArray)(collected.sets[s], cells);
+        int cellRes = root != 0 && H3_GET_RESOLUTION(root) > res
+                          ? H3_GET_RESOLUTION(root)
+                          : res;
+        int valid = 1;
+        int unique = 1;
+        for (int i = 0; i < n; i++) {
+            valid &= H3_EXPORT(h3IsValid)(cells[i]) &&
+                     H3_GET_RESOLUTION(cells[i]) == cellRes;
+            if (root != 0) {
+                valid &= H3_EXPORT(h3ToParent)(
+                             cells[i], H3_GET_RESOLUTION(root)) == root;
+            }
+            unique &= H3_EXPORT(h3IndexSetAdd)(all, cells[i]);
+        }
+        t_assert(valid, "cells are valid descendants");
+        t_assert(unique, "cells are written to one shard");
+        free(cells);
+        H3_EXPORT(destroyH3IndexSet)(collected.sets[s]);
+    }
+    t_assert(H3_EXPORT(h3IndexSetSize)(all) == expected, "cells are unique");
+    H3_EXPORT(destroyH3IndexSet)(all);
+    if (collected.numShards == 1) {
+        t_assert(collected.inOrder, "one shard is written in order");
+    }
+    return collected.numShards;
+}
+
+BEGIN_TESTS(hierDump);
+
+TEST(globe) {
+    // 2 + 120 * 7^res cells at each resolution
+    t_assert(checkDump(0, 0, 1, NUM_BASE_CELLS) == 1, "base cells");
+    t_assert(checkDump(0, 3, 1, 2 + 120 * 343) == 1, "one shard");
+    int numShards = checkDump(0, 3, 4, 2 + 120 * 343);
+#ifdef H3_APP_THREADS
+    t_assert(numShards == 4, "a shard per thread");
+#else
+    t_assert(numShards == 1, "one shard without threads");
+#endif
+}
+
+TEST(descendants) {
+    H3Index hexagon = 0x85283473fffffff;
+    H3Index pentagon = 0x820807fffffffff;
+    for (int numThreads = 1; numThreads <= 3; numThreads++) {
+        checkDump(hexagon, 5, numThreads, 1);
+        checkDump(hexagon, 3, numThreads, 1);
+        checkDump(hexagon, 9, numThreads, 7 * 7 * 7 * 7);
+        // 1 + 5 * (7^k - 1) / 6 descendants k resolutions finer
+        checkDump(pentagon, 6, numThreads, 1 + 5 * (7 * 7 * 7 * 7 - 1) / 6);
+    }
+}
+
+END_TESTS();
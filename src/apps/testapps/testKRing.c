@@ -14,17 +14,21 @@
  * limitations under the License.
  */
 /** @file
- * @brief tests H3 function `kRing` and `kRingDistances`
+ * @brief tests H3 function `kRing`, `kRingDistances` and `kRingOrdered`
  *
  *  usage: `testKRing`
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "algos.h"
 #include "baseCells.h"
 #include "h3Index.h"
 #include "test.h"
 
+// The size macro is a constant expression
+static H3Index kRing2[H3_MAX_KRING_SIZE(2)];
+
 BEGIN_TESTS(kRing);
 
 TEST(kRing0) {
@@ -258,6 +262,141 @@ TEST(kRing1_Pentagon_k4) {
     t_assert(k2present == 51, "pentagon has 50 neighbors");
 }
 
+TEST(kRing_Pentagon_k50) {
+    // Large k around a pentagon uses the internal algorithm, which must
+    // find every index once at its shortest distance.
+    H3Index pentagon;
+    setH3Index(&pentagon, 9, 4, 0);
+    const int k = 50;
+    int kSz = H3_EXPORT(maxKringSize)(k);
+    H3Index* neighbors = calloc(kSz, sizeof(H3Index));
+    int* distances = calloc(kSz, sizeof(int));
+    t_assert(H3_EXPORT(kRingDistances)(pentagon, k, neighbors, distances) == 0,
+             "large k-ring succeeds with heap working memory");
+
+    int ringSizes[51] = {0};
+    for (int i = 0; i < kSz; i++) {
+        if (neighbors[i] != 0) {
+            t_assert(distances[i] >= 0 && distances[i] <= k,
+                     "distance in range");
+            ringSizes[distances[i]]++;
+            for (int j = i + 1; j < kSz; j++) {
+                t_assert(neighbors[j] != neighbors[i], "index is unique");
+            }
+        }
+    }
+    t_assert(ringSizes[0] == 1, "origin found");
+    for (int ring = 1; ring <= k; ring++) {
+        t_assert(ringSizes[ring] == 5 * ring, "pentagon ring has 5k indexes");
+    }
+
+    // kRing takes its distances from the heap as well
+    H3Index* ring = calloc(kSz, sizeof(H3Index));
+    t_assert(H3_EXPORT(kRing)(pentagon, k, ring) == 0, "kRing succeeds");
+    for (int i = 0; i < kSz; i++) {
+        t_assert(ring[i] == neighbors[i], "kRing matches kRingDistances");
+    }
+
+    free(ring);
+    free(neighbors);
+    free(distances);
+}
+
+TEST(kRingWithScratch) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 9, 4, 0);
+    H3Index hexagon = 0x8928308280fffff;
+    H3Index origins[] = {pentagon, hexagon};
+    H3Scratch scratch = {0};
+    for (int o = 0; o < 2; o++) {
+        for (int k = 0; k < 8; k++) {
+            int kSz = H3_EXPORT(maxKringSize)(k);
+            H3Index* expected = calloc(kSz, sizeof(H3Index));
+            int* expectedDistances = calloc(kSz, sizeof(int));
+            H3_EXPORT(kRingDistances)
+            (origins[o], k, expected, expectedDistances);
+
+            // Outputs do not need to be zeroed
+            H3Index* neighbors = malloc(kSz * sizeof(H3Index));
+            int* distances = malloc(kSz * sizeof(int));
+            memset(neighbors, 0xff, kSz * sizeof(H3Index));
+            H3_EXPORT(kRingDistancesWithScratch)
+            (origins[o], k, neighbors, distances, &scratch);
+            for (int i = 0; i < kSz; i++) {
+                t_assert(neighbors[i] == expected[i],
+                         "kRingDistancesWithScratch matches kRingDistances");
+                if (expected[i] != 0) {
+                    t_assert(distances[i] == expectedDistances[i],
+                             "distances match");
+                }
+            }
+
+            memset(neighbors, 0xff, kSz * sizeof(H3Index));
+            H3_EXPORT(kRingWithScratch)(origins[o], k, neighbors, &scratch);
+            for (int i = 0; i < kSz; i++) {
+                t_assert(neighbors[i] == expected[i],
+                         "kRingWithScratch matches kRingDistances");
+            }
+
+            free(neighbors);
+            free(distances);
+            free(expected);
+            free(expectedDistances);
+        }
+    }
+    H3_EXPORT(destroyH3Scratch)(&scratch);
+}
+
+TEST(kRingOrdered) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 9, 4, 0);
+    H3Index nearPentagon = H3_EXPORT(h3ToParent)(pentagon, 8);
+    H3Index hexagon = 0x8928308280fffff;
+    H3Index deformed = 0x8108bffffffffff;
+    H3Index origins[] = {pentagon, nearPentagon, hexagon, deformed};
+    for (int o = 0; o < 4; o++) {
+        for (int k = 0; k < 6; k++) {
+            int kSz = H3_EXPORT(maxKringSize)(k);
+            H3Index* expected = calloc(kSz, sizeof(H3Index));
+            int* expectedDistances = calloc(kSz, sizeof(int));
+            H3_EXPORT(kRingDistances)
+            (origins[o], k, expected, expectedDistances);
+            int numExpected = 0;
+            for (int i = 0; i < kSz; i++) {
+                numExpected += expected[i] != 0;
+            }
+
+            // Output does not need to be zeroed
+            H3Index* out = malloc(kSz * sizeof(H3Index));
+            memset(out, 0xff, kSz * sizeof(H3Index));
+            int ringOffsets[7];
+            int numOut =
+                H3_EXPORT(kRingOrdered)(origins[o], k, out, ringOffsets);
+            t_assert(numOut == numExpected, "every index written densely");
+            t_assert(ringOffsets[0] == 0 && ringOffsets[k + 1] == numOut,
+                     "rings cover the output");
+            t_assert(out[0] == origins[o], "origin is first");
+            for (int ring = 0; ring <= k; ring++) {
+                t_assert(ringOffsets[ring] < ringOffsets[ring + 1],
+                         "ring is not empty");
+                for (int i = ringOffsets[ring]; i < ringOffsets[ring + 1];
+                     i++) {
+                    int j = 0;
+                    while (j < kSz && expected[j] != out[i]) j++;
+                    t_assert(j < kSz, "index is in the k-ring");
+                    t_assert(expectedDistances[j] == ring,
+                             "index is in the ring of its distance");
+                    expected[j] = 0;
+                }
+            }
+
+            free(out);
+            free(expected);
+            free(expectedDistances);
+        }
+    }
+}
+
 TEST(kRing_equals_kRingInternal) {
     // Check that kRingDistances output matches _kRingInternal,
     // since kRingDistances will sometimes use a different implementation.
@@ -327,6 +466,122 @@ TEST(kRing_equals_kRingInternal) {
     }
 }
 
+TEST(kRingsUnion) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 2, 4, 0);
+    H3Index sf = 0x89283080ddbffffL;
+    H3Index sfRing[7] = {0};
+    H3_EXPORT(kRing)(sf, 1, sfRing);
+    H3Index origins[] = {sf, sfRing[3], 0, pentagon, sf};
+    int numOrigins = 5;
+    int k = 3;
+
+    int maxIdx = H3_EXPORT(maxKringsUnionSize)(numOrigins, k);
+    H3Index* out = calloc(maxIdx, sizeof(H3Index));
+    int* distances = calloc(maxIdx, sizeof(int));
+    int numOut =
+        H3_EXPORT(kRingsUnion)(origins, numOrigins, k, out, distances);
+
+    // Expected: every index of every k-ring, at its smallest distance
+    int ringSize = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(ringSize, sizeof(H3Index));
+    int* ringDistances = calloc(ringSize, sizeof(int));
+    int numExpected = 0;
+    H3Index* expected = calloc(maxIdx, sizeof(H3Index));
+    int* expectedDistances = calloc(maxIdx, sizeof(int));
+    for (int o = 0; o < numOrigins; o++) {
+        if (origins[o] == 0) continue;
+        memset(ring, 0, ringSize * sizeof(H3Index));
+        H3_EXPORT(kRingDistances)(origins[o], k, ring, ringDistances);
+        for (int i = 0; i < ringSize; i++) {
+            if (ring[i] == 0) continue;
+            int j = 0;
+            while (j < numExpected && expected[j] != ring[i]) j++;
+            if (j == numExpected) {
+                expected[numExpected] = ring[i];
+                expectedDistances[numExpected] = ringDistances[i];
+                numExpected++;
+            } else if (ringDistances[i] < expectedDistances[j]) {
+                expectedDistances[j] = ringDistances[i];
+            }
+        }
+    }
+
+    t_assert(numOut == numExpected, "union has each index once");
+    for (int i = 0; i < numOut; i++) {
+        t_assert(i == 0 || distances[i - 1] <= distances[i],
+                 "union is ordered by distance");
+        int j = 0;
+        while (j < numExpected && expected[j] != out[i]) j++;
+        t_assert(j < numExpected, "index is in one of the k-rings");
+        t_assert(distances[i] == expectedDistances[j],
+                 "distance to the nearest origin");
+    }
+
+    t_assert(H3_EXPORT(kRingsUnion)(origins, 0, k, out, distances) == 0,
+             "no origins gives no indexes");
+
+    free(expectedDistances);
+    free(expected);
+    free(ringDistances);
+    free(ring);
+    free(distances);
+    free(out);
+}
+
+TEST(maxKringSize) {
+    int64_t expected = 1;
+    for (int k = 0; k < 1000; k++) {
+        t_assert(H3_EXPORT(maxKringSize)(k) == expected, "closed form");
+        t_assert(H3_EXPORT(maxKringSize64)(k) == expected,
+                 "64 bit closed form");
+        expected += 6 * (k + 1);
+    }
+    t_assert(H3_EXPORT(maxKringSize)(-1) == 1, "negative k");
+    t_assert(sizeof(kRing2) / sizeof(kRing2[0]) == 19, "macro size");
+
+    t_assert(H3_EXPORT(maxKringSize)(H3_MAX_KRING_K) == 2147409811,
+             "largest size fitting an int");
+    t_assert(H3_EXPORT(maxKringSize)(H3_MAX_KRING_K + 1) == -1,
+             "int overflow is reported");
+    t_assert(H3_EXPORT(maxKringSize64)(H3_MAX_KRING_K + 1) == 2147570341,
+             "64 bit size past the int range");
+    t_assert(H3_EXPORT(maxKringSize64)(H3_MAX_KRING_K64) ==
+                 INT64_C(9223372029593538241),
+             "largest size fitting an int64_t");
+    t_assert(H3_EXPORT(maxKringSize64)(H3_MAX_KRING_K64 + 1) == -1,
+             "64 bit overflow is reported");
+    t_assert(H3_EXPORT(maxKringSize64)(INT32_MAX) == -1,
+             "64 bit overflow of the largest k is reported");
+}
+
+TEST(kRingSizeOverflow) {
+    // k whose k-ring does not fit in an int is rejected without writing
+    H3Index origin = 0x8928308280fffffL;
+    int k = H3_MAX_KRING_K + 1;
+    H3Index out[1] = {0};
+    int distances[1] = {0};
+    int ringOffsets[1] = {0};
+    t_assert(H3_EXPORT(kRing)(origin, k, out) == -1,
+             "kRing reports the overflow");
+    t_assert(out[0] == 0, "kRing writes nothing");
+    t_assert(H3_EXPORT(kRingDistances)(origin, k, out, distances) == -1,
+             "kRingDistances reports the overflow");
+    t_assert(out[0] == 0, "kRingDistances writes nothing");
+    t_assert(H3_EXPORT(kRingOrdered)(origin, k, out, ringOffsets) == -1,
+             "kRingOrdered reports the overflow");
+    t_assert(out[0] == 0, "kRingOrdered writes nothing");
+    t_assert(H3_EXPORT(hexRanges)(&origin, 1, k, out) != 0,
+             "hexRanges reports the overflow");
+    t_assert(out[0] == 0, "hexRanges writes nothing");
+
+    t_assert(H3_EXPORT(maxKringsUnionSize)(1, k) == -1,
+             "union size overflow of k is reported");
+    t_assert(H3_EXPORT(maxKringsUnionSize)(2, H3_MAX_KRING_K) == -1,
+             "union size overflow of the origins is reported");
+    t_assert(H3_EXPORT(maxKringsUnionSize)(3, 2) == 57, "union size");
+}
+
 TEST(h3NeighborRotations_identity) {
     // This is undefined behavior, but it's helpful for it to make sense.
     H3Index origin = 0x811d7ffffffffffL;
@@ -18,6 +18,10 @@
 #include "h3Index.h"
 #include "test.h"
 
+// The size macros are constant expressions
+static H3Index grandchildren[H3_MAX_CHILDREN_SIZE(7, 9)];
+static int64_t res15Count[H3_NUM_HEXAGONS(15) == 569707381193162 ? 1 : -1];
+
 BEGIN_TESTS(maxH3ToChildrenSize);
 
 GeoCoord sf = {0.659966917655, 2 * 3.14159 - 2.1364398519396};
@@ -33,6 +37,31 @@ TEST(maxH3ToChildrenSize) {
              "got expected size for child res");
     t_assert(H3_EXPORT(maxH3ToChildrenSize)(parent, 9) == 7 * 7,
              "got expected size for grandchild res");
+    t_assert(sizeof(grandchildren) / sizeof(grandchildren[0]) == 49,
+             "macro gives the grandchild size");
+    (void)res15Count;
+}
+
+TEST(maxH3ToChildrenSize64) {
+    H3Index res0;
+    setH3Index(&res0, 0, 0, 0);
+    int64_t expected = 1;
+    for (int childRes = 0; childRes <= MAX_H3_RES; childRes++) {
+        t_assert(H3_EXPORT(maxH3ToChildrenSize64)(res0, childRes) == expected,
+                 "64 bit size is a power of 7");
+        t_assert(H3_MAX_CHILDREN_SIZE(0, childRes) == expected,
+                 "macro size is a power of 7");
+        t_assert(H3_EXPORT(maxH3ToChildrenSize)(res0, childRes) ==
+                     (childRes < 12 ? (int)expected : -1),
+                 "int size is -1 when it does not fit");
+        expected *= 7;
+    }
+    t_assert(H3_EXPORT(maxH3ToChildrenSize64)(res0, 16) == 0,
+             "invalid child resolution");
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        t_assert(H3_NUM_HEXAGONS(res) == H3_EXPORT(numHexagons)(res),
+                 "macro gives numHexagons");
+    }
 }
 
 END_TESTS();
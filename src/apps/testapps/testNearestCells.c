@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests H3 functions `nearestCellsIterInit`, `nearestCellsIterNext`
+ * and `nearestCellsIterDestroy`
+ *
+ *  usage: `testNearestCells`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+
+/** An index with the distance of its center from a point */
+typedef struct {
+    double distanceKm;
+    H3Index h;
+} Candidate;
+
+static int compareCandidates(const void* a, const void* b) {
+    const Candidate* ca = a;
+    const Candidate* cb = b;
+    if (ca->distanceKm != cb->distanceKm) {
+        return ca->distanceKm < cb->distanceKm ? -1 : 1;
+    }
+    return (ca->h > cb->h) - (ca->h < cb->h);
+}
+
+/**
+ * Checks the first numNearest indexes of the walk against sorting a k-ring
+ * around the point much larger than they need, by distance.
+ */
+static void assertMatchesSortedKRing(const GeoCoord* point, int res,
+                                     int numNearest, int k) {
+    int ringSize = H3_EXPORT(maxKringSize)(k);
+    H3Index* ring = calloc(ringSize, sizeof(H3Index));
+    H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(point, res), k, ring);
+    Candidate* expected = calloc(ringSize, sizeof(Candidate));
+    int numExpected = 0;
+    for (int i = 0; i < ringSize; i++) {
+        if (ring[i] == 0) continue;
+        GeoCoord center;
+        H3_EXPORT(h3ToGeo)(ring[i], &center);
+        expected[numExpected].distanceKm = _geoDistKm(point, &center);
+        expected[numExpected].h = ring[i];
+        numExpected++;
+    }
+    qsort(expected, numExpected, sizeof(Candidate), compareCandidates);
+    t_assert(numNearest < numExpected / 2, "k-ring large enough");
+
+    NearestCellsIterator* iter = H3_EXPORT(nearestCellsIterInit)(point, res);
+    t_assert(iter != NULL, "iterator created");
+    H3Index* out = calloc(numNearest, sizeof(H3Index));
+    double* distances = calloc(numNearest, sizeof(double));
+    t_assert(H3_EXPORT(nearestCellsIterNext)(iter, out, distances,
+                                             numNearest) == numNearest,
+             "filled the buffer");
+    for (int i = 0; i < numNearest; i++) {
+        t_assert(out[i] == expected[i].h, "nearest in order");
+        t_assert(distances[i] == expected[i].distanceKm, "distance reported");
+    }
+
+    // Continuing one at a time, without distances
+    for (int i = numNearest; i < numNearest + 10; i++) {
+        H3Index h;
+        t_assert(H3_EXPORT(nearestCellsIterNext)(iter, &h, NULL, 1) == 1,
+                 "wrote the next");
+        t_assert(h == expected[i].h, "next nearest");
+    }
+
+    H3_EXPORT(nearestCellsIterDestroy)(iter);
+    free(distances);
+    free(out);
+    free(expected);
+    free(ring);
+}
+
+BEGIN_TESTS(nearestCells);
+
+TEST(nearestToPoints) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    assertMatchesSortedKRing(&sf, 9, 300, 20);
+    assertMatchesSortedKRing(&sf, 3, 200, 20);
+    GeoCoord north = {1.4, 0.5};
+    assertMatchesSortedKRing(&north, 6, 300, 20);
+}
+
+TEST(nearestToPentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 5, 24, 0);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(pentagon, &center);
+    assertMatchesSortedKRing(&center, 5, 300, 20);
+    center.lon += 0.003;
+    assertMatchesSortedKRing(&center, 6, 300, 20);
+}
+
+TEST(nearerThanContaining) {
+    // The center of a neighbor of the containing index is nearer this point
+    GeoCoord point = {0.66821863398110815, -2.1351844928295245};
+    t_assert(H3_EXPORT(geoToH3)(&point, 9) == 0x89283005cdbffff,
+             "contained in the expected index");
+    NearestCellsIterator* iter = H3_EXPORT(nearestCellsIterInit)(&point, 9);
+    H3Index nearest;
+    t_assert(H3_EXPORT(nearestCellsIterNext)(iter, &nearest, NULL, 1) == 1,
+             "wrote the nearest");
+    t_assert(nearest == 0x892830051afffff, "nearest is the neighbor");
+    H3_EXPORT(nearestCellsIterDestroy)(iter);
+    assertMatchesSortedKRing(&point, 9, 100, 12);
+}
+
+TEST(exhausted) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    NearestCellsIterator* iter = H3_EXPORT(nearestCellsIterInit)(&sf, 0);
+    H3Index out[NUM_BASE_CELLS + 1];
+    double distances[NUM_BASE_CELLS + 1];
+    t_assert(H3_EXPORT(nearestCellsIterNext)(iter, out, distances,
+                                             NUM_BASE_CELLS + 1) ==
+                 NUM_BASE_CELLS,
+             "every base cell");
+    for (int i = 1; i < NUM_BASE_CELLS; i++) {
+        t_assert(distances[i - 1] <= distances[i], "in order of distance");
+        for (int j = 0; j < i; j++) {
+            t_assert(out[i] != out[j], "each base cell once");
+        }
+    }
+    t_assert(distances[NUM_BASE_CELLS - 1] < M_PI * EARTH_RADIUS_KM,
+             "distances on the sphere");
+    t_assert(H3_EXPORT(nearestCellsIterNext)(iter, out, distances, 1) == 0,
+             "nothing after every base cell");
+    H3_EXPORT(nearestCellsIterDestroy)(iter);
+}
+
+TEST(invalidArguments) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    GeoCoord invalid = {NAN, 0};
+    t_assert(H3_EXPORT(nearestCellsIterInit)(&sf, -1) == NULL,
+             "negative res");
+    t_assert(H3_EXPORT(nearestCellsIterInit)(&sf, 16) == NULL,
+             "res too high");
+    t_assert(H3_EXPORT(nearestCellsIterInit)(&invalid, 9) == NULL,
+             "invalid point");
+}
+
+END_TESTS();
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests the pipelines of h3pipe
+ *
+ *  usage: `testPipeline`
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binaryIO.h"
+#include "pipeline.h"
+#include "test.h"
+#include "utility.h"
+
+/** number of coordinates, more than fit one batch */
+#define NUM_COORDS 10000
+
+/**
+ * Parses stages, asserting they are valid.
+ */
+static int parseStages(const char** specs, int numSpecs, PipeStage* stages) {
+    for (int s = 0; s < numSpecs; s++) {
+        t_assert(pipeParseStage(specs[s], &stages[s]) == 0, "stage parsed");
+    }
+    return numSpecs;
+}
+
+/**
+ * Runs a pipeline on the contents of a file, returning the output, which
+ * the caller must free.
+ */
+static char* runPipeline(const PipeStage* stages, int numStages, int binary,
+                         int numWorkers, FILE* in, long* outSize) {
+    PipeOptions options = {binary, numWorkers};
+    t_assert(pipeCheck(stages, numStages, &options) == NULL, "can run");
+    FILE* out = tmpfile();
+    t_assert(out != NULL, "opened output");
+    rewind(in);
+    pipeRun(stages, numStages, &options, in, out);
+    *outSize = ftell(out);
+    char* text = calloc(*outSize + 1, 1);
+    rewind(out);
+    t_assert(fread(text, 1, *outSize, out) == (size_t)*outSize, "read output");
+    fclose(out);
+    return text;
+}
+
+/**
+ * Generates coordinates spread over the globe, in degrees.
+ */
+static void makeCoords(double* lat, double* lon) {
+    for (int i = 0; i < NUM_COORDS; i++) {
+        lat[i] = -89.0 + 178.0 * ((i * 7919) % NUM_COORDS) / NUM_COORDS;
+        lon[i] = -180.0 + 360.0 * ((i * 104729) % NUM_COORDS) / NUM_COORDS;
+    }
+}
+
+BEGIN_TESTS(pipeline);
+
+TEST(parseStage) {
+    PipeStage stage;
+    t_assert(pipeParseStage("encode:9", &stage) == 0, "encode parsed");
+    t_assert(stage.arg == 9 && stage.input == PIPE_COORDS &&
+                 stage.output == PIPE_INDEXES,
+             "encode stage");
+    t_assert(pipeParseStage("kring:0", &stage) == 0, "k of 0 parsed");
+    t_assert(pipeParseStage("center", &stage) == 0, "center parsed");
+    t_assert(stage.output == PIPE_COORDS, "center writes coordinates");
+
+    t_assert(pipeParseStage("encode", &stage), "missing argument");
+    t_assert(pipeParseStage("encode:", &stage), "empty argument");
+    t_assert(pipeParseStage("encode:16", &stage), "resolution out of range");
+    t_assert(pipeParseStage("kring:-1", &stage), "negative k");
+    t_assert(pipeParseStage("kring:2x", &stage), "trailing characters");
+    t_assert(pipeParseStage("center:1", &stage), "unexpected argument");
+    t_assert(pipeParseStage("encoder:9", &stage), "unknown stage");
+    t_assert(pipeParseStage("", &stage), "empty stage");
+}
+
+TEST(check) {
+    PipeOptions text = {0, 1};
+    PipeOptions binary = {1, 1};
+    PipeStage stages[3];
+    const char* chained[] = {"encode:9", "kring:1", "boundary"};
+    parseStages(chained, 3, stages);
+    t_assert(pipeCheck(stages, 3, &text) == NULL, "stages chain");
+    t_assert(pipeCheck(stages, 3, &binary) != NULL,
+             "boundaries have no binary output");
+    t_assert(pipeCheck(stages, 0, &text) != NULL, "no stages");
+
+    const char* unchained[] = {"encode:9", "encode:9"};
+    parseStages(unchained, 2, stages);
+    t_assert(pipeCheck(stages, 2, &text) != NULL, "stages do not chain");
+
+    const char* expanding[] = {"kring:100", "kring:100"};
+    parseStages(expanding, 2, stages);
+    t_assert(pipeCheck(stages, 2, &text) != NULL, "expands too much");
+}
+
+TEST(textMatchesFilters) {
+    static double lat[NUM_COORDS];
+    static double lon[NUM_COORDS];
+    makeCoords(lat, lon);
+    FILE* in = tmpfile();
+    for (int i = 0; i < NUM_COORDS; i++) {
+        fprintf(in, "%.10lf %.10lf\n", lat[i], lon[i]);
+    }
+
+    // the output of geoToH3 9 | kRing 1
+    FILE* expected = tmpfile();
+    H3Index ring[7];
+    for (int i = 0; i < NUM_COORDS; i++) {
+        GeoCoord g;
+        setGeoDegs(&g, lat[i], lon[i]);
+        memset(ring, 0, sizeof(ring));
+        H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(&g, 9), 1, ring);
+        for (int r = 0; r < 7; r++) {
+            if (ring[r] != 0) fprintf(expected, "%" PRIx64 "\n", ring[r]);
+        }
+    }
+    long expectedSize = ftell(expected);
+    char* expectedText = calloc(expectedSize + 1, 1);
+    rewind(expected);
+    t_assert(fread(expectedText, 1, expectedSize, expected) ==
+                 (size_t)expectedSize,
+             "read expected output");
+
+    PipeStage stages[2];
+    const char* specs[] = {"encode:9", "kring:1"};
+    parseStages(specs, 2, stages);
+    for (int numWorkers = 0; numWorkers <= 3; numWorkers++) {
+        long size;
+        char* text = runPipeline(stages, 2, 0, numWorkers, in, &size);
+        t_assert(size == expectedSize && strcmp(text, expectedText) == 0,
+                 "output matches the filters, in order");
+        free(text);
+    }
+
+    free(expectedText);
+    fclose(expected);
+    fclose(in);
+}
+
+TEST(binary) {
+    static double lat[NUM_COORDS];
+    static double lon[NUM_COORDS];
+    static double centerLat[NUM_COORDS];
+    static double centerLon[NUM_COORDS];
+    makeCoords(lat, lon);
+    FILE* in = tmpfile();
+    binaryWriteCoords(in, lat, lon, NUM_COORDS);
+
+    PipeStage stages[3];
+    const char* specs[] = {"encode:10", "parent:7", "center"};
+    parseStages(specs, 3, stages);
+    for (int numWorkers = 0; numWorkers <= 2; numWorkers++) {
+        long size;
+        char* out = runPipeline(stages, 3, 1, numWorkers, in, &size);
+        t_assert(size == NUM_COORDS * 2 * (long)sizeof(double),
+                 "a center per coordinate");
+
+        FILE* centers = tmpfile();
+        fwrite(out, 1, size, centers);
+        rewind(centers);
+        int n = 0;
+        int count;
+        while ((count = binaryReadCoords(centers, &centerLat[n],
+                                         &centerLon[n],
+                                         NUM_COORDS - n)) > 0) {
+            n += count;
+        }
+        t_assert(n == NUM_COORDS, "read every center");
+        for (int i = 0; i < NUM_COORDS; i++) {
+            GeoCoord g;
+            setGeoDegs(&g, lat[i], lon[i]);
+            H3Index parent =
+                H3_EXPORT(h3ToParent)(H3_EXPORT(geoToH3)(&g, 10), 7);
+            GeoCoord center;
+            H3_EXPORT(h3ToGeo)(parent, &center);
+            t_assert(centerLat[i] == H3_EXPORT(radsToDegs)(center.lat) &&
+                         centerLon[i] == H3_EXPORT(radsToDegs)(center.lon),
+                     "center of the parent, in order");
+        }
+        fclose(centers);
+        free(out);
+    }
+    fclose(in);
+}
+
+TEST(boundary) {
+    FILE* in = tmpfile();
+    fprintf(in, "85283473fffffff\n");
+    PipeStage stages[1];
+    const char* specs[] = {"boundary"};
+    parseStages(specs, 1, stages);
+    long size;
+    char* text = runPipeline(stages, 1, 0, 1, in, &size);
+
+    GeoBoundary b;
+    H3_EXPORT(h3ToGeoBoundary)(0x85283473fffffff, &b);
+    char expected[BUFF_SIZE];
+    int length = snprintf(expected, BUFF_SIZE, "85283473fffffff\n{\n");
+    for (int v = 0; v < b.numVerts; v++) {
+        length += snprintf(&expected[length], BUFF_SIZE - length,
+                           "   %.9lf %.9lf\n",
+                           H3_EXPORT(radsToDegs)(b.verts[v].lat),
+                           H3_EXPORT(radsToDegs)(b.verts[v].lon));
+    }
+    snprintf(&expected[length], BUFF_SIZE - length, "}\n");
+    t_assert(strcmp(text, expected) == 0,
+             "boundary in the format of h3ToGeoBoundary");
+    free(text);
+
+    // empty input, empty output
+    FILE* empty = tmpfile();
+    text = runPipeline(stages, 1, 0, 2, empty, &size);
+    t_assert(size == 0, "no output for no input");
+    free(text);
+    fclose(empty);
+    fclose(in);
+}
+
+END_TESTS();
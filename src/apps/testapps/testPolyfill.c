@@ -14,13 +14,100 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include <stdlib.h>
 #include "algos.h"
+#include "baseCells.h"
 #include "constants.h"
 #include "geoCoord.h"
 #include "h3Index.h"
+#include "h3IndexSet.h"
 #include "test.h"
 
+/**
+ * Checks polyfillCoverage of a polygon: the coverage is compacted, holds
+ * every hexagon whose center is in the polygon or that contains a point of
+ * its boundary, and holds no other hexagon that is not next to one
+ * containing its boundary.
+ */
+static void assertCoverage(const GeoPolygon* polygon, int res) {
+    int numCompacted = H3_EXPORT(polyfillCoverage)(polygon, res, NULL, 0);
+    H3Index* compacted = malloc(numCompacted * sizeof(H3Index));
+    t_assert(H3_EXPORT(polyfillCoverage)(polygon, res, compacted,
+                                         numCompacted) == numCompacted,
+             "got same size with a buffer");
+    int numCovered =
+        H3_EXPORT(maxUncompactSize)(compacted, numCompacted, res);
+    H3Index* covered = malloc(numCovered * sizeof(H3Index));
+    t_assert(H3_EXPORT(uncompact)(compacted, numCompacted, covered,
+                                  numCovered, res) == 0,
+             "coverage uncompacts");
+    H3Index* recompacted = calloc(numCovered, sizeof(H3Index));
+    t_assert(H3_EXPORT(compact)(covered, recompacted, numCovered) == 0,
+             "coverage compacts");
+    int numRecompacted = 0;
+    for (int i = 0; i < numCovered; i++) {
+        numRecompacted += recompacted[i] != 0;
+    }
+    t_assert(numRecompacted == numCompacted, "coverage is compacted");
+
+    H3IndexSet* coverage = H3_EXPORT(createH3IndexSet)(numCovered);
+    for (int i = 0; i < numCovered; i++) {
+        t_assert(H3_EXPORT(h3IndexSetAdd)(coverage, covered[i]),
+                 "hexagon covered once");
+    }
+
+    int numFilled = H3_EXPORT(polyfillDense)(polygon, res, NULL, 0);
+    H3Index* filled = malloc(numFilled * sizeof(H3Index));
+    H3_EXPORT(polyfillDense)(polygon, res, filled, numFilled);
+    H3IndexSet* near = H3_EXPORT(createH3IndexSet)(numFilled);
+    for (int i = 0; i < numFilled; i++) {
+        t_assert(H3_EXPORT(h3IndexSetContains)(coverage, filled[i]),
+                 "hexagon with its center in the polygon is covered");
+        H3_EXPORT(h3IndexSetAdd)(near, filled[i]);
+    }
+
+    // Sample the boundary much more finely than the hexagons
+    double step = H3_EXPORT(edgeLengthKm)(res) / EARTH_RADIUS_KM / 8;
+    for (int ring = 0; ring <= polygon->numHoles; ring++) {
+        const Geofence* geofence =
+            ring == 0 ? &polygon->geofence : &polygon->holes[ring - 1];
+        for (int i = 0; i < geofence->numVerts; i++) {
+            const GeoCoord* a = &geofence->verts[i];
+            const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+            double dLat = b->lat - a->lat;
+            double dLon = b->lon - a->lon;
+            if (dLon > M_PI) dLon -= 2 * M_PI;
+            if (dLon < -M_PI) dLon += 2 * M_PI;
+            int numSteps = (int)ceil(hypot(dLat, dLon) / step) + 1;
+            for (int s = 0; s <= numSteps; s++) {
+                double t = (double)s / numSteps;
+                GeoCoord sample = {a->lat + t * dLat,
+                                   constrainLng(a->lon + t * dLon)};
+                H3Index h = H3_EXPORT(geoToH3)(&sample, res);
+                t_assert(H3_EXPORT(h3IndexSetContains)(coverage, h),
+                         "hexagon on the boundary is covered");
+                H3Index ringCells[7] = {0};
+                H3_EXPORT(kRing)(h, 1, ringCells);
+                for (int j = 0; j < 7; j++) {
+                    H3_EXPORT(h3IndexSetAdd)(near, ringCells[j]);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < numCovered; i++) {
+        t_assert(H3_EXPORT(h3IndexSetContains)(near, covered[i]),
+                 "covered hexagon is near the polygon");
+    }
+
+    H3_EXPORT(destroyH3IndexSet)(near);
+    H3_EXPORT(destroyH3IndexSet)(coverage);
+    free(filled);
+    free(recompacted);
+    free(covered);
+    free(compacted);
+}
+
 // Fixtures
 GeoCoord sfVerts[] = {
     {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
@@ -98,15 +185,60 @@ transMeridianFilledHoleGeoPolygon.numHoles = 0;
 
 TEST(maxPolyfillSize) {
     int numHexagons = H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, 9);
-    t_assert(numHexagons == 3169, "got expected max polyfill size");
+    t_assert(numHexagons == 3997, "got expected max polyfill size");
 
     numHexagons = H3_EXPORT(maxPolyfillSize)(&holeGeoPolygon, 9);
-    t_assert(numHexagons == 3169, "got expected max polyfill size (hole)");
+    t_assert(numHexagons == 3997, "got expected max polyfill size (hole)");
 
     numHexagons = H3_EXPORT(maxPolyfillSize)(&emptyGeoPolygon, 9);
     t_assert(numHexagons == 1, "got expected max polyfill size (empty)");
 }
 
+TEST(maxPolyfillSizeCoversPolyfill) {
+    const GeoPolygon* polygons[] = {&sfGeoPolygon, &holeGeoPolygon,
+                                    &primeMeridianGeoPolygon,
+                                    &transMeridianHoleGeoPolygon};
+    for (int p = 0; p < 4; p++) {
+        for (int res = 0; res <= 10; res++) {
+            t_assert(H3_EXPORT(maxPolyfillSize)(polygons[p], res) >=
+                         H3_EXPORT(polyfillDense)(polygons[p], res, NULL, 0),
+                     "max size holds the polyfill");
+        }
+    }
+
+    // Boxes around pentagons, where the hexagons are smallest and shrink
+    // away from the center of the box
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        if (!_isBaseCellPentagon(baseCell)) continue;
+        for (int res = 5; res <= 8; res++) {
+            H3Index pentagon;
+            setH3Index(&pentagon, res, baseCell, 0);
+            GeoCoord center;
+            H3_EXPORT(h3ToGeo)(pentagon, &center);
+            if (fabs(center.lat) > 1.4) continue;
+            // Offset from the pentagon, so it is not at the center
+            double size = 10 * H3_EXPORT(edgeLengthKm)(res) / EARTH_RADIUS_KM;
+            double lat = center.lat + size / 2;
+            double lon = center.lon - size / 3;
+            GeoCoord verts[] = {{lat - size, constrainLng(lon - size)},
+                                {lat - size, constrainLng(lon + size)},
+                                {lat + size, constrainLng(lon + size)},
+                                {lat + size, constrainLng(lon - size)}};
+            GeoPolygon box = {{4, verts}, 0, NULL};
+            t_assert(H3_EXPORT(maxPolyfillSize)(&box, res) >=
+                         H3_EXPORT(polyfillDense)(&box, res, NULL, 0),
+                     "max size holds the polyfill near a pentagon");
+        }
+    }
+}
+
+TEST(maxPolyfillSizeInvalidRes) {
+    t_assert(H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, -1) == 0,
+             "no hexagons below resolution 0");
+    t_assert(H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, MAX_H3_RES + 1) == 0,
+             "no hexagons above resolution 15");
+}
+
 TEST(polyfill) {
     int numHexagons = H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, 9);
     H3Index* hexagons = calloc(numHexagons, sizeof(H3Index));
@@ -139,6 +271,219 @@ TEST(polyfillHole) {
     free(hexagons);
 }
 
+TEST(polyfillDense) {
+    int numHexagons = H3_EXPORT(polyfillDense)(&holeGeoPolygon, 9, NULL, 0);
+    t_assert(numHexagons == 1214, "got polyfill size without a buffer");
+
+    H3Index* hexagons = malloc(numHexagons * sizeof(H3Index));
+    int numWritten =
+        H3_EXPORT(polyfillDense)(&holeGeoPolygon, 9, hexagons, numHexagons);
+    t_assert(numWritten == numHexagons, "got same size with a buffer");
+    for (int i = 0; i < numHexagons; i++) {
+        t_assert(hexagons[i] != 0, "output is dense");
+    }
+
+    H3Index* small = malloc(100 * sizeof(H3Index));
+    t_assert(H3_EXPORT(polyfillDense)(&holeGeoPolygon, 9, small, 100) ==
+                 numHexagons,
+             "got full size with a small buffer");
+    for (int i = 0; i < 100; i++) {
+        t_assert(small[i] == hexagons[i], "small buffer has a prefix");
+    }
+
+    free(small);
+    free(hexagons);
+}
+
+TEST(polyfillInvalidRes) {
+    H3Index hexagons[1] = {0};
+    t_assert(H3_EXPORT(polyfillDense)(&sfGeoPolygon, -1, hexagons, 1) == 0,
+             "no hexagons below resolution 0");
+    t_assert(H3_EXPORT(polyfillDense)(&sfGeoPolygon, MAX_H3_RES + 1,
+                                      hexagons, 1) == 0,
+             "no hexagons above resolution 15");
+    H3_EXPORT(polyfill)(&sfGeoPolygon, -1, hexagons);
+    H3_EXPORT(polyfill)(&sfGeoPolygon, MAX_H3_RES + 1, hexagons);
+    t_assert(hexagons[0] == 0, "polyfill writes nothing at invalid res");
+}
+
+TEST(polyfillCoverage) {
+    assertCoverage(&sfGeoPolygon, 9);
+    assertCoverage(&holeGeoPolygon, 10);
+    assertCoverage(&transMeridianHoleGeoPolygon, 6);
+    assertCoverage(&primeMeridianGeoPolygon, 5);
+
+    int numHexagons = H3_EXPORT(polyfillCoverage)(&holeGeoPolygon, 11, NULL, 0);
+    t_assert(numHexagons <
+                 H3_EXPORT(polyfillDense)(&holeGeoPolygon, 11, NULL, 0),
+             "coverage is compacted");
+    H3Index* hexagons = malloc(numHexagons * sizeof(H3Index));
+    H3_EXPORT(polyfillCoverage)(&holeGeoPolygon, 11, hexagons, numHexagons);
+    H3Index small[100];
+    t_assert(H3_EXPORT(polyfillCoverage)(&holeGeoPolygon, 11, small, 100) ==
+                 numHexagons,
+             "got full size with a small buffer");
+    for (int i = 0; i < 100; i++) {
+        t_assert(small[i] == hexagons[i], "small buffer has a prefix");
+    }
+    free(hexagons);
+
+    // A polygon inside one hexagon, away from its center, covers it alone
+    H3Index h = 0x85283473fffffff;
+    GeoBoundary boundary;
+    H3_EXPORT(h3ToGeoBoundary)(h, &boundary);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(h, &center);
+    // Boundary longitudes may be outside [-pi, pi]
+    GeoCoord tinyVerts[3];
+    for (int i = 0; i < 3; i++) {
+        tinyVerts[i].lat = center.lat + 0.7 * (boundary.verts[0].lat -
+                                              center.lat) +
+                           0.05 * (boundary.verts[i + 1].lat - center.lat);
+        tinyVerts[i].lon = constrainLng(
+            center.lon + 0.7 * (boundary.verts[0].lon - center.lon) +
+            0.05 * (boundary.verts[i + 1].lon - center.lon));
+    }
+    GeoPolygon tiny = {{3, tinyVerts}, 0, NULL};
+    H3Index out[2];
+    t_assert(H3_EXPORT(polyfillCoverage)(&tiny, 5, out, 2) == 1 &&
+                 out[0] == h,
+             "polygon inside a hexagon covers it");
+    t_assert(H3_EXPORT(polyfillDense)(&tiny, 5, out, 2) == 0,
+             "polygon inside a hexagon does not contain its center");
+
+    t_assert(H3_EXPORT(polyfillCoverage)(&sfGeoPolygon, 16, out, 2) == 0,
+             "invalid resolution covers nothing");
+    t_assert(H3_EXPORT(polyfillCoverage)(&emptyGeoPolygon, 9, out, 2) <= 1,
+             "degenerate polygon covers at most one hexagon");
+}
+
+TEST(polyfillIter) {
+    int numHexagons = H3_EXPORT(polyfillDense)(&holeGeoPolygon, 9, NULL, 0);
+    H3Index* hexagons = malloc(numHexagons * sizeof(H3Index));
+    H3_EXPORT(polyfillDense)(&holeGeoPolygon, 9, hexagons, numHexagons);
+
+    PolyfillIterator* iter = H3_EXPORT(polyfillIterInit)(&holeGeoPolygon, 9);
+    t_assert(iter != NULL, "created iterator");
+    H3Index chunk[100];
+    int numSeen = 0;
+    int numWritten;
+    while ((numWritten = H3_EXPORT(polyfillIterNext)(iter, chunk, 100)) > 0) {
+        for (int i = 0; i < numWritten; i++) {
+            t_assert(numSeen + i < numHexagons, "iterator is not too long");
+            t_assert(chunk[i] == hexagons[numSeen + i],
+                     "iterator matches polyfillDense");
+        }
+        numSeen += numWritten;
+    }
+    t_assert(numSeen == numHexagons, "iterator produced every hexagon");
+    t_assert(H3_EXPORT(polyfillIterNext)(iter, chunk, 100) == 0,
+             "exhausted iterator stays exhausted");
+    H3_EXPORT(polyfillIterDestroy)(iter);
+
+    PolyfillIterator* empty = H3_EXPORT(polyfillIterInit)(&emptyGeoPolygon, 9);
+    t_assert(H3_EXPORT(polyfillIterNext)(empty, chunk, 100) == 0,
+             "empty polygon produces no hexagons");
+    H3_EXPORT(polyfillIterDestroy)(empty);
+
+    t_assert(H3_EXPORT(polyfillIterInit)(&holeGeoPolygon, 16) == NULL,
+             "invalid resolution is rejected");
+
+    free(hexagons);
+}
+
+TEST(polyfillParallel) {
+    GeoPolygon* polygons[] = {&holeGeoPolygon, &transMeridianHoleGeoPolygon};
+    for (int p = 0; p < 2; p++) {
+        int numHexagons = H3_EXPORT(polyfillDense)(polygons[p], 7, NULL, 0);
+        H3Index* expected = malloc(numHexagons * sizeof(H3Index));
+        H3Index* hexagons = malloc(numHexagons * sizeof(H3Index));
+        H3_EXPORT(polyfillDense)(polygons[p], 7, expected, numHexagons);
+
+        t_assert(H3_EXPORT(polyfillParallel)(polygons[p], 7, hexagons,
+                                             numHexagons, NULL,
+                                             NULL) == numHexagons,
+                 "serial fallback got expected size");
+        for (int i = 0; i < numHexagons; i++) {
+            t_assert(hexagons[i] == expected[i],
+                     "serial fallback matches polyfillDense");
+        }
+
+        int numCalls = 0;
+        t_assert(H3_EXPORT(polyfillParallel)(
+                     polygons[p], 7, hexagons, numHexagons,
+                     reverseParallelFor, &numCalls) == numHexagons,
+                 "parallel got expected size");
+        t_assert(numCalls > 1, "work was split");
+        for (int i = 0; i < numHexagons; i++) {
+            t_assert(hexagons[i] == expected[i],
+                     "parallel matches polyfillDense");
+        }
+
+        t_assert(H3_EXPORT(polyfillParallel)(polygons[p], 7, hexagons, 10,
+                                             NULL, NULL) == numHexagons,
+                 "got full size with a small buffer");
+
+        free(hexagons);
+        free(expected);
+    }
+
+    H3Index hexagons[1] = {0};
+    t_assert(H3_EXPORT(polyfillParallel)(&sfGeoPolygon, -1, hexagons, 1, NULL,
+                                         NULL) == 0,
+             "no hexagons below resolution 0");
+    t_assert(H3_EXPORT(polyfillParallel)(&sfGeoPolygon, MAX_H3_RES + 1,
+                                         hexagons, 1, NULL, NULL) == 0,
+             "no hexagons above resolution 15");
+}
+
+TEST(polyfillMany) {
+    // The hole is filled by a second polygon, so together they cover sf
+    GeoPolygon holeFillGeoPolygon = {holeGeofence, 0, NULL};
+    GeoPolygon polygons[] = {holeGeoPolygon, holeFillGeoPolygon};
+    int numHexagons = H3_EXPORT(polyfillMany)(polygons, 2, 9, NULL, 0);
+    t_assert(numHexagons == 1253, "got expected polyfillMany size");
+
+    PolyfillCell* cells = malloc(numHexagons * sizeof(PolyfillCell));
+    H3_EXPORT(polyfillMany)(polygons, 2, 9, cells, numHexagons);
+    for (int p = 0; p < 2; p++) {
+        int numExpected =
+            H3_EXPORT(polyfillDense)(&polygons[p], 9, NULL, 0);
+        H3Index* expected = malloc(numExpected * sizeof(H3Index));
+        H3_EXPORT(polyfillDense)(&polygons[p], 9, expected, numExpected);
+        int numFound = 0;
+        for (int i = 0; i < numHexagons; i++) {
+            if (cells[i].polygon == p) {
+                t_assert(numFound < numExpected, "not too many for polygon");
+                t_assert(cells[i].h3 == expected[numFound],
+                         "cells for polygon match polyfillDense");
+                numFound++;
+            }
+        }
+        t_assert(numFound == numExpected, "all cells found for polygon");
+        free(expected);
+    }
+
+    // Overlapping polygons assign each cell to the first polygon
+    GeoPolygon overlapping[] = {sfGeoPolygon, sfGeoPolygon};
+    t_assert(H3_EXPORT(polyfillMany)(overlapping, 2, 9, cells, numHexagons) ==
+                 1253,
+             "overlapping cells are written once");
+    for (int i = 0; i < numHexagons; i++) {
+        t_assert(cells[i].polygon == 0, "assigned to first polygon");
+    }
+
+    t_assert(H3_EXPORT(polyfillMany)(polygons, 0, 9, cells, numHexagons) == 0,
+             "no polygons gives no cells");
+    t_assert(H3_EXPORT(polyfillMany)(polygons, 2, -1, cells, numHexagons) ==
+                 0,
+             "no cells below resolution 0");
+    t_assert(H3_EXPORT(polyfillMany)(polygons, 2, MAX_H3_RES + 1, cells,
+                                     numHexagons) == 0,
+             "no cells above resolution 15");
+    free(cells);
+}
+
 TEST(polyfillEmpty) {
     int numHexagons = H3_EXPORT(maxPolyfillSize)(&emptyGeoPolygon, 9);
     H3Index* hexagons = calloc(numHexagons, sizeof(H3Index));
@@ -262,6 +607,46 @@ TEST(polyfillTransmeridian) {
     free(hexagonsTMH);
 }
 
+TEST(polyfillTransmeridianUneven) {
+    // The vertices on each side of the antimeridian are at different
+    // longitudes, so a bounding box built from the outermost ones would
+    // miss the hexagons between the innermost and outermost vertices
+    GeoCoord verts[] = {{0.01, M_PI - 0.01},
+                        {0.01, -M_PI + 0.02},
+                        {-0.01, -M_PI + 0.01},
+                        {-0.01, M_PI - 0.02}};
+    GeoPolygon polygon = {.geofence = {.numVerts = 4, .verts = verts},
+                          .numHoles = 0};
+    int res = 6;
+
+    int numHexagons = H3_EXPORT(maxPolyfillSize)(&polygon, res);
+    H3Index* hexagons = calloc(numHexagons, sizeof(H3Index));
+    H3_EXPORT(polyfill)(&polygon, res, hexagons);
+    H3IndexSet* filled = H3_EXPORT(createH3IndexSet)(numHexagons);
+    for (int i = 0; i < numHexagons; i++) {
+        if (hexagons[i] != 0) H3_EXPORT(h3IndexSetAdd)(filled, hexagons[i]);
+    }
+
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(&polygon);
+    double step = H3_EXPORT(edgeLengthKm)(res) / EARTH_RADIUS_KM / 2;
+    for (double lat = -0.01; lat <= 0.01; lat += step) {
+        for (double lon = M_PI - 0.02; lon <= M_PI + 0.02; lon += step) {
+            GeoCoord point = {lat, constrainLng(lon)};
+            H3Index h = H3_EXPORT(geoToH3)(&point, res);
+            GeoCoord center;
+            H3_EXPORT(h3ToGeo)(h, &center);
+            if (H3_EXPORT(preparedGeoPolygonContains)(prepared, &center)) {
+                t_assert(H3_EXPORT(h3IndexSetContains)(filled, h),
+                         "hexagon with its center in the polygon is filled");
+            }
+        }
+    }
+
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    H3_EXPORT(destroyH3IndexSet)(filled);
+    free(hexagons);
+}
+
 TEST(polyfillPentagon) {
     H3Index pentagon;
     setH3Index(&pentagon, 9, 24, 0);
@@ -318,6 +703,33 @@ TEST(polyfillPentagon) {
     free(hexagons);
 }
 
+TEST(descendantsBBox) {
+    // a hexagon, a pentagon and a cell near the antimeridian
+    H3Index cells[] = {0x8029fffffffffff, 0x8009fffffffffff, 0x81f2bffffffffff};
+    for (int c = 0; c < 3; c++) {
+        for (int res = 0; res <= 3; res++) {
+            H3Index parent = H3_EXPORT(h3ToParent)(cells[c], res);
+            BBox bbox;
+            _descendantsBBox(parent, &bbox);
+
+            int childRes = res + 3;
+            int numChildren = H3_EXPORT(maxH3ToChildrenSize)(parent, childRes);
+            H3Index* children = calloc(numChildren, sizeof(H3Index));
+            H3_EXPORT(h3ToChildren)(parent, childRes, children);
+            for (int i = 0; i < numChildren; i++) {
+                if (children[i] == 0) continue;
+                GeoCoord center;
+                H3_EXPORT(h3ToGeo)(children[i], &center);
+                center.lat = constrainLat(center.lat);
+                center.lon = constrainLng(center.lon);
+                t_assert(bboxContains(&bbox, &center),
+                         "descendant center is in the bbox");
+            }
+            free(children);
+        }
+    }
+}
+
 TEST(_pointInPolyContainsLoop) {
     GeoCoord somewhere = {1, 2};
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testPolyfillDelta.c
+ * @brief Tests the changes to polyfills from edits of polygons.
+ *
+ *  usage: `testPolyfillDelta`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "constants.h"
+#include "h3api.h"
+#include "test.h"
+
+#define STAR_VERTS 200
+#define RES 9
+
+/**
+ * Writes the hexagons of one polyfill that are not in another.
+ *
+ * @return The number of hexagons written
+ */
+static int polyfillDifference(const GeoPolygon* a, const GeoPolygon* b,
+                              H3Index* out) {
+    int numA = H3_EXPORT(polyfillDense)(a, RES, NULL, 0);
+    int numB = H3_EXPORT(polyfillDense)(b, RES, NULL, 0);
+    H3Index* hexesA = calloc(numA, sizeof(H3Index));
+    H3Index* hexesB = calloc(numB, sizeof(H3Index));
+    H3_EXPORT(polyfillDense)(a, RES, hexesA, numA);
+    H3_EXPORT(polyfillDense)(b, RES, hexesB, numB);
+    H3IndexSet* setB = H3_EXPORT(createH3IndexSet)(numB);
+    for (int i = 0; i < numB; i++) {
+        H3_EXPORT(h3IndexSetAdd)(setB, hexesB[i]);
+    }
+    int numOut = 0;
+    for (int i = 0; i < numA; i++) {
+        if (!H3_EXPORT(h3IndexSetContains)(setB, hexesA[i])) {
+            out[numOut++] = hexesA[i];
+        }
+    }
+    H3_EXPORT(destroyH3IndexSet)(setB);
+    free(hexesB);
+    free(hexesA);
+    return numOut;
+}
+
+/**
+ * Tests that polyfillDelta finds exactly the differences of the polyfills
+ * of two polygons.
+ */
+static void assertDelta(const GeoPolygon* oldPolygon,
+                        const GeoPolygon* newPolygon) {
+    int maxHexes = H3_EXPORT(maxPolyfillSize)(oldPolygon, RES) +
+                   H3_EXPORT(maxPolyfillSize)(newPolygon, RES);
+    H3Index* expectedAdded = calloc(maxHexes, sizeof(H3Index));
+    H3Index* expectedRemoved = calloc(maxHexes, sizeof(H3Index));
+    int numExpectedAdded =
+        polyfillDifference(newPolygon, oldPolygon, expectedAdded);
+    int numExpectedRemoved =
+        polyfillDifference(oldPolygon, newPolygon, expectedRemoved);
+
+    H3Index* added = calloc(maxHexes, sizeof(H3Index));
+    H3Index* removed = calloc(maxHexes, sizeof(H3Index));
+    int numAdded;
+    int numRemoved;
+    t_assert(H3_EXPORT(polyfillDelta)(oldPolygon, newPolygon, RES, added,
+                                      maxHexes, &numAdded, removed,
+                                      maxHexes, &numRemoved) == 0,
+             "delta succeeded");
+    t_assert(numAdded == numExpectedAdded, "number added matches");
+    t_assert(numRemoved == numExpectedRemoved, "number removed matches");
+    H3_EXPORT(h3SortCells)(added, numAdded);
+    H3_EXPORT(h3SortCells)(expectedAdded, numExpectedAdded);
+    H3_EXPORT(h3SortCells)(removed, numRemoved);
+    H3_EXPORT(h3SortCells)(expectedRemoved, numExpectedRemoved);
+    t_assert(memcmp(added, expectedAdded, numAdded * sizeof(H3Index)) == 0,
+             "added matches polyfill");
+    t_assert(
+        memcmp(removed, expectedRemoved, numRemoved * sizeof(H3Index)) == 0,
+        "removed matches polyfill");
+
+    free(removed);
+    free(added);
+    free(expectedRemoved);
+    free(expectedAdded);
+}
+
+// Fixtures
+GeoCoord starVerts[STAR_VERTS];
+GeoCoord editedVerts[STAR_VERTS + 1];
+GeoCoord holeVerts[] = {
+    {0.6595, -2.1365}, {0.6590, -2.1368}, {0.6592, -2.1360}};
+GeoCoord editedHoleVerts[] = {
+    {0.6595, -2.1365}, {0.6588, -2.1369}, {0.6592, -2.1360}};
+Geofence holeGeofence = {3, holeVerts};
+Geofence editedHoleGeofence = {3, editedHoleVerts};
+GeoPolygon starGeoPolygon;
+GeoPolygon editedGeoPolygon;
+
+BEGIN_TESTS(polyfillDelta);
+
+// A star around San Francisco with a hole
+for (int i = 0; i < STAR_VERTS; i++) {
+    double angle = M_2PI * i / STAR_VERTS;
+    double radius = i % 2 ? 0.003 : 0.0025;
+    starVerts[i].lat = 0.659 + radius * sin(angle);
+    starVerts[i].lon = -2.1365 + radius * cos(angle);
+}
+starGeoPolygon.geofence.numVerts = STAR_VERTS;
+starGeoPolygon.geofence.verts = starVerts;
+starGeoPolygon.numHoles = 1;
+starGeoPolygon.holes = &holeGeofence;
+
+TEST(unchanged) {
+    int numAdded = -1;
+    int numRemoved = -1;
+    t_assert(H3_EXPORT(polyfillDelta)(&starGeoPolygon, &starGeoPolygon, RES,
+                                      NULL, 0, &numAdded, NULL, 0,
+                                      &numRemoved) == 0,
+             "delta succeeded");
+    t_assert(numAdded == 0 && numRemoved == 0, "nothing changed");
+}
+
+TEST(invalidRes) {
+    int numAdded;
+    int numRemoved;
+    t_assert(H3_EXPORT(polyfillDelta)(&starGeoPolygon, &starGeoPolygon, -1,
+                                      NULL, 0, &numAdded, NULL, 0,
+                                      &numRemoved) == -1,
+             "negative res");
+    t_assert(H3_EXPORT(polyfillDelta)(&starGeoPolygon, &starGeoPolygon, 16,
+                                      NULL, 0, &numAdded, NULL, 0,
+                                      &numRemoved) == -1,
+             "res too fine");
+}
+
+TEST(moveVertex) {
+    // Every vertex, including the first and last, moved in and out
+    for (int v = 0; v < STAR_VERTS; v += 13) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            memcpy(editedVerts, starVerts, sizeof(starVerts));
+            editedVerts[v].lat += sign * 0.0004;
+            editedVerts[v].lon += 0.0003;
+            editedGeoPolygon = starGeoPolygon;
+            editedGeoPolygon.geofence.verts = editedVerts;
+            assertDelta(&starGeoPolygon, &editedGeoPolygon);
+            assertDelta(&editedGeoPolygon, &starGeoPolygon);
+        }
+    }
+    memcpy(editedVerts, starVerts, sizeof(starVerts));
+    editedVerts[0].lat += 0.001;
+    editedVerts[STAR_VERTS - 1].lon -= 0.001;
+    editedGeoPolygon = starGeoPolygon;
+    editedGeoPolygon.geofence.verts = editedVerts;
+    assertDelta(&starGeoPolygon, &editedGeoPolygon);
+}
+
+TEST(insertAndDeleteVertex) {
+    for (int v = 0; v <= STAR_VERTS; v += 50) {
+        memcpy(editedVerts, starVerts, v * sizeof(GeoCoord));
+        memcpy(editedVerts + v + 1, starVerts + v,
+               (STAR_VERTS - v) * sizeof(GeoCoord));
+        editedVerts[v].lat = 0.659 + 0.004 * sin(M_2PI * (v - 0.5) / 200);
+        editedVerts[v].lon = -2.1365 + 0.004 * cos(M_2PI * (v - 0.5) / 200);
+        editedGeoPolygon = starGeoPolygon;
+        editedGeoPolygon.geofence.numVerts = STAR_VERTS + 1;
+        editedGeoPolygon.geofence.verts = editedVerts;
+        assertDelta(&starGeoPolygon, &editedGeoPolygon);
+        assertDelta(&editedGeoPolygon, &starGeoPolygon);
+    }
+}
+
+TEST(editHoles) {
+    editedGeoPolygon = starGeoPolygon;
+    editedGeoPolygon.holes = &editedHoleGeofence;
+    assertDelta(&starGeoPolygon, &editedGeoPolygon);
+
+    editedGeoPolygon.numHoles = 0;
+    assertDelta(&starGeoPolygon, &editedGeoPolygon);
+    assertDelta(&editedGeoPolygon, &starGeoPolygon);
+}
+
+TEST(bufferTooSmall) {
+    memcpy(editedVerts, starVerts, sizeof(starVerts));
+    editedVerts[10].lat += 0.002;
+    editedGeoPolygon = starGeoPolygon;
+    editedGeoPolygon.geofence.verts = editedVerts;
+    int numAdded;
+    int numRemoved;
+    H3_EXPORT(polyfillDelta)(&starGeoPolygon, &editedGeoPolygon, RES, NULL,
+                             0, &numAdded, NULL, 0, &numRemoved);
+    t_assert(numAdded > 1, "hexagons added");
+    H3Index* added = calloc(numAdded, sizeof(H3Index));
+    H3Index one;
+    int numAddedAgain;
+    H3_EXPORT(polyfillDelta)(&starGeoPolygon, &editedGeoPolygon, RES, &one,
+                             1, &numAddedAgain, NULL, 0, &numRemoved);
+    t_assert(numAddedAgain == numAdded, "counted past the buffer");
+    H3_EXPORT(polyfillDelta)(&starGeoPolygon, &editedGeoPolygon, RES, added,
+                             numAdded, &numAddedAgain, NULL, 0, &numRemoved);
+    t_assert(one == added[0], "filled the buffer first");
+    free(added);
+}
+
+END_TESTS();
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests H3 functions `polylineToCells` and `maxPolylineToCellsSize`
+ *
+ *  usage: `testPolylineToCells`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "test.h"
+#include "vec3d.h"
+
+/** samples per cell of the segments of a path */
+#define SAMPLES_PER_CELL 20
+
+/**
+ * Finds the point a fraction of the way along the great circle arc from a to
+ * b.
+ */
+static void interpolate(const GeoCoord* a, const GeoCoord* b, double s,
+                        GeoCoord* out) {
+    Vec3d pa, pb;
+    _geoToVec3d(a, &pa);
+    _geoToVec3d(b, &pb);
+    double distance = _geoDistRads(a, b);
+    double wa = sin((1 - s) * distance) / sin(distance);
+    double wb = sin(s * distance) / sin(distance);
+    double x = wa * pa.x + wb * pb.x;
+    double y = wa * pa.y + wb * pb.y;
+    double z = wa * pa.z + wb * pb.z;
+    out->lat = atan2(z, sqrt(x * x + y * y));
+    out->lon = atan2(y, x);
+}
+
+/**
+ * Checks polylineToCells against encoding points sampled densely along the
+ * path: the cells of the samples are in the path in the same order, and
+ * each cell of the path neighbors the one before.
+ */
+static void assertMatchesSamples(const GeoCoord* pts, int numPts, int res) {
+    int maxSize = H3_EXPORT(maxPolylineToCellsSize)(pts, numPts, res);
+    t_assert(maxSize > 0, "has a size");
+    H3Index* out = calloc(maxSize, sizeof(H3Index));
+    int count = H3_EXPORT(polylineToCells)(pts, numPts, res, out, maxSize);
+    t_assert(count > 0 && count <= maxSize, "count within bounds");
+
+    t_assert(out[0] == H3_EXPORT(geoToH3)(&pts[0], res), "starts at start");
+    t_assert(out[count - 1] == H3_EXPORT(geoToH3)(&pts[numPts - 1], res),
+             "ends at end");
+    for (int i = 1; i < count; i++) {
+        t_assert(H3_EXPORT(h3IndexesAreNeighbors)(out[i - 1], out[i]),
+                 "path of neighbors");
+    }
+
+    double stepRads = H3_EXPORT(edgeLengthKm)(res) / EARTH_RADIUS_KM /
+                      SAMPLES_PER_CELL;
+    int next = 0;
+    for (int i = 1; i < numPts; i++) {
+        double distance = _geoDistRads(&pts[i - 1], &pts[i]);
+        int numSteps = (int)ceil(distance / stepRads);
+        for (int step = 0; step <= numSteps; step++) {
+            GeoCoord sample = step == 0 ? pts[i - 1] : pts[i];
+            if (step > 0 && step < numSteps) {
+                interpolate(&pts[i - 1], &pts[i], (double)step / numSteps,
+                            &sample);
+            }
+            H3Index h = H3_EXPORT(geoToH3)(&sample, res);
+            if (next > 0 && out[next - 1] == h) continue;
+            while (next < count && out[next] != h) next++;
+            t_assert(next < count, "sampled cell in order");
+            next++;
+        }
+    }
+    free(out);
+}
+
+BEGIN_TESTS(polylineToCells);
+
+TEST(road) {
+    GeoCoord road[] = {{0.659966917655, -2.1364398519396},
+                       {0.659906, -2.136200},
+                       {0.659950, -2.135950},
+                       {0.659700, -2.135800}};
+    assertMatchesSamples(road, 4, 9);
+    assertMatchesSamples(road, 4, 11);
+    assertMatchesSamples(road, 4, 13);
+}
+
+TEST(acrossFaces) {
+    // Long enough to be split into arcs, crossing several faces
+    GeoCoord line[] = {{0.1, 0.1}, {0.9, 1.4}, {-0.3, 2.2}};
+    assertMatchesSamples(line, 3, 3);
+    assertMatchesSamples(line, 3, 4);
+    GeoCoord meridian[] = {{1.5, 0.3}, {-1.5, 0.3}};
+    assertMatchesSamples(meridian, 2, 2);
+}
+
+TEST(aroundPentagon) {
+    H3Index pentagon;
+    setH3Index(&pentagon, 4, 14, 0);
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(pentagon, &center);
+    GeoCoord path[] = {{center.lat - 0.02, center.lon - 0.03},
+                       {center.lat + 0.001, center.lon + 0.002},
+                       {center.lat + 0.03, center.lon + 0.01},
+                       {center.lat - 0.01, center.lon + 0.03}};
+    assertMatchesSamples(path, 4, 4);
+    assertMatchesSamples(path, 4, 5);
+    assertMatchesSamples(path, 4, 6);
+}
+
+TEST(repeats) {
+    GeoCoord sf = {0.659966917655, -2.1364398519396};
+    H3Index h = H3_EXPORT(geoToH3)(&sf, 9);
+    H3Index out[4];
+
+    t_assert(H3_EXPORT(polylineToCells)(&sf, 1, 9, out, 4) == 1,
+             "one point is one cell");
+    t_assert(out[0] == h, "cell of the point");
+
+    GeoCoord same[] = {sf, sf, sf};
+    t_assert(H3_EXPORT(polylineToCells)(same, 3, 9, out, 4) == 1,
+             "cell not repeated");
+
+    // Out and back returns to the start cell
+    GeoCoord outAndBack[] = {sf, {sf.lat + 0.0002, sf.lon}, sf};
+    int count = H3_EXPORT(maxPolylineToCellsSize)(outAndBack, 3, 9);
+    H3Index* path = calloc(count, sizeof(H3Index));
+    count = H3_EXPORT(polylineToCells)(outAndBack, 3, 9, path, count);
+    t_assert(count > 2 && count % 2 == 1, "returns along the same cells");
+    for (int i = 0; i < count; i++) {
+        t_assert(path[i] == path[count - 1 - i], "same cells back");
+    }
+    free(path);
+}
+
+TEST(smallBuffer) {
+    GeoCoord line[] = {{0.1, 0.1}, {0.11, 0.12}};
+    int maxSize = H3_EXPORT(maxPolylineToCellsSize)(line, 2, 7);
+    H3Index* full = calloc(maxSize, sizeof(H3Index));
+    int count = H3_EXPORT(polylineToCells)(line, 2, 7, full, maxSize);
+    t_assert(count > 4, "crosses several cells");
+
+    H3Index small[4];
+    t_assert(H3_EXPORT(polylineToCells)(line, 2, 7, small, 4) == count,
+             "total count returned");
+    for (int i = 0; i < 4; i++) {
+        t_assert(small[i] == full[i], "buffer filled with the start");
+    }
+    free(full);
+}
+
+TEST(maxSizeOverflow) {
+    // Continent length segments back and forth at the finest resolution
+    GeoCoord path[100];
+    for (int i = 0; i < 100; i++) {
+        path[i].lat = 0.0;
+        path[i].lon = i % 2 ? 1.5 : 0.0;
+    }
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(path, 2, 15) > 0,
+             "one segment fits");
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(path, 100, 15) == -1,
+             "too many cells to fit in an int");
+}
+
+TEST(invalidArguments) {
+    GeoCoord line[] = {{0.1, 0.1}, {NAN, 0.1}};
+    H3Index out[4];
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(line, 1, -1) == 0,
+             "negative res");
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(line, 1, 16) == 0,
+             "res too high");
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(line, 0, 9) == 0, "no points");
+    t_assert(H3_EXPORT(maxPolylineToCellsSize)(line, 2, 9) == 0,
+             "non-finite point");
+    t_assert(H3_EXPORT(polylineToCells)(line, 1, 16, out, 4) == 0,
+             "nothing for invalid res");
+    t_assert(H3_EXPORT(polylineToCells)(line, 0, 9, out, 4) == 0,
+             "nothing for no points");
+    t_assert(H3_EXPORT(polylineToCells)(line, 2, 9, out, 4) == 0,
+             "nothing for non-finite point");
+}
+
+END_TESTS();
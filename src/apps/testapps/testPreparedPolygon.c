@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "algos.h"
+#include "bbox.h"
+#include "constants.h"
+#include "geoCoord.h"
+#include "preparedPolygon.h"
+#include "test.h"
+
+#define STAR_VERTS 2000
+
+/**
+ * Compares prepared containment against the unprepared test on a grid of
+ * points around the polygon, and on each of its vertices.
+ */
+static void assertMatchesPointInPoly(const GeoPolygon* geoPolygon) {
+    BBox* bboxes = calloc(geoPolygon->numHoles + 1, sizeof(BBox));
+    bboxesFromGeoPolygon(geoPolygon, bboxes);
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(geoPolygon);
+
+    const BBox* bbox = &bboxes[0];
+    double width = bboxIsTransmeridian(bbox)
+                       ? bbox->east + M_2PI - bbox->west
+                       : bbox->east - bbox->west;
+    double height = bbox->north - bbox->south;
+    for (int i = -5; i <= 105; i++) {
+        for (int j = -5; j <= 105; j++) {
+            GeoCoord point = {bbox->south + height * i / 100,
+                              constrainLng(bbox->west + width * j / 100)};
+            t_assert(_preparedPolygonContains(prepared, &point) ==
+                         _pointInPolyContains(geoPolygon, bboxes, &point),
+                     "prepared containment matches on grid");
+        }
+    }
+    const Geofence* geofence = &geoPolygon->geofence;
+    for (int i = 0; i < geofence->numVerts; i++) {
+        t_assert(_preparedPolygonContains(prepared, &geofence->verts[i]) ==
+                     _pointInPolyContains(geoPolygon, bboxes,
+                                          &geofence->verts[i]),
+                 "prepared containment matches on vertices");
+    }
+
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    free(bboxes);
+}
+
+// Fixtures
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoCoord holeVerts[] = {{0.6595072188743, -2.1371053983433},
+                        {0.6591482046471, -2.1373141048153},
+                        {0.6592295020837, -2.1365222838402}};
+GeoCoord transMeridianVerts[] = {{0.01, -M_PI + 0.01},
+                                 {0.01, M_PI - 0.01},
+                                 {-0.01, M_PI - 0.01},
+                                 {-0.01, -M_PI + 0.01}};
+GeoCoord transMeridianHoleVerts[] = {{0.005, -M_PI + 0.005},
+                                     {0.005, M_PI - 0.005},
+                                     {-0.005, M_PI - 0.005},
+                                     {-0.005, -M_PI + 0.005}};
+GeoCoord starVerts[STAR_VERTS];
+
+Geofence holeGeofence;
+Geofence transMeridianHoleGeofence;
+GeoPolygon sfGeoPolygon;
+GeoPolygon transMeridianGeoPolygon;
+GeoPolygon starGeoPolygon;
+
+BEGIN_TESTS(preparedPolygon);
+
+holeGeofence.numVerts = 3;
+holeGeofence.verts = holeVerts;
+sfGeoPolygon.geofence.numVerts = 6;
+sfGeoPolygon.geofence.verts = sfVerts;
+sfGeoPolygon.numHoles = 1;
+sfGeoPolygon.holes = &holeGeofence;
+
+transMeridianHoleGeofence.numVerts = 4;
+transMeridianHoleGeofence.verts = transMeridianHoleVerts;
+transMeridianGeoPolygon.geofence.numVerts = 4;
+transMeridianGeoPolygon.geofence.verts = transMeridianVerts;
+transMeridianGeoPolygon.numHoles = 1;
+transMeridianGeoPolygon.holes = &transMeridianHoleGeofence;
+
+// A star with long spikes, so edges span many latitude slices
+for (int i = 0; i < STAR_VERTS; i++) {
+    double angle = M_2PI * i / STAR_VERTS;
+    double radius = i % 2 ? 0.1 : 0.02;
+    starVerts[i].lat = 0.5 + radius * sin(angle);
+    starVerts[i].lon = 0.5 + radius * cos(angle);
+}
+starGeoPolygon.geofence.numVerts = STAR_VERTS;
+starGeoPolygon.geofence.verts = starVerts;
+starGeoPolygon.numHoles = 0;
+
+TEST(preparedContainsMatchesPointInPoly) {
+    assertMatchesPointInPoly(&sfGeoPolygon);
+    assertMatchesPointInPoly(&transMeridianGeoPolygon);
+    assertMatchesPointInPoly(&starGeoPolygon);
+}
+
+TEST(preparedGeoPolygonContains) {
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(&sfGeoPolygon);
+
+    GeoCoord inside = {0.659, -2.136};
+    GeoCoord inHole = {0.6593, -2.137};
+    GeoCoord outside = {0.70, -2.136};
+    t_assert(H3_EXPORT(preparedGeoPolygonContains)(prepared, &inside),
+             "contains point inside");
+    t_assert(!H3_EXPORT(preparedGeoPolygonContains)(prepared, &inHole),
+             "does not contain point in hole");
+    t_assert(!H3_EXPORT(preparedGeoPolygonContains)(prepared, &outside),
+             "does not contain point outside");
+
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    H3_EXPORT(destroyPreparedGeoPolygon)(NULL);
+}
+
+TEST(preparedPolygonCrossesBBox) {
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(&sfGeoPolygon);
+
+    BBox interior = {0.6590, 0.6588, -2.1376, -2.1378};
+    BBox boundary = {0.6600, 0.6598, -2.1370, -2.1380};
+    BBox holeBoundary = {0.6596, 0.6594, -2.1370, -2.1372};
+    BBox outside = {0.71, 0.70, -2.13, -2.14};
+    t_assert(!_preparedPolygonCrossesBBox(prepared, &interior),
+             "interior box is not crossed");
+    t_assert(_preparedPolygonCrossesBBox(prepared, &boundary),
+             "box on the boundary is crossed");
+    t_assert(_preparedPolygonCrossesBBox(prepared, &holeBoundary),
+             "box on the hole boundary is crossed");
+    t_assert(!_preparedPolygonCrossesBBox(prepared, &outside),
+             "box outside is not crossed");
+
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+}
+
+END_TESTS();
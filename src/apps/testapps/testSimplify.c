@@ -0,0 +1,229 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testSimplify.c
+ * @brief Tests polygons simplified for polyfilling at a resolution.
+ *
+ *  usage: `testSimplify`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "algos.h"
+#include "bbox.h"
+#include "constants.h"
+#include "h3Alloc.h"
+#include "simplify.h"
+#include "test.h"
+
+#define COAST_VERTS 20000
+#define HOLE_VERTS 2000
+
+/**
+ * The distance in the plane of latitude and longitude from a point to the
+ * nearest edge of a loop.
+ */
+static double boundaryDistance(const Geofence* geofence, const GeoCoord* p) {
+    BBox bbox;
+    bboxFromGeofence(geofence, &bbox);
+    bool isTransmeridian = bboxIsTransmeridian(&bbox);
+    double px = _normalizeLng(p->lon, isTransmeridian);
+    double minDistSq = INFINITY;
+    for (int i = 0; i < geofence->numVerts; i++) {
+        const GeoCoord* a = &geofence->verts[i];
+        const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+        double ax = _normalizeLng(a->lon, isTransmeridian);
+        double dx = _normalizeLng(b->lon, isTransmeridian) - ax;
+        double dy = b->lat - a->lat;
+        double lenSq = dx * dx + dy * dy;
+        double t = lenSq > 0 ? ((px - ax) * dx + (p->lat - a->lat) * dy) /
+                                   lenSq
+                             : 0;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        double ex = ax + t * dx - px;
+        double ey = a->lat + t * dy - p->lat;
+        if (ex * ex + ey * ey < minDistSq) minDistSq = ex * ex + ey * ey;
+    }
+    return sqrt(minDistSq);
+}
+
+/** The distance to the nearest edge of any loop of a polygon. */
+static double polygonBoundaryDistance(const GeoPolygon* geoPolygon,
+                                      const GeoCoord* p) {
+    double dist = boundaryDistance(&geoPolygon->geofence, p);
+    for (int i = 0; i < geoPolygon->numHoles; i++) {
+        double holeDist = boundaryDistance(&geoPolygon->holes[i], p);
+        if (holeDist < dist) dist = holeDist;
+    }
+    return dist;
+}
+
+/** Writes a loop around a center, with a zigzag of the given amplitude. */
+static void noisyLoop(GeoCoord* verts, int numVerts, double lat, double lon,
+                      double radius, double noise) {
+    for (int i = 0; i < numVerts; i++) {
+        double angle = M_2PI * i / numVerts;
+        double r = radius + (i % 2 ? noise : -noise) +
+                   0.2 * radius * sin(7 * angle);
+        verts[i].lat = lat + r * sin(angle);
+        verts[i].lon = constrainLng(lon + r * cos(angle));
+    }
+}
+
+/**
+ * Tests that polyfillSimplified differs from polyfillDense only in hexagons
+ * whose centers are within the tolerance of the simplified boundary.
+ */
+static void assertFlipsNearBoundary(const GeoPolygon* geoPolygon, int res) {
+    SimplifiedGeoPolygon* simplified =
+        H3_EXPORT(createSimplifiedGeoPolygon)(geoPolygon);
+    const GeoPolygon* simple =
+        H3_EXPORT(simplifiedGeoPolygonAtRes)(simplified, res);
+    t_assert(simple == H3_EXPORT(simplifiedGeoPolygonAtRes)(simplified, res),
+             "simplified polygon is cached");
+    double tolerance = H3_EXPORT(simplifyToleranceRads)(res);
+
+    int numExact = H3_EXPORT(polyfillDense)(geoPolygon, res, NULL, 0);
+    int numSimple = H3_EXPORT(polyfillSimplified)(simplified, res, NULL, 0);
+    H3Index* exact = calloc(numExact, sizeof(H3Index));
+    H3Index* simpleHexes = calloc(numSimple, sizeof(H3Index));
+    H3_EXPORT(polyfillDense)(geoPolygon, res, exact, numExact);
+    t_assert(H3_EXPORT(polyfillSimplified)(simplified, res, simpleHexes,
+                                           numSimple) == numSimple,
+             "same count when called again");
+
+    H3IndexSet* exactSet = H3_EXPORT(createH3IndexSet)(numExact);
+    H3IndexSet* simpleSet = H3_EXPORT(createH3IndexSet)(numSimple);
+    for (int i = 0; i < numExact; i++) {
+        H3_EXPORT(h3IndexSetAdd)(exactSet, exact[i]);
+    }
+    for (int i = 0; i < numSimple; i++) {
+        H3_EXPORT(h3IndexSetAdd)(simpleSet, simpleHexes[i]);
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        const H3Index* hexes = pass ? simpleHexes : exact;
+        int numHexes = pass ? numSimple : numExact;
+        const H3IndexSet* other = pass ? exactSet : simpleSet;
+        for (int i = 0; i < numHexes; i++) {
+            if (H3_EXPORT(h3IndexSetContains)(other, hexes[i])) continue;
+            // Constrained as polyfill does before testing containment
+            GeoCoord center;
+            H3_EXPORT(h3ToGeo)(hexes[i], &center);
+            center.lon = constrainLng(center.lon);
+            t_assert(polygonBoundaryDistance(simple, &center) <= tolerance,
+                     "only centers near the simplified boundary change");
+            t_assert(polygonBoundaryDistance(geoPolygon, &center) <=
+                         2 * tolerance,
+                     "only centers near the boundary change");
+        }
+    }
+
+    H3_EXPORT(destroyH3IndexSet)(simpleSet);
+    H3_EXPORT(destroyH3IndexSet)(exactSet);
+    free(simpleHexes);
+    free(exact);
+    H3_EXPORT(destroySimplifiedGeoPolygon)(simplified);
+}
+
+// Fixtures
+GeoCoord coastVerts[COAST_VERTS];
+GeoCoord holeVerts[HOLE_VERTS];
+GeoCoord transMeridianVerts[COAST_VERTS];
+Geofence holeGeofence;
+GeoPolygon coastGeoPolygon;
+GeoPolygon transMeridianGeoPolygon;
+
+BEGIN_TESTS(simplify);
+
+noisyLoop(coastVerts, COAST_VERTS, 0.659, -2.136, 0.02, 2e-6);
+noisyLoop(holeVerts, HOLE_VERTS, 0.659, -2.136, 0.005, 2e-6);
+holeGeofence.numVerts = HOLE_VERTS;
+holeGeofence.verts = holeVerts;
+coastGeoPolygon.geofence.numVerts = COAST_VERTS;
+coastGeoPolygon.geofence.verts = coastVerts;
+coastGeoPolygon.numHoles = 1;
+coastGeoPolygon.holes = &holeGeofence;
+
+noisyLoop(transMeridianVerts, COAST_VERTS, 0.1, M_PI, 0.02, 2e-6);
+transMeridianGeoPolygon.geofence.numVerts = COAST_VERTS;
+transMeridianGeoPolygon.geofence.verts = transMeridianVerts;
+transMeridianGeoPolygon.numHoles = 0;
+
+TEST(simplifyGeofence) {
+    double tolerance = H3_EXPORT(simplifyToleranceRads)(7);
+    Geofence out;
+    _simplifyGeofence(&coastGeoPolygon.geofence, tolerance, &out);
+    t_assert(out.numVerts >= 3 && out.numVerts < COAST_VERTS / 10,
+             "most vertices are dropped");
+    for (int i = 0; i < COAST_VERTS; i++) {
+        t_assert(boundaryDistance(&out, &coastVerts[i]) <= tolerance,
+                 "vertices dropped are within the tolerance");
+    }
+    H3_MEMORY(free)(out.verts);
+
+    // Longitudes are compared across the antimeridian
+    _simplifyGeofence(&transMeridianGeoPolygon.geofence, tolerance, &out);
+    t_assert(out.numVerts >= 3 && out.numVerts < COAST_VERTS / 10,
+             "most transmeridian vertices are dropped");
+    for (int i = 0; i < COAST_VERTS; i++) {
+        t_assert(boundaryDistance(&out, &transMeridianVerts[i]) <= tolerance,
+                 "transmeridian vertices dropped are within the tolerance");
+    }
+    H3_MEMORY(free)(out.verts);
+
+    _simplifyGeofence(&coastGeoPolygon.geofence, 0, &out);
+    t_assert(out.numVerts == COAST_VERTS, "no tolerance keeps every vertex");
+    H3_MEMORY(free)(out.verts);
+
+    // A loop smaller than the tolerance is kept whole
+    GeoCoord tinyVerts[10];
+    noisyLoop(tinyVerts, 10, 0.5, 0.5, tolerance / 10, 0);
+    Geofence tiny = {10, tinyVerts};
+    _simplifyGeofence(&tiny, tolerance, &out);
+    t_assert(out.numVerts == 10, "tiny loop kept whole");
+    H3_MEMORY(free)(out.verts);
+}
+
+TEST(simplifyToleranceRads) {
+    t_assert(H3_EXPORT(simplifyToleranceRads)(-1) == 0, "negative res");
+    t_assert(H3_EXPORT(simplifyToleranceRads)(MAX_H3_RES + 1) == 0,
+             "res too fine");
+    for (int res = 1; res <= MAX_H3_RES; res++) {
+        t_assert(H3_EXPORT(simplifyToleranceRads)(res) <
+                     H3_EXPORT(simplifyToleranceRads)(res - 1),
+                 "tolerance shrinks with resolution");
+    }
+}
+
+TEST(polyfillSimplified) {
+    assertFlipsNearBoundary(&coastGeoPolygon, 5);
+    assertFlipsNearBoundary(&coastGeoPolygon, 7);
+    assertFlipsNearBoundary(&coastGeoPolygon, 8);
+    assertFlipsNearBoundary(&transMeridianGeoPolygon, 6);
+}
+
+TEST(invalidRes) {
+    SimplifiedGeoPolygon* simplified =
+        H3_EXPORT(createSimplifiedGeoPolygon)(&coastGeoPolygon);
+    t_assert(H3_EXPORT(simplifiedGeoPolygonAtRes)(simplified, -1) == NULL,
+             "negative res");
+    t_assert(H3_EXPORT(simplifiedGeoPolygonAtRes)(simplified, 16) == NULL,
+             "res too fine");
+    t_assert(H3_EXPORT(polyfillSimplified)(simplified, 16, NULL, 0) == 0,
+             "nothing filled at an invalid res");
+    H3_EXPORT(destroySimplifiedGeoPolygon)(simplified);
+}
+
+END_TESTS();
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file
+ * @brief tests assigning points to polygons with a spatial join
+ *
+ *  usage: `testSpatialJoin`
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "h3api.h"
+#include "h3RegionIndex.h"
+#include "spatialJoin.h"
+#include "test.h"
+
+#define NUM_POINTS 20000
+
+// Fixtures
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoCoord holeVerts[] = {{0.6595072188743, -2.1371053983433},
+                        {0.6591482046471, -2.1373141048153},
+                        {0.6592295020837, -2.1365222838402}};
+// A sliver narrower than a hexagon, crossing the others
+GeoCoord sliverVerts[] = {{0.6580, -2.1380},
+                          {0.6601, -2.1370},
+                          {0.6601, -2.13699}};
+GeoCoord transMeridianVerts[] = {{0.01, -M_PI + 0.01},
+                                 {0.01, M_PI - 0.01},
+                                 {-0.01, M_PI - 0.01},
+                                 {-0.01, -M_PI + 0.01}};
+
+Geofence holeGeofence = {3, holeVerts};
+GeoPolygon polygons[] = {{{6, sfVerts}, 1, &holeGeofence},
+                         {{3, sliverVerts}, 0, NULL},
+                         {{3, holeVerts}, 0, NULL},
+                         {{4, transMeridianVerts}, 0, NULL}};
+
+/**
+ * The first polygon containing a point, by testing every polygon.
+ */
+static int bruteForce(PreparedGeoPolygon** prepared, int numPolygons,
+                      const GeoCoord* g) {
+    for (int p = 0; p < numPolygons; p++) {
+        if (H3_EXPORT(preparedGeoPolygonContains)(prepared[p], g)) return p;
+    }
+    return -1;
+}
+
+BEGIN_TESTS(spatialJoin);
+
+TEST(matchesBruteForce) {
+    PreparedGeoPolygon* prepared[4];
+    for (int p = 0; p < 4; p++) {
+        prepared[p] = H3_EXPORT(prepareGeoPolygon)(&polygons[p]);
+    }
+    GeoCoord* points = calloc(NUM_POINTS, sizeof(GeoCoord));
+    int* out = calloc(NUM_POINTS, sizeof(int));
+    srand(7);
+    for (int i = 0; i < NUM_POINTS; i++) {
+        double u = (double)rand() / RAND_MAX;
+        double v = (double)rand() / RAND_MAX;
+        if (i % 4 == 0) {
+            // around the antimeridian
+            points[i].lat = -0.012 + 0.024 * u;
+            points[i].lon = M_PI - 0.012 + 0.024 * v;
+            if (points[i].lon > M_PI) points[i].lon -= 2 * M_PI;
+        } else {
+            points[i].lat = 0.6578 + 0.0025 * u;
+            points[i].lon = -2.1387 + 0.0035 * v;
+        }
+    }
+
+    for (int res = 7; res <= 10; res++) {
+        H3SpatialJoin* join = H3_EXPORT(createH3SpatialJoin)(polygons, 4, res);
+        t_assert(join != NULL, "created join");
+        H3_EXPORT(h3SpatialJoinPoints)(join, points, NUM_POINTS, out);
+        int numMismatches = 0;
+        int counts[5] = {0};
+        for (int i = 0; i < NUM_POINTS; i++) {
+            int expected = bruteForce(prepared, 4, &points[i]);
+            numMismatches += out[i] != expected;
+            counts[expected + 1]++;
+        }
+        t_assert(numMismatches == 0, "join matches testing every polygon");
+        for (int c = 0; c < 5; c++) {
+            t_assert(counts[c] > 0, "points in and out of every polygon");
+        }
+        t_assert(H3_EXPORT(h3SpatialJoinPoint)(join, &points[1]) == out[1],
+                 "single point matches");
+        H3_EXPORT(destroyH3SpatialJoin)(join);
+    }
+
+    for (int p = 0; p < 4; p++) {
+        H3_EXPORT(destroyPreparedGeoPolygon)(prepared[p]);
+    }
+    free(points);
+    free(out);
+}
+
+TEST(interiorIsCompacted) {
+    H3SpatialJoin* join = H3_EXPORT(createH3SpatialJoin)(polygons, 1, 10);
+    const H3RegionIndexHeader* header = join->interior;
+    int numFilled = H3_EXPORT(polyfillDense)(&polygons[0], 10, NULL, 0);
+    t_assert(join->numBoundary > 0, "has boundary hexagons");
+    t_assert(join->numBoundary < numFilled / 2,
+             "most hexagons are interior");
+    t_assert(header->numRanges < (uint64_t)numFilled / 2,
+             "interior hexagons are compacted");
+
+    GeoCoord inHole = {
+        (holeVerts[0].lat + holeVerts[1].lat + holeVerts[2].lat) / 3,
+        (holeVerts[0].lon + holeVerts[1].lon + holeVerts[2].lon) / 3};
+    t_assert(H3_EXPORT(h3SpatialJoinPoint)(join, &inHole) == -1,
+             "point in hole is in no polygon");
+    H3_EXPORT(destroyH3SpatialJoin)(join);
+}
+
+TEST(invalidJoin) {
+    t_assert(H3_EXPORT(createH3SpatialJoin)(polygons, 1, 16) == NULL,
+             "invalid resolution fails");
+    H3SpatialJoin* empty = H3_EXPORT(createH3SpatialJoin)(polygons, 0, 9);
+    t_assert(H3_EXPORT(h3SpatialJoinPoint)(empty, &sfVerts[0]) == -1,
+             "empty join contains nothing");
+    H3_EXPORT(destroyH3SpatialJoin)(empty);
+}
+
+END_TESTS();
@@ -0,0 +1,335 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file testThreads.c
+ * @brief Tests that the core API gives the same results when called from
+ * many threads at once.
+ *
+ *  usage: `testThreads`
+ *
+ *  Build with ENABLE_TSAN to also check the library for data races.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "h3api.h"
+#include "test.h"
+#include "threadPool.h"
+
+#define NUM_THREADS 4
+#define NUM_COORDS 100
+#define RES 9
+#define K 2
+/** number of cells in a k-ring with K */
+#define K_RING_SIZE 19
+/** number of points indexed by the parallel batch functions */
+#define NUM_BATCH_POINTS 20011
+/** number of points aggregated in parallel, enough for several parts */
+#define NUM_AGGREGATE_POINTS 400009
+
+GeoCoord coords[NUM_COORDS];
+H3Index expectedCells[NUM_COORDS];
+GeoCoord expectedCenters[NUM_COORDS];
+GeoBoundary expectedBoundaries[NUM_COORDS];
+H3Index expectedRings[NUM_COORDS][K_RING_SIZE];
+
+GeoCoord sfVerts[] = {
+    {0.659966917655, -2.1364398519396},  {0.6595011102219, -2.1359434279405},
+    {0.6583348114025, -2.1354884206045}, {0.6581220034068, -2.1382437718946},
+    {0.6594479998527, -2.1384597563896}, {0.6599990002976, -2.1376771158464}};
+GeoPolygon sfGeoPolygon = {{6, sfVerts}, 0, NULL};
+int polyfillSize;
+H3Index* expectedPolyfill;
+
+/**
+ * Computes every result again and counts those that differ from the
+ * expected results computed on one thread.
+ */
+static void* runThread(void* arg) {
+    int* mismatches = arg;
+    H3Index ring[K_RING_SIZE];
+    H3Index compacted[K_RING_SIZE];
+    H3Index* polyfilled = calloc(polyfillSize, sizeof(H3Index));
+    for (int i = 0; i < NUM_COORDS; i++) {
+        H3Index h = H3_EXPORT(geoToH3)(&coords[i], RES);
+        if (h != expectedCells[i]) (*mismatches)++;
+
+        GeoCoord center;
+        H3_EXPORT(h3ToGeo)(h, &center);
+        if (memcmp(&center, &expectedCenters[i], sizeof(center))) {
+            (*mismatches)++;
+        }
+
+        GeoBoundary boundary;
+        H3_EXPORT(h3ToGeoBoundary)(h, &boundary);
+        if (boundary.numVerts != expectedBoundaries[i].numVerts ||
+            memcmp(boundary.verts, expectedBoundaries[i].verts,
+                   boundary.numVerts * sizeof(GeoCoord))) {
+            (*mismatches)++;
+        }
+
+        memset(ring, 0, sizeof(ring));
+        H3_EXPORT(kRing)(h, K, ring);
+        if (memcmp(ring, expectedRings[i], sizeof(ring))) (*mismatches)++;
+
+        if (H3_EXPORT(compact)(ring, compacted, K_RING_SIZE)) {
+            (*mismatches)++;
+        }
+    }
+    H3_EXPORT(polyfill)(&sfGeoPolygon, RES, polyfilled);
+    if (memcmp(polyfilled, expectedPolyfill, polyfillSize * sizeof(H3Index))) {
+        (*mismatches)++;
+    }
+    free(polyfilled);
+    return NULL;
+}
+
+H3IndexSet* sharedSet;
+
+/**
+ * Adds the k-rings of every expected cell to the shared set, from the
+ * cell given by the thread offset onward, so threads race on the same
+ * indexes.
+ */
+static void* addThread(void* arg) {
+    int* offset = arg;
+    int* failures = offset + NUM_THREADS;
+    for (int i = 0; i < NUM_COORDS; i++) {
+        int c = (i + *offset) % NUM_COORDS;
+        for (int j = 0; j < K_RING_SIZE; j++) {
+            if (H3_EXPORT(h3IndexSetAddConcurrent)(
+                    sharedSet, expectedRings[c][j]) < 0) {
+                (*failures)++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Counts the runs of each item of a range, with uneven work per item.
+ */
+static void countTask(void* data, int begin, int end) {
+    int* hits = data;
+    for (int i = begin; i < end; i++) {
+        volatile int spin = 0;
+        for (int j = 0; j < i % 512; j++) spin += j;
+        hits[i]++;
+    }
+}
+
+BEGIN_TESTS(threads);
+
+TEST(concurrentCallsMatch) {
+    for (int i = 0; i < NUM_COORDS; i++) {
+        coords[i].lat = (i % 19) * 0.165 - 1.5;
+        coords[i].lon = (i % 37) * 0.17 - 3.1;
+        expectedCells[i] = H3_EXPORT(geoToH3)(&coords[i], RES);
+        H3_EXPORT(h3ToGeo)(expectedCells[i], &expectedCenters[i]);
+        H3_EXPORT(h3ToGeoBoundary)(expectedCells[i], &expectedBoundaries[i]);
+        H3_EXPORT(kRing)(expectedCells[i], K, expectedRings[i]);
+    }
+    polyfillSize = H3_EXPORT(maxPolyfillSize)(&sfGeoPolygon, RES);
+    expectedPolyfill = calloc(polyfillSize, sizeof(H3Index));
+    H3_EXPORT(polyfill)(&sfGeoPolygon, RES, expectedPolyfill);
+
+    pthread_t threads[NUM_THREADS];
+    int mismatches[NUM_THREADS] = {0};
+    for (int t = 0; t < NUM_THREADS; t++) {
+        t_assert(pthread_create(&threads[t], NULL, runThread,
+                                &mismatches[t]) == 0,
+                 "created thread");
+    }
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        t_assert(mismatches[t] == 0, "results match on every thread");
+    }
+
+    free(expectedPolyfill);
+}
+
+TEST(concurrentSetAdds) {
+    sharedSet = H3_EXPORT(createH3IndexSet)(NUM_COORDS * K_RING_SIZE);
+    H3IndexSet* expected = H3_EXPORT(createH3IndexSet)(0);
+    for (int i = 0; i < NUM_COORDS; i++) {
+        for (int j = 0; j < K_RING_SIZE; j++) {
+            H3_EXPORT(h3IndexSetAdd)(expected, expectedRings[i][j]);
+        }
+    }
+
+    pthread_t threads[NUM_THREADS];
+    // offsets of each thread, followed by their failure counts
+    int args[2 * NUM_THREADS] = {0};
+    for (int t = 0; t < NUM_THREADS; t++) {
+        args[t] = t * NUM_COORDS / NUM_THREADS;
+        t_assert(pthread_create(&threads[t], NULL, addThread, &args[t]) == 0,
+                 "created thread");
+    }
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        t_assert(args[NUM_THREADS + t] == 0, "every add fit in the set");
+    }
+
+    t_assert(H3_EXPORT(h3IndexSetSize)(sharedSet) ==
+                 H3_EXPORT(h3IndexSetSize)(expected),
+             "each index added once");
+    for (int i = 0; i < NUM_COORDS; i++) {
+        for (int j = 0; j < K_RING_SIZE; j++) {
+            t_assert(H3_EXPORT(h3IndexSetContains)(sharedSet,
+                                                   expectedRings[i][j]),
+                     "contains every index");
+        }
+    }
+    H3_EXPORT(destroyH3IndexSet)(expected);
+    H3_EXPORT(destroyH3IndexSet)(sharedSet);
+}
+
+TEST(threadPoolRunsEveryItem) {
+    ThreadPool* pool = createThreadPool(NUM_THREADS);
+    t_assert(pool != NULL, "created pool");
+    t_assert(threadPoolSize(pool) == NUM_THREADS, "pool size");
+    int sizes[] = {0, 1, 3, 1000, 100003};
+    int* hits = calloc(100003, sizeof(int));
+    for (int round = 0; round < 10; round++) {
+        for (int s = 0; s < 5; s++) {
+            for (int i = 0; i < sizes[s]; i++) hits[i] = 0;
+            threadPoolFor(pool, sizes[s], countTask, hits);
+            int ranOnce = 1;
+            for (int i = 0; i < sizes[s]; i++) ranOnce &= hits[i] == 1;
+            t_assert(ranOnce, "every item ran once");
+        }
+    }
+    free(hits);
+    destroyThreadPool(pool);
+
+    ThreadPool* defaultPool = createThreadPool(0);
+    t_assert(defaultPool != NULL && threadPoolSize(defaultPool) >= 1,
+             "created pool of every processor");
+    destroyThreadPool(defaultPool);
+}
+
+TEST(batchParallelMatches) {
+    ThreadPool* pool = createThreadPool(NUM_THREADS);
+    double* lat = malloc(NUM_BATCH_POINTS * sizeof(double));
+    double* lon = malloc(NUM_BATCH_POINTS * sizeof(double));
+    for (int i = 0; i < NUM_BATCH_POINTS; i++) {
+        lat[i] = (i % 181) * 0.0173 - 1.56;
+        lon[i] = (i / 181) * 0.0566 - 3.14;
+    }
+
+    // Coarse cells give boundaries of every number of vertices
+    H3Index* expected = malloc(NUM_BATCH_POINTS * sizeof(H3Index));
+    H3Index* out = malloc(NUM_BATCH_POINTS * sizeof(H3Index));
+    for (int res = 1; res <= RES; res += RES - 1) {
+        H3_EXPORT(geoToH3Batch)(lat, lon, NUM_BATCH_POINTS, res, expected);
+        H3_EXPORT(geoToH3BatchParallel)
+        (lat, lon, NUM_BATCH_POINTS, res, out, threadPoolFor, pool);
+        t_assert(!memcmp(out, expected, NUM_BATCH_POINTS * sizeof(H3Index)),
+                 "geoToH3BatchParallel matches");
+
+        H3_EXPORT(h3ToParentBatch)
+        (expected, NUM_BATCH_POINTS, res - 1, out);
+        H3Index* parents = malloc(NUM_BATCH_POINTS * sizeof(H3Index));
+        H3_EXPORT(h3ToParentBatchParallel)
+        (expected, NUM_BATCH_POINTS, res - 1, parents, threadPoolFor, pool);
+        t_assert(!memcmp(out, parents, NUM_BATCH_POINTS * sizeof(H3Index)),
+                 "h3ToParentBatchParallel matches");
+        free(parents);
+
+        double* centers = malloc(4 * NUM_BATCH_POINTS * sizeof(double));
+        H3_EXPORT(h3ToGeoBatch)
+        (expected, NUM_BATCH_POINTS, centers, centers + NUM_BATCH_POINTS);
+        H3_EXPORT(h3ToGeoBatchParallel)
+        (expected, NUM_BATCH_POINTS, centers + 2 * NUM_BATCH_POINTS,
+         centers + 3 * NUM_BATCH_POINTS, threadPoolFor, pool);
+        t_assert(!memcmp(centers, centers + 2 * NUM_BATCH_POINTS,
+                         2 * NUM_BATCH_POINTS * sizeof(double)),
+                 "h3ToGeoBatchParallel matches");
+        free(centers);
+
+        size_t vertsSize =
+            2 * NUM_BATCH_POINTS * MAX_CELL_BNDRY_VERTS * sizeof(double);
+        double* expectedVerts = malloc(vertsSize);
+        double* verts = malloc(vertsSize);
+        int* expectedNumVerts = malloc(NUM_BATCH_POINTS * sizeof(int));
+        int* numVerts = malloc(NUM_BATCH_POINTS * sizeof(int));
+        int expectedTotal = H3_EXPORT(h3ToGeoBoundaryBatch)(
+            expected, NUM_BATCH_POINTS, expectedVerts, expectedNumVerts);
+        int total = H3_EXPORT(h3ToGeoBoundaryBatchParallel)(
+            expected, NUM_BATCH_POINTS, verts, numVerts, threadPoolFor, pool);
+        t_assert(total == expectedTotal, "same number of vertices");
+        t_assert(!memcmp(numVerts, expectedNumVerts,
+                         NUM_BATCH_POINTS * sizeof(int)),
+                 "same vertex counts");
+        t_assert(!memcmp(verts, expectedVerts, 2 * total * sizeof(double)),
+                 "h3ToGeoBoundaryBatchParallel matches");
+        free(numVerts);
+        free(expectedNumVerts);
+        free(verts);
+        free(expectedVerts);
+    }
+
+    free(out);
+    free(expected);
+    free(lon);
+    free(lat);
+    destroyThreadPool(pool);
+}
+
+TEST(aggregateParallelMatches) {
+    ThreadPool* pool = createThreadPool(NUM_THREADS);
+    double* lat = malloc(NUM_AGGREGATE_POINTS * sizeof(double));
+    double* lon = malloc(NUM_AGGREGATE_POINTS * sizeof(double));
+    double* values = malloc(NUM_AGGREGATE_POINTS * sizeof(double));
+    for (int i = 0; i < NUM_AGGREGATE_POINTS; i++) {
+        lat[i] = (i % 997) * 0.0001 + 0.65;
+        lon[i] = (i / 997) * 0.0001 - 2.14;
+        values[i] = i % 7;
+    }
+
+    H3Aggregate* expected = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePoints)
+    (expected, lat, lon, values, NUM_AGGREGATE_POINTS);
+    H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(RES, 0);
+    H3_EXPORT(h3AggregatePointsParallel)
+    (agg, lat, lon, values, NUM_AGGREGATE_POINTS, threadPoolFor, pool);
+
+    int size = H3_EXPORT(h3AggregateSize)(expected);
+    t_assert(H3_EXPORT(h3AggregateSize)(agg) == size, "same size");
+    H3Index* cells = malloc(size * sizeof(H3Index));
+    int64_t* counts = malloc(size * sizeof(int64_t));
+    double* sums = malloc(size * sizeof(double));
+    H3_EXPORT(h3AggregateToArrays)(expected, cells, counts, sums);
+    for (int i = 0; i < size; i++) {
+        int64_t count;
+        double sum;
+        H3_EXPORT(h3AggregateGet)(agg, cells[i], &count, &sum);
+        t_assert(count == counts[i] && sum == sums[i],
+                 "h3AggregatePointsParallel matches");
+    }
+
+    free(sums);
+    free(counts);
+    free(cells);
+    H3_EXPORT(destroyH3Aggregate)(agg);
+    H3_EXPORT(destroyH3Aggregate)(expected);
+    free(values);
+    free(lon);
+    free(lat);
+    destroyThreadPool(pool);
+}
+
+END_TESTS();
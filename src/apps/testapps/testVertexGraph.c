@@ -16,6 +16,9 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include "algos.h"
+#include "constants.h"
 #include "geoCoord.h"
 #include "h3api.h"
 #include "test.h"
@@ -51,7 +54,7 @@ TEST(vertexHash) {
     uint32_t hash2;
     int numBuckets = 1000;
 
-    for (int res = 0; res < 11; res++) {
+    for (int res = 0; res <= MAX_H3_RES; res++) {
         centerIndex = H3_EXPORT(geoToH3)(&center, res);
         H3_EXPORT(h3ToGeoBoundary)(centerIndex, &outline);
         for (int i = 0; i < outline.numVerts; i++) {
@@ -63,6 +66,37 @@ TEST(vertexHash) {
     }
 }
 
+TEST(vertexHashDistribution) {
+    // The graph of a disk holds the edges of its outline, which run in every
+    // direction, including along diagonals of constant lat + lon
+    int k = 30;
+    int numHexes = H3_EXPORT(maxKringSize)(k);
+    H3Index* disk = calloc(numHexes, sizeof(H3Index));
+    for (int res = 9; res <= MAX_H3_RES; res++) {
+        H3Index origin = H3_EXPORT(geoToH3)(&center, res);
+        H3_EXPORT(kRing)(origin, k, disk);
+        VertexGraph graph;
+        h3SetToVertexGraph(disk, numHexes, &graph);
+        t_assert(graph.size == 6 * (2 * k + 1), "graph holds the outline");
+
+        // Probes to find every node, and the longest chain
+        int probes = 0;
+        int maxChain = 0;
+        for (int i = 0; i < graph.numBuckets; i++) {
+            int chain = 0;
+            for (VertexNode* node = graph.buckets[i]; node; node = node->next) {
+                chain++;
+                probes += chain;
+            }
+            if (chain > maxChain) maxChain = chain;
+        }
+        t_assert(probes < 2 * graph.size, "few probes per lookup");
+        t_assert(maxChain <= 4, "no long chains");
+        destroyVertexGraph(&graph);
+    }
+    free(disk);
+}
+
 TEST(addVertexNode) {
     VertexGraph graph;
     initVertexGraph(&graph, 10, 9);
@@ -291,4 +325,28 @@ TEST(singleBucketVertexGraph) {
     destroyVertexGraph(&graph);
 }
 
+TEST(vertexNodeStorageReuse) {
+    VertexGraph graph;
+    initVertexGraph(&graph, 2, 9);
+    VertexNode* node;
+    VertexNode* reused;
+
+    node = addVertexNode(&graph, &vertex1, &vertex2);
+    t_assert(removeVertexNode(&graph, node) == 0, "Removal successful");
+    reused = addVertexNode(&graph, &vertex2, &vertex3);
+    t_assert(reused == node, "Removed node storage is reused");
+
+    // Grow past the initial slab; earlier nodes must not move
+    addVertexNode(&graph, &vertex3, &vertex4);
+    addVertexNode(&graph, &vertex4, &vertex1);
+    addVertexNode(&graph, &vertex1, &vertex3);
+    t_assert(graph.size == 4, "Graph size updated");
+    t_assert(findNodeForEdge(&graph, &vertex2, &vertex3) == reused,
+             "Node pointer stable after growth");
+    t_assert(findNodeForEdge(&graph, &vertex1, &vertex3) != NULL,
+             "Node in new slab found");
+
+    destroyVertexGraph(&graph);
+}
+
 END_TESTS();
@@ -24,14 +24,15 @@
 #include "coordijk.h"
 #include "h3api.h"
 #include "linkedGeo.h"
+#include "preparedPolygon.h"
 #include "vertexGraph.h"
 
 // neighbor along the ijk coordinate system of the current face, rotated
 H3Index h3NeighborRotations(H3Index origin, int dir, int* rotations);
 
 // k-ring implementation
-void _kRingInternal(H3Index origin, int k, H3Index* out, int* distances,
-                    int maxIdx, int curK);
+int _kRingInternal(H3Index origin, int k, H3Index* out, int* distances,
+                   int maxIdx, int curK);
 
 // Create a vertex graph from a set of hexagons
 void h3SetToVertexGraph(const H3Index* h3Set, const int numHexes,
@@ -41,7 +42,15 @@ void h3SetToVertexGraph(const H3Index* h3Set, const int numHexes,
 void _vertexGraphToLinkedGeo(VertexGraph* graph, LinkedGeoPolygon* out);
 
 // Point in poly internal implementation
+double _normalizeLng(double lng, bool isTransmeridian);
 bool _pointInPolyContainsLoop(const Geofence* geofence, const BBox* bbox,
                               const GeoCoord* coord);
+bool _pointInPolyContains(const GeoPolygon* geoPolygon, const BBox* bboxes,
+                          const GeoCoord* coord);
+
+// Hierarchical polyfill internals
+void _descendantsBBox(H3Index h3, BBox* bbox);
+void _polyfillFromCell(const PreparedGeoPolygon* prepared, H3Index h3,
+                       int res, H3Index* out, int outSize, int* numOut);
 
 #endif
@@ -20,6 +20,7 @@
 #ifndef BASECELLS_H
 #define BASECELLS_H
 
+#include <stdint.h>
 #include "constants.h"
 #include "coordijk.h"
 #include "faceijk.h"
@@ -42,6 +43,13 @@ extern const int baseCellNeighbor60CCWRots[NUM_BASE_CELLS][7];
 // resolution 0 base cell data lookup-table (global)
 extern const BaseCellData baseCellData[NUM_BASE_CELLS];
 
+/** resolution of the cells marked in baseCellNoOverage */
+#define NO_OVERAGE_RES 2
+
+// cells of resolution NO_OVERAGE_RES, by bit digit1 * 8 + digit2, whose
+// descendants never need an overage adjustment (global)
+extern const uint64_t baseCellNoOverage[NUM_BASE_CELLS];
+
 /** Maximum input for any component to face-to-base-cell lookup functions */
 #define MAX_FACE_COORD 2
 
@@ -52,5 +60,7 @@ int _faceIjkToBaseCellCCWrot60(const FaceIJK* h);
 void _baseCellToFaceIjk(int baseCell, FaceIJK* h);
 bool _baseCellIsCwOffset(int baseCell, int testFace);
 int _getBaseCellNeighbor(int baseCell, int dir);
+int _getBaseCellDirection(int originBaseCell, int neighboringBaseCell);
+int _isBaseCellPolarPentagon(int baseCell);
 
 #endif
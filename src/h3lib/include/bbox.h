@@ -39,6 +39,9 @@ void bboxesFromGeoPolygon(const GeoPolygon* polygon, BBox* bboxes);
 bool bboxIsTransmeridian(const BBox* bbox);
 void bboxCenter(const BBox* bbox, GeoCoord* center);
 bool bboxContains(const BBox* bbox, const GeoCoord* point);
+bool bboxIntersects(const BBox* a, const BBox* b);
 int bboxHexRadius(const BBox* bbox, int res);
+int circleHexRadius(double radiusKm, int res);
+double _hexRadiusKm(H3Index h3Index);
 
 #endif
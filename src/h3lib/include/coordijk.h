@@ -31,6 +31,7 @@
 #define COORDIJK_H
 
 #include "geoCoord.h"
+#include "h3api.h"
 #include "vec2d.h"
 
 /** @struct CoordIJK
@@ -70,6 +71,8 @@ static const CoordIJK UNIT_VECS[] = {
 #define IK_AXES_DIGIT (I_AXES_DIGIT | K_AXES_DIGIT) /* 5 */
 /** H3 digit in i == j direction */
 #define IJ_AXES_DIGIT (I_AXES_DIGIT | J_AXES_DIGIT) /* 6 */
+/** Value indicating an invalid H3 digit */
+#define INVALID_DIGIT -1
 
 // Internal functions
 
@@ -84,6 +87,11 @@ void _ijkNormalize(CoordIJK* c);
 int _unitIjkToDigit(const CoordIJK* ijk);
 void _upAp7(CoordIJK* ijk);
 void _upAp7r(CoordIJK* ijk);
+int _upAp7Digit(CoordIJK* ijk);
+int _upAp7rDigit(CoordIJK* ijk);
+void _upAp7Digits(CoordIJK* ijk, int res, int* digits);
+void _upAp7DigitsPath(CoordIJK* ijk, int res, int* digits, CoordIJ* path);
+void _downAp7Digits(CoordIJK* ijk, int res, const int* digits);
 void _downAp7(CoordIJK* ijk);
 void _downAp7r(CoordIJK* ijk);
 void _downAp3(CoordIJK* ijk);
@@ -93,5 +101,10 @@ void _ijkRotate60ccw(CoordIJK* ijk);
 void _ijkRotate60cw(CoordIJK* ijk);
 int _rotate60ccw(int digit);
 int _rotate60cw(int digit);
+int _ijkDistance(const CoordIJK* a, const CoordIJK* b);
+void _ijkToIj(const CoordIJK* ijk, CoordIJ* ij);
+void _ijToIjk(const CoordIJ* ij, CoordIJK* ijk);
+void _ijkToCube(CoordIJK* ijk);
+void _cubeToIjk(CoordIJK* ijk);
 
 #endif
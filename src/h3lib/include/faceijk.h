@@ -27,6 +27,7 @@
 #include "coordijk.h"
 #include "geoCoord.h"
 #include "vec2d.h"
+#include "vec3d.h"
 
 /** @struct FaceIJK
  * @brief Face number and ijk coordinates on that face-centered coordinate
@@ -59,15 +60,44 @@ typedef struct {
 /** JK quadrant faceNeighbors table direction */
 #define JK 3
 
+// face tables, also read directly by the tests
+extern const GeoCoord faceCenterGeo[NUM_ICOSA_FACES];
+extern const Vec3d faceCenterPoint[NUM_ICOSA_FACES];
+extern const double faceAxesAzRadsCII[NUM_ICOSA_FACES][3];
+extern const Vec3d faceAxesCII[NUM_ICOSA_FACES][2];
+
+/** Maximum number of points processed by _geoToFaceIjkBatch */
+#define FACE_BATCH_SIZE 64
+
+/** Longest great circle arc, in radians, walked by _vec3dArcToCells */
+#define MAX_CELL_ARC_RADS 0.5
+
+/** @struct CellPath
+ * @brief Cells crossed by arcs, in order and with repeats of the last cell
+ * skipped; cells past outSize are counted but not written
+ */
+typedef struct {
+    H3Index* out;  ///< output buffer
+    int outSize;   ///< number of indexes out can hold
+    int count;     ///< number of indexes in the path
+    H3Index last;  ///< last index in the path
+} CellPath;
+
 // Internal functions
 
 void _geoToFaceIjk(const GeoCoord* g, int res, FaceIJK* h);
 void _geoToHex2d(const GeoCoord* g, int res, int* face, Vec2d* v);
+void _geoToFaceIjkMulti(const GeoCoord* g, int finestRes, FaceIJK* h);
+void _geoToFaceIjkBatch(const double* lat, const double* lon, int n, int res,
+                        FaceIJK* h);
 void _faceIjkToGeo(const FaceIJK* h, int res, GeoCoord* g);
 void _faceIjkToGeoBoundary(const FaceIJK* h, int res, int isPentagon,
-                           GeoBoundary* g);
-void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g);
+                           GeoBoundary* g, int* vertexOffsets);
+void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g,
+                               int* vertexOffsets);
 void _hex2dToGeo(const Vec2d* v, int face, int res, int substrate, GeoCoord* g);
+void _vec3dArcToCells(const Vec3d* a, const Vec3d* b, int res,
+                      CellPath* path);
 int _adjustOverageClassII(FaceIJK* fijk, int res, int pentLeading4,
                           int substrate);
 
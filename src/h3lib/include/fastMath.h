@@ -0,0 +1,227 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file fastMath.h
+ * @brief   Trigonometric functions of the encoding and decoding paths, which
+ * are polynomial approximations when built with H3_FAST_MATH
+ *
+ * _h3Sin, _h3Cos and the rest call the libm functions, unless the library is
+ * built with H3_FAST_MATH, when they call the _fast approximations below.
+ * These are near minimax polynomials, interpolated at Chebyshev nodes, on a
+ * reduced range: sin and cos on [-pi/4, pi/4] after subtracting a multiple of
+ * pi/2, and atan on [-1/16, 1/16] after subtracting the nearest of nine
+ * tabulated arguments k/8. The rest are composed from these. They stay within
+ * a few units in the last place of libm, are inlined, and have no slow paths;
+ * arguments they do not reduce (huge, infinite or NaN) are passed to libm.
+ */
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <math.h>
+#include "constants.h"
+
+/** largest magnitude reduced by a multiple of pi/2 */
+#define FAST_MATH_MAX_REDUCE 1.0e5
+
+/** pi/2 to 33 bits, so that multiples up to 2^20 of it are exact */
+#define FAST_MATH_PI_2_HI 1.57079632673412561e+00
+/** pi/2 - FAST_MATH_PI_2_HI */
+#define FAST_MATH_PI_2_LO 6.07710050650619225e-11
+/** 2/pi */
+#define FAST_MATH_2_PI 6.36619772367581382e-01
+
+/** atan(k / 8) for k from 0 to 8 */
+static const double _fastAtanTable[9] = {
+    0.00000000000000000e+00, 1.24354994546761438e-01, 2.44978663126864143e-01,
+    3.58770670270572245e-01, 4.63647609000806094e-01, 5.58599315343562441e-01,
+    6.43501108793284371e-01, 7.18829999621624527e-01, 7.85398163397448279e-01};
+
+/**
+ * Reduces an angle to [-pi/4, pi/4] by subtracting a multiple of pi/2.
+ *
+ * @param x The angle, of magnitude less than FAST_MATH_MAX_REDUCE
+ * @param quadrant Output: the multiple of pi/2 subtracted, modulo 4
+ * @return The reduced angle
+ */
+static inline double _fastReduceAngle(double x, int* quadrant) {
+    int k = (int)(x * FAST_MATH_2_PI + (x < 0 ? -0.5 : 0.5));
+    double kd = (double)k;
+    *quadrant = k & 3;
+    return (x - kd * FAST_MATH_PI_2_HI) - kd * FAST_MATH_PI_2_LO;
+}
+
+/**
+ * sin on [-pi/4, pi/4].
+ *
+ * @param r The reduced angle
+ * @param z r * r
+ */
+static inline double _fastSinKernel(double r, double z) {
+    return r + r * z *
+                   (-1.66666666666666657e-01 +
+                    z * (8.33333333333094797e-03 +
+                         z * (-1.98412698367585736e-04 +
+                              z * (2.75573161025524389e-06 +
+                                   z * (-2.50511318450036243e-08 +
+                                        z * 1.59181292948666079e-10)))));
+}
+
+/**
+ * cos on [-pi/4, pi/4].
+ *
+ * @param z The square of the reduced angle
+ */
+static inline double _fastCosKernel(double z) {
+    return 1.0 - 0.5 * z +
+           z * z *
+               (4.16666666666666644e-02 +
+                z * (-1.38888888888873976e-03 +
+                     z * (2.48015872987656891e-05 +
+                          z * (-2.75573172717297931e-07 +
+                               z * (2.08761462684031992e-09 +
+                                    z * -1.13826324255217172e-11)))));
+}
+
+/**
+ * atan on [0, 1].
+ *
+ * @param t The argument
+ */
+static inline double _fastAtanUnit(double t) {
+    int k = (int)(t * 8.0 + 0.5);
+    double c = k * 0.125;
+    // atan(t) = atan(c) + atan(u), with |u| <= 1/16
+    double u = (t - c) / (1.0 + t * c);
+    double z = u * u;
+    return _fastAtanTable[k] +
+           (u + u * z *
+                    (-3.33333333333169057e-01 +
+                     z * (1.99999998654123518e-01 +
+                          z * (-1.42855419174492265e-01 +
+                               z * 1.10404098793314698e-01))));
+}
+
+/** Polynomial approximation of sin. */
+static inline double _fastSin(double x) {
+    if (!(fabs(x) < FAST_MATH_MAX_REDUCE)) return sin(x);
+    int quadrant;
+    double r = _fastReduceAngle(x, &quadrant);
+    double z = r * r;
+    double v = (quadrant & 1) ? _fastCosKernel(z) : _fastSinKernel(r, z);
+    return (quadrant & 2) ? -v : v;
+}
+
+/** Polynomial approximation of cos. */
+static inline double _fastCos(double x) {
+    if (!(fabs(x) < FAST_MATH_MAX_REDUCE)) return cos(x);
+    int quadrant;
+    double r = _fastReduceAngle(x, &quadrant);
+    double z = r * r;
+    double v = (quadrant & 1) ? _fastSinKernel(r, z) : _fastCosKernel(z);
+    return ((quadrant + 1) & 2) ? -v : v;
+}
+
+/** Polynomial approximation of tan. */
+static inline double _fastTan(double x) {
+    if (!(fabs(x) < FAST_MATH_MAX_REDUCE)) return tan(x);
+    int quadrant;
+    double r = _fastReduceAngle(x, &quadrant);
+    double z = r * r;
+    double s = _fastSinKernel(r, z);
+    double c = _fastCosKernel(z);
+    return (quadrant & 1) ? -c / s : s / c;
+}
+
+/** Polynomial approximation of atan. */
+static inline double _fastAtan(double x) {
+    double ax = fabs(x);
+    if (!(ax <= 1.0)) {
+        if (!(ax <= HUGE_VAL)) return atan(x);
+        double r = M_PI_2 - _fastAtanUnit(1.0 / ax);
+        return x < 0 ? -r : r;
+    }
+    double r = _fastAtanUnit(ax);
+    return x < 0 ? -r : r;
+}
+
+/** Polynomial approximation of atan2. */
+static inline double _fastAtan2(double y, double x) {
+    double ax = fabs(x);
+    double ay = fabs(y);
+    double mx = ay > ax ? ay : ax;
+    double mn = ay > ax ? ax : ay;
+    // zeros, infinities and NaNs
+    if (!(mn >= 0 && mx > 0 && mx < HUGE_VAL)) return atan2(y, x);
+    double r = _fastAtanUnit(mn / mx);
+    if (ay > ax) r = M_PI_2 - r;
+    if (x < 0) r = M_PI - r;
+    return signbit(y) ? -r : r;
+}
+
+/** Polynomial approximation of asin. */
+static inline double _fastAsin(double x) {
+    if (!(fabs(x) <= 1.0)) return asin(x);
+    return _fastAtan2(x, sqrt((1.0 - x) * (1.0 + x)));
+}
+
+/** Polynomial approximation of acos. */
+static inline double _fastAcos(double x) {
+    if (!(fabs(x) <= 1.0)) return acos(x);
+    return _fastAtan2(sqrt((1.0 - x) * (1.0 + x)), x);
+}
+
+#ifdef H3_FAST_MATH
+#define H3_FAST_MATH_CALL(fast, exact) fast
+#else
+#define H3_FAST_MATH_CALL(fast, exact) exact
+#endif
+
+/** sin, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Sin(double x) {
+    return H3_FAST_MATH_CALL(_fastSin, sin)(x);
+}
+
+/** cos, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Cos(double x) {
+    return H3_FAST_MATH_CALL(_fastCos, cos)(x);
+}
+
+/** tan, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Tan(double x) {
+    return H3_FAST_MATH_CALL(_fastTan, tan)(x);
+}
+
+/** atan, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Atan(double x) {
+    return H3_FAST_MATH_CALL(_fastAtan, atan)(x);
+}
+
+/** atan2, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Atan2(double y, double x) {
+    return H3_FAST_MATH_CALL(_fastAtan2, atan2)(y, x);
+}
+
+/** asin, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Asin(double x) {
+    return H3_FAST_MATH_CALL(_fastAsin, asin)(x);
+}
+
+/** acos, or its approximation when built with H3_FAST_MATH */
+static inline double _h3Acos(double x) {
+    return H3_FAST_MATH_CALL(_fastAcos, acos)(x);
+}
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Aggregate.h
+ * @brief   Counts and sums of values of points grouped by hexagon
+ */
+
+#ifndef H3AGGREGATE_H
+#define H3AGGREGATE_H
+
+#include "h3api.h"
+
+/** @brief The count and sum of the points of one hexagon */
+typedef struct {
+    H3Index cell;   ///< the hexagon, or 0 for an empty slot
+    int64_t count;  ///< the number of points
+    double sum;     ///< the sum of the values of the points
+} H3AggregateSlot;
+
+/** @brief Open addressed hash map from hexagons to counts and sums */
+struct H3Aggregate {
+    int res;                 ///< the resolution of the hexagons
+    int mask;                ///< the number of slots minus one, a power of 2
+    int size;                ///< the number of hexagons
+    H3AggregateSlot* slots;  ///< the slots
+};
+
+#endif
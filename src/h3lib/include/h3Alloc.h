@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Alloc.h
+ * @brief   Memory management functions used by the library
+ *
+ * All heap memory is managed through H3_MEMORY. When the library is built
+ * with H3_ALLOC_PREFIX defined, the prefixed functions, for example
+ * `myprefix_malloc` for `H3_ALLOC_PREFIX=myprefix_`, must be provided by the
+ * application and are used instead of the standard library functions.
+ * They are named by H3_ALLOC_FUNC. With H3_ENABLE_STATS, H3_MEMORY counts
+ * each allocation before calling them.
+ */
+
+#ifndef H3ALLOC_H
+#define H3ALLOC_H
+
+#include <stdlib.h>
+
+#define H3_ALLOC_XJOIN(a, b) a##b
+#define H3_ALLOC_JOIN(a, b) H3_ALLOC_XJOIN(a, b)
+
+#ifdef H3_ALLOC_PREFIX
+/* joins the user provided prefix with the standard function name */
+#define H3_ALLOC_FUNC(name) H3_ALLOC_JOIN(H3_ALLOC_PREFIX, name)
+
+void* H3_ALLOC_FUNC(malloc)(size_t size);
+void* H3_ALLOC_FUNC(calloc)(size_t num, size_t size);
+void* H3_ALLOC_FUNC(realloc)(void* ptr, size_t size);
+void H3_ALLOC_FUNC(free)(void* ptr);
+#else
+#define H3_ALLOC_FUNC(name) name
+#endif
+
+#ifdef H3_ENABLE_STATS
+/* counts the allocation, then calls H3_ALLOC_FUNC(name), see h3Stats.c */
+#define H3_MEMORY(name) H3_ALLOC_JOIN(_h3Stats_, name)
+
+void* H3_MEMORY(malloc)(size_t size);
+void* H3_MEMORY(calloc)(size_t num, size_t size);
+void* H3_MEMORY(realloc)(void* ptr, size_t size);
+void H3_MEMORY(free)(void* ptr);
+#else
+#define H3_MEMORY(name) H3_ALLOC_FUNC(name)
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Bitmap.h
+ * @brief   Dense bitmaps of every hexagon of a coarse resolution
+ */
+
+#ifndef H3BITMAP_H
+#define H3BITMAP_H
+
+#include "h3api.h"
+
+/** @brief One bit for each hexagon of a resolution, by ordinal */
+struct H3Bitmap {
+    int res;          ///< the resolution of the hexagons
+    int64_t numBits;  ///< the number of hexagons at the resolution
+    uint64_t* words;  ///< bit i % 64 of word i / 64 is set for ordinal i
+};
+
+int64_t _h3NumDescendants(int isPentagon, int numLevels);
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3CompactSet.h
+ * @brief   Sets of hexagons of a resolution kept compacted as they change
+ */
+
+#ifndef H3COMPACTSET_H
+#define H3COMPACTSET_H
+
+#include "h3IndexSet.h"
+#include "h3api.h"
+
+/** @brief The compacted hexagons of a set, hashed */
+struct H3CompactSet {
+    int res;            ///< the resolution of the hexagons added
+    H3IndexSet* hexes;  ///< the compacted hexagons, of res or coarser
+};
+
+#endif
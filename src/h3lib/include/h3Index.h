@@ -147,15 +147,32 @@
  */
 #define H3_INVALID_INDEX 0
 
+/** @struct DecodedCell
+ * @brief An index decoded once for its center, boundary and edge queries
+ */
+typedef struct {
+    FaceIJK fijk;    ///< the center of the cell, adjusted for any overage
+    int res;         ///< the resolution of the cell
+    int isPentagon;  ///< whether the cell is a pentagon
+} DecodedCell;
+
 void setH3Index(H3Index* h, int res, int baseCell, int initDigit);
 int isResClassIII(int res);
 
 // Internal functions
 
 H3Index _faceIjkToH3(const FaceIJK* fijk, int res);
+H3Index _faceIjkBaseCellToH3(H3Index h, const FaceIJK* fijkBC);
+int _h3ToFaceIjkWithInitializedFijk(H3Index h, FaceIJK* fijk);
+void _h3ToFaceIjk(H3Index h, FaceIJK* fijk);
+void _h3ToDecodedCell(H3Index h, DecodedCell* cell);
+void _decodedCellToGeo(const DecodedCell* cell, GeoCoord* g);
+void _decodedCellToGeoBoundary(const DecodedCell* cell, GeoBoundary* gb);
 int _h3LeadingNonZeroDigit(H3Index h);
 H3Index _h3RotatePent60ccw(H3Index h);
+H3Index _h3RotatePent60cw(H3Index h);
 H3Index _h3Rotate60ccw(H3Index h);
 H3Index _h3Rotate60cw(H3Index h);
+H3Index* _radixSortH3Indexes(H3Index* h3Set, H3Index* temp, int numHexes);
 
 #endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3IndexSet.h
+ * @brief   Open addressed hash sets of indexes
+ */
+
+#ifndef H3INDEXSET_H
+#define H3INDEXSET_H
+
+#include "h3api.h"
+
+/** @brief Open addressed hash set with linear probing */
+struct H3IndexSet {
+    H3Index* slots;  ///< the indexes, or 0 for empty slots
+    int mask;        ///< the number of slots minus one, a power of two
+    int size;        ///< the number of indexes in the set
+};
+
+/**
+ * Mixes all 64 bits of an index into the low bits, with the finalizer of
+ * splitmix64. The low bits of coarse indexes are all 1's, and neighboring
+ * indexes differ in only a few digits, so indexes are hashed with it before
+ * choosing a slot.
+ *
+ * @param h The index
+ * @return The hash of the index
+ */
+static inline uint64_t _h3IndexHash(H3Index h) {
+    h ^= h >> 30;
+    h *= UINT64_C(0xbf58476d1ce4e5b9);
+    h ^= h >> 27;
+    h *= UINT64_C(0x94d049bb133111eb);
+    h ^= h >> 31;
+    return h;
+}
+
+/**
+ * The first slot to probe for an index in a table of any size.
+ *
+ * @param h The index
+ * @param numSlots The number of slots in the table
+ * @return The slot
+ */
+static inline int _h3IndexSlot(H3Index h, int numSlots) {
+    return (int)(_h3IndexHash(h) % (uint64_t)numSlots);
+}
+
+#endif
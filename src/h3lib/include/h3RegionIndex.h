@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3RegionIndex.h
+ * @brief   Flat, position independent index of regions by compacted hexagons
+ */
+
+#ifndef H3REGIONINDEX_H
+#define H3REGIONINDEX_H
+
+#include <stdint.h>
+#include "constants.h"
+#include "h3api.h"
+
+/** Bytes starting every region index */
+#define H3_REGION_INDEX_MAGIC "H3REGION"
+/** Written in the byte order of the builder, to detect a different one */
+#define H3_REGION_INDEX_BYTE_ORDER 0x01020304
+/** Version of the layout */
+#define H3_REGION_INDEX_VERSION 1
+
+/**
+ * @brief The start of a region index, followed by the keys of its hexagons
+ * as uint64_t and then their region ids as int32_t.
+ */
+typedef struct {
+    char magic[8];        ///< H3_REGION_INDEX_MAGIC, without a terminator
+    uint32_t byteOrder;   ///< H3_REGION_INDEX_BYTE_ORDER
+    uint32_t version;     ///< H3_REGION_INDEX_VERSION
+    int32_t res;          ///< resolution points are indexed at
+    uint32_t reserved;    ///< 0
+    uint64_t numRanges;   ///< the number of hexagons
+    /** first hexagon of each base cell, and the number of hexagons */
+    uint64_t baseCellStarts[NUM_BASE_CELLS + 1];
+} H3RegionIndexHeader;
+
+PolyfillCell* _radixSortPolyfillCells(PolyfillCell* cells, PolyfillCell* temp,
+                                      int numCells);
+void* _h3RegionIndexFromSortedCells(const PolyfillCell* sorted, int numCells,
+                                    const int* regionIds, int res,
+                                    size_t* size);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3SetBinary.h
+ * @brief   Compact binary encoding of sets of hexagons
+ */
+
+#ifndef H3SETBINARY_H
+#define H3SETBINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "h3api.h"
+
+/** Bytes starting every encoding: "H3S" and the format version */
+#define H3_SET_BINARY_MAGIC "H3S\x01"
+/** Length of the magic bytes */
+#define H3_SET_BINARY_MAGIC_SIZE 4
+/** Most bytes of a varint of 32 bits */
+#define H3_SET_BINARY_MAX_COUNT_BYTES 5
+/** Most bytes of a varint of a 52 bit position */
+#define H3_SET_BINARY_MAX_POSITION_BYTES 8
+
+size_t _writeVarint(uint64_t value, uint8_t* out);
+size_t _readVarint(const uint8_t* in, size_t size, uint64_t* value);
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Shard.h
+ * @brief   Tables of contiguous ranges of hexagons assigned to shards
+ */
+
+#ifndef H3SHARD_H
+#define H3SHARD_H
+
+#include "h3api.h"
+
+/** @brief The first hexagon of each shard, in index order */
+struct H3ShardTable {
+    int res;              ///< the resolution of the range boundaries
+    int numShards;        ///< the number of shards
+    H3Index* starts;      ///< the first hexagon at res of each shard
+    double* weights;      ///< the weight of each shard, 0 if not known
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3SortedSet.h
+ * @brief   Immutable sets of hexagons sorted for containment queries
+ */
+
+#ifndef H3SORTEDSET_H
+#define H3SORTEDSET_H
+
+#include "h3Index.h"
+#include "h3api.h"
+
+/**
+ * 1's in the base cell and digit bits, 0's everywhere else. Masking an index
+ * with it gives the key the set is sorted by.
+ */
+#define H3_SORTED_SET_KEY_MASK ((UINT64_C(1) << H3_RES_OFFSET) - 1)
+
+/** @brief Disjoint hexagons of mixed resolution, sorted by key */
+struct H3SortedSet {
+    int numKeys;    ///< the number of hexagons in the set
+    H3Index* keys;  ///< the hexagons masked to their keys, in ascending order
+};
+
+H3Index _h3SortedSetRangeStart(H3Index key);
+int _h3SortedSetKeyRes(H3Index key);
+int _h3SortedSetKeyIsPentagon(H3Index key, int res);
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Stats.h
+ * @brief   Hot path counters, collected when built with H3_ENABLE_STATS
+ *
+ * The counters are kept per thread, so counting needs no synchronization.
+ * Without H3_ENABLE_STATS, H3_STAT_ADD and H3_STAT_MAX expand to nothing.
+ */
+
+#ifndef H3STATS_H
+#define H3STATS_H
+
+#include "h3api.h"
+
+#ifdef H3_ENABLE_STATS
+#ifdef _MSC_VER
+#define H3_THREAD_LOCAL __declspec(thread)
+#else
+#define H3_THREAD_LOCAL _Thread_local
+#endif
+
+/** counters of the calling thread */
+extern H3_THREAD_LOCAL H3Stats _h3Stats;
+
+/** adds n to the counter field of the calling thread */
+#define H3_STAT_ADD(field, n) (_h3Stats.field += (uint64_t)(n))
+/** raises the counter field of the calling thread to at least n */
+#define H3_STAT_MAX(field, n)                     \
+    (_h3Stats.field < (uint64_t)(n)               \
+         ? (void)(_h3Stats.field = (uint64_t)(n)) \
+         : (void)0)
+#else
+#define H3_STAT_ADD(field, n) ((void)0)
+#define H3_STAT_MAX(field, n) ((void)0)
+#endif
+
+#endif
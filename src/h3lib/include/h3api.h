@@ -59,6 +59,9 @@ typedef uint64_t H3Index;
  */
 #define MAX_CELL_BNDRY_VERTS 10
 
+/** Fixed point units per degree of packed centers: microdegrees */
+#define H3_PACKED_UNITS_PER_DEGREE 1000000
+
 /** @struct GeoCoord
     @brief latitude/longitude in radians
 */
@@ -129,6 +132,83 @@ struct LinkedGeoPolygon {
     LinkedGeoPolygon *next;
 };
 
+/** @struct FlatGeoMultiPolygon
+ *  @brief Polygons stored in flat arrays, in the same layout as GeoArrow and
+ *  WKB multipolygons. Polygon p is made of the loops polygonOffsets[p] up to
+ *  polygonOffsets[p + 1], the first being its outer loop, and loop l of the
+ *  coordinates loopOffsets[l] up to loopOffsets[l + 1]. Loops are not closed,
+ *  so the first coordinate of a loop is not repeated at its end.
+ */
+typedef struct {
+    int numPolygons;      ///< number of polygons
+    int numLoops;         ///< number of loops in all polygons
+    int numCoords;        ///< number of coordinates in all loops
+    int *polygonOffsets;  ///< numPolygons + 1 offsets into the loops
+    int *loopOffsets;     ///< numLoops + 1 offsets into coords
+    GeoCoord *coords;     ///< coordinates of every loop, in order
+} FlatGeoMultiPolygon;
+
+/** @struct H3Adjacency
+ *  @brief compressed sparse row adjacency of the cells of a set; the edges
+ *  from the cell at position i of the set are offsets[i] up to
+ *  offsets[i + 1], going to the cells at the positions in neighbors
+ */
+typedef struct {
+    int numCells;    ///< number of cells in the set
+    int numEdges;    ///< number of edges between cells of the set
+    int *offsets;    ///< numCells + 1 offsets into neighbors and edges
+    int *neighbors;  ///< position in the set of the destination of each edge
+    H3Index *edges;  ///< unidirectional edge index of each edge
+} H3Adjacency;
+
+/** @struct CoordIJ
+ *  @brief IJ hexagon coordinates, in a local coordinate system anchored at
+ *  an origin index
+ */
+typedef struct {
+    int i;  ///< i component
+    int j;  ///< j component
+} CoordIJ;
+
+/** @brief a task run by an H3ParallelFor on the range [begin, end) */
+typedef void (*H3ParallelTask)(void *data, int begin, int end);
+
+/** @brief runs task on disjoint ranges covering [0, n), possibly
+ * concurrently, and returns once all of them have completed */
+typedef void (*H3ParallelFor)(void *executor, int n, H3ParallelTask task,
+                              void *data);
+
+/** @struct H3Scratch
+ *  @brief reusable heap working memory for the WithScratch functions; zero
+ *  initialize before first use and free with destroyH3Scratch
+ */
+typedef struct {
+    void *buffer;     ///< working memory, owned by the scratch
+    size_t capacity;  ///< size of buffer in bytes
+} H3Scratch;
+
+/** @struct HexRingIterator
+ *  @brief cursor of an outward walk over the hollow rings of an origin;
+ *  initialize with hexRingIterInit
+ */
+typedef struct {
+    H3Index start;  ///< first index of the last ring produced
+    int ring;       ///< ring produced by the next call to hexRingIterNext
+    int rotations;  ///< ccw rotations accumulated by walking out to start
+    int status;     ///< 0, or the error which ended the walk
+} HexRingIterator;
+
+/** @struct ChildIterator
+ *  @brief cursor of an enumeration of the children of a cell in index order;
+ *  initialize with childIterInit
+ */
+typedef struct {
+    H3Index next;    ///< child returned by the next call to childIterNext
+    H3Index parent;  ///< the cell whose children are enumerated
+    int childRes;    ///< resolution of the children
+    int skipRes;     ///< finest resolution at which digit 1 is deleted, or -1
+} ChildIterator;
+
 /** @defgroup geoToH3 geoToH3
  * Functions for geoToH3
  * @{
@@ -138,6 +218,32 @@ struct LinkedGeoPolygon {
 H3Index H3_EXPORT(geoToH3)(const GeoCoord *g, int res);
 /** @} */
 
+/** @defgroup geoToH3Batch geoToH3Batch
+ * Functions for geoToH3Batch
+ * @{
+ */
+/** @brief find the H3 indexes of the resolution res cells containing each of
+ * the n lat/lon points given as separate arrays */
+void H3_EXPORT(geoToH3Batch)(const double *lat, const double *lon, int n,
+                             int res, H3Index *out);
+
+/** @brief geoToH3Batch with the points split into ranges run by the given
+ * executor */
+void H3_EXPORT(geoToH3BatchParallel)(const double *lat, const double *lon,
+                                     int n, int res, H3Index *out,
+                                     H3ParallelFor parallelFor,
+                                     void *executor);
+/** @} */
+
+/** @defgroup geoToH3Multi geoToH3Multi
+ * Functions for geoToH3Multi
+ * @{
+ */
+/** @brief find the H3 indexes of the cells containing the lat/lon g at every
+ * resolution from 0 to finestRes */
+void H3_EXPORT(geoToH3Multi)(const GeoCoord *g, int finestRes, H3Index *out);
+/** @} */
+
 /** @defgroup h3ToGeo h3ToGeo
  * Functions for h3ToGeo
  * @{
@@ -154,25 +260,172 @@ void H3_EXPORT(h3ToGeo)(H3Index h3, GeoCoord *g);
 void H3_EXPORT(h3ToGeoBoundary)(H3Index h3, GeoBoundary *gp);
 /** @} */
 
+/** @defgroup h3ToGeoAndBoundary h3ToGeoAndBoundary
+ * Functions for h3ToGeoAndBoundary
+ * @{
+ */
+/** @brief give both the center and the cell boundary of the cell h3,
+ * decoding it once */
+void H3_EXPORT(h3ToGeoAndBoundary)(H3Index h3, GeoCoord *g, GeoBoundary *gb);
+/** @} */
+
+/** @defgroup h3ToGeoBatch h3ToGeoBatch
+ * Functions for h3ToGeoBatch
+ * @{
+ */
+/** @brief find the lat/lon center points of the n cells h3, as separate
+ * arrays */
+void H3_EXPORT(h3ToGeoBatch)(const H3Index *h3, int n, double *lat,
+                             double *lon);
+
+/** @brief h3ToGeoBatch with the cells split into ranges run by the given
+ * executor */
+void H3_EXPORT(h3ToGeoBatchParallel)(const H3Index *h3, int n, double *lat,
+                                     double *lon, H3ParallelFor parallelFor,
+                                     void *executor);
+/** @} */
+
+/** @defgroup h3ToGeoBoundaryBatch h3ToGeoBoundaryBatch
+ * Functions for h3ToGeoBoundaryBatch
+ * @{
+ */
+/** @brief give the cell boundaries of the n cells h3 as a flat array of
+ * lat/lon pairs plus per-cell vertex counts */
+int H3_EXPORT(h3ToGeoBoundaryBatch)(const H3Index *h3, int n, double *verts,
+                                    int *numVerts);
+
+/** @brief h3ToGeoBoundaryBatch with the cells split into ranges run by the
+ * given executor; returns the total number of vertices */
+int H3_EXPORT(h3ToGeoBoundaryBatchParallel)(const H3Index *h3, int n,
+                                            double *verts, int *numVerts,
+                                            H3ParallelFor parallelFor,
+                                            void *executor);
+/** @} */
+
+/** @defgroup h3ToGeoBoundaryPacked h3ToGeoBoundaryPacked
+ * Functions for h3ToGeoBoundaryPacked
+ * @{
+ */
+/** @brief find the centers of the n cells h3 as int32 microdegree pairs */
+void H3_EXPORT(h3ToGeoPacked)(const H3Index *h3, int n, int32_t *centers);
+
+/** @brief give the cell boundaries of the n cells h3 as packed centers and
+ * float32 vertex offsets from them, in degrees */
+int H3_EXPORT(h3ToGeoBoundaryPacked)(const H3Index *h3, int n,
+                                     int32_t *centers, float *offsets,
+                                     uint8_t *numVerts);
+
+/** @brief unpack a boundary written by h3ToGeoBoundaryPacked */
+void H3_EXPORT(packedToGeoBoundary)(const int32_t *center,
+                                    const float *offsets, int numVerts,
+                                    GeoBoundary *gb);
+/** @} */
+
 /** @defgroup kRing kRing
  * Functions for kRing
  * @{
  */
-/** @brief maximum number of hexagons in k-ring */
+/** @brief the largest k whose maxKringSize fits in an int */
+#define H3_MAX_KRING_K 26754
+
+/** @brief the largest k whose maxKringSize64 fits in an int64_t */
+#define H3_MAX_KRING_K64 1753413055
+
+/** @brief maxKringSize as a 64 bit constant expression, for k up to
+ * H3_MAX_KRING_K64 */
+#define H3_MAX_KRING_SIZE(k) \
+    ((k) <= 0 ? INT64_C(1) : INT64_C(3) * (k) * ((int64_t)(k) + 1) + 1)
+
+/** @brief maximum number of hexagons in k-ring; -1 if it does not fit in an
+ * int, as when k > H3_MAX_KRING_K, see maxKringSize64 */
 int H3_EXPORT(maxKringSize)(int k);
 
-/** @brief hexagon neighbors in all directions */
-void H3_EXPORT(kRing)(H3Index origin, int k, H3Index *out);
+/** @brief maximum number of hexagons in k-ring, as a 64 bit integer; -1 if
+ * it does not fit */
+int64_t H3_EXPORT(maxKringSize64)(int k);
+
+/** @brief hexagon neighbors in all directions; -1 if k is too large or
+ * working memory could not be allocated */
+int H3_EXPORT(kRing)(H3Index origin, int k, H3Index *out);
+
+/** @brief hexagon neighbors in all directions, using heap working memory */
+void H3_EXPORT(kRingWithScratch)(H3Index origin, int k, H3Index *out,
+                                 H3Scratch *scratch);
 /** @} */
 
 /** @defgroup kRingDistances kRingDistances
  * Functions for kRingDistances
  * @{
  */
-/** @brief hexagon neighbors in all directions, reporting distance from origin
+/** @brief hexagon neighbors in all directions, reporting distance from
+ * origin; -1 if k is too large or working memory could not be allocated */
+int H3_EXPORT(kRingDistances)(H3Index origin, int k, H3Index *out,
+                              int *distances);
+
+/** @brief hexagon neighbors in all directions, reporting distance from
+ * origin, using heap working memory */
+void H3_EXPORT(kRingDistancesWithScratch)(H3Index origin, int k, H3Index *out,
+                                          int *distances, H3Scratch *scratch);
+/** @} */
+
+/** @defgroup kRingOrdered kRingOrdered
+ * Functions for kRingOrdered
+ * @{
+ */
+/** @brief hexagon neighbors in all directions, written densely and grouped
+ * by distance from origin; -1 if k > H3_MAX_KRING_K */
+int H3_EXPORT(kRingOrdered)(H3Index origin, int k, H3Index *out,
+                            int *ringOffsets);
+/** @} */
+
+/** @defgroup kRingsUnion kRingsUnion
+ * Functions for kRingsUnion
+ * @{
  */
-void H3_EXPORT(kRingDistances)(H3Index origin, int k, H3Index *out,
-                               int *distances);
+/** @brief maximum number of hexagons in the union of k-rings of many
+ * origins; -1 if it does not fit in an int */
+int H3_EXPORT(maxKringsUnionSize)(int numOrigins, int k);
+
+/** @brief union of the k-rings of many origins, each hexagon once with its
+ * distance to the nearest origin */
+int H3_EXPORT(kRingsUnion)(const H3Index *origins, int numOrigins, int k,
+                           H3Index *out, int *distances);
+/** @} */
+
+/** @defgroup geoRadiusToCells geoRadiusToCells
+ * Functions for geoRadiusToCells
+ * @{
+ */
+/** @brief maximum number of hexagons with centers within a radius; -1 if it
+ * does not fit in an int */
+int H3_EXPORT(maxGeoRadiusToCellsSize)(double radiusKm, int res);
+
+/** @brief hexagons with centers within a radius of a point, nearest first;
+ * -1 if maxGeoRadiusToCellsSize is -1 */
+int H3_EXPORT(geoRadiusToCells)(const GeoCoord *center, double radiusKm,
+                                int res, H3Index *out, double *distancesKm);
+/** @} */
+
+/** @defgroup nearestCellsIter nearestCellsIter
+ * Functions for nearestCellsIter
+ * @{
+ */
+/** @struct NearestCellsIterator
+ *  @brief opaque state of a walk over the hexagons nearest a point
+ */
+typedef struct NearestCellsIterator NearestCellsIterator;
+
+/** @brief start a walk over the hexagons nearest a point */
+NearestCellsIterator *H3_EXPORT(nearestCellsIterInit)(const GeoCoord *point,
+                                                      int res);
+
+/** @brief write the next hexagons nearest the point, nearest first; returns
+ * the number written, which is less than outSize once all are written */
+int H3_EXPORT(nearestCellsIterNext)(NearestCellsIterator *iter, H3Index *out,
+                                    double *distancesKm, int outSize);
+
+/** @brief free all memory held by a walk over the nearest hexagons */
+void H3_EXPORT(nearestCellsIterDestroy)(NearestCellsIterator *iter);
 /** @} */
 
 /** @defgroup hexRange hexRange
@@ -208,17 +461,176 @@ int H3_EXPORT(hexRanges)(H3Index *h3Set, int length, int k, H3Index *out);
  */
 /** @brief hollow hexagon ring at some origin */
 int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index *out);
+
+/** @brief start walking the hollow rings of an origin, from ring 0 */
+void H3_EXPORT(hexRingIterInit)(HexRingIterator *iter, H3Index origin);
+
+/** @brief write the next hollow ring and advance the iterator */
+int H3_EXPORT(hexRingIterNext)(HexRingIterator *iter, H3Index *out);
+/** @} */
+
+/** @defgroup h3ToLocalIj h3ToLocalIj
+ * Functions for h3ToLocalIj
+ * @{
+ */
+/** @brief local IJ coordinates of an index, anchored at an origin index */
+int H3_EXPORT(h3ToLocalIj)(H3Index origin, H3Index h3, CoordIJ *out);
+/** @} */
+
+/** @defgroup localIjToH3 localIjToH3
+ * Functions for localIjToH3
+ * @{
+ */
+/** @brief index at local IJ coordinates anchored at an origin index */
+int H3_EXPORT(localIjToH3)(H3Index origin, const CoordIJ *ij, H3Index *out);
+/** @} */
+
+/** @defgroup h3Distance h3Distance
+ * Functions for h3Distance
+ * @{
+ */
+/** @brief grid distance between two indexes */
+int H3_EXPORT(h3Distance)(H3Index origin, H3Index h3);
+/** @} */
+
+/** @defgroup h3Line h3Line
+ * Functions for h3Line
+ * @{
+ */
+/** @brief number of indexes in a line connecting two indexes */
+int H3_EXPORT(h3LineSize)(H3Index start, H3Index end);
+
+/** @brief line of indexes connecting two indexes */
+int H3_EXPORT(h3Line)(H3Index start, H3Index end, H3Index *out);
+/** @} */
+
+/** @defgroup polylineToCells polylineToCells
+ * Functions for polylineToCells
+ * @{
+ */
+/** @brief maximum number of hexagons crossed by a path; -1 if it does not
+ * fit in an int */
+int H3_EXPORT(maxPolylineToCellsSize)(const GeoCoord *pts, int numPts,
+                                      int res);
+
+/** @brief hexagons crossed by a path of great circle arcs, in order */
+int H3_EXPORT(polylineToCells)(const GeoCoord *pts, int numPts, int res,
+                               H3Index *out, int outSize);
 /** @} */
 
 /** @defgroup polyfill polyfill
  * Functions for polyfill
  * @{
  */
-/** @brief maximum number of hexagons in the geofence */
+/** @brief maximum number of hexagons in the geofence; -1 if it does not fit
+ * in an int */
 int H3_EXPORT(maxPolyfillSize)(const GeoPolygon *geoPolygon, int res);
 
 /** @brief hexagons within the given geofence */
 void H3_EXPORT(polyfill)(const GeoPolygon *geoPolygon, int res, H3Index *out);
+
+/** @brief hexagons within the given geofence, written densely into a bounded
+ * buffer; returns the total number of hexagons */
+int H3_EXPORT(polyfillDense)(const GeoPolygon *geoPolygon, int res,
+                             H3Index *out, int outSize);
+
+/** @brief compacted hexagons overlapping the given geofence at all, written
+ * densely into a bounded buffer; returns the total number of hexagons */
+int H3_EXPORT(polyfillCoverage)(const GeoPolygon *geoPolygon, int res,
+                                H3Index *out, int outSize);
+
+/** @brief hexagons within the given geofence, filled in parallel using the
+ * given executor; returns the total number of hexagons */
+int H3_EXPORT(polyfillParallel)(const GeoPolygon *geoPolygon, int res,
+                                H3Index *out, int outSize,
+                                H3ParallelFor parallelFor, void *executor);
+
+/** @struct PolyfillCell
+ *  @brief a hexagon and the index of the polygon it was assigned to
+ */
+typedef struct {
+    H3Index h3;   ///< the hexagon
+    int polygon;  ///< index of the polygon containing the hexagon center
+} PolyfillCell;
+
+/** @brief hexagons within any of the given geofences, assigned to the first
+ * geofence containing them; returns the total number of hexagons */
+int H3_EXPORT(polyfillMany)(const GeoPolygon *polygons, int numPolygons,
+                            int res, PolyfillCell *out, int outSize);
+
+/** @brief hexagons added to and removed from a polyfill by an edit of the
+ * geofence, testing only hexagons near the edges edited */
+int H3_EXPORT(polyfillDelta)(const GeoPolygon *oldPolygon,
+                             const GeoPolygon *newPolygon, int res,
+                             H3Index *added, int addedSize, int *numAdded,
+                             H3Index *removed, int removedSize,
+                             int *numRemoved);
+
+/** @struct PolyfillIterator
+ *  @brief opaque state of a streaming polyfill
+ */
+typedef struct PolyfillIterator PolyfillIterator;
+
+/** @brief start a streaming polyfill of the given geofence */
+PolyfillIterator *H3_EXPORT(polyfillIterInit)(const GeoPolygon *geoPolygon,
+                                              int res);
+
+/** @brief write the next hexagons of a streaming polyfill; returns the number
+ * written, which is less than outSize once the polyfill is exhausted */
+int H3_EXPORT(polyfillIterNext)(PolyfillIterator *iter, H3Index *out,
+                                int outSize);
+
+/** @brief free all memory held by a streaming polyfill */
+void H3_EXPORT(polyfillIterDestroy)(PolyfillIterator *iter);
+/** @} */
+
+/** @defgroup prepareGeoPolygon prepareGeoPolygon
+ * Functions for prepareGeoPolygon
+ * @{
+ */
+/** @struct PreparedGeoPolygon
+ *  @brief opaque polygon indexed for repeated containment queries
+ */
+typedef struct PreparedGeoPolygon PreparedGeoPolygon;
+
+/** @brief index a geofence and its holes for containment queries */
+PreparedGeoPolygon *H3_EXPORT(prepareGeoPolygon)(const GeoPolygon *geoPolygon);
+
+/** @brief whether a point is contained in a prepared geofence */
+int H3_EXPORT(preparedGeoPolygonContains)(const PreparedGeoPolygon *prepared,
+                                          const GeoCoord *coord);
+
+/** @brief free all memory created for a PreparedGeoPolygon */
+void H3_EXPORT(destroyPreparedGeoPolygon)(PreparedGeoPolygon *prepared);
+/** @} */
+
+/** @defgroup createSimplifiedGeoPolygon createSimplifiedGeoPolygon
+ * Functions for createSimplifiedGeoPolygon
+ * @{
+ */
+/** @struct SimplifiedGeoPolygon
+ *  @brief opaque cache of a polygon simplified for each resolution
+ */
+typedef struct SimplifiedGeoPolygon SimplifiedGeoPolygon;
+
+/** @brief the tolerance of simplification for polyfilling at a resolution */
+double H3_EXPORT(simplifyToleranceRads)(int res);
+
+/** @brief create an empty cache of simplified copies of a geofence */
+SimplifiedGeoPolygon *H3_EXPORT(createSimplifiedGeoPolygon)(
+    const GeoPolygon *geoPolygon);
+
+/** @brief the geofence simplified for a resolution, made on first use */
+const GeoPolygon *H3_EXPORT(simplifiedGeoPolygonAtRes)(
+    SimplifiedGeoPolygon *simplified, int res);
+
+/** @brief hexagons within the geofence simplified for the resolution,
+ * written densely into a bounded buffer; returns the total number */
+int H3_EXPORT(polyfillSimplified)(SimplifiedGeoPolygon *simplified, int res,
+                                  H3Index *out, int outSize);
+
+/** @brief free all memory created for a SimplifiedGeoPolygon */
+void H3_EXPORT(destroySimplifiedGeoPolygon)(SimplifiedGeoPolygon *simplified);
 /** @} */
 
 /** @defgroup h3SetToMultiPolygon h3SetToMultiPolygon
@@ -231,6 +643,13 @@ void H3_EXPORT(h3SetToLinkedGeo)(const H3Index *h3Set, const int numHexes,
 
 /** @brief Free all memory created for a LinkedGeoPolygon */
 void H3_EXPORT(destroyLinkedPolygon)(LinkedGeoPolygon *polygon);
+
+/** @brief Fill flat polygon arrays from a set of hexagons */
+void H3_EXPORT(h3SetToFlatGeo)(const H3Index *h3Set, const int numHexes,
+                               FlatGeoMultiPolygon *out);
+
+/** @brief Free all memory created for a FlatGeoMultiPolygon */
+void H3_EXPORT(destroyFlatGeo)(FlatGeoMultiPolygon *polygons);
 /** @} */
 
 /** @defgroup degsToRads degsToRads
@@ -260,6 +679,20 @@ double H3_EXPORT(hexAreaKm2)(int res);
 double H3_EXPORT(hexAreaM2)(int res);
 /** @} */
 
+/** @defgroup cellArea cellArea
+ * Functions for cellArea
+ * @{
+ */
+/** @brief exact area of a cell in square kilometers */
+double H3_EXPORT(cellAreaKm2)(H3Index h3);
+
+/** @brief exact area of a cell in square meters */
+double H3_EXPORT(cellAreaM2)(H3Index h3);
+
+/** @brief exact areas of an array of cells in square kilometers */
+void H3_EXPORT(cellAreaKm2Batch)(const H3Index *h3, int n, double *out);
+/** @} */
+
 /** @defgroup edgeLength edgeLength
  * Functions for edgeLength
  * @{
@@ -271,10 +704,28 @@ double H3_EXPORT(edgeLengthKm)(int res);
 double H3_EXPORT(edgeLengthM)(int res);
 /** @} */
 
+/** @defgroup exactEdgeLength exactEdgeLength
+ * Functions for exactEdgeLength
+ * @{
+ */
+/** @brief exact length of a unidirectional edge in kilometers */
+double H3_EXPORT(exactEdgeLengthKm)(H3Index edge);
+
+/** @brief exact length of a unidirectional edge in meters */
+double H3_EXPORT(exactEdgeLengthM)(H3Index edge);
+
+/** @brief exact lengths of an array of unidirectional edges in kilometers */
+void H3_EXPORT(exactEdgeLengthKmBatch)(const H3Index *edges, int n,
+                                       double *out);
+/** @} */
+
 /** @defgroup numHexagons numHexagons
  * Functions for numHexagons
  * @{
  */
+/** @brief numHexagons as a 64 bit constant expression */
+#define H3_NUM_HEXAGONS(res) (2 + 120 * H3_POWER_OF_7(res))
+
 /** @brief number of hexagons for a given resolution */
 int64_t H3_EXPORT(numHexagons)(int res);
 /** @} */
@@ -285,6 +736,9 @@ int64_t H3_EXPORT(numHexagons)(int res);
  */
 /** @brief returns the resolution of the provided hexagon */
 int H3_EXPORT(h3GetResolution)(H3Index h);
+
+/** @brief returns the resolutions of n indexes */
+void H3_EXPORT(h3GetResolutionBatch)(const H3Index *h3, int n, int *out);
 /** @} */
 
 /** @defgroup h3GetBaseCell h3GetBaseCell
@@ -301,6 +755,11 @@ int H3_EXPORT(h3GetBaseCell)(H3Index h);
  */
 /** @brief converts the canonical string format to H3Index format */
 H3Index H3_EXPORT(stringToH3)(const char *str);
+
+/** @brief converts n fixed width strings to H3Index format, optionally only
+ * accepting the canonical strings of valid cells */
+int H3_EXPORT(stringToH3Batch)(const char *strs, size_t stride, int n,
+                               int strict, H3Index *out);
 /** @} */
 
 /** @defgroup h3ToString h3ToString
@@ -309,6 +768,10 @@ H3Index H3_EXPORT(stringToH3)(const char *str);
  */
 /** @brief converts an H3Index to a canonical string */
 void H3_EXPORT(h3ToString)(H3Index h, char *str, size_t sz);
+
+/** @brief converts n H3Indexes to canonical strings at a fixed stride */
+void H3_EXPORT(h3ToStringBatch)(const H3Index *h3, int n, char *strs,
+                                size_t stride);
 /** @} */
 
 /** @defgroup h3IsValid h3IsValid
@@ -317,6 +780,10 @@ void H3_EXPORT(h3ToString)(H3Index h, char *str, size_t sz);
  */
 /** @brief confirms if an H3Index is valid */
 int H3_EXPORT(h3IsValid)(H3Index h);
+
+/** @brief validates n H3Indexes, writing 1 for each valid one and 0
+ * otherwise */
+void H3_EXPORT(h3IsValidBatch)(const H3Index *h3, int n, uint8_t *out);
 /** @} */
 
 /** @defgroup h3ToParent h3ToParent
@@ -326,19 +793,64 @@ int H3_EXPORT(h3IsValid)(H3Index h);
 /** @brief returns the parent (or grandparent, etc) hexagon of the given hexagon
  */
 H3Index H3_EXPORT(h3ToParent)(H3Index h, int parentRes);
+
+/** @brief returns the parents at one resolution of n indexes */
+void H3_EXPORT(h3ToParentBatch)(const H3Index *h3, int n, int parentRes,
+                                H3Index *out);
+
+/** @brief h3ToParentBatch with the indexes split into ranges run by the
+ * given executor */
+void H3_EXPORT(h3ToParentBatchParallel)(const H3Index *h3, int n,
+                                        int parentRes, H3Index *out,
+                                        H3ParallelFor parallelFor,
+                                        void *executor);
+
+/** @brief returns the parents at several resolutions of n indexes, in one
+ * column of n parents per resolution */
+void H3_EXPORT(h3ToParentsBatch)(const H3Index *h3, int n,
+                                 const int *parentRes, int numRes,
+                                 H3Index *out);
 /** @} */
 
 /** @defgroup h3ToChildren h3ToChildren
  * Functions for h3ToChildren
  * @{
  */
+/** @brief 7 to the power n, for n from 0 to 15, as a 64 bit constant
+ * expression */
+#define H3_POWER_OF_7(n)                                         \
+    ((((n)&1) ? INT64_C(7) : INT64_C(1)) * (((n)&2) ? 49 : 1) * \
+     (((n)&4) ? 2401 : 1) * (((n)&8) ? 5764801 : 1))
+
+/** @brief maxH3ToChildrenSize as a 64 bit constant expression, given the
+ * resolution of the parent */
+#define H3_MAX_CHILDREN_SIZE(parentRes, childRes)   \
+    ((parentRes) > (childRes) ? INT64_C(0)          \
+                              : H3_POWER_OF_7((childRes) - (parentRes)))
+
 /** @brief determines the maximum number of children (or grandchildren, etc)
  * that
- * could be returned for the given hexagon */
+ * could be returned for the given hexagon; -1 if it does not fit in an int,
+ * see maxH3ToChildrenSize64 */
 int H3_EXPORT(maxH3ToChildrenSize)(H3Index h, int childRes);
 
+/** @brief maximum number of children (or grandchildren, etc) of the given
+ * hexagon, as a 64 bit integer */
+int64_t H3_EXPORT(maxH3ToChildrenSize64)(H3Index h, int childRes);
+
 /** @brief provides the children (or grandchildren, etc) of the given hexagon */
 void H3_EXPORT(h3ToChildren)(H3Index h, int childRes, H3Index *children);
+
+/** @brief start an enumeration of the children of the given hexagon */
+void H3_EXPORT(childIterInit)(ChildIterator *iter, H3Index h, int childRes);
+
+/** @brief returns the next child and advances the iterator, or returns 0
+ * once every child has been returned */
+H3Index H3_EXPORT(childIterNext)(ChildIterator *iter);
+
+/** @brief moves the iterator to the given child, so that it is returned next
+ */
+void H3_EXPORT(childIterSkipTo)(ChildIterator *iter, H3Index child);
 /** @} */
 
 /** @defgroup compact compact
@@ -348,6 +860,22 @@ void H3_EXPORT(h3ToChildren)(H3Index h, int childRes, H3Index *children);
 /** @brief compacts the given set of hexagons as best as possible */
 int H3_EXPORT(compact)(const H3Index *h3Set, H3Index *compactedSet,
                        const int numHexes);
+
+/** @brief compacts the given set of hexagons, using heap working memory */
+int H3_EXPORT(compactWithScratch)(const H3Index *h3Set, H3Index *compactedSet,
+                                  const int numHexes, H3Scratch *scratch);
+
+/** @brief compacts the given set of hexagons by sorting it, for large sets */
+int H3_EXPORT(compactWithSort)(const H3Index *h3Set, H3Index *compactedSet,
+                               const int numHexes);
+/** @} */
+
+/** @defgroup destroyH3Scratch destroyH3Scratch
+ * Functions for destroyH3Scratch
+ * @{
+ */
+/** @brief free the working memory held by an H3Scratch */
+void H3_EXPORT(destroyH3Scratch)(H3Scratch *scratch);
 /** @} */
 
 /** @defgroup uncompact uncompact
@@ -362,6 +890,353 @@ int H3_EXPORT(maxUncompactSize)(const H3Index *compactedSet, const int numHexes,
 /** @brief uncompacts the compacted hexagon set */
 int H3_EXPORT(uncompact)(const H3Index *compactedSet, const int numHexes,
                          H3Index *h3Set, const int maxHexes, const int res);
+
+/** @brief uncompacts the compacted hexagon set, expanding the hexagons in
+ * parallel using the given executor */
+int H3_EXPORT(uncompactParallel)(const H3Index *compactedSet,
+                                 const int numHexes, H3Index *h3Set,
+                                 const int maxHexes, const int res,
+                                 H3ParallelFor parallelFor, void *executor);
+/** @} */
+
+/** @defgroup createH3SortedSet createH3SortedSet
+ * Functions for createH3SortedSet
+ * @{
+ */
+/** @struct H3SortedSet
+ *  @brief opaque immutable set of hexagons sorted for containment queries
+ */
+typedef struct H3SortedSet H3SortedSet;
+
+/** @brief build a sorted set from hexagons of any resolutions */
+H3SortedSet *H3_EXPORT(createH3SortedSet)(const H3Index *h3Set,
+                                          const int numHexes);
+
+/** @brief whether a hexagon or one of its ancestors is in a sorted set */
+int H3_EXPORT(h3SortedSetContains)(const H3SortedSet *set, H3Index h);
+
+/** @brief the number of hexagons held by a sorted set */
+int H3_EXPORT(h3SortedSetSize)(const H3SortedSet *set);
+
+/** @brief write the hexagons held by a sorted set, in ascending order */
+void H3_EXPORT(h3SortedSetToArray)(const H3SortedSet *set, H3Index *out);
+
+/** @brief the compacted union of two sorted sets */
+H3SortedSet *H3_EXPORT(h3SortedSetUnion)(const H3SortedSet *a,
+                                         const H3SortedSet *b);
+
+/** @brief the compacted intersection of two sorted sets */
+H3SortedSet *H3_EXPORT(h3SortedSetIntersection)(const H3SortedSet *a,
+                                                const H3SortedSet *b);
+
+/** @brief the compacted difference of two sorted sets */
+H3SortedSet *H3_EXPORT(h3SortedSetDifference)(const H3SortedSet *a,
+                                              const H3SortedSet *b);
+
+/** @brief free all memory created for an H3SortedSet */
+void H3_EXPORT(destroyH3SortedSet)(H3SortedSet *set);
+/** @} */
+
+/** @defgroup h3SortCells h3SortCells
+ * Functions for h3SortCells
+ * @{
+ */
+/** @brief key ordering hexagons of mixed resolutions by locality */
+uint64_t H3_EXPORT(h3ToOrderKey)(H3Index h);
+
+/** @brief sort hexagons of mixed resolutions in place by h3ToOrderKey */
+void H3_EXPORT(h3SortCells)(H3Index *h3Set, int numHexes);
+
+/** @brief sort hexagons and keep each distinct hexagon once */
+int H3_EXPORT(h3SortUniqueCells)(H3Index *h3Set, int numHexes);
+/** @} */
+
+/** @defgroup createH3IndexSet createH3IndexSet
+ * Functions for createH3IndexSet
+ * @{
+ */
+/** @struct H3IndexSet
+ *  @brief opaque hash set of indexes, which many threads may add to at once
+ */
+typedef struct H3IndexSet H3IndexSet;
+
+/** @brief create an empty hash set of indexes */
+H3IndexSet *H3_EXPORT(createH3IndexSet)(int capacity);
+
+/** @brief add an index to a hash set, growing it as needed */
+int H3_EXPORT(h3IndexSetAdd)(H3IndexSet *set, H3Index h);
+
+/** @brief add an index to a hash set while other threads also add to it */
+int H3_EXPORT(h3IndexSetAddConcurrent)(H3IndexSet *set, H3Index h);
+
+/** @brief remove an index from a hash set */
+int H3_EXPORT(h3IndexSetRemove)(H3IndexSet *set, H3Index h);
+
+/** @brief whether a hash set holds an index */
+int H3_EXPORT(h3IndexSetContains)(const H3IndexSet *set, H3Index h);
+
+/** @brief the number of indexes in a hash set */
+int H3_EXPORT(h3IndexSetSize)(const H3IndexSet *set);
+
+/** @brief write the indexes of a hash set, in no particular order */
+int H3_EXPORT(h3IndexSetToArray)(const H3IndexSet *set, H3Index *out);
+
+/** @brief free all memory created for an H3IndexSet */
+void H3_EXPORT(destroyH3IndexSet)(H3IndexSet *set);
+/** @} */
+
+/** @defgroup createH3CompactSet createH3CompactSet
+ * Functions for createH3CompactSet
+ * @{
+ */
+/** @struct H3CompactSet
+ *  @brief opaque set of hexagons of a resolution, kept compacted
+ */
+typedef struct H3CompactSet H3CompactSet;
+
+/** @brief create an empty compacted set of hexagons of a resolution */
+H3CompactSet *H3_EXPORT(createH3CompactSet)(int res);
+
+/** @brief add a hexagon to a compacted set, merging complete siblings */
+int H3_EXPORT(h3CompactSetAdd)(H3CompactSet *set, H3Index h);
+
+/** @brief remove a hexagon from a compacted set, splitting its ancestor */
+int H3_EXPORT(h3CompactSetRemove)(H3CompactSet *set, H3Index h);
+
+/** @brief whether a compacted set covers a hexagon */
+int H3_EXPORT(h3CompactSetContains)(const H3CompactSet *set, H3Index h);
+
+/** @brief the number of compacted hexagons of a set */
+int H3_EXPORT(h3CompactSetSize)(const H3CompactSet *set);
+
+/** @brief write the compacted hexagons of a set, sorted */
+int H3_EXPORT(h3CompactSetToArray)(const H3CompactSet *set, H3Index *out);
+
+/** @brief free all memory created for an H3CompactSet */
+void H3_EXPORT(destroyH3CompactSet)(H3CompactSet *set);
+/** @} */
+
+/** @defgroup createH3Bitmap createH3Bitmap
+ * Functions for createH3Bitmap
+ * @{
+ */
+/** @brief the finest resolution of a bitmap, of 98 million hexagons */
+#define H3_BITMAP_MAX_RES 7
+
+/** @struct H3Bitmap
+ *  @brief opaque bitmap of every hexagon of a resolution
+ */
+typedef struct H3Bitmap H3Bitmap;
+
+/** @brief the ordinal of a hexagon among those of its resolution */
+int64_t H3_EXPORT(h3ToOrdinal)(H3Index h);
+
+/** @brief the hexagon of a resolution with an ordinal */
+H3Index H3_EXPORT(ordinalToH3)(int64_t ordinal, int res);
+
+/** @brief create an empty bitmap of the hexagons of a resolution */
+H3Bitmap *H3_EXPORT(createH3Bitmap)(int res);
+
+/** @brief add a hexagon to a bitmap */
+int H3_EXPORT(h3BitmapAdd)(H3Bitmap *bitmap, H3Index h);
+
+/** @brief whether a bitmap holds a hexagon */
+int H3_EXPORT(h3BitmapContains)(const H3Bitmap *bitmap, H3Index h);
+
+/** @brief add the hexagons covered by a compacted set to a bitmap */
+int H3_EXPORT(h3BitmapAddCompact)(H3Bitmap *bitmap,
+                                  const H3Index *compactedSet,
+                                  const int numHexes);
+
+/** @brief add the hexagons of one bitmap to another */
+int H3_EXPORT(h3BitmapUnion)(H3Bitmap *bitmap, const H3Bitmap *other);
+
+/** @brief keep the hexagons of a bitmap that are in another */
+int H3_EXPORT(h3BitmapIntersection)(H3Bitmap *bitmap, const H3Bitmap *other);
+
+/** @brief the number of hexagons in a bitmap */
+int64_t H3_EXPORT(h3BitmapCount)(const H3Bitmap *bitmap);
+
+/** @brief write the hexagons of a bitmap compacted */
+int H3_EXPORT(h3BitmapToCompact)(const H3Bitmap *bitmap, H3Index *out,
+                                 const int maxHexes);
+
+/** @brief free all memory created for an H3Bitmap */
+void H3_EXPORT(destroyH3Bitmap)(H3Bitmap *bitmap);
+/** @} */
+
+/** @defgroup createH3ShardTable createH3ShardTable
+ * Functions for createH3ShardTable
+ * @{
+ */
+/** @brief the finest resolution of the ranges of a shard table, of 2 million
+ * hexagons */
+#define H3_SHARD_MAX_RES 5
+
+/** @struct H3ShardTable
+ *  @brief opaque contiguous ranges of hexagons in index order, one per shard
+ */
+typedef struct H3ShardTable H3ShardTable;
+
+/** @brief the weight of a hexagon, for balancing shards */
+typedef double (*H3CellWeightFunc)(void *data, H3Index h);
+
+/** @brief cut the hexagons of a resolution into balanced contiguous ranges,
+ * weighing each with a function */
+H3ShardTable *H3_EXPORT(createH3ShardTable)(int res, int numShards,
+                                            H3CellWeightFunc weight,
+                                            void *data);
+
+/** @brief cut the hexagons of a resolution into balanced contiguous ranges,
+ * weighing each by the samples it contains */
+H3ShardTable *H3_EXPORT(createH3ShardTableFromSamples)(
+    int res, int numShards, const H3Index *samples, const double *weights,
+    int numSamples);
+
+/** @brief rebuild a shard table from the first hexagon of each shard */
+H3ShardTable *H3_EXPORT(createH3ShardTableFromStarts)(const H3Index *starts,
+                                                      int numShards);
+
+/** @brief the number of shards of a shard table */
+int H3_EXPORT(h3ShardTableNumShards)(const H3ShardTable *table);
+
+/** @brief the resolution of the ranges of a shard table */
+int H3_EXPORT(h3ShardTableRes)(const H3ShardTable *table);
+
+/** @brief the weight of the hexagons of a shard */
+double H3_EXPORT(h3ShardWeight)(const H3ShardTable *table, int shard);
+
+/** @brief write the first hexagon of each shard */
+int H3_EXPORT(h3ShardTableToArray)(const H3ShardTable *table,
+                                   H3Index *starts);
+
+/** @brief the shard of a hexagon */
+int H3_EXPORT(h3ToShard)(const H3ShardTable *table, H3Index h);
+
+/** @brief the shards of n hexagons */
+void H3_EXPORT(h3ToShardBatch)(const H3ShardTable *table, const H3Index *h3,
+                               int n, int *out);
+
+/** @brief free all memory created for an H3ShardTable */
+void H3_EXPORT(destroyH3ShardTable)(H3ShardTable *table);
+/** @} */
+
+/** @defgroup createH3Aggregate createH3Aggregate
+ * Functions for createH3Aggregate
+ * @{
+ */
+/** @struct H3Aggregate
+ *  @brief opaque counts and sums of values of points grouped by hexagon
+ */
+typedef struct H3Aggregate H3Aggregate;
+
+/** @brief create an empty aggregate of the points of a resolution */
+H3Aggregate *H3_EXPORT(createH3Aggregate)(int res, int capacity);
+
+/** @brief count points, and sum their values, by the hexagon containing each
+ */
+void H3_EXPORT(h3AggregatePoints)(H3Aggregate *agg, const double *lat,
+                                  const double *lon, const double *values,
+                                  int n);
+
+/** @brief h3AggregatePoints with the points split into parts aggregated by
+ * the given executor */
+void H3_EXPORT(h3AggregatePointsParallel)(H3Aggregate *agg, const double *lat,
+                                          const double *lon,
+                                          const double *values, int n,
+                                          H3ParallelFor parallelFor,
+                                          void *executor);
+
+/** @brief add the counts and sums of one aggregate to another */
+int H3_EXPORT(h3AggregateMerge)(H3Aggregate *agg, const H3Aggregate *other);
+
+/** @brief roll an aggregate up to a coarser resolution */
+H3Aggregate *H3_EXPORT(h3AggregateToParent)(const H3Aggregate *agg,
+                                            int parentRes);
+
+/** @brief the count and sum of a hexagon */
+int H3_EXPORT(h3AggregateGet)(const H3Aggregate *agg, H3Index h,
+                              int64_t *count, double *sum);
+
+/** @brief the number of hexagons with points in an aggregate */
+int H3_EXPORT(h3AggregateSize)(const H3Aggregate *agg);
+
+/** @brief write the hexagons of an aggregate with their counts and sums */
+int H3_EXPORT(h3AggregateToArrays)(const H3Aggregate *agg, H3Index *cells,
+                                   int64_t *counts, double *sums);
+
+/** @brief free all memory created for an H3Aggregate */
+void H3_EXPORT(destroyH3Aggregate)(H3Aggregate *agg);
+/** @} */
+
+/** @defgroup createH3RegionIndex createH3RegionIndex
+ * Functions for createH3RegionIndex
+ * @{
+ */
+/** @brief build a flat index of the regions containing points, which may be
+ * written to a file and mapped back into memory */
+void *H3_EXPORT(createH3RegionIndex)(const GeoPolygon *polygons,
+                                     const int *regionIds, int numPolygons,
+                                     int res, size_t *size);
+
+/** @brief whether memory holds a complete region index */
+int H3_EXPORT(h3RegionIndexIsValid)(const void *index, size_t size);
+
+/** @brief the region containing a point */
+int H3_EXPORT(h3RegionIndexLookup)(const void *index, const GeoCoord *g,
+                                   int *regionId);
+
+/** @brief the region containing a hexagon */
+int H3_EXPORT(h3RegionIndexLookupCell)(const void *index, H3Index h,
+                                       int *regionId);
+
+/** @brief free all memory created for a region index */
+void H3_EXPORT(destroyH3RegionIndex)(void *index);
+/** @} */
+
+/** @defgroup createH3SpatialJoin createH3SpatialJoin
+ * Functions for createH3SpatialJoin
+ * @{
+ */
+/** @struct H3SpatialJoin
+ *  @brief opaque polygons prepared for assigning points to them
+ */
+typedef struct H3SpatialJoin H3SpatialJoin;
+
+/** @brief prepare polygons for assigning many points to them, with the
+ * hexagons of res certainly inside each polygon found up front */
+H3SpatialJoin *H3_EXPORT(createH3SpatialJoin)(const GeoPolygon *polygons,
+                                              int numPolygons, int res);
+
+/** @brief the first polygon containing a point, or -1 */
+int H3_EXPORT(h3SpatialJoinPoint)(const H3SpatialJoin *join,
+                                  const GeoCoord *g);
+
+/** @brief the first polygon containing each of n points, or -1 */
+void H3_EXPORT(h3SpatialJoinPoints)(const H3SpatialJoin *join,
+                                    const GeoCoord *points, int n, int *out);
+
+/** @brief free all memory created for an H3SpatialJoin */
+void H3_EXPORT(destroyH3SpatialJoin)(H3SpatialJoin *join);
+/** @} */
+
+/** @defgroup h3SetToBinary h3SetToBinary
+ * Functions for h3SetToBinary
+ * @{
+ */
+/** @brief maximum number of bytes of the binary encoding of a set */
+size_t H3_EXPORT(maxH3SetToBinarySize)(int numHexes);
+
+/** @brief compact binary encoding of a set of hexagons of any resolutions */
+int H3_EXPORT(h3SetToBinary)(const H3Index *h3Set, int numHexes,
+                             uint8_t *out, size_t *outSize);
+
+/** @brief number of hexagons of a binary encoded set */
+int H3_EXPORT(binaryToH3SetSize)(const uint8_t *in, size_t size);
+
+/** @brief decodes a binary encoded set; returns the number of hexagons */
+int H3_EXPORT(binaryToH3Set)(const uint8_t *in, size_t size, H3Index *out,
+                             int maxHexes);
 /** @} */
 
 /** @defgroup h3IsResClassIII h3IsResClassIII
@@ -455,6 +1330,68 @@ void H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(H3Index origin,
 void H3_EXPORT(getH3UnidirectionalEdgeBoundary)(H3Index edge, GeoBoundary *gb);
 /** @} */
 
+/** @defgroup getH3UnidirectionalEdgesFromHexagonBatch \
+ * getH3UnidirectionalEdgesFromHexagonBatch
+ * Functions for getH3UnidirectionalEdgesFromHexagonBatch
+ * @{
+ */
+/** @brief Returns the 6 edges of each of the n hexagons, with 0 for the
+ * deleted edge of pentagons */
+void H3_EXPORT(getH3UnidirectionalEdgesFromHexagonBatch)(const H3Index *origins,
+                                                         int n,
+                                                         H3Index *edges);
+
+/** @brief Returns the coordinates of the 6 edges of each of the n hexagons
+ * as a flat array of lat/lon pairs plus per-edge vertex counts */
+int H3_EXPORT(getH3UnidirectionalEdgeBoundariesFromHexagonBatch)(
+    const H3Index *origins, int n, double *verts, int *numVerts);
+/** @} */
+
+/** @defgroup h3SetToAdjacency h3SetToAdjacency
+ * Functions for h3SetToAdjacency
+ * @{
+ */
+/** @brief the edges between the cells of a set, as a compressed sparse row
+ * adjacency found in parallel using the given executor */
+int H3_EXPORT(h3SetToAdjacency)(const H3Index *h3Set, const int numHexes,
+                                H3ParallelFor parallelFor, void *executor,
+                                H3Adjacency *out);
+
+/** @brief free all memory created for an H3Adjacency */
+void H3_EXPORT(destroyH3Adjacency)(H3Adjacency *adjacency);
+/** @} */
+
+/** @defgroup h3GetStats h3GetStats
+ * Functions for h3GetStats
+ * @{
+ */
+/** @struct H3Stats
+ *  @brief counters of the work done on a thread, collected when the library
+ *  is built with H3_ENABLE_STATS
+ */
+typedef struct {
+    uint64_t kRingFallbacks;      ///< k-rings that fell back from hexRange
+    uint64_t polyfillCandidates;  ///< cells classified against a polygon
+    uint64_t polyfillKept;        ///< cells output by polyfills
+    uint64_t pointInPolyEdges;    ///< edges tested by point in polygon tests
+    uint64_t vertexGraphLookups;  ///< calls to findNodeForEdge
+    uint64_t vertexGraphProbes;   ///< nodes compared by findNodeForEdge
+    uint64_t compactProbes;       ///< hash set slots probed by compact
+    uint64_t allocations;         ///< heap allocations, including reallocs
+    uint64_t allocatedBytes;      ///< bytes requested by those allocations
+    uint64_t frees;               ///< heap frees, of pointers other than NULL
+    int64_t liveBytes;            ///< bytes allocated less bytes freed
+    int64_t peakBytes;            ///< the most liveBytes has been
+    uint64_t peakStackBytes;      ///< bytes of the largest stack array
+} H3Stats;
+
+/** @brief copies the counters of the calling thread */
+int H3_EXPORT(h3GetStats)(H3Stats *stats);
+
+/** @brief zeroes the counters of the calling thread */
+void H3_EXPORT(h3ResetStats)(void);
+/** @} */
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
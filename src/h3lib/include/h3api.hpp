@@ -0,0 +1,410 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3api.hpp
+ * @brief   Optional header only C++17 layer over the H3 C API.
+ *
+ * The functions in namespace h3 call the exported C functions, taking spans
+ * of caller owned memory instead of pointer and length pairs. Where a buffer
+ * size is needed it is computed by a constexpr function, so callers can size
+ * std::array buffers at compile time. kRing and polyfill without an output
+ * span write into a buffer kept per thread, which grows as needed and is
+ * never zeroed, and return a view of it that is valid until the next such
+ * call on the same thread. LinkedPolygon owns the outlines written by
+ * h3SetToLinkedGeo, and is moved without copying them.
+ *
+ * Like the C API, these functions report errors by return value and do not
+ * throw, except std::bad_alloc when a per thread buffer cannot grow.
+ */
+
+#ifndef H3API_HPP
+#define H3API_HPP
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "h3api.h"
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+#include <span>
+#endif
+
+namespace h3 {
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+
+/** @brief a view of contiguous elements, std::span when it is available */
+template <class T>
+using span = std::span<T>;
+
+#else
+
+/**
+ * A view of contiguous elements, with the subset of the interface of
+ * std::span used here. std::span is C++20; this is used before it.
+ */
+template <class T>
+class span {
+   public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using size_type = std::size_t;
+    using pointer = T*;
+    using iterator = T*;
+
+    constexpr span() noexcept : data_(nullptr), size_(0) {}
+    constexpr span(T* data, std::size_t size) noexcept
+        : data_(data), size_(size) {}
+    template <std::size_t N>
+    constexpr span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+    /** Views a contiguous container, such as std::vector or std::array */
+    template <class Container,
+              class = std::enable_if_t<std::is_convertible_v<
+                  decltype(std::declval<Container&>().data()), T*>>>
+    constexpr span(Container& container) noexcept
+        : data_(container.data()), size_(container.size()) {}
+    /** Views the elements of a span of non-const elements as const */
+    template <class U, class = std::enable_if_t<std::is_convertible_v<
+                           U (*)[], T (*)[]>>>
+    constexpr span(const span<U>& other) noexcept
+        : data_(other.data()), size_(other.size()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T& operator[](std::size_t i) const noexcept { return data_[i]; }
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+
+   private:
+    T* data_;
+    std::size_t size_;
+};
+
+#endif
+
+/**
+ * maxKringSize, as a compile time constant.
+ *
+ * @param k k >= 0
+ * @return The number of indexes within k of an index, 1 for k <= 0, or -1
+ * if k > H3_MAX_KRING_K so that it does not fit in an int
+ */
+constexpr int maxKringSize(int k) noexcept {
+    return k > H3_MAX_KRING_K ? -1 : static_cast<int>(H3_MAX_KRING_SIZE(k));
+}
+
+/**
+ * maxKringSize64, as a compile time constant.
+ *
+ * @param k k >= 0
+ * @return The number of indexes within k of an index, 1 for k <= 0, or -1
+ * if k > H3_MAX_KRING_K64 so that it does not fit in an int64_t
+ */
+constexpr int64_t maxKringSize64(int k) noexcept {
+    return k > H3_MAX_KRING_K64 ? -1 : H3_MAX_KRING_SIZE(k);
+}
+
+/**
+ * numHexagons, as a compile time constant.
+ *
+ * @param res The resolution (0-15)
+ * @return The number of cells at the resolution, 0 if it is invalid
+ */
+constexpr int64_t numHexagons(int res) noexcept {
+    return res < 0 || res > 15 ? 0 : H3_NUM_HEXAGONS(res);
+}
+
+/**
+ * maxH3ToChildrenSize64, as a compile time constant, given both
+ * resolutions.
+ *
+ * @param parentRes The resolution of the parent
+ * @param childRes The resolution of the children
+ * @return The most children at the resolution, 0 if the parent is finer or
+ * childRes is invalid
+ */
+constexpr int64_t maxH3ToChildrenSize64(int parentRes, int childRes) noexcept {
+    return childRes > 15 ? 0 : H3_MAX_CHILDREN_SIZE(parentRes, childRes);
+}
+
+/**
+ * maxH3ToChildrenSize64, as a compile time constant.
+ *
+ * @param h The parent index
+ * @param childRes The resolution of the children
+ * @return The most children at the resolution, 0 if the parent is finer or
+ * childRes is invalid
+ */
+constexpr int64_t maxH3ToChildrenSize64(H3Index h, int childRes) noexcept {
+    return maxH3ToChildrenSize64(static_cast<int>((h >> 52) & 15), childRes);
+}
+
+/**
+ * maxH3ToChildrenSize, as a compile time constant, given both resolutions.
+ *
+ * @param parentRes The resolution of the parent
+ * @param childRes The resolution of the children
+ * @return The most children at the resolution, 0 if the parent is finer, or
+ * -1 if it does not fit in an int
+ */
+constexpr int maxH3ToChildrenSize(int parentRes, int childRes) noexcept {
+    return maxH3ToChildrenSize64(parentRes, childRes) > INT32_MAX
+               ? -1
+               : static_cast<int>(maxH3ToChildrenSize64(parentRes, childRes));
+}
+
+/**
+ * maxH3ToChildrenSize, as a compile time constant.
+ *
+ * @param h The parent index
+ * @param childRes The resolution of the children
+ * @return The most children at the resolution, 0 if the parent is finer, or
+ * -1 if it does not fit in an int
+ */
+constexpr int maxH3ToChildrenSize(H3Index h, int childRes) noexcept {
+    return maxH3ToChildrenSize(static_cast<int>((h >> 52) & 15), childRes);
+}
+
+namespace detail {
+
+/** A buffer that grows to the largest size reserved, without zeroing */
+template <class T>
+class ScratchBuffer {
+   public:
+    /** Returns room for at least n elements, discarding the old contents */
+    T* reserve(std::size_t n) {
+        if (n > capacity_) {
+            data_.reset(new T[n]);
+            capacity_ = n;
+        }
+        return data_.get();
+    }
+    std::size_t capacity() const noexcept { return capacity_; }
+    T* data() const noexcept { return data_.get(); }
+
+   private:
+    std::unique_ptr<T[]> data_;
+    std::size_t capacity_ = 0;
+};
+
+/** The indexes written by kRing */
+inline ScratchBuffer<H3Index>& kRingScratch() {
+    thread_local ScratchBuffer<H3Index> buffer;
+    return buffer;
+}
+
+/** The ring offsets of kRingOrdered, which callers of kRing do not see */
+inline ScratchBuffer<int>& ringOffsetsScratch() {
+    thread_local ScratchBuffer<int> buffer;
+    return buffer;
+}
+
+/** The indexes written by polyfill */
+inline ScratchBuffer<H3Index>& polyfillScratch() {
+    thread_local ScratchBuffer<H3Index> buffer;
+    return buffer;
+}
+
+/** The size of a span as an int, clamped to INT_MAX */
+inline int clampedSize(std::size_t size) noexcept {
+    return size > static_cast<std::size_t>(INT_MAX) ? INT_MAX
+                                                    : static_cast<int>(size);
+}
+
+}  // namespace detail
+
+/**
+ * kRing writes the indexes within k of the origin densely, nearest first,
+ * as kRingOrdered does. The output need not be zeroed.
+ *
+ * @param origin The origin index
+ * @param k k >= 0
+ * @param out Output of at least maxKringSize(k) indexes
+ * @return The number of indexes written, or -1 if k is negative or greater
+ * than H3_MAX_KRING_K, or out is too small
+ */
+inline int kRing(H3Index origin, int k, span<H3Index> out) {
+    if (k < 0 || maxKringSize(k) < 0 ||
+        out.size() < static_cast<std::size_t>(maxKringSize(k))) {
+        return -1;
+    }
+    int* ringOffsets = detail::ringOffsetsScratch().reserve(k + 2);
+    return ::H3_EXPORT(kRingOrdered)(origin, k, out.data(), ringOffsets);
+}
+
+/**
+ * kRing writes the indexes within k of the origin, nearest first, into a
+ * buffer kept for the calling thread.
+ *
+ * @param origin The origin index
+ * @param k k >= 0
+ * @return The indexes, valid until the next call to this function on the
+ * same thread, or an empty span if k is negative or greater than
+ * H3_MAX_KRING_K
+ */
+inline span<const H3Index> kRing(H3Index origin, int k) {
+    int maxSize = maxKringSize(k);
+    if (k < 0 || maxSize < 0) return {};
+    H3Index* out = detail::kRingScratch().reserve(maxSize);
+    int numOut = kRing(origin, k, span<H3Index>(out, maxSize));
+    return span<const H3Index>(out, numOut);
+}
+
+/**
+ * polyfill writes the cells contained by a polygon densely, as
+ * polyfillDense does.
+ *
+ * @param geoPolygon The polygon and its holes
+ * @param res The resolution
+ * @param out Output buffer, which need not be zeroed; at most INT_MAX of
+ * its cells are written
+ * @return The number of cells in the polyfill, which may exceed the size of
+ * out, when out holds the first of them
+ */
+inline int polyfill(const GeoPolygon& geoPolygon, int res, span<H3Index> out) {
+    return ::H3_EXPORT(polyfillDense)(&geoPolygon, res, out.data(),
+                                      detail::clampedSize(out.size()));
+}
+
+/**
+ * polyfill writes the cells contained by a polygon into a buffer kept for
+ * the calling thread, growing it and filling again if it is too small.
+ *
+ * @param geoPolygon The polygon and its holes
+ * @param res The resolution
+ * @return The cells, valid until the next call to this function on the
+ * same thread, or an empty span if they cannot be counted in an int
+ */
+inline span<const H3Index> polyfill(const GeoPolygon& geoPolygon, int res) {
+    detail::ScratchBuffer<H3Index>& buffer = detail::polyfillScratch();
+    int numOut = polyfill(geoPolygon, res,
+                          span<H3Index>(buffer.data(), buffer.capacity()));
+    if (numOut < 0) return {};
+    if (static_cast<std::size_t>(numOut) > buffer.capacity()) {
+        H3Index* out = buffer.reserve(numOut);
+        numOut = polyfill(geoPolygon, res, span<H3Index>(out, numOut));
+    }
+    return span<const H3Index>(buffer.data(), numOut);
+}
+
+/**
+ * geoToH3Batch finds the cells containing points given as separate
+ * latitude and longitude arrays, in radians.
+ *
+ * @param lat The latitudes
+ * @param lon The longitudes, as many as the latitudes
+ * @param res The resolution
+ * @param out Output of one index per point
+ * @return 0 on success, or -1 if the spans differ in size
+ */
+inline int geoToH3Batch(span<const double> lat, span<const double> lon,
+                        int res, span<H3Index> out) {
+    if (lon.size() != lat.size() || out.size() != lat.size()) return -1;
+    ::H3_EXPORT(geoToH3Batch)(lat.data(), lon.data(),
+                              static_cast<int>(lat.size()), res, out.data());
+    return 0;
+}
+
+/**
+ * h3ToGeoBatch finds the centers of cells as separate latitude and
+ * longitude arrays, in radians.
+ *
+ * @param h3 The cells
+ * @param lat Output of one latitude per cell
+ * @param lon Output of one longitude per cell
+ * @return 0 on success, or -1 if the spans differ in size
+ */
+inline int h3ToGeoBatch(span<const H3Index> h3, span<double> lat,
+                        span<double> lon) {
+    if (lat.size() != h3.size() || lon.size() != h3.size()) return -1;
+    ::H3_EXPORT(h3ToGeoBatch)(h3.data(), static_cast<int>(h3.size()),
+                              lat.data(), lon.data());
+    return 0;
+}
+
+/**
+ * Owns the polygons written by h3SetToLinkedGeo, freeing them with
+ * destroyLinkedPolygon. It can be moved, which transfers the polygons
+ * without copying them, but not copied.
+ */
+class LinkedPolygon {
+   public:
+    /** An empty polygon, with no loops */
+    LinkedPolygon() noexcept : polygon_() {}
+
+    /**
+     * The outlines of a set of cells.
+     *
+     * @param h3Set The cells
+     */
+    explicit LinkedPolygon(span<const H3Index> h3Set) : polygon_() {
+        ::H3_EXPORT(h3SetToLinkedGeo)(h3Set.data(),
+                                      static_cast<int>(h3Set.size()),
+                                      &polygon_);
+    }
+
+    LinkedPolygon(const LinkedPolygon&) = delete;
+    LinkedPolygon& operator=(const LinkedPolygon&) = delete;
+
+    LinkedPolygon(LinkedPolygon&& other) noexcept : polygon_(other.polygon_) {
+        other.polygon_ = LinkedGeoPolygon();
+    }
+
+    LinkedPolygon& operator=(LinkedPolygon&& other) noexcept {
+        if (this != &other) {
+            ::H3_EXPORT(destroyLinkedPolygon)(&polygon_);
+            polygon_ = other.polygon_;
+            other.polygon_ = LinkedGeoPolygon();
+        }
+        return *this;
+    }
+
+    ~LinkedPolygon() { ::H3_EXPORT(destroyLinkedPolygon)(&polygon_); }
+
+    /** The first polygon, whose next member links the rest */
+    const LinkedGeoPolygon* get() const noexcept { return &polygon_; }
+    const LinkedGeoPolygon& operator*() const noexcept { return polygon_; }
+    const LinkedGeoPolygon* operator->() const noexcept { return &polygon_; }
+
+    /** Whether there are no loops */
+    bool empty() const noexcept { return polygon_.first == nullptr; }
+
+    /** The number of polygons linked from the first */
+    int numPolygons() const noexcept {
+        if (empty()) return 0;
+        int num = 0;
+        for (const LinkedGeoPolygon* p = &polygon_; p != nullptr;
+             p = p->next) {
+            num++;
+        }
+        return num;
+    }
+
+   private:
+    LinkedGeoPolygon polygon_;
+};
+
+}  // namespace h3
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3api_inline.h
+ * @brief   Optional inline versions of the H3 functions that only read and
+ *          write index bit fields.
+ *
+ * Each function with the Inline suffix returns the same results as the
+ * exported function without it, which the library implements by calling it,
+ * and can be compiled into the calling code instead of called through the
+ * shared library. The exported functions remain part of the API.
+ */
+
+#ifndef H3API_INLINE_H
+#define H3API_INLINE_H
+
+#include <stdint.h>
+#include "h3api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief the maximum resolution */
+#define H3_INLINE_MAX_RES 15
+/** @brief the number of base cells */
+#define H3_INLINE_NUM_BASE_CELLS 122
+/** @brief the mode of cell indexes */
+#define H3_INLINE_HEXAGON_MODE 1
+/** @brief the mode of unidirectional edge indexes */
+#define H3_INLINE_UNIEDGE_MODE 2
+
+/** @brief the bit offset of the mode */
+#define H3_INLINE_MODE_OFFSET 59
+/** @brief the bit offset of the reserved bits */
+#define H3_INLINE_RESERVED_OFFSET 56
+/** @brief the bit offset of the resolution */
+#define H3_INLINE_RES_OFFSET 52
+/** @brief the bit offset of the base cell */
+#define H3_INLINE_BC_OFFSET 45
+/** @brief the bits per index digit */
+#define H3_INLINE_PER_DIGIT_OFFSET 3
+
+/** @brief all bits of the resolution */
+#define H3_INLINE_RES_MASK (UINT64_C(15) << H3_INLINE_RES_OFFSET)
+/** @brief all bits of the index digits */
+#define H3_INLINE_DIGIT_BITS UINT64_C(0x1fffffffffff)
+/** @brief the lowest bit of each index digit */
+#define H3_INLINE_DIGIT_LOW_BITS UINT64_C(0x049249249249)
+/** @brief base cells 0 to 63 that are pentagons, one bit per base cell */
+#define H3_INLINE_PENTAGONS_LOW UINT64_C(0x8402004001004010)
+/** @brief base cells 64 to 127 that are pentagons, one bit per base cell */
+#define H3_INLINE_PENTAGONS_HIGH UINT64_C(0x0020080200080100)
+
+/** @brief returns the resolution of the index */
+static inline int h3GetResolutionInline(H3Index h) {
+    return (int)((h >> H3_INLINE_RES_OFFSET) & 15);
+}
+
+/** @brief returns the base cell of the index */
+static inline int h3GetBaseCellInline(H3Index h) {
+    return (int)((h >> H3_INLINE_BC_OFFSET) & 127);
+}
+
+/** @brief returns non-zero if the index has a Class III resolution */
+static inline int h3IsResClassIIIInline(H3Index h) {
+    return h3GetResolutionInline(h) % 2;
+}
+
+/** @brief mask of the index digits finer than a resolution, 0 to 15 */
+static inline uint64_t h3DigitsBelowInline(int res) {
+    return (UINT64_C(1) << ((H3_INLINE_MAX_RES - res) *
+                            H3_INLINE_PER_DIGIT_OFFSET)) -
+           1;
+}
+
+/** @brief returns 1 if the base cell, 0 to 127, is a pentagon */
+static inline int h3BaseCellIsPentagonInline(int baseCell) {
+    uint64_t pentagons =
+        baseCell < 64 ? H3_INLINE_PENTAGONS_LOW : H3_INLINE_PENTAGONS_HIGH;
+    return (int)((pentagons >> (baseCell & 63)) & 1);
+}
+
+/** @brief returns non-zero if the index is a pentagon */
+static inline int h3IsPentagonInline(H3Index h) {
+    uint64_t used = h & H3_INLINE_DIGIT_BITS &
+                    ~h3DigitsBelowInline(h3GetResolutionInline(h));
+    return h3BaseCellIsPentagonInline(h3GetBaseCellInline(h)) & (used == 0);
+}
+
+/**
+ * @brief returns non-zero if the index is a valid cell
+ *
+ * Every digit is checked at once with word wide masks. The unused digits are
+ * valid if all of their bits are set. A used digit is 7 if the lowest bit of
+ * its group survives ANDing the digits with themselves shifted by one and two
+ * bits. A pentagon index is in the deleted subsequence if its leading nonzero
+ * digit is 1, which is when the highest set bit of the used digits is the
+ * lowest bit of a digit.
+ */
+static inline int h3IsValidInline(H3Index h) {
+    uint64_t mode = h >> H3_INLINE_MODE_OFFSET & 15;
+    int baseCell = h3GetBaseCellInline(h);
+
+    uint64_t unusedMask = h3DigitsBelowInline(h3GetResolutionInline(h));
+    uint64_t digits = h & H3_INLINE_DIGIT_BITS;
+    uint64_t used = digits & ~unusedMask;
+    uint64_t sevens =
+        used & (used >> 1) & (used >> 2) & H3_INLINE_DIGIT_LOW_BITS;
+
+    // smear the highest used bit downward to isolate it
+    uint64_t smeared = used;
+    smeared |= smeared >> 1;
+    smeared |= smeared >> 2;
+    smeared |= smeared >> 4;
+    smeared |= smeared >> 8;
+    smeared |= smeared >> 16;
+    smeared |= smeared >> 32;
+    uint64_t highestBit = smeared ^ (smeared >> 1);
+    int deleted = h3BaseCellIsPentagonInline(baseCell) &
+                  ((highestBit & H3_INLINE_DIGIT_LOW_BITS) != 0);
+
+    return (mode == H3_INLINE_HEXAGON_MODE) &
+           (baseCell < H3_INLINE_NUM_BASE_CELLS) &
+           ((digits & unusedMask) == unusedMask) & (sevens == 0) &
+           (deleted == 0);
+}
+
+/**
+ * @brief returns the parent of the index at a coarser resolution, or 0 if
+ * the parent resolution is invalid or finer than the index
+ */
+static inline H3Index h3ToParentInline(H3Index h, int parentRes) {
+    if (parentRes < 0 || parentRes > H3_INLINE_MAX_RES) {
+        return 0;
+    }
+    uint64_t resBits = (uint64_t)parentRes << H3_INLINE_RES_OFFSET;
+    // the top bit is set when the child resolution is below parentRes
+    uint64_t isChild = ((h & H3_INLINE_RES_MASK) - resBits) >> 63;
+    return ((h & ~H3_INLINE_RES_MASK) | resBits |
+            h3DigitsBelowInline(parentRes)) &
+           (isChild - 1);
+}
+
+/** @brief returns the origin cell of the unidirectional edge */
+static inline H3Index getOriginH3IndexFromUnidirectionalEdgeInline(
+    H3Index edge) {
+    // the mode and reserved bits are the 7 bits below the high bit
+    uint64_t modeAndReserved = UINT64_C(0x7f) << H3_INLINE_RESERVED_OFFSET;
+    return (edge & ~modeAndReserved) |
+           ((uint64_t)H3_INLINE_HEXAGON_MODE << H3_INLINE_MODE_OFFSET);
+}
+
+/** @brief returns non-zero if the index is a valid unidirectional edge */
+static inline int h3UnidirectionalEdgeIsValidInline(H3Index edge) {
+    uint64_t mode = edge >> H3_INLINE_MODE_OFFSET & 15;
+    uint64_t direction = edge >> H3_INLINE_RESERVED_OFFSET & 7;
+    H3Index origin = getOriginH3IndexFromUnidirectionalEdgeInline(edge);
+    // pentagons have no edge in the deleted direction 1
+    return (mode == H3_INLINE_UNIEDGE_MODE) & (direction >= 1) &
+           (direction <= 6) &
+           !(direction == 1 && h3IsPentagonInline(origin)) &
+           h3IsValidInline(origin);
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3wasm.h
+ * @brief   The WebAssembly module of the batch functions
+ *
+ * Built into the separate h3wasm module when H3 is configured with
+ * ENABLE_WASM under Emscripten. The module exports the batch functions of
+ * h3api.h, which JavaScript calls with typed arrays in its linear memory
+ * through the wrappers of h3wasm.js.in.
+ */
+
+#ifndef H3WASM_H
+#define H3WASM_H
+
+#include "h3api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup h3WasmHasSimd128 h3WasmHasSimd128
+ * Functions for h3WasmHasSimd128
+ * @{
+ */
+/** @brief returns 1 if the module was built with WebAssembly SIMD, 0
+ * otherwise */
+int H3_EXPORT(h3WasmHasSimd128)(void);
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
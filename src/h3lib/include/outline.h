@@ -0,0 +1,31 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file outline.h
+ * @brief   Outlines of sets of hexagons traced along their boundary edges
+ */
+
+#ifndef OUTLINE_H
+#define OUTLINE_H
+
+#include "h3api.h"
+
+void h3SetToOutline(const H3Index* h3Set, const int numHexes,
+                    LinkedGeoPolygon* out);
+
+void h3SetToFlatOutline(const H3Index* h3Set, const int numHexes,
+                        FlatGeoMultiPolygon* out);
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file preparedPolygon.h
+ * @brief   Polygons indexed by latitude for repeated containment queries
+ */
+
+#ifndef PREPAREDPOLYGON_H
+#define PREPAREDPOLYGON_H
+
+#include <stdbool.h>
+#include "bbox.h"
+#include "geoCoord.h"
+#include "h3api.h"
+
+/** @struct PreparedGeofence
+ *  @brief  A geofence with its edges bucketed into latitude slices
+ */
+typedef struct {
+    const Geofence* geofence;  ///< the geofence, not owned
+    const BBox* bbox;          ///< the bounding box of the geofence
+    double south;              ///< south edge of the first slice
+    double sliceScale;         ///< number of slices per radian of latitude
+    int numSlices;             ///< number of latitude slices
+    /** offsets of each slice in edges, with a final entry for the end */
+    int* sliceOffsets;
+    /** index of the first vertex of each edge overlapping each slice */
+    int* edges;
+} PreparedGeofence;
+
+/** @brief A polygon and its holes, prepared for containment queries */
+struct PreparedGeoPolygon {
+    const GeoPolygon* geoPolygon;  ///< the polygon, not owned
+    BBox* bboxes;  ///< bboxes for the polygon and each of its holes
+    PreparedGeofence* geofences;  ///< the polygon and each of its holes
+};
+
+bool _preparedGeofenceContains(const PreparedGeofence* prepared,
+                               const GeoCoord* coord);
+bool _preparedPolygonContains(const PreparedGeoPolygon* prepared,
+                              const GeoCoord* coord);
+bool _preparedPolygonCrossesBBox(const PreparedGeoPolygon* prepared,
+                                 const BBox* bbox);
+bool _preparedPolygonCrossesGeofence(const PreparedGeoPolygon* prepared,
+                                     const Geofence* loop,
+                                     const BBox* loopBBox);
+
+#endif
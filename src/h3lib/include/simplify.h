@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file simplify.h
+ * @brief   Geofences simplified within a tolerance of a resolution
+ */
+
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "constants.h"
+#include "h3api.h"
+#include "preparedPolygon.h"
+
+/** tolerance of simplification, as a fraction of the hexagon edge length */
+#define SIMPLIFY_EDGE_FRACTION 0.1
+
+/** @brief A polygon and its simplified copies, by resolution */
+struct SimplifiedGeoPolygon {
+    const GeoPolygon* geoPolygon;  ///< the polygon, not owned
+    /** the simplified polygon of each resolution, or NULL before it is used */
+    GeoPolygon* simplified[MAX_H3_RES + 1];
+    /** the simplified polygon of each resolution, prepared */
+    PreparedGeoPolygon* prepared[MAX_H3_RES + 1];
+};
+
+void _simplifyGeofence(const Geofence* geofence, double toleranceRads,
+                       Geofence* out);
+
+#endif
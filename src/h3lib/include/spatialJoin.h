@@ -0,0 +1,40 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file spatialJoin.h
+ * @brief   Polygons prepared for assigning points to them by hexagon
+ */
+
+#ifndef SPATIALJOIN_H
+#define SPATIALJOIN_H
+
+#include <stddef.h>
+#include "h3api.h"
+#include "preparedPolygon.h"
+
+/** @brief Polygons with the hexagons inside and across each of them */
+struct H3SpatialJoin {
+    int res;                         ///< resolution points are indexed at
+    int numPolygons;                 ///< the number of polygons
+    PreparedGeoPolygon** prepared;   ///< each polygon, prepared
+    void* interior;                  ///< region index of interior hexagons
+    size_t interiorSize;             ///< size of the region index, in bytes
+    /** hexagons crossed by the boundary of each polygon, sorted by hexagon
+     * and then by polygon */
+    PolyfillCell* boundary;
+    int numBoundary;                 ///< the number of boundary hexagons
+};
+
+#endif
@@ -16,6 +16,9 @@
 /** @file stackAlloc.h
  * @brief Macro to provide cross-platform mechanism for allocating variable
  * length arrays on the stack.
+ *
+ * With H3_ENABLE_STATS, the size of the largest array is kept in the
+ * peakStackBytes counter.
  */
 
 #ifndef STACKALLOC_H
@@ -23,13 +26,15 @@
 
 #include <assert.h>
 #include <string.h>
+#include "h3Stats.h"
 
 #ifdef H3_HAVE_VLA
 
-#define STACK_ARRAY_CALLOC(type, name, numElements)        \
-    assert((numElements) > 0);                             \
-    type name##Buffer[(numElements)];                      \
-    memset(name##Buffer, 0, (numElements) * sizeof(type)); \
+#define STACK_ARRAY_CALLOC(type, name, numElements)            \
+    assert((numElements) > 0);                                 \
+    H3_STAT_MAX(peakStackBytes, (numElements) * sizeof(type)); \
+    type name##Buffer[(numElements)];                          \
+    memset(name##Buffer, 0, (numElements) * sizeof(type));     \
     type* name = name##Buffer
 
 #elif defined(H3_HAVE_ALLOCA)
@@ -40,6 +45,7 @@
 
 #define STACK_ARRAY_CALLOC(type, name, numElements)            \
     assert((numElements) > 0);                                 \
+    H3_STAT_MAX(peakStackBytes, (numElements) * sizeof(type)); \
     type* name = (type*)_alloca(sizeof(type) * (numElements)); \
     memset(name, 0, sizeof(type) * (numElements))
 
@@ -47,9 +53,10 @@
 
 #include <alloca.h>
 
-#define STACK_ARRAY_CALLOC(type, name, numElements)           \
-    assert((numElements) > 0);                                \
-    type* name = (type*)alloca(sizeof(type) * (numElements)); \
+#define STACK_ARRAY_CALLOC(type, name, numElements)            \
+    assert((numElements) > 0);                                 \
+    H3_STAT_MAX(peakStackBytes, (numElements) * sizeof(type)); \
+    type* name = (type*)alloca(sizeof(type) * (numElements));  \
     memset(name, 0, sizeof(type) * (numElements))
 
 #endif
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file vec3d.h
+ * @brief   3D floating point vector functions.
+ */
+
+#ifndef VEC3D_H
+#define VEC3D_H
+
+#include "constants.h"
+#include "fastMath.h"
+#include "geoCoord.h"
+
+/** @struct Vec3d
+ *  @brief 3D floating point structure
+ */
+typedef struct {
+    double x;  ///< x component
+    double y;  ///< y component
+    double z;  ///< z component
+} Vec3d;
+
+// Internal functions
+
+void _geoToVec3d(const GeoCoord* geo, Vec3d* point);
+double _pointSquareDist(const Vec3d* v1, const Vec3d* v2);
+
+/**
+ * Converts the squared chord distance between two points on the unit sphere
+ * to their great circle distance. The chord is 2 * sin(r / 2), which is well
+ * conditioned for small distances, unlike acos(1 - sqd / 2).
+ *
+ * @param sqd The squared distance between the points.
+ * @return The great circle distance in radians.
+ */
+static inline double _squareDistToRads(double sqd) {
+    return 2.0 * _h3Asin(sqrt(sqd) / 2.0);
+}
+
+/**
+ * Projects a point on the unit sphere onto the plane tangent to the sphere at
+ * a face center, giving its gnomonic coordinates along the hex2d axes of the
+ * face. This is the trigonometry free equivalent of taking the azimuth and
+ * the tangent of the distance from the face center, used with H3_FAST_MATH.
+ *
+ * @param p The point on the unit sphere.
+ * @param center The face center on the unit sphere.
+ * @param axes The unit vectors of the Class II hex2d x and y axes, tangent
+ *        to the sphere at the face center.
+ * @param classIII Whether to rotate the coordinates into the Class III axes.
+ * @param x The gnomonic x coordinate.
+ * @param y The gnomonic y coordinate.
+ */
+static inline void _vec3dToGnomonic(const Vec3d* p, const Vec3d* center,
+                                    const Vec3d* axes, int classIII, double* x,
+                                    double* y) {
+    double scale =
+        1.0 / (p->x * center->x + p->y * center->y + p->z * center->z);
+    double gx = (p->x * axes[0].x + p->y * axes[0].y + p->z * axes[0].z) *
+                scale;
+    double gy = (p->x * axes[1].x + p->y * axes[1].y + p->z * axes[1].z) *
+                scale;
+    if (classIII) {
+        // rotate cw by the Class III angle
+        const double c = M_COS_AP7_ROT;
+        const double s = M_SIN_AP7_ROT;
+        *x = gx * c + gy * s;
+        *y = gy * c - gx * s;
+    } else {
+        *x = gx;
+        *y = gy;
+    }
+}
+
+/**
+ * Finds the point on the sphere with the given gnomonic coordinates on a
+ * face, the inverse of _vec3dToGnomonic. The longitude is in (-pi, pi].
+ *
+ * @param x The gnomonic x coordinate.
+ * @param y The gnomonic y coordinate.
+ * @param center The face center on the unit sphere.
+ * @param axes The unit vectors of the Class II hex2d x and y axes.
+ * @param classIII Whether the coordinates are along the Class III axes.
+ * @param lat The latitude of the point, in radians.
+ * @param lon The longitude of the point, in radians.
+ */
+static inline void _gnomonicToGeo(double x, double y, const Vec3d* center,
+                                  const Vec3d* axes, int classIII, double* lat,
+                                  double* lon) {
+    double gx = x;
+    double gy = y;
+    if (classIII) {
+        // rotate ccw by the Class III angle
+        const double c = M_COS_AP7_ROT;
+        const double s = M_SIN_AP7_ROT;
+        gx = x * c - y * s;
+        gy = y * c + x * s;
+    }
+    double px = center->x + gx * axes[0].x + gy * axes[1].x;
+    double py = center->y + gx * axes[0].y + gy * axes[1].y;
+    double pz = center->z + gx * axes[0].z + gy * axes[1].z;
+    *lat = _h3Atan2(pz, sqrt(px * px + py * py));
+    *lon = _h3Atan2(py, px);
+}
+
+#endif
@@ -34,14 +34,33 @@ struct VertexNode {
     VertexNode* next;
 };
 
+/** @struct VertexNodeSlab
+ *  @brief A contiguous block of vertex nodes owned by a vertex graph
+ */
+typedef struct VertexNodeSlab VertexNodeSlab;
+struct VertexNodeSlab {
+    VertexNodeSlab* next;
+    int capacity;
+    int used;
+    VertexNode nodes[];
+};
+
 /** @struct VertexGraph
  *  @brief A data structure to store a graph of vertices
+ *
+ *  Nodes are carved out of slabs rather than allocated one at a time, and
+ *  removed nodes are kept on a free list for reuse. Node pointers remain
+ *  valid until the node is removed or the graph is destroyed.
  */
 typedef struct {
     VertexNode** buckets;
     int numBuckets;
     int size;
     int res;
+    /** Lowest bucket index that may be non-empty */
+    int firstBucket;
+    VertexNodeSlab* slabs;
+    VertexNode* freeNodes;
 } VertexGraph;
 
 void initVertexGraph(VertexGraph* graph, int numBuckets, int res);
@@ -18,18 +18,27 @@
  */
 
 #include "algos.h"
+#include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include "baseCells.h"
 #include "bbox.h"
 #include "faceijk.h"
 #include "geoCoord.h"
+#include "h3Alloc.h"
 #include "h3Index.h"
+#include "h3IndexSet.h"
+#include "h3Stats.h"
 #include "h3api.h"
+#include "h3api_inline.h"
 #include "linkedGeo.h"
-#include "stackAlloc.h"
+#include "outline.h"
+#include "preparedPolygon.h"
+#include "scratch.h"
 #include "vertexGraph.h"
 
 /*
@@ -39,6 +48,7 @@
 #define HEX_RANGE_SUCCESS 0
 #define HEX_RANGE_PENTAGON 1
 #define HEX_RANGE_K_SUBSEQUENCE 2
+#define HEX_RANGE_K_TOO_LARGE 3
 
 /**
  * Directions used for traversing a hexagonal ring counterclockwise around
@@ -64,18 +74,37 @@ static const int NEXT_RING_DIRECTION = I_AXES_DIGIT;
 
 /**
  * Maximum number of indices that result from the kRing algorithm with the given
- * k.
+ * k, 1 + 3k(k + 1).
  *
  * @param k k value, k >= 0.
+ * @return The number of indices, or -1 if k > H3_MAX_KRING_K so that it does
+ * not fit in an int
  */
 int H3_EXPORT(maxKringSize)(int k) {
-    int result = 1;
-    for (int i = 0; i < k; i++) {
-        result = result + 6 * (i + 1);
-    }
-    return result;
+    if (k > H3_MAX_KRING_K) return -1;
+    return (int)H3_MAX_KRING_SIZE(k);
+}
+
+/**
+ * Maximum number of indices that result from the kRing algorithm with the given
+ * k, as a 64 bit integer.
+ *
+ * @param k k value, k >= 0.
+ * @return The number of indices, or -1 if k > H3_MAX_KRING_K64 so that it
+ * does not fit in an int64_t
+ */
+int64_t H3_EXPORT(maxKringSize64)(int k) {
+    if (k > H3_MAX_KRING_K64) return -1;
+    return H3_MAX_KRING_SIZE(k);
 }
 
+/**
+ * The largest number of indexes for which the k-ring functions keep their
+ * working memory on the stack, that of k = 16. Larger k-rings take it from
+ * the heap, so that no k can overflow the stack.
+ */
+#define KRING_STACK_MAX_IDX ((int)H3_MAX_KRING_SIZE(16))
+
 /**
  * k-rings produces indices within k distance of the origin index.
  *
@@ -88,11 +117,22 @@ int H3_EXPORT(maxKringSize)(int k) {
  * @param origin Origin location.
  * @param k k >= 0
  * @param out Zero-filled array which must be of size maxKringSize(k).
+ * @return 0 on success, or -1 if k > H3_MAX_KRING_K, when nothing is
+ * written, or if working memory could not be allocated, when out is left
+ * zeroed
  */
-void H3_EXPORT(kRing)(H3Index origin, int k, H3Index* out) {
+int H3_EXPORT(kRing)(H3Index origin, int k, H3Index* out) {
     int maxIdx = H3_EXPORT(maxKringSize)(k);
-    STACK_ARRAY_CALLOC(int, distances, maxIdx);
-    H3_EXPORT(kRingDistances)(origin, k, out, distances);
+    if (maxIdx < 0) return -1;
+    int stackDistances[KRING_STACK_MAX_IDX];
+    int* distances = stackDistances;
+    if (maxIdx > KRING_STACK_MAX_IDX) {
+        distances = H3_MEMORY(malloc)((size_t)maxIdx * sizeof(int));
+        if (distances == NULL) return -1;
+    }
+    int result = H3_EXPORT(kRingDistances)(origin, k, out, distances);
+    if (distances != stackDistances) H3_MEMORY(free)(distances);
+    return result;
 }
 
 /**
@@ -108,69 +148,275 @@ void H3_EXPORT(kRing)(H3Index origin, int k, H3Index* out) {
  * @param k k >= 0
  * @param out Zero-filled array which must be of size maxKringSize(k).
  * @param distances Zero-filled array which must be of size maxKringSize(k).
+ * @return 0 on success, or -1 if k > H3_MAX_KRING_K, when nothing is
+ * written, or if working memory could not be allocated, when out and
+ * distances are left zeroed
  */
-void H3_EXPORT(kRingDistances)(H3Index origin, int k, H3Index* out,
-                               int* distances) {
+int H3_EXPORT(kRingDistances)(H3Index origin, int k, H3Index* out,
+                              int* distances) {
     int maxIdx = H3_EXPORT(maxKringSize)(k);
+    if (maxIdx < 0) return -1;
     // Optimistically try the faster hexRange algorithm first
     int failed = H3_EXPORT(hexRangeDistances)(origin, k, out, distances);
     if (failed) {
         // Fast algo failed, fall back to slower, correct algo
         // and also wipe out array because contents untrustworthy
+        H3_STAT_ADD(kRingFallbacks, 1);
         for (int i = 0; i < maxIdx; i++) {
             out[i] = 0;
             distances[i] = 0;
         }
-        _kRingInternal(origin, k, out, distances, maxIdx, 0);
+        return _kRingInternal(origin, k, out, distances, maxIdx, 0);
+    }
+    return 0;
+}
+
+/**
+ * Adds an index to the k-ring output, treating it as an open addressed hash
+ * set with linear probing.
+ *
+ * @param h The index to add
+ * @param curK Distance from the origin to the index
+ * @param out Array treated as a hash set, elements being either H3Index or 0.
+ * @param distances Elements paralleling the out array, set to curK
+ * @param maxIdx Size of out and distances arrays
+ * @return The slot the index was added at, or -1 if it was already present
+ */
+static int _kRingInsert(H3Index h, int curK, H3Index* out, int* distances,
+                        int maxIdx) {
+    int off = _h3IndexSlot(h, maxIdx);
+    for (int probes = 0; probes < maxIdx; probes++) {
+        if (out[off] == h) {
+            return -1;
+        }
+        if (out[off] == 0) {
+            out[off] = h;
+            distances[off] = curK;
+            return off;
+        }
+        off++;
+        if (off >= maxIdx) {
+            off = 0;
+        }
     }
+    return -1;
 }
 
 /**
- * Internal helper function called recursively for kRingDistances.
+ * Breadth first k-ring, correct in the presence of pentagons.
  *
- * Adds the origin index to the output set (treating it as a hash set)
- * and recurses to its neighbors, if needed.
+ * Visits indexes one ring at a time, using the output array as the visited
+ * set. Each index is expanded at most once, at its shortest distance from
+ * the origin.
  *
  * @param origin
  * @param k Maximum distance to move from the origin.
- * @param out Array treated as a hash set, elements being either H3Index or 0.
+ * @param out Zeroed array treated as a hash set, elements being either
+ * H3Index or 0.
  * @param distances Scratch area, with elements paralleling the out array.
  * Elements indicate ijk distance from the origin index to the output index.
  * @param maxIdx Size of out and scratch arrays (must be maxKringSize(k))
- * @param curK Current distance from the origin.
+ * @param curK Distance of the origin, usually 0.
+ * @param queue Working memory of maxIdx elements, need not be zeroed.
  */
-void _kRingInternal(H3Index origin, int k, H3Index* out, int* distances,
-                    int maxIdx, int curK) {
+static void _kRingBreadthFirst(H3Index origin, int k, H3Index* out,
+                               int* distances, int maxIdx, int curK,
+                               int* queue) {
     if (origin == 0) return;
 
-    // Put origin in the output array. out is used as a hash set.
-    int off = origin % maxIdx;
-    while (out[off] != 0 && out[off] != origin) {
-        off++;
-        if (off >= maxIdx) {
-            off = 0;
+    // queue holds the slots of the indexes still to be expanded, in order of
+    // distance
+    int head = 0;
+    int tail = 0;
+
+    int slot = _kRingInsert(origin, curK, out, distances, maxIdx);
+    if (slot >= 0 && curK < k) {
+        queue[tail++] = slot;
+    }
+
+    while (head < tail) {
+        int current = queue[head++];
+        H3Index h = out[current];
+        int nextK = distances[current] + 1;
+        for (int i = 0; i < 6; i++) {
+            int rotations = 0;
+            H3Index neighbor =
+                h3NeighborRotations(h, DIRECTIONS[i], &rotations);
+            if (neighbor == 0) continue;
+            slot = _kRingInsert(neighbor, nextK, out, distances, maxIdx);
+            if (slot >= 0 && nextK < k) {
+                queue[tail++] = slot;
+            }
         }
     }
+}
+
+/**
+ * Internal algorithm for kRingDistances, correct in the presence of
+ * pentagons. See _kRingBreadthFirst.
+ *
+ * @param origin
+ * @param k Maximum distance to move from the origin.
+ * @param out Array treated as a hash set, elements being either H3Index or 0.
+ * @param distances Scratch area, with elements paralleling the out array.
+ * Elements indicate ijk distance from the origin index to the output index.
+ * @param maxIdx Size of out and scratch arrays (must be maxKringSize(k))
+ * @param curK Distance of the origin, usually 0.
+ * @return 0 on success, or -1 without writing anything if the queue of the
+ * search could not be allocated
+ */
+int _kRingInternal(H3Index origin, int k, H3Index* out, int* distances,
+                   int maxIdx, int curK) {
+    int stackQueue[KRING_STACK_MAX_IDX];
+    int* queue = stackQueue;
+    if (maxIdx > KRING_STACK_MAX_IDX) {
+        queue = H3_MEMORY(malloc)((size_t)maxIdx * sizeof(int));
+        if (queue == NULL) return -1;
+    }
+    _kRingBreadthFirst(origin, k, out, distances, maxIdx, curK, queue);
+    if (queue != stackQueue) H3_MEMORY(free)(queue);
+    return 0;
+}
+
+/**
+ * kRingDistances using the given working memory, so that it is safe to call
+ * with large k on small stacks.
+ *
+ * @param origin Origin location.
+ * @param k k >= 0
+ * @param out Array which must be of size maxKringSize(k).
+ * @param distances Array which must be of size maxKringSize(k).
+ * @param queue Working memory of maxKringSize(k) elements.
+ */
+static void _kRingDistancesWithQueue(H3Index origin, int k, H3Index* out,
+                                     int* distances, int* queue) {
+    int maxIdx = H3_EXPORT(maxKringSize)(k);
+    if (H3_EXPORT(hexRangeDistances)(origin, k, out, distances)) {
+        H3_STAT_ADD(kRingFallbacks, 1);
+        memset(out, 0, (size_t)maxIdx * sizeof(H3Index));
+        memset(distances, 0, (size_t)maxIdx * sizeof(int));
+        _kRingBreadthFirst(origin, k, out, distances, maxIdx, 0, queue);
+    }
+}
 
-    // We either got a free slot in the hash set or hit a duplicate
-    // We might need to process the duplicate anyways because we got
-    // here on a longer path before.
-    if (out[off] == origin && distances[off] <= curK) return;
+/**
+ * kRingDistances using heap working memory from the given scratch instead of
+ * the stack. Reusing the scratch across calls avoids allocating on each call.
+ *
+ * @param origin Origin location.
+ * @param k k >= 0
+ * @param out Array which must be of size maxKringSize(k).
+ * @param distances Array which must be of size maxKringSize(k).
+ * @param scratch Working memory
+ * Nothing is written if k > H3_MAX_KRING_K.
+ */
+void H3_EXPORT(kRingDistancesWithScratch)(H3Index origin, int k, H3Index* out,
+                                          int* distances, H3Scratch* scratch) {
+    int maxIdx = H3_EXPORT(maxKringSize)(k);
+    if (maxIdx < 0) return;
+    int* queue = _scratchReserve(scratch, (size_t)maxIdx * sizeof(int));
+    _kRingDistancesWithQueue(origin, k, out, distances, queue);
+}
 
-    out[off] = origin;
-    distances[off] = curK;
+/**
+ * kRing using heap working memory from the given scratch instead of the
+ * stack. Reusing the scratch across calls avoids allocating on each call.
+ *
+ * @param origin Origin location.
+ * @param k k >= 0
+ * @param out Array which must be of size maxKringSize(k).
+ * @param scratch Working memory
+ * Nothing is written if k > H3_MAX_KRING_K.
+ */
+void H3_EXPORT(kRingWithScratch)(H3Index origin, int k, H3Index* out,
+                                 H3Scratch* scratch) {
+    int maxIdx = H3_EXPORT(maxKringSize)(k);
+    if (maxIdx < 0) return;
+    int* distances =
+        _scratchReserve(scratch, 2 * (size_t)maxIdx * sizeof(int));
+    _kRingDistancesWithQueue(origin, k, out, distances, distances + maxIdx);
+}
 
-    // Base case: reached an index k away from the origin.
-    if (curK >= k) return;
+/**
+ * kRingOrdered produces indexes within k distance of the origin index,
+ * grouped by their distance from it.
+ *
+ * Output is placed contiguously at the start of `out`, nearest first, with
+ * no zero elements. Ring r, the indexes at distance r, is
+ * out[ringOffsets[r]] up to but not including out[ringOffsets[r + 1]], so
+ * callers need neither sort by distance nor skip empty elements.
+ *
+ * Away from pentagons the output is that of hexRangeDistances. Otherwise
+ * it falls back to a breadth first search, which uses out as its queue so
+ * that each ring follows the one before.
+ *
+ * @param origin Origin location.
+ * @param k k >= 0
+ * @param out Array which must be of size maxKringSize(k), need not be
+ * zeroed.
+ * @param ringOffsets Array which must be of size k + 2.
+ * @return The number of indexes written to out, or -1 without writing
+ * anything if k > H3_MAX_KRING_K
+ */
+int H3_EXPORT(kRingOrdered)(H3Index origin, int k, H3Index* out,
+                            int* ringOffsets) {
+    int maxIdx = H3_EXPORT(maxKringSize)(k);
+    if (maxIdx < 0) return -1;
+    ringOffsets[0] = 0;
+    if (!H3_EXPORT(hexRangeDistances)(origin, k, out, NULL)) {
+        for (int ring = 1; ring <= k + 1; ring++) {
+            ringOffsets[ring] = 3 * ring * (ring - 1) + 1;
+        }
+        return ringOffsets[k + 1];
+    }
 
-    // Recurse to all neighbors in no particular order.
-    for (int i = 0; i < 6; i++) {
-        int rotations = 0;
-        _kRingInternal(h3NeighborRotations(origin, DIRECTIONS[i], &rotations),
-                       k, out, distances, maxIdx, curK + 1);
+    H3_STAT_ADD(kRingFallbacks, 1);
+    H3IndexSet* visited =
+        H3_EXPORT(createH3IndexSet)(maxIdx);
+    out[0] = origin;
+    H3_EXPORT(h3IndexSetAdd)(visited, origin);
+    int tail = 1;
+    ringOffsets[1] = tail;
+    for (int ring = 1; ring <= k; ring++) {
+        for (int head = ringOffsets[ring - 1]; head < ringOffsets[ring];
+             head++) {
+            for (int i = 0; i < 6; i++) {
+                int rotations = 0;
+                H3Index neighbor =
+                    h3NeighborRotations(out[head], DIRECTIONS[i], &rotations);
+                if (H3_EXPORT(h3IndexSetAdd)(visited, neighbor)) {
+                    out[tail++] = neighbor;
+                }
+            }
+        }
+        ringOffsets[ring + 1] = tail;
     }
+    H3_EXPORT(destroyH3IndexSet)(visited);
+    return tail;
 }
 
+// generated by hand
+/** Current digit -> direction -> new digit */
+static const int NEW_DIGIT_II[7][7] = {
+    {0, 1, 2, 3, 4, 5, 6}, {1, 4, 3, 6, 5, 2, 0}, {2, 3, 1, 4, 6, 0, 5},
+    {3, 6, 4, 5, 0, 1, 2}, {4, 5, 6, 0, 2, 3, 1}, {5, 2, 0, 1, 3, 6, 4},
+    {6, 0, 5, 2, 1, 4, 3}};
+/** Current digit -> direction -> new ap7 move */
+static const int NEW_ADJUSTMENT_II[7][7] = {
+    {0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 1, 0, 5, 0}, {0, 0, 2, 3, 0, 0, 2},
+    {0, 1, 3, 3, 0, 0, 0}, {0, 0, 0, 0, 4, 4, 6}, {0, 5, 0, 0, 4, 5, 0},
+    {0, 0, 2, 0, 6, 0, 6}};
+/** Current digit -> direction -> new digit */
+static const int NEW_DIGIT_III[7][7] = {
+    {0, 1, 2, 3, 4, 5, 6}, {1, 2, 3, 4, 5, 6, 0}, {2, 3, 4, 5, 6, 0, 1},
+    {3, 4, 5, 6, 0, 1, 2}, {4, 5, 6, 0, 1, 2, 3}, {5, 6, 0, 1, 2, 3, 4},
+    {6, 0, 1, 2, 3, 4, 5}};
+/** Current digit -> direction -> new ap7 move */
+static const int NEW_ADJUSTMENT_III[7][7] = {
+    {0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 3, 0, 1, 0}, {0, 0, 2, 2, 0, 0, 6},
+    {0, 3, 2, 3, 0, 0, 0}, {0, 0, 0, 0, 4, 5, 4}, {0, 1, 0, 0, 5, 5, 0},
+    {0, 0, 6, 0, 4, 0, 6}};
+
 /**
  * Returns the hexagon index neighboring the origin, in the direction dir.
  *
@@ -195,10 +441,26 @@ H3Index h3NeighborRotations(H3Index origin, int dir, int* rotations) {
 
     int newRotations = 0;
     int oldBaseCell = H3_GET_BASE_CELL(out);
-    int oldLeadingDigit = _h3LeadingNonZeroDigit(out);
+    int res = H3_GET_RESOLUTION(out);
+
+    // Fast path: within a hexagon base cell, a move that stays inside the
+    // parent of the origin only changes the finest digit. This is the case
+    // for about six in seven moves.
+    if (res > 0 && !_isBaseCellPentagon(oldBaseCell)) {
+        int oldDigit = H3_GET_INDEX_DIGIT(out, res);
+        if (isResClassIII(res)) {
+            if (NEW_ADJUSTMENT_II[oldDigit][dir] == 0) {
+                H3_SET_INDEX_DIGIT(out, res, NEW_DIGIT_II[oldDigit][dir]);
+                return out;
+            }
+        } else if (NEW_ADJUSTMENT_III[oldDigit][dir] == 0) {
+            H3_SET_INDEX_DIGIT(out, res, NEW_DIGIT_III[oldDigit][dir]);
+            return out;
+        }
+    }
 
     // Adjust the indexing digits and, if needed, the base cell.
-    int r = H3_GET_RESOLUTION(out) - 1;
+    int r = res - 1;
     while (true) {
         if (r == -1) {
             H3_SET_BASE_CELL(out, baseCellNeighbors[oldBaseCell][dir]);
@@ -220,32 +482,6 @@ H3Index h3NeighborRotations(H3Index origin, int dir, int* rotations) {
 
             break;
         } else {
-            // generated by hand
-            // Current digit -> direction -> new digit
-            const int NEW_DIGIT_II[7][7] = {
-                {0, 1, 2, 3, 4, 5, 6}, {1, 4, 3, 6, 5, 2, 0},
-                {2, 3, 1, 4, 6, 0, 5}, {3, 6, 4, 5, 0, 1, 2},
-                {4, 5, 6, 0, 2, 3, 1}, {5, 2, 0, 1, 3, 6, 4},
-                {6, 0, 5, 2, 1, 4, 3}};
-            // Current digit -> direction -> new ap7 move
-            const int NEW_ADJUSTMENT_II[7][7] = {
-                {0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 1, 0, 5, 0},
-                {0, 0, 2, 3, 0, 0, 2}, {0, 1, 3, 3, 0, 0, 0},
-                {0, 0, 0, 0, 4, 4, 6}, {0, 5, 0, 0, 4, 5, 0},
-                {0, 0, 2, 0, 6, 0, 6}};
-            // Current digit -> direction -> new digit
-            const int NEW_DIGIT_III[7][7] = {
-                {0, 1, 2, 3, 4, 5, 6}, {1, 2, 3, 4, 5, 6, 0},
-                {2, 3, 4, 5, 6, 0, 1}, {3, 4, 5, 6, 0, 1, 2},
-                {4, 5, 6, 0, 1, 2, 3}, {5, 6, 0, 1, 2, 3, 4},
-                {6, 0, 1, 2, 3, 4, 5}};
-            // Current digit -> direction -> new ap7 move
-            const int NEW_ADJUSTMENT_III[7][7] = {
-                {0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 3, 0, 1, 0},
-                {0, 0, 2, 2, 0, 0, 6}, {0, 3, 2, 3, 0, 0, 0},
-                {0, 0, 0, 0, 4, 5, 4}, {0, 1, 0, 0, 5, 5, 0},
-                {0, 0, 6, 0, 4, 0, 6}};
-
             int oldDigit = H3_GET_INDEX_DIGIT(out, r + 1);
             int nextDir;
             if (isResClassIII(r + 1)) {
@@ -292,6 +528,7 @@ H3Index h3NeighborRotations(H3Index origin, int dir, int* rotations) {
                 // In this case, we traversed into the deleted
                 // k subsequence from within the same pentagon
                 // base cell.
+                int oldLeadingDigit = _h3LeadingNonZeroDigit(origin);
                 if (oldLeadingDigit == CENTER_DIGIT) {
                     // Undefined: the k direction is deleted from here
                     return 0;
@@ -397,7 +634,7 @@ int H3_EXPORT(hexRangeDistances)(H3Index origin, int k, H3Index* out,
     }
     idx++;
 
-    if (H3_EXPORT(h3IsPentagon)(origin)) {
+    if (h3IsPentagonInline(origin)) {
         // Pentagon was encountered; bail out as user doesn't want this.
         return HEX_RANGE_PENTAGON;
     }
@@ -424,7 +661,7 @@ int H3_EXPORT(hexRangeDistances)(H3Index origin, int k, H3Index* out,
                 return HEX_RANGE_K_SUBSEQUENCE;  // LCOV_EXCL_LINE
             }
 
-            if (H3_EXPORT(h3IsPentagon)(origin)) {
+            if (h3IsPentagonInline(origin)) {
                 // Pentagon was encountered; bail out as user doesn't want this.
                 return HEX_RANGE_PENTAGON;
             }
@@ -454,7 +691,7 @@ int H3_EXPORT(hexRangeDistances)(H3Index origin, int k, H3Index* out,
             }
         }
 
-        if (H3_EXPORT(h3IsPentagon)(origin)) {
+        if (h3IsPentagonInline(origin)) {
             // Pentagon was encountered; bail out as user doesn't want this.
             return HEX_RANGE_PENTAGON;
         }
@@ -472,21 +709,93 @@ int H3_EXPORT(hexRangeDistances)(H3Index origin, int k, H3Index* out,
  * @param k The number of rings to generate
  * @param out A pointer to the output memory to dump the new set of H3Indexes to
  *            The memory block should be equal to maxKringSize(k) * length
- * @return 0 if no pentagon is encountered. Cannot trust output otherwise
+ * @return 0 if no pentagon is encountered. Cannot trust output otherwise.
+ * Nothing is written if k > H3_MAX_KRING_K.
  */
 int H3_EXPORT(hexRanges)(H3Index* h3Set, int length, int k, H3Index* out) {
     int success = 0;
     H3Index* segment;
     int segmentSize = H3_EXPORT(maxKringSize)(k);
+    if (segmentSize < 0) return HEX_RANGE_K_TOO_LARGE;
     for (int i = 0; i < length; i++) {
         // Determine the appropriate segment of the output array to operate on
-        segment = out + i * segmentSize;
+        segment = out + (size_t)i * segmentSize;
         success = H3_EXPORT(hexRange)(h3Set[i], k, segment);
         if (success != 0) return success;
     }
     return 0;
 }
 
+/**
+ * Maximum number of hexagons in the union of the k-rings of the given
+ * number of origins.
+ *
+ * @param numOrigins The number of origins
+ * @param k k >= 0
+ * @return The number of hexagons to allocate memory for, or -1 if it does
+ * not fit in an int
+ */
+int H3_EXPORT(maxKringsUnionSize)(int numOrigins, int k) {
+    int kRingSize = H3_EXPORT(maxKringSize)(k);
+    if (kRingSize < 0) return -1;
+    int64_t size = (int64_t)numOrigins * kRingSize;
+    if (size > INT_MAX) return -1;
+    return (int)size;
+}
+
+/**
+ * kRingsUnion produces the union of the k-rings of many origins, each index
+ * once, with its distance to the nearest origin.
+ *
+ * All origins are expanded together as one breadth first search sharing a
+ * single visited set, so each index is expanded once no matter how many
+ * k-rings it is in. The search steps around pentagons like kRing does, so
+ * origins near pentagons need no special handling. Empty origins are
+ * skipped.
+ *
+ * The output is written contiguously, in order of increasing distance.
+ *
+ * @param origins The origins
+ * @param numOrigins The number of origins
+ * @param k k >= 0
+ * @param out Array which must be of size maxKringsUnionSize(numOrigins, k)
+ * @param distances Array which must be of size
+ *                  maxKringsUnionSize(numOrigins, k)
+ * @return The number of indexes written to out
+ */
+int H3_EXPORT(kRingsUnion)(const H3Index* origins, int numOrigins, int k,
+                           H3Index* out, int* distances) {
+    H3IndexSet* visited = H3_EXPORT(createH3IndexSet)(numOrigins);
+
+    // out doubles as the queue of the search, so the indexes found at each
+    // distance follow those found at the one before.
+    int tail = 0;
+    for (int i = 0; i < numOrigins; i++) {
+        if (H3_EXPORT(h3IndexSetAdd)(visited, origins[i])) {
+            out[tail] = origins[i];
+            distances[tail] = 0;
+            tail++;
+        }
+    }
+    for (int head = 0; head < tail && distances[head] < k; head++) {
+        H3Index h = out[head];
+        int nextK = distances[head] + 1;
+        for (int i = 0; i < 6; i++) {
+            int rotations = 0;
+            H3Index neighbor =
+                h3NeighborRotations(h, DIRECTIONS[i], &rotations);
+            if (H3_EXPORT(h3IndexSetAdd)(visited, neighbor)) {
+                out[tail] = neighbor;
+                distances[tail] = nextK;
+                tail++;
+            }
+        }
+    }
+
+    H3_EXPORT(destroyH3IndexSet)(visited);
+    return tail;
+}
+
 /**
  * Returns the hollow hexagonal ring centered at origin with sides of length k.
  *
@@ -506,7 +815,7 @@ int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index* out) {
     // which faces have been crossed.)
     int rotations = 0;
     // Scratch structure for checking for pentagons
-    if (H3_EXPORT(h3IsPentagon)(origin)) {
+    if (h3IsPentagonInline(origin)) {
         // Pentagon was encountered; bail out as user doesn't want this.
         return HEX_RANGE_PENTAGON;
     }
@@ -519,7 +828,7 @@ int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index* out) {
             return HEX_RANGE_K_SUBSEQUENCE;  // LCOV_EXCL_LINE
         }
 
-        if (H3_EXPORT(h3IsPentagon)(origin)) {
+        if (h3IsPentagonInline(origin)) {
             return HEX_RANGE_PENTAGON;
         }
     }
@@ -546,7 +855,7 @@ int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index* out) {
                 out[idx] = origin;
                 idx++;
 
-                if (H3_EXPORT(h3IsPentagon)(origin)) {
+                if (h3IsPentagonInline(origin)) {
                     return HEX_RANGE_PENTAGON;
                 }
             }
@@ -563,6 +872,417 @@ int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index* out) {
     }
 }
 
+/**
+ * hexRingIterInit starts an outward walk over the hollow rings centered at
+ * origin. Successive calls to hexRingIterNext produce rings 0, 1, 2, ...
+ * in the same order as hexRing, with each ring continuing from where the
+ * previous one ended rather than walking out from the origin again.
+ *
+ * The iterator holds no memory, so it may be abandoned at any ring.
+ *
+ * @param iter The iterator to initialize
+ * @param origin Origin location.
+ */
+void H3_EXPORT(hexRingIterInit)(HexRingIterator* iter, H3Index origin) {
+    iter->start = origin;
+    iter->ring = 0;
+    iter->rotations = 0;
+    iter->status = HEX_RANGE_SUCCESS;
+}
+
+/**
+ * hexRingIterNext writes the next hollow ring of the walk started by
+ * hexRingIterInit, and advances the iterator to the ring after it.
+ *
+ * The ring is found by one step outward from the first index of the
+ * previous ring, followed by a walk around the new ring, so producing ring
+ * k costs O(k). Once pentagonal distortion has been encountered the walk
+ * cannot continue, and this and every later call return the error without
+ * advancing.
+ *
+ * @param iter The iterator
+ * @param out Array which must be of size 6 * iter->ring (or 1 if it is 0)
+ * @return 0 if no pentagonal distortion was encountered.
+ */
+int H3_EXPORT(hexRingIterNext)(HexRingIterator* iter, H3Index* out) {
+    if (iter->status != HEX_RANGE_SUCCESS) {
+        return iter->status;
+    }
+    int k = iter->ring;
+    if (k == 0) {
+        // Short-circuit on 'identity' ring
+        out[0] = iter->start;
+        iter->ring++;
+        return HEX_RANGE_SUCCESS;
+    }
+    if (h3IsPentagonInline(iter->start)) {
+        // Pentagon was encountered; bail out as user doesn't want this.
+        iter->status = HEX_RANGE_PENTAGON;
+        return iter->status;
+    }
+
+    H3Index origin = h3NeighborRotations(iter->start, NEXT_RING_DIRECTION,
+                                         &iter->rotations);
+    if (origin == 0) {
+        // Should not be possible because `start` would have to be a
+        // pentagon
+        iter->status = HEX_RANGE_K_SUBSEQUENCE;  // LCOV_EXCL_LINE
+        return iter->status;                     // LCOV_EXCL_LINE
+    }
+    if (h3IsPentagonInline(origin)) {
+        iter->status = HEX_RANGE_PENTAGON;
+        return iter->status;
+    }
+
+    H3Index lastIndex = origin;
+    // Walking around the ring changes the rotations, but the next ring
+    // starts from the first index of this one, so work on a copy.
+    int rotations = iter->rotations;
+    int idx = 0;
+    out[idx] = origin;
+    idx++;
+
+    for (int direction = 0; direction < 6; direction++) {
+        for (int pos = 0; pos < k; pos++) {
+            origin =
+                h3NeighborRotations(origin, DIRECTIONS[direction], &rotations);
+            if (origin == 0) {
+                // Should not be possible because `origin` would have to be a
+                // pentagon
+                iter->status = HEX_RANGE_K_SUBSEQUENCE;  // LCOV_EXCL_LINE
+                return iter->status;                     // LCOV_EXCL_LINE
+            }
+
+            // Skip the very last index, it was already added.
+            if (pos != k - 1 || direction != 5) {
+                out[idx] = origin;
+                idx++;
+
+                if (h3IsPentagonInline(origin)) {
+                    iter->status = HEX_RANGE_PENTAGON;
+                    return iter->status;
+                }
+            }
+        }
+    }
+
+    // As in hexRing, not arriving back at the first index indicates
+    // pentagonal distortion.
+    if (lastIndex != origin) {
+        iter->status = HEX_RANGE_PENTAGON;
+        return iter->status;
+    }
+    iter->start = lastIndex;
+    iter->ring++;
+    return HEX_RANGE_SUCCESS;
+}
+
+/**
+ * maxGeoRadiusToCellsSize returns the number of indexes to allocate space
+ * for when calling geoRadiusToCells with the given radius and resolution.
+ *
+ * @param radiusKm Radius in km, >= 0
+ * @param res Hexagon resolution (0-15)
+ * @return The number of indexes to allocate for, 0 if the arguments are
+ * invalid, or -1 if the radius is too large for the size to fit in an int
+ */
+int H3_EXPORT(maxGeoRadiusToCellsSize)(double radiusKm, int res) {
+    if (res < 0 || res > MAX_H3_RES || !(radiusKm >= 0)) return 0;
+    return H3_EXPORT(maxKringSize)(circleHexRadius(radiusKm, res));
+}
+
+/** An index with the distance of its center from the search center */
+typedef struct {
+    double distanceKm;
+    H3Index h;
+} RadiusCell;
+
+/**
+ * Orders RadiusCells by distance, breaking ties by index.
+ */
+static int _compareRadiusCells(const void* a, const void* b) {
+    const RadiusCell* ca = a;
+    const RadiusCell* cb = b;
+    if (ca->distanceKm != cb->distanceKm) {
+        return ca->distanceKm < cb->distanceKm ? -1 : 1;
+    }
+    return (ca->h > cb->h) - (ca->h < cb->h);
+}
+
+/**
+ * Keeps the indexes of one ring whose centers are within a radius, moving
+ * them down to out[*count] onwards.
+ *
+ * @param center The search center
+ * @param radiusKm The search radius in km
+ * @param out The output, holding the ring at out[start] to out[start + n - 1]
+ * @param distances Distances of the kept indexes, at their offsets in out
+ * @param start Offset of the ring in out, >= *count
+ * @param n Number of indexes in the ring
+ * @param count Number of indexes kept so far, to be updated
+ * @return The distance in km of the nearest center in the ring
+ */
+static double _keepWithinRadius(const GeoCoord* center, double radiusKm,
+                                H3Index* out, double* distances, int start,
+                                int n, int* count) {
+    double nearestKm = DBL_MAX;
+    for (int i = start; i < start + n; i++) {
+        GeoCoord cellCenter;
+        H3_EXPORT(h3ToGeo)(out[i], &cellCenter);
+        double distanceKm = _geoDistKm(center, &cellCenter);
+        if (distanceKm < nearestKm) nearestKm = distanceKm;
+        if (distanceKm <= radiusKm) {
+            out[*count] = out[i];
+            distances[*count] = distanceKm;
+            (*count)++;
+        }
+    }
+    return nearestKm;
+}
+
+/**
+ * geoRadiusToCells produces the indexes at the given resolution whose
+ * centers are within a great circle distance of a point, nearest first.
+ *
+ * The search walks the hollow rings around the index containing the point,
+ * out to the k that circleHexRadius guarantees holds the whole circle. It
+ * stops early once every center of a ring is beyond the radius by more than
+ * the size of a hexagon, as only rings crossing the circle can have centers
+ * in it. Near pentagons, where the rings cannot be walked, the k-ring is
+ * expanded breadth first instead.
+ *
+ * @param center The point, in radians
+ * @param radiusKm The radius in km, >= 0
+ * @param res Hexagon resolution (0-15)
+ * @param out Array which must be of size
+ * maxGeoRadiusToCellsSize(radiusKm, res), need not be zeroed
+ * @param distancesKm Array of the same size for the distance in km from
+ * center to the center of each output index, or NULL
+ * @return The number of indexes written to out, or -1 without writing
+ * anything if maxGeoRadiusToCellsSize is -1
+ */
+int H3_EXPORT(geoRadiusToCells)(const GeoCoord* center, double radiusKm,
+                                int res, H3Index* out, double* distancesKm) {
+    int maxSize = H3_EXPORT(maxGeoRadiusToCellsSize)(radiusKm, res);
+    if (maxSize < 0) return -1;
+    if (maxSize == 0) return 0;
+    H3Index origin = H3_EXPORT(geoToH3)(center, res);
+    if (origin == 0) return 0;
+    int k = circleHexRadius(radiusKm, res);
+
+    double* distances = distancesKm;
+    if (distances == NULL) {
+        distances = H3_MEMORY(malloc)((size_t)maxSize * sizeof(double));
+        assert(distances != NULL);
+    }
+    // Twice the origin's radius leaves room for the hexagons crossing the
+    // circle being somewhat larger than the origin
+    double cutoffKm = radiusKm + 2.0 * _hexRadiusKm(origin);
+
+    int count = 0;
+    HexRingIterator iter;
+    H3_EXPORT(hexRingIterInit)(&iter, origin);
+    for (int ring = 0; ring <= k; ring++) {
+        // Each ring fits after the kept indexes of the rings inside it
+        if (H3_EXPORT(hexRingIterNext)(&iter, out + count)) break;
+        int n = ring == 0 ? 1 : 6 * ring;
+        if (_keepWithinRadius(center, radiusKm, out, distances, count, n,
+                              &count) > cutoffKm) {
+            break;
+        }
+    }
+
+    if (iter.status != HEX_RANGE_SUCCESS) {
+        int* ringOffsets = H3_MEMORY(malloc)((k + 2) * sizeof(int));
+        assert(ringOffsets != NULL);
+        H3_EXPORT(kRingOrdered)(origin, k, out, ringOffsets);
+        count = 0;
+        for (int ring = 0; ring <= k; ring++) {
+            int n = ringOffsets[ring + 1] - ringOffsets[ring];
+            if (_keepWithinRadius(center, radiusKm, out, distances,
+                                  ringOffsets[ring], n, &count) > cutoffKm) {
+                break;
+            }
+        }
+        H3_MEMORY(free)(ringOffsets);
+    }
+
+    // Rings are only roughly ordered by distance, so sort them exactly
+    if (count > 1) {
+        RadiusCell* cells = H3_MEMORY(malloc)(count * sizeof(RadiusCell));
+        assert(cells != NULL);
+        for (int i = 0; i < count; i++) {
+            cells[i].distanceKm = distances[i];
+            cells[i].h = out[i];
+        }
+        qsort(cells, count, sizeof(RadiusCell), _compareRadiusCells);
+        for (int i = 0; i < count; i++) {
+            out[i] = cells[i].h;
+            distances[i] = cells[i].distanceKm;
+        }
+        H3_MEMORY(free)(cells);
+    }
+
+    if (distances != distancesKm) {
+        H3_MEMORY(free)(distances);
+    }
+    return count;
+}
+
+/**
+ * State of a walk over the indexes nearest a point, a best first search
+ * from the index containing it.
+ */
+struct NearestCellsIterator {
+    GeoCoord point;       ///< the point being searched around
+    H3IndexSet* seen;     ///< every index queued so far
+    RadiusCell* queue;    ///< binary heap of the queued indexes, nearest first
+    int queueSize;        ///< number of queued indexes
+    int queueCapacity;    ///< number of indexes queue has room for
+};
+
+/**
+ * Queues an index, unless it has been queued before.
+ *
+ * @param iter The iterator
+ * @param h The index, which is skipped if 0
+ */
+static void _nearestCellsPush(NearestCellsIterator* iter, H3Index h) {
+    if (!H3_EXPORT(h3IndexSetAdd)(iter->seen, h)) return;
+    if (iter->queueSize == iter->queueCapacity) {
+        iter->queueCapacity *= 2;
+        iter->queue = H3_MEMORY(realloc)(
+            iter->queue, iter->queueCapacity * sizeof(RadiusCell));
+        assert(iter->queue != NULL);
+    }
+    GeoCoord center;
+    H3_EXPORT(h3ToGeo)(h, &center);
+    RadiusCell cell = {_geoDistKm(&iter->point, &center), h};
+
+    int i = iter->queueSize++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (_compareRadiusCells(&iter->queue[parent], &cell) <= 0) break;
+        iter->queue[i] = iter->queue[parent];
+        i = parent;
+    }
+    iter->queue[i] = cell;
+}
+
+/**
+ * Removes the nearest queued index.
+ *
+ * @param iter The iterator, with at least one queued index
+ * @return The nearest queued index and its distance
+ */
+static RadiusCell _nearestCellsPop(NearestCellsIterator* iter) {
+    RadiusCell nearest = iter->queue[0];
+    RadiusCell last = iter->queue[--iter->queueSize];
+    int i = 0;
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= iter->queueSize) break;
+        if (child + 1 < iter->queueSize &&
+            _compareRadiusCells(&iter->queue[child + 1],
+                                &iter->queue[child]) < 0) {
+            child++;
+        }
+        if (_compareRadiusCells(&last, &iter->queue[child]) <= 0) break;
+        iter->queue[i] = iter->queue[child];
+        i = child;
+    }
+    iter->queue[i] = last;
+    return nearest;
+}
+
+/**
+ * nearestCellsIterInit starts a walk over the indexes at the given
+ * resolution in order of the great circle distance from a point to their
+ * centers, nearest first.
+ *
+ * It is the responsibility of the caller to call nearestCellsIterDestroy on
+ * the iterator.
+ *
+ * @param point The point, in radians
+ * @param res Hexagon resolution (0-15)
+ * @return The iterator, or NULL if the point or resolution is invalid
+ */
+NearestCellsIterator* H3_EXPORT(nearestCellsIterInit)(const GeoCoord* point,
+                                                      int res) {
+    H3Index origin = H3_EXPORT(geoToH3)(point, res);
+    if (origin == 0) {
+        return NULL;
+    }
+    NearestCellsIterator* iter =
+        H3_MEMORY(calloc)(1, sizeof(NearestCellsIterator));
+    assert(iter != NULL);
+    iter->point = *point;
+    iter->seen = H3_EXPORT(createH3IndexSet)(H3_EXPORT(maxKringSize)(2));
+    iter->queueCapacity = 16;
+    iter->queue = H3_MEMORY(malloc)(iter->queueCapacity * sizeof(RadiusCell));
+    assert(iter->queue != NULL);
+
+    // The center of the index containing the point may not be the nearest,
+    // as the index boundaries are not exactly equidistant from the centers
+    // near them, so its neighbors are candidates from the start
+    _nearestCellsPush(iter, origin);
+    for (int i = 0; i < 6; i++) {
+        int rotations = 0;
+        _nearestCellsPush(
+            iter, h3NeighborRotations(origin, DIRECTIONS[i], &rotations));
+    }
+    return iter;
+}
+
+/**
+ * nearestCellsIterNext writes the next indexes of a walk started by
+ * nearestCellsIterInit.
+ *
+ * The walk is a best first search: the nearest queued index is produced
+ * and its neighbors queued. Away from the index containing the point and
+ * its neighbors, which are queued from the start, every index has a
+ * neighbor whose center is nearer the point. So each index has a chain of
+ * ever nearer neighbors back to the start, and is queued before anything
+ * further away is produced. Only the indexes neighboring those already
+ * produced are queued, whatever their distances.
+ *
+ * @param iter The iterator
+ * @param out The buffer to write to
+ * @param distancesKm Buffer for the distance in km from the point to the
+ * center of each index written, or NULL
+ * @param outSize The number of indexes the buffers can hold
+ * @return The number of indexes written, which is only less than outSize
+ *         once every index at the resolution has been produced
+ */
+int H3_EXPORT(nearestCellsIterNext)(NearestCellsIterator* iter, H3Index* out,
+                                    double* distancesKm, int outSize) {
+    int numOut = 0;
+    while (numOut < outSize && iter->queueSize > 0) {
+        RadiusCell nearest = _nearestCellsPop(iter);
+        out[numOut] = nearest.h;
+        if (distancesKm != NULL) distancesKm[numOut] = nearest.distanceKm;
+        numOut++;
+        for (int i = 0; i < 6; i++) {
+            int rotations = 0;
+            _nearestCellsPush(iter, h3NeighborRotations(
+                                        nearest.h, DIRECTIONS[i], &rotations));
+        }
+    }
+    return numOut;
+}
+
+/**
+ * nearestCellsIterDestroy frees an iterator returned by
+ * nearestCellsIterInit.
+ *
+ * @param iter The iterator
+ */
+void H3_EXPORT(nearestCellsIterDestroy)(NearestCellsIterator* iter) {
+    H3_EXPORT(destroyH3IndexSet)(iter->seen);
+    H3_MEMORY(free)(iter->queue);
+    H3_MEMORY(free)(iter);
+}
+
 /**
  * maxPolyfillSize returns the number of hexagons to allocate space for when
  * performing a polyfill on the given GeoJSON-like data structure.
@@ -573,9 +1293,13 @@ int H3_EXPORT(hexRing)(H3Index origin, int k, H3Index* out) {
  *
  * @param geoPolygon A GeoJSON-like data structure indicating the poly to fill
  * @param res Hexagon resolution (0-15)
- * @return number of hexagons to allocate for
+ * @return number of hexagons to allocate for, 0 if res is not a valid
+ * resolution, or -1 if it does not fit in an int, in which case polyfillDense
+ * can count the hexagons instead
  */
 int H3_EXPORT(maxPolyfillSize)(const GeoPolygon* geoPolygon, int res) {
+    if (res < 0 || res > MAX_H3_RES) return 0;
+
     // Get the bounding box for the GeoJSON-like struct
     BBox bbox;
     bboxFromGeofence(&geoPolygon->geofence, &bbox);
@@ -619,6 +1343,7 @@ bool _pointInPolyContainsLoop(const Geofence* geofence, const BBox* bbox,
     double lat = coord->lat;
     double lng = _normalizeLng(coord->lon, isTransmeridian);
 
+    H3_STAT_ADD(pointInPolyEdges, geofence->numVerts);
     for (int i = 0; i < geofence->numVerts; i++) {
         GeoCoord a = geofence->verts[i];
         GeoCoord b;
@@ -701,13 +1426,219 @@ bool _pointInPolyContains(const GeoPolygon* geoPolygon, const BBox* bboxes,
 }
 
 /**
- * polyfill takes a given GeoJSON-like data structure and preallocated,
- * zeroed memory, and fills it with the hexagons that are contained by
- * the GeoJSON-like data structure.
+ * Factor applied to the distance from a cell center to its farthest vertex to
+ * bound the distance from the cell center to the center of any descendant.
+ * In the plane the bound is sqrt(3) / (sqrt(7) - 1) ~= 1.05; the extra margin
+ * covers the distortion of the gnomonic projection.
+ */
+#define DESCENDANT_RADIUS_SCALE 1.5
+
+/**
+ * Computes a bounding box containing the centers of all descendants of a
+ * cell, at any finer resolution.
  *
- * The current implementation is very primitive and slow, but correct,
- * performing a point-in-poly operation on every hexagon in a k-ring defined
- * around the given geofence.
+ * @param h3 The cell
+ * @param bbox Output bounding box
+ */
+void _descendantsBBox(H3Index h3, BBox* bbox) {
+    GeoCoord center;
+    GeoBoundary boundary;
+    H3_EXPORT(h3ToGeoAndBoundary)(h3, &center, &boundary);
+    center.lon = constrainLng(center.lon);
+
+    double radius = 0;
+    for (int i = 0; i < boundary.numVerts; i++) {
+        double dist = _geoDistRads(&center, &boundary.verts[i]);
+        if (dist > radius) radius = dist;
+    }
+    radius *= DESCENDANT_RADIUS_SCALE;
+
+    bbox->north = center.lat + radius;
+    bbox->south = center.lat - radius;
+    if (bbox->north >= M_PI_2 || bbox->south <= -M_PI_2) {
+        // the descendants may surround a pole; use every longitude
+        if (bbox->north > M_PI_2) bbox->north = M_PI_2;
+        if (bbox->south < -M_PI_2) bbox->south = -M_PI_2;
+        bbox->east = M_PI;
+        bbox->west = -M_PI;
+        return;
+    }
+
+    double maxLat = fmax(fabs(bbox->north), fabs(bbox->south));
+    double lonRadius = radius / cos(maxLat);
+    if (lonRadius >= M_PI) {
+        bbox->east = M_PI;
+        bbox->west = -M_PI;
+        return;
+    }
+    bbox->east = constrainLng(center.lon + lonRadius);
+    bbox->west = center.lon - lonRadius;
+    if (bbox->west < -M_PI) bbox->west += M_2PI;
+}
+
+/**
+ * Writes all descendants of a cell at the given resolution.
+ *
+ * @param h3 The cell
+ * @param res The resolution of the descendants
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, incremented for each descendant
+ *               even if it did not fit in the output array
+ */
+static void _appendDescendants(H3Index h3, int res, H3Index* out, int outSize,
+                               int* numOut) {
+    if (H3_GET_RESOLUTION(h3) == res) {
+        if (*numOut < outSize) out[*numOut] = h3;
+        (*numOut)++;
+        H3_STAT_ADD(polyfillKept, 1);
+        return;
+    }
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _appendDescendants(children[i], res, out, outSize, numOut);
+        }
+    }
+}
+
+/**
+ * Computes the center of a cell, constrained for point in polygon tests.
+ *
+ * @param h3 The cell
+ * @param center Output center
+ */
+static void _cellCenter(H3Index h3, GeoCoord* center) {
+    H3_EXPORT(h3ToGeo)(h3, center);
+    center->lat = constrainLat(center->lat);
+    center->lon = constrainLng(center->lon);
+}
+
+/*
+ * Classifications of a cell's descendants at the target resolution.
+ */
+
+/** No descendant center is in the polygon */
+#define POLYFILL_OUTSIDE 0
+/** Every descendant center is in the polygon */
+#define POLYFILL_INSIDE 1
+/** The children of the cell need to be classified individually */
+#define POLYFILL_REFINE 2
+
+/**
+ * Classifies the descendants of a cell relative to the polygon, given the
+ * bounding box of their centers.
+ *
+ * @param prepared The prepared polygon
+ * @param center The center of the cell, from _cellCenter
+ * @param descendants The bounding box of the descendant centers
+ * @return POLYFILL_OUTSIDE, POLYFILL_INSIDE or POLYFILL_REFINE
+ */
+static int _polyfillClassifyDescendants(const PreparedGeoPolygon* prepared,
+                                        const GeoCoord* center,
+                                        const BBox* descendants) {
+    if (!bboxIntersects(descendants, &prepared->bboxes[0])) {
+        // no descendant center can be in the polygon
+        return POLYFILL_OUTSIDE;
+    }
+
+    // The point in polygon test treats edges as straight lines in lat/lon,
+    // so if no edge comes near the descendants they are all on the same
+    // side of the polygon boundary as this cell's center.
+    if (!bboxIsTransmeridian(&prepared->bboxes[0]) &&
+        !_preparedPolygonCrossesBBox(prepared, descendants)) {
+        return _preparedPolygonContains(prepared, center) ? POLYFILL_INSIDE
+                                                          : POLYFILL_OUTSIDE;
+    }
+
+    return POLYFILL_REFINE;
+}
+
+/**
+ * Classifies the descendants of a cell at the target resolution relative to
+ * the polygon.
+ *
+ * Cells whose descendants are all far from the polygon boundary are resolved
+ * with a single point in polygon test, so only cells along the boundary need
+ * to be refined down to the target resolution.
+ *
+ * @param prepared The prepared polygon
+ * @param h3 The cell, at or above the target resolution
+ * @param res The target resolution
+ * @return POLYFILL_OUTSIDE, POLYFILL_INSIDE or POLYFILL_REFINE
+ */
+static int _polyfillClassifyCell(const PreparedGeoPolygon* prepared,
+                                 H3Index h3, int res) {
+    GeoCoord center;
+    H3_STAT_ADD(polyfillCandidates, 1);
+    if (H3_GET_RESOLUTION(h3) == res) {
+        _cellCenter(h3, &center);
+        return _preparedPolygonContains(prepared, &center) ? POLYFILL_INSIDE
+                                                           : POLYFILL_OUTSIDE;
+    }
+
+    // Bounding the children of a cell costs about as much as testing them,
+    // so cells one level above the target resolution are not bounded.
+    if (H3_GET_RESOLUTION(h3) + 1 < res) {
+        BBox descendants;
+        _descendantsBBox(h3, &descendants);
+        if (!bboxIntersects(&descendants, &prepared->bboxes[0])) {
+            return POLYFILL_OUTSIDE;
+        }
+        _cellCenter(h3, &center);
+        return _polyfillClassifyDescendants(prepared, &center, &descendants);
+    }
+
+    return POLYFILL_REFINE;
+}
+
+/**
+ * Hierarchical polyfill step: writes the descendants of a cell at the target
+ * resolution whose centers are contained in the polygon.
+ *
+ * @param prepared The prepared polygon
+ * @param h3 The cell to fill from
+ * @param res The target resolution
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, including any that did not fit in
+ *               the output array
+ */
+void _polyfillFromCell(const PreparedGeoPolygon* prepared, H3Index h3,
+                       int res, H3Index* out, int outSize, int* numOut) {
+    if (res < 0 || res > MAX_H3_RES) return;
+    switch (_polyfillClassifyCell(prepared, h3, res)) {
+        case POLYFILL_OUTSIDE:
+            return;
+        case POLYFILL_INSIDE:
+            _appendDescendants(h3, res, out, outSize, numOut);
+            return;
+    }
+
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _polyfillFromCell(prepared, children[i], res, out, outSize,
+                              numOut);
+        }
+    }
+}
+
+/**
+ * polyfill takes a given GeoJSON-like data structure and preallocated,
+ * zeroed memory, and fills it with the hexagons that are contained by
+ * the GeoJSON-like data structure.
+ *
+ * The hexagons are found by descending from the res 0 base cells, pruning
+ * cells whose descendants are all outside the polygon bounding box, and
+ * accepting whole subtrees that are far from the polygon boundary. Only cells
+ * along the boundary are refined to the target resolution and tested
+ * individually, so the cost scales with the output rather than with the area
+ * of the bounding box.
+ *
+ * The hexagons are written contiguously from the start of out.
  *
  * @param geoPolygon The geofence and holes defining the relevant area
  * @param res The Hexagon resolution (0-15)
@@ -728,41 +1659,967 @@ void H3_EXPORT(polyfill)(const GeoPolygon* geoPolygon, int res, H3Index* out) {
     // polygons is still minimal (only affecting concave shapes on the order of
     // magnitude of the hexagon size or smaller, not impacting larger concave
     // shapes)
-    //
-    // This first part is identical to the maxPolyfillSize above.
 
-    // Get the bounding boxes for the polygon and any holes
-    STACK_ARRAY_CALLOC(BBox, bboxes, geoPolygon->numHoles + 1);
-    bboxesFromGeoPolygon(geoPolygon, bboxes);
-    int minK = bboxHexRadius(&bboxes[0], res);
-    int numHexagons = H3_EXPORT(maxKringSize)(minK);
+    H3_EXPORT(polyfillDense)(geoPolygon, res, out, INT_MAX);
+}
+
+/**
+ * polyfillDense takes a given GeoJSON-like data structure and fills the
+ * provided buffer with the hexagons that are contained by it, with no gaps.
+ *
+ * If the buffer is too small, it is filled completely and the total number of
+ * hexagons is still returned, so the caller can grow the buffer to the
+ * returned size and call again. The buffer does not need to be zeroed.
+ *
+ * @param geoPolygon The geofence and holes defining the relevant area
+ * @param res The Hexagon resolution (0-15)
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @return The number of hexagons in the polyfill, which may exceed outSize,
+ *         or 0 if the resolution is invalid
+ */
+int H3_EXPORT(polyfillDense)(const GeoPolygon* geoPolygon, int res,
+                             H3Index* out, int outSize) {
+    if (res < 0 || res > MAX_H3_RES) {
+        return 0;
+    }
+    // Index the edges of the polygon and any holes, since every candidate
+    // cell is tested against them
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(geoPolygon);
+
+    int numOut = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index h3;
+        setH3Index(&h3, 0, baseCell, 0);
+        _polyfillFromCell(prepared, h3, res, out, outSize, &numOut);
+    }
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    return numOut;
+}
+
+/**
+ * Appends a cell to the output of polyfillCoverage.
+ *
+ * @param h3 The cell
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, incremented even if the cell did
+ *               not fit in the output array
+ */
+static void _appendCell(H3Index h3, H3Index* out, int outSize, int* numOut) {
+    if (*numOut < outSize) out[*numOut] = h3;
+    (*numOut)++;
+}
 
-    // Get the center hex
+/**
+ * Whether any part of a cell is in the polygon, taking the cell and the
+ * polygon as bounded by straight lat/lon edges.
+ *
+ * Either the boundaries of the cell and the polygon intersect, or one is
+ * inside the other, which is found by testing a single vertex of each.
+ *
+ * @param prepared The prepared polygon
+ * @param h3 The cell
+ * @return true if the cell and the polygon overlap
+ */
+static bool _coverageIntersectsCell(const PreparedGeoPolygon* prepared,
+                                    H3Index h3) {
+    H3_STAT_ADD(polyfillCandidates, 1);
+    // Decoded once for the center, and the boundary if it is needed
+    DecodedCell decoded;
+    _h3ToDecodedCell(h3, &decoded);
     GeoCoord center;
-    bboxCenter(&bboxes[0], &center);
-    H3Index centerH3 = H3_EXPORT(geoToH3)(&center, res);
-
-    // From here on it works differently, first we get all potential
-    // hexagons inserted into the available memory
-    H3_EXPORT(kRing)(centerH3, minK, out);
-
-    // Next we iterate through each hexagon, and test its center point to see if
-    // it's contained in the GeoJSON-like struct
-    for (int i = 0; i < numHexagons; i++) {
-        // Skip records that are already zeroed
-        if (out[i] == 0) {
+    _decodedCellToGeo(&decoded, &center);
+    center.lat = constrainLat(center.lat);
+    center.lon = constrainLng(center.lon);
+    if (_preparedPolygonContains(prepared, &center)) {
+        return true;
+    }
+
+    GeoBoundary boundary;
+    _decodedCellToGeoBoundary(&decoded, &boundary);
+    for (int i = 0; i < boundary.numVerts; i++) {
+        boundary.verts[i].lon = constrainLng(boundary.verts[i].lon);
+    }
+    Geofence cell = {boundary.numVerts, boundary.verts};
+    BBox cellBBox;
+    bboxFromGeofence(&cell, &cellBBox);
+    if (!bboxIntersects(&cellBBox, &prepared->bboxes[0])) {
+        return false;
+    }
+    // With no edge near the cell, it is outside along with its center
+    if (!bboxIsTransmeridian(&prepared->bboxes[0]) &&
+        !_preparedPolygonCrossesBBox(prepared, &cellBBox)) {
+        return false;
+    }
+    for (int i = 0; i < cell.numVerts; i++) {
+        if (_preparedPolygonContains(prepared, &cell.verts[i])) {
+            return true;
+        }
+    }
+    const Geofence* outer = &prepared->geoPolygon->geofence;
+    if (outer->numVerts > 0 &&
+        _pointInPolyContainsLoop(&cell, &cellBBox, &outer->verts[0])) {
+        return true;
+    }
+    return _preparedPolygonCrossesGeofence(prepared, &cell, &cellBBox);
+}
+
+/**
+ * Hierarchical coverage step: writes the compacted set of the descendants of
+ * a cell at the target resolution that overlap the polygon.
+ *
+ * A cell whose descendants are all far from the polygon boundary is written
+ * whole or pruned with a single point in polygon test. Otherwise its
+ * children are covered in turn, and if each of them was written whole they
+ * are replaced by the cell.
+ *
+ * @param prepared The prepared polygon
+ * @param h3 The cell to cover from
+ * @param res The target resolution
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, including any that did not fit in
+ *               the output array
+ * @return true if every descendant overlaps the polygon, and the cell
+ *         itself was written
+ */
+static bool _coverageFromCell(const PreparedGeoPolygon* prepared, H3Index h3,
+                              int res, H3Index* out, int outSize,
+                              int* numOut) {
+    if (H3_GET_RESOLUTION(h3) == res) {
+        if (!_coverageIntersectsCell(prepared, h3)) {
+            return false;
+        }
+        _appendCell(h3, out, outSize, numOut);
+        return true;
+    }
+
+    // The bounding box of the descendant centers also holds the descendants
+    // themselves, whose vertices are within 1.06 times the distance from the
+    // center of the cell to its farthest vertex.
+    H3_STAT_ADD(polyfillCandidates, 1);
+    BBox descendants;
+    _descendantsBBox(h3, &descendants);
+    if (!bboxIntersects(&descendants, &prepared->bboxes[0])) {
+        return false;
+    }
+    if (!bboxIsTransmeridian(&prepared->bboxes[0]) &&
+        !_preparedPolygonCrossesBBox(prepared, &descendants)) {
+        GeoCoord center;
+        _cellCenter(h3, &center);
+        if (!_preparedPolygonContains(prepared, &center)) {
+            return false;
+        }
+        _appendCell(h3, out, outSize, numOut);
+        return true;
+    }
+
+    int start = *numOut;
+    bool full = true;
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0 &&
+            !_coverageFromCell(prepared, children[i], res, out, outSize,
+                               numOut)) {
+            full = false;
+        }
+    }
+    if (full) {
+        *numOut = start;
+        _appendCell(h3, out, outSize, numOut);
+    }
+    return full;
+}
+
+/**
+ * polyfillCoverage fills the provided buffer with the compacted set of
+ * hexagons at the given resolution that overlap the polygon at all, rather
+ * than only those whose centers are in it.
+ *
+ * The hexagons are found as polyfill finds them, descending from the res 0
+ * base cells. Cells far from the polygon boundary are written whole or
+ * pruned, and only cells along the boundary are refined to the target
+ * resolution, where each is tested for overlap with the polygon. Output is
+ * compacted as it is written, so uncompacting it to res gives every
+ * overlapping hexagon, and the cost scales with the polygon perimeter.
+ *
+ * If the buffer is too small, it is filled completely and the total number of
+ * hexagons is still returned, so the caller can grow the buffer to the
+ * returned size and call again. The buffer does not need to be zeroed.
+ *
+ * @param geoPolygon The geofence and holes defining the relevant area
+ * @param res The Hexagon resolution (0-15)
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @return The number of hexagons in the compacted coverage, which may exceed
+ *         outSize, or 0 if the resolution is invalid
+ */
+int H3_EXPORT(polyfillCoverage)(const GeoPolygon* geoPolygon, int res,
+                                H3Index* out, int outSize) {
+    if (res < 0 || res > MAX_H3_RES) {
+        return 0;
+    }
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(geoPolygon);
+
+    int numOut = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index h3;
+        setH3Index(&h3, 0, baseCell, 0);
+        _coverageFromCell(prepared, h3, res, out, outSize, &numOut);
+    }
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    return numOut;
+}
+
+/**
+ * State of a depth first walk of the descendants of a cell that are in the
+ * polygon. The pending work is at most the children of one cell at each
+ * resolution.
+ */
+typedef struct {
+    const PreparedGeoPolygon* prepared;  ///< the polygon being filled
+    int res;                             ///< the target resolution
+    int depth;  ///< the number of levels on the stack
+    /** cells to visit at each level of the stack, the first being the root */
+    H3Index children[MAX_H3_RES + 1][7];
+    /** index of the next child to visit at each level of the stack */
+    int nextChild[MAX_H3_RES + 1];
+    /** whether all descendants at each level of the stack are contained */
+    bool inside[MAX_H3_RES + 1];
+} PolyfillTraversal;
+
+/**
+ * Starts a traversal of the descendants of a cell.
+ *
+ * @param traversal The traversal, with its polygon and resolution set
+ * @param h3 The root cell, at or above the target resolution
+ * @param inside Whether all descendants of the root are known to be in the
+ *               polygon
+ */
+static void _polyfillTraversalStart(PolyfillTraversal* traversal, H3Index h3,
+                                    bool inside) {
+    memset(traversal->children[0], 0, sizeof(traversal->children[0]));
+    traversal->children[0][0] = h3;
+    traversal->nextChild[0] = 0;
+    traversal->inside[0] = inside;
+    traversal->depth = 1;
+}
+
+/**
+ * Writes the next cells of a traversal, in the same order as
+ * _polyfillFromCell.
+ *
+ * @param traversal The traversal
+ * @param out The buffer to write to
+ * @param outSize The number of cells the buffer can hold
+ * @return The number of cells written, which is only less than outSize once
+ *         the traversal is exhausted
+ */
+static int _polyfillTraversalNext(PolyfillTraversal* traversal, H3Index* out,
+                                  int outSize) {
+    int numOut = 0;
+    while (numOut < outSize && traversal->depth > 0) {
+        int level = traversal->depth - 1;
+        if (traversal->nextChild[level] == 7) {
+            traversal->depth--;
             continue;
         }
-        // Check if hexagon is inside of polygon
-        GeoCoord hexCenter;
-        H3_EXPORT(h3ToGeo)(out[i], &hexCenter);
-        hexCenter.lat = constrainLat(hexCenter.lat);
-        hexCenter.lon = constrainLng(hexCenter.lon);
-        // And remove from list if not
-        if (!_pointInPolyContains(geoPolygon, bboxes, &hexCenter)) {
-            out[i] = 0;
+        H3Index h3 = traversal->children[level][traversal->nextChild[level]];
+        traversal->nextChild[level]++;
+        if (h3 == 0) {
+            // deleted pentagon subsequence, or unused root slot
+            continue;
+        }
+
+        bool inside = traversal->inside[level];
+        if (!inside) {
+            int classification =
+                _polyfillClassifyCell(traversal->prepared, h3, traversal->res);
+            if (classification == POLYFILL_OUTSIDE) {
+                continue;
+            }
+            inside = classification == POLYFILL_INSIDE;
+        }
+
+        if (H3_GET_RESOLUTION(h3) == traversal->res) {
+            out[numOut] = h3;
+            numOut++;
+            H3_STAT_ADD(polyfillKept, 1);
+            continue;
         }
+
+        level = traversal->depth;
+        memset(traversal->children[level], 0,
+               sizeof(traversal->children[level]));
+        H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1,
+                                traversal->children[level]);
+        traversal->nextChild[level] = 0;
+        traversal->inside[level] = inside;
+        traversal->depth++;
     }
+    return numOut;
+}
+
+/**
+ * State of a streaming polyfill, which traverses each base cell in turn.
+ */
+struct PolyfillIterator {
+    PreparedGeoPolygon* prepared;  ///< the polygon being filled
+    int baseCell;                  ///< the next base cell to traverse
+    PolyfillTraversal traversal;   ///< traversal of the current base cell
+};
+
+/**
+ * polyfillIterInit starts a streaming polyfill of the given polygon. The
+ * hexagons are produced by polyfillIterNext in the same order as polyfillDense
+ * writes them, while holding only a bounded amount of state.
+ *
+ * The polygon must remain valid until the iterator is destroyed. It is the
+ * responsibility of the caller to call polyfillIterDestroy on the iterator.
+ *
+ * @param geoPolygon The geofence and holes defining the relevant area
+ * @param res The Hexagon resolution (0-15)
+ * @return The iterator, or NULL if the resolution is invalid
+ */
+PolyfillIterator* H3_EXPORT(polyfillIterInit)(const GeoPolygon* geoPolygon,
+                                              int res) {
+    if (res < 0 || res > MAX_H3_RES) {
+        return NULL;
+    }
+    PolyfillIterator* iter = H3_MEMORY(calloc)(1, sizeof(PolyfillIterator));
+    assert(iter != NULL);
+    iter->prepared = H3_EXPORT(prepareGeoPolygon)(geoPolygon);
+    iter->traversal.prepared = iter->prepared;
+    iter->traversal.res = res;
+    return iter;
+}
+
+/**
+ * polyfillIterNext writes the next hexagons of a streaming polyfill.
+ *
+ * @param iter The iterator
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @return The number of hexagons written, which is only less than outSize
+ *         once the polyfill is exhausted
+ */
+int H3_EXPORT(polyfillIterNext)(PolyfillIterator* iter, H3Index* out,
+                                int outSize) {
+    int numOut = 0;
+    while (numOut < outSize) {
+        numOut += _polyfillTraversalNext(&iter->traversal, out + numOut,
+                                         outSize - numOut);
+        if (numOut < outSize) {
+            if (iter->baseCell >= NUM_BASE_CELLS) {
+                break;
+            }
+            H3Index h3;
+            setH3Index(&h3, 0, iter->baseCell, 0);
+            iter->baseCell++;
+            _polyfillTraversalStart(&iter->traversal, h3, false);
+        }
+    }
+    return numOut;
+}
+
+/**
+ * Free all memory held by a streaming polyfill.
+ *
+ * @param iter The iterator, which may be NULL
+ */
+void H3_EXPORT(polyfillIterDestroy)(PolyfillIterator* iter) {
+    if (iter == NULL) {
+        return;
+    }
+    H3_EXPORT(destroyPreparedGeoPolygon)(iter->prepared);
+    H3_MEMORY(free)(iter);
+}
+
+/**
+ * Minimum number of independent units of work a parallel polyfill is split
+ * into, unless the target resolution is reached first.
+ */
+#define POLYFILL_PARALLEL_UNITS 512
+
+/**
+ * A coarse cell filled independently by a parallel polyfill, and the
+ * hexagons found in it.
+ */
+typedef struct {
+    H3Index h3;    ///< the cell to fill from
+    bool inside;   ///< whether all descendants are known to be contained
+    H3Index* out;  ///< the hexagons found, owned by the unit
+    int numOut;    ///< the number of hexagons found
+} PolyfillUnit;
+
+/**
+ * Shared, read only state of a parallel polyfill.
+ */
+typedef struct {
+    const PreparedGeoPolygon* prepared;  ///< the polygon being filled
+    int res;                             ///< the target resolution
+    PolyfillUnit* units;                 ///< the units of work
+} PolyfillParallelData;
+
+/**
+ * Splits a polyfill into coarse cells that can be filled independently,
+ * refining one resolution at a time until there are enough cells. The cells
+ * are kept in the order polyfillDense visits them.
+ *
+ * @param prepared The prepared polygon
+ * @param res The target resolution
+ * @param numUnits Output number of units
+ * @return The units, which the caller must free
+ */
+static PolyfillUnit* _polyfillParallelUnits(const PreparedGeoPolygon* prepared,
+                                            int res, int* numUnits) {
+    PolyfillUnit* units =
+        H3_MEMORY(calloc)(NUM_BASE_CELLS, sizeof(PolyfillUnit));
+    assert(units != NULL);
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        setH3Index(&units[baseCell].h3, 0, baseCell, 0);
+    }
+    int n = NUM_BASE_CELLS;
+
+    for (int unitRes = 0; unitRes < res && n < POLYFILL_PARALLEL_UNITS;
+         unitRes++) {
+        PolyfillUnit* children = H3_MEMORY(calloc)(n * 7, sizeof(PolyfillUnit));
+        assert(children != NULL);
+        int numChildren = 0;
+        for (int i = 0; i < n; i++) {
+            bool inside = units[i].inside;
+            if (!inside) {
+                int classification =
+                    _polyfillClassifyCell(prepared, units[i].h3, res);
+                if (classification == POLYFILL_OUTSIDE) {
+                    continue;
+                }
+                inside = classification == POLYFILL_INSIDE;
+            }
+            H3Index cells[7] = {0};
+            H3_EXPORT(h3ToChildren)(units[i].h3, unitRes + 1, cells);
+            for (int j = 0; j < 7; j++) {
+                if (cells[j] != 0) {
+                    children[numChildren].h3 = cells[j];
+                    children[numChildren].inside = inside;
+                    numChildren++;
+                }
+            }
+        }
+        H3_MEMORY(free)(units);
+        units = children;
+        n = numChildren;
+    }
+
+    *numUnits = n;
+    return units;
+}
+
+/**
+ * Parallel task filling a range of units, each into its own buffer.
+ *
+ * @param data The PolyfillParallelData
+ * @param begin The first unit to fill
+ * @param end One past the last unit to fill
+ */
+static void _polyfillParallelTask(void* data, int begin, int end) {
+    PolyfillParallelData* parallelData = data;
+    PolyfillTraversal traversal;
+    traversal.prepared = parallelData->prepared;
+    traversal.res = parallelData->res;
+    for (int i = begin; i < end; i++) {
+        PolyfillUnit* unit = &parallelData->units[i];
+        _polyfillTraversalStart(&traversal, unit->h3, unit->inside);
+        int capacity = 0;
+        while (true) {
+            if (unit->numOut == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                unit->out =
+                    H3_MEMORY(realloc)(unit->out, capacity * sizeof(H3Index));
+                assert(unit->out != NULL);
+            }
+            int wanted = capacity - unit->numOut;
+            int found = _polyfillTraversalNext(
+                &traversal, unit->out + unit->numOut, wanted);
+            unit->numOut += found;
+            if (found < wanted) {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * polyfillParallel computes the same hexagons as polyfillDense, in the same
+ * order, by splitting the polygon into coarse cells that are filled
+ * independently and then concatenated.
+ *
+ * The coarse cells are filled by calling parallelFor, which must call the
+ * given task on disjoint ranges covering [0, n) and return once all of them
+ * have completed. The ranges may run concurrently on any threads. If
+ * parallelFor is NULL, the cells are filled on the calling thread.
+ *
+ * @param geoPolygon The geofence and holes defining the relevant area
+ * @param res The Hexagon resolution (0-15)
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ * @return The number of hexagons in the polyfill, which may exceed outSize,
+ *         or 0 if the resolution is invalid
+ */
+int H3_EXPORT(polyfillParallel)(const GeoPolygon* geoPolygon, int res,
+                                H3Index* out, int outSize,
+                                H3ParallelFor parallelFor, void* executor) {
+    if (res < 0 || res > MAX_H3_RES) {
+        return 0;
+    }
+    PreparedGeoPolygon* prepared = H3_EXPORT(prepareGeoPolygon)(geoPolygon);
+    int numUnits;
+    PolyfillParallelData data = {
+        prepared, res, _polyfillParallelUnits(prepared, res, &numUnits)};
+
+    if (parallelFor == NULL) {
+        _polyfillParallelTask(&data, 0, numUnits);
+    } else {
+        parallelFor(executor, numUnits, _polyfillParallelTask, &data);
+    }
+
+    int numOut = 0;
+    for (int i = 0; i < numUnits; i++) {
+        PolyfillUnit* unit = &data.units[i];
+        if (numOut < outSize) {
+            int numCopied = unit->numOut < outSize - numOut
+                                ? unit->numOut
+                                : outSize - numOut;
+            memcpy(out + numOut, unit->out, numCopied * sizeof(H3Index));
+        }
+        numOut += unit->numOut;
+        H3_MEMORY(free)(unit->out);
+    }
+
+    H3_MEMORY(free)(data.units);
+    H3_EXPORT(destroyPreparedGeoPolygon)(prepared);
+    return numOut;
+}
+
+/**
+ * Writes all descendants of a cell at the given resolution, assigned to a
+ * polygon.
+ *
+ * @param h3 The cell
+ * @param res The resolution of the descendants
+ * @param polygon The index of the polygon containing the descendants
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, incremented for each descendant
+ *               even if it did not fit in the output array
+ */
+static void _appendPolyfillCells(H3Index h3, int res, int polygon,
+                                 PolyfillCell* out, int outSize,
+                                 int* numOut) {
+    if (H3_GET_RESOLUTION(h3) == res) {
+        if (*numOut < outSize) {
+            out[*numOut].h3 = h3;
+            out[*numOut].polygon = polygon;
+        }
+        (*numOut)++;
+        H3_STAT_ADD(polyfillKept, 1);
+        return;
+    }
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _appendPolyfillCells(children[i], res, polygon, out, outSize,
+                                 numOut);
+        }
+    }
+}
+
+/**
+ * Hierarchical polyfill step for many polygons: writes the descendants of a
+ * cell at the target resolution whose centers are contained in any of the
+ * candidate polygons, assigned to the first one containing them.
+ *
+ * The candidates are narrowed at each level to the polygons whose bounding
+ * boxes meet the descendants of the cell, so the cell hierarchy acts as the
+ * spatial index over the polygons.
+ *
+ * @param prepared The prepared polygons
+ * @param h3 The cell to fill from
+ * @param res The target resolution
+ * @param candidates Indexes of the polygons that may contain descendants, in
+ *                   increasing order
+ * @param numCandidates The number of candidates
+ * @param scratch Space for the candidates of each finer level, of at least
+ *                numCandidates entries per level
+ * @param out The output array
+ * @param outSize The capacity of the output array
+ * @param numOut The number of cells found, including any that did not fit in
+ *               the output array
+ */
+static void _polyfillManyFromCell(PreparedGeoPolygon* const* prepared,
+                                  H3Index h3, int res, const int* candidates,
+                                  int numCandidates, int* scratch,
+                                  PolyfillCell* out, int outSize,
+                                  int* numOut) {
+    GeoCoord center;
+    H3_STAT_ADD(polyfillCandidates, 1);
+    _cellCenter(h3, &center);
+    if (H3_GET_RESOLUTION(h3) == res) {
+        for (int i = 0; i < numCandidates; i++) {
+            if (_preparedPolygonContains(prepared[candidates[i]], &center)) {
+                if (*numOut < outSize) {
+                    out[*numOut].h3 = h3;
+                    out[*numOut].polygon = candidates[i];
+                }
+                (*numOut)++;
+                H3_STAT_ADD(polyfillKept, 1);
+                return;
+            }
+        }
+        return;
+    }
+
+    int* next = scratch;
+    int numNext = 0;
+    if (H3_GET_RESOLUTION(h3) + 1 < res) {
+        BBox descendants;
+        _descendantsBBox(h3, &descendants);
+        for (int i = 0; i < numCandidates; i++) {
+            int classification = _polyfillClassifyDescendants(
+                prepared[candidates[i]], &center, &descendants);
+            if (classification == POLYFILL_OUTSIDE) {
+                continue;
+            }
+            next[numNext] = candidates[i];
+            numNext++;
+            if (classification == POLYFILL_INSIDE) {
+                // later polygons can only get what this one does not
+                if (numNext == 1) {
+                    _appendPolyfillCells(h3, res, candidates[i], out, outSize,
+                                         numOut);
+                    return;
+                }
+                break;
+            }
+        }
+    } else {
+        for (int i = 0; i < numCandidates; i++) {
+            next[i] = candidates[i];
+        }
+        numNext = numCandidates;
+    }
+    if (numNext == 0) {
+        return;
+    }
+
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _polyfillManyFromCell(prepared, children[i], res, next, numNext,
+                                  scratch + numNext, out, outSize, numOut);
+        }
+    }
+}
+
+/**
+ * polyfillMany fills many polygons at once, assigning each hexagon to the
+ * polygon containing its center. If the polygons overlap, the hexagon is
+ * assigned to the first polygon containing it, so each hexagon is written at
+ * most once.
+ *
+ * Each hexagon center is computed once and only tested against the polygons
+ * whose bounding boxes are near it, so filling adjacent polygons together
+ * costs about as much as filling their union.
+ *
+ * @param polygons The polygons to fill
+ * @param numPolygons The number of polygons
+ * @param res The Hexagon resolution (0-15)
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @return The number of hexagons in the polygons, which may exceed outSize,
+ *         or 0 if the resolution is invalid
+ */
+int H3_EXPORT(polyfillMany)(const GeoPolygon* polygons, int numPolygons,
+                            int res, PolyfillCell* out, int outSize) {
+    if (numPolygons < 1 || res < 0 || res > MAX_H3_RES) {
+        return 0;
+    }
+    PreparedGeoPolygon** prepared =
+        H3_MEMORY(malloc)(numPolygons * sizeof(PreparedGeoPolygon*));
+    assert(prepared != NULL);
+    for (int i = 0; i < numPolygons; i++) {
+        prepared[i] = H3_EXPORT(prepareGeoPolygon)(&polygons[i]);
+    }
+    // One level of candidates for the base cells and each finer resolution
+    int* candidates =
+        H3_MEMORY(malloc)((MAX_H3_RES + 2) * numPolygons * sizeof(int));
+    assert(candidates != NULL);
+    for (int i = 0; i < numPolygons; i++) {
+        candidates[i] = i;
+    }
+
+    int numOut = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index h3;
+        setH3Index(&h3, 0, baseCell, 0);
+        _polyfillManyFromCell(prepared, h3, res, candidates, numPolygons,
+                              candidates + numPolygons, out, outSize,
+                              &numOut);
+    }
+
+    H3_MEMORY(free)(candidates);
+    for (int i = 0; i < numPolygons; i++) {
+        H3_EXPORT(destroyPreparedGeoPolygon)(prepared[i]);
+    }
+    H3_MEMORY(free)(prepared);
+    return numOut;
+}
+
+/** margin of the regions re-tested by polyfillDelta, in radians */
+#define POLYFILL_DELTA_MARGIN 1e-9
+
+/**
+ * Bounds the vertices of a cyclic span of a loop.
+ *
+ * @param loop The loop
+ * @param first The index of the first vertex, which may be -1
+ * @param numVerts The number of vertices in the span
+ * @param bbox Bounds, extended by the vertices
+ */
+static void _bboxAddLoopSpan(const Geofence* loop, int first, int numVerts,
+                             BBox* bbox) {
+    if (numVerts > loop->numVerts) numVerts = loop->numVerts;
+    for (int i = 0; i < numVerts; i++) {
+        const GeoCoord* vert =
+            &loop->verts[(first + i + loop->numVerts) % loop->numVerts];
+        if (vert->lat > bbox->north) bbox->north = vert->lat;
+        if (vert->lat < bbox->south) bbox->south = vert->lat;
+        if (vert->lon > bbox->east) bbox->east = vert->lon;
+        if (vert->lon < bbox->west) bbox->west = vert->lon;
+    }
+}
+
+/**
+ * Bounds the points whose containment by a loop may differ from that by
+ * another version of the loop.
+ *
+ * The versions share their vertices before and after the span that
+ * differs, so their chains of edges across the span, from the last shared
+ * vertex before it to the first after it, form a closed curve. A point
+ * outside the curve crosses both chains the same number of times, and so
+ * only points within the bounds of the two chains can change containment.
+ * Loops crossing the antimeridian, and loops sharing no vertices at either
+ * end, are bounded whole, since either version only contains points in its
+ * own bounds.
+ *
+ * @param oldLoop The loop before the edit, which may have no vertices
+ * @param newLoop The loop after the edit, which may have no vertices
+ * @param regions Output bounds, of which there are at most 2
+ * @return The number of bounds written
+ */
+static int _polyfillDeltaRegions(const Geofence* oldLoop,
+                                 const Geofence* newLoop, BBox* regions) {
+    int numOld = oldLoop->numVerts;
+    int numNew = newLoop->numVerts;
+    int numShared = numOld < numNew ? numOld : numNew;
+    int prefix = 0;
+    while (prefix < numShared &&
+           oldLoop->verts[prefix].lat == newLoop->verts[prefix].lat &&
+           oldLoop->verts[prefix].lon == newLoop->verts[prefix].lon) {
+        prefix++;
+    }
+    if (prefix == numOld && numOld == numNew) {
+        return 0;
+    }
+    int suffix = 0;
+    while (suffix < numShared - prefix &&
+           oldLoop->verts[numOld - 1 - suffix].lat ==
+               newLoop->verts[numNew - 1 - suffix].lat &&
+           oldLoop->verts[numOld - 1 - suffix].lon ==
+               newLoop->verts[numNew - 1 - suffix].lon) {
+        suffix++;
+    }
+
+    int numRegions = 0;
+    BBox oldBBox;
+    BBox newBBox;
+    bboxFromGeofence(oldLoop, &oldBBox);
+    bboxFromGeofence(newLoop, &newBBox);
+    if (bboxIsTransmeridian(&oldBBox) || bboxIsTransmeridian(&newBBox) ||
+        (prefix == 0 && suffix == 0)) {
+        if (numOld > 0) regions[numRegions++] = oldBBox;
+        if (numNew > 0) regions[numRegions++] = newBBox;
+    } else {
+        BBox* region = &regions[numRegions++];
+        region->north = -DBL_MAX;
+        region->south = DBL_MAX;
+        region->east = -DBL_MAX;
+        region->west = DBL_MAX;
+        // The spans of changed vertices, with the shared vertex at each end
+        _bboxAddLoopSpan(oldLoop, prefix - 1, numOld - prefix - suffix + 2,
+                         region);
+        _bboxAddLoopSpan(newLoop, prefix - 1, numNew - prefix - suffix + 2,
+                         region);
+    }
+    // Points on the boundary are moved slightly by the tie breaking of the
+    // point in polygon test
+    for (int i = 0; i < numRegions; i++) {
+        regions[i].north += POLYFILL_DELTA_MARGIN;
+        regions[i].south -= POLYFILL_DELTA_MARGIN;
+        regions[i].east += POLYFILL_DELTA_MARGIN;
+        regions[i].west -= POLYFILL_DELTA_MARGIN;
+    }
+    return numRegions;
+}
+
+/** @brief The state of a polyfillDelta */
+typedef struct {
+    PreparedGeoPolygon* oldPrepared;  ///< the polygon before the edit
+    PreparedGeoPolygon* newPrepared;  ///< the polygon after the edit
+    const BBox* regions;              ///< bounds of the centers that may change
+    int numRegions;                   ///< the number of regions
+    int res;                          ///< the target resolution
+    H3Index* added;                   ///< output hexagons added
+    int addedSize;                    ///< the capacity of added
+    int numAdded;                     ///< the number of hexagons added
+    H3Index* removed;                 ///< output hexagons removed
+    int removedSize;                  ///< the capacity of removed
+    int numRemoved;                   ///< the number of hexagons removed
+} PolyfillDelta;
+
+/**
+ * Hierarchical step of polyfillDelta: tests the descendants of a cell at
+ * the target resolution whose centers are in a region that may change.
+ *
+ * @param delta The state of the delta
+ * @param h3 The cell to fill from
+ */
+static void _polyfillDeltaFromCell(PolyfillDelta* delta, H3Index h3) {
+    H3_STAT_ADD(polyfillCandidates, 1);
+    if (H3_GET_RESOLUTION(h3) == delta->res) {
+        GeoCoord center;
+        _cellCenter(h3, &center);
+        bool inRegion = false;
+        for (int i = 0; i < delta->numRegions && !inRegion; i++) {
+            inRegion = bboxContains(&delta->regions[i], &center);
+        }
+        if (!inRegion) return;
+        bool wasIn = _preparedPolygonContains(delta->oldPrepared, &center);
+        bool isIn = _preparedPolygonContains(delta->newPrepared, &center);
+        if (isIn && !wasIn) {
+            _appendCell(h3, delta->added, delta->addedSize, &delta->numAdded);
+        } else if (wasIn && !isIn) {
+            _appendCell(h3, delta->removed, delta->removedSize,
+                        &delta->numRemoved);
+        }
+        return;
+    }
+
+    // As in polyfill, cells one level above the target are not bounded
+    if (H3_GET_RESOLUTION(h3) + 1 < delta->res) {
+        BBox descendants;
+        _descendantsBBox(h3, &descendants);
+        bool intersects = false;
+        for (int i = 0; i < delta->numRegions && !intersects; i++) {
+            intersects = bboxIntersects(&descendants, &delta->regions[i]);
+        }
+        if (!intersects) return;
+    }
+
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, H3_GET_RESOLUTION(h3) + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _polyfillDeltaFromCell(delta, children[i]);
+        }
+    }
+}
+
+/**
+ * polyfillDelta finds the hexagons added to and removed from the polyfill
+ * of a polygon by an edit, as the differences between polyfillDense of the
+ * polygon before and after the edit.
+ *
+ * Each loop of the polygon is compared with the same loop after the edit,
+ * and only the centers of hexagons within the bounds of the edges that
+ * differ are tested, so for an edit of a few vertices of a large polygon
+ * the cost is that of indexing the edges of the two versions and of the
+ * hexagons near the edit, not of the area of the polygon.
+ *
+ * If a buffer is too small, it is filled completely and the total number of
+ * hexagons is still counted, as polyfillDense does.
+ *
+ * @param oldPolygon The polygon before the edit
+ * @param newPolygon The polygon after the edit
+ * @param res The Hexagon resolution (0-15)
+ * @param added Output hexagons in the new polyfill but not the old one
+ * @param addedSize The number of hexagons added can hold
+ * @param numAdded Output number of hexagons added, which may exceed
+ * addedSize
+ * @param removed Output hexagons in the old polyfill but not the new one
+ * @param removedSize The number of hexagons removed can hold
+ * @param numRemoved Output number of hexagons removed, which may exceed
+ * removedSize
+ * @return 0 on success, or -1 if the resolution is out of range
+ */
+int H3_EXPORT(polyfillDelta)(const GeoPolygon* oldPolygon,
+                             const GeoPolygon* newPolygon, int res,
+                             H3Index* added, int addedSize, int* numAdded,
+                             H3Index* removed, int removedSize,
+                             int* numRemoved) {
+    *numAdded = 0;
+    *numRemoved = 0;
+    if (res < 0 || res > MAX_H3_RES) return -1;
+
+    // Holes are compared in order, with missing holes as empty loops
+    int numLoops = 1 + (oldPolygon->numHoles > newPolygon->numHoles
+                            ? oldPolygon->numHoles
+                            : newPolygon->numHoles);
+    BBox* regions = H3_MEMORY(malloc)(2 * numLoops * sizeof(BBox));
+    assert(regions != NULL);
+    int numRegions = _polyfillDeltaRegions(
+        &oldPolygon->geofence, &newPolygon->geofence, regions);
+    Geofence empty = {0, NULL};
+    for (int i = 0; i < numLoops - 1; i++) {
+        const Geofence* oldHole =
+            i < oldPolygon->numHoles ? &oldPolygon->holes[i] : &empty;
+        const Geofence* newHole =
+            i < newPolygon->numHoles ? &newPolygon->holes[i] : &empty;
+        numRegions +=
+            _polyfillDeltaRegions(oldHole, newHole, regions + numRegions);
+    }
+
+    if (numRegions > 0) {
+        PolyfillDelta delta = {
+            H3_EXPORT(prepareGeoPolygon)(oldPolygon),
+            H3_EXPORT(prepareGeoPolygon)(newPolygon),
+            regions,
+            numRegions,
+            res,
+            added,
+            addedSize,
+            0,
+            removed,
+            removedSize,
+            0};
+        for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+            H3Index h3;
+            setH3Index(&h3, 0, baseCell, 0);
+            _polyfillDeltaFromCell(&delta, h3);
+        }
+        H3_EXPORT(destroyPreparedGeoPolygon)(delta.newPrepared);
+        H3_EXPORT(destroyPreparedGeoPolygon)(delta.oldPrepared);
+        *numAdded = delta.numAdded;
+        *numRemoved = delta.numRemoved;
+    }
+    H3_MEMORY(free)(regions);
+    return 0;
 }
 
 /**
@@ -787,9 +2644,10 @@ void h3SetToVertexGraph(const H3Index* h3Set, const int numHexes,
         return;
     }
     int res = H3_GET_RESOLUTION(h3Set[0]);
-    const int minBuckets = 6;
-    // TODO: Better way to calculate/guess?
-    int numBuckets = numHexes > minBuckets ? numHexes : minBuckets;
+    // Each hexagon contributes at most six edges that can survive into the
+    // graph, so this sizes the buckets (and the graph's initial node slab)
+    // to hold the worst case without growing.
+    int numBuckets = numHexes * 6;
     initVertexGraph(graph, numBuckets, res);
     // Iterate through every hexagon
     for (int i = 0; i < numHexes; i++) {
@@ -845,17 +2703,16 @@ void _vertexGraphToLinkedGeo(VertexGraph* graph, LinkedGeoPolygon* out) {
  * populated linked geo structure, or the memory for that structure will
  * not be freed.
  *
- * It is expected that all hexagons in the set will have the same resolution.
- * If you pass in hexagons at different resolutions, the algorithm should work
- * fine, but we won't be able to merge the outlines of different-resolution
- * hexagons, so you might get overlap. I'd suggest not doing this.
+ * The set may mix resolutions, for example the output of compact. The
+ * outline is then that of the union of the hexagons, traced at the finest
+ * resolution in the set, and coarse hexagons are only refined along it.
+ *
+ * Only hexagons on the outline are converted to lat/lon; the outline itself is
+ * found by neighbor traversal.
  *
- * TODO: At present, if the set of hexagons is not contiguous, this function
- * will return a single polygon with multiple outer loops. The correct GeoJSON
- * output should only have one outer loop per polygon. It appears that most
- * GeoJSON consumers are fine with the first input format, but it's less correct
- * than the second format, and we should update the function to produce
- * multiple polygons in that case.
+ * Each connected outline is returned as its own polygon in the linked list
+ * starting at out, with its outer loop first followed by its holes. The
+ * caller should iterate over out->next to visit every polygon.
  *
  * @param h3Set    Set of hexagons
  * @param numHexes Number of hexagons in set
@@ -863,8 +2720,20 @@ void _vertexGraphToLinkedGeo(VertexGraph* graph, LinkedGeoPolygon* out) {
  */
 void H3_EXPORT(h3SetToLinkedGeo)(const H3Index* h3Set, const int numHexes,
                                  LinkedGeoPolygon* out) {
-    VertexGraph graph;
-    h3SetToVertexGraph(h3Set, numHexes, &graph);
-    _vertexGraphToLinkedGeo(&graph, out);
-    destroyVertexGraph(&graph);
+    h3SetToOutline(h3Set, numHexes, out);
+}
+
+/**
+ * Describe the outline(s) of a set of hexagons in flat arrays, with the same
+ * polygons and loops as h3SetToLinkedGeo. The coordinate and offset arrays
+ * share one allocation, and it is the responsibility of the caller to call
+ * destroyFlatGeo to free it.
+ *
+ * @param h3Set    Set of hexagons
+ * @param numHexes Number of hexagons in set
+ * @param out      Output polygons
+ */
+void H3_EXPORT(h3SetToFlatGeo)(const H3Index* h3Set, const int numHexes,
+                               FlatGeoMultiPolygon* out) {
+    h3SetToFlatOutline(h3Set, numHexes, out);
 }
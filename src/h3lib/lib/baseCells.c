@@ -18,6 +18,7 @@
  */
 
 #include "baseCells.h"
+#include "h3api_inline.h"
 
 /** @struct BaseCellOrient
  *  @brief base cell at a given ijk and required rotations into its system
@@ -818,9 +819,145 @@ const BaseCellData baseCellData[NUM_BASE_CELLS] = {
     {{18, {1, 0, 0}}, 0, {0, 0}}     // base cell 121
 };
 
-/** @brief Return whether or not the indicated base cell is a pentagon. */
+/** @brief Resolution NO_OVERAGE_RES cells that never need an overage
+ * adjustment.
+ *
+ * For each base cell, bit digit1 * 8 + digit2 is set when every descendant
+ * of the cell with those digits lies on the home face of the base cell.
+ * Generated by generateNoOverageTable.
+ */
+const uint64_t baseCellNoOverage[NUM_BASE_CELLS] = {
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 0
+    UINT64_C(0x00002a007f007f02),  // base cell 1
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 2
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 3
+    UINT64_C(0x000000004c000000),  // base cell 4
+    UINT64_C(0x00002a007f007f02),  // base cell 5
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 6
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 7
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 8
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 9
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 10
+    UINT64_C(0x00707f7f00000010),  // base cell 11
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 12
+    UINT64_C(0x00002a007f007f02),  // base cell 13
+    UINT64_C(0x000000004c000000),  // base cell 14
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 15
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 16
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 17
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 18
+    UINT64_C(0x00707f7f00000010),  // base cell 19
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 20
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 21
+    UINT64_C(0x00002a007f007f02),  // base cell 22
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 23
+    UINT64_C(0x000000004c000000),  // base cell 24
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 25
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 26
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 27
+    UINT64_C(0x00002a007f007f02),  // base cell 28
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 29
+    UINT64_C(0x00707f7f00000010),  // base cell 30
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 31
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 32
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 33
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 34
+    UINT64_C(0x00002a007f007f02),  // base cell 35
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 36
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 37
+    UINT64_C(0x000000004c000000),  // base cell 38
+    UINT64_C(0x007f00004c7f0004),  // base cell 39
+    UINT64_C(0x007f00004c7f0004),  // base cell 40
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 41
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 42
+    UINT64_C(0x00707f7f00000010),  // base cell 43
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 44
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 45
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 46
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 47
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 48
+    UINT64_C(0x000000004c000000),  // base cell 49
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 50
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 51
+    UINT64_C(0x00002a007f007f02),  // base cell 52
+    UINT64_C(0x00707f7f00000010),  // base cell 53
+    UINT64_C(0x00002a007f007f02),  // base cell 54
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 55
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 56
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 57
+    UINT64_C(0x000000004c000000),  // base cell 58
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 59
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 60
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 61
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 62
+    UINT64_C(0x000000004c000000),  // base cell 63
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 64
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 65
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 66
+    UINT64_C(0x007f00004c7f0004),  // base cell 67
+    UINT64_C(0x00707f7f00000010),  // base cell 68
+    UINT64_C(0x007f00004c7f0004),  // base cell 69
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 70
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 71
+    UINT64_C(0x000000004c000000),  // base cell 72
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 73
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 74
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 75
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 76
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 77
+    UINT64_C(0x00707f7f00000010),  // base cell 78
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 79
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 80
+    UINT64_C(0x00002a007f007f02),  // base cell 81
+    UINT64_C(0x00002a007f007f02),  // base cell 82
+    UINT64_C(0x000000004c000000),  // base cell 83
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 84
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 85
+    UINT64_C(0x007f00004c7f0004),  // base cell 86
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 87
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 88
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 89
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 90
+    UINT64_C(0x00707f7f00000010),  // base cell 91
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 92
+    UINT64_C(0x007f00004c7f0004),  // base cell 93
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 94
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 95
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 96
+    UINT64_C(0x000000004c000000),  // base cell 97
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 98
+    UINT64_C(0x007f00004c7f0004),  // base cell 99
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 100
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 101
+    UINT64_C(0x00707f7f00000010),  // base cell 102
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 103
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 104
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 105
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 106
+    UINT64_C(0x000000004c000000),  // base cell 107
+    UINT64_C(0x007f00004c7f0004),  // base cell 108
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 109
+    UINT64_C(0x00707f7f00000010),  // base cell 110
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 111
+    UINT64_C(0x007f4d7f71775f7f),  // base cell 112
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 113
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 114
+    UINT64_C(0x002b7f3f71777f7f),  // base cell 115
+    UINT64_C(0x007f00004c7f0004),  // base cell 116
+    UINT64_C(0x000000004c000000),  // base cell 117
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 118
+    UINT64_C(0x007f7f7f7f7f7f7f),  // base cell 119
+    UINT64_C(0x007f00004c7f0004),  // base cell 120
+    UINT64_C(0x002b4d3f7f7f5f7f),  // base cell 121
+};
+
+/** @brief Return whether or not the indicated base cell is a pentagon.
+ *
+ * Reads a bitmap of the pentagon base cells, which agrees with
+ * baseCellData.
+ */
 int _isBaseCellPentagon(int baseCell) {
-    return baseCellData[baseCell].isPentagon;
+    return h3BaseCellIsPentagonInline(baseCell);
 }
 
 /** @brief Find base cell given FaceIJK.
@@ -867,3 +1004,22 @@ bool _baseCellIsCwOffset(int baseCell, int testFace) {
 int _getBaseCellNeighbor(int baseCell, int dir) {
     return baseCellNeighbors[baseCell][dir];
 }
+
+/** @brief Return the direction from the origin base cell to the neighbor.
+ * Returns INVALID_DIGIT if the base cells are not neighbors.
+ */
+int _getBaseCellDirection(int originBaseCell, int neighboringBaseCell) {
+    for (int dir = CENTER_DIGIT; dir < 7; dir++) {
+        int testBaseCell = _getBaseCellNeighbor(originBaseCell, dir);
+        if (testBaseCell == neighboringBaseCell) {
+            return dir;
+        }
+    }
+    return INVALID_DIGIT;
+}
+
+/** @brief Return whether the base cell is one of the two polar pentagons.
+ */
+int _isBaseCellPolarPentagon(int baseCell) {
+    return baseCell == 4 || baseCell == 117;
+}
@@ -19,6 +19,7 @@
 
 #include "bbox.h"
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include "constants.h"
@@ -51,6 +52,8 @@ void bboxFromVertices(const GeoCoord* verts, int numVerts, BBox* bbox) {
     bbox->west = DBL_MAX;
     bbox->north = -1.0 * DBL_MAX;
     bbox->east = -1.0 * DBL_MAX;
+    double minPosLon = DBL_MAX;
+    double maxNegLon = -1.0 * DBL_MAX;
     bool isTransmeridian = false;
 
     for (int i = 0; i < numVerts; i++) {
@@ -60,16 +63,19 @@ void bboxFromVertices(const GeoCoord* verts, int numVerts, BBox* bbox) {
         if (lon < bbox->west) bbox->west = lon;
         if (lat > bbox->north) bbox->north = lat;
         if (lon > bbox->east) bbox->east = lon;
+        // track the innermost longitude on each side of the antimeridian
+        if (lon < 0 && lon > maxNegLon) maxNegLon = lon;
+        if (lon > 0 && lon < minPosLon) minPosLon = lon;
         // check for arcs > 180 degrees longitude, flagging as transmeridian
         if (fabs(lon - verts[(i + 1) % numVerts].lon) > M_PI) {
             isTransmeridian = true;
         }
     }
-    // Swap east and west if transmeridian
+    // If transmeridian, the box runs from the innermost positive longitude
+    // west of the antimeridian to the innermost negative longitude east of it
     if (isTransmeridian) {
-        double tmp = bbox->east;
-        bbox->east = bbox->west;
-        bbox->west = tmp;
+        bbox->east = maxNegLon;
+        bbox->west = minPosLon;
     }
 }
 
@@ -129,6 +135,32 @@ bool bboxContains(const BBox* bbox, const GeoCoord* point) {
                 (point->lon >= bbox->west && point->lon <= bbox->east));
 }
 
+/**
+ * Whether two bounding boxes overlap, including along their borders
+ * @param  a First bounding box
+ * @param  b Second bounding box
+ * @return   Whether the boxes share at least one point
+ */
+bool bboxIntersects(const BBox* a, const BBox* b) {
+    if (a->south > b->north || b->south > a->north) {
+        return false;
+    }
+    // a transmeridian box covers [west, PI] and [-PI, east], so it always
+    // reaches the antimeridian; two such boxes therefore always overlap
+    bool aTransmeridian = bboxIsTransmeridian(a);
+    bool bTransmeridian = bboxIsTransmeridian(b);
+    if (aTransmeridian && bTransmeridian) {
+        return true;
+    }
+    if (aTransmeridian) {
+        return b->east >= a->west || b->west <= a->east;
+    }
+    if (bTransmeridian) {
+        return a->east >= b->west || a->west <= b->east;
+    }
+    return a->west <= b->east && b->west <= a->east;
+}
+
 /**
  * _hexRadiusKm returns the radius of a given hexagon in Km
  *
@@ -145,14 +177,59 @@ double _hexRadiusKm(H3Index h3Index) {
     return _geoDistKm(&h3Center, h3Boundary.verts);
 }
 
+/**
+ * Lower bound on the radius of any cell at each resolution, as measured by
+ * _hexRadiusKm. Generated by generateHexRadiusTable.
+ *
+ * Resolutions 0 to 5 are the minimum over every cell. Each finer resolution,
+ * marked derived, is the value two resolutions coarser divided by 7.1: two
+ * aperture 7 steps shrink the cells by a factor that tends to exactly 7 as
+ * the cells get smaller and the projection less distorted across them, and
+ * the measured factor between resolutions 3 and 5 is already below 7.08, so
+ * the derived values stay below the true minimums. The generator checks
+ * them against the cells around every pentagon, where the smallest cells
+ * are.
+ */
+static const double minHexRadiusKm[MAX_H3_RES + 1] = {
+    1.036860888391e+03,  // res 0
+    3.523804209283e+02,  // res 1
+    1.374644334724e+02,  // res 2
+    4.867538306163e+01,  // res 3
+    1.941877157492e+01,  // res 4
+    6.920111109727e+00,  // res 5
+    2.735038249989e+00,  // res 6 (derived)
+    9.746635365812e-01,  // res 7 (derived)
+    3.852166549280e-01,  // res 8 (derived)
+    1.372765544481e-01,  // res 9 (derived)
+    5.425586689127e-02,  // res 10 (derived)
+    1.933472597860e-02,  // res 11 (derived)
+    7.641671393137e-03,  // res 12 (derived)
+    2.723200842056e-03,  // res 13 (derived)
+    1.076291745512e-03,  // res 14 (derived)
+    3.835494143741e-04,  // res 15 (derived)
+};
+
+/**
+ * Factor applied to the radius of the hexagon at the center of a bounding box
+ * by bboxHexRadius. Hexagons near pentagons can be two thirds the radius of
+ * a hexagon a few rings away, so the center hexagon overstates the radius of
+ * some hexagons in the box. Over thousands of random polygons and boxes at
+ * resolutions 2 to 9, half of them around pentagons, the unscaled radius
+ * still sized maxPolyfillSize at 1.4 times the hexagons filled or more; the
+ * factor adds margin for the shrinking at about 1.2 times the size.
+ */
+#define HEX_RADIUS_SAFETY_FACTOR 0.9
+
 /**
  * Get the radius of the bbox in hexagons - i.e. the radius of a k-ring centered
  * on the bbox center and covering the entire bbox.
  * @param  bbox Bounding box to measure
  * @param  res  Resolution of hexagons to use in measurement
- * @return      Radius in hexagons
+ * @return      Radius in hexagons, or 0 if res is not a valid resolution
  */
 int bboxHexRadius(const BBox* bbox, int res) {
+    if (res < 0 || res > MAX_H3_RES) return 0;
+
     // Determine the center of the bounding box
     GeoCoord center;
     bboxCenter(bbox, &center);
@@ -167,13 +244,41 @@ int bboxHexRadius(const BBox* bbox, int res) {
     // as a circle on the earth that the k-rings must be greater than
     double bboxRadiusKm = _geoDistKm(&center, &vertex);
 
-    // Determine the radius of the center hexagon
-    double centerHexRadiusKm = _hexRadiusKm(H3_EXPORT(geoToH3)(&center, res));
+    // Use the radius of the center hexagon, shrunk by a safety factor since
+    // hexagons elsewhere in the box can be smaller, but never below the
+    // smallest radius of any hexagon at this resolution
+    double hexRadiusKm = minHexRadiusKm[res];
+    H3Index centerIndex = H3_EXPORT(geoToH3)(&center, res);
+    if (centerIndex != H3_INVALID_INDEX) {
+        hexRadiusKm = fmax(
+            hexRadiusKm, HEX_RADIUS_SAFETY_FACTOR * _hexRadiusKm(centerIndex));
+    }
 
     // The closest point along a hexagon drawn through the center points
     // of a k-ring aggregation is exactly 1.5 radii of the hexagon. For
     // any orientation of the GeoJSON encased in a circle defined by the
     // bounding box radius and center, it is guaranteed to fit in this k-ring
     // Rounded *up* to guarantee containment
-    return (int)ceil(bboxRadiusKm / (1.5 * centerHexRadiusKm));
+    return (int)ceil(bboxRadiusKm / (1.5 * hexRadiusKm));
+}
+
+/**
+ * Get the radius in hexagons of a circle - i.e. the k of a k-ring centered on
+ * the hexagon containing the circle center and holding every hexagon whose
+ * center is in the circle.
+ * @param  radiusKm Radius of the circle in km, >= 0
+ * @param  res      Resolution of hexagons to use in measurement
+ * @return          Radius in hexagons, at most INT_MAX, or 0 if res is not a
+ *                  valid resolution
+ */
+int circleHexRadius(double radiusKm, int res) {
+    if (res < 0 || res > MAX_H3_RES) return 0;
+
+    double hexRadiusKm = minHexRadiusKm[res];
+
+    // As in bboxHexRadius, the centers of ring k are at least 1.5 * k radii
+    // from the center of the origin, and the circle center may be up to one
+    // radius away from that
+    double k = ceil((radiusKm + hexRadiusKm) / (1.5 * hexRadiusKm));
+    return k < INT_MAX ? (int)k : INT_MAX;
 }
@@ -28,8 +28,6 @@
 
 /** 1.0/sqrt(7) */
 #define M_1_SQRT7 0.3779644730092272272145165362341800608157L
-/** Value indicating an invalid H3 digit */
-#define INVALID_DIGIT -1
 
 /**
  * Sets an IJK coordinate to the specified component values.
@@ -302,6 +300,200 @@ void _upAp7r(CoordIJK* ijk) {
     _ijkNormalize(ijk);
 }
 
+/** @brief digit of a cell within its counter-clockwise aperture 7 parent,
+ * indexed by (i + 2j) mod 7 of the cell's ij coordinates
+ */
+static const int ap7DigitByResidue[7] = {0, 4, 2, 6, 1, 5, 3};
+
+/** @brief digit of a cell within its clockwise aperture 7 parent, indexed by
+ * (2i + j) mod 7 of the cell's ij coordinates
+ */
+static const int ap7rDigitByResidue[7] = {0, 2, 4, 6, 1, 3, 5};
+
+/**
+ * Non-negative remainder of division by 7.
+ *
+ * @param x The dividend.
+ * @return x mod 7, in the range 0-6.
+ */
+static int _mod7(int x) {
+    int m = x % 7;
+    return m < 0 ? m + 7 : m;
+}
+
+/**
+ * Find the normalized ijk coordinates of the indexing parent of a cell in a
+ * counter-clockwise aperture 7 grid, and the digit of the cell within that
+ * parent. Works in place.
+ *
+ * Produces the same parent as _upAp7, but uses only integer arithmetic: the
+ * children of a parent are the cells of one residue class of (i + 2j) mod 7,
+ * so the digit is found with a table lookup and the parent by an exact
+ * division.
+ *
+ * @param ijk The ijk coordinates.
+ * @return The digit of the cell within its parent.
+ */
+int _upAp7Digit(CoordIJK* ijk) {
+    // convert to CoordIJ
+    int i = ijk->i - ijk->k;
+    int j = ijk->j - ijk->k;
+
+    int digit = ap7DigitByResidue[_mod7(i + 2 * j)];
+
+    // move to the center child, which is the parent's _downAp7
+    i -= UNIT_VECS[digit].i - UNIT_VECS[digit].k;
+    j -= UNIT_VECS[digit].j - UNIT_VECS[digit].k;
+
+    ijk->i = (3 * i - j) / 7;
+    ijk->j = (i + 2 * j) / 7;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+
+    return digit;
+}
+
+/**
+ * Find the normalized ijk coordinates of the indexing parent of a cell in a
+ * clockwise aperture 7 grid, and the digit of the cell within that parent.
+ * Works in place.
+ *
+ * Produces the same parent as _upAp7r, using integer arithmetic only; see
+ * _upAp7Digit.
+ *
+ * @param ijk The ijk coordinates.
+ * @return The digit of the cell within its parent.
+ */
+int _upAp7rDigit(CoordIJK* ijk) {
+    // convert to CoordIJ
+    int i = ijk->i - ijk->k;
+    int j = ijk->j - ijk->k;
+
+    int digit = ap7rDigitByResidue[_mod7(2 * i + j)];
+
+    // move to the center child, which is the parent's _downAp7r
+    i -= UNIT_VECS[digit].i - UNIT_VECS[digit].k;
+    j -= UNIT_VECS[digit].j - UNIT_VECS[digit].k;
+
+    ijk->i = (2 * i + j) / 7;
+    ijk->j = (3 * j - i) / 7;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+
+    return digit;
+}
+
+/** @brief ij coordinates of the unit vectors of the 7 H3 digits */
+static const int UNIT_IJ[7][2] = {{0, 0}, {-1, -1}, {0, 1}, {-1, 0},
+                                  {1, 0}, {0, -1},  {1, 1}};
+
+/**
+ * Body of _upAp7Digits and _upAp7DigitsPath, recording the ij coordinates
+ * of each ancestor if path is not NULL.
+ */
+static inline void _upAp7DigitsInline(CoordIJK* ijk, int res, int* digits,
+                                      CoordIJ* path) {
+    int i = ijk->i - ijk->k;
+    int j = ijk->j - ijk->k;
+    for (int r = res; r > 0; r--) {
+        if (path) {
+            path[r].i = i;
+            path[r].j = j;
+        }
+        int digit;
+        // odd resolutions are Class III, rotated counter-clockwise
+        if (r % 2) {
+            digit = ap7DigitByResidue[_mod7(i + 2 * j)];
+            i -= UNIT_IJ[digit][0];
+            j -= UNIT_IJ[digit][1];
+            int parentI = (3 * i - j) / 7;
+            j = (i + 2 * j) / 7;
+            i = parentI;
+        } else {
+            digit = ap7rDigitByResidue[_mod7(2 * i + j)];
+            i -= UNIT_IJ[digit][0];
+            j -= UNIT_IJ[digit][1];
+            int parentI = (2 * i + j) / 7;
+            j = (3 * j - i) / 7;
+            i = parentI;
+        }
+        digits[r] = digit;
+    }
+    if (path) {
+        path[0].i = i;
+        path[0].j = j;
+    }
+    ijk->i = i;
+    ijk->j = j;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+}
+
+/**
+ * Find the digits of a cell within its resolution 0 ancestor, and the
+ * normalized ijk coordinates of that ancestor. Works in place.
+ *
+ * Gives the same results as calling _upAp7Digit and _upAp7rDigit for each
+ * resolution, but stays in ij coordinates between the steps, so that the
+ * coordinates are only normalized once.
+ *
+ * @param ijk The ijk coordinates of the cell at resolution res.
+ * @param res The resolution of the cell.
+ * @param digits Output array; the digit of resolution r is set at digits[r],
+ *               for 1 <= r <= res.
+ */
+void _upAp7Digits(CoordIJK* ijk, int res, int* digits) {
+    _upAp7DigitsInline(ijk, res, digits, NULL);
+}
+
+/**
+ * _upAp7Digits, also giving the coordinates of every ancestor of the cell.
+ *
+ * @param ijk The ijk coordinates of the cell at resolution res.
+ * @param res The resolution of the cell.
+ * @param digits Output array; the digit of resolution r is set at digits[r],
+ *               for 1 <= r <= res.
+ * @param path Output array; the ancestor at resolution r, for 0 <= r <= res,
+ *             is set at path[r] as ijk coordinates with k of 0.
+ */
+void _upAp7DigitsPath(CoordIJK* ijk, int res, int* digits, CoordIJ* path) {
+    _upAp7DigitsInline(ijk, res, digits, path);
+}
+
+/**
+ * Find the normalized ijk coordinates of a cell from those of its resolution
+ * 0 ancestor and its digits. Works in place.
+ *
+ * Gives the same result as calling _downAp7 or _downAp7r followed by
+ * _neighbor for each resolution, but stays in ij coordinates between the
+ * steps, so that the coordinates are only normalized once.
+ *
+ * @param ijk The ijk coordinates of the resolution 0 ancestor.
+ * @param res The resolution of the cell.
+ * @param digits The digit of resolution r at digits[r], for 1 <= r <= res.
+ */
+void _downAp7Digits(CoordIJK* ijk, int res, const int* digits) {
+    int i = ijk->i - ijk->k;
+    int j = ijk->j - ijk->k;
+    for (int r = 1; r <= res; r++) {
+        int childI;
+        // odd resolutions are Class III, rotated counter-clockwise
+        if (r % 2) {
+            childI = 2 * i + j;
+            j = 3 * j - i;
+        } else {
+            childI = 3 * i - j;
+            j = i + 2 * j;
+        }
+        i = childI + UNIT_IJ[digits[r]][0];
+        j += UNIT_IJ[digits[r]][1];
+    }
+    ijk->i = i;
+    ijk->j = j;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+}
+
 /**
  * Find the normalized ijk coordinates of the hex centered on the indicated
  * hex at the next finer aperture 7 counter-clockwise resolution. Works in
@@ -495,3 +687,67 @@ void _downAp3r(CoordIJK* ijk) {
 
     _ijkNormalize(ijk);
 }
+
+/**
+ * Finds the distance between the two coordinates. Returns result.
+ *
+ * @param a The first set of ijk coordinates.
+ * @param b The second set of ijk coordinates.
+ * @return The number of grid steps between the coordinates.
+ */
+int _ijkDistance(const CoordIJK* a, const CoordIJK* b) {
+    CoordIJK diff;
+    _ijkSub(a, b, &diff);
+    _ijkNormalize(&diff);
+    int distance = diff.i > diff.j ? diff.i : diff.j;
+    return distance > diff.k ? distance : diff.k;
+}
+
+/**
+ * Transforms coordinates from the IJK+ coordinate system to the IJ
+ * coordinate system.
+ *
+ * @param ijk The input IJK+ coordinates
+ * @param ij The output IJ coordinates
+ */
+void _ijkToIj(const CoordIJK* ijk, CoordIJ* ij) {
+    ij->i = ijk->i - ijk->k;
+    ij->j = ijk->j - ijk->k;
+}
+
+/**
+ * Transforms coordinates from the IJ coordinate system to the IJK+
+ * coordinate system.
+ *
+ * @param ij The input IJ coordinates
+ * @param ijk The output IJK+ coordinates
+ */
+void _ijToIjk(const CoordIJ* ij, CoordIJK* ijk) {
+    ijk->i = ij->i;
+    ijk->j = ij->j;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+}
+
+/**
+ * Convert IJK coordinates to cube coordinates, in place, so they can be
+ * interpolated linearly.
+ *
+ * @param ijk Coordinate to convert
+ */
+void _ijkToCube(CoordIJK* ijk) {
+    ijk->i = -ijk->i + ijk->k;
+    ijk->j = ijk->j - ijk->k;
+    ijk->k = -ijk->i - ijk->j;
+}
+
+/**
+ * Convert cube coordinates to IJK coordinates, in place.
+ *
+ * @param ijk Coordinate to convert
+ */
+void _cubeToIjk(CoordIJK* ijk) {
+    ijk->i = -ijk->i;
+    ijk->k = 0;
+    _ijkNormalize(ijk);
+}
@@ -26,14 +26,87 @@
 #include <string.h>
 #include "constants.h"
 #include "coordijk.h"
+#include "fastMath.h"
 #include "geoCoord.h"
 #include "h3Index.h"
+#include "vec3d.h"
 
-/** square root of 7 */
-#define M_SQRT7 2.6457513110645905905016157536392604257102L
+/**
+ * @brief scale from the gnomonic distance to hex2d units at each resolution,
+ * sqrt(7)^res / RES0_U_GNOMONIC rounded once to double
+ */
+static const double gnomonicToHex2dScale[] = {
+    2.61803398874989588842e+0,  // res  0
+    6.92666685814669665919e+0,  // res  1
+    1.83262379212492712189e+1,  // res  2
+    4.84866680070268766143e+1,  // res  3
+    1.28283665448744898533e+2,  // res  4
+    3.39406676049188136300e+2,  // res  5
+    8.97985658141214289728e+2,  // res  6
+    2.37584673234431695410e+3,  // res  7
+    6.28589960698850002810e+3,  // res  8
+    1.66309271264102186787e+4,  // res  9
+    4.40012972489195001967e+4,  // res 10
+    1.16416489884871530751e+5,  // res 11
+    3.08009080742436501377e+5,  // res 12
+    8.14915429194100715257e+5,  // res 13
+    2.15606356519705550964e+6,  // res 14
+    5.70440800435870500680e+6,  // res 15
+    1.50924449563793885675e+7   // res 16
+};
+
+/**
+ * @brief scale from hex2d units at each resolution to the gnomonic distance,
+ * RES0_U_GNOMONIC / sqrt(7)^res rounded once to double
+ */
+static const double hex2dToGnomonicScale[] = {
+    3.81966011250105000030e-1,  // res  0
+    1.44369582149582494705e-1,  // res  1
+    5.45665730357292857186e-2,  // res  2
+    2.06242260213689278150e-2,  // res  3
+    7.79522471938989795980e-3,  // res  4
+    2.94631800305270397357e-3,  // res  5
+    1.11360353134141399426e-3,  // res  6
+    4.20902571864671996225e-4,  // res  7
+    1.59086218763059142037e-4,  // res  8
+    6.01289388378102851749e-5,  // res  9
+    2.27266026804370202910e-5,  // res 10
+    8.58984840540146931071e-6,  // res 11
+    3.24665752577671718442e-6,  // res 12
+    1.22712120077163847296e-6,  // res 13
+    4.63808217968102454917e-7,  // res 14
+    1.75303028681662638994e-7,  // res 15
+    6.62583168525860649882e-8   // res 16
+};
+
+/**
+ * @brief scale from substrate grid units at each resolution to the gnomonic
+ * distance. Substrate grids are aperture 3 finer, and one more aperture 7
+ * finer for Class III resolutions. Class III cell boundaries are found on
+ * the next finer Class II grid, hence the entry for res 16.
+ */
+static const double substrateToGnomonicScale[] = {
+    1.27322003750035000010e-1,  // res  0
+    1.81888576785764285729e-2,  // res  1
+    1.81888576785764285729e-2,  // res  2
+    2.59840823979663265327e-3,  // res  3
+    2.59840823979663265327e-3,  // res  4
+    3.71201177113804664752e-4,  // res  5
+    3.71201177113804664752e-4,  // res  6
+    5.30287395876863806789e-5,  // res  7
+    5.30287395876863806789e-5,  // res  8
+    7.57553422681234009698e-6,  // res  9
+    7.57553422681234009698e-6,  // res 10
+    1.08221917525890572814e-6,  // res 11
+    1.08221917525890572814e-6,  // res 12
+    1.54602739322700818306e-7,  // res 13
+    1.54602739322700818306e-7,  // res 14
+    2.20861056175286883294e-8,  // res 15
+    2.20861056175286883294e-8   // res 16
+};
 
 /** @brief icosahedron face centers in lat/lon radians */
-static const GeoCoord faceCenterGeo[NUM_ICOSA_FACES] = {
+const GeoCoord faceCenterGeo[NUM_ICOSA_FACES] = {
     {0.803582649718989942, 1.248397419617396099},    // face  0
     {1.307747883455638156, 2.536945009877921159},    // face  1
     {1.054751253523952054, -1.347517358900396623},   // face  2
@@ -56,10 +129,34 @@ static const GeoCoord faceCenterGeo[NUM_ICOSA_FACES] = {
     {-1.054751253523952054, 1.794075294689396615},   // face 19
 };
 
+/** @brief icosahedron face centers in x/y/z on the unit sphere */
+const Vec3d faceCenterPoint[NUM_ICOSA_FACES] = {
+    {0.2199307791404606, 0.6583691780274996, 0.7198475378926182},  // face  0
+    {-0.2139234834501421, 0.1478171829550703, 0.9656017935214205},  // face  1
+    {0.1092625278784797, -0.4811951572873209, 0.8697775121287253},  // face  2
+    {0.7428567301586791, -0.3593941678278028, 0.5648005936517033},  // face  3
+    {0.8112534709140969, 0.3448953237639384, 0.4721387736413930},  // face  4
+    {-0.1055498149613921, 0.9794457296411413, 0.1718874610009365},  // face  5
+    {-0.8075407579970092, 0.1533552485898819, 0.5695261994882688},  // face  6
+    {-0.2846148069787907, -0.8644080972654206, 0.4144792552473539},  // face  7
+    {0.7405621473854481, -0.6673299564565524, -0.0789837646326737},  // face  8
+    {0.8512303986474293, 0.4722343788582681, -0.2289137388687808},  // face  9
+    {-0.7405621473854481, 0.6673299564565525, 0.0789837646326737},  // face 10
+    {-0.8512303986474292, -0.4722343788582682, 0.2289137388687808},  // face 11
+    {0.1055498149613920, -0.9794457296411413, -0.1718874610009365},  // face 12
+    {0.8075407579970092, -0.1533552485898819, -0.5695261994882688},  // face 13
+    {0.2846148069787908, 0.8644080972654204, -0.4144792552473539},  // face 14
+    {-0.7428567301586791, 0.3593941678278027, -0.5648005936517033},  // face 15
+    {-0.8112534709140971, -0.3448953237639383, -0.4721387736413930},  // face 16
+    {-0.2199307791404607, -0.6583691780274996, -0.7198475378926182},  // face 17
+    {0.2139234834501420, -0.1478171829550704, -0.9656017935214205},  // face 18
+    {-0.1092625278784796, 0.4811951572873209, -0.8697775121287253},  // face 19
+};
+
 /** @brief icosahedron face ijk axes as azimuth in radians from face center to
  * vertex 0/1/2 respectively
  */
-static const double faceAxesAzRadsCII[NUM_ICOSA_FACES][3] = {
+const double faceAxesAzRadsCII[NUM_ICOSA_FACES][3] = {
     {5.619958268523939882, 3.525563166130744542,
      1.431168063737548730},  // face  0
     {5.760339081714187279, 3.665943979320991689,
@@ -102,6 +199,73 @@ static const double faceAxesAzRadsCII[NUM_ICOSA_FACES][3] = {
      4.455774101589558636},  // face 19
 };
 
+/** @brief unit vectors along the Class II hex2d x and y axes of each face,
+ * tangent to the sphere at the face center; the x axis is at azimuth
+ * faceAxesAzRadsCII[face][0] and the y axis 90 degrees ccw from it
+ */
+const Vec3d faceAxesCII[NUM_ICOSA_FACES][2] = {
+    // face  0
+    {{0.4042148086933695, -0.7330894762816368, 0.5469828225804703},
+     {0.8878292858537911, 0.1706746764710865, -0.4273515110442893}},
+    // face  1
+    {{0.9721374115064794, -0.0647682382197926, 0.2252863255224030},
+     {0.0958415169852749, 0.9868916636293629, -0.1298431664772152}},
+    // face  2
+    {{0.5490814303330593, 0.7586196048290542, 0.3507219383392081},
+     {-0.8285959708235409, 0.4392579148657882, 0.3471040209544594}},
+    // face  3
+    {{-0.2803041479891599, 0.5991800396948611, 0.7499419075177328},
+     {-0.6079419898954393, -0.7154153424148980, 0.3443652490588268}},
+    // face  4
+    {{-0.3698366439978593, -0.3227468737584196, 0.8712378046409416},
+     {0.4528671578799142, -0.8814089125513395, -0.1342745924917817}},
+    // face  5
+    {{-0.4479044493437893, 0.1074998488334869, -0.8875952831999584},
+     {-0.8878292858537912, -0.1706746764710864, 0.4273515110442891}},
+    // face  6
+    {{-0.5819727895662967, -0.0502693941559282, -0.8116530417706933},
+     {-0.0958415169852749, -0.9868916636293629, 0.1298431664772152}},
+    // face  7
+    {{-0.4821028197214983, -0.2446448969623838, -0.8412643731948032},
+     {0.8285959708235409, -0.4392579148657882, -0.3471040209544594}},
+    // face  8
+    {{-0.2863114436794785, -0.2070063212877086, -0.9355074238963060},
+     {0.6079419898954393, 0.7154153424148980, -0.3443652490588266}},
+    // face  9
+    {{-0.2651756884261970, 0.0106311005738309, -0.9641415010092044},
+     {-0.4528671578799142, 0.8814089125513395, 0.1342745924917818}},
+    // face 10
+    {{0.2863114436794785, 0.2070063212877086, 0.9355074238963060},
+     {0.6079419898954393, 0.7154153424148980, -0.3443652490588266}},
+    // face 11
+    {{0.2651756884261970, -0.0106311005738309, 0.9641415010092044},
+     {-0.4528671578799142, 0.8814089125513395, 0.1342745924917818}},
+    // face 12
+    {{0.4479044493437893, -0.1074998488334869, 0.8875952831999584},
+     {-0.8878292858537912, -0.1706746764710864, 0.4273515110442891}},
+    // face 13
+    {{0.5819727895662967, 0.0502693941559282, 0.8116530417706933},
+     {-0.0958415169852749, -0.9868916636293629, 0.1298431664772152}},
+    // face 14
+    {{0.4821028197214983, 0.2446448969623838, 0.8412643731948032},
+     {0.8285959708235409, -0.4392579148657882, -0.3471040209544594}},
+    // face 15
+    {{0.2803041479891599, -0.5991800396948611, -0.7499419075177328},
+     {-0.6079419898954393, -0.7154153424148980, 0.3443652490588268}},
+    // face 16
+    {{0.3698366439978593, 0.3227468737584196, -0.8712378046409416},
+     {0.4528671578799142, -0.8814089125513395, -0.1342745924917817}},
+    // face 17
+    {{-0.4042148086933695, 0.7330894762816368, -0.5469828225804703},
+     {0.8878292858537911, 0.1706746764710865, -0.4273515110442893}},
+    // face 18
+    {{-0.9721374115064794, 0.0647682382197926, -0.2252863255224030},
+     {0.0958415169852749, 0.9868916636293629, -0.1298431664772152}},
+    // face 19
+    {{-0.5490814303330593, -0.7586196048290542, -0.3507219383392081},
+     {-0.8285959708235409, 0.4392579148657882, 0.3471040209544594}},
+};
+
 /** @brief Definition of which faces neighbor each other. */
 static const FaceOrientIJK faceNeighbors[NUM_ICOSA_FACES][4] = {
     {
@@ -351,51 +515,391 @@ void _geoToFaceIjk(const GeoCoord* g, int res, FaceIJK* h) {
 }
 
 /**
- * Encodes a coordinate on the sphere to the corresponding icosahedral face and
- * containing 2D hex coordinates relative to that face center.
+ * Determines the icosahedral face whose center is closest to a point.
  *
- * @param g The spherical coordinates to encode.
- * @param res The desired H3 resolution for the encoding.
- * @param face The icosahedral face containing the spherical coordinates.
- * @param v The 2D hex coordinates of the cell containing the point.
+ * The face is found by comparing squared distances between unit vectors,
+ * which avoids any trigonometry in the scan over faces.
+ *
+ * @param v3d The point on the unit sphere.
+ * @param sqd The squared distance from the face center to the point.
+ * @return The closest icosahedral face.
  */
-void _geoToHex2d(const GeoCoord* g, int res, int* face, Vec2d* v) {
-    // determine the icosahedron face
-    *face = 0;
-    double r = _geoDistRads(&faceCenterGeo[0], g);
+static inline int _vec3dToClosestFace(const Vec3d* v3d, double* sqd) {
+    int face = 0;
+    *sqd = _pointSquareDist(&faceCenterPoint[0], v3d);
     for (int f = 1; f < NUM_ICOSA_FACES; f++) {
-        double dist = _geoDistRads(&faceCenterGeo[f], g);
-        if (dist < r) {
-            *face = f;
-            r = dist;
+        double sqdT = _pointSquareDist(&faceCenterPoint[f], v3d);
+        if (sqdT < *sqd) {
+            face = f;
+            *sqd = sqdT;
         }
     }
+    return face;
+}
+
+/**
+ * Determines the icosahedral face whose center is closest to a coordinate on
+ * the sphere.
+ *
+ * @param g The spherical coordinates.
+ * @param v3d The point g on the unit sphere.
+ * @param face The closest icosahedral face.
+ * @param r The great circle distance in radians from the face center to g.
+ */
+static void _geoToClosestFace(const GeoCoord* g, Vec3d* v3d, int* face,
+                              double* r) {
+    _geoToVec3d(g, v3d);
+
+    // determine the icosahedron face
+    double sqd;
+    *face = _vec3dToClosestFace(v3d, &sqd);
+
+    *r = _squareDistToRads(sqd);
+}
 
+/**
+ * Projects a coordinate on the sphere onto the given icosahedral face, giving
+ * the 2D hex coordinates relative to that face center.
+ *
+ * With H3_FAST_MATH the point is projected with vector arithmetic, which
+ * needs the point on the unit sphere but no trigonometry.
+ *
+ * @param g The spherical coordinates to encode.
+ * @param v3d The point g on the unit sphere.
+ * @param res The desired H3 resolution for the encoding.
+ * @param face The icosahedral face containing the spherical coordinates.
+ * @param r The great circle distance in radians from the face center to g.
+ * @param v The 2D hex coordinates of the cell containing the point.
+ */
+static inline void _geoToHex2dOnFace(const GeoCoord* g, const Vec3d* v3d,
+                                     int res, int face, double r, Vec2d* v) {
     if (r < EPSILON) {
         v->x = v->y = 0.0L;
         return;
     }
 
+#ifdef H3_FAST_MATH
+    (void)g;
+    double x, y;
+    _vec3dToGnomonic(v3d, &faceCenterPoint[face], faceAxesCII[face],
+                     isResClassIII(res), &x, &y);
+    v->x = x * gnomonicToHex2dScale[res];
+    v->y = y * gnomonicToHex2dScale[res];
+#else
+    (void)v3d;
+
     // now have face and r, now find CCW theta from CII i-axis
     double theta =
-        _posAngleRads(faceAxesAzRadsCII[*face][0] -
-                      _posAngleRads(_geoAzimuthRads(&faceCenterGeo[*face], g)));
+        _posAngleRads(faceAxesAzRadsCII[face][0] -
+                      _posAngleRads(_geoAzimuthRads(&faceCenterGeo[face], g)));
 
     // adjust theta for Class III (odd resolutions)
     if (isResClassIII(res)) theta = _posAngleRads(theta - M_AP7_ROT_RADS);
 
     // perform gnomonic scaling of r
-    r = tan(r);
+    r = _h3Tan(r);
 
     // scale for current resolution length u
-    r /= RES0_U_GNOMONIC;
-    for (int i = 0; i < res; i++) r *= M_SQRT7;
+    r *= gnomonicToHex2dScale[res];
 
     // we now have (r, theta) in hex2d with theta ccw from x-axes
 
     // convert to local x,y
-    v->x = r * cos(theta);
-    v->y = r * sin(theta);
+    v->x = r * _h3Cos(theta);
+    v->y = r * _h3Sin(theta);
+#endif
+}
+
+/**
+ * Encodes a coordinate on the sphere to the corresponding icosahedral face and
+ * containing 2D hex coordinates relative to that face center.
+ *
+ * @param g The spherical coordinates to encode.
+ * @param res The desired H3 resolution for the encoding.
+ * @param face The icosahedral face containing the spherical coordinates.
+ * @param v The 2D hex coordinates of the cell containing the point.
+ */
+void _geoToHex2d(const GeoCoord* g, int res, int* face, Vec2d* v) {
+    Vec3d v3d;
+    double r;
+    _geoToClosestFace(g, &v3d, face, &r);
+    _geoToHex2dOnFace(g, &v3d, res, *face, r, v);
+}
+
+/**
+ * Encodes a coordinate on the sphere to the FaceIJK addresses of the
+ * containing cells at every resolution from 0 to finestRes.
+ *
+ * The face, the azimuth and the gnomonic distance do not depend on the
+ * resolution, so they are computed once, along with the sines and cosines of
+ * the Class II and Class III angles. The results are identical to calling
+ * _geoToFaceIjk at each resolution.
+ *
+ * @param g The spherical coordinates to encode.
+ * @param finestRes The finest H3 resolution to encode.
+ * @param h The FaceIJK addresses of the containing cells, finestRes + 1 of
+ *          them indexed by resolution.
+ */
+void _geoToFaceIjkMulti(const GeoCoord* g, int finestRes, FaceIJK* h) {
+    Vec3d v3d;
+    int face;
+    double r;
+    _geoToClosestFace(g, &v3d, &face, &r);
+
+    if (r < EPSILON) {
+        for (int res = 0; res <= finestRes; res++) {
+            Vec2d v = {0.0, 0.0};
+            h[res].face = face;
+            _hex2dToCoordIJK(&v, &h[res].coord);
+        }
+        return;
+    }
+
+    // see _geoToHex2dOnFace
+#ifdef H3_FAST_MATH
+    double x[2], y[2];
+    for (int classIII = 0; classIII < 2; classIII++) {
+        _vec3dToGnomonic(&v3d, &faceCenterPoint[face], faceAxesCII[face],
+                         classIII, &x[classIII], &y[classIII]);
+    }
+
+    for (int res = 0; res <= finestRes; res++) {
+        int classIII = isResClassIII(res);
+        Vec2d v = {x[classIII] * gnomonicToHex2dScale[res],
+                   y[classIII] * gnomonicToHex2dScale[res]};
+        h[res].face = face;
+        _hex2dToCoordIJK(&v, &h[res].coord);
+    }
+#else
+    double theta =
+        _posAngleRads(faceAxesAzRadsCII[face][0] -
+                      _posAngleRads(_geoAzimuthRads(&faceCenterGeo[face], g)));
+    double thetaIII = _posAngleRads(theta - M_AP7_ROT_RADS);
+    double cosTheta[2] = {_h3Cos(theta), _h3Cos(thetaIII)};
+    double sinTheta[2] = {_h3Sin(theta), _h3Sin(thetaIII)};
+    double gnomonicR = _h3Tan(r);
+
+    for (int res = 0; res <= finestRes; res++) {
+        int classIII = isResClassIII(res);
+        double resR = gnomonicR * gnomonicToHex2dScale[res];
+        Vec2d v = {resR * cosTheta[classIII], resR * sinTheta[classIII]};
+        h[res].face = face;
+        _hex2dToCoordIJK(&v, &h[res].coord);
+    }
+#endif
+}
+
+/**
+ * Encodes a block of coordinates on the sphere to the FaceIJK addresses of the
+ * containing cells at the specified resolution.
+ *
+ * The face selection performs the same squared distance scan as
+ * _geoToHex2d, laid out so that the inner loop over points has no branches
+ * or calls and can be auto-vectorized. The results are identical to calling
+ * _geoToFaceIjk on each point.
+ *
+ * @param lat The latitudes of the points, in radians.
+ * @param lon The longitudes of the points, in radians.
+ * @param n The number of points, at most FACE_BATCH_SIZE.
+ * @param res The desired H3 resolution for the encoding.
+ * @param h The FaceIJK addresses of the containing cells at resolution res.
+ */
+void _geoToFaceIjkBatch(const double* lat, const double* lon, int n, int res,
+                        FaceIJK* h) {
+    assert(n >= 0 && n <= FACE_BATCH_SIZE);
+
+    double x[FACE_BATCH_SIZE];
+    double y[FACE_BATCH_SIZE];
+    double z[FACE_BATCH_SIZE];
+    for (int i = 0; i < n; i++) {
+        GeoCoord g = {lat[i], lon[i]};
+        Vec3d p;
+        _geoToVec3d(&g, &p);
+        x[i] = p.x;
+        y[i] = p.y;
+        z[i] = p.z;
+    }
+
+    double best[FACE_BATCH_SIZE];
+    int faces[FACE_BATCH_SIZE];
+    for (int i = 0; i < n; i++) {
+        best[i] = 5.0;  // greater than any sqd on the unit sphere
+        faces[i] = 0;
+    }
+    for (int f = 0; f < NUM_ICOSA_FACES; f++) {
+        const double cx = faceCenterPoint[f].x;
+        const double cy = faceCenterPoint[f].y;
+        const double cz = faceCenterPoint[f].z;
+        for (int i = 0; i < n; i++) {
+            double dx = x[i] - cx;
+            double dy = y[i] - cy;
+            double dz = z[i] - cz;
+            double sqd = dx * dx + dy * dy + dz * dz;
+            int closer = sqd < best[i];
+            faces[i] = closer ? f : faces[i];
+            best[i] = closer ? sqd : best[i];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        GeoCoord g = {lat[i], lon[i]};
+        Vec3d p = {x[i], y[i], z[i]};
+        double r = _squareDistToRads(best[i]);
+
+        Vec2d v;
+        h[i].face = faces[i];
+        _geoToHex2dOnFace(&g, &p, res, faces[i], r, &v);
+        _hex2dToCoordIJK(&v, &h[i].coord);
+    }
+}
+
+/** @brief hex2d unit vectors towards the 6 neighbors of a cell */
+static const Vec2d neighborDirs[6] = {
+    {-0.5, -M_SQRT3_2}, {-0.5, M_SQRT3_2}, {-1.0, 0.0},
+    {1.0, 0.0},         {0.5, -M_SQRT3_2}, {0.5, M_SQRT3_2}};
+/** @brief the H3 digits of the neighbors in neighborDirs */
+static const int neighborDigits[6] = {K_AXES_DIGIT,  J_AXES_DIGIT,
+                                      JK_AXES_DIGIT, I_AXES_DIGIT,
+                                      IK_AXES_DIGIT, IJ_AXES_DIGIT};
+
+/**
+ * Adds an index to a path of cells, unless it repeats the last one.
+ *
+ * @param path The path.
+ * @param h The index to add.
+ */
+static void _cellPathAdd(CellPath* path, H3Index h) {
+    if (path->count > 0 && h == path->last) return;
+    if (path->count < path->outSize) path->out[path->count] = h;
+    path->count++;
+    path->last = h;
+}
+
+/**
+ * Adds the cells of a face crossed by the segment from a to b in its 2D hex
+ * coordinates, as far as the point a + tEnd * (b - a).
+ *
+ * Cells are the Voronoi cells of the lattice of their centers, so the
+ * segment leaves a cell where it crosses the perpendicular bisector towards
+ * one of its neighbors, and the first bisector it crosses is the one it
+ * leaves through.
+ *
+ * @param face The icosahedral face.
+ * @param res The H3 resolution of the cells.
+ * @param a The start of the segment.
+ * @param b The end of the segment.
+ * @param tEnd The fraction of the segment on this face.
+ * @param path The path to add the cells to.
+ */
+static void _faceSegmentToCells(int face, int res, const Vec2d* a,
+                                const Vec2d* b, double tEnd, CellPath* path) {
+    FaceIJK fijk;
+    fijk.face = face;
+    _hex2dToCoordIJK(a, &fijk.coord);
+    _cellPathAdd(path, _faceIjkToH3(&fijk, res));
+
+    Vec2d d = {b->x - a->x, b->y - a->y};
+    while (true) {
+        Vec2d c;
+        _ijkToHex2d(&fijk.coord, &c);
+        double qx = a->x - c.x;
+        double qy = a->y - c.y;
+
+        // The bisector towards the neighbor at c + u is where
+        // u . (a - c + t * d) = 1/2
+        double tExit = tEnd;
+        int digit = INVALID_DIGIT;
+        for (int i = 0; i < 6; i++) {
+            double along = neighborDirs[i].x * d.x + neighborDirs[i].y * d.y;
+            if (along <= 0) continue;
+            double t =
+                (0.5 - (neighborDirs[i].x * qx + neighborDirs[i].y * qy)) /
+                along;
+            if (t < tExit) {
+                tExit = t;
+                digit = neighborDigits[i];
+            }
+        }
+        if (digit == INVALID_DIGIT) return;
+
+        // Every step is towards b, so the walk cannot return to a cell
+        _neighbor(&fijk.coord, digit);
+        _cellPathAdd(path, _faceIjkToH3(&fijk, res));
+    }
+}
+
+/**
+ * Adds the cells crossed by the great circle arc from a to b to a path, in
+ * order, each cell being the one geoToH3 gives for the points of the arc in
+ * it.
+ *
+ * A point is encoded on the face with the closest center, whose region is
+ * bounded by the planes through the origin equidistant from its center and
+ * each other face center. In the gnomonic projection onto that face the
+ * regions are straight sided and the arc is a segment, so the portion of
+ * the arc on each face is found exactly, and walked in the 2D hex
+ * coordinates of the face.
+ *
+ * @param a The start of the arc on the unit sphere.
+ * @param b The end of the arc, less than MAX_CELL_ARC_RADS from a, in the
+ * same direction from the origin as a point on the unit sphere.
+ * @param res The H3 resolution of the cells.
+ * @param path The path to add the cells to.
+ */
+void _vec3dArcToCells(const Vec3d* a, const Vec3d* b, int res,
+                      CellPath* path) {
+    Vec3d pa = *a;
+    Vec3d pb = *b;
+    double sqd;
+    int face = _vec3dToClosestFace(&pa, &sqd);
+    int classIII = isResClassIII(res);
+    double scale = gnomonicToHex2dScale[res];
+
+    // The arc enters each face at most once, the bound only guards against
+    // rounding at the vertices of the faces
+    for (int faces = 0; faces < NUM_ICOSA_FACES; faces++) {
+        const Vec3d* center = &faceCenterPoint[face];
+        double ra = pa.x * center->x + pa.y * center->y + pa.z * center->z;
+        double rb = pb.x * center->x + pb.y * center->y + pb.z * center->z;
+        // The ends of the segment on the plane tangent at the face center
+        Vec3d qa = {pa.x / ra, pa.y / ra, pa.z / ra};
+        Vec3d qb = {pb.x / rb, pb.y / rb, pb.z / rb};
+
+        // Find where the segment leaves the region of the face. Points q
+        // have the other face f closer where q . (center - f) < 0.
+        double tExit = 1.0;
+        int nextFace = face;
+        for (int f = 0; f < NUM_ICOSA_FACES; f++) {
+            if (f == face) continue;
+            Vec3d n = {center->x - faceCenterPoint[f].x,
+                       center->y - faceCenterPoint[f].y,
+                       center->z - faceCenterPoint[f].z};
+            double ha = qa.x * n.x + qa.y * n.y + qa.z * n.z;
+            double hb = qb.x * n.x + qb.y * n.y + qb.z * n.z;
+            if (hb >= 0 || hb >= ha) continue;
+            double t = ha > 0 ? ha / (ha - hb) : 0.0;
+            if (t < tExit) {
+                tExit = t;
+                nextFace = f;
+            }
+        }
+
+        double x, y;
+        Vec2d va, vb;
+        _vec3dToGnomonic(&qa, center, faceAxesCII[face], classIII, &x, &y);
+        va.x = x * scale;
+        va.y = y * scale;
+        _vec3dToGnomonic(&qb, center, faceAxesCII[face], classIII, &x, &y);
+        vb.x = x * scale;
+        vb.y = y * scale;
+        _faceSegmentToCells(face, res, &va, &vb, tExit, path);
+
+        if (nextFace == face) return;
+        pa.x = qa.x + tExit * (qb.x - qa.x);
+        pa.y = qa.y + tExit * (qb.y - qa.y);
+        pa.z = qa.z + tExit * (qb.z - qa.z);
+        face = nextFace;
+    }
 }
 
 /**
@@ -420,21 +924,33 @@ void _hex2dToGeo(const Vec2d* v, int face, int res, int substrate,
         return;
     }
 
-    double theta = atan2(v->y, v->x);
-
-    // scale for current resolution length u
-    for (int i = 0; i < res; i++) r /= M_SQRT7;
-
-    // scale accordingly if this is a substrate grid
-    if (substrate) {
-        r /= 3.0;
-        if (isResClassIII(res)) r /= M_SQRT7;
+#ifdef H3_FAST_MATH
+    // if a substrate grid, then it's already been adjusted for Class III
+    double scale = substrate ? substrateToGnomonicScale[res]
+                             : hex2dToGnomonicScale[res];
+    _gnomonicToGeo(v->x * scale, v->y * scale, &faceCenterPoint[face],
+                   faceAxesCII[face], !substrate && isResClassIII(res),
+                   &g->lat, &g->lon);
+    // see _geoAzDistanceRads
+    if (fabs(g->lat - M_PI_2) < EPSILON) {
+        g->lat = M_PI_2;
+        g->lon = 0.0;
+    } else if (fabs(g->lat + M_PI_2) < EPSILON) {
+        g->lat = -M_PI_2;
+        g->lon = 0.0;
+    } else {
+        g->lon = _posAngleRads(g->lon);
     }
+#else
+    double theta = _h3Atan2(v->y, v->x);
 
-    r *= RES0_U_GNOMONIC;
+    // scale for current resolution length u, and accordingly if this is a
+    // substrate grid
+    r *= substrate ? substrateToGnomonicScale[res]
+                   : hex2dToGnomonicScale[res];
 
     // perform inverse gnomonic scaling of r
-    r = atan(r);
+    r = _h3Atan(r);
 
     // adjust theta for Class III
     // if a substrate grid, then it's already been adjusted for Class III
@@ -446,6 +962,7 @@ void _hex2dToGeo(const Vec2d* v, int face, int res, int substrate,
 
     // now find the point at (r,theta) from the face center
     _geoAzDistanceRads(&faceCenterGeo[face], theta, r, g);
+#endif
 }
 
 /**
@@ -469,8 +986,11 @@ void _faceIjkToGeo(const FaceIJK* h, int res, GeoCoord* g) {
  * @param h The FaceIJK address of the pentagonal cell.
  * @param res The H3 resolution of the cell.
  * @param g The spherical coordinates of the cell boundary.
+ * @param vertexOffsets Output position in g of each of the 5 vertices of the
+ * pentagon, between which edge crossing vertices are inserted, or NULL.
  */
-void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g) {
+void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g,
+                               int* vertexOffsets) {
     // the vertexes of an origin-centered pentagon in a Class II resolution on a
     // substrate grid with aperture sequence 33r. The aperture 3 gets us the
     // vertices, and the 3r gets us back to Class II.
@@ -614,6 +1134,7 @@ void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g) {
         // vert == NUM_PENT_VERTS is only used to test for possible intersection
         // on last edge
         if (vert < NUM_PENT_VERTS) {
+            if (vertexOffsets != NULL) vertexOffsets[v] = g->numVerts;
             Vec2d vec;
             _ijkToHex2d(&fijk.coord, &vec);
             _hex2dToGeo(&vec, fijk.face, adjRes, 1, &g->verts[g->numVerts]);
@@ -632,11 +1153,14 @@ void _faceIjkPentToGeoBoundary(const FaceIJK* h, int res, GeoBoundary* g) {
  * @param res The H3 resolution of the cell.
  * @param isPentagon Whether or not the cell is a pentagon.
  * @param g The spherical coordinates of the cell boundary.
+ * @param vertexOffsets Output position in g of each of the 6 vertices of the
+ * cell (5 for pentagons), between which edge crossing vertices are
+ * inserted, or NULL.
  */
 void _faceIjkToGeoBoundary(const FaceIJK* h, int res, int isPentagon,
-                           GeoBoundary* g) {
+                           GeoBoundary* g, int* vertexOffsets) {
     if (isPentagon) {
-        _faceIjkPentToGeoBoundary(h, res, g);
+        _faceIjkPentToGeoBoundary(h, res, g, vertexOffsets);
         return;
     }
 
@@ -697,6 +1221,23 @@ void _faceIjkToGeoBoundary(const FaceIJK* h, int res, int isPentagon,
         _ijkNormalize(&fijkVerts[v].coord);
     }
 
+    // The origin cell vertices have i + j + k of at most 3 in Class II and 9
+    // in Class III, and normalizing never increases it, so a cell whose
+    // center is at least that far inside the face edge has every vertex on
+    // its face: no vertex has overage and no edge crosses the face edge.
+    const CoordIJK* c = &centerIJK.coord;
+    int vertMargin = isResClassIII(res) ? 9 : 3;
+    if (c->i + c->j + c->k + vertMargin < 3 * maxDimByCIIres[adjRes]) {
+        for (int v = 0; v < NUM_HEX_VERTS; v++) {
+            if (vertexOffsets != NULL) vertexOffsets[v] = v;
+            Vec2d vec;
+            _ijkToHex2d(&fijkVerts[v].coord, &vec);
+            _hex2dToGeo(&vec, centerIJK.face, adjRes, 1, &g->verts[v]);
+        }
+        g->numVerts = NUM_HEX_VERTS;
+        return;
+    }
+
     // convert each vertex to lat/lon
     // adjust the face of each vertex as appropriate and introduce
     // edge-crossing vertices as needed
@@ -777,6 +1318,7 @@ void _faceIjkToGeoBoundary(const FaceIJK* h, int res, int isPentagon,
         // vert == NUM_HEX_VERTS is only used to test for possible intersection
         // on last edge
         if (vert < NUM_HEX_VERTS) {
+            if (vertexOffsets != NULL) vertexOffsets[v] = g->numVerts;
             Vec2d vec;
             _ijkToHex2d(&fijk.coord, &vec);
             _hex2dToGeo(&vec, fijk.face, adjRes, 1, &g->verts[g->numVerts]);
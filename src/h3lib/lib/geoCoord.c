@@ -21,7 +21,9 @@
 #include <math.h>
 #include <stdbool.h>
 #include "constants.h"
+#include "fastMath.h"
 #include "h3api.h"
+#include "vec3d.h"
 
 /**
  * Normalizes radians to a value between 0.0 and two PI.
@@ -155,11 +157,11 @@ double _geoDistRads(const GeoCoord* p1, const GeoCoord* p2) {
     double a = M_PI_2 - p2->lat;
 
     // use law of cosines to find c
-    double cosc = cos(a) * cos(b) + sin(a) * sin(b) * cos(bigC);
+    double cosc = _h3Cos(a) * _h3Cos(b) + _h3Sin(a) * _h3Sin(b) * _h3Cos(bigC);
     if (cosc > 1.0L) cosc = 1.0L;
     if (cosc < -1.0L) cosc = -1.0L;
 
-    return acos(cosc);
+    return _h3Acos(cosc);
 }
 
 /**
@@ -182,9 +184,10 @@ double _geoDistKm(const GeoCoord* p1, const GeoCoord* p2) {
  * @return The azimuth in radians from p1 to p2.
  */
 double _geoAzimuthRads(const GeoCoord* p1, const GeoCoord* p2) {
-    return atan2(cos(p2->lat) * sin(p2->lon - p1->lon),
-                 cos(p1->lat) * sin(p2->lat) -
-                     sin(p1->lat) * cos(p2->lat) * cos(p2->lon - p1->lon));
+    return _h3Atan2(_h3Cos(p2->lat) * _h3Sin(p2->lon - p1->lon),
+                    _h3Cos(p1->lat) * _h3Sin(p2->lat) -
+                        _h3Sin(p1->lat) * _h3Cos(p2->lat) *
+                            _h3Cos(p2->lon - p1->lon));
 }
 
 /**
@@ -227,11 +230,11 @@ void _geoAzDistanceRads(const GeoCoord* p1, double az, double distance,
             p2->lon = _posAngleRads(p1->lon);
     } else  // not due north or south
     {
-        sinlat = sin(p1->lat) * cos(distance) +
-                 cos(p1->lat) * sin(distance) * cos(az);
+        sinlat = _h3Sin(p1->lat) * _h3Cos(distance) +
+                 _h3Cos(p1->lat) * _h3Sin(distance) * _h3Cos(az);
         if (sinlat > 1.0L) sinlat = 1.0L;
         if (sinlat < -1.0L) sinlat = -1.0L;
-        p2->lat = asin(sinlat);
+        p2->lat = _h3Asin(sinlat);
         if (fabs(p2->lat - M_PI_2) < EPSILON)  // north pole
         {
             p2->lat = M_PI_2;
@@ -241,14 +244,14 @@ void _geoAzDistanceRads(const GeoCoord* p1, double az, double distance,
             p2->lat = -M_PI_2;
             p2->lon = 0.0L;
         } else {
-            sinlon = sin(az) * sin(distance) / cos(p2->lat);
-            coslon = (cos(distance) - sin(p1->lat) * sin(p2->lat)) /
-                     cos(p1->lat) / cos(p2->lat);
+            sinlon = _h3Sin(az) * _h3Sin(distance) / _h3Cos(p2->lat);
+            coslon = (_h3Cos(distance) - _h3Sin(p1->lat) * _h3Sin(p2->lat)) /
+                     _h3Cos(p1->lat) / _h3Cos(p2->lat);
             if (sinlon > 1.0L) sinlon = 1.0L;
             if (sinlon < -1.0L) sinlon = -1.0L;
             if (coslon > 1.0L) sinlon = 1.0L;
             if (coslon < -1.0L) sinlon = -1.0L;
-            p2->lon = _posAngleRads(p1->lon + atan2(sinlon, coslon));
+            p2->lon = _posAngleRads(p1->lon + _h3Atan2(sinlon, coslon));
         }
     }
 }
@@ -297,6 +300,143 @@ double H3_EXPORT(edgeLengthM)(int res) {
     return lens[res];
 }
 
+/**
+ * Area in steradians of a simple spherical polygon, as the sum of the signed
+ * areas of the triangles fanning out from its first vertex.
+ *
+ * Each triangle is measured with the formula of Van Oosterom and Strackee,
+ * tan(E / 2) = a . (b x c) / (1 + a . b + b . c + c . a). The triple product
+ * is taken over the differences from a, so that it keeps its precision for
+ * the tiny triangles of fine resolutions.
+ *
+ * @param gb The polygon
+ * @return The area of the polygon in steradians
+ */
+static double _geoBoundaryAreaRads2(const GeoBoundary* gb) {
+    Vec3d verts[MAX_CELL_BNDRY_VERTS];
+    for (int i = 0; i < gb->numVerts; i++) {
+        _geoToVec3d(&gb->verts[i], &verts[i]);
+    }
+
+    const Vec3d* a = &verts[0];
+    double area = 0;
+    for (int i = 1; i + 1 < gb->numVerts; i++) {
+        const Vec3d* b = &verts[i];
+        const Vec3d* c = &verts[i + 1];
+        Vec3d u = {b->x - a->x, b->y - a->y, b->z - a->z};
+        Vec3d w = {c->x - a->x, c->y - a->y, c->z - a->z};
+        double triple = a->x * (u.y * w.z - u.z * w.y) +
+                        a->y * (u.z * w.x - u.x * w.z) +
+                        a->z * (u.x * w.y - u.y * w.x);
+        double ab = a->x * b->x + a->y * b->y + a->z * b->z;
+        double bc = b->x * c->x + b->y * c->y + b->z * c->z;
+        double ca = c->x * a->x + c->y * a->y + c->z * a->z;
+        area += 2 * atan2(triple, 1 + ab + bc + ca);
+    }
+    return fabs(area);
+}
+
+/**
+ * Length in radians of the great circle path through the vertices of the
+ * given boundary, in order. Each segment is measured as
+ * atan2(|a x b|, a . b), which unlike the law of cosines keeps its precision
+ * for short segments.
+ *
+ * @param gb The path
+ * @return The length of the path in radians
+ */
+static double _geoBoundaryLengthRads(const GeoBoundary* gb) {
+    Vec3d prev;
+    _geoToVec3d(&gb->verts[0], &prev);
+    double length = 0;
+    for (int i = 1; i < gb->numVerts; i++) {
+        Vec3d v;
+        _geoToVec3d(&gb->verts[i], &v);
+        Vec3d d = {v.x - prev.x, v.y - prev.y, v.z - prev.z};
+        Vec3d cross = {prev.y * d.z - prev.z * d.y, prev.z * d.x - prev.x * d.z,
+                       prev.x * d.y - prev.y * d.x};
+        double dot = prev.x * v.x + prev.y * v.y + prev.z * v.z;
+        length += atan2(sqrt(cross.x * cross.x + cross.y * cross.y +
+                             cross.z * cross.z),
+                        dot);
+        prev = v;
+    }
+    return length;
+}
+
+/**
+ * Exact area of the given cell in square kilometers, from its boundary as
+ * given by h3ToGeoBoundary.
+ *
+ * @param h3 The cell
+ * @return The area of the cell in square kilometers
+ */
+double H3_EXPORT(cellAreaKm2)(H3Index h3) {
+    GeoBoundary gb;
+    H3_EXPORT(h3ToGeoBoundary)(h3, &gb);
+    return _geoBoundaryAreaRads2(&gb) * EARTH_RADIUS_KM * EARTH_RADIUS_KM;
+}
+
+/**
+ * Exact area of the given cell in square meters.
+ *
+ * @param h3 The cell
+ * @return The area of the cell in square meters
+ */
+double H3_EXPORT(cellAreaM2)(H3Index h3) {
+    return H3_EXPORT(cellAreaKm2)(h3) * 1000 * 1000;
+}
+
+/**
+ * Exact areas of an array of cells in square kilometers.
+ *
+ * @param h3 The cells
+ * @param n The number of cells
+ * @param out Output array of n areas
+ */
+void H3_EXPORT(cellAreaKm2Batch)(const H3Index* h3, int n, double* out) {
+    for (int i = 0; i < n; i++) {
+        out[i] = H3_EXPORT(cellAreaKm2)(h3[i]);
+    }
+}
+
+/**
+ * Exact length of the given unidirectional edge in kilometers, along the
+ * vertices given by getH3UnidirectionalEdgeBoundary.
+ *
+ * @param edge The unidirectional edge
+ * @return The length of the edge in kilometers
+ */
+double H3_EXPORT(exactEdgeLengthKm)(H3Index edge) {
+    GeoBoundary gb;
+    H3_EXPORT(getH3UnidirectionalEdgeBoundary)(edge, &gb);
+    return _geoBoundaryLengthRads(&gb) * EARTH_RADIUS_KM;
+}
+
+/**
+ * Exact length of the given unidirectional edge in meters.
+ *
+ * @param edge The unidirectional edge
+ * @return The length of the edge in meters
+ */
+double H3_EXPORT(exactEdgeLengthM)(H3Index edge) {
+    return H3_EXPORT(exactEdgeLengthKm)(edge) * 1000;
+}
+
+/**
+ * Exact lengths of an array of unidirectional edges in kilometers.
+ *
+ * @param edges The unidirectional edges
+ * @param n The number of edges
+ * @param out Output array of n lengths
+ */
+void H3_EXPORT(exactEdgeLengthKmBatch)(const H3Index* edges, int n,
+                                       double* out) {
+    for (int i = 0; i < n; i++) {
+        out[i] = H3_EXPORT(exactEdgeLengthKm)(edges[i]);
+    }
+}
+
 /** @brief Number of unique valid H3Indexes at given resolution. */
 int64_t H3_EXPORT(numHexagons)(int res) {
     static const int64_t nums[] = {122L,
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Adjacency.c
+ * @brief   Compressed sparse row adjacency of the cells of a set
+ *
+ * The cells are sorted once with their positions in the set, so that the
+ * neighbor of a cell in each direction is found by a binary search. A first
+ * pass finds the neighbors of every cell in the set and counts them, the
+ * counts are summed into the offsets of the rows, and a second pass writes
+ * each row into its own range of the output. Both passes may run in
+ * parallel over ranges of cells.
+ */
+
+#include <assert.h>
+#include "algos.h"
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3api_inline.h"
+
+/** @brief A cell and its position in the input set */
+typedef struct {
+    H3Index h;     ///< the cell
+    int position;  ///< the position of the cell in the input set
+} AdjacencyKey;
+
+/** @brief State shared by the tasks of h3SetToAdjacency */
+typedef struct {
+    const H3Index* h3Set;      ///< the input set
+    const AdjacencyKey* keys;  ///< the cells of the set, sorted
+    int numKeys;               ///< the number of keys
+    int* found;      ///< position of the neighbor in each direction of each
+                     ///< cell, or -1
+    int* offsets;    ///< the number of neighbors of each cell, then the
+                     ///< offset of each row
+    int* neighbors;  ///< output positions of the neighbors
+    H3Index* edges;  ///< output edges to the neighbors
+} AdjacencyData;
+
+/**
+ * Sort keys in ascending order of cells with a least significant digit
+ * first radix sort, one byte at a time, as _radixSortH3Indexes does.
+ * @param keys Keys to sort
+ * @param temp Working memory of the same size
+ * @param numKeys Number of keys
+ * @return The array holding the sorted keys, either keys or temp
+ */
+static AdjacencyKey* _radixSortAdjacencyKeys(AdjacencyKey* keys,
+                                             AdjacencyKey* temp,
+                                             int numKeys) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        int counts[256] = {0};
+        for (int i = 0; i < numKeys; i++) {
+            counts[(keys[i].h >> shift) & 0xff]++;
+        }
+        if (counts[(keys[0].h >> shift) & 0xff] == numKeys) {
+            continue;
+        }
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < numKeys; i++) {
+            temp[counts[(keys[i].h >> shift) & 0xff]++] = keys[i];
+        }
+        AdjacencyKey* swap = keys;
+        keys = temp;
+        temp = swap;
+    }
+    return keys;
+}
+
+/**
+ * Finds the position of a cell in the set.
+ * @param data The sorted cells of the set
+ * @param h The cell
+ * @return The position of the cell in the input set, or -1 if it is not in
+ * the set
+ */
+static int _adjacencyFind(const AdjacencyData* data, H3Index h) {
+    int low = 0;
+    int high = data->numKeys;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (data->keys[mid].h < h) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < data->numKeys && data->keys[low].h == h) {
+        return data->keys[low].position;
+    }
+    return -1;
+}
+
+/**
+ * Finds the neighbors in the set of a range of cells, in each direction,
+ * and counts them.
+ * @param data The AdjacencyData
+ * @param begin The first cell of the range
+ * @param end One past the last cell of the range
+ */
+static void _adjacencyFindTask(void* data, int begin, int end) {
+    AdjacencyData* adjacency = data;
+    for (int i = begin; i < end; i++) {
+        H3Index origin = adjacency->h3Set[i];
+        int* found = adjacency->found + 6 * i;
+        int isPentagon = origin != 0 && h3IsPentagonInline(origin);
+        int count = 0;
+        for (int d = 0; d < 6; d++) {
+            found[d] = -1;
+            if (origin == 0 || (isPentagon && d + 1 == K_AXES_DIGIT)) {
+                continue;
+            }
+            int rotations = 0;
+            H3Index neighbor = h3NeighborRotations(origin, d + 1, &rotations);
+            found[d] = _adjacencyFind(adjacency, neighbor);
+            count += found[d] >= 0;
+        }
+        adjacency->offsets[i] = count;
+    }
+}
+
+/**
+ * Writes the rows of a range of cells, from the neighbors found for them.
+ * @param data The AdjacencyData
+ * @param begin The first cell of the range
+ * @param end One past the last cell of the range
+ */
+static void _adjacencyWriteTask(void* data, int begin, int end) {
+    AdjacencyData* adjacency = data;
+    for (int i = begin; i < end; i++) {
+        const int* found = adjacency->found + 6 * i;
+        int offset = adjacency->offsets[i];
+        H3Index edge = adjacency->h3Set[i];
+        H3_SET_MODE(edge, H3_UNIEDGE_MODE);
+        for (int d = 0; d < 6; d++) {
+            if (found[d] < 0) continue;
+            H3_SET_RESERVED_BITS(edge, d + 1);
+            adjacency->neighbors[offset] = found[d];
+            adjacency->edges[offset] = edge;
+            offset++;
+        }
+    }
+}
+
+/**
+ * h3SetToAdjacency finds the edges between the cells of a set, as a
+ * compressed sparse row adjacency over the positions of the cells in the
+ * set. The edges from the cell at position i are edges[offsets[i]] up to
+ * edges[offsets[i + 1]], in order of direction, and go to the cells at
+ * positions neighbors[offsets[i]] up to neighbors[offsets[i + 1]]. Cells
+ * are only adjacent to neighbors of the same resolution, and 0's in the set
+ * have no edges.
+ *
+ * The neighbors are found, and the rows written, by calling parallelFor,
+ * which must call the given task on disjoint ranges covering [0, n) and
+ * return once all of them have completed. The ranges may run concurrently
+ * on any threads. If parallelFor is NULL, everything runs on the calling
+ * thread.
+ *
+ * @param h3Set Set of cells
+ * @param numHexes The number of cells in the set
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ * @param out The adjacency, which the caller must free with
+ * destroyH3Adjacency
+ * @return 0 on success, or -1 if a cell is in the set more than once, in
+ * which case out is left empty
+ */
+int H3_EXPORT(h3SetToAdjacency)(const H3Index* h3Set, const int numHexes,
+                                H3ParallelFor parallelFor, void* executor,
+                                H3Adjacency* out) {
+    out->numCells = 0;
+    out->numEdges = 0;
+    out->offsets = NULL;
+    out->neighbors = NULL;
+    out->edges = NULL;
+    if (numHexes <= 0) {
+        return 0;
+    }
+
+    AdjacencyKey* keys =
+        H3_MEMORY(malloc)(2 * numHexes * sizeof(AdjacencyKey));
+    assert(keys != NULL);
+    int numKeys = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] == 0) continue;
+        keys[numKeys].h = h3Set[i];
+        keys[numKeys].position = i;
+        numKeys++;
+    }
+    AdjacencyKey* sorted = keys;
+    if (numKeys > 0) {
+        sorted = _radixSortAdjacencyKeys(keys, keys + numHexes, numKeys);
+    }
+    for (int i = 1; i < numKeys; i++) {
+        if (sorted[i].h == sorted[i - 1].h) {
+            H3_MEMORY(free)(keys);
+            return -1;
+        }
+    }
+
+    AdjacencyData data = {0};
+    data.h3Set = h3Set;
+    data.keys = sorted;
+    data.numKeys = numKeys;
+    data.found = H3_MEMORY(malloc)(6 * numHexes * sizeof(int));
+    assert(data.found != NULL);
+    data.offsets = H3_MEMORY(malloc)((numHexes + 1) * sizeof(int));
+    assert(data.offsets != NULL);
+    if (parallelFor == NULL) {
+        _adjacencyFindTask(&data, 0, numHexes);
+    } else {
+        parallelFor(executor, numHexes, _adjacencyFindTask, &data);
+    }
+    H3_MEMORY(free)(keys);
+
+    int numEdges = 0;
+    for (int i = 0; i < numHexes; i++) {
+        int count = data.offsets[i];
+        data.offsets[i] = numEdges;
+        numEdges += count;
+    }
+    data.offsets[numHexes] = numEdges;
+
+    // The edges, offsets and neighbors share one block, edges first to keep
+    // them aligned
+    H3Index* block = H3_MEMORY(malloc)(numEdges * sizeof(H3Index) +
+                                       (numHexes + 1 + numEdges) * sizeof(int));
+    assert(block != NULL);
+    data.edges = block;
+    int* offsets = (int*)(block + numEdges);
+    data.neighbors = offsets + numHexes + 1;
+    if (parallelFor == NULL) {
+        _adjacencyWriteTask(&data, 0, numHexes);
+    } else {
+        parallelFor(executor, numHexes, _adjacencyWriteTask, &data);
+    }
+    for (int i = 0; i <= numHexes; i++) {
+        offsets[i] = data.offsets[i];
+    }
+    H3_MEMORY(free)(data.offsets);
+    H3_MEMORY(free)(data.found);
+
+    out->numCells = numHexes;
+    out->numEdges = numEdges;
+    out->offsets = offsets;
+    out->neighbors = data.neighbors;
+    out->edges = data.edges;
+    return 0;
+}
+
+/**
+ * Free the memory held by an H3Adjacency filled by h3SetToAdjacency. The
+ * caller is responsible for the memory of the struct itself.
+ * @param adjacency Adjacency to destroy
+ */
+void H3_EXPORT(destroyH3Adjacency)(H3Adjacency* adjacency) {
+    // Every array lives in the block starting at edges
+    H3_MEMORY(free)(adjacency->edges);
+    adjacency->edges = NULL;
+    adjacency->offsets = NULL;
+    adjacency->neighbors = NULL;
+    adjacency->numCells = 0;
+    adjacency->numEdges = 0;
+}
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Aggregate.c
+ * @brief   Counts and sums of values of points grouped by hexagon
+ *
+ * Points are encoded a block at a time with geoToH3Batch into a buffer on
+ * the stack and accumulated into an open addressed hash map, whose slots
+ * keep the hexagon, count and sum together so that each point touches one
+ * cache line. Runs of points in the same hexagon, as in tracks and sorted
+ * data, are accumulated without probing. The map is kept at most half full,
+ * and hashed as H3IndexSet is.
+ *
+ * The parallel version splits the points into parts aggregated into tables
+ * of their own, which are merged once all of them have completed.
+ */
+
+#include "h3Aggregate.h"
+#include <assert.h>
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3IndexSet.h"
+#include "h3api_inline.h"
+
+/** the number of points encoded at a time */
+#define AGGREGATE_BLOCK_SIZE 256
+
+/** the fewest points of a part of a parallel aggregation */
+#define AGGREGATE_PARALLEL_MIN_POINTS 65536
+
+/** the most parts a parallel aggregation is split into */
+#define AGGREGATE_PARALLEL_MAX_PARTS 64
+
+/**
+ * Allocates the slots of an aggregate, with room for capacity hexagons
+ * before it grows.
+ *
+ * @param agg The aggregate
+ * @param capacity The number of hexagons
+ */
+static void _aggregateAllocSlots(H3Aggregate* agg, int capacity) {
+    int numSlots = 16;
+    while (numSlots < 2 * capacity && numSlots < (1 << 30)) {
+        numSlots *= 2;
+    }
+    agg->slots = H3_MEMORY(calloc)(numSlots, sizeof(H3AggregateSlot));
+    assert(agg->slots != NULL);
+    agg->mask = numSlots - 1;
+}
+
+/**
+ * createH3Aggregate creates an empty aggregate of the points of the
+ * hexagons of a resolution.
+ *
+ * @param res The resolution of the hexagons
+ * @param capacity The number of hexagons the aggregate holds before it grows
+ * @return The aggregate, which the caller must free with destroyH3Aggregate,
+ * or NULL if the resolution is invalid
+ */
+H3Aggregate* H3_EXPORT(createH3Aggregate)(int res, int capacity) {
+    if (res < 0 || res > MAX_H3_RES) return NULL;
+    H3Aggregate* agg = H3_MEMORY(malloc)(sizeof(H3Aggregate));
+    assert(agg != NULL);
+    agg->res = res;
+    agg->size = 0;
+    _aggregateAllocSlots(agg, capacity);
+    return agg;
+}
+
+/**
+ * Doubles the number of slots of an aggregate, rehashing its hexagons.
+ *
+ * @param agg The aggregate
+ */
+static void _aggregateGrow(H3Aggregate* agg) {
+    int oldNumSlots = agg->mask + 1;
+    H3AggregateSlot* oldSlots = agg->slots;
+    _aggregateAllocSlots(agg, oldNumSlots);
+    for (int i = 0; i < oldNumSlots; i++) {
+        if (oldSlots[i].cell == 0) continue;
+        int slot = (int)(_h3IndexHash(oldSlots[i].cell) & agg->mask);
+        while (agg->slots[slot].cell != 0) {
+            slot = (slot + 1) & agg->mask;
+        }
+        agg->slots[slot] = oldSlots[i];
+    }
+    H3_MEMORY(free)(oldSlots);
+}
+
+/**
+ * Finds the slot of a hexagon, adding it with a count and sum of 0 if it is
+ * not in the aggregate yet. The slot is valid until the next hexagon is
+ * added.
+ *
+ * @param agg The aggregate
+ * @param h The hexagon, not 0
+ * @return The slot
+ */
+static H3AggregateSlot* _aggregateSlot(H3Aggregate* agg, H3Index h) {
+    int slot = (int)(_h3IndexHash(h) & agg->mask);
+    while (agg->slots[slot].cell != 0) {
+        if (agg->slots[slot].cell == h) return &agg->slots[slot];
+        slot = (slot + 1) & agg->mask;
+    }
+    if (2 * (agg->size + 1) > agg->mask + 1) {
+        _aggregateGrow(agg);
+        slot = (int)(_h3IndexHash(h) & agg->mask);
+        while (agg->slots[slot].cell != 0) {
+            slot = (slot + 1) & agg->mask;
+        }
+    }
+    agg->slots[slot].cell = h;
+    agg->size++;
+    return &agg->slots[slot];
+}
+
+/**
+ * h3AggregatePoints encodes points at the resolution of an aggregate, and
+ * adds each to the count, and its value to the sum, of its hexagon. Points
+ * with non-finite coordinates are skipped.
+ *
+ * @param agg The aggregate
+ * @param lat The latitudes of the points, in radians
+ * @param lon The longitudes of the points, in radians
+ * @param values The values of the points, or NULL to only count them
+ * @param n The number of points
+ */
+void H3_EXPORT(h3AggregatePoints)(H3Aggregate* agg, const double* lat,
+                                  const double* lon, const double* values,
+                                  int n) {
+    H3Index cells[AGGREGATE_BLOCK_SIZE];
+    H3Index lastCell = 0;
+    H3AggregateSlot* last = NULL;
+    for (int start = 0; start < n; start += AGGREGATE_BLOCK_SIZE) {
+        int count = n - start;
+        if (count > AGGREGATE_BLOCK_SIZE) count = AGGREGATE_BLOCK_SIZE;
+        H3_EXPORT(geoToH3Batch)(lat + start, lon + start, count, agg->res,
+                                cells);
+        for (int i = 0; i < count; i++) {
+            H3Index h = cells[i];
+            if (h == 0) continue;
+            if (h != lastCell) {
+                last = _aggregateSlot(agg, h);
+                lastCell = h;
+            }
+            last->count++;
+            if (values) last->sum += values[start + i];
+        }
+    }
+}
+
+/**
+ * Adds a count and sum to a hexagon of an aggregate.
+ *
+ * @param agg The aggregate
+ * @param h The hexagon, not 0
+ * @param count The count
+ * @param sum The sum
+ */
+static void _aggregateAdd(H3Aggregate* agg, H3Index h, int64_t count,
+                          double sum) {
+    H3AggregateSlot* slot = _aggregateSlot(agg, h);
+    slot->count += count;
+    slot->sum += sum;
+}
+
+/**
+ * h3AggregateMerge adds the counts and sums of one aggregate to another of
+ * the same resolution.
+ *
+ * @param agg The aggregate added to
+ * @param other The aggregate added
+ * @return 0 on success, or -1 if the resolutions differ
+ */
+int H3_EXPORT(h3AggregateMerge)(H3Aggregate* agg, const H3Aggregate* other) {
+    if (agg->res != other->res) return -1;
+    for (int i = 0; i <= other->mask; i++) {
+        const H3AggregateSlot* slot = &other->slots[i];
+        if (slot->cell != 0) {
+            _aggregateAdd(agg, slot->cell, slot->count, slot->sum);
+        }
+    }
+    return 0;
+}
+
+/** @brief Shared state of a parallel aggregation */
+typedef struct {
+    const double* lat;     ///< the latitudes of the points
+    const double* lon;     ///< the longitudes of the points
+    const double* values;  ///< the values of the points, or NULL
+    int n;                 ///< the number of points
+    int numParts;          ///< the number of parts the points are split into
+    int res;               ///< the resolution of the hexagons
+    H3Aggregate** parts;   ///< the aggregate of each part
+} AggregateParallelData;
+
+/**
+ * Parallel task aggregating a range of parts, each into its own table.
+ *
+ * @param data The AggregateParallelData
+ * @param begin The first part
+ * @param end One past the last part
+ */
+static void _aggregateParallelTask(void* data, int begin, int end) {
+    AggregateParallelData* parallelData = data;
+    for (int part = begin; part < end; part++) {
+        int64_t n = parallelData->n;
+        int first = (int)(n * part / parallelData->numParts);
+        int last = (int)(n * (part + 1) / parallelData->numParts);
+        H3Aggregate* agg = H3_EXPORT(createH3Aggregate)(parallelData->res, 0);
+        H3_EXPORT(h3AggregatePoints)
+        (agg, parallelData->lat + first, parallelData->lon + first,
+         parallelData->values ? parallelData->values + first : NULL,
+         last - first);
+        parallelData->parts[part] = agg;
+    }
+}
+
+/**
+ * h3AggregatePointsParallel adds points to an aggregate as
+ * h3AggregatePoints does, with the points split into parts aggregated by
+ * parallelFor into tables of their own, then merged into the aggregate.
+ * parallelFor must call the given task on disjoint ranges covering [0, n)
+ * and return once all of them have completed. The ranges may run
+ * concurrently on any threads. If parallelFor is NULL, the points are
+ * aggregated on the calling thread.
+ *
+ * @param agg The aggregate
+ * @param lat The latitudes of the points, in radians
+ * @param lon The longitudes of the points, in radians
+ * @param values The values of the points, or NULL to only count them
+ * @param n The number of points
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ */
+void H3_EXPORT(h3AggregatePointsParallel)(H3Aggregate* agg, const double* lat,
+                                          const double* lon,
+                                          const double* values, int n,
+                                          H3ParallelFor parallelFor,
+                                          void* executor) {
+    int numParts = (n + AGGREGATE_PARALLEL_MIN_POINTS - 1) /
+                   AGGREGATE_PARALLEL_MIN_POINTS;
+    if (numParts > AGGREGATE_PARALLEL_MAX_PARTS) {
+        numParts = AGGREGATE_PARALLEL_MAX_PARTS;
+    }
+    if (parallelFor == NULL || numParts <= 1) {
+        H3_EXPORT(h3AggregatePoints)(agg, lat, lon, values, n);
+        return;
+    }
+
+    H3Aggregate* parts[AGGREGATE_PARALLEL_MAX_PARTS];
+    AggregateParallelData data = {lat,      lon,      values, n,
+                                  numParts, agg->res, parts};
+    parallelFor(executor, numParts, _aggregateParallelTask, &data);
+    for (int part = 0; part < numParts; part++) {
+        H3_EXPORT(h3AggregateMerge)(agg, parts[part]);
+        H3_EXPORT(destroyH3Aggregate)(parts[part]);
+    }
+}
+
+/**
+ * h3AggregateToParent rolls an aggregate up to a coarser resolution,
+ * combining the counts and sums of the hexagons with the same parent.
+ *
+ * @param agg The aggregate
+ * @param parentRes The resolution of the parents
+ * @return The aggregate of the parents, which the caller must free with
+ * destroyH3Aggregate, or NULL if parentRes is finer than the aggregate or
+ * invalid
+ */
+H3Aggregate* H3_EXPORT(h3AggregateToParent)(const H3Aggregate* agg,
+                                            int parentRes) {
+    if (parentRes < 0 || parentRes > agg->res) return NULL;
+    H3Aggregate* parents =
+        H3_EXPORT(createH3Aggregate)(parentRes, agg->size / 7);
+    for (int i = 0; i <= agg->mask; i++) {
+        const H3AggregateSlot* slot = &agg->slots[i];
+        if (slot->cell != 0) {
+            _aggregateAdd(parents, h3ToParentInline(slot->cell, parentRes),
+                          slot->count, slot->sum);
+        }
+    }
+    return parents;
+}
+
+/**
+ * h3AggregateGet finds the count and sum of a hexagon.
+ *
+ * @param agg The aggregate
+ * @param h The hexagon
+ * @param count Output: the number of points of the hexagon
+ * @param sum Output: the sum of their values
+ * @return 1 if the hexagon has points, or 0 with count and sum set to 0
+ */
+int H3_EXPORT(h3AggregateGet)(const H3Aggregate* agg, H3Index h,
+                              int64_t* count, double* sum) {
+    *count = 0;
+    *sum = 0;
+    if (h == 0) return 0;
+    int slot = (int)(_h3IndexHash(h) & agg->mask);
+    for (int probes = 0; probes <= agg->mask; probes++) {
+        const H3AggregateSlot* s = &agg->slots[slot];
+        if (s->cell == 0) return 0;
+        if (s->cell == h) {
+            *count = s->count;
+            *sum = s->sum;
+            return 1;
+        }
+        slot = (slot + 1) & agg->mask;
+    }
+    return 0;
+}
+
+/**
+ * h3AggregateSize returns the number of hexagons with points in an
+ * aggregate.
+ *
+ * @param agg The aggregate
+ * @return The number of hexagons
+ */
+int H3_EXPORT(h3AggregateSize)(const H3Aggregate* agg) { return agg->size; }
+
+/**
+ * h3AggregateToArrays writes the hexagons of an aggregate and their counts
+ * and sums, densely and in no particular order.
+ *
+ * @param agg The aggregate
+ * @param cells Output array of h3AggregateSize(agg) hexagons
+ * @param counts Output array of their counts, or NULL
+ * @param sums Output array of their sums, or NULL
+ * @return The number of hexagons written
+ */
+int H3_EXPORT(h3AggregateToArrays)(const H3Aggregate* agg, H3Index* cells,
+                                   int64_t* counts, double* sums) {
+    int numWritten = 0;
+    for (int i = 0; i <= agg->mask; i++) {
+        const H3AggregateSlot* slot = &agg->slots[i];
+        if (slot->cell == 0) continue;
+        cells[numWritten] = slot->cell;
+        if (counts) counts[numWritten] = slot->count;
+        if (sums) sums[numWritten] = slot->sum;
+        numWritten++;
+    }
+    return numWritten;
+}
+
+/**
+ * destroyH3Aggregate frees an aggregate.
+ *
+ * @param agg The aggregate
+ */
+void H3_EXPORT(destroyH3Aggregate)(H3Aggregate* agg) {
+    H3_MEMORY(free)(agg->slots);
+    H3_MEMORY(free)(agg);
+}
@@ -0,0 +1,436 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Bitmap.c
+ * @brief   Dense bitmaps of every hexagon of a coarse resolution
+ *
+ * The hexagons of a resolution are numbered from 0 by base cell, then by
+ * their digits read as a base 7 number. The descendants of a pentagon base
+ * cell skip the numbers of the deleted K axis subsequences, so that the
+ * ordinals are dense: the descendants whose first non center digit is at
+ * position r, with n digits after it, follow the ordinals of the
+ * _h3NumDescendants(1, n) hexagons with more leading center digits. The
+ * descendants of any hexagon then have a contiguous range of ordinals, and
+ * compacted sets are added and recovered a range at a time.
+ */
+
+#include "h3Bitmap.h"
+#include <assert.h>
+#include <string.h>
+#include "baseCells.h"
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+
+/**
+ * The number of set bits of a word. Without a popcount instruction enabled,
+ * __builtin_popcountll calls a library function, so the bits are counted in
+ * parallel instead, which compilers vectorize over a bitmap.
+ *
+ * @param x The word
+ * @return The number of set bits
+ */
+static inline int _popcount64(uint64_t x) {
+#if defined(__POPCNT__) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+    x = (x & UINT64_C(0x3333333333333333)) +
+        ((x >> 2) & UINT64_C(0x3333333333333333));
+    x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return (int)((x * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+/** 7 to the power of each number of levels */
+static const int64_t pow7[MAX_H3_RES + 1] = {
+    INT64_C(1), INT64_C(7), INT64_C(49), INT64_C(343), INT64_C(2401),
+    INT64_C(16807), INT64_C(117649), INT64_C(823543), INT64_C(5764801),
+    INT64_C(40353607), INT64_C(282475249), INT64_C(1977326743),
+    INT64_C(13841287201), INT64_C(96889010407), INT64_C(678223072849),
+    INT64_C(4747561509943),
+};
+
+/** The number of pentagons among the base cells numbered below each one */
+static const unsigned char pentagonsBefore[NUM_BASE_CELLS] = {
+    0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 12, 12, 12, 12,
+};
+
+/**
+ * The number of descendants of a hexagon some levels finer.
+ *
+ * @param isPentagon Whether the hexagon is a pentagon
+ * @param numLevels The number of resolutions finer
+ * @return The number of descendants
+ */
+int64_t _h3NumDescendants(int isPentagon, int numLevels) {
+    if (!isPentagon) return pow7[numLevels];
+    return 1 + 5 * (pow7[numLevels] - 1) / 6;
+}
+
+/**
+ * The ordinal of the first hexagon of a base cell at a resolution.
+ *
+ * @param baseCell The base cell
+ * @param res The resolution
+ * @return The ordinal
+ */
+static int64_t _baseCellOrdinal(int baseCell, int res) {
+    int numPentagons = pentagonsBefore[baseCell];
+    return (baseCell - numPentagons) * pow7[res] +
+           numPentagons * _h3NumDescendants(1, res);
+}
+
+/**
+ * h3ToOrdinal numbers the hexagons of each resolution densely, from 0 to
+ * numHexagons(res) - 1, in the order of their base cells and digits.
+ *
+ * @param h The hexagon
+ * @return The ordinal of the hexagon among those of its resolution
+ */
+int64_t H3_EXPORT(h3ToOrdinal)(H3Index h) {
+    int res = H3_GET_RESOLUTION(h);
+    int baseCell = H3_GET_BASE_CELL(h);
+    int64_t value = 0;
+    int firstNonCenter = 0;
+    for (int r = 1; r <= res; r++) {
+        int digit = H3_GET_INDEX_DIGIT(h, r);
+        if (!firstNonCenter && digit != CENTER_DIGIT) firstNonCenter = r;
+        value = value * 7 + digit;
+    }
+    if (_isBaseCellPentagon(baseCell) && firstNonCenter) {
+        // Skip the K axis subsequences starting at the first non center
+        // digit, and those with more leading center digits
+        int n = res - firstNonCenter;
+        value += _h3NumDescendants(1, n) - 2 * pow7[n];
+    }
+    return _baseCellOrdinal(baseCell, res) + value;
+}
+
+/**
+ * ordinalToH3 finds the hexagon of a resolution numbered by h3ToOrdinal.
+ *
+ * @param ordinal The ordinal, from 0 to numHexagons(res) - 1
+ * @param res The resolution
+ * @return The hexagon, or 0 if the resolution or ordinal is out of range
+ */
+H3Index H3_EXPORT(ordinalToH3)(int64_t ordinal, int res) {
+    if (res < 0 || res > MAX_H3_RES || ordinal < 0 ||
+        ordinal >= H3_EXPORT(numHexagons)(res)) {
+        return H3_INVALID_INDEX;
+    }
+    // The last base cell starting at or before the ordinal
+    int lo = 0;
+    int hi = NUM_BASE_CELLS - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (_baseCellOrdinal(mid, res) <= ordinal) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    int baseCell = lo;
+    int64_t value = ordinal - _baseCellOrdinal(baseCell, res);
+    if (_isBaseCellPentagon(baseCell) && value > 0) {
+        // The number of digits after the first non center digit
+        int n = 0;
+        while (_h3NumDescendants(1, n + 1) <= value) n++;
+        value += 2 * pow7[n] - _h3NumDescendants(1, n);
+    }
+
+    H3Index h = H3_INIT;
+    H3_SET_MODE(h, H3_HEXAGON_MODE);
+    H3_SET_RESOLUTION(h, res);
+    H3_SET_BASE_CELL(h, baseCell);
+    for (int r = res; r > 0; r--) {
+        H3_SET_INDEX_DIGIT(h, r, value % 7);
+        value /= 7;
+    }
+    return h;
+}
+
+/**
+ * createH3Bitmap creates an empty bitmap of the hexagons of a resolution.
+ *
+ * @param res The resolution, at most H3_BITMAP_MAX_RES
+ * @return The bitmap, which the caller must free with destroyH3Bitmap, or
+ * NULL if the resolution is out of range
+ */
+H3Bitmap* H3_EXPORT(createH3Bitmap)(int res) {
+    if (res < 0 || res > H3_BITMAP_MAX_RES) return NULL;
+    H3Bitmap* bitmap = H3_MEMORY(malloc)(sizeof(H3Bitmap));
+    assert(bitmap != NULL);
+    bitmap->res = res;
+    bitmap->numBits = H3_EXPORT(numHexagons)(res);
+    bitmap->words = H3_MEMORY(calloc)((size_t)(bitmap->numBits + 63) / 64,
+                                      sizeof(uint64_t));
+    assert(bitmap->words != NULL);
+    return bitmap;
+}
+
+/**
+ * h3BitmapAdd adds a hexagon of the resolution of a bitmap to it.
+ *
+ * @param bitmap The bitmap
+ * @param h The hexagon
+ * @return 1 if the hexagon was added, 0 if it was already present, or -1 if
+ * it is not of the resolution of the bitmap
+ */
+int H3_EXPORT(h3BitmapAdd)(H3Bitmap* bitmap, H3Index h) {
+    if (H3_GET_RESOLUTION(h) != bitmap->res) return -1;
+    int64_t ordinal = H3_EXPORT(h3ToOrdinal)(h);
+    uint64_t bit = UINT64_C(1) << (ordinal % 64);
+    uint64_t* word = &bitmap->words[ordinal / 64];
+    if (*word & bit) return 0;
+    *word |= bit;
+    return 1;
+}
+
+/**
+ * h3BitmapContains tests whether a bitmap holds a hexagon.
+ *
+ * @param bitmap The bitmap
+ * @param h The hexagon
+ * @return 1 if the bitmap holds the hexagon, 0 otherwise, including for
+ * hexagons of other resolutions
+ */
+int H3_EXPORT(h3BitmapContains)(const H3Bitmap* bitmap, H3Index h) {
+    if (H3_GET_RESOLUTION(h) != bitmap->res) return 0;
+    int64_t ordinal = H3_EXPORT(h3ToOrdinal)(h);
+    return (bitmap->words[ordinal / 64] >> (ordinal % 64)) & 1;
+}
+
+/**
+ * The mask of the bits of a word from a start bit up to an end bit.
+ *
+ * @param start The first bit, from 0 to 63
+ * @param end One past the last bit, from start + 1 to 64
+ */
+static uint64_t _bitRange(int start, int end) {
+    uint64_t high = end == 64 ? ~UINT64_C(0) : (UINT64_C(1) << end) - 1;
+    return high & ~((UINT64_C(1) << start) - 1);
+}
+
+/**
+ * Sets the bits of a range of ordinals, whole words at a time.
+ *
+ * @param words The bits
+ * @param start The first ordinal
+ * @param end One past the last ordinal
+ */
+static void _setRange(uint64_t* words, int64_t start, int64_t end) {
+    int64_t first = start / 64;
+    int64_t last = (end - 1) / 64;
+    if (first == last) {
+        words[first] |= _bitRange(start % 64, (end - 1) % 64 + 1);
+        return;
+    }
+    words[first] |= _bitRange(start % 64, 64);
+    for (int64_t w = first + 1; w < last; w++) words[w] = ~UINT64_C(0);
+    words[last] |= _bitRange(0, (end - 1) % 64 + 1);
+}
+
+/**
+ * Counts the set bits of a range of ordinals, stopping early once the count
+ * is known to be neither 0 nor the whole range.
+ *
+ * @param words The bits
+ * @param start The first ordinal
+ * @param end One past the last ordinal
+ * @return 0 if no bit is set, 1 if every bit is set, and -1 otherwise
+ */
+static int _rangeState(const uint64_t* words, int64_t start, int64_t end) {
+    int64_t first = start / 64;
+    int64_t last = (end - 1) / 64;
+    int any = 0;
+    int all = 1;
+    for (int64_t w = first; w <= last; w++) {
+        uint64_t mask = _bitRange(w == first ? start % 64 : 0,
+                                  w == last ? (end - 1) % 64 + 1 : 64);
+        uint64_t bits = words[w] & mask;
+        if (bits) any = 1;
+        if (bits != mask) all = 0;
+        if (any && !all) return -1;
+    }
+    return all;
+}
+
+/**
+ * h3BitmapAddCompact adds every hexagon of the resolution of a bitmap
+ * covered by a set of hexagons of that or coarser resolutions, such as the
+ * output of compact.
+ *
+ * @param bitmap The bitmap
+ * @param compactedSet The hexagons
+ * @param numHexes The number of hexagons
+ * @return 0 on success, or -1 if a hexagon is finer than the bitmap, when
+ * the hexagons before it have been added
+ */
+int H3_EXPORT(h3BitmapAddCompact)(H3Bitmap* bitmap,
+                                  const H3Index* compactedSet,
+                                  const int numHexes) {
+    for (int i = 0; i < numHexes; i++) {
+        H3Index h = compactedSet[i];
+        if (h == H3_INVALID_INDEX) continue;
+        int res = H3_GET_RESOLUTION(h);
+        if (res > bitmap->res) return -1;
+        // The first descendant is the central one
+        H3Index first = h;
+        H3_SET_RESOLUTION(first, bitmap->res);
+        for (int r = res + 1; r <= bitmap->res; r++) {
+            H3_SET_INDEX_DIGIT(first, r, CENTER_DIGIT);
+        }
+        int64_t start = H3_EXPORT(h3ToOrdinal)(first);
+        int64_t count = _h3NumDescendants(H3_EXPORT(h3IsPentagon)(h),
+                                          bitmap->res - res);
+        _setRange(bitmap->words, start, start + count);
+    }
+    return 0;
+}
+
+/**
+ * h3BitmapUnion adds the hexagons of one bitmap to another of the same
+ * resolution, a word at a time.
+ *
+ * @param bitmap The bitmap added to
+ * @param other The bitmap added
+ * @return 0 on success, or -1 if the resolutions differ
+ */
+int H3_EXPORT(h3BitmapUnion)(H3Bitmap* bitmap, const H3Bitmap* other) {
+    if (bitmap->res != other->res) return -1;
+    int64_t numWords = (bitmap->numBits + 63) / 64;
+    for (int64_t w = 0; w < numWords; w++) {
+        bitmap->words[w] |= other->words[w];
+    }
+    return 0;
+}
+
+/**
+ * h3BitmapIntersection removes the hexagons from a bitmap that are not in
+ * another of the same resolution, a word at a time.
+ *
+ * @param bitmap The bitmap removed from
+ * @param other The bitmap intersected with
+ * @return 0 on success, or -1 if the resolutions differ
+ */
+int H3_EXPORT(h3BitmapIntersection)(H3Bitmap* bitmap, const H3Bitmap* other) {
+    if (bitmap->res != other->res) return -1;
+    int64_t numWords = (bitmap->numBits + 63) / 64;
+    for (int64_t w = 0; w < numWords; w++) {
+        bitmap->words[w] &= other->words[w];
+    }
+    return 0;
+}
+
+/**
+ * h3BitmapCount returns the number of hexagons in a bitmap.
+ *
+ * @param bitmap The bitmap
+ * @return The number of hexagons
+ */
+int64_t H3_EXPORT(h3BitmapCount)(const H3Bitmap* bitmap) {
+    int64_t numWords = (bitmap->numBits + 63) / 64;
+    int64_t count = 0;
+    for (int64_t w = 0; w < numWords; w++) {
+        count += _popcount64(bitmap->words[w]);
+    }
+    return count;
+}
+
+/** @brief The hexagons written by h3BitmapToCompact */
+typedef struct {
+    H3Index* out;  ///< the hexagons written
+    int numHexes;  ///< the number of hexagons written
+    int maxHexes;  ///< the number of hexagons out holds
+} CompactOutput;
+
+/**
+ * Writes the largest hexagons covering the hexagons of a bitmap that are
+ * descendants of a hexagon.
+ *
+ * @param bitmap The bitmap
+ * @param h The hexagon
+ * @param start The ordinal of its first descendant in the bitmap
+ * @param output The hexagons written
+ * @return 0 on success, or -1 if output is full
+ */
+static int _bitmapToCompact(const H3Bitmap* bitmap, H3Index h, int64_t start,
+                            CompactOutput* output) {
+    int res = H3_GET_RESOLUTION(h);
+    int isPentagon = H3_EXPORT(h3IsPentagon)(h);
+    int64_t count = _h3NumDescendants(isPentagon, bitmap->res - res);
+    int state = _rangeState(bitmap->words, start, start + count);
+    if (state == 0) return 0;
+    if (state == 1) {
+        if (output->numHexes == output->maxHexes) return -1;
+        output->out[output->numHexes++] = h;
+        return 0;
+    }
+    // The children are numbered in order of their digits, the central
+    // child of a pentagon being a pentagon and its K axis child deleted
+    H3Index child = h;
+    H3_SET_RESOLUTION(child, res + 1);
+    for (int d = CENTER_DIGIT; d <= IJ_AXES_DIGIT; d++) {
+        if (isPentagon && d == K_AXES_DIGIT) continue;
+        H3_SET_INDEX_DIGIT(child, res + 1, d);
+        if (_bitmapToCompact(bitmap, child, start, output)) return -1;
+        start += _h3NumDescendants(isPentagon && d == CENTER_DIGIT,
+                                   bitmap->res - res - 1);
+    }
+    return 0;
+}
+
+/**
+ * h3BitmapToCompact writes the hexagons of a bitmap compacted, replacing
+ * every complete set of children with their parent as compact does. The
+ * hexagons are written in the order of their ordinals.
+ *
+ * @param bitmap The bitmap
+ * @param out Output array of up to maxHexes hexagons
+ * @param maxHexes The number of hexagons out holds
+ * @return The number of hexagons written, or -1 if there are more than
+ * maxHexes
+ */
+int H3_EXPORT(h3BitmapToCompact)(const H3Bitmap* bitmap, H3Index* out,
+                                 const int maxHexes) {
+    CompactOutput output = {out, 0, maxHexes};
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index h;
+        setH3Index(&h, 0, baseCell, CENTER_DIGIT);
+        if (_bitmapToCompact(bitmap, h, _baseCellOrdinal(baseCell, bitmap->res),
+                             &output)) {
+            return -1;
+        }
+    }
+    return output.numHexes;
+}
+
+/**
+ * destroyH3Bitmap frees a bitmap returned by createH3Bitmap.
+ *
+ * @param bitmap The bitmap
+ */
+void H3_EXPORT(destroyH3Bitmap)(H3Bitmap* bitmap) {
+    H3_MEMORY(free)(bitmap->words);
+    H3_MEMORY(free)(bitmap);
+}
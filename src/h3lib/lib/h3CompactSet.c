@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3CompactSet.c
+ * @brief   Sets of hexagons of a resolution kept compacted as they change
+ *
+ * The set holds the compacted form of the hexagons added to it, as `compact`
+ * would write it: no hexagon held is the ancestor of another, and no hexagon
+ * has all of its children held. Adding a hexagon replaces each complete
+ * group of siblings above it with their parent, and removing a hexagon held
+ * only through an ancestor replaces that ancestor with the siblings of each
+ * hexagon on the path down to it. Both look at no more than the 7 children
+ * of each ancestor, so neither recompacts the whole set.
+ */
+
+#include "h3CompactSet.h"
+#include <assert.h>
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+
+/**
+ * createH3CompactSet creates an empty set of hexagons of a resolution.
+ *
+ * @param res The resolution of the hexagons added and removed
+ * @return The set, which the caller must free with destroyH3CompactSet, or
+ * NULL if the resolution is out of range
+ */
+H3CompactSet* H3_EXPORT(createH3CompactSet)(int res) {
+    if (res < 0 || res > MAX_H3_RES) return NULL;
+    H3CompactSet* set = H3_MEMORY(malloc)(sizeof(H3CompactSet));
+    assert(set != NULL);
+    set->res = res;
+    set->hexes = H3_EXPORT(createH3IndexSet)(0);
+    return set;
+}
+
+/**
+ * The resolution of the hexagon held that is, or is an ancestor of, a
+ * hexagon.
+ *
+ * @param set The set
+ * @param h The hexagon, of the resolution of the set or coarser
+ * @return The resolution of the hexagon held, or -1 if there is none
+ */
+static int _h3CompactSetHolder(const H3CompactSet* set, H3Index h) {
+    for (int r = H3_GET_RESOLUTION(h); r >= 0; r--) {
+        if (H3_EXPORT(h3IndexSetContains)(set->hexes,
+                                          H3_EXPORT(h3ToParent)(h, r))) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Whether a hexagon of the set's resolution may be added or removed.
+ *
+ * @param set The set
+ * @param h The hexagon
+ * @return 1 if it is a valid hexagon of the resolution of the set
+ */
+static int _h3CompactSetAccepts(const H3CompactSet* set, H3Index h) {
+    return H3_EXPORT(h3IsValid)(h) && H3_GET_RESOLUTION(h) == set->res;
+}
+
+/**
+ * h3CompactSetAdd adds a hexagon to a set. While every child of the parent
+ * of the hexagon added is held, the children are replaced by the parent.
+ *
+ * @param set The set
+ * @param h The hexagon, of the resolution of the set
+ * @return 1 if the hexagon was added, 0 if it was already in the set, or -1
+ * if it is not a valid hexagon of the resolution of the set
+ */
+int H3_EXPORT(h3CompactSetAdd)(H3CompactSet* set, H3Index h) {
+    if (!_h3CompactSetAccepts(set, h)) return -1;
+    if (_h3CompactSetHolder(set, h) >= 0) return 0;
+    H3_EXPORT(h3IndexSetAdd)(set->hexes, h);
+    for (int r = set->res; r > 0; r--) {
+        H3Index parent = H3_EXPORT(h3ToParent)(h, r - 1);
+        // Pentagons leave the slot of their deleted child 0
+        H3Index children[7] = {0};
+        H3_EXPORT(h3ToChildren)(parent, r, children);
+        for (int i = 0; i < 7; i++) {
+            if (children[i] != 0 &&
+                !H3_EXPORT(h3IndexSetContains)(set->hexes, children[i])) {
+                return 1;
+            }
+        }
+        for (int i = 0; i < 7; i++) {
+            H3_EXPORT(h3IndexSetRemove)(set->hexes, children[i]);
+        }
+        H3_EXPORT(h3IndexSetAdd)(set->hexes, parent);
+    }
+    return 1;
+}
+
+/**
+ * h3CompactSetRemove removes a hexagon from a set. If the hexagon is held
+ * through an ancestor, the ancestor is replaced by the children of each
+ * hexagon on the path down to the one removed, except those on the path.
+ *
+ * @param set The set
+ * @param h The hexagon, of the resolution of the set
+ * @return 1 if the hexagon was removed, 0 if it was not in the set, or -1
+ * if it is not a valid hexagon of the resolution of the set
+ */
+int H3_EXPORT(h3CompactSetRemove)(H3CompactSet* set, H3Index h) {
+    if (!_h3CompactSetAccepts(set, h)) return -1;
+    int holderRes = _h3CompactSetHolder(set, h);
+    if (holderRes < 0) return 0;
+    H3_EXPORT(h3IndexSetRemove)(set->hexes,
+                                H3_EXPORT(h3ToParent)(h, holderRes));
+    for (int r = holderRes + 1; r <= set->res; r++) {
+        H3Index onPath = H3_EXPORT(h3ToParent)(h, r);
+        H3Index children[7] = {0};
+        H3_EXPORT(h3ToChildren)(H3_EXPORT(h3ToParent)(h, r - 1), r,
+                                children);
+        for (int i = 0; i < 7; i++) {
+            if (children[i] != onPath) {
+                H3_EXPORT(h3IndexSetAdd)(set->hexes, children[i]);
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * h3CompactSetContains tests whether a set covers a hexagon, of any
+ * resolution: whether the hexagon or one of its ancestors is held.
+ *
+ * @param set The set
+ * @param h The hexagon
+ * @return 1 if the set covers the whole hexagon, 0 otherwise
+ */
+int H3_EXPORT(h3CompactSetContains)(const H3CompactSet* set, H3Index h) {
+    if (h == 0) return 0;
+    int res = H3_GET_RESOLUTION(h);
+    if (res > set->res) h = H3_EXPORT(h3ToParent)(h, set->res);
+    return _h3CompactSetHolder(set, h) >= 0;
+}
+
+/**
+ * h3CompactSetSize returns the number of compacted hexagons of a set.
+ *
+ * @param set The set
+ * @return The number of hexagons h3CompactSetToArray writes
+ */
+int H3_EXPORT(h3CompactSetSize)(const H3CompactSet* set) {
+    return H3_EXPORT(h3IndexSetSize)(set->hexes);
+}
+
+/**
+ * h3CompactSetToArray writes the compacted hexagons of a set, sorted by
+ * h3ToOrderKey.
+ *
+ * @param set The set
+ * @param out Output array of h3CompactSetSize(set) indexes
+ * @return The number of hexagons written
+ */
+int H3_EXPORT(h3CompactSetToArray)(const H3CompactSet* set, H3Index* out) {
+    int numHexes = H3_EXPORT(h3IndexSetToArray)(set->hexes, out);
+    H3_EXPORT(h3SortCells)(out, numHexes);
+    return numHexes;
+}
+
+/**
+ * destroyH3CompactSet frees a set returned by createH3CompactSet.
+ *
+ * @param set The set
+ */
+void H3_EXPORT(destroyH3CompactSet)(H3CompactSet* set) {
+    H3_EXPORT(destroyH3IndexSet)(set->hexes);
+    H3_MEMORY(free)(set);
+}
@@ -18,13 +18,21 @@
  *          (see h3api.h for the main library entry functions)
  */
 #include "h3Index.h"
-#include <inttypes.h>
+#include <assert.h>
+#include <stdint.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "baseCells.h"
 #include "faceijk.h"
-#include "mathExtensions.h"
+#include "h3Alloc.h"
+#include "h3api_inline.h"
+#include "h3SortedSet.h"
+#include "h3Stats.h"
+#include "scratch.h"
 #include "stackAlloc.h"
 
 /**
@@ -32,25 +40,122 @@
  * @param h The H3 index.
  * @return The resolution of the H3 index argument.
  */
-int H3_EXPORT(h3GetResolution)(H3Index h) { return H3_GET_RESOLUTION(h); }
+int H3_EXPORT(h3GetResolution)(H3Index h) {
+    return h3GetResolutionInline(h);
+}
+
+/**
+ * Returns the H3 resolutions of an array of H3 indexes.
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param out Output array of n resolutions.
+ */
+void H3_EXPORT(h3GetResolutionBatch)(const H3Index* h3, int n, int* out) {
+    for (int i = 0; i < n; i++) out[i] = H3_GET_RESOLUTION(h3[i]);
+}
 
 /**
  * Returns the H3 base cell number of an H3 index.
  * @param h The H3 index.
  * @return The base cell of the H3 index argument.
  */
-int H3_EXPORT(h3GetBaseCell)(H3Index h) { return H3_GET_BASE_CELL(h); }
+int H3_EXPORT(h3GetBaseCell)(H3Index h) { return h3GetBaseCellInline(h); }
+
+/** hexadecimal digits, indexed by value */
+static const char _hexDigits[16] = "0123456789abcdef";
+
+/** values plus one of hexadecimal digits, indexed by character; 0 for
+ * characters that are not hexadecimal digits */
+static const uint8_t _hexDigitValues[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,
+    ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10, ['a'] = 11, ['b'] = 12,
+    ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16, ['A'] = 11, ['B'] = 12,
+    ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16};
+
+/**
+ * Parses the hexadecimal digits at the start of a string.
+ *
+ * @param str The digits
+ * @param len The maximum number of characters to read
+ * @param out The value of the digits, or 0 if there are more than 16
+ *            significant digits
+ * @return The number of characters read
+ */
+static size_t _parseHexDigits(const char* str, size_t len, H3Index* out) {
+    size_t i = 0;
+    // leading zeros do not count toward the 16 digit limit
+    while (i < len && str[i] == '0') i++;
+    size_t first = i;
+    H3Index h = 0;
+    unsigned int value;
+    while (i < len && (value = _hexDigitValues[(unsigned char)str[i]]) != 0) {
+        h = h << 4 | (value - 1);
+        i++;
+    }
+    *out = i - first > 16 ? H3_INVALID_INDEX : h;
+    return i;
+}
+
+/**
+ * Parses an H3 index from at most len characters, accepting leading white
+ * space and a 0x prefix as sscanf with PRIx64 does.
+ */
+static H3Index _stringToH3(const char* str, size_t len) {
+    size_t i = 0;
+    while (i < len && (str[i] == ' ' || (str[i] >= '\t' && str[i] <= '\r'))) {
+        i++;
+    }
+    if (i + 2 < len && str[i] == '0' &&
+        (str[i + 1] == 'x' || str[i + 1] == 'X') &&
+        _hexDigitValues[(unsigned char)str[i + 2]] != 0) {
+        i += 2;
+    }
+    H3Index h;
+    _parseHexDigits(&str[i], len - i, &h);
+    return h;
+}
+
+/**
+ * Parses an H3 index from a string of exactly the hexadecimal digits of a
+ * valid cell, ending at the first NUL or after len characters.
+ *
+ * @return The index, or 0 if the string is anything else
+ */
+static H3Index _stringToH3Strict(const char* str, size_t len) {
+    H3Index h;
+    size_t numDigits = _parseHexDigits(str, len, &h);
+    if (numDigits == 0 || (numDigits < len && str[numDigits] != '\0') ||
+        !H3_EXPORT(h3IsValid)(h)) {
+        return H3_INVALID_INDEX;
+    }
+    return h;
+}
+
+/**
+ * Writes the lowercase hexadecimal digits of an index, NUL terminated, to
+ * a buffer of at least 17 characters.
+ */
+static void _formatHex(H3Index h, char* str) {
+    int numDigits = 1;
+    while (numDigits < 16 && (h >> (4 * numDigits)) != 0) numDigits++;
+    str[numDigits] = '\0';
+    for (int i = numDigits - 1; i >= 0; i--) {
+        str[i] = _hexDigits[h & 0xf];
+        h >>= 4;
+    }
+}
 
 /**
  * Converts a string representation of an H3 index into an H3 index.
+ *
+ * Leading white space and a 0x prefix are skipped, and parsing stops at the
+ * first character that is not a hexadecimal digit.
+ *
  * @param str The string representation of an H3 index.
  * @return The H3 index corresponding to the string argument, or 0 if invalid.
  */
 H3Index H3_EXPORT(stringToH3)(const char* str) {
-    H3Index h = H3_INVALID_INDEX;
-    // If failed, h will be unmodified and we should return 0 anyways.
-    sscanf(str, "%" PRIx64, &h);
-    return h;
+    return _stringToH3(str, SIZE_MAX);
 }
 
 /**
@@ -66,34 +171,161 @@ void H3_EXPORT(h3ToString)(H3Index h, char* str, size_t sz) {
         // Buffer is potentially not large enough.
         return;
     }
-    sprintf(str, "%" PRIx64, h);
+    _formatHex(h, str);
+}
+
+/**
+ * Converts an array of fixed width strings into H3 indexes.
+ *
+ * String i starts at strs + i * stride and ends at its first NUL or after
+ * stride characters, so records need not be NUL terminated.
+ *
+ * Without strict, each string is parsed as by stringToH3. With strict, a
+ * string must consist of exactly the hexadecimal digits of a valid cell,
+ * which replaces a separate h3IsValid pass over the output.
+ *
+ * @param strs The strings
+ * @param stride The distance in characters between the starts of strings
+ * @param n The number of strings
+ * @param strict Whether to only accept the digits of valid cells
+ * @param out Output array of n indexes, 0 for strings that are not accepted
+ * @return The number of 0 indexes written
+ */
+int H3_EXPORT(stringToH3Batch)(const char* strs, size_t stride, int n,
+                               int strict, H3Index* out) {
+    int numInvalid = 0;
+    for (int i = 0; i < n; i++) {
+        const char* str = &strs[i * stride];
+        out[i] = strict ? _stringToH3Strict(str, stride)
+                        : _stringToH3(str, stride);
+        numInvalid += out[i] == H3_INVALID_INDEX;
+    }
+    return numInvalid;
+}
+
+/**
+ * Converts an array of H3 indexes into NUL terminated strings at a fixed
+ * stride, as by h3ToString.
+ *
+ * @param h3 The indexes
+ * @param n The number of indexes
+ * @param strs Output buffer of n * stride characters
+ * @param stride The distance in characters between the starts of strings,
+ *               at least 17. Nothing is written if it is smaller.
+ */
+void H3_EXPORT(h3ToStringBatch)(const H3Index* h3, int n, char* strs,
+                                size_t stride) {
+    if (stride < 17) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        _formatHex(h3[i], &strs[i * stride]);
+    }
 }
 
 /**
  * Returns whether or not an H3 index is valid.
+ *
+ * Indexes of pentagons whose leading nonzero digit is 1 are not valid, as
+ * that subsequence of the pentagon is deleted.
+ *
  * @param h The H3 index to validate.
  * @return 1 if the H3 index if valid, and 0 if it is not.
  */
-int H3_EXPORT(h3IsValid)(H3Index h) {
-    if (H3_GET_MODE(h) != H3_HEXAGON_MODE) return 0;
+int H3_EXPORT(h3IsValid)(H3Index h) { return h3IsValidInline(h); }
 
-    int baseCell = H3_GET_BASE_CELL(h);
-    if (baseCell < 0 || baseCell >= NUM_BASE_CELLS) return 0;
+#ifdef __AVX2__
+/**
+ * h3IsValidInline for four indexes at once.
+ *
+ * @param h3 The four H3 indexes to validate.
+ * @return A bit for each index, set if it is a valid cell.
+ */
+static int _h3IsValidAvx2(const H3Index* h3) {
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i h = _mm256_loadu_si256((const __m256i*)h3);
+    __m256i mode = _mm256_and_si256(_mm256_srli_epi64(h, H3_MODE_OFFSET),
+                                    _mm256_set1_epi64x(15));
+    __m256i baseCell = _mm256_and_si256(_mm256_srli_epi64(h, H3_BC_OFFSET),
+                                        _mm256_set1_epi64x(127));
+    __m256i res = _mm256_and_si256(_mm256_srli_epi64(h, H3_RES_OFFSET),
+                                   _mm256_set1_epi64x(15));
 
-    int res = H3_GET_RESOLUTION(h);
-    if (res < 0 || res > MAX_H3_RES) return 0;
+    __m256i unusedDigits =
+        _mm256_sub_epi64(_mm256_set1_epi64x(MAX_H3_RES), res);
+    __m256i unusedBits = _mm256_add_epi64(
+        unusedDigits, _mm256_slli_epi64(unusedDigits, 1));
+    __m256i unusedMask =
+        _mm256_sub_epi64(_mm256_sllv_epi64(one, unusedBits), one);
+    __m256i digits =
+        _mm256_and_si256(h, _mm256_set1_epi64x(H3_INLINE_DIGIT_BITS));
+    __m256i used = _mm256_andnot_si256(unusedMask, digits);
+    __m256i sevens = _mm256_and_si256(
+        _mm256_and_si256(used, _mm256_srli_epi64(used, 1)),
+        _mm256_and_si256(_mm256_srli_epi64(used, 2),
+                         _mm256_set1_epi64x(H3_INLINE_DIGIT_LOW_BITS)));
 
-    for (int r = 1; r <= res; r++) {
-        int digit = H3_GET_INDEX_DIGIT(h, r);
-        if (digit < 0 || digit > 6) return 0;
-    }
+    __m256i smeared = used;
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 1));
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 2));
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 4));
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 8));
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 16));
+    smeared = _mm256_or_si256(smeared, _mm256_srli_epi64(smeared, 32));
+    __m256i highestBit =
+        _mm256_xor_si256(smeared, _mm256_srli_epi64(smeared, 1));
+    // variable shifts of 64 or more give 0, so exactly one of these
+    // selects the pentagon bit of the base cell
+    __m256i isPentagon = _mm256_and_si256(
+        _mm256_or_si256(
+            _mm256_srlv_epi64(_mm256_set1_epi64x(H3_INLINE_PENTAGONS_LOW),
+                              baseCell),
+            _mm256_srlv_epi64(
+                _mm256_set1_epi64x(H3_INLINE_PENTAGONS_HIGH),
+                _mm256_sub_epi64(baseCell, _mm256_set1_epi64x(64)))),
+        one);
+    __m256i leadingOne = _mm256_and_si256(
+        highestBit, _mm256_set1_epi64x(H3_INLINE_DIGIT_LOW_BITS));
+    __m256i deleted = _mm256_andnot_si256(
+        _mm256_cmpeq_epi64(leadingOne, _mm256_setzero_si256()),
+        _mm256_cmpeq_epi64(isPentagon, one));
 
-    for (int r = res + 1; r <= MAX_H3_RES; r++) {
-        int digit = H3_GET_INDEX_DIGIT(h, r);
-        if (digit != 7) return 0;
-    }
+    __m256i valid = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_cmpeq_epi64(mode, _mm256_set1_epi64x(H3_HEXAGON_MODE)),
+            _mm256_cmpgt_epi64(_mm256_set1_epi64x(NUM_BASE_CELLS), baseCell)),
+        _mm256_and_si256(
+            _mm256_cmpeq_epi64(_mm256_and_si256(digits, unusedMask),
+                               unusedMask),
+            _mm256_cmpeq_epi64(sevens, _mm256_setzero_si256())));
+    valid = _mm256_andnot_si256(deleted, valid);
+    return _mm256_movemask_pd(_mm256_castsi256_pd(valid));
+}
+#endif
 
-    return 1;
+/**
+ * Validates an array of H3 indexes, as by h3IsValid.
+ *
+ * When compiled for AVX2, four indexes are validated per iteration.
+ *
+ * @param h3 The H3 indexes to validate.
+ * @param n The number of indexes.
+ * @param out Output array of n flags, 1 for valid indexes and 0 otherwise.
+ */
+void H3_EXPORT(h3IsValidBatch)(const H3Index* h3, int n, uint8_t* out) {
+    int i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= n; i += 4) {
+        int valid = _h3IsValidAvx2(&h3[i]);
+        out[i] = valid & 1;
+        out[i + 1] = (valid >> 1) & 1;
+        out[i + 2] = (valid >> 2) & 1;
+        out[i + 3] = (valid >> 3) & 1;
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = (uint8_t)h3IsValidInline(h3[i]);
+    }
 }
 
 /**
@@ -112,6 +344,9 @@ void setH3Index(H3Index* hp, int res, int baseCell, int initDigit) {
     *hp = h;
 }
 
+/** indexes per block of h3ToParentsBatch, 8 KiB of input */
+#define PARENTS_BLOCK_SIZE 1024
+
 /**
  * h3ToParent produces the parent index for a given H3 index
  *
@@ -121,21 +356,140 @@ void setH3Index(H3Index* hp, int res, int baseCell, int initDigit) {
  * @return H3Index of the parent, or 0 if you actually asked for a child
  */
 H3Index H3_EXPORT(h3ToParent)(H3Index h, int parentRes) {
-    int childRes = H3_GET_RESOLUTION(h);
-    if (parentRes > childRes) {
-        return H3_INVALID_INDEX;
-    } else if (parentRes == childRes) {
-        return h;
-    } else if (parentRes < 0 || parentRes > MAX_H3_RES) {
-        return H3_INVALID_INDEX;
+    return h3ToParentInline(h, parentRes);
+}
+
+/**
+ * Shared state of the parallel batch functions. Each function uses only the
+ * fields of its own inputs and outputs.
+ */
+typedef struct {
+    const H3Index* h3;  ///< the input indexes
+    const double* lat;  ///< the input latitudes
+    const double* lon;  ///< the input longitudes
+    int res;            ///< the resolution to index or find parents at
+    H3Index* out;       ///< the output indexes
+    double* outLat;     ///< the output latitudes
+    double* outLon;     ///< the output longitudes
+    double* verts;      ///< the output vertices, at a fixed stride per index
+    int* numVerts;      ///< the output vertex counts
+} BatchParallelData;
+
+/**
+ * Runs a parallel batch task over [0, n), by calling parallelFor if it is
+ * not NULL and on the calling thread otherwise.
+ *
+ * @param n The number of items
+ * @param task The task
+ * @param data The BatchParallelData
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ */
+static void _batchParallelFor(int n, H3ParallelTask task,
+                              BatchParallelData* data,
+                              H3ParallelFor parallelFor, void* executor) {
+    if (n <= 0) return;
+    if (parallelFor == NULL) {
+        task(data, 0, n);
+    } else {
+        parallelFor(executor, n, task, data);
+    }
+}
+
+/**
+ * h3ToParentBatch produces the parent indexes at one resolution for an
+ * array of H3 indexes, as by h3ToParent.
+ *
+ * @param h3 H3Indexes to find the parents of
+ * @param n The number of indexes
+ * @param parentRes The resolution of the parents
+ * @param out Output array of n parents, 0 for indexes coarser than parentRes
+ *            or for every index if parentRes is invalid
+ */
+void H3_EXPORT(h3ToParentBatch)(const H3Index* h3, int n, int parentRes,
+                                H3Index* out) {
+    if (parentRes < 0 || parentRes > MAX_H3_RES) {
+        for (int i = 0; i < n; i++) out[i] = H3_INVALID_INDEX;
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        out[i] = h3ToParentInline(h3[i], parentRes);
     }
-    H3Index parentH = H3_SET_RESOLUTION(h, parentRes);
-    for (int i = parentRes + 1; i <= childRes; i++) {
-        H3_SET_INDEX_DIGIT(parentH, i, H3_DIGIT_MASK);
+}
+
+/**
+ * Parallel task finding the parents of a range of indexes.
+ *
+ * @param data The BatchParallelData
+ * @param begin The first index
+ * @param end One past the last index
+ */
+static void _h3ToParentBatchTask(void* data, int begin, int end) {
+    BatchParallelData* batch = data;
+    H3_EXPORT(h3ToParentBatch)
+    (batch->h3 + begin, end - begin, batch->res, batch->out + begin);
+}
+
+/**
+ * h3ToParentBatchParallel produces the same output as h3ToParentBatch, with
+ * the indexes split into ranges run by parallelFor. parallelFor must call
+ * the given task on disjoint ranges covering [0, n) and return once all of
+ * them have completed. The ranges may run concurrently on any threads. If
+ * parallelFor is NULL, the parents are found on the calling thread.
+ *
+ * @param h3 H3Indexes to find the parents of
+ * @param n The number of indexes
+ * @param parentRes The resolution of the parents
+ * @param out Output array of n parents, as for h3ToParentBatch
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ */
+void H3_EXPORT(h3ToParentBatchParallel)(const H3Index* h3, int n,
+                                        int parentRes, H3Index* out,
+                                        H3ParallelFor parallelFor,
+                                        void* executor) {
+    BatchParallelData data = {0};
+    data.h3 = h3;
+    data.res = parentRes;
+    data.out = out;
+    _batchParallelFor(n, _h3ToParentBatchTask, &data, parallelFor, executor);
+}
+
+/**
+ * h3ToParentsBatch produces the parent indexes at several resolutions for an
+ * array of H3 indexes in one pass over the input, as by h3ToParent.
+ *
+ * The parents are written in columns, one per resolution: the parent of
+ * index i at resolution parentRes[r] is out[r * n + i]. The input is read in
+ * blocks that stay in cache while every column of the block is written.
+ *
+ * @param h3 H3Indexes to find the parents of
+ * @param n The number of indexes
+ * @param parentRes The resolutions of the parents
+ * @param numRes The number of resolutions
+ * @param out Output array of numRes * n parents, with 0 columns for invalid
+ *            resolutions
+ */
+void H3_EXPORT(h3ToParentsBatch)(const H3Index* h3, int n,
+                                 const int* parentRes, int numRes,
+                                 H3Index* out) {
+    for (int start = 0; start < n; start += PARENTS_BLOCK_SIZE) {
+        int blockSize = n - start < PARENTS_BLOCK_SIZE ? n - start
+                                                       : PARENTS_BLOCK_SIZE;
+        for (int r = 0; r < numRes; r++) {
+            H3_EXPORT(h3ToParentBatch)
+            (h3 + start, blockSize, parentRes[r], out + (size_t)r * n + start);
+        }
     }
-    return parentH;
 }
 
+/** 7 to the power of each difference of resolutions */
+static const int64_t POWERS_OF_7[MAX_H3_RES + 1] = {
+    H3_POWER_OF_7(0),  H3_POWER_OF_7(1),  H3_POWER_OF_7(2),  H3_POWER_OF_7(3),
+    H3_POWER_OF_7(4),  H3_POWER_OF_7(5),  H3_POWER_OF_7(6),  H3_POWER_OF_7(7),
+    H3_POWER_OF_7(8),  H3_POWER_OF_7(9),  H3_POWER_OF_7(10), H3_POWER_OF_7(11),
+    H3_POWER_OF_7(12), H3_POWER_OF_7(13), H3_POWER_OF_7(14), H3_POWER_OF_7(15)};
+
 /**
  * maxH3ToChildrenSize returns the maximum number of children possible for a
  * given child level.
@@ -144,14 +498,30 @@ H3Index H3_EXPORT(h3ToParent)(H3Index h, int parentRes) {
  * @param childRes The resolution of the child level you're interested in
  *
  * @return int count of maximum number of children (equal for hexagons, less for
- * pentagons
+ * pentagons), or -1 if it does not fit in an int, when childRes is at least 12
+ * finer than h
  */
 int H3_EXPORT(maxH3ToChildrenSize)(H3Index h, int childRes) {
+    int64_t numChildren = H3_EXPORT(maxH3ToChildrenSize64)(h, childRes);
+    return numChildren > INT32_MAX ? -1 : (int)numChildren;
+}
+
+/**
+ * maxH3ToChildrenSize64 returns the maximum number of children possible for
+ * a given child level, as a 64 bit integer.
+ *
+ * @param h H3Index to find the number of children of
+ * @param childRes The resolution of the child level you're interested in
+ *
+ * @return The maximum number of children, or 0 if childRes is coarser than h
+ * or invalid
+ */
+int64_t H3_EXPORT(maxH3ToChildrenSize64)(H3Index h, int childRes) {
     int parentRes = H3_GET_RESOLUTION(h);
-    if (parentRes > childRes) {
+    if (parentRes > childRes || childRes > MAX_H3_RES) {
         return 0;
     }
-    return _ipow(7, (childRes - parentRes));
+    return POWERS_OF_7[childRes - parentRes];
 }
 
 /**
@@ -176,9 +546,14 @@ H3Index makeDirectChild(H3Index h, int cellNumber) {
  * at the specified resolution storing them into the provided memory pointer.
  * It's assumed that maxH3ToChildrenSize was used to determine the allocation.
  *
+ * The children are enumerated in place by incrementing their digits as a
+ * base 7 counter, so child i is written to children[i]. Under a pentagon the
+ * slots of the deleted K subsequence are skipped and left untouched.
+ *
  * @param h H3Index to find the children of
  * @param childRes int the child level to produce
- * @param children H3Index* the memory to store the resulting addresses in
+ * @param children H3Index* the memory to store the resulting addresses in.
+ * Nothing is written if maxH3ToChildrenSize is -1.
  */
 void H3_EXPORT(h3ToChildren)(H3Index h, int childRes, H3Index* children) {
     int parentRes = H3_GET_RESOLUTION(h);
@@ -188,45 +563,206 @@ void H3_EXPORT(h3ToChildren)(H3Index h, int childRes, H3Index* children) {
         *children = h;
         return;
     }
-    int bufferSize = H3_EXPORT(maxH3ToChildrenSize)(h, childRes);
-    int bufferChildStep = (bufferSize / 7);
+    int numChildren = H3_EXPORT(maxH3ToChildrenSize)(h, childRes);
+    if (numChildren < 0) return;
     int isAPentagon = H3_EXPORT(h3IsPentagon)(h);
-    for (int i = 0; i < 7; i++) {
-        if (!isAPentagon || i != K_AXES_DIGIT) {
-            H3_EXPORT(h3ToChildren)(makeDirectChild(h, i), childRes, children);
+    H3Index child = h;
+    H3_SET_RESOLUTION(child, childRes);
+    for (int r = parentRes + 1; r <= childRes; r++) {
+        H3_SET_INDEX_DIGIT(child, r, CENTER_DIGIT);
+    }
+
+    int i = 0;
+    while (i < numChildren) {
+        children[i] = child;
+        i++;
+
+        // Increment the digits, carrying towards the parent.
+        int r = childRes;
+        int digit = 0;
+        while (r > parentRes) {
+            digit = H3_GET_INDEX_DIGIT(child, r) + 1;
+            if (digit < 7) break;
+            H3_SET_INDEX_DIGIT(child, r, CENTER_DIGIT);
+            r--;
+        }
+        if (r == parentRes) break;
+
+        if (isAPentagon && digit == K_AXES_DIGIT) {
+            // The child is deleted if all digits before it are centers, in
+            // which case its whole subtree is skipped.
+            int leadingCenters = 1;
+            for (int l = parentRes + 1; l < r; l++) {
+                if (H3_GET_INDEX_DIGIT(child, l) != CENTER_DIGIT) {
+                    leadingCenters = 0;
+                    break;
+                }
+            }
+            if (leadingCenters) {
+                i += (int)POWERS_OF_7[childRes - r];
+                digit++;
+            }
         }
-        children += bufferChildStep;
+        H3_SET_INDEX_DIGIT(child, r, digit);
     }
 }
 
 /**
- * compact takes a set of hexagons all at the same resolution and compresses
- * them by pruning full child branches to the parent level. This is also done
- * for all parents recursively to get the minimum number of hex addresses that
- * perfectly cover the defined space.
- * @param h3Set Set of hexagons
- * @param compactedSet The output array of compressed hexagons (preallocated)
- * @param numHexes The size of the input and output arrays (possible that no
- * contiguous regions exist in the set at all and no compression possible)
- * @return an error code on bad input data
+ * childIterInit starts an enumeration of the children of h at childRes, in
+ * the order of their indexes, which is the order of h3ToChildren without the
+ * deleted children of pentagons. The iterator holds no memory, so it may be
+ * abandoned at any child.
+ *
+ * If childRes is coarser than h or not a valid resolution the enumeration is
+ * empty.
+ *
+ * @param iter The iterator to initialize
+ * @param h H3Index to find the children of
+ * @param childRes int the child level to produce
  */
-int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
-                       const int numHexes) {
-    int res = H3_GET_RESOLUTION(h3Set[0]);
-    if (res == 0) {
-        // No compaction possible, just copy the set to output
-        for (int i = 0; i < numHexes; i++) {
-            compactedSet[i] = h3Set[i];
+void H3_EXPORT(childIterInit)(ChildIterator* iter, H3Index h, int childRes) {
+    int parentRes = H3_GET_RESOLUTION(h);
+    iter->parent = h;
+    iter->childRes = childRes;
+    iter->skipRes = -1;
+    if (childRes < parentRes || childRes > MAX_H3_RES) {
+        iter->next = H3_INVALID_INDEX;
+        return;
+    }
+
+    H3Index child = h;
+    H3_SET_RESOLUTION(child, childRes);
+    // clear the digits of the children, leaving them all centers
+    child &= ~(h3DigitsBelowInline(parentRes) & ~h3DigitsBelowInline(childRes));
+    iter->next = child;
+    if (h3IsPentagonInline(h)) {
+        iter->skipRes = childRes;
+    }
+}
+
+/**
+ * childIterNext returns the next child of the enumeration started by
+ * childIterInit, and advances the iterator to the child after it.
+ *
+ * The digits of the children are incremented as a base 7 counter, carrying
+ * towards the parent. Under a pentagon the children whose leading nonzero
+ * digit is 1 are deleted. Every digit coarser than skipRes is a center, so
+ * when the counter first reaches 1 at skipRes the whole deleted subsequence
+ * is skipped by incrementing it once more, and skipRes moves one resolution
+ * coarser.
+ *
+ * @param iter The iterator
+ * @return The next child, or H3_INVALID_INDEX (0) once every child has been
+ * returned.
+ */
+H3Index H3_EXPORT(childIterNext)(ChildIterator* iter) {
+    H3Index child = iter->next;
+    if (child == H3_INVALID_INDEX) {
+        return child;
+    }
+
+    int parentRes = H3_GET_RESOLUTION(iter->parent);
+    H3Index next = child;
+    for (int r = iter->childRes;; r--) {
+        if (r == parentRes) {
+            next = H3_INVALID_INDEX;
+            break;
+        }
+        H3Index unit = (H3Index)1 << ((MAX_H3_RES - r) * H3_PER_DIGIT_OFFSET);
+        next += unit;
+        int digit = H3_GET_INDEX_DIGIT(next, r);
+        if (digit == K_AXES_DIGIT && r == iter->skipRes) {
+            next += unit;
+            iter->skipRes--;
+            break;
+        }
+        if (digit < 7) break;
+        // back to a center, carrying to the next coarser digit
+        next -= 7 * unit;
+    }
+    iter->next = next;
+    return child;
+}
+
+/**
+ * childIterSkipTo moves the iterator to any child of its parent, so that it
+ * is returned by the next call to childIterNext, followed by the children
+ * after it. The iterator may be moved backward as well as forward, so
+ * it can split an enumeration among workers which each skip to the first
+ * child of their part, and stop at the first child of the next part.
+ *
+ * A deleted child of a pentagon moves the iterator to the first child after
+ * it. Any other index that is not a child of the parent at the resolution of
+ * the enumeration, including one with invalid digits, ends the enumeration.
+ *
+ * @param iter The iterator
+ * @param child The child to return next
+ */
+void H3_EXPORT(childIterSkipTo)(ChildIterator* iter, H3Index child) {
+    int parentRes = H3_GET_RESOLUTION(iter->parent);
+    int childRes = iter->childRes;
+    iter->next = H3_INVALID_INDEX;
+    iter->skipRes = -1;
+    if (childRes < parentRes || childRes > MAX_H3_RES ||
+        H3_GET_RESOLUTION(child) != childRes ||
+        h3ToParentInline(child, parentRes) != iter->parent ||
+        (child & h3DigitsBelowInline(childRes)) !=
+            h3DigitsBelowInline(childRes)) {
+        return;
+    }
+    for (int r = parentRes + 1; r <= childRes; r++) {
+        if (H3_GET_INDEX_DIGIT(child, r) == H3_DIGIT_MASK) {
+            return;
+        }
+    }
+
+    if (h3IsPentagonInline(iter->parent)) {
+        iter->skipRes = childRes;
+        for (int r = parentRes + 1; r <= childRes; r++) {
+            int digit = H3_GET_INDEX_DIGIT(child, r);
+            if (digit == CENTER_DIGIT) continue;
+            if (digit == K_AXES_DIGIT) {
+                // deleted, so move to the first child after the subsequence
+                H3_SET_INDEX_DIGIT(child, r, digit + 1);
+                for (int f = r + 1; f <= childRes; f++) {
+                    H3_SET_INDEX_DIGIT(child, f, CENTER_DIGIT);
+                }
+            }
+            iter->skipRes = r - 1;
+            break;
         }
-        return 0;
     }
-    STACK_ARRAY_CALLOC(H3Index, remainingHexes, numHexes);
+    iter->next = child;
+}
+
+/**
+ * Number of hexagons of working memory needed to compact a set of the given
+ * size: the remaining hexagons, their parents hash set, and the compactable
+ * parents.
+ */
+#define COMPACT_BUFFER_SIZE(numHexes) (2 * (numHexes) + (numHexes) / 6 + 1)
+
+/**
+ * Internal algorithm for compact, using the given working memory.
+ * @param h3Set Set of hexagons, at a resolution above 0
+ * @param compactedSet The output array of compressed hexagons (preallocated)
+ * @param numHexes The size of the input and output arrays
+ * @param remainingHexes Working memory of numHexes elements
+ * @param hashSetArray Zeroed working memory of numHexes elements
+ * @param compactableHexes Working memory of numHexes / 6 + 1 elements
+ * @return an error code on bad input data
+ */
+static int _compactWithBuffers(const H3Index* h3Set, H3Index* compactedSet,
+                               const int numHexes, H3Index* remainingHexes,
+                               H3Index* hashSetArray,
+                               H3Index* compactableHexes) {
     memcpy(remainingHexes, h3Set, numHexes * sizeof(H3Index));
-    STACK_ARRAY_CALLOC(H3Index, hashSetArray, numHexes);
     H3Index* compactedSetOffset = compactedSet;
     int numRemainingHexes = numHexes;
-    while (numRemainingHexes) {
-        res = H3_GET_RESOLUTION(remainingHexes[0]);
+    while (numRemainingHexes > 0) {
+        // the number of hexagons as a size, for the copies and clearing
+        const size_t remainingSize = (size_t)numRemainingHexes;
+        int res = H3_GET_RESOLUTION(remainingHexes[0]);
         int parentRes = res - 1;
         // Put the parents of the hexagons into the temp array
         // via a hashing mechanism, and use the reserved bits
@@ -238,7 +774,9 @@ int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
                 // Modulus hash the parent into the temp array
                 int loc = (int)(parent % numRemainingHexes);
                 int loopCount = 0;
+                H3_STAT_ADD(compactProbes, 1);
                 while (hashSetArray[loc] != 0) {
+                    H3_STAT_ADD(compactProbes, 1);
                     if (loopCount > numRemainingHexes) {
                         // LCOV_EXCL_START
                         // This case should not be possible because at most one
@@ -272,10 +810,9 @@ int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
             numRemainingHexes / 6;  // Somehow all pentagons; conservative
         if (maxCompactableCount == 0) {
             memcpy(compactedSetOffset, remainingHexes,
-                   numRemainingHexes * sizeof(remainingHexes[0]));
+                   remainingSize * sizeof(remainingHexes[0]));
             break;
         }
-        STACK_ARRAY_CALLOC(H3Index, compactableHexes, maxCompactableCount);
         for (int i = 0; i < numRemainingHexes; i++) {
             if (hashSetArray[i] == 0) continue;
             int count = H3_GET_RESERVED_BITS(hashSetArray[i]) + 1;
@@ -310,6 +847,7 @@ int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
                 int loopCount = 0;
                 int isUncompactable = 1;
                 do {
+                    H3_STAT_ADD(compactProbes, 1);
                     if (loopCount > numRemainingHexes) {
                         // LCOV_EXCL_START
                         // This case should not be possible because at most one
@@ -337,87 +875,423 @@ int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
             }
         }
         // Set up for the next loop
-        memset(hashSetArray, 0, numHexes * sizeof(H3Index));
+        memset(hashSetArray, 0, remainingSize * sizeof(H3Index));
         compactedSetOffset += uncompactableCount;
-        memcpy(remainingHexes, compactableHexes, numHexes * sizeof(H3Index));
+        memcpy(remainingHexes, compactableHexes,
+               compactableCount * sizeof(H3Index));
         numRemainingHexes = compactableCount;
     }
     return 0;
 }
 
 /**
- * uncompact takes a compressed set of hexagons and expands back to the
- * original set of hexagons.
- * @param compactedSet Set of hexagons
- * @param numHexes The number of hexes in the input set
- * @param h3Set Output array of decompressed hexagons (preallocated)
- * @param maxHexes The size of the output array to bound check against
- * @param res The hexagon resolution to decompress to
- * @return An error code if output array is too small or any hexagon is
- * smaller than the output resolution.
+ * compact takes a set of hexagons all at the same resolution and compresses
+ * them by pruning full child branches to the parent level. This is also done
+ * for all parents recursively to get the minimum number of hex addresses that
+ * perfectly cover the defined space.
+ * @param h3Set Set of hexagons
+ * @param compactedSet The output array of compressed hexagons (preallocated)
+ * @param numHexes The size of the input and output arrays (possible that no
+ * contiguous regions exist in the set at all and no compression possible)
+ * @return an error code on bad input data
  */
-int H3_EXPORT(uncompact)(const H3Index* compactedSet, const int numHexes,
-                         H3Index* h3Set, const int maxHexes, const int res) {
-    int outOffset = 0;
-    for (int i = 0; i < numHexes; i++) {
-        if (outOffset >= maxHexes) {
-            // We went too far, abort!
-            return -1;
-        }
-        if (compactedSet[i] == 0) continue;
-        int currentRes = H3_GET_RESOLUTION(compactedSet[i]);
-        if (currentRes > res) {
-            // Nonsensical. Abort.
-            return -2;
-        }
-        if (currentRes == res) {
-            // Just copy and move along
-            h3Set[outOffset] = compactedSet[i];
-            outOffset++;
-        } else {
-            // Bigger hexagon to reduce in size
-            int numHexesToGen =
-                H3_EXPORT(maxH3ToChildrenSize)(compactedSet[i], res);
-            if (outOffset + numHexesToGen > maxHexes) {
-                // We're about to go too far, abort!
-                return -1;
-            }
-            H3_EXPORT(h3ToChildren)(compactedSet[i], res, h3Set + outOffset);
-            outOffset += numHexesToGen;
+int H3_EXPORT(compact)(const H3Index* h3Set, H3Index* compactedSet,
+                       const int numHexes) {
+    int res = H3_GET_RESOLUTION(h3Set[0]);
+    if (res == 0) {
+        // No compaction possible, just copy the set to output
+        for (int i = 0; i < numHexes; i++) {
+            compactedSet[i] = h3Set[i];
         }
+        return 0;
     }
-    return 0;
+    STACK_ARRAY_CALLOC(H3Index, buffer, COMPACT_BUFFER_SIZE(numHexes));
+    return _compactWithBuffers(h3Set, compactedSet, numHexes, buffer,
+                               buffer + numHexes, buffer + 2 * numHexes);
 }
 
 /**
- * maxUncompactSize takes a compacted set of hexagons are provides an
- * upper-bound estimate of the size of the uncompacted set of hexagons.
- * @param compactedSet Set of hexagons
- * @param numHexes The number of hexes in the input set
- * @param res The hexagon resolution to decompress to
- * @return The number of hexagons to allocate memory for, or a negative
- * number if an error occurs.
+ * compact using heap working memory from the given scratch instead of the
+ * stack, so that it is safe to call with large sets on small stacks.
+ * Reusing the scratch across calls avoids allocating on each call.
+ * @param h3Set Set of hexagons
+ * @param compactedSet The output array of compressed hexagons (preallocated)
+ * @param numHexes The size of the input and output arrays
+ * @param scratch Working memory
+ * @return an error code on bad input data
  */
-int H3_EXPORT(maxUncompactSize)(const H3Index* compactedSet, const int numHexes,
-                                const int res) {
-    int maxNumHexagons = 0;
-    for (int i = 0; i < numHexes; i++) {
-        if (compactedSet[i] == 0) continue;
-        int currentRes = H3_GET_RESOLUTION(compactedSet[i]);
+int H3_EXPORT(compactWithScratch)(const H3Index* h3Set, H3Index* compactedSet,
+                                  const int numHexes, H3Scratch* scratch) {
+    int res = H3_GET_RESOLUTION(h3Set[0]);
+    if (res == 0) {
+        memcpy(compactedSet, h3Set, numHexes * sizeof(H3Index));
+        return 0;
+    }
+    H3Index* buffer = _scratchReserve(
+        scratch, COMPACT_BUFFER_SIZE(numHexes) * sizeof(H3Index));
+    // Only the hash set needs to start zeroed
+    memset(buffer + numHexes, 0, numHexes * sizeof(H3Index));
+    return _compactWithBuffers(h3Set, compactedSet, numHexes, buffer,
+                               buffer + numHexes, buffer + 2 * numHexes);
+}
+
+/**
+ * Sort indexes in ascending order of their bits under a mask, with a least
+ * significant digit first radix sort, one byte at a time. Bytes that are the
+ * same in every index, such as the mode, resolution and unused digits, are
+ * skipped. The sort is stable.
+ * @param h3Set Indexes to sort
+ * @param temp Working memory of the same size
+ * @param numHexes Number of indexes, at least 1
+ * @param mask The bits to sort by
+ * @return The array holding the sorted indexes, either h3Set or temp
+ */
+static H3Index* _radixSortMasked(H3Index* h3Set, H3Index* temp, int numHexes,
+                                 H3Index mask) {
+    for (int shift = 0; shift < 64 && (mask >> shift) != 0; shift += 8) {
+        int counts[256] = {0};
+        for (int i = 0; i < numHexes; i++) {
+            counts[((h3Set[i] & mask) >> shift) & 0xff]++;
+        }
+        if (counts[((h3Set[0] & mask) >> shift) & 0xff] == numHexes) {
+            continue;
+        }
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < numHexes; i++) {
+            temp[counts[((h3Set[i] & mask) >> shift) & 0xff]++] = h3Set[i];
+        }
+        H3Index* swap = h3Set;
+        h3Set = temp;
+        temp = swap;
+    }
+    return h3Set;
+}
+
+/**
+ * Sort indexes in ascending order with a least significant digit first
+ * radix sort, one byte at a time. Bytes that are the same in every index,
+ * such as the mode, resolution and unused digits, are skipped.
+ * @param h3Set Indexes to sort
+ * @param temp Working memory of the same size
+ * @param numHexes Number of indexes
+ * @return The array holding the sorted indexes, either h3Set or temp
+ */
+H3Index* _radixSortH3Indexes(H3Index* h3Set, H3Index* temp, int numHexes) {
+    return _radixSortMasked(h3Set, temp, numHexes, ~(H3Index)0);
+}
+
+/**
+ * h3ToOrderKey returns the key that h3SortCells orders hexagons by: the
+ * base cell and digits of the index, with the mode and resolution cleared.
+ *
+ * Unused digits are all 1's, so the descendants of a hexagon have keys just
+ * below its own, and the keys of every hexagon and its descendants form a
+ * range that no other hexagon falls in. Sorting by key therefore keeps
+ * nearby hexagons together whatever their resolutions, where sorting the
+ * indexes themselves separates them by resolution first. Distinct hexagons
+ * have distinct keys, and these are the keys of an H3SortedSet.
+ *
+ * @param h The hexagon
+ * @return The ordering key of the hexagon
+ */
+uint64_t H3_EXPORT(h3ToOrderKey)(H3Index h) {
+    return h & H3_SORTED_SET_KEY_MASK;
+}
+
+/**
+ * h3SortCells sorts hexagons of any resolutions in place, in ascending order
+ * of h3ToOrderKey, with a radix sort. Hexagons with the same key keep their
+ * order. Working memory is taken from the heap.
+ *
+ * @param h3Set The hexagons to sort
+ * @param numHexes The number of hexagons
+ */
+void H3_EXPORT(h3SortCells)(H3Index* h3Set, int numHexes) {
+    if (numHexes < 2) {
+        return;
+    }
+    H3Index* temp = H3_MEMORY(malloc)(numHexes * sizeof(H3Index));
+    assert(temp != NULL);
+    H3Index* sorted =
+        _radixSortMasked(h3Set, temp, numHexes, H3_SORTED_SET_KEY_MASK);
+    if (sorted != h3Set) {
+        memcpy(h3Set, sorted, numHexes * sizeof(H3Index));
+    }
+    H3_MEMORY(free)(temp);
+}
+
+/**
+ * h3SortUniqueCells sorts hexagons as h3SortCells does, then moves each
+ * distinct hexagon once to the start of the array, dropping zeros.
+ *
+ * @param h3Set The hexagons to sort
+ * @param numHexes The number of hexagons
+ * @return The number of distinct hexagons at the start of h3Set
+ */
+int H3_EXPORT(h3SortUniqueCells)(H3Index* h3Set, int numHexes) {
+    H3_EXPORT(h3SortCells)(h3Set, numHexes);
+    int numUnique = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] == 0) continue;
+        if (numUnique == 0 || h3Set[i] != h3Set[numUnique - 1]) {
+            h3Set[numUnique++] = h3Set[i];
+        }
+    }
+    return numUnique;
+}
+
+/**
+ * compactWithSort compacts a set of hexagons as compact does, but by sorting
+ * the set instead of hashing it. The children of a parent are adjacent once
+ * sorted, and the parents of a sorted set are again sorted, so each
+ * resolution is compacted in one sequential pass over the remaining
+ * hexagons. Already sorted input skips the sort. Working memory is taken
+ * from the heap, so very large sets are safe to compact.
+ *
+ * The compacted hexagons are the same as those from compact, though they
+ * may be in a different order.
+ * @param h3Set Set of hexagons, all at the same resolution
+ * @param compactedSet The output array of compressed hexagons (preallocated)
+ * @param numHexes The size of the input and output arrays
+ * @return an error code on bad input data
+ */
+int H3_EXPORT(compactWithSort)(const H3Index* h3Set, H3Index* compactedSet,
+                               const int numHexes) {
+    if (numHexes <= 0) {
+        return 0;
+    }
+    H3Index* buffer = H3_MEMORY(malloc)(2 * numHexes * sizeof(H3Index));
+    assert(buffer != NULL);
+    memcpy(buffer, h3Set, numHexes * sizeof(H3Index));
+    H3Index* remaining = buffer;
+    H3Index* next = buffer + numHexes;
+    int sorted = 1;
+    for (int i = 1; i < numHexes && sorted; i++) {
+        sorted = h3Set[i - 1] <= h3Set[i];
+    }
+    if (!sorted) {
+        remaining = _radixSortH3Indexes(buffer, next, numHexes);
+        next = remaining == buffer ? buffer + numHexes : buffer;
+    }
+
+    // Skip any empty entries, which sort first
+    int start = 0;
+    while (start < numHexes && remaining[start] == 0) {
+        start++;
+    }
+    remaining += start;
+    int numRemaining = numHexes - start;
+    int numCompacted = 0;
+    while (numRemaining > 0) {
+        int res = H3_GET_RESOLUTION(remaining[0]);
+        if (res == 0) {
+            memcpy(compactedSet + numCompacted, remaining,
+                   numRemaining * sizeof(H3Index));
+            numCompacted += numRemaining;
+            break;
+        }
+        int numParents = 0;
+        int i = 0;
+        while (i < numRemaining) {
+            H3Index parent = H3_EXPORT(h3ToParent)(remaining[i], res - 1);
+            int end = i + 1;
+            while (end < numRemaining &&
+                   H3_EXPORT(h3ToParent)(remaining[end], res - 1) == parent) {
+                if (remaining[end] == remaining[end - 1]) {
+                    // Only possible on duplicate input
+                    H3_MEMORY(free)(buffer);
+                    return -2;
+                }
+                end++;
+            }
+            // Pentagons have no child in the deleted direction
+            int numChildren = H3_EXPORT(h3IsPentagon)(parent) ? 6 : 7;
+            if (end - i == numChildren) {
+                next[numParents++] = parent;
+            } else {
+                memcpy(compactedSet + numCompacted, remaining + i,
+                       (end - i) * sizeof(H3Index));
+                numCompacted += end - i;
+            }
+            i = end;
+        }
+        // The parents become the hexagons to compact at the next resolution
+        H3Index* swap = remaining;
+        remaining = next;
+        next = swap;
+        numRemaining = numParents;
+    }
+    H3_MEMORY(free)(buffer);
+    return 0;
+}
+
+/**
+ * uncompact takes a compressed set of hexagons and expands back to the
+ * original set of hexagons.
+ * @param compactedSet Set of hexagons
+ * @param numHexes The number of hexes in the input set
+ * @param h3Set Output array of decompressed hexagons (preallocated)
+ * @param maxHexes The size of the output array to bound check against
+ * @param res The hexagon resolution to decompress to
+ * @return An error code if output array is too small or any hexagon is
+ * smaller than the output resolution.
+ */
+int H3_EXPORT(uncompact)(const H3Index* compactedSet, const int numHexes,
+                         H3Index* h3Set, const int maxHexes, const int res) {
+    int outOffset = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (outOffset >= maxHexes) {
+            // We went too far, abort!
+            return -1;
+        }
+        if (compactedSet[i] == 0) continue;
+        int currentRes = H3_GET_RESOLUTION(compactedSet[i]);
         if (currentRes > res) {
             // Nonsensical. Abort.
-            return -1;
+            return -2;
         }
         if (currentRes == res) {
-            maxNumHexagons++;
+            // Just copy and move along
+            h3Set[outOffset] = compactedSet[i];
+            outOffset++;
         } else {
             // Bigger hexagon to reduce in size
             int numHexesToGen =
                 H3_EXPORT(maxH3ToChildrenSize)(compactedSet[i], res);
-            maxNumHexagons += numHexesToGen;
+            if (numHexesToGen < 0 || outOffset + numHexesToGen > maxHexes) {
+                // We're about to go too far, abort!
+                return -1;
+            }
+            H3_EXPORT(h3ToChildren)(compactedSet[i], res, h3Set + outOffset);
+            outOffset += numHexesToGen;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Shared state of a parallel uncompact.
+ */
+typedef struct {
+    const H3Index* compactedSet;  ///< the hexagons to uncompact
+    const int* offsets;           ///< the output offset of each hexagon
+    H3Index* h3Set;               ///< the output array
+    int res;                      ///< the resolution to uncompact to
+} UncompactParallelData;
+
+/**
+ * Parallel task uncompacting a range of hexagons into their output ranges.
+ *
+ * @param data The UncompactParallelData
+ * @param begin The first hexagon to uncompact
+ * @param end One past the last hexagon to uncompact
+ */
+static void _uncompactParallelTask(void* data, int begin, int end) {
+    UncompactParallelData* parallelData = data;
+    for (int i = begin; i < end; i++) {
+        H3Index h = parallelData->compactedSet[i];
+        if (h == 0) continue;
+        H3_EXPORT(h3ToChildren)
+        (h, parallelData->res, parallelData->h3Set + parallelData->offsets[i]);
+    }
+}
+
+/**
+ * uncompactParallel produces the same output as uncompact, and returns the
+ * same error codes. The output offset of every hexagon is computed up front
+ * from maxH3ToChildrenSize, so each hexagon is expanded into a disjoint range
+ * of the output.
+ *
+ * The hexagons are expanded by calling parallelFor, which must call the
+ * given task on disjoint ranges covering [0, n) and return once all of them
+ * have completed. The ranges may run concurrently on any threads. If
+ * parallelFor is NULL, the hexagons are expanded on the calling thread.
+ *
+ * @param compactedSet Set of hexagons
+ * @param numHexes The number of hexes in the input set
+ * @param h3Set Output array of decompressed hexagons (preallocated)
+ * @param maxHexes The size of the output array to bound check against
+ * @param res The hexagon resolution to decompress to
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ * @return An error code if output array is too small or any hexagon is
+ * smaller than the output resolution.
+ */
+int H3_EXPORT(uncompactParallel)(const H3Index* compactedSet,
+                                 const int numHexes, H3Index* h3Set,
+                                 const int maxHexes, const int res,
+                                 H3ParallelFor parallelFor, void* executor) {
+    if (numHexes <= 0) {
+        return 0;
+    }
+    int* offsets = H3_MEMORY(malloc)(numHexes * sizeof(int));
+    assert(offsets != NULL);
+    int outOffset = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (outOffset >= maxHexes) {
+            H3_MEMORY(free)(offsets);
+            return -1;
+        }
+        offsets[i] = outOffset;
+        if (compactedSet[i] == 0) continue;
+        if (H3_GET_RESOLUTION(compactedSet[i]) > res) {
+            H3_MEMORY(free)(offsets);
+            return -2;
         }
+        int numHexesToGen =
+            H3_EXPORT(maxH3ToChildrenSize)(compactedSet[i], res);
+        if (numHexesToGen < 0 || outOffset + numHexesToGen > maxHexes) {
+            H3_MEMORY(free)(offsets);
+            return -1;
+        }
+        outOffset += numHexesToGen;
+    }
+
+    UncompactParallelData data = {compactedSet, offsets, h3Set, res};
+    if (parallelFor == NULL) {
+        _uncompactParallelTask(&data, 0, numHexes);
+    } else {
+        parallelFor(executor, numHexes, _uncompactParallelTask, &data);
     }
-    return maxNumHexagons;
+    H3_MEMORY(free)(offsets);
+    return 0;
+}
+
+/**
+ * maxUncompactSize takes a compacted set of hexagons are provides an
+ * upper-bound estimate of the size of the uncompacted set of hexagons.
+ * @param compactedSet Set of hexagons
+ * @param numHexes The number of hexes in the input set
+ * @param res The hexagon resolution to decompress to
+ * @return The number of hexagons to allocate memory for, or a negative
+ * number if an error occurs, including when the number does not fit in an
+ * int.
+ */
+int H3_EXPORT(maxUncompactSize)(const H3Index* compactedSet, const int numHexes,
+                                const int res) {
+    int64_t maxNumHexagons = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (compactedSet[i] == 0) continue;
+        int currentRes = H3_GET_RESOLUTION(compactedSet[i]);
+        if (currentRes > res) {
+            // Nonsensical. Abort.
+            return -1;
+        }
+        if (currentRes == res) {
+            maxNumHexagons++;
+        } else {
+            // Bigger hexagon to reduce in size
+            maxNumHexagons +=
+                H3_EXPORT(maxH3ToChildrenSize64)(compactedSet[i], res);
+        }
+        if (maxNumHexagons > INT32_MAX) return -1;
+    }
+    return (int)maxNumHexagons;
 }
 
 /**
@@ -428,7 +1302,9 @@ int H3_EXPORT(maxUncompactSize)(const H3Index* compactedSet, const int numHexes,
  * @param h The H3Index to check.
  * @return Returns 1 if the hexagon is class III, otherwise 0.
  */
-int H3_EXPORT(h3IsResClassIII)(H3Index h) { return H3_GET_RESOLUTION(h) % 2; }
+int H3_EXPORT(h3IsResClassIII)(H3Index h) {
+    return h3IsResClassIIIInline(h);
+}
 
 /**
  * h3IsPentagon takes an H3Index and determines if it is actually a
@@ -437,8 +1313,7 @@ int H3_EXPORT(h3IsResClassIII)(H3Index h) { return H3_GET_RESOLUTION(h) % 2; }
  * @return Returns 1 if it is a pentagon, otherwise 0.
  */
 int H3_EXPORT(h3IsPentagon)(H3Index h) {
-    return _isBaseCellPentagon(H3_GET_BASE_CELL(h)) &&
-           !_h3LeadingNonZeroDigit(h);
+    return h3IsPentagonInline(h);
 }
 
 /**
@@ -480,6 +1355,32 @@ H3Index _h3RotatePent60ccw(H3Index h) {
     return h;
 }
 
+/**
+ * Rotate an H3Index 60 degrees clockwise about a pentagonal center.
+ * @param h The H3Index.
+ */
+H3Index _h3RotatePent60cw(H3Index h) {
+    // rotate in place; skips any leading 1 digits (k-axis)
+
+    int foundFirstNonZeroDigit = 0;
+    for (int r = 1, res = H3_GET_RESOLUTION(h); r <= res; r++) {
+        // rotate this digit
+        H3_SET_INDEX_DIGIT(h, r, _rotate60cw(H3_GET_INDEX_DIGIT(h, r)));
+
+        // look for the first non-zero digit so we
+        // can adjust for deleted k-axes sequence
+        // if neccessary
+        if (!foundFirstNonZeroDigit && H3_GET_INDEX_DIGIT(h, r) != 0) {
+            foundFirstNonZeroDigit = 1;
+
+            // adjust for deleted k-axes sequence
+            if (_h3LeadingNonZeroDigit(h) == K_AXES_DIGIT)
+                h = _h3Rotate60cw(h);
+        }
+    }
+    return h;
+}
+
 /**
  * Rotate an H3Index 60 degrees counter-clockwise.
  * @param h The H3Index.
@@ -505,81 +1406,44 @@ H3Index _h3Rotate60cw(H3Index h) {
     return h;
 }
 
+/** @brief digits rotated 60 degrees counter-clockwise the number of times
+ * given by the first index, as by repeated _rotate60ccw */
+static const int DIGIT_ROTATIONS_CCW[6][7] = {
+    {0, 1, 2, 3, 4, 5, 6},  // 0 rotations
+    {0, 5, 3, 1, 6, 4, 2},  // 1 rotation
+    {0, 4, 1, 5, 2, 6, 3},  // 2 rotations
+    {0, 6, 5, 4, 3, 2, 1},  // 3 rotations
+    {0, 2, 4, 6, 1, 3, 5},  // 4 rotations
+    {0, 3, 6, 2, 5, 1, 4},  // 5 rotations
+};
+
 /**
- * Convert an FaceIJK address to the corresponding H3Index.
- * @param fijk The FaceIJK address.
- * @param res The cell resolution.
+ * Completes an H3Index from the IJK coordinates of its base cell in the
+ * coordinate system of the originally encoded face, once all digits below
+ * res 0 have been set.
+ * @param h The H3Index with mode, resolution and digits set.
+ * @param fijkBC The FaceIJK address of the base cell.
  * @return The encoded H3Index (or 0 on failure).
  */
-H3Index _faceIjkToH3(const FaceIJK* fijk, int res) {
-    // initialize the index
-    H3Index h = H3_INIT;
-    H3_SET_MODE(h, H3_HEXAGON_MODE);
-    H3_SET_RESOLUTION(h, res);
-
-    // check for res 0/base cell
-    if (res == 0) {
-        if (fijk->coord.i > MAX_FACE_COORD || fijk->coord.j > MAX_FACE_COORD ||
-            fijk->coord.k > MAX_FACE_COORD) {
-            // out of range input
-            return H3_INVALID_INDEX;
-        }
-
-        H3_SET_BASE_CELL(h, _faceIjkToBaseCell(fijk));
-        return h;
-    }
-
-    // we need to find the correct base cell FaceIJK for this H3 index;
-    // start with the passed in face and resolution res ijk coordinates
-    // in that face's coordinate system
-    FaceIJK fijkBC = *fijk;
-
-    // build the H3Index from finest res up
-    // adjust r for the fact that the res 0 base cell offsets the index array
-    CoordIJK* ijk = &fijkBC.coord;
-    for (int r = res - 1; r >= 0; r--) {
-        CoordIJK lastIJK = *ijk;
-        CoordIJK lastCenter;
-        if (isResClassIII(r + 1)) {
-            // rotate ccw
-            _upAp7(ijk);
-            lastCenter = *ijk;
-            _downAp7(&lastCenter);
-        } else {
-            // rotate cw
-            _upAp7r(ijk);
-            lastCenter = *ijk;
-            _downAp7r(&lastCenter);
-        }
-
-        CoordIJK diff;
-        _ijkSub(&lastIJK, &lastCenter, &diff);
-        _ijkNormalize(&diff);
-
-        H3_SET_INDEX_DIGIT(h, r + 1, _unitIjkToDigit(&diff));
-    }
-
-    // fijkBC should now hold the IJK of the base cell in the
-    // coordinate system of the current face
-
-    if (fijkBC.coord.i > MAX_FACE_COORD || fijkBC.coord.j > MAX_FACE_COORD ||
-        fijkBC.coord.k > MAX_FACE_COORD) {
+H3Index _faceIjkBaseCellToH3(H3Index h, const FaceIJK* fijkBC) {
+    if (fijkBC->coord.i > MAX_FACE_COORD || fijkBC->coord.j > MAX_FACE_COORD ||
+        fijkBC->coord.k > MAX_FACE_COORD) {
         // out of range input
         return H3_INVALID_INDEX;
     }
 
     // lookup the correct base cell
-    int baseCell = _faceIjkToBaseCell(&fijkBC);
+    int baseCell = _faceIjkToBaseCell(fijkBC);
     H3_SET_BASE_CELL(h, baseCell);
 
     // rotate if necessary to get canonical base cell orientation
     // for this base cell
-    int numRots = _faceIjkToBaseCellCCWrot60(&fijkBC);
+    int numRots = _faceIjkToBaseCellCCWrot60(fijkBC);
     if (_isBaseCellPentagon(baseCell)) {
         // force rotation out of missing k-axes sub-sequence
         if (_h3LeadingNonZeroDigit(h) == K_AXES_DIGIT) {
             // check for a cw/ccw offset face; default is ccw
-            if (_baseCellIsCwOffset(baseCell, fijkBC.face)) {
+            if (_baseCellIsCwOffset(baseCell, fijkBC->face)) {
                 h = _h3Rotate60cw(h);
             } else {
                 h = _h3Rotate60ccw(h);
@@ -587,15 +1451,71 @@ H3Index _faceIjkToH3(const FaceIJK* fijk, int res) {
         }
 
         for (int i = 0; i < numRots; i++) h = _h3RotatePent60ccw(h);
-    } else {
-        for (int i = 0; i < numRots; i++) {
-            h = _h3Rotate60ccw(h);
+    } else if (numRots > 0) {
+        // apply all the rotations to each digit at once
+        for (int r = 1, res = H3_GET_RESOLUTION(h); r <= res; r++) {
+            H3_SET_INDEX_DIGIT(
+                h, r, DIGIT_ROTATIONS_CCW[numRots][H3_GET_INDEX_DIGIT(h, r)]);
         }
     }
 
     return h;
 }
 
+/**
+ * Convert an FaceIJK address to the corresponding H3Index.
+ * @param fijk The FaceIJK address.
+ * @param res The cell resolution.
+ * @return The encoded H3Index (or 0 on failure).
+ */
+H3Index _faceIjkToH3(const FaceIJK* fijk, int res) {
+    // initialize the index
+    H3Index h = H3_INIT;
+    H3_SET_MODE(h, H3_HEXAGON_MODE);
+    H3_SET_RESOLUTION(h, res);
+
+    // we need to find the correct base cell FaceIJK for this H3 index;
+    // start with the passed in face and resolution res ijk coordinates
+    // in that face's coordinate system
+    FaceIJK fijkBC = *fijk;
+
+    // build the H3Index from finest res up, taking each digit from the
+    // residue of the coordinates in the parent grid
+    int digits[MAX_H3_RES + 1];
+    _upAp7Digits(&fijkBC.coord, res, digits);
+    for (int r = 1; r <= res; r++) {
+        H3_SET_INDEX_DIGIT(h, r, digits[r]);
+    }
+
+    // fijkBC should now hold the IJK of the base cell in the
+    // coordinate system of the current face
+    return _faceIjkBaseCellToH3(h, &fijkBC);
+}
+
+/**
+ * Convert an FaceIJK address to the corresponding H3Index, also giving the
+ * coordinates of the ancestors of the cell on the face.
+ * @param fijk The FaceIJK address.
+ * @param res The cell resolution.
+ * @param path Output array; the ancestor at resolution r, for 0 <= r <= res,
+ *             is set at path[r] as ijk coordinates with k of 0.
+ * @return The encoded H3Index (or 0 on failure).
+ */
+static H3Index _faceIjkToH3WithPath(const FaceIJK* fijk, int res,
+                                    CoordIJ* path) {
+    H3Index h = H3_INIT;
+    H3_SET_MODE(h, H3_HEXAGON_MODE);
+    H3_SET_RESOLUTION(h, res);
+
+    FaceIJK fijkBC = *fijk;
+    int digits[MAX_H3_RES + 1];
+    _upAp7DigitsPath(&fijkBC.coord, res, digits, path);
+    for (int r = 1; r <= res; r++) {
+        H3_SET_INDEX_DIGIT(h, r, digits[r]);
+    }
+    return _faceIjkBaseCellToH3(h, &fijkBC);
+}
+
 /**
  * Encodes a coordinate on the sphere to the H3 index of the containing cell at
  * the specified resolution.
@@ -620,15 +1540,150 @@ H3Index H3_EXPORT(geoToH3)(const GeoCoord* g, int res) {
 }
 
 /**
- * Convert an H3Index to the FaceIJK address on a specified icosahedral face.
- * @param h The H3Index.
- * @param fijk The FaceIJK address, initialized with the desired face
- *        and normalized base cell coordinates.
- * @return Returns 1 if the possibility of overage exists, otherwise 0.
+ * Encodes a location on the sphere to the H3 indexes of the containing cells
+ * at every resolution from 0 to finestRes.
+ *
+ * The projection onto the icosahedron is done once and shared by every
+ * resolution, and the output is identical to calling geoToH3 at each
+ * resolution. It can differ from taking h3ToParent of the finest index,
+ * since a cell is not exactly contained by its parent: near the edges of a
+ * parent, a point in one of its children may lie in a neighbor of the parent.
+ *
+ * @param g The spherical coordinates to encode.
+ * @param finestRes The finest H3 resolution to encode.
+ * @param out Output array of finestRes + 1 indexes, indexed by resolution.
+ *            Nothing is written if finestRes is invalid, and every index is
+ *            H3_INVALID_INDEX if the coordinates are not finite.
  */
-int _h3ToFaceIjkWithInitializedFijk(H3Index h, FaceIJK* fijk) {
+void H3_EXPORT(geoToH3Multi)(const GeoCoord* g, int finestRes, H3Index* out) {
+    if (finestRes < 0 || finestRes > MAX_H3_RES) {
+        return;
+    }
+    if (!isfinite(g->lat) || !isfinite(g->lon)) {
+        for (int res = 0; res <= finestRes; res++) out[res] = H3_INVALID_INDEX;
+        return;
+    }
+
+    FaceIJK fijk[MAX_H3_RES + 1];
+    _geoToFaceIjkMulti(g, finestRes, fijk);
+
+    // Encode the finest cell, keeping the coordinates of its ancestors. The
+    // digits and base cell of a coarser cell follow from its coordinates
+    // alone, so where the cell encoded directly at a resolution is the
+    // ancestor on the path, its index is the parent of the finer index.
+    // Otherwise the point is near the edge of the ancestor and the coarser
+    // cell is encoded in full, starting a new path.
+    CoordIJ path[MAX_H3_RES + 1];
+    H3Index h = _faceIjkToH3WithPath(&fijk[finestRes], finestRes, path);
+    out[finestRes] = h;
+    for (int res = finestRes - 1; res >= 0; res--) {
+        const CoordIJK* ijk = &fijk[res].coord;
+        if (h && ijk->i - ijk->k == path[res].i &&
+            ijk->j - ijk->k == path[res].j) {
+            out[res] = h3ToParentInline(h, res);
+        } else {
+            h = _faceIjkToH3WithPath(&fijk[res], res, path);
+            out[res] = h;
+        }
+    }
+}
+
+/**
+ * Encodes arrays of coordinates on the sphere to the H3 indexes of the
+ * containing cells at the specified resolution.
+ *
+ * The points are processed in blocks so that face selection can be done for
+ * many points at once. The output is identical to calling geoToH3 on each
+ * point.
+ *
+ * @param lat The latitudes of the points, in radians.
+ * @param lon The longitudes of the points, in radians.
+ * @param n The number of points.
+ * @param res The desired H3 resolution for the encoding.
+ * @param out Output array of n indexes. Points that cannot be encoded, because
+ *            the resolution is invalid or the coordinates are not finite, are
+ *            set to H3_INVALID_INDEX.
+ */
+void H3_EXPORT(geoToH3Batch)(const double* lat, const double* lon, int n,
+                             int res, H3Index* out) {
+    if (res < 0 || res > MAX_H3_RES) {
+        for (int i = 0; i < n; i++) out[i] = H3_INVALID_INDEX;
+        return;
+    }
+
+    double blockLat[FACE_BATCH_SIZE];
+    double blockLon[FACE_BATCH_SIZE];
+    int valid[FACE_BATCH_SIZE];
+    FaceIJK fijk[FACE_BATCH_SIZE];
+    for (int start = 0; start < n; start += FACE_BATCH_SIZE) {
+        int count = n - start;
+        if (count > FACE_BATCH_SIZE) count = FACE_BATCH_SIZE;
+
+        // replace non-finite lanes with a placeholder so the block kernel
+        // does not need to check each point
+        for (int i = 0; i < count; i++) {
+            valid[i] = isfinite(lat[start + i]) && isfinite(lon[start + i]);
+            blockLat[i] = valid[i] ? lat[start + i] : 0.0;
+            blockLon[i] = valid[i] ? lon[start + i] : 0.0;
+        }
+
+        _geoToFaceIjkBatch(blockLat, blockLon, count, res, fijk);
+
+        for (int i = 0; i < count; i++) {
+            out[start + i] =
+                valid[i] ? _faceIjkToH3(&fijk[i], res) : H3_INVALID_INDEX;
+        }
+    }
+}
+
+/**
+ * Parallel task indexing a range of points.
+ *
+ * @param data The BatchParallelData
+ * @param begin The first point
+ * @param end One past the last point
+ */
+static void _geoToH3BatchTask(void* data, int begin, int end) {
+    BatchParallelData* batch = data;
+    H3_EXPORT(geoToH3Batch)
+    (batch->lat + begin, batch->lon + begin, end - begin, batch->res,
+     batch->out + begin);
+}
+
+/**
+ * geoToH3BatchParallel produces the same output as geoToH3Batch, with the
+ * points split into ranges run by parallelFor. parallelFor must call the
+ * given task on disjoint ranges covering [0, n) and return once all of them
+ * have completed. The ranges may run concurrently on any threads. If
+ * parallelFor is NULL, the points are indexed on the calling thread.
+ *
+ * @param lat The latitudes of the points, in radians.
+ * @param lon The longitudes of the points, in radians.
+ * @param n The number of points.
+ * @param res The desired H3 resolution for the encoding.
+ * @param out Output array of n indexes, as for geoToH3Batch.
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ */
+void H3_EXPORT(geoToH3BatchParallel)(const double* lat, const double* lon,
+                                     int n, int res, H3Index* out,
+                                     H3ParallelFor parallelFor,
+                                     void* executor) {
+    BatchParallelData data = {0};
+    data.lat = lat;
+    data.lon = lon;
+    data.res = res;
+    data.out = out;
+    _batchParallelFor(n, _geoToH3BatchTask, &data, parallelFor, executor);
+}
+
+/**
+ * Adds the digits of an H3Index at the given resolution to the FaceIJK
+ * address of its base cell. See _h3ToFaceIjkWithInitializedFijk.
+ */
+static inline int _h3ToFaceIjkWithInitializedFijkRes(H3Index h, int res,
+                                                     FaceIJK* fijk) {
     CoordIJK* ijk = &fijk->coord;
-    int res = H3_GET_RESOLUTION(h);
 
     // center base cell hierarchy is entirely on this face
     int possibleOverage = 1;
@@ -637,27 +1692,31 @@ int _h3ToFaceIjkWithInitializedFijk(H3Index h, FaceIJK* fijk) {
          (fijk->coord.i == 0 && fijk->coord.j == 0 && fijk->coord.k == 0)))
         possibleOverage = 0;
 
+    int digits[MAX_H3_RES + 1];
     for (int r = 1; r <= res; r++) {
-        if (isResClassIII(r)) {
-            // Class III == rotate ccw
-            _downAp7(ijk);
-        } else {
-            // Class II == rotate cw
-            _downAp7r(ijk);
-        }
-
-        _neighbor(ijk, H3_GET_INDEX_DIGIT(h, r));
+        digits[r] = H3_GET_INDEX_DIGIT(h, r);
     }
+    _downAp7Digits(ijk, res, digits);
 
     return possibleOverage;
 }
 
 /**
- * Convert an H3Index to a FaceIJK address.
+ * Convert an H3Index to the FaceIJK address on a specified icosahedral face.
  * @param h The H3Index.
- * @param fijk The corresponding FaceIJK address.
+ * @param fijk The FaceIJK address, initialized with the desired face
+ *        and normalized base cell coordinates.
+ * @return Returns 1 if the possibility of overage exists, otherwise 0.
  */
-void _h3ToFaceIjk(H3Index h, FaceIJK* fijk) {
+int _h3ToFaceIjkWithInitializedFijk(H3Index h, FaceIJK* fijk) {
+    return _h3ToFaceIjkWithInitializedFijkRes(h, H3_GET_RESOLUTION(h), fijk);
+}
+
+/**
+ * Convert an H3Index at the given resolution to a FaceIJK address, for
+ * callers that have already decoded the resolution. See _h3ToFaceIjk.
+ */
+static inline void _h3ToFaceIjkRes(H3Index h, int res, FaceIJK* fijk) {
     int baseCell = H3_GET_BASE_CELL(h);
     // adjust for the pentagonal missing sequence; all of sub-sequence 5 needs
     // to be adjusted (and some of sub-sequence 4 below)
@@ -666,16 +1725,24 @@ void _h3ToFaceIjk(H3Index h, FaceIJK* fijk) {
 
     // start with the "home" face and ijk+ coordinates for the base cell of c
     *fijk = baseCellData[baseCell].homeFijk;
-    if (!_h3ToFaceIjkWithInitializedFijk(h, fijk))
+    if (!_h3ToFaceIjkWithInitializedFijkRes(h, res, fijk))
         return;  // no overage is possible; h lies on this face
 
+    // no overage is possible for the descendants of some cells of each base
+    // cell either; see generateNoOverageTable
+    if (res >= NO_OVERAGE_RES &&
+        ((baseCellNoOverage[baseCell] >>
+          (H3_GET_INDEX_DIGIT(h, 1) * 8 + H3_GET_INDEX_DIGIT(h, 2))) &
+         1))
+        return;
+
     // if we're here we have the potential for an "overage"; i.e., it is
     // possible that c lies on an adjacent face
 
     CoordIJK origIJK = fijk->coord;
 
     // if we're in Class III, drop into the next finer Class II grid
-    int res = H3_GET_RESOLUTION(h);
+    int origRes = res;
     if (isResClassIII(res)) {
         // Class III
         _downAp7r(&fijk->coord);
@@ -695,12 +1762,54 @@ void _h3ToFaceIjk(H3Index h, FaceIJK* fijk) {
             }
         }
 
-        if (res != H3_GET_RESOLUTION(h)) _upAp7r(&fijk->coord);
-    } else if (res != H3_GET_RESOLUTION(h)) {
+        if (res != origRes) _upAp7r(&fijk->coord);
+    } else if (res != origRes) {
         fijk->coord = origIJK;
     }
 }
 
+/**
+ * Convert an H3Index to a FaceIJK address.
+ * @param h The H3Index.
+ * @param fijk The corresponding FaceIJK address.
+ */
+void _h3ToFaceIjk(H3Index h, FaceIJK* fijk) {
+    _h3ToFaceIjkRes(h, H3_GET_RESOLUTION(h), fijk);
+}
+
+/**
+ * Decodes an H3Index into the work its center, boundary and edge queries
+ * share: the FaceIJK address of its center, after the pentagon rotations,
+ * the digit walk and any overage adjustment.
+ * @param h The H3Index.
+ * @param cell The decoded cell.
+ */
+void _h3ToDecodedCell(H3Index h, DecodedCell* cell) {
+    cell->res = H3_GET_RESOLUTION(h);
+    cell->isPentagon = H3_EXPORT(h3IsPentagon)(h);
+    _h3ToFaceIjkRes(h, cell->res, &cell->fijk);
+}
+
+/**
+ * Determines the spherical coordinates of the center point of a decoded
+ * cell, as h3ToGeo does.
+ * @param cell The decoded cell.
+ * @param g The spherical coordinates of the cell center.
+ */
+void _decodedCellToGeo(const DecodedCell* cell, GeoCoord* g) {
+    _faceIjkToGeo(&cell->fijk, cell->res, g);
+}
+
+/**
+ * Determines the cell boundary in spherical coordinates of a decoded cell,
+ * as h3ToGeoBoundary does.
+ * @param cell The decoded cell.
+ * @param gb The boundary of the cell in spherical coordinates.
+ */
+void _decodedCellToGeoBoundary(const DecodedCell* cell, GeoBoundary* gb) {
+    _faceIjkToGeoBoundary(&cell->fijk, cell->res, cell->isPentagon, gb, NULL);
+}
+
 /**
  * Determines the spherical coordinates of the center point of an H3 index.
  *
@@ -723,7 +1832,290 @@ void H3_EXPORT(h3ToGeoBoundary)(H3Index h3, GeoBoundary* gb) {
     FaceIJK fijk;
     _h3ToFaceIjk(h3, &fijk);
     _faceIjkToGeoBoundary(&fijk, H3_GET_RESOLUTION(h3),
-                          H3_EXPORT(h3IsPentagon)(h3), gb);
+                          H3_EXPORT(h3IsPentagon)(h3), gb, NULL);
+}
+
+/**
+ * Determines both the center point and the cell boundary of an H3 index, as
+ * h3ToGeo and h3ToGeoBoundary do, decoding the index only once.
+ *
+ * @param h3 The H3 index.
+ * @param g The spherical coordinates of the H3 cell center.
+ * @param gb The boundary of the H3 cell in spherical coordinates.
+ */
+void H3_EXPORT(h3ToGeoAndBoundary)(H3Index h3, GeoCoord* g, GeoBoundary* gb) {
+    DecodedCell cell;
+    _h3ToDecodedCell(h3, &cell);
+    _decodedCellToGeo(&cell, g);
+    _decodedCellToGeoBoundary(&cell, gb);
+}
+
+/**
+ * Determines the spherical coordinates of the center points of an array of
+ * H3 indexes. Each index is decoded on its own, as by h3ToGeo; this only
+ * saves the caller the loop and the GeoCoord copies.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param lat Output array of n latitudes, in radians.
+ * @param lon Output array of n longitudes, in radians.
+ */
+void H3_EXPORT(h3ToGeoBatch)(const H3Index* h3, int n, double* lat,
+                             double* lon) {
+    for (int i = 0; i < n; i++) {
+        FaceIJK fijk;
+        GeoCoord g;
+        _h3ToFaceIjk(h3[i], &fijk);
+        _faceIjkToGeo(&fijk, H3_GET_RESOLUTION(h3[i]), &g);
+        lat[i] = g.lat;
+        lon[i] = g.lon;
+    }
+}
+
+/**
+ * Determines the cell boundaries in spherical coordinates for an array of H3
+ * indexes, written densely into a flat buffer.
+ *
+ * The vertices of all cells are written one after another as lat/lon pairs in
+ * radians, so cell i starts after the sum of numVerts[0..i-1] vertices. Each
+ * index is decoded on its own, as by h3ToGeoBoundary.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param verts Output buffer of lat/lon pairs. Must hold at least
+ *              2 * n * MAX_CELL_BNDRY_VERTS doubles in the worst case.
+ * @param numVerts Output array of n vertex counts.
+ * @return The total number of vertices written.
+ */
+int H3_EXPORT(h3ToGeoBoundaryBatch)(const H3Index* h3, int n, double* verts,
+                                    int* numVerts) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        FaceIJK fijk;
+        GeoBoundary gb;
+        _h3ToFaceIjk(h3[i], &fijk);
+        _faceIjkToGeoBoundary(&fijk, H3_GET_RESOLUTION(h3[i]),
+                              H3_EXPORT(h3IsPentagon)(h3[i]), &gb, NULL);
+
+        numVerts[i] = gb.numVerts;
+        for (int v = 0; v < gb.numVerts; v++) {
+            verts[2 * total] = gb.verts[v].lat;
+            verts[2 * total + 1] = gb.verts[v].lon;
+            total++;
+        }
+    }
+    return total;
+}
+
+/**
+ * Packs an angle in radians as a fixed point number of microdegrees,
+ * rounded to the nearest.
+ */
+static int32_t _packDegrees(double rads) {
+    return (int32_t)lround(rads * M_180_PI * H3_PACKED_UNITS_PER_DEGREE);
+}
+
+/**
+ * Determines the center points of an array of H3 indexes, packed as pairs
+ * of int32 latitude and longitude in microdegrees
+ * (H3_PACKED_UNITS_PER_DEGREE). A microdegree is under 2e-8 radians.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param centers Output array of 2 * n packed coordinates.
+ */
+void H3_EXPORT(h3ToGeoPacked)(const H3Index* h3, int n, int32_t* centers) {
+    for (int i = 0; i < n; i++) {
+        FaceIJK fijk;
+        GeoCoord g;
+        _h3ToFaceIjk(h3[i], &fijk);
+        _faceIjkToGeo(&fijk, H3_GET_RESOLUTION(h3[i]), &g);
+        centers[2 * i] = _packDegrees(g.lat);
+        centers[2 * i + 1] = _packDegrees(g.lon);
+    }
+}
+
+/**
+ * Determines the cell boundaries of an array of H3 indexes, packed for
+ * rendering. The center of each cell is packed as by h3ToGeoPacked, and
+ * each vertex as the float32 offset in degrees of its latitude and
+ * longitude from the packed center. Offsets of longitude are taken the
+ * short way around, so cells crossing the antimeridian have offsets past
+ * 180 degrees from the center rather than wrapping.
+ *
+ * The offsets of all cells are written densely, as verts are by
+ * h3ToGeoBoundaryBatch. Unpacked vertices are within 1e-7 radians of those
+ * of h3ToGeoBoundary, and a hexagon takes 57 bytes instead of the 168 of a
+ * GeoBoundary.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param centers Output array of 2 * n packed coordinates.
+ * @param offsets Output buffer of lat/lon offsets. Must hold at least
+ *                2 * n * MAX_CELL_BNDRY_VERTS floats in the worst case.
+ * @param numVerts Output array of n vertex counts.
+ * @return The total number of vertices written.
+ */
+int H3_EXPORT(h3ToGeoBoundaryPacked)(const H3Index* h3, int n,
+                                     int32_t* centers, float* offsets,
+                                     uint8_t* numVerts) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        GeoCoord center;
+        GeoBoundary gb;
+        H3_EXPORT(h3ToGeoAndBoundary)(h3[i], &center, &gb);
+
+        int32_t packedLat = _packDegrees(center.lat);
+        int32_t packedLon = _packDegrees(center.lon);
+        centers[2 * i] = packedLat;
+        centers[2 * i + 1] = packedLon;
+        double centerLat = (double)packedLat / H3_PACKED_UNITS_PER_DEGREE;
+        double centerLon = (double)packedLon / H3_PACKED_UNITS_PER_DEGREE;
+        numVerts[i] = (uint8_t)gb.numVerts;
+        for (int v = 0; v < gb.numVerts; v++) {
+            double dLat = gb.verts[v].lat * M_180_PI - centerLat;
+            double dLon = gb.verts[v].lon * M_180_PI - centerLon;
+            if (dLon > 180) dLon -= 360;
+            if (dLon < -180) dLon += 360;
+            offsets[2 * total] = (float)dLat;
+            offsets[2 * total + 1] = (float)dLon;
+            total++;
+        }
+    }
+    return total;
+}
+
+/**
+ * Unpacks the boundary of one cell written by h3ToGeoBoundaryPacked, with
+ * longitudes normalized to [-pi, pi].
+ *
+ * @param center The packed center of the cell, 2 coordinates.
+ * @param offsets The offsets of its vertices, 2 * numVerts floats.
+ * @param numVerts The number of vertices.
+ * @param gb Output boundary.
+ */
+void H3_EXPORT(packedToGeoBoundary)(const int32_t* center,
+                                    const float* offsets, int numVerts,
+                                    GeoBoundary* gb) {
+    double centerLat = (double)center[0] / H3_PACKED_UNITS_PER_DEGREE;
+    double centerLon = (double)center[1] / H3_PACKED_UNITS_PER_DEGREE;
+    gb->numVerts = numVerts;
+    for (int v = 0; v < numVerts; v++) {
+        double lon = (centerLon + offsets[2 * v + 1]) * M_PI_180;
+        if (lon > M_PI) lon -= 2 * M_PI;
+        if (lon < -M_PI) lon += 2 * M_PI;
+        gb->verts[v].lat = (centerLat + offsets[2 * v]) * M_PI_180;
+        gb->verts[v].lon = lon;
+    }
+}
+
+/**
+ * Parallel task finding the center points of a range of indexes.
+ *
+ * @param data The BatchParallelData
+ * @param begin The first index
+ * @param end One past the last index
+ */
+static void _h3ToGeoBatchTask(void* data, int begin, int end) {
+    BatchParallelData* batch = data;
+    H3_EXPORT(h3ToGeoBatch)
+    (batch->h3 + begin, end - begin, batch->outLat + begin,
+     batch->outLon + begin);
+}
+
+/**
+ * h3ToGeoBatchParallel produces the same output as h3ToGeoBatch, with the
+ * indexes split into ranges run by parallelFor, as for geoToH3BatchParallel.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param lat Output array of n latitudes, in radians.
+ * @param lon Output array of n longitudes, in radians.
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ */
+void H3_EXPORT(h3ToGeoBatchParallel)(const H3Index* h3, int n, double* lat,
+                                     double* lon, H3ParallelFor parallelFor,
+                                     void* executor) {
+    BatchParallelData data = {0};
+    data.h3 = h3;
+    data.outLat = lat;
+    data.outLon = lon;
+    _batchParallelFor(n, _h3ToGeoBatchTask, &data, parallelFor, executor);
+}
+
+/**
+ * Parallel task finding the boundaries of a range of indexes, each written
+ * at its own fixed offset of MAX_CELL_BNDRY_VERTS vertices.
+ *
+ * @param data The BatchParallelData
+ * @param begin The first index
+ * @param end One past the last index
+ */
+static void _h3ToGeoBoundaryBatchTask(void* data, int begin, int end) {
+    BatchParallelData* batch = data;
+    for (int i = begin; i < end; i++) {
+        FaceIJK fijk;
+        GeoBoundary gb;
+        _h3ToFaceIjk(batch->h3[i], &fijk);
+        _faceIjkToGeoBoundary(&fijk, H3_GET_RESOLUTION(batch->h3[i]),
+                              H3_EXPORT(h3IsPentagon)(batch->h3[i]), &gb,
+                              NULL);
+
+        double* verts = batch->verts + (size_t)2 * MAX_CELL_BNDRY_VERTS * i;
+        batch->numVerts[i] = gb.numVerts;
+        for (int v = 0; v < gb.numVerts; v++) {
+            verts[2 * v] = gb.verts[v].lat;
+            verts[2 * v + 1] = gb.verts[v].lon;
+        }
+    }
+}
+
+/**
+ * h3ToGeoBoundaryBatchParallel produces the same output as
+ * h3ToGeoBoundaryBatch, with the indexes split into ranges run by
+ * parallelFor, as for geoToH3BatchParallel.
+ *
+ * Before it is known where each boundary starts in the dense output, each is
+ * written at the offset it would have if every cell had
+ * MAX_CELL_BNDRY_VERTS vertices. The boundaries are then moved down into
+ * place on the calling thread, which is much cheaper than finding them.
+ *
+ * @param h3 The H3 indexes.
+ * @param n The number of indexes.
+ * @param verts Output buffer of lat/lon pairs. Must hold
+ *              2 * n * MAX_CELL_BNDRY_VERTS doubles.
+ * @param numVerts Output array of n vertex counts.
+ * @param parallelFor The function running tasks, or NULL
+ * @param executor Passed through to parallelFor
+ * @return The total number of vertices written.
+ */
+int H3_EXPORT(h3ToGeoBoundaryBatchParallel)(const H3Index* h3, int n,
+                                            double* verts, int* numVerts,
+                                            H3ParallelFor parallelFor,
+                                            void* executor) {
+    if (parallelFor == NULL) {
+        return H3_EXPORT(h3ToGeoBoundaryBatch)(h3, n, verts, numVerts);
+    }
+    BatchParallelData data = {0};
+    data.h3 = h3;
+    data.verts = verts;
+    data.numVerts = numVerts;
+    _batchParallelFor(n, _h3ToGeoBoundaryBatchTask, &data, parallelFor,
+                      executor);
+
+    // Boundaries only move towards the start, so moving them in order never
+    // overwrites one not yet moved
+    size_t total = 0;
+    for (int i = 0; i < n; i++) {
+        size_t offset = (size_t)MAX_CELL_BNDRY_VERTS * i;
+        if (offset != total) {
+            memmove(verts + 2 * total, verts + 2 * offset,
+                    2 * numVerts[i] * sizeof(double));
+        }
+        total += numVerts[i];
+    }
+    return (int)total;
 }
 
 /**
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3IndexSet.c
+ * @brief   Open addressed hash sets of indexes
+ *
+ * The slots hold the indexes themselves, 0 marking an empty slot, and are
+ * probed linearly from the hash of the index. A set is kept at most half
+ * full. Removing an index moves later indexes of its probe sequence back
+ * into the freed slot, so no tombstones are left. Adding concurrently claims
+ * an empty slot with a compare and swap, so many threads can add to the same
+ * set without locks; the set does not grow then, and must be created with
+ * enough capacity.
+ */
+
+#include "h3IndexSet.h"
+#include <assert.h>
+#include "h3Alloc.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define H3_ATOMIC_LOAD(ptr) (*(volatile H3Index*)(ptr))
+#define H3_ATOMIC_CAS(ptr, expected, desired)                   \
+    (_InterlockedCompareExchange64((volatile __int64*)(ptr),    \
+                                   (__int64)(desired),          \
+                                   (__int64)(expected)) ==      \
+     (__int64)(expected))
+#define H3_ATOMIC_INCREMENT(ptr) _InterlockedIncrement((volatile long*)(ptr))
+#else
+#define H3_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define H3_ATOMIC_CAS(ptr, expected, desired)                      \
+    __atomic_compare_exchange_n((ptr), &(expected), (desired), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define H3_ATOMIC_INCREMENT(ptr) __atomic_fetch_add((ptr), 1, __ATOMIC_RELAXED)
+#endif
+
+/**
+ * createH3IndexSet creates an empty set, with room for the given number of
+ * indexes before it grows.
+ *
+ * @param capacity The number of indexes the set holds without growing,
+ * which is also the most that can be added concurrently
+ * @return The set, which the caller must free with destroyH3IndexSet
+ */
+H3IndexSet* H3_EXPORT(createH3IndexSet)(int capacity) {
+    int numSlots = 16;
+    while (numSlots < 2 * capacity && numSlots < (1 << 30)) {
+        numSlots *= 2;
+    }
+    H3IndexSet* set = H3_MEMORY(malloc)(sizeof(H3IndexSet));
+    assert(set != NULL);
+    set->slots = H3_MEMORY(calloc)(numSlots, sizeof(H3Index));
+    assert(set->slots != NULL);
+    set->mask = numSlots - 1;
+    set->size = 0;
+    return set;
+}
+
+/**
+ * Doubles the number of slots of a set, rehashing its indexes.
+ *
+ * @param set The set
+ */
+static void _h3IndexSetGrow(H3IndexSet* set) {
+    int oldNumSlots = set->mask + 1;
+    H3Index* oldSlots = set->slots;
+    set->mask = 2 * oldNumSlots - 1;
+    set->slots = H3_MEMORY(calloc)(2 * oldNumSlots, sizeof(H3Index));
+    assert(set->slots != NULL);
+    for (int i = 0; i < oldNumSlots; i++) {
+        if (oldSlots[i] == 0) continue;
+        int slot = (int)(_h3IndexHash(oldSlots[i]) & set->mask);
+        while (set->slots[slot] != 0) {
+            slot = (slot + 1) & set->mask;
+        }
+        set->slots[slot] = oldSlots[i];
+    }
+    H3_MEMORY(free)(oldSlots);
+}
+
+/**
+ * h3IndexSetAdd adds an index to a set, growing the set to keep at most half
+ * of its slots occupied. It must not run at the same time as any other
+ * function on the same set.
+ *
+ * @param set The set
+ * @param h The index to add
+ * @return 1 if the index was added, 0 if it was already present or is 0
+ */
+int H3_EXPORT(h3IndexSetAdd)(H3IndexSet* set, H3Index h) {
+    if (h == 0) return 0;
+    if (2 * (set->size + 1) > set->mask + 1) {
+        _h3IndexSetGrow(set);
+    }
+    int slot = (int)(_h3IndexHash(h) & set->mask);
+    while (set->slots[slot] != 0) {
+        if (set->slots[slot] == h) {
+            return 0;
+        }
+        slot = (slot + 1) & set->mask;
+    }
+    set->slots[slot] = h;
+    set->size++;
+    return 1;
+}
+
+/**
+ * h3IndexSetAddConcurrent adds an index to a set, safely while other threads
+ * add to the same set with h3IndexSetAddConcurrent. The set never grows, so
+ * at most the capacity it was created with can be added; other functions may
+ * be called on the set once every concurrent add has completed.
+ *
+ * @param set The set
+ * @param h The index to add
+ * @return 1 if the index was added, 0 if it was already present or is 0, or
+ * -1 if the set is full
+ */
+int H3_EXPORT(h3IndexSetAddConcurrent)(H3IndexSet* set, H3Index h) {
+    if (h == 0) return 0;
+    int slot = (int)(_h3IndexHash(h) & set->mask);
+    for (int probes = 0; probes <= set->mask; probes++) {
+        H3Index current = H3_ATOMIC_LOAD(&set->slots[slot]);
+        if (current == 0) {
+            if (H3_ATOMIC_CAS(&set->slots[slot], current, h)) {
+                H3_ATOMIC_INCREMENT(&set->size);
+                return 1;
+            }
+            // Another thread claimed the slot first, perhaps for h
+            current = H3_ATOMIC_LOAD(&set->slots[slot]);
+        }
+        if (current == h) {
+            return 0;
+        }
+        slot = (slot + 1) & set->mask;
+    }
+    return -1;
+}
+
+/**
+ * h3IndexSetRemove removes an index from a set. Every index after it in
+ * the same run of occupied slots that may occupy the freed slot is moved
+ * back into it, leaving no gap between any index and its first slot. It
+ * must not run at the same time as any other function on the same set.
+ *
+ * @param set The set
+ * @param h The index to remove
+ * @return 1 if the index was removed, 0 if it was not present or is 0
+ */
+int H3_EXPORT(h3IndexSetRemove)(H3IndexSet* set, H3Index h) {
+    if (h == 0) return 0;
+    int hole = (int)(_h3IndexHash(h) & set->mask);
+    while (set->slots[hole] != h) {
+        if (set->slots[hole] == 0) return 0;
+        hole = (hole + 1) & set->mask;
+    }
+    for (int slot = (hole + 1) & set->mask; set->slots[slot] != 0;
+         slot = (slot + 1) & set->mask) {
+        int first = (int)(_h3IndexHash(set->slots[slot]) & set->mask);
+        // The index may move back if the hole is between its first slot
+        // and its current one
+        if (((slot - first) & set->mask) >= ((slot - hole) & set->mask)) {
+            set->slots[hole] = set->slots[slot];
+            hole = slot;
+        }
+    }
+    set->slots[hole] = 0;
+    set->size--;
+    return 1;
+}
+
+/**
+ * h3IndexSetContains tests whether a set holds an index.
+ *
+ * @param set The set
+ * @param h The index
+ * @return 1 if the set holds the index, 0 otherwise
+ */
+int H3_EXPORT(h3IndexSetContains)(const H3IndexSet* set, H3Index h) {
+    if (h == 0) return 0;
+    int slot = (int)(_h3IndexHash(h) & set->mask);
+    for (int probes = 0; probes <= set->mask; probes++) {
+        if (set->slots[slot] == h) return 1;
+        if (set->slots[slot] == 0) return 0;
+        slot = (slot + 1) & set->mask;
+    }
+    return 0;
+}
+
+/**
+ * h3IndexSetSize returns the number of indexes in a set.
+ *
+ * @param set The set
+ * @return The number of indexes
+ */
+int H3_EXPORT(h3IndexSetSize)(const H3IndexSet* set) { return set->size; }
+
+/**
+ * h3IndexSetToArray writes the indexes of a set, densely and in no
+ * particular order.
+ *
+ * @param set The set
+ * @param out Output array of h3IndexSetSize(set) indexes
+ * @return The number of indexes written
+ */
+int H3_EXPORT(h3IndexSetToArray)(const H3IndexSet* set, H3Index* out) {
+    int numWritten = 0;
+    for (int i = 0; i <= set->mask; i++) {
+        if (set->slots[i] != 0) out[numWritten++] = set->slots[i];
+    }
+    return numWritten;
+}
+
+/**
+ * destroyH3IndexSet frees a set returned by createH3IndexSet.
+ *
+ * @param set The set
+ */
+void H3_EXPORT(destroyH3IndexSet)(H3IndexSet* set) {
+    H3_MEMORY(free)(set->slots);
+    H3_MEMORY(free)(set);
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3RegionIndex.c
+ * @brief   Flat, position independent index of regions by compacted hexagons
+ *
+ * The regions are filled at one resolution, and the hexagons of each region
+ * compacted. The index is a single block of memory: a header, the keys of
+ * the hexagons sorted as in an H3SortedSet, and the region of each hexagon.
+ * Holding no pointers, it can be written to a file and mapped back into
+ * memory, and queried in place without any parsing.
+ */
+
+#include "h3RegionIndex.h"
+#include <assert.h>
+#include <string.h>
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3SortedSet.h"
+
+/** @brief Hexagon keys written in ascending order with their regions */
+typedef struct {
+    H3Index* keys;   ///< the keys written
+    int32_t* ids;    ///< the region of each key
+    int numKeys;     ///< the number of keys written
+} RegionStack;
+
+/**
+ * Sort hexagons in ascending order with a least significant digit first
+ * radix sort, one byte at a time, as _radixSortH3Indexes does. The sort is
+ * stable, so equal hexagons keep their order.
+ * @param cells Hexagons to sort
+ * @param temp Working memory of the same size
+ * @param numCells Number of hexagons
+ * @return The array holding the sorted hexagons, either cells or temp
+ */
+PolyfillCell* _radixSortPolyfillCells(PolyfillCell* cells, PolyfillCell* temp,
+                                      int numCells) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        int counts[256] = {0};
+        for (int i = 0; i < numCells; i++) {
+            counts[(cells[i].h3 >> shift) & 0xff]++;
+        }
+        if (counts[(cells[0].h3 >> shift) & 0xff] == numCells) {
+            continue;
+        }
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < numCells; i++) {
+            temp[counts[(cells[i].h3 >> shift) & 0xff]++] = cells[i];
+        }
+        PolyfillCell* swap = cells;
+        cells = temp;
+        temp = swap;
+    }
+    return cells;
+}
+
+/**
+ * Appends a key and its region after every key already written. If it
+ * completes the children of its parent, all in the same region, they are
+ * replaced by the parent, as the keys of an H3SortedSet are merged.
+ *
+ * @param stack The keys written, with room for one more
+ * @param key The key to append
+ * @param id The region of the key
+ */
+static void _regionStackPush(RegionStack* stack, H3Index key, int32_t id) {
+    int res = _h3SortedSetKeyRes(key);
+    while (res > 0 && H3_GET_INDEX_DIGIT(key, res) == 6) {
+        H3Index digitMask = H3_DIGIT_MASK
+                            << ((MAX_H3_RES - res) * H3_PER_DIGIT_OFFSET);
+        H3Index parent = key | digitMask;
+        int numSiblings = _h3SortedSetKeyIsPentagon(parent, res - 1) ? 5 : 6;
+        if (stack->numKeys < numSiblings) break;
+        int complete = 1;
+        for (int i = stack->numKeys - numSiblings; i < stack->numKeys; i++) {
+            if (stack->ids[i] != id ||
+                _h3SortedSetKeyRes(stack->keys[i]) != res ||
+                (stack->keys[i] | digitMask) != parent) {
+                complete = 0;
+                break;
+            }
+        }
+        if (!complete) break;
+        stack->numKeys -= numSiblings;
+        key = parent;
+        res--;
+    }
+    stack->keys[stack->numKeys] = key;
+    stack->ids[stack->numKeys] = id;
+    stack->numKeys++;
+}
+
+/**
+ * createH3RegionIndex builds an index of the regions containing points.
+ * Each polygon is filled at res as polyfillMany fills it, and its hexagons
+ * are compacted and recorded with the id of its region. Where polygons
+ * overlap, a hexagon goes to the first polygon containing its center.
+ *
+ * The index is one block of memory holding no pointers, which may be
+ * written to a file as is, and later queried from a copy, or from a memory
+ * mapping of the file, aligned to at least 8 bytes. It can only be queried
+ * on a machine of the same byte order.
+ *
+ * @param polygons The polygons of the regions
+ * @param regionIds The region of each polygon, or NULL to use the index of
+ * each polygon as its region
+ * @param numPolygons The number of polygons
+ * @param res The resolution the polygons are filled at (0-15)
+ * @param size Output size of the index, in bytes
+ * @return The index, which the caller must free with destroyH3RegionIndex,
+ * or NULL if the resolution is invalid
+ */
+void* H3_EXPORT(createH3RegionIndex)(const GeoPolygon* polygons,
+                                     const int* regionIds, int numPolygons,
+                                     int res, size_t* size) {
+    if (res < 0 || res > MAX_H3_RES) {
+        return NULL;
+    }
+
+    // Fill into a guessed buffer, and again into one of the right size if
+    // the guess was too small
+    int capacity = 1 << 16;
+    PolyfillCell* cells =
+        H3_MEMORY(malloc)(2 * capacity * sizeof(PolyfillCell));
+    assert(cells != NULL);
+    int numCells =
+        H3_EXPORT(polyfillMany)(polygons, numPolygons, res, cells, capacity);
+    if (numCells > capacity) {
+        capacity = numCells;
+        H3_MEMORY(free)(cells);
+        cells = H3_MEMORY(malloc)(2 * capacity * sizeof(PolyfillCell));
+        assert(cells != NULL);
+        H3_EXPORT(polyfillMany)(polygons, numPolygons, res, cells, capacity);
+    }
+    PolyfillCell* sorted = cells;
+    if (numCells > 0) {
+        sorted = _radixSortPolyfillCells(cells, cells + capacity, numCells);
+    }
+
+    void* index =
+        _h3RegionIndexFromSortedCells(sorted, numCells, regionIds, res, size);
+    H3_MEMORY(free)(cells);
+    return index;
+}
+
+/**
+ * Builds a region index from hexagons sorted by _radixSortPolyfillCells.
+ * Where a hexagon is repeated, it goes to the first of its copies.
+ *
+ * @param sorted The sorted hexagons
+ * @param numCells The number of hexagons
+ * @param regionIds The region of each polygon, or NULL to use the index of
+ * each polygon as its region
+ * @param res The resolution of the hexagons
+ * @param size Output size of the index, in bytes
+ * @return The index, which the caller must free with destroyH3RegionIndex
+ */
+void* _h3RegionIndexFromSortedCells(const PolyfillCell* sorted, int numCells,
+                                    const int* regionIds, int res,
+                                    size_t* size) {
+    RegionStack stack;
+    stack.keys = H3_MEMORY(malloc)((numCells + 1) * sizeof(H3Index));
+    stack.ids = H3_MEMORY(malloc)((numCells + 1) * sizeof(int32_t));
+    assert(stack.keys != NULL && stack.ids != NULL);
+    stack.numKeys = 0;
+    for (int i = 0; i < numCells; i++) {
+        if (i > 0 && sorted[i].h3 == sorted[i - 1].h3) continue;
+        int32_t id = regionIds ? regionIds[sorted[i].polygon]
+                               : sorted[i].polygon;
+        _regionStackPush(&stack, sorted[i].h3 & H3_SORTED_SET_KEY_MASK, id);
+    }
+
+    size_t numRanges = stack.numKeys;
+    *size = sizeof(H3RegionIndexHeader) +
+            numRanges * (sizeof(uint64_t) + sizeof(int32_t));
+    H3RegionIndexHeader* header = H3_MEMORY(calloc)(1, *size);
+    assert(header != NULL);
+    memcpy(header->magic, H3_REGION_INDEX_MAGIC, sizeof(header->magic));
+    header->byteOrder = H3_REGION_INDEX_BYTE_ORDER;
+    header->version = H3_REGION_INDEX_VERSION;
+    header->res = res;
+    header->numRanges = numRanges;
+
+    uint64_t* keys = (uint64_t*)(header + 1);
+    int32_t* ids = (int32_t*)(keys + numRanges);
+    memcpy(keys, stack.keys, numRanges * sizeof(uint64_t));
+    memcpy(ids, stack.ids, numRanges * sizeof(int32_t));
+    size_t r = 0;
+    for (int bc = 0; bc <= NUM_BASE_CELLS; bc++) {
+        while (r < numRanges && (int)(keys[r] >> H3_BC_OFFSET) < bc) r++;
+        header->baseCellStarts[bc] = r;
+    }
+
+    H3_MEMORY(free)(stack.keys);
+    H3_MEMORY(free)(stack.ids);
+    return header;
+}
+
+/**
+ * h3RegionIndexIsValid checks that a block of memory, such as a mapped
+ * file, holds a complete region index built on a machine of the same byte
+ * order. The check only reads the header.
+ *
+ * @param index The index
+ * @param size The size of the block of memory, in bytes
+ * @return 1 if the index can be queried, 0 otherwise
+ */
+int H3_EXPORT(h3RegionIndexIsValid)(const void* index, size_t size) {
+    if (size < sizeof(H3RegionIndexHeader)) {
+        return 0;
+    }
+    const H3RegionIndexHeader* header = index;
+    if (memcmp(header->magic, H3_REGION_INDEX_MAGIC, sizeof(header->magic)) ||
+        header->byteOrder != H3_REGION_INDEX_BYTE_ORDER ||
+        header->version != H3_REGION_INDEX_VERSION || header->res < 0 ||
+        header->res > MAX_H3_RES) {
+        return 0;
+    }
+    size_t rangeSize = sizeof(uint64_t) + sizeof(int32_t);
+    if (header->numRanges > (size - sizeof(H3RegionIndexHeader)) / rangeSize ||
+        size != sizeof(H3RegionIndexHeader) + header->numRanges * rangeSize) {
+        return 0;
+    }
+    if (header->baseCellStarts[0] != 0 ||
+        header->baseCellStarts[NUM_BASE_CELLS] != header->numRanges) {
+        return 0;
+    }
+    for (int bc = 0; bc < NUM_BASE_CELLS; bc++) {
+        if (header->baseCellStarts[bc] > header->baseCellStarts[bc + 1]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * h3RegionIndexLookupCell finds the region containing a hexagon, by a
+ * binary search over the hexagons of its base cell.
+ *
+ * @param index A valid index
+ * @param h The hexagon, at any resolution
+ * @param regionId Output region containing the hexagon
+ * @return 1 if a region contains the whole hexagon, 0 otherwise
+ */
+int H3_EXPORT(h3RegionIndexLookupCell)(const void* index, H3Index h,
+                                       int* regionId) {
+    const H3RegionIndexHeader* header = index;
+    const uint64_t* keys = (const uint64_t*)(header + 1);
+    const int32_t* ids = (const int32_t*)(keys + header->numRanges);
+
+    int bc = H3_GET_BASE_CELL(h);
+    if (bc >= NUM_BASE_CELLS) {
+        return 0;
+    }
+    H3Index key = h & H3_SORTED_SET_KEY_MASK;
+    uint64_t low = header->baseCellStarts[bc];
+    uint64_t high = header->baseCellStarts[bc + 1];
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (keys[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < header->baseCellStarts[bc + 1] &&
+        _h3SortedSetRangeStart(keys[low]) <= _h3SortedSetRangeStart(key)) {
+        *regionId = ids[low];
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * h3RegionIndexLookup finds the region containing a point, by indexing it
+ * at the resolution of the index and looking up its hexagon.
+ *
+ * @param index A valid index
+ * @param g The point
+ * @param regionId Output region containing the point
+ * @return 1 if a region contains the point, 0 otherwise
+ */
+int H3_EXPORT(h3RegionIndexLookup)(const void* index, const GeoCoord* g,
+                                   int* regionId) {
+    const H3RegionIndexHeader* header = index;
+    H3Index h = H3_EXPORT(geoToH3)(g, header->res);
+    if (h == H3_INVALID_INDEX) {
+        return 0;
+    }
+    return H3_EXPORT(h3RegionIndexLookupCell)(index, h, regionId);
+}
+
+/**
+ * destroyH3RegionIndex frees an index returned by createH3RegionIndex.
+ *
+ * @param index The index
+ */
+void H3_EXPORT(destroyH3RegionIndex)(void* index) { H3_MEMORY(free)(index); }
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3SetBinary.c
+ * @brief   Compact binary encoding of sets of hexagons
+ *
+ * The hexagons are sorted and grouped by resolution. Within a resolution r,
+ * a hexagon is identified by its position, the base cell followed by the r
+ * used digits packed at 3 bits each, so that the hexagons of a contiguous
+ * area have nearby positions. Each group is encoded as:
+ *
+ *     resolution (1 byte) | count (varint) | position deltas (varints)
+ *
+ * after the magic bytes and the total number of hexagons as a varint. The
+ * first delta of a group is its first position, and every later delta is
+ * the positive difference from the previous position. Varints are little
+ * endian base 128, with the high bit of each byte set if another follows.
+ */
+
+#include "h3SetBinary.h"
+#include <assert.h>
+#include <string.h>
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3api_inline.h"
+
+/** 1's in the base cell and digit bits, which hold the position */
+#define POSITION_MASK ((UINT64_C(1) << H3_RES_OFFSET) - 1)
+
+/**
+ * Writes a varint.
+ *
+ * @param value The value to write
+ * @param out Output of up to 10 bytes
+ * @return The number of bytes written
+ */
+size_t _writeVarint(uint64_t value, uint8_t* out) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (uint8_t)value;
+    return size;
+}
+
+/**
+ * Reads a varint of at most 64 bits.
+ *
+ * @param in The bytes to read
+ * @param size The number of bytes available
+ * @param value Output value
+ * @return The number of bytes read, or 0 if the varint is truncated or too
+ * long
+ */
+size_t _readVarint(const uint8_t* in, size_t size, uint64_t* value) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < size && i < 10; i++) {
+        result |= (uint64_t)(in[i] & 0x7f) << (7 * i);
+        if (in[i] < 0x80) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * maxH3SetToBinarySize returns the most bytes h3SetToBinary writes for a set
+ * of the given size.
+ *
+ * @param numHexes The number of entries in the set
+ * @return The size of the output buffer needed
+ */
+size_t H3_EXPORT(maxH3SetToBinarySize)(int numHexes) {
+    if (numHexes < 0) numHexes = 0;
+    return H3_SET_BINARY_MAGIC_SIZE + H3_SET_BINARY_MAX_COUNT_BYTES +
+           (MAX_H3_RES + 1) * (1 + H3_SET_BINARY_MAX_COUNT_BYTES) +
+           (size_t)numHexes * H3_SET_BINARY_MAX_POSITION_BYTES;
+}
+
+/**
+ * h3SetToBinary encodes a set of hexagons of any resolutions, such as the
+ * output of compact. Empty entries and duplicates are skipped, and the
+ * hexagons may be in any order; already sorted input skips the sort.
+ *
+ * @param h3Set The hexagons
+ * @param numHexes The number of entries in h3Set
+ * @param out Output buffer of maxH3SetToBinarySize(numHexes) bytes
+ * @param outSize Output number of bytes written
+ * @return 0 on success, or -1 if an entry is not a valid hexagon
+ */
+int H3_EXPORT(h3SetToBinary)(const H3Index* h3Set, int numHexes, uint8_t* out,
+                             size_t* outSize) {
+    int numValid = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] == 0) continue;
+        if (!h3IsValidInline(h3Set[i])) return -1;
+        numValid++;
+    }
+
+    // Sort a copy without the empty entries, unless already sorted
+    H3Index* buffer = NULL;
+    const H3Index* sorted = h3Set;
+    int isSorted = 1;
+    for (int i = 0; i < numHexes && isSorted; i++) {
+        isSorted = h3Set[i] != 0 && (i == 0 || h3Set[i - 1] <= h3Set[i]);
+    }
+    if (!isSorted) {
+        buffer = H3_MEMORY(malloc)(2 * numValid * sizeof(H3Index));
+        assert(buffer != NULL);
+        int n = 0;
+        for (int i = 0; i < numHexes; i++) {
+            if (h3Set[i] != 0) buffer[n++] = h3Set[i];
+        }
+        sorted = _radixSortH3Indexes(buffer, buffer + numValid, numValid);
+        numHexes = numValid;
+    }
+
+    // Count the distinct hexagons before writing the total
+    int numDistinct = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (i == 0 || sorted[i] != sorted[i - 1]) numDistinct++;
+    }
+
+    size_t size = H3_SET_BINARY_MAGIC_SIZE;
+    memcpy(out, H3_SET_BINARY_MAGIC, H3_SET_BINARY_MAGIC_SIZE);
+    size += _writeVarint((uint64_t)numDistinct, out + size);
+
+    int i = 0;
+    while (i < numHexes) {
+        int res = h3GetResolutionInline(sorted[i]);
+        int shift = (MAX_H3_RES - res) * H3_PER_DIGIT_OFFSET;
+        H3Index resBits = (H3Index)res << H3_RES_OFFSET;
+
+        // Count the group, which ends at the first finer resolution
+        int count = 0;
+        int end = i;
+        while (end < numHexes && (sorted[end] & H3_RES_MASK) == resBits) {
+            if (end == i || sorted[end] != sorted[end - 1]) count++;
+            end++;
+        }
+
+        out[size++] = (uint8_t)res;
+        size += _writeVarint((uint64_t)count, out + size);
+        uint64_t previous = 0;
+        for (int first = i; i < end; i++) {
+            if (i > first && sorted[i] == sorted[i - 1]) continue;
+            uint64_t position = (sorted[i] & POSITION_MASK) >> shift;
+            size += _writeVarint(position - previous, out + size);
+            previous = position;
+        }
+    }
+
+    H3_MEMORY(free)(buffer);
+    *outSize = size;
+    return 0;
+}
+
+/**
+ * binaryToH3SetSize reads the number of hexagons of an encoded set, which
+ * is the size of the output needed by binaryToH3Set.
+ *
+ * @param in The encoded set
+ * @param size The number of bytes of the encoded set
+ * @return The number of hexagons, or -1 if the encoding is not recognized
+ */
+int H3_EXPORT(binaryToH3SetSize)(const uint8_t* in, size_t size) {
+    if (size < H3_SET_BINARY_MAGIC_SIZE ||
+        memcmp(in, H3_SET_BINARY_MAGIC, H3_SET_BINARY_MAGIC_SIZE) != 0) {
+        return -1;
+    }
+    uint64_t numHexes;
+    if (!_readVarint(in + H3_SET_BINARY_MAGIC_SIZE,
+                     size - H3_SET_BINARY_MAGIC_SIZE, &numHexes) ||
+        numHexes > INT32_MAX) {
+        return -1;
+    }
+    return (int)numHexes;
+}
+
+/**
+ * binaryToH3Set decodes a set encoded by h3SetToBinary. The hexagons are
+ * written densely and in ascending order, so a compacted set is decoded
+ * directly into the form compact writes.
+ *
+ * Every hexagon is checked to be valid, so a corrupted encoding is reported
+ * rather than decoded into invalid indexes.
+ *
+ * @param in The encoded set
+ * @param size The number of bytes of the encoded set
+ * @param out Output array of binaryToH3SetSize(in, size) hexagons
+ * @param maxHexes The size of the output array
+ * @return The number of hexagons written, -1 if the encoding is malformed,
+ * or -2 if the output array is too small
+ */
+int H3_EXPORT(binaryToH3Set)(const uint8_t* in, size_t size, H3Index* out,
+                             int maxHexes) {
+    int numHexes = H3_EXPORT(binaryToH3SetSize)(in, size);
+    if (numHexes < 0) return -1;
+    if (numHexes > maxHexes) return -2;
+
+    size_t offset = H3_SET_BINARY_MAGIC_SIZE;
+    uint64_t value;
+    offset += _readVarint(in + offset, size - offset, &value);
+
+    int numWritten = 0;
+    int minRes = 0;
+    while (numWritten < numHexes) {
+        if (offset >= size) return -1;
+        int res = in[offset++];
+        if (res < minRes || res > MAX_H3_RES) return -1;
+        minRes = res + 1;
+
+        size_t read = _readVarint(in + offset, size - offset, &value);
+        if (!read || value == 0 || value > (uint64_t)(numHexes - numWritten)) {
+            return -1;
+        }
+        offset += read;
+        int count = (int)value;
+
+        int shift = (MAX_H3_RES - res) * H3_PER_DIGIT_OFFSET;
+        uint64_t maxPosition = (uint64_t)H3_INLINE_NUM_BASE_CELLS
+                               << (res * H3_PER_DIGIT_OFFSET);
+        H3Index header = ((H3Index)H3_HEXAGON_MODE << H3_MODE_OFFSET) |
+                         ((H3Index)res << H3_RES_OFFSET) |
+                         h3DigitsBelowInline(res);
+        int digitShift = res * H3_PER_DIGIT_OFFSET;
+        uint64_t lowDigitBits =
+            H3_INLINE_DIGIT_LOW_BITS & ((UINT64_C(1) << digitShift) - 1);
+        uint64_t position = 0;
+        for (int i = 0; i < count; i++) {
+            uint64_t delta;
+            if (offset < size && in[offset] < 0x80) {
+                delta = in[offset++];
+            } else {
+                read = _readVarint(in + offset, size - offset, &delta);
+                if (!read) return -1;
+                offset += read;
+            }
+            if (delta == 0 && i > 0) return -1;
+            position += delta;
+            if (position >= maxPosition || delta >= maxPosition) return -1;
+            // The base cell is in range, so only a digit of 7 or a deleted
+            // pentagon child can be invalid
+            uint64_t sevens =
+                position & (position >> 1) & (position >> 2) & lowDigitBits;
+            H3Index h = header | (position << shift);
+            if (sevens || (h3BaseCellIsPentagonInline(
+                               (int)(position >> digitShift)) &&
+                           !h3IsValidInline(h))) {
+                return -1;
+            }
+            out[numWritten++] = h;
+        }
+    }
+    return offset == size ? numWritten : -1;
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Shard.c
+ * @brief   Tables of contiguous ranges of hexagons assigned to shards
+ *
+ * The hexagons of the prefix resolution are taken in index order, which is
+ * the order of their ordinals, and cut into one contiguous range per shard
+ * so that the weight of the ranges is as even as the hexagons allow. The
+ * descendants of a hexagon follow each other in index order, so a shard
+ * holds whole regions, and any finer hexagon is routed by the range of its
+ * ancestor at the prefix resolution, found by binary search over the first
+ * hexagon of each range.
+ */
+
+#include "h3Shard.h"
+#include <assert.h>
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3api_inline.h"
+
+/**
+ * Allocates a table of shards at a resolution.
+ *
+ * @param res The resolution of the range boundaries
+ * @param numShards The number of shards
+ * @return The table, with its starts and weights unset
+ */
+static H3ShardTable* _createH3ShardTable(int res, int numShards) {
+    H3ShardTable* table = H3_MEMORY(malloc)(sizeof(H3ShardTable));
+    assert(table != NULL);
+    table->res = res;
+    table->numShards = numShards;
+    table->starts = H3_MEMORY(malloc)(numShards * sizeof(H3Index));
+    assert(table->starts != NULL);
+    table->weights = H3_MEMORY(calloc)(numShards, sizeof(double));
+    assert(table->weights != NULL);
+    return table;
+}
+
+/**
+ * Cuts the weighted hexagons of the table's resolution into contiguous
+ * ranges. Each range ends where the cumulative weight comes nearest to the
+ * share of the total up to it, keeping at least one hexagon in every range;
+ * hexagons of no weight go to the range before them. If the
+ * total weight is not positive, the hexagons are counted instead, and the
+ * weight of each shard is its number of hexagons.
+ *
+ * @param table The table, whose starts and weights are set
+ * @param weights The weight of each hexagon, by ordinal
+ * @param numCells The number of hexagons at the resolution
+ */
+static void _h3ShardCut(H3ShardTable* table, const double* weights,
+                        int64_t numCells) {
+    double total = 0;
+    for (int64_t i = 0; i < numCells; i++) {
+        total += weights[i];
+    }
+    int uniform = !(total > 0);
+    if (uniform) total = (double)numCells;
+
+    int numShards = table->numShards;
+    int64_t start = 0;
+    int64_t i = 0;
+    double prefix = 0;
+    double shardStart = 0;
+    for (int s = 0; s < numShards; s++) {
+        table->starts[s] = H3_EXPORT(ordinalToH3)(start, table->res);
+        int64_t end = numCells;
+        if (s < numShards - 1) {
+            double target = total * (s + 1) / numShards;
+            int64_t minEnd = start + 1;
+            int64_t maxEnd = numCells - (numShards - s - 1);
+            while (i < minEnd) {
+                prefix += uniform ? 1.0 : weights[i];
+                i++;
+            }
+            // Take the next hexagon while the range stays within its share,
+            // or passes it by less than it falls short
+            while (i < maxEnd) {
+                double next = prefix + (uniform ? 1.0 : weights[i]);
+                if (next > target && !(next - target < target - prefix)) {
+                    break;
+                }
+                prefix = next;
+                i++;
+            }
+            end = i;
+        } else {
+            prefix = total;
+        }
+        table->weights[s] = prefix - shardStart;
+        shardStart = prefix;
+        start = end;
+    }
+}
+
+/**
+ * createH3ShardTable cuts the hexagons of a resolution into contiguous,
+ * balanced ranges, weighing each hexagon with a function.
+ *
+ * @param res The resolution of the ranges, from 0 to H3_SHARD_MAX_RES
+ * @param numShards The number of shards, at most numHexagons(res)
+ * @param weight The weight of a hexagon, at least 0, called once for each in
+ * index order; NULL to weigh each the same
+ * @param data Passed to weight
+ * @return The table, or NULL if res or numShards is out of range. It is the
+ * responsibility of the caller to call destroyH3ShardTable on it.
+ */
+H3ShardTable* H3_EXPORT(createH3ShardTable)(int res, int numShards,
+                                            H3CellWeightFunc weight,
+                                            void* data) {
+    if (res < 0 || res > H3_SHARD_MAX_RES || numShards < 1 ||
+        numShards > H3_EXPORT(numHexagons)(res)) {
+        return NULL;
+    }
+    int64_t numCells = H3_EXPORT(numHexagons)(res);
+    double* weights = H3_MEMORY(calloc)(numCells, sizeof(double));
+    assert(weights != NULL);
+    if (weight != NULL) {
+        for (int64_t i = 0; i < numCells; i++) {
+            weights[i] = weight(data, H3_EXPORT(ordinalToH3)(i, res));
+        }
+    }
+    H3ShardTable* table = _createH3ShardTable(res, numShards);
+    _h3ShardCut(table, weights, numCells);
+    H3_MEMORY(free)(weights);
+    return table;
+}
+
+/**
+ * createH3ShardTableFromSamples cuts the hexagons of a resolution into
+ * contiguous, balanced ranges, weighing each hexagon by the samples it
+ * contains.
+ *
+ * @param res The resolution of the ranges, from 0 to H3_SHARD_MAX_RES
+ * @param numShards The number of shards, at most numHexagons(res)
+ * @param samples The sampled hexagons, at res or finer; coarser ones and 0
+ * are skipped
+ * @param weights The weight of each sample, at least 0, or NULL to count
+ * them
+ * @param numSamples The number of samples
+ * @return The table, or NULL if res or numShards is out of range. It is the
+ * responsibility of the caller to call destroyH3ShardTable on it.
+ */
+H3ShardTable* H3_EXPORT(createH3ShardTableFromSamples)(
+    int res, int numShards, const H3Index* samples, const double* weights,
+    int numSamples) {
+    if (res < 0 || res > H3_SHARD_MAX_RES || numShards < 1 ||
+        numShards > H3_EXPORT(numHexagons)(res)) {
+        return NULL;
+    }
+    int64_t numCells = H3_EXPORT(numHexagons)(res);
+    double* histogram = H3_MEMORY(calloc)(numCells, sizeof(double));
+    assert(histogram != NULL);
+    for (int i = 0; i < numSamples; i++) {
+        if (samples[i] == 0 || H3_GET_RESOLUTION(samples[i]) < res) continue;
+        H3Index prefix = h3ToParentInline(samples[i], res);
+        histogram[H3_EXPORT(h3ToOrdinal)(prefix)] +=
+            weights == NULL ? 1.0 : weights[i];
+    }
+    H3ShardTable* table = _createH3ShardTable(res, numShards);
+    _h3ShardCut(table, histogram, numCells);
+    H3_MEMORY(free)(histogram);
+    return table;
+}
+
+/**
+ * createH3ShardTableFromStarts rebuilds a table from the first hexagon of
+ * each shard, as written by h3ShardTableToArray. The weights of its shards
+ * are not known, and are 0.
+ *
+ * @param starts The first hexagon of each shard, all of one resolution and
+ * in increasing order
+ * @param numShards The number of shards
+ * @return The table, or NULL if there are no shards or the starts are not
+ * in order. It is the responsibility of the caller to call
+ * destroyH3ShardTable on it.
+ */
+H3ShardTable* H3_EXPORT(createH3ShardTableFromStarts)(const H3Index* starts,
+                                                      int numShards) {
+    if (numShards < 1) return NULL;
+    int res = H3_GET_RESOLUTION(starts[0]);
+    for (int s = 0; s < numShards; s++) {
+        if (!H3_EXPORT(h3IsValid)(starts[s]) ||
+            H3_GET_RESOLUTION(starts[s]) != res ||
+            (s > 0 && starts[s] <= starts[s - 1])) {
+            return NULL;
+        }
+    }
+    H3ShardTable* table = _createH3ShardTable(res, numShards);
+    for (int s = 0; s < numShards; s++) {
+        table->starts[s] = starts[s];
+    }
+    return table;
+}
+
+/**
+ * h3ShardTableNumShards returns the number of shards of a table.
+ *
+ * @param table The table
+ * @return The number of shards
+ */
+int H3_EXPORT(h3ShardTableNumShards)(const H3ShardTable* table) {
+    return table->numShards;
+}
+
+/**
+ * h3ShardTableRes returns the resolution of the ranges of a table.
+ *
+ * @param table The table
+ * @return The resolution
+ */
+int H3_EXPORT(h3ShardTableRes)(const H3ShardTable* table) {
+    return table->res;
+}
+
+/**
+ * h3ShardWeight returns the weight of the hexagons of a shard, as the table
+ * was cut with.
+ *
+ * @param table The table
+ * @param shard The shard, from 0 to h3ShardTableNumShards(table) - 1
+ * @return The weight, or 0 if the table was rebuilt from its starts
+ */
+double H3_EXPORT(h3ShardWeight)(const H3ShardTable* table, int shard) {
+    return table->weights[shard];
+}
+
+/**
+ * h3ShardTableToArray writes the first hexagon of each shard, from which
+ * createH3ShardTableFromStarts rebuilds the table.
+ *
+ * @param table The table
+ * @param starts Output array of h3ShardTableNumShards(table) hexagons
+ * @return The number of hexagons written
+ */
+int H3_EXPORT(h3ShardTableToArray)(const H3ShardTable* table,
+                                   H3Index* starts) {
+    for (int s = 0; s < table->numShards; s++) {
+        starts[s] = table->starts[s];
+    }
+    return table->numShards;
+}
+
+/**
+ * h3ToShard finds the shard of a hexagon, by binary search for the last
+ * range starting at or before its ancestor at the table's resolution.
+ *
+ * @param table The table
+ * @param h The hexagon, at the table's resolution or finer
+ * @return The shard, or -1 if h is coarser than the table's resolution, its
+ * descendants possibly spanning several shards
+ */
+int H3_EXPORT(h3ToShard)(const H3ShardTable* table, H3Index h) {
+    if (H3_GET_RESOLUTION(h) < table->res) return -1;
+    H3Index prefix = h3ToParentInline(h, table->res);
+    int lo = 0;
+    int hi = table->numShards - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (table->starts[mid] <= prefix) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * h3ToShardBatch finds the shard of each of n hexagons, as h3ToShard does.
+ *
+ * @param table The table
+ * @param h3 The hexagons
+ * @param n The number of hexagons
+ * @param out Output array of n shards
+ */
+void H3_EXPORT(h3ToShardBatch)(const H3ShardTable* table, const H3Index* h3,
+                               int n, int* out) {
+    for (int i = 0; i < n; i++) {
+        out[i] = H3_EXPORT(h3ToShard)(table, h3[i]);
+    }
+}
+
+/**
+ * destroyH3ShardTable frees a table.
+ *
+ * @param table The table
+ */
+void H3_EXPORT(destroyH3ShardTable)(H3ShardTable* table) {
+    H3_MEMORY(free)(table->starts);
+    H3_MEMORY(free)(table->weights);
+    H3_MEMORY(free)(table);
+}
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3SortedSet.c
+ * @brief   Immutable sets of hexagons sorted for containment queries
+ *
+ * Each hexagon is keyed by its base cell and digits, with the unused digits
+ * left as 7. The keys of the descendants of a hexagon are then exactly the
+ * keys between its key with the unused digits cleared and its key itself, so
+ * a hexagon covers a contiguous range of keys ending at its own key. With
+ * the ranges disjoint and sorted, the only hexagon that may contain a query
+ * is the first one whose key is not less than the key of the query.
+ *
+ * Two ranges are either nested or disjoint, so the union, intersection and
+ * difference of two sets are found by a single merge walk over their keys.
+ */
+
+#include "h3SortedSet.h"
+#include <assert.h>
+#include <string.h>
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3api_inline.h"
+
+/** @brief Keys written in ascending order, merging complete siblings */
+typedef struct {
+    H3Index* keys;  ///< the keys written
+    int numKeys;    ///< the number of keys written
+    int capacity;   ///< the number of keys allocated
+} KeyStack;
+
+/**
+ * The first key in the range of descendants of a key, found by clearing its
+ * trailing unused digits.
+ *
+ * @param key The key of a hexagon
+ * @return The smallest key of any of its descendants
+ */
+H3Index _h3SortedSetRangeStart(H3Index key) {
+    H3Index unused = 0;
+    H3Index digit = H3_DIGIT_MASK;
+    for (int r = MAX_H3_RES; r > 0 && (key & digit) == digit; r--) {
+        unused |= digit;
+        digit <<= H3_PER_DIGIT_OFFSET;
+    }
+    return key & ~unused;
+}
+
+/**
+ * The resolution of a key, found by counting its trailing unused digits.
+ *
+ * @param key The key of a hexagon
+ * @return The resolution of the hexagon
+ */
+int _h3SortedSetKeyRes(H3Index key) {
+    int res = MAX_H3_RES;
+    H3Index digit = H3_DIGIT_MASK;
+    while (res > 0 && (key & digit) == digit) {
+        res--;
+        digit <<= H3_PER_DIGIT_OFFSET;
+    }
+    return res;
+}
+
+/**
+ * Whether the hexagon of a key at a resolution is a pentagon: its base cell
+ * is a pentagon and all of its used digits are centers.
+ */
+int _h3SortedSetKeyIsPentagon(H3Index key, int res) {
+    return h3BaseCellIsPentagonInline((int)(key >> H3_BC_OFFSET)) &&
+           (key & H3_INLINE_DIGIT_BITS & ~h3DigitsBelowInline(res)) == 0;
+}
+
+/**
+ * Appends a key after every key already written, which it must follow. If
+ * it completes the children of its parent, they are replaced by the parent,
+ * which may in turn complete its own siblings, so the keys written are
+ * always compacted.
+ *
+ * @param stack The keys written
+ * @param key The key to append
+ */
+static void _keyStackPush(KeyStack* stack, H3Index key) {
+    int res = _h3SortedSetKeyRes(key);
+    // The last sibling in key order always has digit 6
+    while (res > 0 && H3_GET_INDEX_DIGIT(key, res) == IJ_AXES_DIGIT) {
+        H3Index parent =
+            key | (H3_DIGIT_MASK << ((MAX_H3_RES - res) * H3_PER_DIGIT_OFFSET));
+        // Pentagons have no child in the deleted direction
+        int numSiblings = _h3SortedSetKeyIsPentagon(parent, res - 1) ? 5 : 6;
+        if (stack->numKeys < numSiblings) break;
+        int complete = 1;
+        for (int i = stack->numKeys - numSiblings; i < stack->numKeys; i++) {
+            H3Index sibling = stack->keys[i];
+            if (_h3SortedSetKeyRes(sibling) != res ||
+                (sibling | (H3_DIGIT_MASK << ((MAX_H3_RES - res) *
+                                              H3_PER_DIGIT_OFFSET))) !=
+                    parent) {
+                complete = 0;
+                break;
+            }
+        }
+        if (!complete) break;
+        stack->numKeys -= numSiblings;
+        key = parent;
+        res--;
+    }
+
+    if (stack->numKeys == stack->capacity) {
+        stack->capacity = stack->capacity ? 2 * stack->capacity : 64;
+        stack->keys = H3_MEMORY(realloc)(stack->keys,
+                                         stack->capacity * sizeof(H3Index));
+        assert(stack->keys != NULL);
+    }
+    stack->keys[stack->numKeys++] = key;
+}
+
+/**
+ * Creates a set holding the keys written, taking their memory.
+ */
+static H3SortedSet* _keyStackToSet(KeyStack* stack) {
+    H3SortedSet* set = H3_MEMORY(malloc)(sizeof(H3SortedSet));
+    assert(set != NULL);
+    set->numKeys = stack->numKeys;
+    set->keys = NULL;
+    if (stack->numKeys > 0) {
+        set->keys = H3_MEMORY(realloc)(stack->keys,
+                                       stack->numKeys * sizeof(H3Index));
+        assert(set->keys != NULL);
+    } else {
+        H3_MEMORY(free)(stack->keys);
+    }
+    return set;
+}
+
+/**
+ * createH3SortedSet builds an immutable set from hexagons of any
+ * resolutions, such as the output of compact. Empty entries are skipped, and
+ * hexagons that are duplicated or contained in another hexagon of the set
+ * are dropped.
+ *
+ * @param h3Set The hexagons
+ * @param numHexes The number of entries in h3Set
+ * @return The set, which the caller must free with destroyH3SortedSet
+ */
+H3SortedSet* H3_EXPORT(createH3SortedSet)(const H3Index* h3Set,
+                                          const int numHexes) {
+    H3SortedSet* set = H3_MEMORY(malloc)(sizeof(H3SortedSet));
+    assert(set != NULL);
+    set->numKeys = 0;
+    set->keys = NULL;
+    if (numHexes <= 0) {
+        return set;
+    }
+
+    H3Index* buffer = H3_MEMORY(malloc)(2 * numHexes * sizeof(H3Index));
+    assert(buffer != NULL);
+    int numKeys = 0;
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] != 0) {
+            buffer[numKeys++] = h3Set[i] & H3_SORTED_SET_KEY_MASK;
+        }
+    }
+    if (numKeys == 0) {
+        H3_MEMORY(free)(buffer);
+        return set;
+    }
+    H3Index* keys = _radixSortH3Indexes(buffer, buffer + numKeys, numKeys);
+
+    // Descendants sort before their ancestors, so walk backwards keeping
+    // each key that lies before the range of the last key kept.
+    int kept = numKeys - 1;
+    H3Index rangeStart = _h3SortedSetRangeStart(keys[kept]);
+    for (int i = numKeys - 2; i >= 0; i--) {
+        if (keys[i] < rangeStart) {
+            kept--;
+            keys[kept] = keys[i];
+            rangeStart = _h3SortedSetRangeStart(keys[kept]);
+        }
+    }
+
+    set->numKeys = numKeys - kept;
+    set->keys = H3_MEMORY(malloc)(set->numKeys * sizeof(H3Index));
+    assert(set->keys != NULL);
+    memcpy(set->keys, keys + kept, set->numKeys * sizeof(H3Index));
+    H3_MEMORY(free)(buffer);
+    return set;
+}
+
+/**
+ * h3SortedSetContains determines whether a hexagon or one of its ancestors
+ * is in the set, by a binary search over the sorted keys.
+ *
+ * @param set The set
+ * @param h The hexagon
+ * @return 1 if the hexagon is contained in the set, 0 otherwise
+ */
+int H3_EXPORT(h3SortedSetContains)(const H3SortedSet* set, H3Index h) {
+    H3Index key = h & H3_SORTED_SET_KEY_MASK;
+    int low = 0;
+    int high = set->numKeys;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (set->keys[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low < set->numKeys &&
+           _h3SortedSetRangeStart(set->keys[low]) <= key;
+}
+
+/**
+ * h3SortedSetSize returns the number of hexagons held by the set, after
+ * dropping duplicated and contained hexagons.
+ *
+ * @param set The set
+ * @return The number of hexagons
+ */
+int H3_EXPORT(h3SortedSetSize)(const H3SortedSet* set) {
+    return set->numKeys;
+}
+
+/**
+ * h3SortedSetToArray writes the hexagons held by the set in ascending key
+ * order, which orders the descendants of every hexagon before it.
+ *
+ * @param set The set
+ * @param out Output array of h3SortedSetSize(set) hexagons
+ */
+void H3_EXPORT(h3SortedSetToArray)(const H3SortedSet* set, H3Index* out) {
+    for (int i = 0; i < set->numKeys; i++) {
+        H3Index h = set->keys[i];
+        H3_SET_MODE(h, H3_HEXAGON_MODE);
+        H3_SET_RESOLUTION(h, _h3SortedSetKeyRes(set->keys[i]));
+        out[i] = h;
+    }
+}
+
+/**
+ * h3SortedSetUnion creates the set of the hexagons contained in either of
+ * two sets. A hexagon of one set contained in a hexagon of the other is
+ * dropped, and complete children are merged into their parent, so the
+ * result is compacted.
+ *
+ * @param a The first set
+ * @param b The second set
+ * @return The union, which the caller must free with destroyH3SortedSet
+ */
+H3SortedSet* H3_EXPORT(h3SortedSetUnion)(const H3SortedSet* a,
+                                         const H3SortedSet* b) {
+    KeyStack out = {0};
+    int i = 0;
+    int j = 0;
+    while (i < a->numKeys && j < b->numKeys) {
+        H3Index keyA = a->keys[i];
+        H3Index keyB = b->keys[j];
+        if (keyA < _h3SortedSetRangeStart(keyB)) {
+            _keyStackPush(&out, keyA);
+            i++;
+        } else if (keyB < _h3SortedSetRangeStart(keyA)) {
+            _keyStackPush(&out, keyB);
+            j++;
+        } else if (keyB <= keyA) {
+            // b is nested in a, which may contain more of b
+            j++;
+        } else {
+            i++;
+        }
+    }
+    for (; i < a->numKeys; i++) _keyStackPush(&out, a->keys[i]);
+    for (; j < b->numKeys; j++) _keyStackPush(&out, b->keys[j]);
+    return _keyStackToSet(&out);
+}
+
+/**
+ * h3SortedSetIntersection creates the set of the areas contained in both of
+ * two sets. Where a hexagon of one set is contained in a hexagon of the
+ * other, the smaller is kept.
+ *
+ * @param a The first set
+ * @param b The second set
+ * @return The intersection, which the caller must free with
+ * destroyH3SortedSet
+ */
+H3SortedSet* H3_EXPORT(h3SortedSetIntersection)(const H3SortedSet* a,
+                                                const H3SortedSet* b) {
+    KeyStack out = {0};
+    int i = 0;
+    int j = 0;
+    while (i < a->numKeys && j < b->numKeys) {
+        H3Index keyA = a->keys[i];
+        H3Index keyB = b->keys[j];
+        if (keyA < _h3SortedSetRangeStart(keyB)) {
+            i++;
+        } else if (keyB < _h3SortedSetRangeStart(keyA)) {
+            j++;
+        } else if (keyB <= keyA) {
+            _keyStackPush(&out, keyB);
+            j++;
+        } else {
+            _keyStackPush(&out, keyA);
+            i++;
+        }
+    }
+    return _keyStackToSet(&out);
+}
+
+/**
+ * Writes the part of a hexagon outside of the sorted, disjoint holes nested
+ * in it, as the largest hexagons covering it. The hexagon is split into its
+ * children, and each child is written whole unless it contains a hole, in
+ * which case it is split again.
+ *
+ * @param out The keys written
+ * @param key The key of the hexagon
+ * @param res The resolution of the hexagon
+ * @param holes The keys of the holes, all nested in the hexagon
+ * @param numHoles The number of holes
+ */
+static void _pushDifference(KeyStack* out, H3Index key, int res,
+                            const H3Index* holes, int numHoles) {
+    if (numHoles == 0) {
+        _keyStackPush(out, key);
+        return;
+    }
+    if (holes[0] == key) {
+        return;
+    }
+    int childRes = res + 1;
+    int shift = (MAX_H3_RES - childRes) * H3_PER_DIGIT_OFFSET;
+    int isPentagon = _h3SortedSetKeyIsPentagon(key, res);
+    int first = 0;
+    for (H3Index digit = CENTER_DIGIT; digit < 7; digit++) {
+        if (isPentagon && digit == K_AXES_DIGIT) continue;
+        H3Index child = (key & ~(H3_DIGIT_MASK << shift)) | (digit << shift);
+        int end = first;
+        while (end < numHoles && holes[end] <= child) end++;
+        _pushDifference(out, child, childRes, holes + first, end - first);
+        first = end;
+    }
+}
+
+/**
+ * h3SortedSetDifference creates the set of the areas contained in one set
+ * but not in another. A hexagon of the first set partly covered by the
+ * second is replaced by the largest hexagons covering the rest of it.
+ *
+ * @param a The set to subtract from
+ * @param b The set to subtract
+ * @return The difference, which the caller must free with destroyH3SortedSet
+ */
+H3SortedSet* H3_EXPORT(h3SortedSetDifference)(const H3SortedSet* a,
+                                              const H3SortedSet* b) {
+    KeyStack out = {0};
+    int j = 0;
+    for (int i = 0; i < a->numKeys; i++) {
+        H3Index keyA = a->keys[i];
+        H3Index startA = _h3SortedSetRangeStart(keyA);
+        while (j < b->numKeys && b->keys[j] < startA) j++;
+        if (j < b->numKeys && keyA <= b->keys[j] &&
+            _h3SortedSetRangeStart(b->keys[j]) <= startA) {
+            // a is nested in b, which may contain more of a
+            continue;
+        }
+        int end = j;
+        while (end < b->numKeys && b->keys[end] <= keyA) end++;
+        _pushDifference(&out, keyA, _h3SortedSetKeyRes(keyA), b->keys + j,
+                        end - j);
+        j = end;
+    }
+    return _keyStackToSet(&out);
+}
+
+/**
+ * destroyH3SortedSet frees all memory held by a set.
+ *
+ * @param set The set
+ */
+void H3_EXPORT(destroyH3SortedSet)(H3SortedSet* set) {
+    H3_MEMORY(free)(set->keys);
+    H3_MEMORY(free)(set);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3Stats.c
+ * @brief   Hot path counters and the allocation functions that count
+ *
+ * The counting allocation functions put a header holding the size before
+ * each allocation, so that frees can lower the live byte count. Memory
+ * allocated on one thread and freed on another lowers the count of the
+ * thread freeing it, whose liveBytes may then be negative.
+ */
+
+#include "h3Stats.h"
+#include <string.h>
+#include "h3Alloc.h"
+
+#ifdef H3_ENABLE_STATS
+H3_THREAD_LOCAL H3Stats _h3Stats;
+
+/**
+ * Precedes each counted allocation, recording its size for the free, and
+ * aligned as strictly as any type malloc returns memory for.
+ */
+typedef union {
+    size_t size;
+    long double alignLongDouble;
+    long long alignLongLong;
+    void* alignPointer;
+} AllocationHeader;
+
+/**
+ * The number of bytes to allocate for size bytes and their header, or the
+ * largest size_t, which cannot be allocated, if that overflows.
+ *
+ * @param size The number of bytes requested
+ */
+static size_t _withHeader(size_t size) {
+    if (size > (size_t)-1 - sizeof(AllocationHeader)) return (size_t)-1;
+    return sizeof(AllocationHeader) + size;
+}
+
+/**
+ * Counts an allocation of the given size, returning the memory following
+ * its header.
+ *
+ * @param header The header of the allocation, or NULL if it failed
+ * @param size The number of bytes requested
+ * @return The memory following the header, or NULL
+ */
+static void* _countAllocation(AllocationHeader* header, size_t size) {
+    H3_STAT_ADD(allocations, 1);
+    H3_STAT_ADD(allocatedBytes, size);
+    if (header == NULL) return NULL;
+    header->size = size;
+    _h3Stats.liveBytes += (int64_t)size;
+    if (_h3Stats.liveBytes > _h3Stats.peakBytes) {
+        _h3Stats.peakBytes = _h3Stats.liveBytes;
+    }
+    return header + 1;
+}
+
+void* _h3Stats_malloc(size_t size) {
+    return _countAllocation(H3_ALLOC_FUNC(malloc)(_withHeader(size)), size);
+}
+
+void* _h3Stats_calloc(size_t num, size_t size) {
+    if (size != 0 && num > (size_t)-1 / size) {
+        return _countAllocation(NULL, 0);
+    }
+    return _countAllocation(
+        H3_ALLOC_FUNC(calloc)(1, _withHeader(num * size)), num * size);
+}
+
+void* _h3Stats_realloc(void* ptr, size_t size) {
+    if (ptr == NULL) return _h3Stats_malloc(size);
+    AllocationHeader* header = (AllocationHeader*)ptr - 1;
+    size_t oldSize = header->size;
+    header = H3_ALLOC_FUNC(realloc)(header, _withHeader(size));
+    if (header != NULL) {
+        _h3Stats.liveBytes -= (int64_t)oldSize;
+    }
+    return _countAllocation(header, size);
+}
+
+void _h3Stats_free(void* ptr) {
+    if (ptr == NULL) return;
+    AllocationHeader* header = (AllocationHeader*)ptr - 1;
+    H3_STAT_ADD(frees, 1);
+    _h3Stats.liveBytes -= (int64_t)header->size;
+    H3_ALLOC_FUNC(free)(header);
+}
+#endif
+
+/**
+ * Copies the counters collected on the calling thread since the last
+ * h3ResetStats, or since the thread started.
+ *
+ * @param stats Output counters, zeroed if the library does not collect them
+ * @return 0 if the library was built with H3_ENABLE_STATS, 1 otherwise
+ */
+int H3_EXPORT(h3GetStats)(H3Stats* stats) {
+#ifdef H3_ENABLE_STATS
+    *stats = _h3Stats;
+    return 0;
+#else
+    memset(stats, 0, sizeof(*stats));
+    return 1;
+#endif
+}
+
+/**
+ * Zeroes the counters of the calling thread.
+ */
+void H3_EXPORT(h3ResetStats)(void) {
+#ifdef H3_ENABLE_STATS
+    memset(&_h3Stats, 0, sizeof(_h3Stats));
+#endif
+}
@@ -19,18 +19,70 @@
 
 #include <inttypes.h>
 #include "algos.h"
+#include "baseCells.h"
 #include "constants.h"
 #include "coordijk.h"
+#include "faceijk.h"
 #include "geoCoord.h"
 #include "h3Index.h"
+#include "h3api_inline.h"
+#include "vec3d.h"
 
 /**
- * Returns whether or not the provided H3Indexes are neighbors.
+ * The most vertices of an edge boundary: its two ends and a vertex where it
+ * crosses an icosahedron edge.
+ */
+#define MAX_EDGE_BNDRY_VERTS 3
+
+/**
+ * First vertex of the edge of a hexagon towards each direction, for a
+ * hexagon whose vertices are not rotated from those of its directions. The
+ * edge runs to the next vertex.
+ */
+static const int DIRECTION_TO_VERTEX_HEX[7] = {-1, 3, 1, 2, 5, 4, 0};
+
+/**
+ * First vertex of the edge of a pentagon towards each direction, as for
+ * hexagons. The K direction is deleted.
+ */
+static const int DIRECTION_TO_VERTEX_PENT[7] = {-1, -1, 1, 2, 4, 3, 0};
+
+/**
+ * Direction from an origin to a destination digit for aperture 7 moves at
+ * Class III resolutions, the inverse of the digit adjustment made by
+ * h3NeighborRotations.
+ */
+static const int DIGIT_DIRECTION_CLASS_III[7][7] = {
+    {0, 1, 2, 3, 4, 5, 6}, {6, 0, 5, 2, 1, 4, 3}, {5, 2, 0, 1, 3, 6, 4},
+    {4, 5, 6, 0, 2, 3, 1}, {3, 6, 4, 5, 0, 1, 2}, {2, 3, 1, 4, 6, 0, 5},
+    {1, 4, 3, 6, 5, 2, 0}};
+
+/**
+ * Direction from an origin to a destination digit for aperture 7 moves at
+ * Class II resolutions, the inverse of the digit adjustment made by
+ * h3NeighborRotations.
+ */
+static const int DIGIT_DIRECTION_CLASS_II[7][7] = {
+    {0, 1, 2, 3, 4, 5, 6}, {6, 0, 1, 2, 3, 4, 5}, {5, 6, 0, 1, 2, 3, 4},
+    {4, 5, 6, 0, 1, 2, 3}, {3, 4, 5, 6, 0, 1, 2}, {2, 3, 4, 5, 6, 0, 1},
+    {1, 2, 3, 4, 5, 6, 0}};
+
+/**
+ * Resolves the direction from an origin hexagon to a neighboring destination
+ * hexagon.
+ *
+ * A move in any direction changes the finest digit of the origin, and for
+ * each origin digit every direction leads to a different destination digit.
+ * The finest digits therefore give the direction, unless the move crosses
+ * into a base cell with a different orientation or a pentagon rotates the
+ * result. Only then are the remaining directions tried.
+ *
  * @param origin The origin H3 index.
  * @param destination The destination H3 index.
- * @return 1 if the indexes are neighbors, 0 otherwise;
+ * @return The direction from origin to destination (1-6), or 0 if they are
+ * not neighbors.
  */
-int H3_EXPORT(h3IndexesAreNeighbors)(H3Index origin, H3Index destination) {
+static int _h3NeighborDirection(H3Index origin, H3Index destination) {
     // Make sure they're hexagon indexes
     if (H3_GET_MODE(origin) != H3_HEXAGON_MODE ||
         H3_GET_MODE(destination) != H3_HEXAGON_MODE) {
@@ -43,41 +95,42 @@ int H3_EXPORT(h3IndexesAreNeighbors)(H3Index origin, H3Index destination) {
     }
 
     // Only hexagons in the same resolution can be neighbors
-    if (H3_GET_RESOLUTION(origin) != H3_GET_RESOLUTION(destination)) {
+    int res = H3_GET_RESOLUTION(origin);
+    if (res != H3_GET_RESOLUTION(destination)) {
         return 0;
     }
 
-    // H3 Indexes that share the same parent are very likely to be neighbors
-    // Child 0 is neighbor with all of its parent's 'offspring', the other
-    // children are neighbors with 3 of the 7 children. So a simple comparison
-    // of origin and destination parents and then a lookup table of the children
-    // is a super-cheap way to possibly determine they are neighbors.
-    int parentRes = H3_GET_RESOLUTION(origin) - 1;
-    if (parentRes > 0 && (H3_EXPORT(h3ToParent)(origin, parentRes) ==
-                          H3_EXPORT(h3ToParent)(destination, parentRes))) {
-        int originResDigit = H3_GET_INDEX_DIGIT(origin, parentRes + 1);
-        int destinationResDigit =
-            H3_GET_INDEX_DIGIT(destination, parentRes + 1);
-        if (originResDigit == 0 || destinationResDigit == 0) {
-            return 1;
+    int candidate = 0;
+    if (res > 0) {
+        int originDigit = H3_GET_INDEX_DIGIT(origin, res);
+        int destinationDigit = H3_GET_INDEX_DIGIT(destination, res);
+        candidate =
+            isResClassIII(res)
+                ? DIGIT_DIRECTION_CLASS_III[originDigit][destinationDigit]
+                : DIGIT_DIRECTION_CLASS_II[originDigit][destinationDigit];
+        if (candidate != 0) {
+            int rotations = 0;
+            if (h3NeighborRotations(origin, candidate, &rotations) ==
+                destination) {
+                return candidate;
+            }
         }
-        // These sets are the relevant neighbors in the clockwise
-        // and counter-clockwise
-        const int neighborSetClockwise[] = {0, 3, 6, 2, 5, 1, 4};
-        const int neighborSetCounterclockwise[] = {0, 5, 3, 1, 6, 4, 2};
-        if (neighborSetClockwise[originResDigit] == destinationResDigit ||
-            neighborSetCounterclockwise[originResDigit] ==
-                destinationResDigit) {
-            return 1;
+
+        // Within a hexagon base cell no move rotates the digits, so the
+        // candidate was the only possible direction.
+        int baseCell = H3_GET_BASE_CELL(origin);
+        if (baseCell == H3_GET_BASE_CELL(destination) &&
+            !_isBaseCellPentagon(baseCell)) {
+            return 0;
         }
     }
 
-    // Otherwise, we have to determine the neighbor relationship the "hard" way.
-    H3Index neighborRing[7] = {0};
-    H3_EXPORT(kRing)(origin, 1, neighborRing);
-    for (int i = 0; i < 7; i++) {
-        if (neighborRing[i] == destination) {
-            return 1;
+    for (int direction = 1; direction < 7; direction++) {
+        if (direction == candidate) continue;
+        int rotations = 0;
+        if (h3NeighborRotations(origin, direction, &rotations) ==
+            destination) {
+            return direction;
         }
     }
 
@@ -85,6 +138,16 @@ int H3_EXPORT(h3IndexesAreNeighbors)(H3Index origin, H3Index destination) {
     return 0;
 }
 
+/**
+ * Returns whether or not the provided H3Indexes are neighbors.
+ * @param origin The origin H3 index.
+ * @param destination The destination H3 index.
+ * @return 1 if the indexes are neighbors, 0 otherwise;
+ */
+int H3_EXPORT(h3IndexesAreNeighbors)(H3Index origin, H3Index destination) {
+    return _h3NeighborDirection(origin, destination) != 0;
+}
+
 /**
  * Returns a unidirectional edge H3 index based on the provided origin and
  * destination
@@ -94,29 +157,16 @@ int H3_EXPORT(h3IndexesAreNeighbors)(H3Index origin, H3Index destination) {
  */
 H3Index H3_EXPORT(getH3UnidirectionalEdge)(H3Index origin,
                                            H3Index destination) {
+    int direction = _h3NeighborDirection(origin, destination);
     // Short-circuit and return an invalid index value if they are not neighbors
-    if (H3_EXPORT(h3IndexesAreNeighbors)(origin, destination) == 0) {
+    if (direction == 0) {
         return H3_INVALID_INDEX;
     }
 
-    // Otherwise, determine the IJK direction from the origin to the destination
     H3Index output = origin;
     H3_SET_MODE(output, H3_UNIEDGE_MODE);
-
-    // Checks each neighbor, in order, to determine which direction the
-    // destination neighbor is located.
-    H3Index neighbor;
-    for (int direction = 1; direction < 7; direction++) {
-        int rotations = 0;
-        neighbor = h3NeighborRotations(origin, direction, &rotations);
-        if (neighbor == destination) {
-            H3_SET_RESERVED_BITS(output, direction);
-            return output;
-        }
-    }
-
-    // This should be impossible, return an invalid H3Index in this case;
-    return H3_INVALID_INDEX;  // LCOV_EXCL_LINE
+    H3_SET_RESERVED_BITS(output, direction);
+    return output;
 }
 
 /**
@@ -125,10 +175,7 @@ H3Index H3_EXPORT(getH3UnidirectionalEdge)(H3Index origin,
  * @return The origin H3 hexagon index
  */
 H3Index H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(H3Index edge) {
-    H3Index origin = edge;
-    H3_SET_MODE(origin, H3_HEXAGON_MODE);
-    H3_SET_RESERVED_BITS(origin, 0);
-    return origin;
+    return getOriginH3IndexFromUnidirectionalEdgeInline(edge);
 }
 
 /**
@@ -151,21 +198,7 @@ H3Index H3_EXPORT(getDestinationH3IndexFromUnidirectionalEdge)(H3Index edge) {
  * @return 1 if it is a unidirectional edge H3Index, otherwise 0.
  */
 int H3_EXPORT(h3UnidirectionalEdgeIsValid)(H3Index edge) {
-    if (H3_GET_MODE(edge) != H3_UNIEDGE_MODE) {
-        return 0;
-    }
-
-    int neighborDirection = H3_GET_RESERVED_BITS(edge);
-    if (neighborDirection < 1 || neighborDirection > 6) {
-        return 0;
-    }
-
-    H3Index origin = H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(edge);
-    if (H3_EXPORT(h3IsPentagon)(origin) && neighborDirection == 1) {
-        return 0;
-    }
-
-    return H3_EXPORT(h3IsValid)(origin);
+    return h3UnidirectionalEdgeIsValidInline(edge);
 }
 
 /**
@@ -207,30 +240,165 @@ void H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(H3Index origin,
 }
 
 /**
- * Provides the coordinates defining the unidirectional edge.
+ * The boundary of a cell, with the first vertex of the edge towards each
+ * direction, so that the boundary of every edge of the cell can be sliced
+ * out of it.
+ */
+typedef struct {
+    GeoBoundary gb;      ///< the boundary of the cell
+    int numCellVerts;    ///< 6, or 5 for pentagons
+    int offsets[6];      ///< position in gb of each vertex of the cell
+    int rotations;       ///< ccw rotations of the vertices from directions
+    int isPentagon;      ///< whether the cell is a pentagon
+} CellEdgeBoundaries;
+
+/**
+ * Decodes the boundary of a cell once for the boundaries of all its edges.
+ *
+ * The vertices of a cell are in a fixed order relative to its directions,
+ * up to a rotation which depends on the face and base cell of the cell. The
+ * rotation is found from the neighbor in the J direction, which every cell
+ * has: its center faces the midpoint of exactly one edge.
+ *
+ * @param origin The cell
+ * @param ceb Output boundary of the cell
+ */
+static void _cellEdgeBoundariesInit(H3Index origin, CellEdgeBoundaries* ceb) {
+    int res = H3_GET_RESOLUTION(origin);
+    ceb->isPentagon = h3IsPentagonInline(origin);
+    ceb->numCellVerts = ceb->isPentagon ? NUM_PENT_VERTS : NUM_HEX_VERTS;
+    FaceIJK fijk;
+    _h3ToFaceIjk(origin, &fijk);
+    _faceIjkToGeoBoundary(&fijk, res, ceb->isPentagon, &ceb->gb,
+                          ceb->offsets);
+
+    int rotations = 0;
+    H3Index neighbor = h3NeighborRotations(origin, J_AXES_DIGIT, &rotations);
+    GeoCoord center;
+    Vec3d centerPoint;
+    _h3ToFaceIjk(neighbor, &fijk);
+    _faceIjkToGeo(&fijk, res, &center);
+    _geoToVec3d(&center, &centerPoint);
+
+    int facing = 0;
+    double maxDot = -4;
+    for (int v = 0; v < ceb->numCellVerts; v++) {
+        Vec3d a;
+        Vec3d b;
+        _geoToVec3d(&ceb->gb.verts[ceb->offsets[v]], &a);
+        _geoToVec3d(&ceb->gb.verts[ceb->offsets[(v + 1) % ceb->numCellVerts]],
+                    &b);
+        double dot = (a.x + b.x) * centerPoint.x + (a.y + b.y) * centerPoint.y +
+                     (a.z + b.z) * centerPoint.z;
+        if (dot > maxDot) {
+            maxDot = dot;
+            facing = v;
+        }
+    }
+    const int* toVertex =
+        ceb->isPentagon ? DIRECTION_TO_VERTEX_PENT : DIRECTION_TO_VERTEX_HEX;
+    ceb->rotations = (toVertex[J_AXES_DIGIT] - facing + ceb->numCellVerts) %
+                     ceb->numCellVerts;
+}
+
+/**
+ * Slices the boundary of the edge towards a direction out of the boundary of
+ * its origin, in the order of the origin boundary.
+ *
+ * @param ceb The boundary of the origin
+ * @param direction The direction of the edge, 1-6
+ * @param verts Output vertices, at most MAX_EDGE_BNDRY_VERTS
+ * @return The number of vertices written, 0 for the deleted direction of a
+ * pentagon
+ */
+static int _cellEdgeBoundary(const CellEdgeBoundaries* ceb, int direction,
+                             GeoCoord* verts) {
+    const int* toVertex =
+        ceb->isPentagon ? DIRECTION_TO_VERTEX_PENT : DIRECTION_TO_VERTEX_HEX;
+    if (direction < 1 || direction > 6 || toVertex[direction] < 0) {
+        return 0;
+    }
+    int start = (toVertex[direction] - ceb->rotations + ceb->numCellVerts) %
+                ceb->numCellVerts;
+    int end = ceb->offsets[(start + 1) % ceb->numCellVerts];
+    int numVerts = 0;
+    for (int i = ceb->offsets[start]; numVerts < MAX_EDGE_BNDRY_VERTS;
+         i = (i + 1) % ceb->gb.numVerts) {
+        verts[numVerts++] = ceb->gb.verts[i];
+        if (i == end) break;
+    }
+    return numVerts;
+}
+
+/**
+ * Provides the coordinates defining the unidirectional edge, in the order
+ * of the boundary of its origin.
  * @param edge The unidirectional edge H3Index
  * @param gb The geoboundary object to store the edge coordinates.
  */
 void H3_EXPORT(getH3UnidirectionalEdgeBoundary)(H3Index edge, GeoBoundary* gb) {
-    // TODO: More efficient solution :)
-    GeoBoundary origin = {0};
-    GeoBoundary destination = {0};
-    H3_EXPORT(h3ToGeoBoundary)
-    (H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(edge), &origin);
-    H3_EXPORT(h3ToGeoBoundary)
-    (H3_EXPORT(getDestinationH3IndexFromUnidirectionalEdge)(edge),
-     &destination);
-
-    int k = 0;
-    for (int i = 0; i < origin.numVerts; i++) {
-        for (int j = 0; j < destination.numVerts; j++) {
-            if (geoAlmostEqualThreshold(&origin.verts[i], &destination.verts[j],
-                                        0.000001)) {
-                gb->verts[k].lat = origin.verts[i].lat;
-                gb->verts[k].lon = origin.verts[i].lon;
-                k++;
+    CellEdgeBoundaries ceb;
+    _cellEdgeBoundariesInit(
+        H3_EXPORT(getOriginH3IndexFromUnidirectionalEdge)(edge), &ceb);
+    gb->numVerts =
+        _cellEdgeBoundary(&ceb, (int)H3_GET_RESERVED_BITS(edge), gb->verts);
+}
+
+/**
+ * Provides all of the unidirectional edges of an array of hexagons, six per
+ * hexagon as getH3UnidirectionalEdgesFromHexagon gives them.
+ * @param origins The origin hexagons.
+ * @param n The number of origins.
+ * @param edges Output array of 6 * n edges, with 0 for the deleted direction
+ * of pentagons.
+ */
+void H3_EXPORT(getH3UnidirectionalEdgesFromHexagonBatch)(const H3Index* origins,
+                                                         int n,
+                                                         H3Index* edges) {
+    for (int i = 0; i < n; i++) {
+        H3Index edge = origins[i];
+        H3_SET_MODE(edge, H3_UNIEDGE_MODE);
+        int isPentagon = h3IsPentagonInline(origins[i]);
+        for (int d = 0; d < 6; d++) {
+            H3_SET_RESERVED_BITS(edge, d + 1);
+            edges[6 * i + d] = (isPentagon && d == 0) ? 0 : edge;
+        }
+    }
+}
+
+/**
+ * Provides the coordinates of every unidirectional edge of an array of
+ * hexagons, in the order of getH3UnidirectionalEdgesFromHexagonBatch, written
+ * densely into a flat buffer. The boundary of each hexagon is decoded once,
+ * and the boundary of each of its edges sliced out of it.
+ *
+ * The vertices of all edges are written one after another as lat/lon pairs
+ * in radians, so edge j starts after the sum of numVerts[0..j-1] vertices.
+ *
+ * @param origins The origin hexagons.
+ * @param n The number of origins.
+ * @param verts Output buffer of lat/lon pairs. Must hold at least 36 * n
+ *              doubles in the worst case, three vertices per edge.
+ * @param numVerts Output array of 6 * n vertex counts, 0 for the deleted
+ *                 direction of pentagons.
+ * @return The total number of vertices written.
+ */
+int H3_EXPORT(getH3UnidirectionalEdgeBoundariesFromHexagonBatch)(
+    const H3Index* origins, int n, double* verts, int* numVerts) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        CellEdgeBoundaries ceb;
+        _cellEdgeBoundariesInit(origins[i], &ceb);
+        for (int d = 0; d < 6; d++) {
+            GeoCoord edgeVerts[MAX_EDGE_BNDRY_VERTS];
+            int count = _cellEdgeBoundary(&ceb, d + 1, edgeVerts);
+            numVerts[6 * i + d] = count;
+            for (int v = 0; v < count; v++) {
+                verts[2 * total] = edgeVerts[v].lat;
+                verts[2 * total + 1] = edgeVerts[v].lon;
+                total++;
             }
         }
     }
-    gb->numVerts = k;
+    return total;
 }
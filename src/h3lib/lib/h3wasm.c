@@ -0,0 +1,38 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file h3wasm.c
+ * @brief   The WebAssembly module of the batch functions
+ *
+ * The module is the library itself, compiled with WebAssembly SIMD, and
+ * linked with the batch functions exported. The library has no SIMD128
+ * paths of its own; it is vectorized where the compiler can.
+ */
+
+#include "h3wasm.h"
+
+/**
+ * h3WasmHasSimd128 tells JavaScript whether the module it loaded was built
+ * with WebAssembly SIMD, which every browser it runs in then supports.
+ *
+ * @return 1 if the module was built with WebAssembly SIMD, 0 otherwise
+ */
+int H3_EXPORT(h3WasmHasSimd128)(void) {
+#ifdef __wasm_simd128__
+    return 1;
+#else
+    return 0;
+#endif
+}
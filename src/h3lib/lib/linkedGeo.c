@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "geoCoord.h"
+#include "h3Alloc.h"
 #include "h3api.h"
 
 /**
@@ -50,7 +51,7 @@ void initLinkedLoop(LinkedGeoLoop* loop) {
  */
 LinkedGeoPolygon* addLinkedPolygon(LinkedGeoPolygon* polygon) {
     assert(polygon->next == NULL);
-    LinkedGeoPolygon* next = calloc(1, sizeof(*next));
+    LinkedGeoPolygon* next = H3_MEMORY(calloc)(1, sizeof(*next));
     assert(next != NULL);
     polygon->next = next;
     return next;
@@ -62,7 +63,7 @@ LinkedGeoPolygon* addLinkedPolygon(LinkedGeoPolygon* polygon) {
  * @return         Pointer to loop
  */
 LinkedGeoLoop* addLinkedLoop(LinkedGeoPolygon* polygon) {
-    LinkedGeoLoop* loop = calloc(1, sizeof(*loop));
+    LinkedGeoLoop* loop = H3_MEMORY(calloc)(1, sizeof(*loop));
     assert(loop != NULL);
     initLinkedLoop(loop);
     LinkedGeoLoop* last = polygon->last;
@@ -84,7 +85,7 @@ LinkedGeoLoop* addLinkedLoop(LinkedGeoPolygon* polygon) {
  * @return        Pointer to the coordinate
  */
 LinkedGeoCoord* addLinkedCoord(LinkedGeoLoop* loop, const GeoCoord* vertex) {
-    LinkedGeoCoord* coord = calloc(1, sizeof(*coord));
+    LinkedGeoCoord* coord = H3_MEMORY(calloc)(1, sizeof(*coord));
     assert(coord != NULL);
     coord->vertex = *vertex;
     coord->next = NULL;
@@ -115,17 +116,17 @@ void H3_EXPORT(destroyLinkedPolygon)(LinkedGeoPolygon* polygon) {
             for (LinkedGeoCoord *currentCoord = currentLoop->first, *nextCoord;
                  currentCoord != NULL; currentCoord = nextCoord) {
                 nextCoord = currentCoord->next;
-                free(currentCoord);
+                H3_MEMORY(free)(currentCoord);
             }
             nextLoop = currentLoop->next;
-            free(currentLoop);
+            H3_MEMORY(free)(currentLoop);
         }
         nextPolygon = currentPolygon->next;
         if (skip) {
             // do not free the input polygon
             skip = false;
         } else {
-            free(currentPolygon);
+            H3_MEMORY(free)(currentPolygon);
         }
     }
 }
@@ -0,0 +1,727 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file outline.c
+ * @brief   Outlines of sets of hexagons traced along their boundary edges
+ *
+ * An edge of a hexagon in the set is on the outline exactly when the
+ * neighbor across it is not in the set, which is decided with integer
+ * neighbor traversal and a hash set lookup. The boundary edges are then
+ * chained by walking around the shared vertices, so only cells on the
+ * outline are ever converted to lat/lon.
+ *
+ * Sets of mixed resolution, such as the output of compact, are traced at
+ * their finest resolution. Coarse hexagons are refined with h3ToChildren
+ * only where they touch the outside of the set, so the work done scales
+ * with the perimeter of the set rather than its area.
+ *
+ * Each outer loop becomes its own polygon, and each hole is attached to the
+ * innermost outer loop containing it.
+ */
+
+#include "outline.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "algos.h"
+#include "bbox.h"
+#include "constants.h"
+#include "coordijk.h"
+#include "geoCoord.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3IndexSet.h"
+#include "linkedGeo.h"
+
+/** @struct OutlineTable
+ *  @brief Open addressed hash set of hexagons, optionally recording for each
+ *  hexagon which of its boundary edges have already been traced
+ */
+typedef struct {
+    H3Index* cells;
+    /** Bit (1 << direction) is set once that edge has been traced */
+    uint8_t* traced;
+    int capacity;
+    int size;
+} OutlineTable;
+
+/** @struct OutlineSet
+ *  @brief The input hexagons, which may be of mixed resolution
+ */
+typedef struct {
+    OutlineTable input;
+    /** Bit (1 << res) is set if the input has a hexagon at res */
+    int resolutions;
+    /** Finest resolution in the input, at which the outline is traced */
+    int res;
+} OutlineSet;
+
+/** @struct OutlineCellList
+ *  @brief Growable list of the finest resolution hexagons with at least one
+ *  edge on the outline
+ */
+typedef struct {
+    H3Index* cells;
+    int size;
+    int capacity;
+} OutlineCellList;
+
+/** @struct OutlineLoops
+ *  @brief Traced loops, with the vertices of all loops in one flat array
+ */
+typedef struct {
+    GeoCoord* coords;
+    int numCoords;
+    int coordCapacity;
+    /** Index of the first vertex of each loop, plus one past the last loop */
+    int* loopStarts;
+    /** Left turns minus right turns of each loop, positive for outer loops */
+    int* turns;
+    int numLoops;
+    int loopCapacity;
+} OutlineLoops;
+
+/** @struct OutlinePolygons
+ *  @brief Traced loops grouped into polygons. Polygon p is made of the loops
+ *  loops[polygonStarts[p]] up to loops[polygonStarts[p + 1] - 1], outer loop
+ *  first.
+ */
+typedef struct {
+    int* loops;
+    int* polygonStarts;
+    int numPolygons;
+} OutlinePolygons;
+
+/** @struct OutlineShell
+ *  @brief An outer loop prepared for containment tests
+ */
+typedef struct {
+    Geofence geofence;
+    BBox bbox;
+    double area;
+    int shell;
+} OutlineShell;
+
+/** @struct OutlineBoundaryCache
+ *  @brief The most recently converted cell boundaries. Consecutive edges of
+ *  an outline share a cell, so this keeps the walk to roughly one boundary
+ *  conversion per outline edge.
+ */
+typedef struct {
+    H3Index cells[3];
+    GeoBoundary boundaries[3];
+    int next;
+} OutlineBoundaryCache;
+
+/**
+ * Initialize an empty table.
+ * @param table    Table to initialize
+ * @param capacity Number of slots, which must exceed the number of hexagons
+ *                 that will be inserted
+ * @param traced   Whether to record traced edges for each hexagon
+ */
+static void _outlineTableInit(OutlineTable* table, int capacity, int traced) {
+    table->capacity = capacity;
+    table->size = 0;
+    table->cells = H3_MEMORY(calloc)(capacity, sizeof(H3Index));
+    assert(table->cells != NULL);
+    table->traced = NULL;
+    if (traced) {
+        table->traced = H3_MEMORY(calloc)(capacity, sizeof(uint8_t));
+        assert(table->traced != NULL);
+    }
+}
+
+/**
+ * Free the memory held by a table.
+ * @param table Table to destroy
+ */
+static void _outlineTableDestroy(OutlineTable* table) {
+    H3_MEMORY(free)(table->traced);
+    H3_MEMORY(free)(table->cells);
+}
+
+/**
+ * Find the slot for a hexagon in a table: either the slot holding it, or
+ * the empty slot where it would be inserted.
+ * @param table Table to search
+ * @param h3    Hexagon to look for
+ * @return      Slot index
+ */
+static int _outlineSlot(const OutlineTable* table, H3Index h3) {
+    int slot = _h3IndexSlot(h3, table->capacity);
+    while (table->cells[slot] != 0 && table->cells[slot] != h3) {
+        slot = (slot + 1) % table->capacity;
+    }
+    return slot;
+}
+
+/**
+ * Insert a hexagon into a table if it is not already present.
+ * @param table Table to insert into
+ * @param h3    Hexagon to insert
+ * @return      Slot index of the hexagon
+ */
+static int _outlineInsert(OutlineTable* table, H3Index h3) {
+    int slot = _outlineSlot(table, h3);
+    if (table->cells[slot] == 0) {
+        assert(table->size < table->capacity - 1);
+        table->cells[slot] = h3;
+        table->size++;
+    }
+    return slot;
+}
+
+/**
+ * Whether a hexagon is covered by the input, either directly or because an
+ * ancestor of it is in the input.
+ * @param set Input hexagons
+ * @param h3  Hexagon to look for
+ * @return    1 if the hexagon is covered, 0 otherwise
+ */
+static int _outlineCovers(const OutlineSet* set, H3Index h3) {
+    if (h3 == 0) {
+        return 0;
+    }
+    for (int res = H3_GET_RESOLUTION(h3); res >= 0; res--) {
+        if (set->resolutions & (1 << res)) {
+            H3Index parent = H3_EXPORT(h3ToParent)(h3, res);
+            if (set->input.cells[_outlineSlot(&set->input, parent)] ==
+                parent) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Get the neighbors of a hexagon across each of its edges.
+ * @param origin    Hexagon to start from
+ * @param neighbors Output neighbors, indexed by direction - 1, with 0 for the
+ *                  deleted direction of a pentagon
+ */
+static void _outlineNeighbors(H3Index origin, H3Index* neighbors) {
+    H3Index edges[6];
+    H3_EXPORT(getH3UnidirectionalEdgesFromHexagon)(origin, edges);
+    for (int i = 0; i < 6; i++) {
+        if (edges[i] == 0) {
+            neighbors[i] = 0;
+        } else {
+            neighbors[i] = H3_EXPORT(
+                getDestinationH3IndexFromUnidirectionalEdge)(edges[i]);
+        }
+    }
+}
+
+/**
+ * Get the next edge direction counter-clockwise around a hexagon. This is
+ * the same order in which h3ToGeoBoundary lists the vertices.
+ * @param direction Current direction
+ * @param pentagon  Whether the hexagon is a pentagon, which has no K edge
+ * @return          Next direction
+ */
+static int _outlineNextDirection(int direction, int pentagon) {
+    direction = _rotate60ccw(direction);
+    if (pentagon && direction == K_AXES_DIGIT) {
+        direction = _rotate60ccw(direction);
+    }
+    return direction;
+}
+
+/**
+ * Add the finest resolution descendants of a covered hexagon that have an
+ * edge on the outline to a list. Descendants are only generated where the
+ * hexagon has a neighbor that is not covered, as the descendants of a
+ * hexagon only border the descendants of its neighbors.
+ * @param set  Input hexagons
+ * @param h3   Covered hexagon, at or coarser than the finest resolution
+ * @param list List to add to
+ */
+static void _outlineCollect(const OutlineSet* set, H3Index h3,
+                            OutlineCellList* list) {
+    H3Index neighbors[6];
+    _outlineNeighbors(h3, neighbors);
+    int boundary = 0;
+    for (int i = 0; i < 6 && !boundary; i++) {
+        boundary = neighbors[i] != 0 && !_outlineCovers(set, neighbors[i]);
+    }
+    if (!boundary) {
+        return;
+    }
+    int res = H3_GET_RESOLUTION(h3);
+    if (res == set->res) {
+        if (list->size == list->capacity) {
+            list->capacity = list->capacity * 2 + 16;
+            list->cells = H3_MEMORY(realloc)(
+                list->cells, list->capacity * sizeof(H3Index));
+            assert(list->cells != NULL);
+        }
+        list->cells[list->size++] = h3;
+        return;
+    }
+    H3Index children[7] = {0};
+    H3_EXPORT(h3ToChildren)(h3, res + 1, children);
+    for (int i = 0; i < 7; i++) {
+        if (children[i] != 0) {
+            _outlineCollect(set, children[i], list);
+        }
+    }
+}
+
+/**
+ * Get the boundary of a cell, converting it only if it is not cached.
+ * @param cache Cache of recent boundaries
+ * @param h3    Cell to get the boundary of
+ * @return      Boundary, valid until the third following call
+ */
+static const GeoBoundary* _outlineBoundary(OutlineBoundaryCache* cache,
+                                           H3Index h3) {
+    for (int i = 0; i < 3; i++) {
+        if (cache->cells[i] == h3) {
+            return &cache->boundaries[i];
+        }
+    }
+    int i = cache->next;
+    cache->next = (cache->next + 1) % 3;
+    cache->cells[i] = h3;
+    H3_EXPORT(h3ToGeoBoundary)(h3, &cache->boundaries[i]);
+    return &cache->boundaries[i];
+}
+
+/**
+ * Add a vertex to the loop being traced.
+ * @param loops  Loops to add to
+ * @param vertex Vertex to add
+ */
+static void _outlineAddCoord(OutlineLoops* loops, const GeoCoord* vertex) {
+    if (loops->numCoords == loops->coordCapacity) {
+        loops->coordCapacity = loops->coordCapacity * 2 + 64;
+        loops->coords = H3_MEMORY(realloc)(
+            loops->coords, loops->coordCapacity * sizeof(GeoCoord));
+        assert(loops->coords != NULL);
+    }
+    loops->coords[loops->numCoords++] = *vertex;
+}
+
+/**
+ * Add the vertices of the edge between a hexagon and its neighbor to a loop,
+ * in the hexagon's counter-clockwise order. The final vertex of the edge is
+ * left off, as it starts the next edge of the outline.
+ *
+ * The two corners of the edge appear in both boundaries. Distortion vertices
+ * between them are taken from the hexagon's own boundary, as they are not
+ * guaranteed to match exactly between the two cells.
+ * @param cache    Cache of recent boundaries
+ * @param h3       Hexagon on the inside of the edge
+ * @param neighbor Hexagon on the outside of the edge
+ * @param loops    Loops to add the vertices to
+ */
+static void _outlineAddEdge(OutlineBoundaryCache* cache, H3Index h3,
+                            H3Index neighbor, OutlineLoops* loops) {
+    GeoBoundary inner = *_outlineBoundary(cache, h3);
+    const GeoBoundary* outer = _outlineBoundary(cache, neighbor);
+    int numVerts = inner.numVerts;
+    int shared[MAX_CELL_BNDRY_VERTS] = {0};
+    for (int i = 0; i < numVerts; i++) {
+        for (int j = 0; j < outer->numVerts; j++) {
+            if (geoAlmostEqual(&inner.verts[i], &outer->verts[j])) {
+                shared[i] = 1;
+            }
+        }
+    }
+    // The edge starts at the shared vertex that has all of the other shared
+    // vertices within the next two positions.
+    for (int i = 0; i < numVerts; i++) {
+        if (!shared[i]) {
+            continue;
+        }
+        int length = 0;
+        for (int j = 1; j < numVerts; j++) {
+            if (shared[(i + j) % numVerts]) {
+                length = j;
+            }
+        }
+        if (length <= 2) {
+            for (int j = 0; j < length; j++) {
+                _outlineAddCoord(loops, &inner.verts[(i + j) % numVerts]);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Trace one loop of the outline, starting from an untraced boundary edge
+ * and keeping the set on its left, so outer loops are counter-clockwise and
+ * holes are clockwise.
+ *
+ * Every vertex is shared by three cells. From the edge between a hexagon in
+ * the set and a neighbor outside it, the next edge is found by looking at the
+ * third cell at the end of the edge: if it is outside the set the outline
+ * turns left to the hexagon's next edge, otherwise it continues along the
+ * edge between that third cell and the same outside neighbor.
+ * @param set       Input hexagons
+ * @param traced    Finest resolution hexagons on the outline, with the edges
+ *                  traced so far
+ * @param cache     Cache of recent boundaries
+ * @param h3        Hexagon on the inside of the starting edge
+ * @param direction Direction of the starting edge
+ * @param loops     Loops to add the vertices to
+ * @return          Number of left turns minus number of right turns, which
+ *                  is positive for outer loops and negative for holes
+ */
+static int _outlineTraceLoop(const OutlineSet* set, OutlineTable* traced,
+                             OutlineBoundaryCache* cache, H3Index h3,
+                             int direction, OutlineLoops* loops) {
+    int turns = 0;
+    H3Index neighbors[6];
+    _outlineNeighbors(h3, neighbors);
+    H3Index neighbor = neighbors[direction - 1];
+    int slot = _outlineInsert(traced, h3);
+    while (!(traced->traced[slot] & (1 << direction))) {
+        traced->traced[slot] |= 1 << direction;
+        _outlineAddEdge(cache, h3, neighbor, loops);
+
+        int nextDirection =
+            _outlineNextDirection(direction, H3_EXPORT(h3IsPentagon)(h3));
+        H3Index next = neighbors[nextDirection - 1];
+        if (!_outlineCovers(set, next)) {
+            direction = nextDirection;
+            neighbor = next;
+            turns++;
+        } else {
+            // Continue on the next hexagon, along its edge with the same
+            // outside neighbor
+            _outlineNeighbors(next, neighbors);
+            for (direction = 1; direction < 7; direction++) {
+                if (neighbors[direction - 1] == neighbor) {
+                    break;
+                }
+            }
+            h3 = next;
+            slot = _outlineInsert(traced, h3);
+            turns--;
+        }
+    }
+    return turns;
+}
+
+/**
+ * Trace every loop of the outline of a set of hexagons.
+ * @param h3Set    Set of hexagons
+ * @param numHexes Number of hexagons in the set
+ * @param loops    Output loops, which must be zero initialized
+ */
+static void _outlineTrace(const H3Index* h3Set, const int numHexes,
+                          OutlineLoops* loops) {
+    OutlineSet set = {{0}};
+    _outlineTableInit(&set.input, numHexes * 2 + 1, 0);
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] != 0) {
+            _outlineInsert(&set.input, h3Set[i]);
+            int res = H3_GET_RESOLUTION(h3Set[i]);
+            set.resolutions |= 1 << res;
+            if (res > set.res) {
+                set.res = res;
+            }
+        }
+    }
+
+    OutlineCellList list = {0};
+    for (int i = 0; i < numHexes; i++) {
+        if (h3Set[i] != 0) {
+            _outlineCollect(&set, h3Set[i], &list);
+        }
+    }
+    OutlineTable traced;
+    _outlineTableInit(&traced, list.size * 2 + 1, 1);
+    for (int i = 0; i < list.size; i++) {
+        _outlineInsert(&traced, list.cells[i]);
+    }
+
+    OutlineBoundaryCache cache = {{0}};
+    for (int i = 0; i < list.size; i++) {
+        H3Index h3 = list.cells[i];
+        H3Index neighbors[6];
+        _outlineNeighbors(h3, neighbors);
+        int slot = _outlineSlot(&traced, h3);
+        for (int direction = 1; direction < 7; direction++) {
+            if (neighbors[direction - 1] == 0 ||
+                (traced.traced[slot] & (1 << direction)) ||
+                _outlineCovers(&set, neighbors[direction - 1])) {
+                continue;
+            }
+            if (loops->numLoops + 1 >= loops->loopCapacity) {
+                loops->loopCapacity = loops->loopCapacity * 2 + 4;
+                loops->loopStarts = H3_MEMORY(realloc)(
+                    loops->loopStarts, loops->loopCapacity * sizeof(int));
+                assert(loops->loopStarts != NULL);
+                loops->turns = H3_MEMORY(realloc)(
+                    loops->turns, loops->loopCapacity * sizeof(int));
+                assert(loops->turns != NULL);
+            }
+            loops->loopStarts[loops->numLoops] = loops->numCoords;
+            loops->turns[loops->numLoops] = _outlineTraceLoop(
+                &set, &traced, &cache, h3, direction, loops);
+            loops->numLoops++;
+            loops->loopStarts[loops->numLoops] = loops->numCoords;
+        }
+    }
+
+    _outlineTableDestroy(&traced);
+    H3_MEMORY(free)(list.cells);
+    _outlineTableDestroy(&set.input);
+}
+
+/**
+ * Free the memory held by traced loops.
+ * @param loops Loops to destroy
+ */
+static void _outlineLoopsDestroy(OutlineLoops* loops) {
+    H3_MEMORY(free)(loops->coords);
+    H3_MEMORY(free)(loops->loopStarts);
+    H3_MEMORY(free)(loops->turns);
+}
+
+/**
+ * Order outer loops by increasing bounding box area.
+ */
+static int _outlineShellCompare(const void* a, const void* b) {
+    double areaA = ((const OutlineShell*)a)->area;
+    double areaB = ((const OutlineShell*)b)->area;
+    return (areaA > areaB) - (areaA < areaB);
+}
+
+/**
+ * Group traced loops into polygons: one polygon per outer loop, in the order
+ * traced, followed by each hole whose innermost containing outer loop it is.
+ * Loops produced by tracing never cross or touch, so the outer loops
+ * containing a hole are nested, and the first one found in order of
+ * increasing bounding box area is the innermost. Holes are only tested
+ * against outer loops whose bounding box contains them.
+ * @param loops    Traced loops
+ * @param polygons Output polygons
+ */
+static void _outlineGroup(const OutlineLoops* loops,
+                          OutlinePolygons* polygons) {
+    int numShells = 0;
+    for (int i = 0; i < loops->numLoops; i++) {
+        numShells += loops->turns[i] > 0;
+    }
+    polygons->loops = H3_MEMORY(malloc)((loops->numLoops + 1) * sizeof(int));
+    assert(polygons->loops != NULL);
+    if (numShells == 0) {
+        // Without an outer loop (such as a set covering the whole globe)
+        // there is nothing to attach the holes to, so they form one polygon
+        polygons->numPolygons = loops->numLoops > 0;
+        polygons->polygonStarts = H3_MEMORY(malloc)(2 * sizeof(int));
+        assert(polygons->polygonStarts != NULL);
+        polygons->polygonStarts[0] = 0;
+        polygons->polygonStarts[1] = loops->numLoops;
+        for (int i = 0; i < loops->numLoops; i++) {
+            polygons->loops[i] = i;
+        }
+        return;
+    }
+
+    // shell[i] is the polygon of loop i, which for holes is found below
+    int* shell = H3_MEMORY(malloc)(loops->numLoops * sizeof(int));
+    assert(shell != NULL);
+    OutlineShell* byArea = H3_MEMORY(malloc)(numShells * sizeof(OutlineShell));
+    assert(byArea != NULL);
+    int numPrepared = 0;
+    for (int i = 0; i < loops->numLoops; i++) {
+        shell[i] = 0;
+        if (loops->turns[i] > 0) {
+            OutlineShell* prepared = &byArea[numPrepared];
+            prepared->shell = numPrepared++;
+            shell[i] = prepared->shell;
+            prepared->geofence.numVerts =
+                loops->loopStarts[i + 1] - loops->loopStarts[i];
+            prepared->geofence.verts = loops->coords + loops->loopStarts[i];
+            bboxFromGeofence(&prepared->geofence, &prepared->bbox);
+            double width = prepared->bbox.east - prepared->bbox.west;
+            if (bboxIsTransmeridian(&prepared->bbox)) {
+                width += M_2PI;
+            }
+            prepared->area =
+                width * (prepared->bbox.north - prepared->bbox.south);
+        }
+    }
+    qsort(byArea, numShells, sizeof(OutlineShell), _outlineShellCompare);
+
+    polygons->numPolygons = numShells;
+    polygons->polygonStarts =
+        H3_MEMORY(calloc)(numShells + 1, sizeof(int));
+    assert(polygons->polygonStarts != NULL);
+    for (int i = 0; i < loops->numLoops; i++) {
+        if (loops->turns[i] <= 0) {
+            // Loops share no vertices, so any vertex of the hole will do
+            const GeoCoord* point = &loops->coords[loops->loopStarts[i]];
+            for (int j = 0; j < numShells; j++) {
+                if (_pointInPolyContainsLoop(&byArea[j].geofence,
+                                             &byArea[j].bbox, point)) {
+                    shell[i] = byArea[j].shell;
+                    break;
+                }
+            }
+        }
+        polygons->polygonStarts[shell[i] + 1]++;
+    }
+    for (int p = 0; p < numShells; p++) {
+        polygons->polygonStarts[p + 1] += polygons->polygonStarts[p];
+    }
+    // Each outer loop starts its polygon, followed by its holes in the order
+    // they were traced
+    int* next = H3_MEMORY(malloc)(numShells * sizeof(int));
+    assert(next != NULL);
+    for (int p = 0; p < numShells; p++) {
+        next[p] = polygons->polygonStarts[p] + 1;
+    }
+    for (int i = 0; i < loops->numLoops; i++) {
+        if (loops->turns[i] > 0) {
+            polygons->loops[polygons->polygonStarts[shell[i]]] = i;
+        } else {
+            polygons->loops[next[shell[i]]++] = i;
+        }
+    }
+
+    H3_MEMORY(free)(next);
+    H3_MEMORY(free)(byArea);
+    H3_MEMORY(free)(shell);
+}
+
+/**
+ * Free the memory held by grouped polygons.
+ * @param polygons Polygons to destroy
+ */
+static void _outlinePolygonsDestroy(OutlinePolygons* polygons) {
+    H3_MEMORY(free)(polygons->loops);
+    H3_MEMORY(free)(polygons->polygonStarts);
+}
+
+/**
+ * Internal: Create a LinkedGeoPolygon describing the outline(s) of a set of
+ * hexagons by tracing their boundary edges. Each outer loop is returned as a
+ * separate polygon in the linked list starting at out, followed by its
+ * holes. The set may mix resolutions, in which case the outline is that of
+ * the union of the hexagons at the finest resolution present.
+ * It is the responsibility of the caller to call destroyLinkedPolygon on the
+ * populated linked geo structure.
+ * @private
+ * @param h3Set    Set of hexagons
+ * @param numHexes Number of hexagons in the set
+ * @param out      Output polygon
+ */
+void h3SetToOutline(const H3Index* h3Set, const int numHexes,
+                    LinkedGeoPolygon* out) {
+    initLinkedPolygon(out);
+    if (numHexes < 1) {
+        return;
+    }
+    OutlineLoops loops = {0};
+    _outlineTrace(h3Set, numHexes, &loops);
+    OutlinePolygons polygons;
+    _outlineGroup(&loops, &polygons);
+
+    LinkedGeoPolygon* polygon = out;
+    for (int p = 0; p < polygons.numPolygons; p++) {
+        if (p > 0) {
+            polygon = addLinkedPolygon(polygon);
+        }
+        for (int i = polygons.polygonStarts[p];
+             i < polygons.polygonStarts[p + 1]; i++) {
+            int l = polygons.loops[i];
+            LinkedGeoLoop* loop = addLinkedLoop(polygon);
+            for (int c = loops.loopStarts[l]; c < loops.loopStarts[l + 1];
+                 c++) {
+                addLinkedCoord(loop, &loops.coords[c]);
+            }
+        }
+    }
+
+    _outlinePolygonsDestroy(&polygons);
+    _outlineLoopsDestroy(&loops);
+}
+
+/**
+ * Internal: Fill a FlatGeoMultiPolygon with the outline(s) of a set of
+ * hexagons, grouped as by h3SetToOutline. All of the arrays are carved from a
+ * single allocation, released with destroyFlatGeo.
+ * @private
+ * @param h3Set    Set of hexagons
+ * @param numHexes Number of hexagons in the set
+ * @param out      Output polygons
+ */
+void h3SetToFlatOutline(const H3Index* h3Set, const int numHexes,
+                        FlatGeoMultiPolygon* out) {
+    OutlineLoops loops = {0};
+    if (numHexes > 0) {
+        _outlineTrace(h3Set, numHexes, &loops);
+    }
+    OutlinePolygons polygons;
+    _outlineGroup(&loops, &polygons);
+
+    out->numPolygons = polygons.numPolygons;
+    out->numLoops = loops.numLoops;
+    out->numCoords = loops.numCoords;
+    // Coordinates go first in the block so that they are suitably aligned
+    size_t coordsSize = loops.numCoords * sizeof(GeoCoord);
+    size_t offsetsSize =
+        (polygons.numPolygons + 1 + loops.numLoops + 1) * sizeof(int);
+    char* block = H3_MEMORY(malloc)(coordsSize + offsetsSize);
+    assert(block != NULL);
+    out->coords = (GeoCoord*)block;
+    out->polygonOffsets = (int*)(block + coordsSize);
+    out->loopOffsets = out->polygonOffsets + polygons.numPolygons + 1;
+
+    int numLoops = 0;
+    int numCoords = 0;
+    for (int p = 0; p < polygons.numPolygons; p++) {
+        out->polygonOffsets[p] = numLoops;
+        for (int i = polygons.polygonStarts[p];
+             i < polygons.polygonStarts[p + 1]; i++) {
+            int l = polygons.loops[i];
+            out->loopOffsets[numLoops++] = numCoords;
+            for (int c = loops.loopStarts[l]; c < loops.loopStarts[l + 1];
+                 c++) {
+                out->coords[numCoords++] = loops.coords[c];
+            }
+        }
+    }
+    out->polygonOffsets[polygons.numPolygons] = numLoops;
+    out->loopOffsets[numLoops] = numCoords;
+
+    _outlinePolygonsDestroy(&polygons);
+    _outlineLoopsDestroy(&loops);
+}
+
+/**
+ * Free the memory held by a FlatGeoMultiPolygon filled by h3SetToFlatGeo.
+ * The caller is responsible for the memory of the struct itself.
+ * @param polygons Polygons to destroy
+ */
+void H3_EXPORT(destroyFlatGeo)(FlatGeoMultiPolygon* polygons) {
+    // Every array lives in the block starting at coords
+    H3_MEMORY(free)(polygons->coords);
+    polygons->coords = NULL;
+    polygons->polygonOffsets = NULL;
+    polygons->loopOffsets = NULL;
+    polygons->numPolygons = 0;
+    polygons->numLoops = 0;
+    polygons->numCoords = 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file polyline.c
+ * @brief   Cells crossed by paths of great circle arcs
+ *
+ * Each segment of a path is split into arcs short enough to project onto
+ * any face they touch, and each arc is walked cell by cell in the 2D hex
+ * coordinates of the faces it crosses by _vec3dArcToCells, so the cost is
+ * proportional to the number of cells crossed.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include "bbox.h"
+#include "constants.h"
+#include "faceijk.h"
+#include "geoCoord.h"
+#include "h3Index.h"
+#include "h3api.h"
+#include "vec3d.h"
+
+/**
+ * Whether every point of a path has finite coordinates.
+ */
+static int _polylineIsFinite(const GeoCoord* pts, int numPts) {
+    for (int i = 0; i < numPts; i++) {
+        if (!isfinite(pts[i].lat) || !isfinite(pts[i].lon)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * maxPolylineToCellsSize returns the number of indexes to allocate space for
+ * when calling polylineToCells on a path.
+ *
+ * A straight segment crosses at most 2 / sqrt(3) cells per circumradius of
+ * the cells it crosses, plus the cells at its ends. The bound allows for a
+ * cell per 0.5 of the smallest circumradius at the resolution, which also
+ * covers the stretching of the cells in the gnomonic projection.
+ *
+ * @param pts The points of the path, in radians
+ * @param numPts The number of points
+ * @param res Hexagon resolution (0-15)
+ * @return The number of indexes to allocate for, 0 if the path or
+ * resolution is invalid, or -1 if the path is so long that the number does
+ * not fit in an int
+ */
+int H3_EXPORT(maxPolylineToCellsSize)(const GeoCoord* pts, int numPts,
+                                      int res) {
+    if (res < 0 || res > MAX_H3_RES || numPts < 1) return 0;
+    if (!_polylineIsFinite(pts, numPts)) return 0;
+    int64_t size = 1;
+    for (int i = 1; i < numPts; i++) {
+        // circleHexRadius counts 1.5 circumradii per hexagon
+        size +=
+            3 * (int64_t)circleHexRadius(_geoDistKm(&pts[i - 1], &pts[i]), res);
+        if (size > INT_MAX) return -1;
+    }
+    return (int)size;
+}
+
+/**
+ * polylineToCells produces the cells crossed by a path of great circle arcs
+ * between consecutive points, in order along the path.
+ *
+ * Each cell is the one geoToH3 gives for the points of the path in it, and
+ * from one cell to the next the path crosses their shared edge. A cell is
+ * not repeated where the path stays in it from one segment to the next, but
+ * is repeated if the path leaves it and later returns.
+ *
+ * If the buffer is too small, it is filled completely and the total number of
+ * cells is still returned, so the caller can grow the buffer to the returned
+ * size and call again. The buffer does not need to be zeroed.
+ *
+ * @param pts The points of the path, in radians
+ * @param numPts The number of points
+ * @param res Hexagon resolution (0-15)
+ * @param out The buffer to write to, of maxPolylineToCellsSize(pts, numPts,
+ * res) indexes to always hold the path
+ * @param outSize The number of indexes the buffer can hold
+ * @return The number of cells in the path, which may exceed outSize, or 0 if
+ * the path or resolution is invalid
+ */
+int H3_EXPORT(polylineToCells)(const GeoCoord* pts, int numPts, int res,
+                               H3Index* out, int outSize) {
+    if (res < 0 || res > MAX_H3_RES || numPts < 1) return 0;
+    if (!_polylineIsFinite(pts, numPts)) return 0;
+
+    CellPath path = {out, outSize, 0, H3_INVALID_INDEX};
+    Vec3d a, b;
+    _geoToVec3d(&pts[0], &a);
+    if (numPts == 1) {
+        _vec3dArcToCells(&a, &a, res, &path);
+        return path.count;
+    }
+    for (int i = 1; i < numPts; i++) {
+        _geoToVec3d(&pts[i], &b);
+        double distance = _geoDistRads(&pts[i - 1], &pts[i]);
+        int numArcs = (int)ceil(distance / MAX_CELL_ARC_RADS);
+        if (numArcs <= 1) {
+            _vec3dArcToCells(&a, &b, res, &path);
+        } else {
+            // Split the segment at points interpolated along its great
+            // circle
+            Vec3d start = a;
+            double sinDistance = sin(distance);
+            for (int arc = 1; arc <= numArcs; arc++) {
+                Vec3d end = b;
+                if (arc < numArcs) {
+                    double s = (double)arc / numArcs;
+                    double wa = sin((1 - s) * distance) / sinDistance;
+                    double wb = sin(s * distance) / sinDistance;
+                    end.x = wa * a.x + wb * b.x;
+                    end.y = wa * a.y + wb * b.y;
+                    end.z = wa * a.z + wb * b.z;
+                }
+                _vec3dArcToCells(&start, &end, res, &path);
+                start = end;
+            }
+        }
+        a = b;
+    }
+    return path.count;
+}
@@ -0,0 +1,480 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file preparedPolygon.c
+ * @brief   Polygons indexed by latitude for repeated containment queries
+ *
+ * The edges of each geofence are bucketed into slices of equal latitude
+ * height, so a query only visits the edges that overlap the latitudes it
+ * covers instead of every edge of the geofence.
+ */
+
+#include "preparedPolygon.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "algos.h"
+#include "bbox.h"
+#include "constants.h"
+#include "geoCoord.h"
+#include "h3Alloc.h"
+#include "h3Stats.h"
+#include "h3api.h"
+
+/**
+ * Maximum average number of slices an edge may be bucketed into. Geofences
+ * with many edges spanning a large range of latitudes use fewer slices.
+ */
+#define MAX_SLICES_PER_EDGE 8
+
+/**
+ * Index of the latitude slice containing the given latitude, clamped to the
+ * slices of the geofence.
+ *
+ * @param prepared The prepared geofence
+ * @param lat The latitude
+ * @return The slice index
+ */
+static int _sliceOf(const PreparedGeofence* prepared, double lat) {
+    int slice = (int)((lat - prepared->south) * prepared->sliceScale);
+    if (slice < 0) return 0;
+    if (slice >= prepared->numSlices) return prepared->numSlices - 1;
+    return slice;
+}
+
+/**
+ * Counts the number of slice entries needed for a geofence, and fills in the
+ * number of entries for each slice.
+ *
+ * @param prepared The prepared geofence, with its slices configured
+ * @param counts Output number of entries for each slice, or NULL
+ * @return The total number of entries
+ */
+static int _countSliceEntries(const PreparedGeofence* prepared, int* counts) {
+    const Geofence* geofence = prepared->geofence;
+    int total = 0;
+    for (int i = 0; i < geofence->numVerts; i++) {
+        const GeoCoord* a = &geofence->verts[i];
+        const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+        int first = _sliceOf(prepared, fmin(a->lat, b->lat));
+        int last = _sliceOf(prepared, fmax(a->lat, b->lat));
+        if (counts != NULL) {
+            for (int s = first; s <= last; s++) {
+                counts[s]++;
+            }
+        }
+        total += last - first + 1;
+    }
+    return total;
+}
+
+/**
+ * Configures the latitude slices of a geofence, using one slice per edge
+ * when that does not duplicate edges into too many slices.
+ *
+ * @param prepared The prepared geofence, with its geofence and bbox set
+ */
+static void _configureSlices(PreparedGeofence* prepared) {
+    int numVerts = prepared->geofence->numVerts;
+    double height = prepared->bbox->north - prepared->bbox->south;
+    prepared->south = prepared->bbox->south;
+    prepared->numSlices = numVerts > 1 ? numVerts : 1;
+    while (true) {
+        prepared->sliceScale = height > 0 ? prepared->numSlices / height : 0;
+        if (prepared->numSlices == 1 ||
+            _countSliceEntries(prepared, NULL) <=
+                MAX_SLICES_PER_EDGE * numVerts) {
+            return;
+        }
+        prepared->numSlices /= 2;
+    }
+}
+
+/**
+ * Buckets the edges of a geofence into latitude slices.
+ *
+ * @param geofence The geofence
+ * @param bbox The bounding box of the geofence
+ * @param prepared Output prepared geofence
+ */
+static void _prepareGeofence(const Geofence* geofence, const BBox* bbox,
+                             PreparedGeofence* prepared) {
+    prepared->geofence = geofence;
+    prepared->bbox = bbox;
+    _configureSlices(prepared);
+
+    prepared->sliceOffsets =
+        H3_MEMORY(calloc)(prepared->numSlices + 1, sizeof(int));
+    assert(prepared->sliceOffsets != NULL);
+    int total = _countSliceEntries(prepared, prepared->sliceOffsets + 1);
+    for (int s = 0; s < prepared->numSlices; s++) {
+        prepared->sliceOffsets[s + 1] += prepared->sliceOffsets[s];
+    }
+
+    prepared->edges = H3_MEMORY(malloc)((total > 0 ? total : 1) * sizeof(int));
+    assert(prepared->edges != NULL);
+    int* next = H3_MEMORY(calloc)(prepared->numSlices, sizeof(int));
+    assert(next != NULL);
+    // Edges are added in order, so each slice lists its edges in the same
+    // order as the geofence.
+    for (int i = 0; i < geofence->numVerts; i++) {
+        const GeoCoord* a = &geofence->verts[i];
+        const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+        int first = _sliceOf(prepared, fmin(a->lat, b->lat));
+        int last = _sliceOf(prepared, fmax(a->lat, b->lat));
+        for (int s = first; s <= last; s++) {
+            prepared->edges[prepared->sliceOffsets[s] + next[s]] = i;
+            next[s]++;
+        }
+    }
+    H3_MEMORY(free)(next);
+}
+
+/**
+ * prepareGeoPolygon indexes a polygon for repeated containment queries. It is
+ * the responsibility of the caller to call destroyPreparedGeoPolygon on the
+ * result. The polygon must remain valid until then.
+ *
+ * @param geoPolygon The geofence and holes defining the relevant area
+ * @return The prepared polygon
+ */
+PreparedGeoPolygon* H3_EXPORT(prepareGeoPolygon)(
+    const GeoPolygon* geoPolygon) {
+    int numGeofences = geoPolygon->numHoles + 1;
+    PreparedGeoPolygon* prepared =
+        H3_MEMORY(malloc)(sizeof(PreparedGeoPolygon));
+    assert(prepared != NULL);
+    prepared->geoPolygon = geoPolygon;
+    prepared->bboxes = H3_MEMORY(calloc)(numGeofences, sizeof(BBox));
+    assert(prepared->bboxes != NULL);
+    bboxesFromGeoPolygon(geoPolygon, prepared->bboxes);
+    prepared->geofences =
+        H3_MEMORY(calloc)(numGeofences, sizeof(PreparedGeofence));
+    assert(prepared->geofences != NULL);
+
+    _prepareGeofence(&geoPolygon->geofence, &prepared->bboxes[0],
+                     &prepared->geofences[0]);
+    for (int i = 0; i < geoPolygon->numHoles; i++) {
+        _prepareGeofence(&geoPolygon->holes[i], &prepared->bboxes[i + 1],
+                         &prepared->geofences[i + 1]);
+    }
+    return prepared;
+}
+
+/**
+ * Free all memory created for a prepared polygon. The polygon it was prepared
+ * from is not freed.
+ *
+ * @param prepared The prepared polygon, which may be NULL
+ */
+void H3_EXPORT(destroyPreparedGeoPolygon)(PreparedGeoPolygon* prepared) {
+    if (prepared == NULL) {
+        return;
+    }
+    for (int i = 0; i <= prepared->geoPolygon->numHoles; i++) {
+        H3_MEMORY(free)(prepared->geofences[i].sliceOffsets);
+        H3_MEMORY(free)(prepared->geofences[i].edges);
+    }
+    H3_MEMORY(free)(prepared->geofences);
+    H3_MEMORY(free)(prepared->bboxes);
+    H3_MEMORY(free)(prepared);
+}
+
+/**
+ * Ray casting containment test for a prepared geofence. This gives the same
+ * result as _pointInPolyContainsLoop, but only visits the edges in the slice
+ * of the point's latitude.
+ *
+ * @param prepared The prepared geofence
+ * @param coord The coordinate to check
+ * @return true if the coordinate is contained by the geofence
+ */
+bool _preparedGeofenceContains(const PreparedGeofence* prepared,
+                               const GeoCoord* coord) {
+    // fail fast if we're outside the bounding box
+    if (!bboxContains(prepared->bbox, coord)) {
+        return false;
+    }
+    const Geofence* geofence = prepared->geofence;
+    bool isTransmeridian = bboxIsTransmeridian(prepared->bbox);
+    bool contains = false;
+
+    double lat = coord->lat;
+    double lng = _normalizeLng(coord->lon, isTransmeridian);
+
+    // Every edge whose latitude range contains lat is in this slice, in the
+    // order of the geofence, so the westerly bias below is applied exactly
+    // as in the unprepared test.
+    int slice = _sliceOf(prepared, lat);
+    H3_STAT_ADD(pointInPolyEdges, prepared->sliceOffsets[slice + 1] -
+                                      prepared->sliceOffsets[slice]);
+    for (int e = prepared->sliceOffsets[slice];
+         e < prepared->sliceOffsets[slice + 1]; e++) {
+        int i = prepared->edges[e];
+        GeoCoord a = geofence->verts[i];
+        GeoCoord b = geofence->verts[(i + 1) % geofence->numVerts];
+
+        // Ray casting algo requires the second point to always be higher
+        // than the first, so swap if needed
+        if (a.lat > b.lat) {
+            GeoCoord tmp = a;
+            a = b;
+            b = tmp;
+        }
+
+        if (lat < a.lat || lat > b.lat) {
+            continue;
+        }
+
+        double aLng = _normalizeLng(a.lon, isTransmeridian);
+        double bLng = _normalizeLng(b.lon, isTransmeridian);
+
+        // Rays are cast in the longitudinal direction, in case a point
+        // exactly matches, to decide tiebreakers, bias westerly
+        if (aLng == lng || bLng == lng) {
+            lng -= DBL_EPSILON;
+        }
+
+        double ratio = (lat - a.lat) / (b.lat - a.lat);
+        double testLng =
+            _normalizeLng(aLng + (bLng - aLng) * ratio, isTransmeridian);
+
+        // Intersection of the ray
+        if (testLng > lng) {
+            contains = !contains;
+        }
+    }
+
+    return contains;
+}
+
+/**
+ * Containment test for a prepared polygon, giving the same result as
+ * _pointInPolyContains.
+ *
+ * @param prepared The prepared polygon
+ * @param coord The coordinate to check
+ * @return true if the coordinate is in the polygon and not in any hole
+ */
+bool _preparedPolygonContains(const PreparedGeoPolygon* prepared,
+                              const GeoCoord* coord) {
+    if (!_preparedGeofenceContains(&prepared->geofences[0], coord)) {
+        return false;
+    }
+    for (int i = 1; i <= prepared->geoPolygon->numHoles; i++) {
+        if (_preparedGeofenceContains(&prepared->geofences[i], coord)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * preparedGeoPolygonContains checks whether a point is contained in a
+ * prepared polygon, and not in any of its holes.
+ *
+ * @param prepared The prepared polygon
+ * @param coord The coordinate to check
+ * @return 1 if the coordinate is contained, 0 otherwise
+ */
+int H3_EXPORT(preparedGeoPolygonContains)(const PreparedGeoPolygon* prepared,
+                                          const GeoCoord* coord) {
+    return _preparedPolygonContains(prepared, coord);
+}
+
+/**
+ * Whether the straight lat/lon segment between two points intersects an
+ * axis aligned lat/lon rectangle, using Liang-Barsky clipping.
+ *
+ * @param a The first endpoint
+ * @param b The second endpoint
+ * @param north North edge of the rectangle
+ * @param south South edge of the rectangle
+ * @param east East edge of the rectangle
+ * @param west West edge of the rectangle
+ * @return true if the segment touches the rectangle
+ */
+static bool _segmentIntersectsRect(const GeoCoord* a, const GeoCoord* b,
+                                   double north, double south, double east,
+                                   double west) {
+    double dLat = b->lat - a->lat;
+    double dLon = b->lon - a->lon;
+    double p[4] = {-dLon, dLon, -dLat, dLat};
+    double q[4] = {a->lon - west, east - a->lon, a->lat - south,
+                   north - a->lat};
+    double t0 = 0;
+    double t1 = 1;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            // parallel to this edge of the rectangle
+            if (q[i] < 0) return false;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0) {
+                if (t > t1) return false;
+                if (t > t0) t0 = t;
+            } else {
+                if (t < t0) return false;
+                if (t < t1) t1 = t;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Whether any edge of the prepared geofence intersects the given bounding
+ * box. If not, every point in the box is on the same side of the geofence.
+ * Only the edges in the slices overlapping the box are tested.
+ *
+ * @param prepared The prepared geofence, which must not be transmeridian
+ * @param bbox The bounding box
+ * @return true if an edge crosses the box
+ */
+static bool _preparedGeofenceCrossesBBox(const PreparedGeofence* prepared,
+                                         const BBox* bbox) {
+    if (bbox->north < prepared->bbox->south ||
+        bbox->south > prepared->bbox->north) {
+        return false;
+    }
+    const Geofence* geofence = prepared->geofence;
+    bool isTransmeridian = bboxIsTransmeridian(bbox);
+    int firstSlice = _sliceOf(prepared, bbox->south);
+    int lastSlice = _sliceOf(prepared, bbox->north);
+    for (int e = prepared->sliceOffsets[firstSlice];
+         e < prepared->sliceOffsets[lastSlice + 1]; e++) {
+        int i = prepared->edges[e];
+        const GeoCoord* a = &geofence->verts[i];
+        const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+        if (isTransmeridian) {
+            if (_segmentIntersectsRect(a, b, bbox->north, bbox->south, M_PI,
+                                       bbox->west) ||
+                _segmentIntersectsRect(a, b, bbox->north, bbox->south,
+                                       bbox->east, -M_PI)) {
+                return true;
+            }
+        } else if (_segmentIntersectsRect(a, b, bbox->north, bbox->south,
+                                          bbox->east, bbox->west)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Whether the boundary of the prepared polygon, or of any of its holes,
+ * crosses the given bounding box.
+ *
+ * @param prepared The prepared polygon, which must not be transmeridian
+ * @param bbox The bounding box
+ * @return true if an edge crosses the box
+ */
+bool _preparedPolygonCrossesBBox(const PreparedGeoPolygon* prepared,
+                                 const BBox* bbox) {
+    for (int i = 0; i <= prepared->geoPolygon->numHoles; i++) {
+        if (_preparedGeofenceCrossesBBox(&prepared->geofences[i], bbox)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * The sign of the turn from segment ab to point c, in lat/lon.
+ *
+ * @return Positive for a counterclockwise turn, negative for clockwise, and
+ * 0 if the points are collinear
+ */
+static double _turn(double aLat, double aLng, double bLat, double bLng,
+                    double cLat, double cLng) {
+    return (bLng - aLng) * (cLat - aLat) - (bLat - aLat) * (cLng - aLng);
+}
+
+/**
+ * Whether two straight lat/lon segments intersect, including touching at an
+ * endpoint or overlapping when collinear.
+ *
+ * @param a The first endpoint of the first segment
+ * @param b The second endpoint of the first segment
+ * @param c The first endpoint of the second segment
+ * @param d The second endpoint of the second segment
+ * @param isTransmeridian Whether longitudes are normalized as by
+ * _normalizeLng
+ * @return true if the segments have a point in common
+ */
+static bool _segmentsIntersect(const GeoCoord* a, const GeoCoord* b,
+                               const GeoCoord* c, const GeoCoord* d,
+                               bool isTransmeridian) {
+    double aLng = _normalizeLng(a->lon, isTransmeridian);
+    double bLng = _normalizeLng(b->lon, isTransmeridian);
+    double cLng = _normalizeLng(c->lon, isTransmeridian);
+    double dLng = _normalizeLng(d->lon, isTransmeridian);
+    if (fmax(aLng, bLng) < fmin(cLng, dLng) ||
+        fmax(cLng, dLng) < fmin(aLng, bLng) ||
+        fmax(a->lat, b->lat) < fmin(c->lat, d->lat) ||
+        fmax(c->lat, d->lat) < fmin(a->lat, b->lat)) {
+        return false;
+    }
+    double c1 = _turn(a->lat, aLng, b->lat, bLng, c->lat, cLng);
+    double c2 = _turn(a->lat, aLng, b->lat, bLng, d->lat, dLng);
+    double c3 = _turn(c->lat, cLng, d->lat, dLng, a->lat, aLng);
+    double c4 = _turn(c->lat, cLng, d->lat, dLng, b->lat, bLng);
+    // With overlapping bounding boxes, collinear segments overlap
+    return ((c1 <= 0 && c2 >= 0) || (c1 >= 0 && c2 <= 0)) &&
+           ((c3 <= 0 && c4 >= 0) || (c3 >= 0 && c4 <= 0));
+}
+
+/**
+ * Whether any edge of the prepared polygon, or of any of its holes,
+ * intersects an edge of the given loop. Only the polygon edges in the
+ * slices overlapping the loop are tested.
+ *
+ * @param prepared The prepared polygon
+ * @param loop The loop, such as the boundary of a cell
+ * @param loopBBox The bounding box of the loop
+ * @return true if the boundaries of the polygon and the loop intersect
+ */
+bool _preparedPolygonCrossesGeofence(const PreparedGeoPolygon* prepared,
+                                     const Geofence* loop,
+                                     const BBox* loopBBox) {
+    bool isTransmeridian = bboxIsTransmeridian(&prepared->bboxes[0]) ||
+                           bboxIsTransmeridian(loopBBox);
+    for (int g = 0; g <= prepared->geoPolygon->numHoles; g++) {
+        const PreparedGeofence* fence = &prepared->geofences[g];
+        if (loopBBox->north < fence->bbox->south ||
+            loopBBox->south > fence->bbox->north) {
+            continue;
+        }
+        const Geofence* geofence = fence->geofence;
+        int firstSlice = _sliceOf(fence, loopBBox->south);
+        int lastSlice = _sliceOf(fence, loopBBox->north);
+        for (int e = fence->sliceOffsets[firstSlice];
+             e < fence->sliceOffsets[lastSlice + 1]; e++) {
+            int i = fence->edges[e];
+            const GeoCoord* a = &geofence->verts[i];
+            const GeoCoord* b = &geofence->verts[(i + 1) % geofence->numVerts];
+            for (int j = 0; j < loop->numVerts; j++) {
+                if (_segmentsIntersect(a, b, &loop->verts[j],
+                                       &loop->verts[(j + 1) % loop->numVerts],
+                                       isTransmeridian)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file scratch.c
+ * @brief   Reusable heap working memory for the WithScratch functions
+ */
+
+#include "scratch.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "h3Alloc.h"
+#include "h3api.h"
+
+/**
+ * Returns working memory of at least the given size, growing the scratch
+ * buffer if needed. The contents of the memory are undefined, and are only
+ * valid until the next call with the same scratch.
+ *
+ * @param scratch The scratch to take memory from
+ * @param size The number of bytes needed
+ * @return The working memory
+ */
+void* _scratchReserve(H3Scratch* scratch, size_t size) {
+    if (size > scratch->capacity) {
+        // Grow geometrically so that slowly increasing sizes do not
+        // reallocate on every call
+        size_t capacity = scratch->capacity * 2;
+        if (capacity < size) {
+            capacity = size;
+        }
+        // The old contents are not needed, so avoid copying them
+        H3_MEMORY(free)(scratch->buffer);
+        scratch->buffer = H3_MEMORY(malloc)(capacity);
+        assert(scratch->buffer != NULL);
+        scratch->capacity = capacity;
+    }
+    return scratch->buffer;
+}
+
+/**
+ * Free the working memory held by a scratch. The scratch can be reused
+ * afterwards.
+ *
+ * @param scratch The scratch
+ */
+void H3_EXPORT(destroyH3Scratch)(H3Scratch* scratch) {
+    H3_MEMORY(free)(scratch->buffer);
+    scratch->buffer = NULL;
+    scratch->capacity = 0;
+}
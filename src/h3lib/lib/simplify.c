@@ -0,0 +1,276 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file simplify.c
+ * @brief   Geofences simplified within a tolerance of a resolution
+ *
+ * Each loop is simplified with the Douglas-Peucker algorithm, in the plane
+ * of latitude and longitude in which the point in polygon test takes edges
+ * as straight lines. Every vertex dropped is within the tolerance of the
+ * edge replacing it, so each chain of edges dropped lies within the convex
+ * region within the tolerance of its replacement, and a point outside that
+ * region crosses the chain and its replacement the same number of times.
+ * Only points within the tolerance of the simplified boundary, which is
+ * within twice the tolerance of the original one, can change containment.
+ *
+ * The tolerance is a fraction of the hexagon edge length of the resolution
+ * polyfilled, measured as an angle. A difference of longitude is a shorter
+ * distance on the ground away from the equator, so the tolerance on the
+ * ground is smaller still.
+ */
+
+#include "simplify.h"
+#include <assert.h>
+#include <math.h>
+#include "algos.h"
+#include "bbox.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "vec2d.h"
+
+/**
+ * The squared distance in the plane from a point to a segment.
+ *
+ * @param p The point
+ * @param a The start of the segment
+ * @param b The end of the segment
+ * @return The squared distance, in radians squared
+ */
+static double _pointSegmentDistSq(const Vec2d* p, const Vec2d* a,
+                                  const Vec2d* b) {
+    double dx = b->x - a->x;
+    double dy = b->y - a->y;
+    double lenSq = dx * dx + dy * dy;
+    double t = 0.0;
+    if (lenSq > 0.0) {
+        t = ((p->x - a->x) * dx + (p->y - a->y) * dy) / lenSq;
+        if (t < 0.0) t = 0.0;
+        if (t > 1.0) t = 1.0;
+    }
+    double ex = a->x + t * dx - p->x;
+    double ey = a->y + t * dy - p->y;
+    return ex * ex + ey * ey;
+}
+
+/**
+ * Simplifies a loop with the Douglas-Peucker algorithm. The loop is split
+ * at its first vertex and the vertex farthest from it, and each chain is
+ * simplified without recursion. A loop left with fewer than 3 vertices is
+ * kept whole.
+ *
+ * @param geofence The loop
+ * @param toleranceRads The largest distance of a vertex dropped from the
+ * edge replacing it
+ * @param out Output loop, whose vertices the caller must free
+ */
+void _simplifyGeofence(const Geofence* geofence, double toleranceRads,
+                       Geofence* out) {
+    int n = geofence->numVerts;
+    out->numVerts = n;
+    out->verts = H3_MEMORY(malloc)((n > 0 ? n : 1) * sizeof(GeoCoord));
+    assert(out->verts != NULL);
+    if (n <= 3) {
+        for (int i = 0; i < n; i++) out->verts[i] = geofence->verts[i];
+        return;
+    }
+
+    BBox bbox;
+    bboxFromGeofence(geofence, &bbox);
+    bool isTransmeridian = bboxIsTransmeridian(&bbox);
+    // The last entry repeats the first vertex, closing the loop
+    Vec2d* pts = H3_MEMORY(malloc)((n + 1) * sizeof(Vec2d));
+    assert(pts != NULL);
+    for (int i = 0; i < n; i++) {
+        pts[i].x = _normalizeLng(geofence->verts[i].lon, isTransmeridian);
+        pts[i].y = geofence->verts[i].lat;
+    }
+    pts[n] = pts[0];
+
+    int far = 1;
+    double farDistSq = 0.0;
+    for (int i = 1; i < n; i++) {
+        double dx = pts[i].x - pts[0].x;
+        double dy = pts[i].y - pts[0].y;
+        if (dx * dx + dy * dy > farDistSq) {
+            farDistSq = dx * dx + dy * dy;
+            far = i;
+        }
+    }
+
+    // Each split leaves one more chain to simplify, so at most n are pending
+    bool* keep = H3_MEMORY(calloc)(n + 1, sizeof(bool));
+    int* stack = H3_MEMORY(malloc)(2 * (n + 1) * sizeof(int));
+    assert(keep != NULL && stack != NULL);
+    keep[0] = keep[far] = keep[n] = true;
+    int numPending = 0;
+    stack[numPending++] = 0;
+    stack[numPending++] = far;
+    stack[numPending++] = far;
+    stack[numPending++] = n;
+    double toleranceSq = toleranceRads * toleranceRads;
+    while (numPending > 0) {
+        int last = stack[--numPending];
+        int first = stack[--numPending];
+        int farthest = -1;
+        double maxDistSq = toleranceSq;
+        for (int i = first + 1; i < last; i++) {
+            double distSq =
+                _pointSegmentDistSq(&pts[i], &pts[first], &pts[last]);
+            if (distSq > maxDistSq) {
+                maxDistSq = distSq;
+                farthest = i;
+            }
+        }
+        if (farthest < 0) continue;
+        keep[farthest] = true;
+        stack[numPending++] = first;
+        stack[numPending++] = farthest;
+        stack[numPending++] = farthest;
+        stack[numPending++] = last;
+    }
+
+    int numKept = 0;
+    for (int i = 0; i < n; i++) {
+        if (keep[i]) out->verts[numKept++] = geofence->verts[i];
+    }
+    if (numKept < 3) {
+        for (int i = 0; i < n; i++) out->verts[i] = geofence->verts[i];
+        numKept = n;
+    }
+    out->numVerts = numKept;
+    H3_MEMORY(free)(stack);
+    H3_MEMORY(free)(keep);
+    H3_MEMORY(free)(pts);
+}
+
+/**
+ * simplifyToleranceRads returns the tolerance polygons are simplified
+ * within for polyfilling at a resolution.
+ *
+ * @param res The resolution
+ * @return The tolerance, in radians, or 0 if the resolution is out of range
+ */
+double H3_EXPORT(simplifyToleranceRads)(int res) {
+    if (res < 0 || res > MAX_H3_RES) return 0.0;
+    return SIMPLIFY_EDGE_FRACTION * H3_EXPORT(edgeLengthKm)(res) /
+           EARTH_RADIUS_KM;
+}
+
+/**
+ * createSimplifiedGeoPolygon creates the cache of simplified copies of a
+ * polygon, which are made on first use at each resolution.
+ *
+ * @param geoPolygon The polygon, which must outlive the result
+ * @return The cache, which the caller must free with
+ * destroySimplifiedGeoPolygon
+ */
+SimplifiedGeoPolygon* H3_EXPORT(createSimplifiedGeoPolygon)(
+    const GeoPolygon* geoPolygon) {
+    SimplifiedGeoPolygon* simplified =
+        H3_MEMORY(calloc)(1, sizeof(SimplifiedGeoPolygon));
+    assert(simplified != NULL);
+    simplified->geoPolygon = geoPolygon;
+    return simplified;
+}
+
+/**
+ * simplifiedGeoPolygonAtRes returns the polygon simplified within
+ * simplifyToleranceRads(res), simplifying and preparing it on first use.
+ * It must not run at the same time as any other function on the same cache.
+ *
+ * @param simplified The cache
+ * @param res The resolution
+ * @return The simplified polygon, owned by the cache, or NULL if the
+ * resolution is out of range
+ */
+const GeoPolygon* H3_EXPORT(simplifiedGeoPolygonAtRes)(
+    SimplifiedGeoPolygon* simplified, int res) {
+    if (res < 0 || res > MAX_H3_RES) return NULL;
+    if (simplified->simplified[res] != NULL) {
+        return simplified->simplified[res];
+    }
+
+    const GeoPolygon* geoPolygon = simplified->geoPolygon;
+    double toleranceRads = H3_EXPORT(simplifyToleranceRads)(res);
+    GeoPolygon* out = H3_MEMORY(malloc)(sizeof(GeoPolygon));
+    assert(out != NULL);
+    out->numHoles = geoPolygon->numHoles;
+    out->holes = NULL;
+    _simplifyGeofence(&geoPolygon->geofence, toleranceRads, &out->geofence);
+    if (out->numHoles > 0) {
+        out->holes = H3_MEMORY(malloc)(out->numHoles * sizeof(Geofence));
+        assert(out->holes != NULL);
+        for (int i = 0; i < out->numHoles; i++) {
+            _simplifyGeofence(&geoPolygon->holes[i], toleranceRads,
+                              &out->holes[i]);
+        }
+    }
+    simplified->simplified[res] = out;
+    simplified->prepared[res] = H3_EXPORT(prepareGeoPolygon)(out);
+    return out;
+}
+
+/**
+ * polyfillSimplified fills a buffer with the hexagons whose centers are in
+ * the polygon simplified for the resolution, as polyfillDense does with the
+ * polygon itself. Only hexagons whose centers are within
+ * simplifyToleranceRads(res) of the simplified boundary can differ. The
+ * simplified polygon is cached, with its prepared edges, for later calls at
+ * the same resolution.
+ *
+ * @param simplified The cache
+ * @param res The Hexagon resolution (0-15)
+ * @param out The buffer to write to
+ * @param outSize The number of hexagons the buffer can hold
+ * @return The number of hexagons in the polyfill, which may exceed outSize,
+ * or 0 if the resolution is out of range
+ */
+int H3_EXPORT(polyfillSimplified)(SimplifiedGeoPolygon* simplified, int res,
+                                  H3Index* out, int outSize) {
+    if (H3_EXPORT(simplifiedGeoPolygonAtRes)(simplified, res) == NULL) {
+        return 0;
+    }
+    int numOut = 0;
+    for (int baseCell = 0; baseCell < NUM_BASE_CELLS; baseCell++) {
+        H3Index h3;
+        setH3Index(&h3, 0, baseCell, 0);
+        _polyfillFromCell(simplified->prepared[res], h3, res, out, outSize,
+                          &numOut);
+    }
+    return numOut;
+}
+
+/**
+ * destroySimplifiedGeoPolygon frees a cache returned by
+ * createSimplifiedGeoPolygon, and every simplified polygon it returned. The
+ * polygon itself is not freed.
+ *
+ * @param simplified The cache
+ */
+void H3_EXPORT(destroySimplifiedGeoPolygon)(
+    SimplifiedGeoPolygon* simplified) {
+    for (int res = 0; res <= MAX_H3_RES; res++) {
+        GeoPolygon* geoPolygon = simplified->simplified[res];
+        if (geoPolygon == NULL) continue;
+        H3_EXPORT(destroyPreparedGeoPolygon)(simplified->prepared[res]);
+        for (int i = 0; i < geoPolygon->numHoles; i++) {
+            H3_MEMORY(free)(geoPolygon->holes[i].verts);
+        }
+        H3_MEMORY(free)(geoPolygon->holes);
+        H3_MEMORY(free)(geoPolygon->geofence.verts);
+        H3_MEMORY(free)(geoPolygon);
+    }
+    H3_MEMORY(free)(simplified);
+}
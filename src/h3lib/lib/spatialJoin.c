@@ -0,0 +1,326 @@
+/*
+ * Copyright 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file spatialJoin.c
+ * @brief   Polygons prepared for assigning points to them by hexagon
+ *
+ * Each polygon is split, at one resolution, into the hexagons its boundary
+ * crosses and the hexagons certainly inside it. A hexagon is crossed if an
+ * edge of the polygon, or of one of its holes, comes within the bounding box
+ * of the hexagon, padded for the curvature of its edges. Every other
+ * hexagon is entirely on one side of the polygon boundary, so it is inside
+ * if its center is, which polyfill finds.
+ *
+ * The interior hexagons of all polygons are compacted into a region index,
+ * and the boundary hexagons kept in a sorted array. A point is indexed, and
+ * resolved by a lookup if its hexagon is interior, or by the exact point in
+ * polygon test against the polygons whose boundaries cross its hexagon.
+ */
+
+#include "spatialJoin.h"
+#include <assert.h>
+#include <math.h>
+#include "bbox.h"
+#include "constants.h"
+#include "h3Alloc.h"
+#include "h3Index.h"
+#include "h3RegionIndex.h"
+
+/** fraction of its size a hexagon bounding box is padded by on each side */
+#define BOUNDARY_BBOX_PADDING 0.1
+/** spacing of the points sampled along edges, in average hexagon edges */
+#define EDGE_SAMPLE_SPACING 0.4
+
+/** @brief A growing array of hexagons and their polygons */
+typedef struct {
+    PolyfillCell* cells;  ///< the hexagons
+    int numCells;         ///< the number of hexagons
+    int capacity;         ///< the number of hexagons allocated
+} CellList;
+
+static void _cellListAppend(CellList* list, H3Index h3, int polygon) {
+    if (list->numCells == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 1024;
+        list->cells = H3_MEMORY(realloc)(list->cells,
+                                         list->capacity * sizeof(PolyfillCell));
+        assert(list->cells != NULL);
+    }
+    list->cells[list->numCells].h3 = h3;
+    list->cells[list->numCells].polygon = polygon;
+    list->numCells++;
+}
+
+/**
+ * Adds every hexagon a straight lat/lon edge may cross. Points are sampled
+ * along the edge closer together than the width of any hexagon, so every
+ * hexagon the edge crosses is the hexagon of a point or a neighbor of one.
+ *
+ * @param set The set of hexagons
+ * @param a The first endpoint
+ * @param b The second endpoint
+ * @param res The resolution
+ * @param spacing The spacing of the samples, in radians
+ */
+static void _addEdgeCells(H3IndexSet* set, const GeoCoord* a,
+                          const GeoCoord* b, int res, double spacing) {
+    double dLat = b->lat - a->lat;
+    double dLon = b->lon - a->lon;
+    if (dLon > M_PI) dLon -= 2 * M_PI;
+    if (dLon < -M_PI) dLon += 2 * M_PI;
+    int numSteps = (int)ceil(sqrt(dLat * dLat + dLon * dLon) / spacing);
+    if (numSteps < 1) numSteps = 1;
+    for (int i = 0; i <= numSteps; i++) {
+        double t = (double)i / numSteps;
+        GeoCoord g = {a->lat + t * dLat, constrainLng(a->lon + t * dLon)};
+        if (g.lon < -M_PI) g.lon += 2 * M_PI;
+        H3Index ring[7] = {0};
+        H3_EXPORT(kRing)(H3_EXPORT(geoToH3)(&g, res), 1, ring);
+        for (int r = 0; r < 7; r++) {
+            H3_EXPORT(h3IndexSetAdd)(set, ring[r]);
+        }
+    }
+}
+
+/**
+ * Whether the boundary of a polygon may cross a hexagon.
+ *
+ * @param prepared The prepared polygon, which must not be transmeridian
+ * @param h3 The hexagon
+ * @return true unless every point of the hexagon is on the same side of the
+ * polygon boundary
+ */
+static bool _cellCrossesPolygon(const PreparedGeoPolygon* prepared,
+                                H3Index h3) {
+    GeoBoundary gb;
+    H3_EXPORT(h3ToGeoBoundary)(h3, &gb);
+    for (int v = 0; v < gb.numVerts; v++) {
+        gb.verts[v].lon = constrainLng(gb.verts[v].lon);
+    }
+    BBox bbox;
+    bboxFromVertices(gb.verts, gb.numVerts, &bbox);
+    if (bboxIsTransmeridian(&bbox)) {
+        // across the antimeridian or around a pole
+        return true;
+    }
+    double size = fmax(bbox.north - bbox.south, bbox.east - bbox.west);
+    double padding = BOUNDARY_BBOX_PADDING * size;
+    bbox.north += padding;
+    bbox.south -= padding;
+    bbox.east += padding;
+    bbox.west -= padding;
+    return _preparedPolygonCrossesBBox(prepared, &bbox);
+}
+
+/**
+ * Splits the hexagons of one polygon into boundary and interior hexagons.
+ *
+ * @param prepared The prepared polygon
+ * @param p The index of the polygon
+ * @param res The resolution
+ * @param interior The interior hexagons, appended to
+ * @param boundary The boundary hexagons, appended to
+ */
+static void _joinPolygon(const PreparedGeoPolygon* prepared, int p, int res,
+                         CellList* interior, CellList* boundary) {
+    const GeoPolygon* polygon = prepared->geoPolygon;
+    bool isTransmeridian = false;
+    for (int i = 0; i <= polygon->numHoles; i++) {
+        isTransmeridian |= bboxIsTransmeridian(&prepared->bboxes[i]);
+    }
+
+    double spacing =
+        EDGE_SAMPLE_SPACING * H3_EXPORT(edgeLengthKm)(res) / EARTH_RADIUS_KM;
+    H3IndexSet* candidates = H3_EXPORT(createH3IndexSet)(0);
+    for (int i = 0; i <= polygon->numHoles; i++) {
+        const Geofence* geofence =
+            i == 0 ? &polygon->geofence : &polygon->holes[i - 1];
+        for (int v = 0; v < geofence->numVerts; v++) {
+            _addEdgeCells(candidates, &geofence->verts[v],
+                          &geofence->verts[(v + 1) % geofence->numVerts], res,
+                          spacing);
+        }
+    }
+
+    int numCandidates = H3_EXPORT(h3IndexSetSize)(candidates);
+    H3Index* cells = H3_MEMORY(malloc)(numCandidates * sizeof(H3Index));
+    assert(cells != NULL || numCandidates == 0);
+    H3_EXPORT(h3IndexSetToArray)(candidates, cells);
+    H3IndexSet* crossed = H3_EXPORT(createH3IndexSet)(0);
+    for (int i = 0; i < numCandidates; i++) {
+        if (isTransmeridian || _cellCrossesPolygon(prepared, cells[i])) {
+            H3_EXPORT(h3IndexSetAdd)(crossed, cells[i]);
+            _cellListAppend(boundary, cells[i], p);
+        }
+    }
+    H3_MEMORY(free)(cells);
+    H3_EXPORT(destroyH3IndexSet)(candidates);
+
+    int maxCells = H3_EXPORT(maxPolyfillSize)(polygon, res);
+    if (maxCells < 0) {
+        // The padded estimate does not fit in an int, so count the cells
+        maxCells = H3_EXPORT(polyfillDense)(polygon, res, NULL, 0);
+    }
+    H3Index* filled = H3_MEMORY(malloc)((size_t)maxCells * sizeof(H3Index));
+    assert(filled != NULL);
+    int numFilled = H3_EXPORT(polyfillDense)(polygon, res, filled, maxCells);
+    for (int i = 0; i < numFilled && i < maxCells; i++) {
+        if (H3_EXPORT(h3IndexSetContains)(crossed, filled[i])) continue;
+        if (isTransmeridian) {
+            _cellListAppend(boundary, filled[i], p);
+        } else {
+            _cellListAppend(interior, filled[i], p);
+        }
+    }
+    H3_MEMORY(free)(filled);
+    H3_EXPORT(destroyH3IndexSet)(crossed);
+}
+
+/**
+ * createH3SpatialJoin prepares polygons for assigning many points to them.
+ * Each polygon is split into the hexagons at res certainly inside it, and
+ * the hexagons its boundary crosses, which points are tested against
+ * exactly. Finer resolutions leave fewer points to test exactly, at the
+ * cost of more hexagons.
+ *
+ * The polygons are not copied, and must outlive the join. The join may be
+ * queried from many threads at once.
+ *
+ * @param polygons The polygons
+ * @param numPolygons The number of polygons
+ * @param res The resolution points are indexed at (0-15)
+ * @return The join, which the caller must free with destroyH3SpatialJoin,
+ * or NULL if the resolution is invalid
+ */
+H3SpatialJoin* H3_EXPORT(createH3SpatialJoin)(const GeoPolygon* polygons,
+                                              int numPolygons, int res) {
+    if (res < 0 || res > MAX_H3_RES || numPolygons < 0) {
+        return NULL;
+    }
+    H3SpatialJoin* join = H3_MEMORY(malloc)(sizeof(H3SpatialJoin));
+    assert(join != NULL);
+    join->res = res;
+    join->numPolygons = numPolygons;
+    join->prepared =
+        H3_MEMORY(malloc)((numPolygons + 1) * sizeof(PreparedGeoPolygon*));
+    assert(join->prepared != NULL);
+
+    CellList interior = {NULL, 0, 0};
+    CellList boundary = {NULL, 0, 0};
+    for (int p = 0; p < numPolygons; p++) {
+        join->prepared[p] = H3_EXPORT(prepareGeoPolygon)(&polygons[p]);
+        _joinPolygon(join->prepared[p], p, res, &interior, &boundary);
+    }
+
+    // The sort is stable, so the copies of a hexagon are in polygon order
+    PolyfillCell* temp = H3_MEMORY(malloc)(
+        (interior.numCells + boundary.numCells + 1) * sizeof(PolyfillCell));
+    assert(temp != NULL);
+    PolyfillCell* sorted = interior.cells;
+    if (interior.numCells > 0) {
+        sorted = _radixSortPolyfillCells(interior.cells, temp,
+                                         interior.numCells);
+    }
+    join->interior = _h3RegionIndexFromSortedCells(
+        sorted, interior.numCells, NULL, res, &join->interiorSize);
+    H3_MEMORY(free)(interior.cells);
+
+    join->numBoundary = boundary.numCells;
+    join->boundary = H3_MEMORY(malloc)(
+        (boundary.numCells + 1) * sizeof(PolyfillCell));
+    assert(join->boundary != NULL);
+    if (boundary.numCells > 0) {
+        sorted = _radixSortPolyfillCells(boundary.cells, temp,
+                                         boundary.numCells);
+        for (int i = 0; i < boundary.numCells; i++) {
+            join->boundary[i] = sorted[i];
+        }
+    }
+    H3_MEMORY(free)(boundary.cells);
+    H3_MEMORY(free)(temp);
+    return join;
+}
+
+/**
+ * h3SpatialJoinPoint finds the first polygon of a join containing a point,
+ * as the point in polygon test of polyfill decides containment.
+ *
+ * @param join The join
+ * @param g The point
+ * @return The index of the polygon, or -1 if no polygon contains the point
+ */
+int H3_EXPORT(h3SpatialJoinPoint)(const H3SpatialJoin* join,
+                                  const GeoCoord* g) {
+    GeoCoord point = {g->lat, constrainLng(g->lon)};
+    H3Index h = H3_EXPORT(geoToH3)(&point, join->res);
+    if (h == H3_INVALID_INDEX) {
+        return -1;
+    }
+    int interior = -1;
+    if (!H3_EXPORT(h3RegionIndexLookupCell)(join->interior, h, &interior)) {
+        interior = -1;
+    }
+
+    int low = 0;
+    int high = join->numBoundary;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (join->boundary[mid].h3 < h) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (int i = low; i < join->numBoundary && join->boundary[i].h3 == h;
+         i++) {
+        int p = join->boundary[i].polygon;
+        if (interior >= 0 && p > interior) break;
+        if (_preparedPolygonContains(join->prepared[p], &point)) {
+            return p;
+        }
+    }
+    return interior;
+}
+
+/**
+ * h3SpatialJoinPoints finds the first polygon of a join containing each of
+ * an array of points, as h3SpatialJoinPoint does.
+ *
+ * @param join The join
+ * @param points The points
+ * @param n The number of points
+ * @param out Output array of n polygon indexes, -1 for points in no polygon
+ */
+void H3_EXPORT(h3SpatialJoinPoints)(const H3SpatialJoin* join,
+                                    const GeoCoord* points, int n, int* out) {
+    for (int i = 0; i < n; i++) {
+        out[i] = H3_EXPORT(h3SpatialJoinPoint)(join, &points[i]);
+    }
+}
+
+/**
+ * destroyH3SpatialJoin frees a join returned by createH3SpatialJoin. The
+ * polygons it was created from are not freed.
+ *
+ * @param join The join
+ */
+void H3_EXPORT(destroyH3SpatialJoin)(H3SpatialJoin* join) {
+    for (int p = 0; p < join->numPolygons; p++) {
+        H3_EXPORT(destroyPreparedGeoPolygon)(join->prepared[p]);
+    }
+    H3_MEMORY(free)(join->prepared);
+    H3_EXPORT(destroyH3RegionIndex)(join->interior);
+    H3_MEMORY(free)(join->boundary);
+    H3_MEMORY(free)(join);
+}
@@ -23,24 +23,57 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "constants.h"
 #include "geoCoord.h"
+#include "h3Alloc.h"
+#include "h3IndexSet.h"
+#include "h3Stats.h"
 
 /**
- * Initialize a new VertexGraph
+ * Grid steps per hexagon edge used by the vertex hash. Vertices are about
+ * an edge apart, so they fall in different steps, while the rounding error
+ * of a vertex computed from neighboring hexagons is many orders of
+ * magnitude smaller than a step.
+ */
+#define VERTEX_HASH_STEPS_PER_EDGE 4
+
+/**
+ * Allocate a new slab of nodes and push it onto the graph's slab list.
+ * @param graph    Graph to add the slab to
+ * @param capacity Number of nodes in the slab
+ */
+static void _addVertexNodeSlab(VertexGraph* graph, int capacity) {
+    VertexNodeSlab* slab = H3_MEMORY(malloc)(sizeof(VertexNodeSlab) +
+                                             capacity * sizeof(VertexNode));
+    assert(slab != NULL);
+    slab->capacity = capacity;
+    slab->used = 0;
+    slab->next = graph->slabs;
+    graph->slabs = slab;
+}
+
+/**
+ * Initialize a new VertexGraph. Storage for numBuckets nodes is allocated
+ * up front, so a graph holding no more edges than it has buckets makes
+ * exactly two allocations.
  * @param graph       Graph to initialize
  * @param  numBuckets Number of buckets to include in the graph
  * @param  res        Resolution of the hexagons whose vertices we're storing
  */
 void initVertexGraph(VertexGraph* graph, int numBuckets, int res) {
+    graph->slabs = NULL;
+    graph->freeNodes = NULL;
     if (numBuckets > 0) {
-        graph->buckets = calloc(numBuckets, sizeof(VertexNode*));
+        graph->buckets = H3_MEMORY(calloc)(numBuckets, sizeof(VertexNode*));
         assert(graph->buckets != NULL);
+        _addVertexNodeSlab(graph, numBuckets);
     } else {
         graph->buckets = NULL;
     }
     graph->numBuckets = numBuckets;
     graph->size = 0;
     graph->res = res;
+    graph->firstBucket = numBuckets;
 }
 
 /**
@@ -49,29 +82,60 @@ void initVertexGraph(VertexGraph* graph, int numBuckets, int res) {
  * @param graph Graph to destroy
  */
 void destroyVertexGraph(VertexGraph* graph) {
-    VertexNode* node;
-    while ((node = firstVertexNode(graph)) != NULL) {
-        removeVertexNode(graph, node);
+    VertexNodeSlab* slab = graph->slabs;
+    while (slab != NULL) {
+        VertexNodeSlab* next = slab->next;
+        H3_MEMORY(free)(slab);
+        slab = next;
+    }
+    graph->slabs = NULL;
+    graph->freeNodes = NULL;
+    H3_MEMORY(free)(graph->buckets);
+    graph->buckets = NULL;
+    graph->size = 0;
+}
+
+/**
+ * Take an unused node from the graph's free list or slabs, growing the
+ * slab list if every slab is full.
+ * @param graph Graph to take the node from
+ * @return      Uninitialized node owned by the graph
+ */
+static VertexNode* _allocVertexNode(VertexGraph* graph) {
+    if (graph->freeNodes != NULL) {
+        VertexNode* node = graph->freeNodes;
+        graph->freeNodes = node->next;
+        return node;
     }
-    free(graph->buckets);
+    VertexNodeSlab* slab = graph->slabs;
+    if (slab == NULL || slab->used == slab->capacity) {
+        // Existing nodes must not move, so grow by adding a slab as large
+        // as everything allocated so far.
+        int capacity = graph->size > 0 ? graph->size : 1;
+        _addVertexNodeSlab(graph, capacity);
+        slab = graph->slabs;
+    }
+    return &slab->nodes[slab->used++];
 }
 
 /**
- * Get an integer hash for a lat/lon point, at a precision determined
- * by the current hexagon resolution.
- * TODO: Light testing suggests this might not be sufficient at resolutions
- * finer than 10. Design a better hash function if performance and collisions
- * seem to be an issue here.
+ * Get an integer hash for a lat/lon point. The latitude and longitude are
+ * each quantized to a grid of VERTEX_HASH_STEPS_PER_EDGE steps per hexagon
+ * edge at the resolution, so that distinct vertices fall in distinct grid
+ * cells at every resolution, and the two grid coordinates are mixed before
+ * taking the bucket.
  * @param  vertex     Lat/lon vertex to hash
  * @param  res        Resolution of the hexagon the vertex belongs to
  * @param  numBuckets Number of buckets in the graph
  * @return            Integer hash
  */
 uint32_t _hashVertex(const GeoCoord* vertex, int res, int numBuckets) {
-    // Simple hash: Take the sum of the lat and lon with a precision level
-    // determined by the resolution, converted to int, modulo bucket count.
-    return (uint32_t)fmod((vertex->lat + vertex->lon) * pow(10, 15 - res),
-                          numBuckets);
+    double scale = VERTEX_HASH_STEPS_PER_EDGE * EARTH_RADIUS_KM /
+                   H3_EXPORT(edgeLengthKm)(res);
+    int64_t lat = (int64_t)floor(vertex->lat * scale);
+    int64_t lon = (int64_t)floor(vertex->lon * scale);
+    uint64_t key = ((uint64_t)lat << 32) ^ (uint64_t)lon;
+    return (uint32_t)(_h3IndexHash(key) % (uint64_t)numBuckets);
 }
 
 void _initVertexNode(VertexNode* node, const GeoCoord* fromVtx,
@@ -90,41 +154,35 @@ void _initVertexNode(VertexNode* node, const GeoCoord* fromVtx,
  */
 VertexNode* addVertexNode(VertexGraph* graph, const GeoCoord* fromVtx,
                           const GeoCoord* toVtx) {
-    // Make the new node
-    VertexNode* node = malloc(sizeof(VertexNode));
-    assert(node != NULL);
-    _initVertexNode(node, fromVtx, toVtx);
     // Determine location
     uint32_t index = _hashVertex(fromVtx, graph->res, graph->numBuckets);
     // Check whether there's an existing node in that spot
     VertexNode* currentNode = graph->buckets[index];
-    if (currentNode == NULL) {
-        // Set bucket to the new node
-        graph->buckets[index] = node;
-    } else {
-        // Find the end of the list
-        do {
-            // Check the the edge we're adding doesn't already exist
-            if (geoAlmostEqual(&currentNode->from, fromVtx) &&
-                geoAlmostEqual(&currentNode->to, toVtx)) {
-                // already exists, bail
-                free(node);
-                return currentNode;
-            }
-            if (currentNode->next != NULL) {
-                currentNode = currentNode->next;
-            }
-        } while (currentNode->next != NULL);
-        // Add the new node to the end of the list
-        currentNode->next = node;
+    VertexNode** tail = &graph->buckets[index];
+    while (currentNode != NULL) {
+        // Check the the edge we're adding doesn't already exist
+        if (geoAlmostEqual(&currentNode->from, fromVtx) &&
+            geoAlmostEqual(&currentNode->to, toVtx)) {
+            // already exists, bail
+            return currentNode;
+        }
+        tail = &currentNode->next;
+        currentNode = currentNode->next;
+    }
+    // Make the new node and add it to the end of the list
+    VertexNode* node = _allocVertexNode(graph);
+    _initVertexNode(node, fromVtx, toVtx);
+    *tail = node;
+    if ((int)index < graph->firstBucket) {
+        graph->firstBucket = index;
     }
     graph->size++;
     return node;
 }
 
 /**
- * Remove a node from the graph. The input node will be freed, and should
- * not be used after removal.
+ * Remove a node from the graph. The input node will be returned to the
+ * graph's free list, and should not be used after removal.
  * @param graph Graph to mutate
  * @param node  Node to remove
  * @return      0 on success, 1 on failure (node not found)
@@ -150,8 +208,17 @@ int removeVertexNode(VertexGraph* graph, VertexNode* node) {
         }
     }
     if (found) {
-        free(node);
+        node->next = graph->freeNodes;
+        graph->freeNodes = node;
         graph->size--;
+        // Keep the first bucket hint tight so that firstVertexNode does not
+        // rescan empty buckets while the graph is drained
+        if ((int)index == graph->firstBucket) {
+            while (graph->firstBucket < graph->numBuckets &&
+                   graph->buckets[graph->firstBucket] == NULL) {
+                graph->firstBucket++;
+            }
+        }
         return 0;
     }
     // Failed to find the node
@@ -171,9 +238,11 @@ VertexNode* findNodeForEdge(const VertexGraph* graph, const GeoCoord* fromVtx,
     uint32_t index = _hashVertex(fromVtx, graph->res, graph->numBuckets);
     // Check whether there's an existing node in that spot
     VertexNode* node = graph->buckets[index];
+    H3_STAT_ADD(vertexGraphLookups, 1);
     if (node != NULL) {
         // Look through the list and see if we find the edge
         do {
+            H3_STAT_ADD(vertexGraphProbes, 1);
             if (geoAlmostEqual(&node->from, fromVtx) &&
                 (toVtx == NULL || geoAlmostEqual(&node->to, toVtx))) {
                 return node;
@@ -202,17 +271,11 @@ VertexNode* findNodeForVertex(const VertexGraph* graph,
  * @return       Vertex node, or NULL if at the end
  */
 VertexNode* firstVertexNode(const VertexGraph* graph) {
-    VertexNode* node = NULL;
-    int currentIndex = 0;
-    while (node == NULL) {
-        if (currentIndex < graph->numBuckets) {
-            // find the first node in the next bucket
-            node = graph->buckets[currentIndex];
-        } else {
-            // end of iteration
-            return NULL;
+    for (int i = graph->firstBucket; i < graph->numBuckets; i++) {
+        if (graph->buckets[i] != NULL) {
+            return graph->buckets[i];
         }
-        currentIndex++;
     }
-    return node;
+    // end of iteration
+    return NULL;
 }